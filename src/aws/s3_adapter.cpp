@@ -604,6 +604,58 @@ Aws::S3::Model::CompletedPart S3Adapter::UploadOnePart(
   }
 }
 
+int S3Adapter::CopyObject(const Aws::String& src_key,
+                          const Aws::String& dst_key) {
+  Aws::S3::Model::CopyObjectRequest request;
+  request.SetBucket(bucketName_);
+  request.SetKey(dst_key);
+  request.SetCopySource(bucketName_ + "/" + src_key);
+
+  if (throttle_) {
+    throttle_->Add(false, 0);
+  }
+  auto response = s3Client_->CopyObject(request);
+  if (response.IsSuccess()) {
+    return 0;
+  } else {
+    LOG(ERROR) << "CopyObject error:" << bucketName_ << "--" << src_key
+               << "=>" << dst_key << "--"
+               << response.GetError().GetExceptionName()
+               << response.GetError().GetMessage();
+    return -1;
+  }
+}
+
+Aws::S3::Model::CompletedPart S3Adapter::UploadPartCopy(
+    const Aws::String& key, const Aws::String& upload_id, int part_num,
+    const Aws::String& src_key, uint64_t offset, uint64_t len) {
+  Aws::S3::Model::UploadPartCopyRequest request;
+  request.SetBucket(bucketName_);
+  request.SetKey(key);
+  request.SetUploadId(upload_id);
+  request.SetPartNumber(part_num);
+  request.SetCopySource(bucketName_ + "/" + src_key);
+  request.SetCopySourceRange(GetObjectRequestRange(offset, len));
+
+  if (throttle_) {
+    throttle_->Add(false, 0);
+  }
+  auto response = s3Client_->UploadPartCopy(request);
+  if (response.IsSuccess()) {
+    return Aws::S3::Model::CompletedPart()
+        .WithETag(response.GetResult().GetCopyPartResult().GetETag())
+        .WithPartNumber(part_num);
+  } else {
+    LOG(ERROR) << "UploadPartCopy error:" << bucketName_ << "--" << src_key
+               << "=>" << key << ", part " << part_num << "--"
+               << response.GetError().GetExceptionName()
+               << response.GetError().GetMessage();
+    return Aws::S3::Model::CompletedPart()
+        .WithETag("errorTag")
+        .WithPartNumber(-1);
+  }
+}
+
 int S3Adapter::CompleteMultiUpload(
     const Aws::String& key, const Aws::String& upload_id,
     const Aws::Vector<Aws::S3::Model::CompletedPart>& cp_v) {
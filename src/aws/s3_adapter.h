@@ -37,6 +37,7 @@
 #include <aws/s3/model/BucketLocationConstraint.h>
 #include <aws/s3/model/CompleteMultipartUploadRequest.h>
 #include <aws/s3/model/CompletedPart.h>
+#include <aws/s3/model/CopyObjectRequest.h>
 #include <aws/s3/model/CreateBucketConfiguration.h>
 #include <aws/s3/model/CreateBucketRequest.h>
 #include <aws/s3/model/CreateMultipartUploadRequest.h>
@@ -49,14 +50,17 @@
 #include <aws/s3/model/HeadObjectRequest.h>
 #include <aws/s3/model/ObjectIdentifier.h>
 #include <aws/s3/model/PutObjectRequest.h>
+#include <aws/s3/model/UploadPartCopyRequest.h>
 #include <aws/s3/model/UploadPartRequest.h>
 
 #include <condition_variable>
 #include <cstdint>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include "bvar/reducer.h"
 #include "utils/configuration.h"
@@ -304,6 +308,32 @@ class S3Adapter {
       const Aws::String& key, const Aws::String& upload_id, int part_num,
       int part_size, const char* buf);
 
+  /**
+   * copy the whole object inside the bucket, the data is not transferred
+   * through the caller
+   * @param source object name
+   * @param destination object name
+   * @return 0 success / -1 fail
+   */
+  virtual int CopyObject(const Aws::String& src_key,
+                         const Aws::String& dst_key);
+
+  /**
+   * add a part copied from the range of an existing object to the
+   * multipart upload task, all parts except the last one must be
+   * at least 5MiB
+   * @param object name
+   * @param upload id
+   * @param part number (start from 1)
+   * @param source object name
+   * @param offset of the range in source object
+   * @param length of the range
+   * @return: completed part, part number is -1 if failed
+   */
+  virtual Aws::S3::Model::CompletedPart UploadPartCopy(
+      const Aws::String& key, const Aws::String& upload_id, int part_num,
+      const Aws::String& src_key, uint64_t offset, uint64_t len);
+
   /**
    * 完成分片上传任务
    * @param 对象名
@@ -367,9 +397,12 @@ class S3Adapter {
   bvar::Adder<uint64_t> s3_object_get_sync_num_;
 };
 
+// Fake s3 adapter which does nothing and always returns success, the read
+// data is filled with '1'. If `in_memory` is true, the objects are kept in
+// memory instead, so the callers can be tested offline.
 class FakeS3Adapter final : public S3Adapter {
  public:
-  FakeS3Adapter() = default;
+  explicit FakeS3Adapter(bool in_memory = false) : inMemory_(in_memory) {}
 
   ~FakeS3Adapter() override = default;
 
@@ -377,26 +410,33 @@ class FakeS3Adapter final : public S3Adapter {
 
   int PutObject(const Aws::String& key, const char* buffer,
                 const size_t buffer_size) override {
-    (void)key;
-    (void)buffer;
-    (void)buffer_size;
+    if (inMemory_) {
+      std::lock_guard<std::mutex> lk(mutex_);
+      objects_[ToString(key)] = std::string(buffer, buffer_size);
+    }
     return 0;
   }
 
   int PutObject(const Aws::String& key, const std::string& data) override {
-    (void)key;
-    (void)data;
-    return 0;
+    return PutObject(key, data.data(), data.size());
   }
 
   void PutObjectAsync(std::shared_ptr<PutObjectAsyncContext> context) override {
-    context->retCode = 0;
+    context->retCode = PutObject(Aws::String(context->key.c_str()),
+                                 context->buffer, context->bufferSize);
     context->cb(context);
   }
 
   int GetObject(const Aws::String& key, std::string* data) override {
-    (void)key;
-    (void)data;
+    if (inMemory_) {
+      std::lock_guard<std::mutex> lk(mutex_);
+      auto iter = objects_.find(ToString(key));
+      if (iter == objects_.end()) {
+        return -1;
+      }
+      *data = iter->second;
+      return 0;
+    }
     // just return 4M data
     data->resize(4 * 1024 * 1024, '1');
     return 0;
@@ -404,33 +444,158 @@ class FakeS3Adapter final : public S3Adapter {
 
   int GetObject(const std::string& key, char* buf, off_t offset,
                 size_t len) override {
-    (void)key;
-    (void)offset;
+    if (inMemory_) {
+      std::lock_guard<std::mutex> lk(mutex_);
+      auto iter = objects_.find(key);
+      if (iter == objects_.end() ||
+          static_cast<size_t>(offset) + len > iter->second.size()) {
+        return -1;
+      }
+      memcpy(buf, iter->second.data() + offset, len);
+      return 0;
+    }
     // juset return len data
     memset(buf, '1', len);
     return 0;
   }
 
   void GetObjectAsync(std::shared_ptr<GetObjectAsyncContext> context) override {
-    memset(context->buf, '1', context->len);
-    context->retCode = 0;
+    context->retCode = GetObject(context->key, context->buf, context->offset,
+                                 context->len);
     context->cb(this, context);
   }
 
   int DeleteObject(const Aws::String& key) override {
-    (void)key;
+    if (inMemory_) {
+      std::lock_guard<std::mutex> lk(mutex_);
+      objects_.erase(ToString(key));
+    }
     return 0;
   }
 
   int DeleteObjects(const std::list<Aws::String>& key_list) override {
-    (void)key_list;
+    for (const auto& key : key_list) {
+      DeleteObject(key);
+    }
     return 0;
   }
 
   bool ObjectExist(const Aws::String& key) override {
-    (void)key;
+    if (inMemory_) {
+      std::lock_guard<std::mutex> lk(mutex_);
+      return objects_.count(ToString(key)) != 0;
+    }
     return true;
   }
+
+  int CopyObject(const Aws::String& src_key,
+                 const Aws::String& dst_key) override {
+    if (inMemory_) {
+      std::lock_guard<std::mutex> lk(mutex_);
+      auto iter = objects_.find(ToString(src_key));
+      if (iter == objects_.end()) {
+        return -1;
+      }
+      objects_[ToString(dst_key)] = iter->second;
+    }
+    return 0;
+  }
+
+  Aws::String MultiUploadInit(const Aws::String& key) override {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto upload_id = ToString(key) + "#" + std::to_string(nextUploadId_++);
+    uploads_[upload_id].clear();
+    return Aws::String(upload_id.c_str(), upload_id.size());
+  }
+
+  Aws::S3::Model::CompletedPart UploadOnePart(const Aws::String& key,
+                                              const Aws::String& upload_id,
+                                              int part_num, int part_size,
+                                              const char* buf) override {
+    (void)key;
+    return AddPart(upload_id, part_num, std::string(buf, part_size));
+  }
+
+  Aws::S3::Model::CompletedPart UploadPartCopy(const Aws::String& key,
+                                               const Aws::String& upload_id,
+                                               int part_num,
+                                               const Aws::String& src_key,
+                                               uint64_t offset,
+                                               uint64_t len) override {
+    (void)key;
+    std::string data;
+    if (inMemory_) {
+      std::lock_guard<std::mutex> lk(mutex_);
+      auto iter = objects_.find(ToString(src_key));
+      if (iter == objects_.end() || offset + len > iter->second.size()) {
+        return Aws::S3::Model::CompletedPart()
+            .WithETag("errorTag")
+            .WithPartNumber(-1);
+      }
+      data = iter->second.substr(offset, len);
+    }
+    return AddPart(upload_id, part_num, std::move(data));
+  }
+
+  int CompleteMultiUpload(
+      const Aws::String& key, const Aws::String& upload_id,
+      const Aws::Vector<Aws::S3::Model::CompletedPart>& cp_v) override {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto iter = uploads_.find(ToString(upload_id));
+    if (iter == uploads_.end()) {
+      return -1;
+    }
+    std::string data;
+    for (const auto& part : cp_v) {
+      auto it = iter->second.find(part.GetPartNumber());
+      if (it == iter->second.end()) {
+        uploads_.erase(iter);
+        return -1;
+      }
+      data.append(it->second);
+    }
+    uploads_.erase(iter);
+    if (inMemory_) {
+      objects_[ToString(key)] = std::move(data);
+    }
+    return 0;
+  }
+
+  int AbortMultiUpload(const Aws::String& key,
+                       const Aws::String& upload_id) override {
+    (void)key;
+    std::lock_guard<std::mutex> lk(mutex_);
+    uploads_.erase(ToString(upload_id));
+    return 0;
+  }
+
+ private:
+  static std::string ToString(const Aws::String& str) {
+    return std::string(str.c_str(), str.size());
+  }
+
+  Aws::S3::Model::CompletedPart AddPart(const Aws::String& upload_id,
+                                        int part_num, std::string data) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto iter = uploads_.find(ToString(upload_id));
+    if (iter == uploads_.end()) {
+      return Aws::S3::Model::CompletedPart()
+          .WithETag("errorTag")
+          .WithPartNumber(-1);
+    }
+    iter->second[part_num] = inMemory_ ? std::move(data) : std::string();
+    return Aws::S3::Model::CompletedPart()
+        .WithETag(Aws::String(std::to_string(part_num).c_str()))
+        .WithPartNumber(part_num);
+  }
+
+ private:
+  const bool inMemory_;
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::string> objects_;
+  // upload id => (part number => data)
+  std::unordered_map<std::string, std::map<int, std::string>> uploads_;
+  uint64_t nextUploadId_{0};
 };
 
 }  // namespace aws
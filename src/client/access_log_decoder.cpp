@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Decode the binary access log written by async access logger, e.g.
+//
+//   $ dingo-access-log-decoder /var/log/dingofs/access_1234.bin
+//   2024-10-24 10:00:00.000123 read (100,0,4096): OK <0.000120>
+
+#include <time.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "client/filesystem/async_access_log.h"
+
+using ::dingofs::client::filesystem::AccessLogReader;
+using ::dingofs::client::filesystem::AccessLogRecord;
+using ::dingofs::client::filesystem::StrAccessLogRecord;
+
+namespace {
+
+std::string StrTimestamp(uint64_t timestamp_us) {
+  time_t seconds = timestamp_us / 1000000;
+  struct tm tm;
+  localtime_r(&seconds, &tm);
+
+  char buffer[64];
+  size_t n = strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+  snprintf(buffer + n, sizeof(buffer) - n, ".%06lu",
+           static_cast<unsigned long>(timestamp_us % 1000000));
+  return buffer;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s <binary access log>\n", argv[0]);
+    return 1;
+  }
+
+  bool succ = AccessLogReader::ReadAll(argv[1], [](const AccessLogRecord& r) {
+    printf("%s %s\n", StrTimestamp(r.timestamp_us).c_str(),
+           StrAccessLogRecord(r).c_str());
+  });
+  if (!succ) {
+    fprintf(stderr, "Decode access log (%s) failed.\n", argv[1]);
+    return 1;
+  }
+  return 0;
+}
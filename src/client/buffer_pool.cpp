@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/buffer_pool.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "client/common/dynamic_config.h"
+
+namespace dingofs {
+namespace client {
+
+using common::FLAGS_fuse_buffer_pool_max_cached_mb;
+
+namespace {
+
+constexpr size_t kAlignment = 4096;
+
+// the bytes cached by each thread for every size class
+constexpr size_t kThreadCacheBytes = 1024 * 1024;
+
+size_t ClassSize(int sizeClass) {
+  return BufferPool::kMinBufferSize << sizeClass;
+}
+
+size_t ThreadCacheLimit(int sizeClass) {
+  return std::max<size_t>(1, kThreadCacheBytes / ClassSize(sizeClass));
+}
+
+}  // namespace
+
+// The buffers cached by one thread, they are given back to the shared lists
+// when the thread exits, and are still counted as cached there.
+class ThreadCache {
+ public:
+  ~ThreadCache() {
+    auto& pool = BufferPool::GetInstance();
+    for (int i = 0; i < BufferPool::kNumSizeClasses; i++) {
+      for (char* buffer : lists_[i]) {
+        pool.PushCentral(i, buffer);
+      }
+      lists_[i].clear();
+    }
+  }
+
+  char* Pop(int sizeClass) {
+    auto& list = lists_[sizeClass];
+    if (list.empty()) {
+      return nullptr;
+    }
+    char* buffer = list.back();
+    list.pop_back();
+    return buffer;
+  }
+
+  bool Push(int sizeClass, char* buffer) {
+    auto& list = lists_[sizeClass];
+    if (list.size() >= ThreadCacheLimit(sizeClass)) {
+      return false;
+    }
+    list.push_back(buffer);
+    return true;
+  }
+
+ private:
+  std::vector<char*> lists_[BufferPool::kNumSizeClasses];
+};
+
+static thread_local ThreadCache threadCache;
+
+BufferPool::BufferPool()
+    : cachedBytes_(0),
+      hits_("fuse_buffer_pool", "hit"),
+      misses_("fuse_buffer_pool", "miss"),
+      cachedBytesStatus_("fuse_buffer_pool", "cached_bytes",
+                         &BufferPool::GetCachedBytes, this) {}
+
+uint64_t BufferPool::GetCachedBytes(void* arg) {
+  return static_cast<BufferPool*>(arg)->CachedBytes();
+}
+
+int BufferPool::SizeClass(size_t size) {
+  if (size > kMaxBufferSize) {
+    return -1;
+  }
+
+  int sizeClass = 0;
+  while (ClassSize(sizeClass) < size) {
+    sizeClass++;
+  }
+  return sizeClass;
+}
+
+char* BufferPool::Allocate(size_t size, size_t* capacity) {
+  int sizeClass = SizeClass(size);
+  if (sizeClass < 0) {
+    misses_ << 1;
+    *capacity = size;
+    return NewBuffer(size);
+  }
+
+  *capacity = ClassSize(sizeClass);
+  char* buffer = threadCache.Pop(sizeClass);
+  if (buffer == nullptr) {
+    buffer = PopCentral(sizeClass);
+  }
+
+  if (buffer != nullptr) {
+    hits_ << 1;
+    SubCachedBytes(*capacity);
+    return buffer;
+  }
+  misses_ << 1;
+  return NewBuffer(*capacity);
+}
+
+void BufferPool::Release(char* buffer, size_t capacity) {
+  if (buffer == nullptr) {
+    return;
+  }
+
+  int sizeClass = SizeClass(capacity);
+  if (sizeClass < 0 || ClassSize(sizeClass) != capacity) {
+    FreeBuffer(buffer);
+    return;
+  }
+
+  if (!AddCachedBytes(capacity)) {
+    FreeBuffer(buffer);
+  } else if (!threadCache.Push(sizeClass, buffer)) {
+    PushCentral(sizeClass, buffer);
+  }
+}
+
+char* BufferPool::PopCentral(int sizeClass) {
+  auto& central = centrals_[sizeClass];
+  std::lock_guard<std::mutex> lk(central.mutex);
+  if (central.buffers.empty()) {
+    return nullptr;
+  }
+  char* buffer = central.buffers.back();
+  central.buffers.pop_back();
+  return buffer;
+}
+
+void BufferPool::PushCentral(int sizeClass, char* buffer) {
+  auto& central = centrals_[sizeClass];
+  std::lock_guard<std::mutex> lk(central.mutex);
+  central.buffers.push_back(buffer);
+}
+
+bool BufferPool::AddCachedBytes(size_t size) {
+  uint64_t limit = FLAGS_fuse_buffer_pool_max_cached_mb * 1024ULL * 1024;
+  uint64_t cached = cachedBytes_.load(std::memory_order_relaxed);
+  do {
+    if (cached + size > limit) {
+      return false;
+    }
+  } while (!cachedBytes_.compare_exchange_weak(cached, cached + size,
+                                               std::memory_order_relaxed));
+  return true;
+}
+
+void BufferPool::SubCachedBytes(size_t size) {
+  cachedBytes_.fetch_sub(size, std::memory_order_relaxed);
+}
+
+char* BufferPool::NewBuffer(size_t capacity) {
+  void* buffer = nullptr;
+  int rc = posix_memalign(&buffer, kAlignment, std::max<size_t>(capacity, 1));
+  CHECK(rc == 0) << "allocate buffer failed, size = " << capacity
+                 << ", rc = " << rc;
+  return static_cast<char*>(buffer);
+}
+
+void BufferPool::FreeBuffer(char* buffer) { free(buffer); }
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) noexcept {
+  if (this != &other) {
+    Reset();
+    data_ = other.data_;
+    capacity_ = other.capacity_;
+    other.data_ = nullptr;
+    other.capacity_ = 0;
+  }
+  return *this;
+}
+
+void PooledBuffer::Reserve(size_t size, size_t used) {
+  if (data_ != nullptr && size <= capacity_) {
+    return;
+  }
+
+  // grow at least twice, so appending the entries one by one costs linear
+  // time even beyond the largest size class
+  size_t capacity = 0;
+  size = std::max(size, capacity_ * 2);
+  char* data = BufferPool::GetInstance().Allocate(size, &capacity);
+  if (data_ != nullptr && used > 0) {
+    memcpy(data, data_, std::min(used, capacity_));
+  }
+  Reset();
+  data_ = data;
+  capacity_ = capacity;
+}
+
+void PooledBuffer::Reset() {
+  if (data_ != nullptr) {
+    BufferPool::GetInstance().Release(data_, capacity_);
+    data_ = nullptr;
+    capacity_ = 0;
+  }
+}
+
+}  // namespace client
+}  // namespace dingofs
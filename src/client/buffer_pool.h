@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_CLIENT_BUFFER_POOL_H_
+#define DINGOFS_SRC_CLIENT_BUFFER_POOL_H_
+
+#include <bvar/bvar.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace dingofs {
+namespace client {
+
+// A pool of the buffers for the fuse replies, e.g. read, readdir and the
+// xattrs, which are allocated and freed at a high rate.
+//
+// The buffers are grouped by size class, the class i holds 4KiB << i bytes.
+// Every thread caches a few buffers of each class without lock, the others
+// are shared by all threads with a mutex per class, and the buffers larger
+// than the largest class bypass the pool. Both the buffers cached by threads
+// and the shared ones count toward fuse_buffer_pool_max_cached_mb. The fuse
+// reply functions copy the data before they return, so the buffer can be
+// released back right after the reply is sent.
+class BufferPool {
+ public:
+  static constexpr size_t kMinBufferSize = 4096;
+  static constexpr int kNumSizeClasses = 11;  // 4KiB ~ 4MiB
+  static constexpr size_t kMaxBufferSize = kMinBufferSize
+                                           << (kNumSizeClasses - 1);
+
+  static BufferPool& GetInstance() {
+    static BufferPool instance;
+    return instance;
+  }
+
+  // return a buffer holds at least `size` bytes, the `capacity` of buffer
+  // must be passed back to Release()
+  char* Allocate(size_t size, size_t* capacity);
+
+  void Release(char* buffer, size_t capacity);
+
+  // return the size class of `size`, or -1 if it's larger than any class
+  static int SizeClass(size_t size);
+
+  uint64_t Hits() const { return hits_.get_value(); }
+
+  uint64_t Misses() const { return misses_.get_value(); }
+
+  uint64_t CachedBytes() const {
+    return cachedBytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend class ThreadCache;
+
+  struct CentralList {
+    std::mutex mutex;
+    std::vector<char*> buffers;
+  };
+
+  BufferPool();
+
+  char* PopCentral(int sizeClass);
+
+  void PushCentral(int sizeClass, char* buffer);
+
+  // return false if the cached buffers would exceed the limit
+  bool AddCachedBytes(size_t size);
+
+  void SubCachedBytes(size_t size);
+
+  static uint64_t GetCachedBytes(void* arg);
+
+  static char* NewBuffer(size_t capacity);
+
+  static void FreeBuffer(char* buffer);
+
+ private:
+  std::array<CentralList, kNumSizeClasses> centrals_;
+  std::atomic<uint64_t> cachedBytes_;
+
+  bvar::Adder<uint64_t> hits_;
+  bvar::Adder<uint64_t> misses_;
+  bvar::PassiveStatus<uint64_t> cachedBytesStatus_;
+};
+
+// A buffer from BufferPool which is released back when it goes out of scope.
+class PooledBuffer {
+ public:
+  PooledBuffer() : data_(nullptr), capacity_(0) {}
+
+  explicit PooledBuffer(size_t size) : PooledBuffer() { Reserve(size, 0); }
+
+  ~PooledBuffer() { Reset(); }
+
+  PooledBuffer(const PooledBuffer&) = delete;
+  PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+  PooledBuffer(PooledBuffer&& other) noexcept
+      : data_(other.data_), capacity_(other.capacity_) {
+    other.data_ = nullptr;
+    other.capacity_ = 0;
+  }
+
+  PooledBuffer& operator=(PooledBuffer&& other) noexcept;
+
+  char* Data() const { return data_; }
+
+  size_t Capacity() const { return capacity_; }
+
+  // make the buffer hold at least `size` bytes, the first `used` bytes
+  // are kept if the buffer is replaced by a larger one
+  void Reserve(size_t size, size_t used);
+
+  void Reset();
+
+ private:
+  char* data_;
+  size_t capacity_;
+};
+
+}  // namespace client
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_CLIENT_BUFFER_POOL_H_
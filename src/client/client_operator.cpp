@@ -22,6 +22,9 @@
 
 #include "client/client_operator.h"
 
+#include <butil/fast_rand.h>
+
+#include <atomic>
 #include <cstdint>
 #include <list>
 
@@ -46,18 +49,35 @@ using pb::metaserver::DentryFlag;
 using pb::metaserver::FsFileType;
 using pb::metaserver::InodeAttr;
 using pb::metaserver::MetaStatusCode;
+using stub::common::EncodeShardedTx;
+using stub::common::ShardedTxOp;
 
 #define LOG_ERROR(action, rc)                             \
   LOG(ERROR) << (action) << " failed, retCode = " << (rc) \
              << ", DebugString = " << DebugString();
 
+namespace {
+
+// The random base makes the id unique among clients without coordination.
+uint64_t NewShardedTxId() {
+  static std::atomic<uint64_t> next(butil::fast_rand());
+  uint64_t txId;
+  do {
+    txId = next.fetch_add(1, std::memory_order_relaxed);
+  } while (txId == 0);
+  return txId;
+}
+
+}  // namespace
+
 RenameOperator::RenameOperator(
     uint32_t fs_id, const std::string& fs_name, uint64_t parent_id,
     std::string name, uint64_t new_parent_id, std::string newname,
     std::shared_ptr<DentryCacheManager> dentry_manager,
     std::shared_ptr<InodeCacheManager> inode_manager,
     std::shared_ptr<MetaServerClient> meta_client,
-    std::shared_ptr<MdsClient> mds_client, bool enable_parallel)
+    std::shared_ptr<MdsClient> mds_client, bool enable_parallel,
+    bool enable_sharded_tx)
     : fsId_(fs_id),
       fsName_(fs_name),
       parentId_(parent_id),
@@ -75,7 +95,9 @@ RenameOperator::RenameOperator(
       metaClient_(meta_client),
       mdsClient_(mds_client),
       enableParallel_(enable_parallel),
-      sequence_(0) {}
+      sequence_(0),
+      enableShardedTx_(enable_sharded_tx),
+      shardedTxId_(0) {}
 
 std::string RenameOperator::DebugString() {
   std::ostringstream os;
@@ -90,7 +112,9 @@ std::string RenameOperator::DebugString() {
      << ", prepare dentry = [" << dentry_.ShortDebugString() << "]"
      << ", prepare new dentry = [" << newDentry_.ShortDebugString() << "]"
      << ", enableParallel = " << enableParallel_ << ", uuid = " << uuid_
-     << ", sequence = " << sequence_ << ")";
+     << ", sequence = " << sequence_
+     << ", enableShardedTx = " << enableShardedTx_
+     << ", shardedTxId = " << shardedTxId_ << ")";
   return os.str();
 }
 
@@ -120,7 +144,7 @@ DINGOFS_ERROR RenameOperator::GetLatestTxIdWithLock() {
 
 DINGOFS_ERROR RenameOperator::GetTxId() {
   DINGOFS_ERROR rc;
-  if (enableParallel_) {
+  if (enableParallel_ && !enableShardedTx_) {
     rc = GetLatestTxIdWithLock();
     if (rc != DINGOFS_ERROR::OK) {
       LOG_ERROR("GetLatestTxIdWithLock", rc);
@@ -224,6 +248,10 @@ DINGOFS_ERROR RenameOperator::PrepareRenameTx(
 }
 
 DINGOFS_ERROR RenameOperator::PrepareTx() {
+  if (enableShardedTx_) {
+    return PrepareShardedTx();
+  }
+
   dentry_ = Dentry(srcDentry_);
   dentry_.set_txid(srcTxId_ + 1);
   dentry_.set_txsequence(sequence_);
@@ -259,6 +287,10 @@ DINGOFS_ERROR RenameOperator::PrepareTx() {
 }
 
 DINGOFS_ERROR RenameOperator::CommitTx() {
+  if (enableShardedTx_) {
+    return CommitShardedTx();
+  }
+
   PartitionTxId partition_tx_id;
   std::vector<PartitionTxId> tx_ids;
 
@@ -286,6 +318,102 @@ DINGOFS_ERROR RenameOperator::CommitTx() {
   return DINGOFS_ERROR::OK;
 }
 
+MetaStatusCode RenameOperator::ShardedTxRequest(ShardedTxOp op,
+                                                size_t target) {
+  std::vector<Dentry> dentrys{dentry_, newDentry_};
+  return metaClient_->PrepareRenameTx(EncodeShardedTx(op, dentrys, target));
+}
+
+// The partition of old dentry is the coordinator and the partition of new
+// dentry is the participant, the participant is prepared before the
+// coordinator, so the commit on coordinator implies both are prepared.
+// The dentries keep the txid which the client seen, the metaserver replaces
+// all versions of the name when applying, so the txid of partition is never
+// advanced by the sharded transaction.
+DINGOFS_ERROR RenameOperator::PrepareShardedTx() {
+  shardedTxId_ = NewShardedTxId();
+
+  dentry_ = Dentry(srcDentry_);
+  dentry_.set_txid(srcTxId_);
+  dentry_.set_txsequence(shardedTxId_);
+  dentry_.set_flag(dentry_.flag() | DentryFlag::DELETE_MARK_FLAG);
+  dentry_.set_type(srcDentry_.type());
+
+  newDentry_ = Dentry(srcDentry_);
+  newDentry_.set_parentinodeid(newParentId_);
+  newDentry_.set_name(newname_);
+  newDentry_.set_txid(dstTxId_);
+  newDentry_.set_txsequence(shardedTxId_);
+  newDentry_.set_type(srcDentry_.type());
+
+  if (srcPartitionId_ == dstPartitionId_) {
+    return DINGOFS_ERROR::OK;
+  }
+
+  auto rc = ShardedTxRequest(ShardedTxOp::kPrepare, 1);
+  if (rc != MetaStatusCode::OK) {
+    LOG_ERROR("PrepareShardedTx", rc);
+    return ToFSError(rc);
+  }
+
+  rc = ShardedTxRequest(ShardedTxOp::kPrepare, 0);
+  if (rc != MetaStatusCode::OK) {
+    LOG_ERROR("PrepareShardedTx", rc);
+    // the rest is left to the RenameTxResolver if the abort fails
+    if (ShardedTxRequest(ShardedTxOp::kAbort, 0) == MetaStatusCode::OK) {
+      ShardedTxRequest(ShardedTxOp::kAbort, 1);
+    }
+  }
+  return ToFSError(rc);
+}
+
+// The commit on coordinator is the commit point of transaction. If its result
+// is unknown, abort on coordinator tells whether the transaction committed.
+// The coordinator keeps the decision until the participant finished, the
+// failure on participant is left to the RenameTxResolver of metaserver.
+DINGOFS_ERROR RenameOperator::CommitShardedTx() {
+  auto rc = ShardedTxRequest(ShardedTxOp::kCommit, 0);
+  bool committed = (rc == MetaStatusCode::OK);
+  if (!committed) {
+    LOG_ERROR("CommitShardedTx", rc);
+    auto ret = ShardedTxRequest(ShardedTxOp::kAbort, 0);
+    if (ret == MetaStatusCode::HANDLE_TX_FAILED) {
+      committed = true;
+    } else if (ret != MetaStatusCode::OK) {
+      LOG_ERROR("AbortShardedTx", ret);
+      return DINGOFS_ERROR::INTERNAL;
+    }
+  }
+
+  bool finished = true;
+  if (srcPartitionId_ != dstPartitionId_) {
+    auto op = committed ? ShardedTxOp::kCommit : ShardedTxOp::kAbort;
+    auto ret = ShardedTxRequest(op, 1);
+    if (ret != MetaStatusCode::OK) {
+      finished = false;
+      LOG(WARNING) << "Finish sharded rename tx on participant failed"
+                   << ", retCode = " << ret << ", committed = " << committed
+                   << ", DebugString = " << DebugString();
+    }
+  }
+
+  // the aborted decision is kept for fencing the late commit
+  if (committed && finished) {
+    auto ret = ShardedTxRequest(ShardedTxOp::kForget, 0);
+    if (ret != MetaStatusCode::OK) {
+      LOG(WARNING) << "Forget sharded rename tx on coordinator failed"
+                   << ", retCode = " << ret
+                   << ", DebugString = " << DebugString();
+    }
+  }
+
+  if (!committed) {
+    return rc == MetaStatusCode::HANDLE_TX_FAILED ? DINGOFS_ERROR::NOTEXIST
+                                                  : ToFSError(rc);
+  }
+  return DINGOFS_ERROR::OK;
+}
+
 DINGOFS_ERROR RenameOperator::LinkInode(uint64_t inode_id, uint64_t parent) {
   std::shared_ptr<InodeWrapper> inode_wrapper;
   auto rc = inodeManager_->GetInode(inode_id, inode_wrapper);
@@ -433,6 +561,10 @@ DINGOFS_ERROR RenameOperator::UpdateInodeCtime() {
 }
 
 void RenameOperator::UpdateCache() {
+  if (enableShardedTx_) {
+    return;
+  }
+
   SetTxId(srcPartitionId_, srcTxId_ + 1);
   SetTxId(dstPartitionId_, dstTxId_ + 1);
 }
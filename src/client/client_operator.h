@@ -29,6 +29,7 @@
 
 #include "client/dentry_cache_manager.h"
 #include "client/inode_cache_manager.h"
+#include "stub/common/rename_tx.h"
 #include "stub/rpcclient/mds_client.h"
 
 namespace dingofs {
@@ -47,7 +48,7 @@ class RenameOperator {
                  std::shared_ptr<InodeCacheManager> inode_manager,
                  std::shared_ptr<stub::rpcclient::MetaServerClient> meta_client,
                  std::shared_ptr<stub::rpcclient::MdsClient> mds_client,
-                 bool enable_parallel);
+                 bool enable_parallel, bool enable_sharded_tx = false);
 
   DINGOFS_ERROR GetTxId();
   DINGOFS_ERROR Precheck();
@@ -86,6 +87,14 @@ class RenameOperator {
   DINGOFS_ERROR PrepareRenameTx(
       const std::vector<pb::metaserver::Dentry>& dentrys);
 
+  // sharded rename transaction, see stub/common/rename_tx.h
+  DINGOFS_ERROR PrepareShardedTx();
+
+  DINGOFS_ERROR CommitShardedTx();
+
+  pb::metaserver::MetaStatusCode ShardedTxRequest(stub::common::ShardedTxOp op,
+                                                  size_t target);
+
   DINGOFS_ERROR LinkInode(uint64_t inode_id, uint64_t parent = 0);
 
   DINGOFS_ERROR UnLinkInode(uint64_t inode_id, uint64_t parent = 0);
@@ -129,6 +138,10 @@ class RenameOperator {
   bool enableParallel_;
   std::string uuid_;
   uint64_t sequence_;
+
+  // whether the transaction is coordinated by metaserver partitions
+  bool enableShardedTx_;
+  uint64_t shardedTxId_;
 };
 
 }  // namespace client
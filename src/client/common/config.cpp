@@ -59,6 +59,7 @@ using dingofs::utils::Configuration;
 
 using ::dingofs::base::string::StrSplit;
 using dingofs::stub::common::ExcutorOpt;
+using dingofs::stub::common::InodePlacementPolicy;
 using dingofs::stub::common::MetaCacheOpt;
 
 static bool pass_bool(const char*, bool) { return true; }
@@ -113,6 +114,17 @@ DEFINE_uint64(fuseClientBurstReadIopsSecs, 180,
               "the times that Read burst iops can continue");
 DEFINE_validator(fuseClientBurstReadIopsSecs, &pass_uint64);
 
+// Read the optional |key|, the |value| keeps its default if the key is not
+// found, so the conf of older version still works.
+template <typename T>
+static void GetValueOrDefault(Configuration* conf, const std::string& key,
+                              T* value) {
+  if (!conf->GetValue(key, value)) {
+    LOG(WARNING) << "Not found `" << key << "` in conf, use default value `"
+                 << std::boolalpha << *value << '`';
+  }
+}
+
 void InitMetaCacheOption(Configuration* conf, MetaCacheOpt* opts) {
   conf->GetValueFatalIfFail("metaCacheOpt.metacacheGetLeaderRetry",
                             &opts->metacacheGetLeaderRetry);
@@ -120,6 +132,18 @@ void InitMetaCacheOption(Configuration* conf, MetaCacheOpt* opts) {
                             &opts->metacacheRPCRetryIntervalUS);
   conf->GetValueFatalIfFail("metaCacheOpt.metacacheGetLeaderRPCTimeOutMS",
                             &opts->metacacheGetLeaderRPCTimeOutMS);
+
+  std::string policy;
+  if (!conf->GetStringValue("metaCacheOpt.inodePlacementPolicy", &policy)) {
+    LOG(WARNING) << "Not found `metaCacheOpt.inodePlacementPolicy` in conf, "
+                    "use default value `random`";
+  } else if (policy == "locality") {
+    opts->inodePlacementPolicy = InodePlacementPolicy::kLocality;
+  } else if (policy == "random") {
+    opts->inodePlacementPolicy = InodePlacementPolicy::kRandom;
+  } else {
+    LOG(FATAL) << "Invalid `metaCacheOpt.inodePlacementPolicy`: " << policy;
+  }
 }
 
 void InitExcutorOption(Configuration* conf, ExcutorOpt* opts, bool internal) {
@@ -153,6 +177,17 @@ void InitBlockDeviceOption(Configuration* conf,
   conf->GetValueFatalIfFail("bdev.confPath", &bdevOpt->configPath);
 }
 
+void InitChunkIdPoolOption(Configuration* conf, ChunkIdPoolOption* opt) {
+  GetValueOrDefault(conf, "s3.chunkIdPool.minBundleSize",
+                    &opt->minBundleSize);
+  GetValueOrDefault(conf, "s3.chunkIdPool.maxBundleSize",
+                    &opt->maxBundleSize);
+  GetValueOrDefault(conf, "s3.chunkIdPool.refillPercent",
+                    &opt->refillPercent);
+  GetValueOrDefault(conf, "s3.chunkIdPool.bundleLifetimeSec",
+                    &opt->bundleLifetimeSec);
+}
+
 void InitS3Option(Configuration* conf, S3Option* s3Opt) {
   conf->GetValueFatalIfFail("s3.fakeS3", &FLAGS_useFakeS3);
   conf->GetValueFatalIfFail("data_stream.page.size",
@@ -179,6 +214,7 @@ void InitS3Option(Configuration* conf, S3Option* s3Opt) {
                             &s3Opt->s3ClientAdaptorOpt.maxReadRetryIntervalMs);
   conf->GetValueFatalIfFail("s3.readRetryIntervalMs",
                             &s3Opt->s3ClientAdaptorOpt.readRetryIntervalMs);
+  InitChunkIdPoolOption(conf, &s3Opt->s3ClientAdaptorOpt.chunkIdPoolOpt);
   dingofs::aws::InitS3AdaptorOptionExceptS3InfoOption(conf,
                                                       &s3Opt->s3AdaptrOpt);
 }
@@ -230,6 +266,10 @@ void InitKVClientManagerOpt(Configuration* conf, KVClientManagerOpt* config) {
                             &config->setThreadPooln);
   conf->GetValueFatalIfFail("fuseClient.getThreadPool",
                             &config->getThreadPooln);
+  GetValueOrDefault(conf, "fuseClient.kvcache.getBatchMaxKeys",
+                    &config->getBatchMaxKeys);
+  GetValueOrDefault(conf, "fuseClient.kvcache.valueSplitSize",
+                    &config->valueSplitSize);
 }
 
 void InitFileSystemOption(Configuration* c, FileSystemOption* option) {
@@ -248,6 +288,17 @@ void InitFileSystemOption(Configuration* c, FileSystemOption* option) {
                            &o->entryTimeoutSec);
     c->GetValueFatalIfFail("fs.kernelCache.dirEntryTimeoutSec",
                            &o->dirEntryTimeoutSec);
+    GetValueOrDefault(c, "fs.kernelCache.writeback", &o->writeback);
+    GetValueOrDefault(c, "fs.kernelCache.activeInvalidate",
+                      &o->activeInvalidate);
+    GetValueOrDefault(c, "fs.kernelCache.invalidateTimeoutSec",
+                      &o->invalidateTimeoutSec);
+    GetValueOrDefault(c, "fs.kernelCache.invalidateIntervalMs",
+                      &o->invalidateIntervalMs);
+    GetValueOrDefault(c, "fs.kernelCache.invalidateBatchSize",
+                      &o->invalidateBatchSize);
+    GetValueOrDefault(c, "fs.kernelCache.invalidateWatchSize",
+                      &o->invalidateWatchSize);
   }
   {  // lookup cache option
     auto o = &option->lookupCacheOption;
@@ -256,9 +307,15 @@ void InitFileSystemOption(Configuration* c, FileSystemOption* option) {
                            &o->negativeTimeoutSec);
     c->GetValueFatalIfFail("fs.lookupCache.minUses", &o->minUses);
   }
+  {  // dentry cache option
+    auto o = &option->dentryCacheOption;
+    GetValueOrDefault(c, "fs.dentryCache.lruSize", &o->lruSize);
+    GetValueOrDefault(c, "fs.dentryCache.timeoutSec", &o->timeoutSec);
+  }
   {  // dir cache option
     auto o = &option->dirCacheOption;
     c->GetValueFatalIfFail("fs.dirCache.lruSize", &o->lruSize);
+    GetValueOrDefault(c, "fs.dirCache.capacityMB", &o->capacityMB);
   }
   {  // attr watcher option
     auto o = &option->attrWatcherOption;
@@ -273,6 +330,12 @@ void InitFileSystemOption(Configuration* c, FileSystemOption* option) {
     c->GetValueFatalIfFail("fs.deferSync.delay", &o->delay);
     c->GetValueFatalIfFail("fs.deferSync.deferDirMtime", &o->deferDirMtime);
   }
+  {  // access log option
+    auto o = &option->accessLogOption;
+    GetValueOrDefault(c, "fs.accessLog.async", &o->async);
+    GetValueOrDefault(c, "fs.accessLog.binary", &o->binary);
+    GetValueOrDefault(c, "fs.accessLog.bufferSize", &o->bufferSize);
+  }
 }
 
 void InitDataStreamOption(Configuration* c, DataStreamOption* option) {
@@ -287,6 +350,9 @@ void InitDataStreamOption(Configuration* c, DataStreamOption* option) {
     c->GetValueFatalIfFail("data_stream.file.flush_workers", &o->flush_workers);
     c->GetValueFatalIfFail("data_stream.file.flush_queue_size",
                            &o->flush_queue_size);
+    GetValueOrDefault(c, "data_stream.file.inode_affinity",
+                      &o->inode_affinity);
+    GetValueOrDefault(c, "data_stream.file.bind_cpu", &o->bind_cpu);
   }
   {  // chunk option
     auto* o = &option->chunk_option;
@@ -324,6 +390,34 @@ void InitDataStreamOption(Configuration* c, DataStreamOption* option) {
                       "before force flush.";
     }
   }
+  {  // flush pipeline option
+    auto* o = &option->flush_pipeline_option;
+    uint64_t inode_max_inflight_mb = 128;
+    uint64_t max_inflight_mb = 512;
+    GetValueOrDefault(c, "data_stream.flush_pipeline.enable", &o->enable);
+    GetValueOrDefault(c, "data_stream.flush_pipeline.slice_workers",
+                      &o->slice_workers);
+    GetValueOrDefault(c, "data_stream.flush_pipeline.encode_workers",
+                      &o->encode_workers);
+    GetValueOrDefault(c, "data_stream.flush_pipeline.upload_workers",
+                      &o->upload_workers);
+    GetValueOrDefault(c, "data_stream.flush_pipeline.commit_workers",
+                      &o->commit_workers);
+    GetValueOrDefault(c, "data_stream.flush_pipeline.queue_size",
+                      &o->queue_size);
+    GetValueOrDefault(c, "data_stream.flush_pipeline.inode_max_inflight_mb",
+                      &inode_max_inflight_mb);
+    GetValueOrDefault(c, "data_stream.flush_pipeline.max_inflight_mb",
+                      &max_inflight_mb);
+
+    o->inode_max_inflight_bytes = inode_max_inflight_mb * kMiB;
+    o->max_inflight_bytes = max_inflight_mb * kMiB;
+    if (o->inode_max_inflight_bytes == 0 ||
+        o->max_inflight_bytes < o->inode_max_inflight_bytes) {
+      CHECK(false) << "Flush pipeline max in-flight size must greater than "
+                      "per inode in-flight size.";
+    }
+  }
 }
 
 namespace {
@@ -401,6 +495,29 @@ void InitBlockCacheOption(Configuration* c, BlockCacheOption* option) {
   }
 }
 
+void InitWarmupOption(Configuration* c, WarmupOption* option) {
+  GetValueOrDefault(c, "warmup.download_workers", &option->download_workers);
+  GetValueOrDefault(c, "warmup.bandwidth_mb", &option->bandwidth_bytes);
+  option->bandwidth_bytes = option->bandwidth_bytes * kMiB;
+  GetValueOrDefault(c, "warmup.iops", &option->iops);
+  GetValueOrDefault(c, "warmup.checkpoint_dir", &option->checkpoint_dir);
+  GetValueOrDefault(c, "warmup.replay_profile", &option->replay_profile);
+  GetValueOrDefault(c, "warmup.replay_distance", &option->replay_distance);
+  CHECK(option->download_workers > 0)
+      << "Option warmup.download_workers must greater than 0.";
+}
+
+void InitAccessTraceOption(Configuration* c, AccessTraceOption* option) {
+  GetValueOrDefault(c, "access_trace.record", &option->record);
+  GetValueOrDefault(c, "access_trace.profile_dir", &option->profile_dir);
+  GetValueOrDefault(c, "access_trace.max_records", &option->max_records);
+}
+
+void InitFuseWorkerOption(Configuration* c, FuseWorkerOption* option) {
+  GetValueOrDefault(c, "fuse_worker.bind_cpu", &option->bind_cpu);
+  GetValueOrDefault(c, "fuse_worker.workers", &option->workers);
+}
+
 void SetBrpcOpt(Configuration* conf) {
   dingofs::utils::GflagsLoadValueFromConfIfCmdNotSet dummy;
   dummy.Load(conf, "defer_close_second", "rpc.defer.close.second",
@@ -424,6 +541,9 @@ void InitFuseClientOption(Configuration* conf, FuseClientOption* clientOption) {
   InitFileSystemOption(conf, &clientOption->fileSystemOption);
   InitDataStreamOption(conf, &clientOption->data_stream_option);
   InitBlockCacheOption(conf, &clientOption->block_cache_option);
+  InitWarmupOption(conf, &clientOption->warmup_option);
+  InitAccessTraceOption(conf, &clientOption->access_trace_option);
+  InitFuseWorkerOption(conf, &clientOption->fuse_worker_option);
 
   conf->GetValueFatalIfFail("fuseClient.listDentryLimit",
                             &clientOption->listDentryLimit);
@@ -441,6 +561,17 @@ void InitFuseClientOption(Configuration* conf, FuseClientOption* clientOption) {
                                      &clientOption->enableFuseSplice))
       << "Not found `fuseClient.enableSplice` in conf, use default value `"
       << std::boolalpha << clientOption->enableFuseSplice << '`';
+  LOG_IF(WARNING, !conf->GetBoolValue("fuseClient.enableShardedRenameTx",
+                                      &clientOption->enableShardedRenameTx))
+      << "Not found `fuseClient.enableShardedRenameTx` in conf, "
+         "use default value `"
+      << std::boolalpha << clientOption->enableShardedRenameTx << '`';
+  if (clientOption->enableShardedRenameTx) {
+    // the sharded transaction never advances the txid of partitions,
+    // so it's unnecessary to refresh them from mds
+    clientOption->excutorOpt.enableRenameParallel = false;
+    clientOption->excutorInternalOpt.enableRenameParallel = false;
+  }
 
   conf->GetValueFatalIfFail("fuseClient.throttle.avgWriteBytes",
                             &FLAGS_fuseClientAvgWriteBytes);
@@ -54,6 +54,20 @@ struct SpaceAllocServerOption {
 struct KVClientManagerOpt {
   int setThreadPooln = 4;
   int getThreadPooln = 4;
+  // max number of get tasks which batched into one multi-get
+  uint32_t getBatchMaxKeys = 32;
+  // value larger than it will be split over several keys, 0 means no split
+  uint64_t valueSplitSize = 0;
+};
+
+struct ChunkIdPoolOption {
+  // min number of chunk ids fetched from mds at once, 0 means disabled
+  uint32_t minBundleSize = 0;
+  uint32_t maxBundleSize = 65536;
+  // fetch the next range when less than this percent of ids left
+  uint32_t refillPercent = 25;
+  // adjust the size of range to last about this long
+  uint32_t bundleLifetimeSec = 10;
 };
 
 struct S3ClientAdaptorOption {
@@ -72,6 +86,7 @@ struct S3ClientAdaptorOption {
   uint32_t maxReadRetryIntervalMs;
   uint32_t readRetryIntervalMs;
   uint32_t objectPrefix;
+  ChunkIdPoolOption chunkIdPoolOpt;
 };
 
 struct S3Option {
@@ -116,6 +131,15 @@ struct KernelCacheOption {
   uint32_t dirEntryTimeoutSec;
   uint32_t attrTimeoutSec;
   uint32_t dirAttrTimeoutSec;
+  // enable the writeback cache of kernel
+  bool writeback = false;
+  // reply with |invalidateTimeoutSec| and invalidate the kernel cache
+  // actively once the watched inode changed
+  bool activeInvalidate = false;
+  uint32_t invalidateTimeoutSec = 3600;
+  uint32_t invalidateIntervalMs = 1000;
+  uint32_t invalidateBatchSize = 1000;
+  uint64_t invalidateWatchSize = 60000;
 };
 
 struct LookupCacheOption {
@@ -124,9 +148,15 @@ struct LookupCacheOption {
   uint32_t minUses;
 };
 
+struct DentryCacheOption {
+  uint64_t lruSize = 1000000;
+  uint32_t timeoutSec = 0;  // disabled
+};
+
 struct DirCacheOption {
   uint64_t lruSize;
   uint32_t timeoutSec;
+  uint64_t capacityMB = 1024;
 };
 
 struct AttrWatcherOption {
@@ -147,6 +177,12 @@ struct DeferSyncOption {
   bool deferDirMtime;
 };
 
+struct AccessLogOption {
+  bool async = false;
+  bool binary = false;
+  uint32_t bufferSize = 8192;  // the number of records buffered per thread
+};
+
 struct FileSystemOption {
   bool cto;
   std::string nocto_suffix;
@@ -155,11 +191,13 @@ struct FileSystemOption {
   uint32_t blockSize = 0x10000u;
   KernelCacheOption kernelCacheOption;
   LookupCacheOption lookupCacheOption;
+  DentryCacheOption dentryCacheOption;
   DirCacheOption dirCacheOption;
   OpenFilesOption openFilesOption;
   AttrWatcherOption attrWatcherOption;
   RPCOption rpcOption;
   DeferSyncOption deferSyncOption;
+  AccessLogOption accessLogOption;
 };
 // }
 
@@ -171,6 +209,8 @@ struct BackgroundFlushOption {
 struct FileOption {
   uint64_t flush_workers;
   uint64_t flush_queue_size;
+  bool inode_affinity = false;  // flush the same inode on the same worker
+  bool bind_cpu = false;
 };
 
 struct SliceOption {
@@ -189,12 +229,24 @@ struct PageOption {
   bool use_pool;
 };
 
+struct FlushPipelineOption {
+  bool enable = false;
+  uint64_t slice_workers = 4;
+  uint64_t encode_workers = 4;
+  uint64_t upload_workers = 32;
+  uint64_t commit_workers = 4;
+  uint64_t queue_size = 10000;
+  uint64_t inode_max_inflight_bytes;
+  uint64_t max_inflight_bytes;
+};
+
 struct DataStreamOption {
   BackgroundFlushOption background_flush_option;
   FileOption file_option;
   ChunkOption chunk_option;
   SliceOption slice_option;
   PageOption page_option;
+  FlushPipelineOption flush_pipeline_option;
 };
 // }
 
@@ -220,6 +272,30 @@ struct BlockCacheOption {
 };
 // }
 
+// { warmup option
+struct WarmupOption {
+  uint32_t download_workers = 16;
+  uint64_t bandwidth_bytes = 0;  // 0 means no limit
+  uint64_t iops = 0;             // 0 means no limit
+  std::string checkpoint_dir;    // empty means disable checkpoint
+  bool replay_profile = false;   // replay the recorded access profile
+  uint64_t replay_distance = 64;  // blocks prefetched ahead of reader
+};
+
+struct AccessTraceOption {
+  bool record = false;
+  std::string profile_dir;
+  uint64_t max_records = 0;
+};
+// }
+
+// { fuse worker option
+struct FuseWorkerOption {
+  bool bind_cpu = false;
+  uint32_t workers = 0;  // 0 means the number of usable cpus
+};
+// }
+
 struct FuseClientOption {
   stub::common::MdsOption mdsOpt;
   stub::common::MetaCacheOpt metaCacheOpt;
@@ -236,11 +312,15 @@ struct FuseClientOption {
   FileSystemOption fileSystemOption;
   DataStreamOption data_stream_option;
   BlockCacheOption block_cache_option;
+  WarmupOption warmup_option;
+  AccessTraceOption access_trace_option;
+  FuseWorkerOption fuse_worker_option;
 
   uint32_t listDentryLimit;
   uint32_t listDentryThreads;
   uint32_t dummyServerStartPort;
   bool enableMultiMountPointRename = false;
+  bool enableShardedRenameTx = false;
   bool enableFuseSplice = false;
   uint32_t downloadMaxRetryTimes;
   uint32_t warmupThreadsNum = 10;
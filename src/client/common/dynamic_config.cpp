@@ -111,6 +111,10 @@ DEFINE_uint32(fuse_read_max_retry_s3_not_exist, 60,
               "fuse read max retry when s3 object not exist");
 DEFINE_validator(fuse_read_max_retry_s3_not_exist, &PassUint32);
 
+DEFINE_uint32(fuse_buffer_pool_max_cached_mb, 256,
+              "max size of reply buffers cached by all fuse threads in MiB");
+DEFINE_validator(fuse_buffer_pool_max_cached_mb, &PassUint32);
+
 }  // namespace common
 }  // namespace client
 }  // namespace dingofs
@@ -71,6 +71,7 @@ DECLARE_uint32(push_metric_interval_millsecond);
 
 // fuse client
 DECLARE_uint32(fuse_read_max_retry_s3_not_exist);
+DECLARE_uint32(fuse_buffer_pool_max_cached_mb);
 
 }  // namespace common
 }  // namespace client
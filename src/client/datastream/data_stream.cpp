@@ -26,8 +26,10 @@
 
 #include <cassert>
 #include <cstring>
+#include <utility>
 
 #include "client/common/config.h"
+#include "client/datastream/flush_pipeline.h"
 #include "client/datastream/metric.h"
 #include "client/datastream/page_allocator.h"
 
@@ -42,9 +44,14 @@ bool DataStream::Init(DataStreamOption option) {
   {
     auto o = option.file_option;
     flush_file_thread_pool_ =
-        std::make_shared<TaskThreadPool<>>("flush_file_worker");
-    auto rc =
-        flush_file_thread_pool_->Start(o.flush_workers, o.flush_queue_size);
+        std::make_shared<ShardedTaskPool>("flush_file_worker");
+    // one shard per worker, or one shard shared by all workers
+    int rc = o.inode_affinity
+                 ? flush_file_thread_pool_->Start(o.flush_workers, 1,
+                                                  o.flush_queue_size,
+                                                  o.bind_cpu)
+                 : flush_file_thread_pool_->Start(1, o.flush_workers,
+                                                  o.flush_queue_size);
     if (rc != 0) {
       LOG(ERROR) << "Start flush file thread pool failed, rc = " << rc;
       return false;
@@ -93,12 +100,25 @@ bool DataStream::Init(DataStreamOption option) {
     }
   }
 
+  // flush pipeline
+  {
+    auto o = option.flush_pipeline_option;
+    if (o.enable) {
+      flush_pipeline_ = std::make_shared<FlushPipeline>();
+      if (!flush_pipeline_->Start(o)) {
+        LOG(ERROR) << "Start flush pipeline failed.";
+        return false;
+      }
+    }
+  }
+
   // metric
   auto aux_members = DataStreamMetric::AuxMembers{
       .flush_file_thread_pool = flush_file_thread_pool_,
       .flush_chunk_thread_pool = flush_chunk_thread_pool_,
       .flush_slice_thread_pool = flush_slice_thread_pool_,
       .page_allocator = page_allocator_,
+      .flush_pipeline = flush_pipeline_,
   };
   metric_ = std::make_unique<DataStreamMetric>(option, aux_members);
   return true;
@@ -108,10 +128,13 @@ void DataStream::Shutdown() {
   flush_file_thread_pool_->Stop();
   flush_chunk_thread_pool_->Stop();
   flush_slice_thread_pool_->Stop();
+  if (flush_pipeline_ != nullptr) {
+    flush_pipeline_->Stop();
+  }
 }
 
-void DataStream::EnterFlushFileQueue(TaskFunc task) {
-  flush_file_thread_pool_->Enqueue(task);
+void DataStream::EnterFlushFileQueue(uint64_t ino, TaskFunc task) {
+  flush_file_thread_pool_->Enqueue(ino, task);
 }
 
 void DataStream::EnterFlushChunkQueue(TaskFunc task) {
@@ -122,6 +145,12 @@ void DataStream::EnterFlushSliceQueue(TaskFunc task) {
   flush_slice_thread_pool_->Enqueue(task);
 }
 
+bool DataStream::FlushPipelineEnabled() { return flush_pipeline_ != nullptr; }
+
+void DataStream::EnterFlushPipeline(FlushSliceTask task) {
+  flush_pipeline_->Submit(std::move(task));
+}
+
 char* DataStream::NewPage() { return page_allocator_->Allocate(); }
 
 void DataStream::FreePage(char* page) { page_allocator_->DeAllocate(page); }
@@ -28,14 +28,17 @@
 #include <memory>
 
 #include "client/common/config.h"
+#include "client/datastream/flush_pipeline.h"
 #include "client/datastream/metric.h"
 #include "client/datastream/page_allocator.h"
+#include "utils/concurrent/sharded_task_pool.h"
 #include "utils/concurrent/task_thread_pool.h"
 
 namespace dingofs {
 namespace client {
 namespace datastream {
 
+using ::dingofs::utils::ShardedTaskPool;
 using ::dingofs::utils::TaskThreadPool;
 using ::dingofs::client::common::DataStreamOption;
 
@@ -53,12 +56,18 @@ class DataStream {
 
   void Shutdown();
 
-  void EnterFlushFileQueue(TaskFunc task);
+  // the flush tasks of the same inode run on the same worker if
+  // `inode_affinity` is enabled
+  void EnterFlushFileQueue(uint64_t ino, TaskFunc task);
 
   void EnterFlushChunkQueue(TaskFunc task);
 
   void EnterFlushSliceQueue(TaskFunc task);
 
+  bool FlushPipelineEnabled();
+
+  void EnterFlushPipeline(FlushSliceTask task);
+
   char* NewPage();
 
   void FreePage(char* p);
@@ -66,10 +75,11 @@ class DataStream {
   bool MemoryNearFull();
 
  private:
-  std::shared_ptr<TaskThreadPool<>> flush_file_thread_pool_;
+  std::shared_ptr<ShardedTaskPool> flush_file_thread_pool_;
   std::shared_ptr<TaskThreadPool<>> flush_chunk_thread_pool_;
   std::shared_ptr<TaskThreadPool<>> flush_slice_thread_pool_;
   std::shared_ptr<PageAllocator> page_allocator_;
+  std::shared_ptr<FlushPipeline> flush_pipeline_;
   std::unique_ptr<DataStreamMetric> metric_;
   DataStreamOption option_;
 };
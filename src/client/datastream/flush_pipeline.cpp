@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/datastream/flush_pipeline.h"
+
+#include <glog/logging.h>
+#include <malloc.h>
+
+#include <cstdlib>
+#include <utility>
+
+namespace dingofs {
+namespace client {
+namespace datastream {
+
+// the block buffer is aligned, so block cache can write it with direct io
+static constexpr uint64_t kBufferAlignment = 4096;
+
+InflightBudget::InflightBudget(uint64_t inode_limit, uint64_t total_limit)
+    : inode_limit_(inode_limit), total_limit_(total_limit), total_inflight_(0) {}
+
+bool InflightBudget::CanAcquire(uint64_t ino, uint64_t bytes) {
+  if (total_inflight_ > 0 && total_inflight_ + bytes > total_limit_) {
+    return false;
+  }
+
+  auto iter = inode_inflight_.find(ino);
+  if (iter != inode_inflight_.end() && iter->second > 0 &&
+      iter->second + bytes > inode_limit_) {
+    return false;
+  }
+  return true;
+}
+
+void InflightBudget::Acquire(uint64_t ino, uint64_t bytes) {
+  std::unique_lock<std::mutex> lk(mutex_);
+  cond_.wait(lk, [&]() { return CanAcquire(ino, bytes); });
+  total_inflight_ += bytes;
+  inode_inflight_[ino] += bytes;
+}
+
+void InflightBudget::Release(uint64_t ino, uint64_t bytes) {
+  {
+    std::unique_lock<std::mutex> lk(mutex_);
+    total_inflight_ -= bytes;
+    auto iter = inode_inflight_.find(ino);
+    CHECK(iter != inode_inflight_.end() && iter->second >= bytes);
+    iter->second -= bytes;
+    if (iter->second == 0) {
+      inode_inflight_.erase(iter);
+    }
+  }
+  cond_.notify_all();
+}
+
+uint64_t InflightBudget::InflightBytes() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  return total_inflight_;
+}
+
+uint64_t InflightBudget::InflightBytes(uint64_t ino) {
+  std::unique_lock<std::mutex> lk(mutex_);
+  auto iter = inode_inflight_.find(ino);
+  return iter == inode_inflight_.end() ? 0 : iter->second;
+}
+
+struct FlushPipeline::SliceContext {
+  SliceContext(FlushSliceTask task, uint64_t seq)
+      : task(std::move(task)), seq(seq), pending_blocks(0) {}
+
+  FlushSliceTask task;
+  uint64_t seq;
+  std::atomic<uint64_t> pending_blocks;
+};
+
+FlushPipeline::FlushPipeline() : running_(false), inflight_slices_(0) {}
+
+bool FlushPipeline::Start(FlushPipelineOption option) {
+  if (running_.exchange(true)) {
+    return true;
+  }
+
+  option_ = option;
+  budget_ = std::make_unique<InflightBudget>(option.inode_max_inflight_bytes,
+                                             option.max_inflight_bytes);
+
+  struct Stage {
+    std::unique_ptr<TaskThreadPool<>>* pool;
+    const char* name;
+    uint64_t workers;
+  };
+  std::vector<Stage> stages{
+      {&slice_thread_pool_, "flush_pipe_slice", option.slice_workers},
+      {&encode_thread_pool_, "flush_pipe_encode", option.encode_workers},
+      {&upload_thread_pool_, "flush_pipe_upload", option.upload_workers},
+      {&commit_thread_pool_, "flush_pipe_commit", option.commit_workers},
+  };
+  for (auto& stage : stages) {
+    *stage.pool = std::make_unique<TaskThreadPool<>>(stage.name);
+    auto rc = (*stage.pool)->Start(stage.workers, option.queue_size);
+    if (rc != 0) {
+      LOG(ERROR) << "Start " << stage.name
+                 << " thread pool failed, rc = " << rc;
+      return false;
+    }
+  }
+  return true;
+}
+
+void FlushPipeline::Stop() {
+  if (!running_.exchange(false)) {
+    return;
+  }
+
+  slice_thread_pool_->Stop();
+  encode_thread_pool_->Stop();
+  upload_thread_pool_->Stop();
+  commit_thread_pool_->Stop();
+}
+
+void FlushPipeline::Submit(FlushSliceTask task) {
+  uint64_t ino = task.ino;
+  uint64_t seq;
+  {
+    std::unique_lock<std::mutex> lk(commit_mutex_);
+    seq = commit_queues_[ino].next_submit_seq++;
+  }
+
+  inflight_slices_.fetch_add(1, std::memory_order_relaxed);
+  auto ctx = std::make_shared<SliceContext>(std::move(task), seq);
+  ctx->pending_blocks.store(ctx->task.blocks.size());
+  if (ctx->task.blocks.empty()) {
+    CommitReady(ctx);
+    return;
+  }
+  slice_thread_pool_->Enqueue([this, ctx]() { SliceStage(ctx); });
+}
+
+void FlushPipeline::SliceStage(SliceContextPtr ctx) {
+  for (size_t i = 0; i < ctx->task.blocks.size(); i++) {
+    budget_->Acquire(ctx->task.ino, ctx->task.blocks[i].length);
+    encode_thread_pool_->Enqueue([this, ctx, i]() { EncodeStage(ctx, i); });
+  }
+}
+
+void FlushPipeline::EncodeStage(SliceContextPtr ctx, size_t index) {
+  auto& block = ctx->task.blocks[index];
+  char* buffer =
+      reinterpret_cast<char*>(memalign(kBufferAlignment, block.length));
+  CHECK(buffer != nullptr) << "Allocate flush buffer failed.";
+  block.encode(buffer);
+  upload_thread_pool_->Enqueue(
+      [this, ctx, index, buffer]() { UploadStage(ctx, index, buffer); });
+}
+
+void FlushPipeline::UploadStage(SliceContextPtr ctx, size_t index,
+                                char* buffer) {
+  auto& block = ctx->task.blocks[index];
+  block.upload(buffer);
+  free(buffer);
+  budget_->Release(ctx->task.ino, block.length);
+
+  if (ctx->pending_blocks.fetch_sub(1) == 1) {
+    CommitReady(ctx);
+  }
+}
+
+void FlushPipeline::CommitReady(SliceContextPtr ctx) {
+  uint64_t ino = ctx->task.ino;
+  bool schedule = false;
+  {
+    std::unique_lock<std::mutex> lk(commit_mutex_);
+    auto& queue = commit_queues_[ino];
+    queue.ready.emplace(ctx->seq, ctx);
+    if (!queue.committing && ctx->seq == queue.next_commit_seq) {
+      queue.committing = true;
+      schedule = true;
+    }
+  }
+
+  if (schedule) {
+    commit_thread_pool_->Enqueue([this, ino]() { CommitStage(ino); });
+  }
+}
+
+// Only one commit task is running for an inode at any time, and it drains
+// all slices which are ready in sequence.
+void FlushPipeline::CommitStage(uint64_t ino) {
+  for (;;) {
+    SliceContextPtr ctx;
+    {
+      std::unique_lock<std::mutex> lk(commit_mutex_);
+      auto iter = commit_queues_.find(ino);
+      CHECK(iter != commit_queues_.end());
+      auto& queue = iter->second;
+      auto it = queue.ready.begin();
+      if (it == queue.ready.end() || it->first != queue.next_commit_seq) {
+        queue.committing = false;
+        if (queue.ready.empty() &&
+            queue.next_commit_seq == queue.next_submit_seq) {
+          commit_queues_.erase(iter);
+        }
+        return;
+      }
+      ctx = it->second;
+      queue.ready.erase(it);
+      queue.next_commit_seq++;
+    }
+
+    if (ctx->task.commit) {
+      ctx->task.commit();
+    }
+    inflight_slices_.fetch_sub(1, std::memory_order_relaxed);
+    if (ctx->task.done) {
+      ctx->task.done();
+    }
+  }
+}
+
+uint64_t FlushPipeline::InflightBytes() { return budget_->InflightBytes(); }
+
+uint64_t FlushPipeline::InflightSlices() {
+  return inflight_slices_.load(std::memory_order_relaxed);
+}
+
+}  // namespace datastream
+}  // namespace client
+}  // namespace dingofs
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_CLIENT_DATASTREAM_FLUSH_PIPELINE_H_
+#define DINGOFS_SRC_CLIENT_DATASTREAM_FLUSH_PIPELINE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "client/common/config.h"
+#include "utils/concurrent/task_thread_pool.h"
+
+namespace dingofs {
+namespace client {
+namespace datastream {
+
+using ::dingofs::client::common::FlushPipelineOption;
+using ::dingofs::utils::TaskThreadPool;
+
+// The in-flight bytes budget of flushing, which bounded by per-inode and
+// global limits. A request larger than the limit is granted only when nothing
+// else is in flight for the same scope, so huge blocks never deadlock.
+class InflightBudget {
+ public:
+  InflightBudget(uint64_t inode_limit, uint64_t total_limit);
+
+  void Acquire(uint64_t ino, uint64_t bytes);
+
+  void Release(uint64_t ino, uint64_t bytes);
+
+  uint64_t InflightBytes();
+
+  uint64_t InflightBytes(uint64_t ino);
+
+ private:
+  bool CanAcquire(uint64_t ino, uint64_t bytes);
+
+ private:
+  uint64_t inode_limit_;
+  uint64_t total_limit_;
+  uint64_t total_inflight_;
+  std::unordered_map<uint64_t, uint64_t> inode_inflight_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+};
+
+// The flush of one block in slice:
+//   encode: copy (and transform if needed) block data into the buffer
+//   upload: put the encoded buffer to block cache (stage) or s3
+struct FlushBlockTask {
+  uint64_t length;
+  std::function<void(char* buffer)> encode;
+  std::function<void(const char* buffer)> upload;
+};
+
+// The flush of one slice (a DataCache of chunk):
+//   commit: update the metadata (e.g. S3ChunkInfo) of inode, the commits
+//           of the same inode are executed in submit order
+//   done: invoked after commit
+struct FlushSliceTask {
+  uint64_t ino;
+  std::vector<FlushBlockTask> blocks;
+  std::function<void()> commit;
+  std::function<void()> done;
+};
+
+// Pipelined flush engine, the slice flows through below stages:
+//
+//   slice  -> split into blocks and acquire in-flight budget
+//   encode -> copy block data into its own buffer
+//   upload -> put block to block cache, blocks are uploaded in parallel
+//   commit -> update metadata, ordered by submit sequence per inode
+//
+// Each stage has its own thread pool (queue), so one file's flush can
+// keep many blocks in flight while the metadata ordering is preserved.
+class FlushPipeline {
+  struct SliceContext;
+  using SliceContextPtr = std::shared_ptr<SliceContext>;
+
+  struct InodeCommitQueue {
+    uint64_t next_submit_seq{0};
+    uint64_t next_commit_seq{0};
+    bool committing{false};
+    std::map<uint64_t, SliceContextPtr> ready;
+  };
+
+ public:
+  FlushPipeline();
+
+  virtual ~FlushPipeline() = default;
+
+  bool Start(FlushPipelineOption option);
+
+  void Stop();
+
+  void Submit(FlushSliceTask task);
+
+  uint64_t InflightBytes();
+
+  uint64_t InflightSlices();
+
+ private:
+  void SliceStage(SliceContextPtr ctx);
+
+  void EncodeStage(SliceContextPtr ctx, size_t index);
+
+  void UploadStage(SliceContextPtr ctx, size_t index, char* buffer);
+
+  void CommitReady(SliceContextPtr ctx);
+
+  void CommitStage(uint64_t ino);
+
+ private:
+  std::atomic<bool> running_;
+  std::atomic<uint64_t> inflight_slices_;
+  FlushPipelineOption option_;
+  std::unique_ptr<InflightBudget> budget_;
+  std::unique_ptr<TaskThreadPool<>> slice_thread_pool_;
+  std::unique_ptr<TaskThreadPool<>> encode_thread_pool_;
+  std::unique_ptr<TaskThreadPool<>> upload_thread_pool_;
+  std::unique_ptr<TaskThreadPool<>> commit_thread_pool_;
+  std::mutex commit_mutex_;
+  std::unordered_map<uint64_t, InodeCommitQueue> commit_queues_;
+};
+
+}  // namespace datastream
+}  // namespace client
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_CLIENT_DATASTREAM_FLUSH_PIPELINE_H_
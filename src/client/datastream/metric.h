@@ -29,13 +29,16 @@
 #include <memory>
 
 #include "client/common/config.h"
+#include "client/datastream/flush_pipeline.h"
 #include "client/datastream/page_allocator.h"
+#include "utils/concurrent/sharded_task_pool.h"
 #include "utils/concurrent/task_thread_pool.h"
 
 namespace dingofs {
 namespace client {
 namespace datastream {
 
+using ::dingofs::utils::ShardedTaskPool;
 using ::dingofs::utils::TaskThreadPool;
 using ::dingofs::client::common::DataStreamOption;
 
@@ -44,18 +47,34 @@ static uint32_t GetQueueSize(void* arg) {
   return thread_pool->QueueSize();
 }
 
+static uint32_t GetShardedQueueSize(void* arg) {
+  auto* thread_pool = reinterpret_cast<ShardedTaskPool*>(arg);
+  return thread_pool->QueueSize();
+}
+
 static uint64_t GetFreePages(void* arg) {
   auto* page_allocator = reinterpret_cast<PageAllocator*>(arg);
   return page_allocator->GetFreePages();
 }
 
+static uint64_t GetFlushPipelineInflightBytes(void* arg) {
+  auto* flush_pipeline = reinterpret_cast<FlushPipeline*>(arg);
+  return flush_pipeline == nullptr ? 0 : flush_pipeline->InflightBytes();
+}
+
+static uint64_t GetFlushPipelineInflightSlices(void* arg) {
+  auto* flush_pipeline = reinterpret_cast<FlushPipeline*>(arg);
+  return flush_pipeline == nullptr ? 0 : flush_pipeline->InflightSlices();
+}
+
 class DataStreamMetric {
  public:
   struct AuxMembers {
-    std::shared_ptr<TaskThreadPool<>> flush_file_thread_pool;
+    std::shared_ptr<ShardedTaskPool> flush_file_thread_pool;
     std::shared_ptr<TaskThreadPool<>> flush_chunk_thread_pool;
     std::shared_ptr<TaskThreadPool<>> flush_slice_thread_pool;
     std::shared_ptr<PageAllocator> page_allocator;
+    std::shared_ptr<FlushPipeline> flush_pipeline;
   };
 
  public:
@@ -87,6 +106,12 @@ class DataStreamMetric {
       auto o = option.page_option;
       metric_.use_page_pool.set_value(o.use_pool);
     }
+
+    // flush pipeline
+    {
+      auto o = option.flush_pipeline_option;
+      metric_.use_flush_pipeline.set_value(o.enable);
+    }
   }
 
   virtual ~DataStreamMetric() = default;
@@ -98,7 +123,7 @@ class DataStreamMetric {
           flush_file_workers(prefix, "flush_file_workers", 0),
           flush_file_queue_capacity(prefix, "flush_file_queue_capacity", 0),
           flush_file_pending_tasks(prefix, "flush_file_pending_tasks",
-                                   &GetQueueSize,
+                                   &GetShardedQueueSize,
                                    aux_members.flush_file_thread_pool.get()),
           // chunk
           flush_chunk_workers(prefix, "flush_chunk_workers", 0),
@@ -115,7 +140,17 @@ class DataStreamMetric {
           // page
           use_page_pool(prefix, "use_page_pool", false),
           free_pages(prefix, "free_pages", &GetFreePages,
-                     aux_members.page_allocator.get()) {}
+                     aux_members.page_allocator.get()),
+          // flush pipeline
+          use_flush_pipeline(prefix, "use_flush_pipeline", false),
+          flush_pipeline_inflight_bytes(prefix,
+                                        "flush_pipeline_inflight_bytes",
+                                        &GetFlushPipelineInflightBytes,
+                                        aux_members.flush_pipeline.get()),
+          flush_pipeline_inflight_slices(prefix,
+                                         "flush_pipeline_inflight_slices",
+                                         &GetFlushPipelineInflightSlices,
+                                         aux_members.flush_pipeline.get()) {}
 
     // file
     bvar::Status<uint32_t> flush_file_workers;
@@ -132,6 +167,10 @@ class DataStreamMetric {
     // page
     bvar::Status<bool> use_page_pool;
     bvar::PassiveStatus<uint64_t> free_pages;
+    // flush pipeline
+    bvar::Status<bool> use_flush_pipeline;
+    bvar::PassiveStatus<uint64_t> flush_pipeline_inflight_bytes;
+    bvar::PassiveStatus<uint64_t> flush_pipeline_inflight_slices;
     bvar::Status<uint32_t> s3_async_upload_workers;
   };
 
@@ -22,19 +22,23 @@
 
 #include "client/dingo_fuse_op.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "client/blockcache/log.h"
+#include "client/buffer_pool.h"
 #include "client/common/common.h"
 #include "client/common/config.h"
 #include "client/filesystem/access_log.h"
+#include "client/filesystem/access_trace.h"
 #include "client/filesystem/error.h"
 #include "client/filesystem/meta.h"
 #include "client/fuse_client.h"
 #include "client/fuse_s3_client.h"
+#include "client/fuse_worker.h"
 #include "client/warmup/warmup_manager.h"
 #include "common/define.h"
 #include "common/dynamic_vlog.h"
@@ -48,9 +52,14 @@
 using dingofs::client::DINGOFS_ERROR;
 using dingofs::client::FuseClient;
 using dingofs::client::FuseS3Client;
+using dingofs::client::FuseWorkerAffinity;
+using dingofs::client::PooledBuffer;
 using dingofs::client::blockcache::InitBlockCacheLog;
 using dingofs::client::common::FuseClientOption;
 using dingofs::client::filesystem::AccessLogGuard;
+using dingofs::client::filesystem::AccessOp;
+using dingofs::client::filesystem::AccessTraceGuard;
+using dingofs::client::filesystem::AsyncAccessLogger;
 using dingofs::client::filesystem::AttrOut;
 using dingofs::client::filesystem::EntryOut;
 using dingofs::client::filesystem::FileOut;
@@ -98,6 +107,18 @@ void EnableSplice(struct fuse_conn_info* conn) {
   }
 }
 
+void EnableWriteback(struct fuse_conn_info* conn) {
+  if (!g_fuse_client_option->fileSystemOption.kernelCacheOption.writeback) {
+    LOG(INFO) << "Fuse writeback cache is disabled";
+    return;
+  }
+
+  if (conn->capable & FUSE_CAP_WRITEBACK_CACHE) {
+    conn->want |= FUSE_CAP_WRITEBACK_CACHE;
+    LOG(INFO) << "FUSE_CAP_WRITEBACK_CACHE enabled";
+  }
+}
+
 int GetFsInfo(const char* fs_name, FsInfo* fs_info) {
   MdsClientImpl mds_client;
   MDSBaseClient mds_base;
@@ -167,6 +188,17 @@ int InitFuseClient(const struct MountOption* mount_option) {
 
   g_fuse_client_option = new FuseClientOption();
   dingofs::client::common::InitFuseClientOption(&conf, g_fuse_client_option);
+  FuseWorkerAffinity::GetInstance().Init(
+      g_fuse_client_option->fuse_worker_option);
+
+  const auto& access_log_option =
+      g_fuse_client_option->fileSystemOption.accessLogOption;
+  if (access_log_option.async &&
+      !AsyncAccessLogger::GetInstance().Start(FLAGS_log_dir,
+                                              access_log_option.binary,
+                                              access_log_option.bufferSize)) {
+    return -1;
+  }
 
   auto fs_info = std::make_shared<FsInfo>();
   if (GetFsInfo(mount_option->fsName, fs_info.get()) != 0) {
@@ -208,11 +240,29 @@ int InitFuseClient(const struct MountOption* mount_option) {
   return 0;
 }
 
+void InitFuseLoopConfig(struct fuse_loop_config* config) {
+  auto& affinity = FuseWorkerAffinity::GetInstance();
+  if (!affinity.Enabled()) {
+    return;
+  }
+
+  // every worker has its own channel, and the bound workers are never
+  // destroyed when idle
+  config->clone_fd = 1;
+  config->max_idle_threads =
+      std::max<unsigned int>(config->max_idle_threads, affinity.Workers());
+}
+
+void SetFuseSession(struct fuse_session* session) {
+  Client()->GetFileSystem()->SetSession(session);
+}
+
 void UnInitFuseClient() {
   if (g_client_instance) {
     g_client_instance->Fini();
     g_client_instance->UnInit();
   }
+  AsyncAccessLogger::GetInstance().Stop();
   delete g_client_instance;
   delete g_fuse_client_option;
   delete g_clientOpMetric;
@@ -347,28 +397,32 @@ void QueryWarmup(fuse_req_t req, fuse_ino_t ino, size_t size) {
 void ReadThrottleAdd(size_t size) { Client()->Add(true, size); }
 void WriteThrottleAdd(size_t size) { Client()->Add(false, size); }
 
-#define METRIC_GUARD(REQUEST)              \
-  ClientOpMetricGuard clientOpMetricGuard( \
+#define METRIC_GUARD(REQUEST)                            \
+  FuseWorkerAffinity::GetInstance().BindCurrentWorker(); \
+  ClientOpMetricGuard clientOpMetricGuard(               \
       &rc, {&g_clientOpMetric->op##REQUEST, &g_clientOpMetric->opAll});
 }  // namespace
 
 void FuseOpInit(void* userdata, struct fuse_conn_info* conn) {
   DINGOFS_ERROR rc;
   auto* client = Client();
-  AccessLogGuard log([&]() { return StrFormat("init : %s", StrErr(rc)); });
+  AccessLogGuard log(AccessOp::kInit, 0, &rc,
+                     [&]() { return StrFormat("init : %s", StrErr(rc)); });
 
   rc = client->FuseOpInit(userdata, conn);
   if (rc != DINGOFS_ERROR::OK) {
     LOG(FATAL) << "FuseOpInit() failed, retCode = " << rc;
   } else {
     EnableSplice(conn);
+    EnableWriteback(conn);
     LOG(INFO) << "FuseOpInit() success, retCode = " << rc;
   }
 }
 
 void FuseOpDestroy(void* userdata) {
   auto* client = Client();
-  AccessLogGuard log([&]() { return StrFormat("destory : OK"); });
+  AccessLogGuard log(AccessOp::kDestroy, 0, nullptr,
+                     [&]() { return StrFormat("destory : OK"); });
   client->FuseOpDestroy(userdata);
 }
 
@@ -378,7 +432,7 @@ void FuseOpLookup(fuse_req_t req, fuse_ino_t parent, const char* name) {
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(Lookup);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kLookup, parent, &rc, [&]() {
     return StrFormat("lookup (%d,%s): %s%s", parent, name, StrErr(rc),
                      StrEntry(entry_out));
   });
@@ -387,7 +441,7 @@ void FuseOpLookup(fuse_req_t req, fuse_ino_t parent, const char* name) {
   if (rc != DINGOFS_ERROR::OK) {
     return fs->ReplyError(req, rc);
   }
-  return fs->ReplyEntry(req, &entry_out);
+  return fs->ReplyEntry(req, parent, name, &entry_out);
 }
 
 void FuseOpGetAttr(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info* fi) {
@@ -396,7 +450,7 @@ void FuseOpGetAttr(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info* fi) {
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(GetAttr);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kGetAttr, ino, &rc, [&]() {
     return StrFormat("getattr (%d): %s%s", ino, StrErr(rc), StrAttr(attr_out));
   });
 
@@ -414,7 +468,7 @@ void FuseOpSetAttr(fuse_req_t req, fuse_ino_t ino, struct stat* attr,
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(SetAttr);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kSetAttr, ino, &rc, [&]() {
     return StrFormat("setattr (%d,0x%X): %s%s", ino, to_set, StrErr(rc),
                      StrAttr(attr_out));
   });
@@ -432,7 +486,7 @@ void FuseOpReadLink(fuse_req_t req, fuse_ino_t ino) {
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(ReadLink);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kReadLink, ino, &rc, [&]() {
     return StrFormat("readlink (%d): %s %s", ino, StrErr(rc), link.c_str());
   });
 
@@ -450,7 +504,7 @@ void FuseOpMkNod(fuse_req_t req, fuse_ino_t parent, const char* name,
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(MkNod);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kMkNod, parent, &rc, [&]() {
     return StrFormat("mknod (%d,%s,%s:0%04o): %s%s", parent, name,
                      StrMode(mode), mode, StrErr(rc), StrEntry(entry_out));
   });
@@ -459,7 +513,7 @@ void FuseOpMkNod(fuse_req_t req, fuse_ino_t parent, const char* name,
   if (rc != DINGOFS_ERROR::OK) {
     return fs->ReplyError(req, rc);
   }
-  return fs->ReplyEntry(req, &entry_out);
+  return fs->ReplyEntry(req, parent, name, &entry_out);
 }
 
 void FuseOpMkDir(fuse_req_t req, fuse_ino_t parent, const char* name,
@@ -469,7 +523,7 @@ void FuseOpMkDir(fuse_req_t req, fuse_ino_t parent, const char* name,
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(MkDir);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kMkDir, parent, &rc, [&]() {
     return StrFormat("mkdir (%d,%s,%s:0%04o): %s%s", parent, name,
                      StrMode(mode), mode, StrErr(rc), StrEntry(entry_out));
   });
@@ -478,7 +532,7 @@ void FuseOpMkDir(fuse_req_t req, fuse_ino_t parent, const char* name,
   if (rc != DINGOFS_ERROR::OK) {
     return fs->ReplyError(req, rc);
   }
-  return fs->ReplyEntry(req, &entry_out);
+  return fs->ReplyEntry(req, parent, name, &entry_out);
 }
 
 void FuseOpUnlink(fuse_req_t req, fuse_ino_t parent, const char* name) {
@@ -486,7 +540,7 @@ void FuseOpUnlink(fuse_req_t req, fuse_ino_t parent, const char* name) {
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(Unlink);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kUnlink, parent, &rc, [&]() {
     return StrFormat("unlink (%d,%s): %s", parent, name, StrErr(rc));
   });
 
@@ -499,7 +553,7 @@ void FuseOpRmDir(fuse_req_t req, fuse_ino_t parent, const char* name) {
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(RmDir);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kRmDir, parent, &rc, [&]() {
     return StrFormat("rmdir (%d,%s): %s", parent, name, StrErr(rc));
   });
 
@@ -514,7 +568,7 @@ void FuseOpSymlink(fuse_req_t req, const char* link, fuse_ino_t parent,
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(Symlink);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kSymlink, parent, &rc, [&]() {
     return StrFormat("symlink (%d,%s,%s): %s%s", parent, name, link, StrErr(rc),
                      StrEntry(entry_out));
   });
@@ -523,7 +577,7 @@ void FuseOpSymlink(fuse_req_t req, const char* link, fuse_ino_t parent,
   if (rc != DINGOFS_ERROR::OK) {
     return fs->ReplyError(req, rc);
   }
-  return fs->ReplyEntry(req, &entry_out);
+  return fs->ReplyEntry(req, parent, name, &entry_out);
 }
 
 void FuseOpRename(fuse_req_t req, fuse_ino_t parent, const char* name,
@@ -533,7 +587,7 @@ void FuseOpRename(fuse_req_t req, fuse_ino_t parent, const char* name,
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(Rename);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kRename, parent, &rc, [&]() {
     return StrFormat("rename (%d,%s,%d,%s,%d): %s", parent, name, newparent,
                      newname, flags, StrErr(rc));
   });
@@ -549,7 +603,7 @@ void FuseOpLink(fuse_req_t req, fuse_ino_t ino, fuse_ino_t newparent,
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(Link);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kLink, ino, &rc, [&]() {
     return StrFormat("link (%d,%d,%s): %s%s", ino, newparent, newname,
                      StrErr(rc), StrEntry(entry_out));
   });
@@ -558,7 +612,7 @@ void FuseOpLink(fuse_req_t req, fuse_ino_t ino, fuse_ino_t newparent,
   if (rc != DINGOFS_ERROR::OK) {
     return fs->ReplyError(req, rc);
   }
-  return fs->ReplyEntry(req, &entry_out);
+  return fs->ReplyEntry(req, newparent, newname, &entry_out);
 }
 
 void FuseOpOpen(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info* fi) {
@@ -567,7 +621,7 @@ void FuseOpOpen(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info* fi) {
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(Open);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kOpen, ino, &rc, [&]() {
     return StrFormat("open (%d): %s [fh:%d]", ino, StrErr(rc), fi->fh);
   });
 
@@ -583,22 +637,23 @@ void FuseOpRead(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off,
                 struct fuse_file_info* fi) {
   DINGOFS_ERROR rc;
   size_t r_size = 0;
-  std::unique_ptr<char[]> buffer(new char[size]);
+  PooledBuffer buffer(size);
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(Read);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kRead, ino, off, &r_size, &rc, [&]() {
     return StrFormat("read (%d,%d,%d,%d): %s (%d)", ino, size, off, fi->fh,
                      StrErr(rc), r_size);
   });
+  AccessTraceGuard trace(ino, off, &r_size);
 
   ReadThrottleAdd(size);
-  rc = client->FuseOpRead(req, ino, size, off, fi, buffer.get(), &r_size);
+  rc = client->FuseOpRead(req, ino, size, off, fi, buffer.Data(), &r_size);
   if (rc != DINGOFS_ERROR::OK) {
     return fs->ReplyError(req, rc);
   }
   struct fuse_bufvec bufvec = FUSE_BUFVEC_INIT(r_size);
-  bufvec.buf[0].mem = buffer.get();
+  bufvec.buf[0].mem = buffer.Data();
   return fs->ReplyData(req, &bufvec, FUSE_BUF_SPLICE_MOVE);
 }
 
@@ -609,10 +664,11 @@ void FuseOpWrite(fuse_req_t req, fuse_ino_t ino, const char* buf, size_t size,
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(Write);
-  AccessLogGuard log([&]() {
-    return StrFormat("write (%d,%d,%d,%d): %s (%d)", ino, size, off, fi->fh,
-                     StrErr(rc), file_out.nwritten);
-  });
+  AccessLogGuard log(
+      AccessOp::kWrite, ino, off, &file_out.nwritten, &rc, [&]() {
+        return StrFormat("write (%d,%d,%d,%d): %s (%d)", ino, size, off,
+                         fi->fh, StrErr(rc), file_out.nwritten);
+      });
 
   WriteThrottleAdd(size);
   rc = client->FuseOpWrite(req, ino, buf, size, off, fi, &file_out);
@@ -630,7 +686,7 @@ void FuseOpFlush(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info* fi) {
     return fs->ReplyError(req, DINGOFS_ERROR::OK);
   }
   METRIC_GUARD(Flush);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kFlush, ino, &rc, [&]() {
     return StrFormat("flush (%d,%d): %s", ino, fi->fh, StrErr(rc));
   });
 
@@ -643,7 +699,7 @@ void FuseOpRelease(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info* fi) {
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(Release);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kRelease, ino, &rc, [&]() {
     return StrFormat("release (%d,%d): %s", ino, fi->fh, StrErr(rc));
   });
 
@@ -657,7 +713,7 @@ void FuseOpFsync(fuse_req_t req, fuse_ino_t ino, int datasync,
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(Fsync);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kFsync, ino, &rc, [&]() {
     return StrFormat("fsync (%d,%d): %s", ino, datasync, StrErr(rc));
   });
 
@@ -670,7 +726,7 @@ void FuseOpOpenDir(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info* fi) {
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(OpenDir);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kOpenDir, ino, &rc, [&]() {
     return StrFormat("opendir (%d): %s [fh:%d]", ino, StrErr(rc), fi->fh);
   });
 
@@ -689,7 +745,7 @@ void FuseOpReadDir(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off,
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(ReadDir);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kReadDir, ino, off, &r_size, &rc, [&]() {
     return StrFormat("readdir (%d,%d,%d): %s (%d)", ino, size, off, StrErr(rc),
                      r_size);
   });
@@ -709,10 +765,11 @@ void FuseOpReadDirPlus(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off,
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(ReadDir);
-  AccessLogGuard log([&]() {
-    return StrFormat("readdirplus (%d,%d,%d): %s (%d)", ino, size, off,
-                     StrErr(rc), r_size);
-  });
+  AccessLogGuard log(
+      AccessOp::kReadDirPlus, ino, off, &r_size, &rc, [&]() {
+        return StrFormat("readdirplus (%d,%d,%d): %s (%d)", ino, size, off,
+                         StrErr(rc), r_size);
+      });
 
   rc = client->FuseOpReadDir(req, ino, size, off, fi, &buffer, &r_size, true);
   if (rc != DINGOFS_ERROR::OK) {
@@ -728,7 +785,7 @@ void FuseOpReleaseDir(fuse_req_t req, fuse_ino_t ino,
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(ReleaseDir);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kReleaseDir, ino, &rc, [&]() {
     return StrFormat("releasedir (%d,%d): %s", ino, fi->fh, StrErr(rc));
   });
 
@@ -741,8 +798,9 @@ void FuseOpStatFs(fuse_req_t req, fuse_ino_t ino) {
   struct statvfs stbuf;
   auto* client = Client();
   auto fs = client->GetFileSystem();
-  AccessLogGuard log(
-      [&]() { return StrFormat("statfs (%d): %s", ino, StrErr(rc)); });
+  AccessLogGuard log(AccessOp::kStatFs, ino, &rc, [&]() {
+    return StrFormat("statfs (%d): %s", ino, StrErr(rc));
+  });
 
   rc = client->FuseOpStatFs(req, ino, &stbuf);
   if (rc != DINGOFS_ERROR::OK) {
@@ -756,7 +814,7 @@ void FuseOpSetXattr(fuse_req_t req, fuse_ino_t ino, const char* name,
   DINGOFS_ERROR rc;
   auto* client = Client();
   auto fs = client->GetFileSystem();
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kSetXattr, ino, &rc, [&]() {
     return StrFormat("setxattr (%d,%s,%d,%d): %s", ino, name, size, flags,
                      StrErr(rc));
   });
@@ -772,13 +830,13 @@ void FuseOpSetXattr(fuse_req_t req, fuse_ino_t ino, const char* name,
 void FuseOpGetXattr(fuse_req_t req, fuse_ino_t ino, const char* name,
                     size_t size) {
   DINGOFS_ERROR rc;
-  std::string value;
+  size_t xattr_size = 0;
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(GetXattr);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kGetXattr, ino, &rc, [&]() {
     return StrFormat("getxattr (%d,%s,%d): %s (%d)", ino, name, size,
-                     StrErr(rc), value.size());
+                     StrErr(rc), xattr_size);
   });
 
   // FIXME(Wine93): please handle it in FuseClient.
@@ -786,35 +844,36 @@ void FuseOpGetXattr(fuse_req_t req, fuse_ino_t ino, const char* name,
     return QueryWarmup(req, ino, size);
   }
 
-  rc = Client()->FuseOpGetXattr(req, ino, name, &value, size);
+  PooledBuffer buf(size);
+  rc = Client()->FuseOpGetXattr(req, ino, name, buf.Data(), size, &xattr_size);
   if (rc != DINGOFS_ERROR::OK) {
     return fs->ReplyError(req, rc);
   } else if (size == 0) {
-    return fs->ReplyXattr(req, value.length());
+    return fs->ReplyXattr(req, xattr_size);
   }
-  return fs->ReplyBuffer(req, value.data(), value.length());
+  return fs->ReplyBuffer(req, buf.Data(), xattr_size);
 }
 
 void FuseOpListXattr(fuse_req_t req, fuse_ino_t ino, size_t size) {
   DINGOFS_ERROR rc;
   size_t xattr_size = 0;
-  std::unique_ptr<char[]> buf(new char[size]);
-  std::memset(buf.get(), 0, size);
+  PooledBuffer buf(size);
+  std::memset(buf.Data(), 0, size);
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(ListXattr);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kListXattr, ino, &rc, [&]() {
     return StrFormat("listxattr (%d,%d): %s (%d)", ino, size, StrErr(rc),
                      xattr_size);
   });
 
-  rc = Client()->FuseOpListXattr(req, ino, buf.get(), size, &xattr_size);
+  rc = Client()->FuseOpListXattr(req, ino, buf.Data(), size, &xattr_size);
   if (rc != DINGOFS_ERROR::OK) {
     return fs->ReplyError(req, rc);
   } else if (size == 0) {
     return fs->ReplyXattr(req, xattr_size);
   }
-  return fs->ReplyBuffer(req, buf.get(), xattr_size);
+  return fs->ReplyBuffer(req, buf.Data(), xattr_size);
 }
 
 void FuseOpCreate(fuse_req_t req, fuse_ino_t parent, const char* name,
@@ -824,7 +883,7 @@ void FuseOpCreate(fuse_req_t req, fuse_ino_t parent, const char* name,
   auto* client = Client();
   auto fs = client->GetFileSystem();
   METRIC_GUARD(Create);
-  AccessLogGuard log([&]() {
+  AccessLogGuard log(AccessOp::kCreate, parent, &rc, [&]() {
     return StrFormat("create (%d,%s): %s%s [fh:%d]", parent, name, StrErr(rc),
                      StrEntry(entry_out), fi->fh);
   });
@@ -833,7 +892,7 @@ void FuseOpCreate(fuse_req_t req, fuse_ino_t parent, const char* name,
   if (rc != DINGOFS_ERROR::OK) {
     return fs->ReplyError(req, rc);
   }
-  return fs->ReplyCreate(req, &entry_out, fi);
+  return fs->ReplyCreate(req, parent, name, &entry_out, fi);
 }
 
 void FuseOpBmap(fuse_req_t req, fuse_ino_t /*ino*/, size_t /*blocksize*/,
@@ -41,6 +41,12 @@ int InitFuseClient(const struct MountOption* mount_option);
 
 void UnInitFuseClient();
 
+// Adjust the config of multi-threaded fuse loop after InitFuseClient()
+void InitFuseLoopConfig(struct fuse_loop_config* config);
+
+// Set the session which used to notify kernel after InitFuseClient()
+void SetFuseSession(struct fuse_session* session);
+
 /**
  * Initialize filesystem
  *
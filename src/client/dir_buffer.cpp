@@ -48,7 +48,6 @@ void DirBuffer::DirBufferRelease(uint64_t dindex) {
   dingofs::utils::WriteLockGuard wlg(bufferMtx_);
   auto it = buffer_.find(dindex);
   if (it != buffer_.end()) {
-    free(it->second->p);
     delete it->second;
     buffer_.erase(it);
   }
@@ -57,7 +56,6 @@ void DirBuffer::DirBufferRelease(uint64_t dindex) {
 void DirBuffer::DirBufferFreeAll() {
   dingofs::utils::WriteLockGuard wlg(bufferMtx_);
   for (auto it : buffer_) {
-    free(it.second->p);
     delete it.second;
   }
   buffer_.clear();
@@ -28,6 +28,7 @@
 #include <deque>
 #include <unordered_map>
 
+#include "client/buffer_pool.h"
 #include "utils/concurrent/concurrent.h"
 
 namespace dingofs {
@@ -37,7 +38,14 @@ struct DirBufferHead {
   bool wasRead;
   size_t size;
   char* p;
+  PooledBuffer buffer;
   DirBufferHead() : wasRead(false), size(0), p(nullptr) {}
+  // Make the buffer hold at least `newSize` bytes, the first `size` bytes
+  // are kept
+  void Reserve(size_t newSize) {
+    buffer.Reserve(newSize, size);
+    p = buffer.Data();
+  }
 };
 
 // directory buffer
@@ -28,10 +28,13 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "absl/strings/str_format.h"
 #include "dingofs/metaserver.pb.h"
 #include "client/common/config.h"
+#include "client/filesystem/async_access_log.h"
+#include "client/filesystem/error.h"
 
 #ifndef DINGOFS_SRC_CLIENT_FILESYSTEM_ACCESS_LOG_H_
 #define DINGOFS_SRC_CLIENT_FILESYSTEM_ACCESS_LOG_H_
@@ -51,20 +54,46 @@ using MessageHandler = std::function<std::string()>;
 
 static std::shared_ptr<spdlog::logger> Logger;
 
-bool InitAccessLog(const std::string& prefix) {
+inline bool InitAccessLog(const std::string& prefix) {
   std::string filename = StrFormat("%s/access_%d.log", prefix, getpid());
   Logger = spdlog::daily_logger_mt("fuse_access", filename, 0, 0);
   spdlog::flush_every(std::chrono::seconds(1));
   return true;
 }
 
+// The access log is written asynchronously as fixed-size record
+// (op, ino, offset, length, latency, status) if the async access logger
+// is running, otherwise the message returned by handler is written
+// synchronously. The |length| points to the size actually read or written,
+// which is recorded only if the operation succeeded.
 struct AccessLogGuard {
   explicit AccessLogGuard(MessageHandler handler)
-      : enable(FLAGS_access_logging), handler(handler) {
+      : AccessLogGuard(AccessOp::kUnknown, 0, nullptr, std::move(handler)) {}
+
+  AccessLogGuard(AccessOp op, uint64_t ino, const DINGOFS_ERROR* rc,
+                 MessageHandler handler)
+      : AccessLogGuard(op, ino, 0, nullptr, rc, std::move(handler)) {}
+
+  AccessLogGuard(AccessOp op, uint64_t ino, uint64_t offset,
+                 const size_t* length, const DINGOFS_ERROR* rc,
+                 MessageHandler handler)
+      : enable(FLAGS_access_logging),
+        async(false),
+        op(op),
+        ino(ino),
+        offset(offset),
+        length(length),
+        rc(rc),
+        handler(std::move(handler)) {
     if (!enable) {
       return;
     }
 
+    async = (op != AccessOp::kUnknown) &&
+            AsyncAccessLogger::GetInstance().Running();
+    if (async) {
+      start_us = butil::gettimeofday_us();
+    }
     timer.start();
   }
 
@@ -74,10 +103,31 @@ struct AccessLogGuard {
     }
 
     timer.stop();
+    if (async) {
+      AccessLogRecord record;
+      record.timestamp_us = start_us;
+      record.ino = ino;
+      record.offset = offset;
+      record.status = (rc == nullptr) ? 0 : static_cast<int32_t>(*rc);
+      record.length =
+          (length == nullptr || record.status != 0) ? 0 : *length;
+      record.latency_us = static_cast<uint32_t>(timer.u_elapsed());
+      record.op = static_cast<uint8_t>(op);
+      AsyncAccessLogger::GetInstance().Append(record);
+      return;
+    }
+
     Logger->info("{0} <{1:.6f}>", handler(), timer.u_elapsed() / 1e6);
   }
 
   bool enable;
+  bool async;
+  AccessOp op;
+  uint64_t ino;
+  uint64_t offset;
+  const size_t* length;
+  const DINGOFS_ERROR* rc;
+  uint64_t start_us;
   MessageHandler handler;
   butil::Timer timer;
 };
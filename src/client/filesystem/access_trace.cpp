@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/filesystem/access_trace.h"
+
+#include <glog/logging.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+namespace dingofs {
+namespace client {
+namespace filesystem {
+
+namespace {
+
+constexpr char kProfileMagic[8] = {'D', 'F', 'S', 'P', 'R', 'O', 'F', '\0'};
+constexpr uint32_t kProfileVersion = 1;
+constexpr size_t kRecordSize = sizeof(uint64_t) + sizeof(uint32_t);
+
+void EncodeRecord(const AccessRecord& record, char* buffer) {
+  uint32_t index = static_cast<uint32_t>(record.index);
+  memcpy(buffer, &record.ino, sizeof(uint64_t));
+  memcpy(buffer + sizeof(uint64_t), &index, sizeof(uint32_t));
+}
+
+void DecodeRecord(const char* buffer, AccessRecord* record) {
+  uint32_t index;
+  memcpy(&record->ino, buffer, sizeof(uint64_t));
+  memcpy(&index, buffer + sizeof(uint64_t), sizeof(uint32_t));
+  record->index = index;
+}
+
+}  // namespace
+
+bool AccessProfile::Load(const std::string& path,
+                         std::vector<AccessRecord>* records) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    LOG(WARNING) << "Open access profile (" << path
+                 << ") failed: " << strerror(errno);
+    return false;
+  }
+
+  char magic[sizeof(kProfileMagic)];
+  uint32_t version;
+  if (fread(magic, sizeof(magic), 1, file) != 1 ||
+      memcmp(magic, kProfileMagic, sizeof(magic)) != 0 ||
+      fread(&version, sizeof(version), 1, file) != 1 ||
+      version != kProfileVersion) {
+    LOG(ERROR) << "Invalid access profile (" << path << ").";
+    fclose(file);
+    return false;
+  }
+
+  char buffer[kRecordSize];
+  AccessRecord record;
+  while (fread(buffer, kRecordSize, 1, file) == 1) {
+    DecodeRecord(buffer, &record);
+    records->emplace_back(record);
+  }
+  fclose(file);
+  return true;
+}
+
+bool AccessProfile::WriteHeader(FILE* file) {
+  return fwrite(kProfileMagic, sizeof(kProfileMagic), 1, file) == 1 &&
+         fwrite(&kProfileVersion, sizeof(kProfileVersion), 1, file) == 1;
+}
+
+bool AccessProfile::WriteRecords(FILE* file,
+                                 const std::vector<AccessRecord>& records) {
+  std::vector<char> buffer(records.size() * kRecordSize);
+  for (size_t i = 0; i < records.size(); i++) {
+    EncodeRecord(records[i], buffer.data() + i * kRecordSize);
+  }
+  return fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+}
+
+AccessTracer::AccessTracer()
+    : enabled_(false),
+      block_size_(0),
+      recording_(false),
+      max_records_(0),
+      file_(nullptr) {}
+
+bool AccessTracer::StartRecord(const std::string& profile,
+                               uint64_t block_size, uint64_t max_records) {
+  std::unique_lock<std::mutex> lk(mutex_);
+  if (recording_) {
+    return true;
+  }
+
+  profile_ = profile;
+  tmpfile_ = profile + ".recording";
+  file_ = fopen(tmpfile_.c_str(), "wb");
+  if (file_ == nullptr || !AccessProfile::WriteHeader(file_)) {
+    LOG(ERROR) << "Create access profile (" << tmpfile_
+               << ") failed: " << strerror(errno);
+    if (file_ != nullptr) {
+      fclose(file_);
+      file_ = nullptr;
+    }
+    return false;
+  }
+
+  recording_ = true;
+  max_records_ = max_records;
+  block_size_.store(block_size, std::memory_order_relaxed);
+  enabled_.store(true, std::memory_order_relaxed);
+  sleeper_.init();
+  flush_thread_ = std::thread(&AccessTracer::FlushLoop, this);
+  LOG(INFO) << "Start recording access profile to " << profile_;
+  return true;
+}
+
+void AccessTracer::SetListener(uint64_t block_size, Listener listener) {
+  std::unique_lock<std::mutex> lk(mutex_);
+  listener_ = std::move(listener);
+  if (listener_ != nullptr) {
+    block_size_.store(block_size, std::memory_order_relaxed);
+  }
+  enabled_.store(recording_ || listener_ != nullptr,
+                 std::memory_order_relaxed);
+}
+
+void AccessTracer::Stop() {
+  enabled_.store(false, std::memory_order_relaxed);
+  if (flush_thread_.joinable()) {
+    sleeper_.interrupt();
+    flush_thread_.join();
+  }
+
+  std::unique_lock<std::mutex> lk(mutex_);
+  listener_ = nullptr;
+  if (!recording_) {
+    return;
+  }
+
+  recording_ = false;
+  lk.unlock();
+  Flush();
+  lk.lock();
+
+  fclose(file_);
+  file_ = nullptr;
+  // keep the previous profile if nothing recorded
+  if (seen_.empty()) {
+    unlink(tmpfile_.c_str());
+  } else if (rename(tmpfile_.c_str(), profile_.c_str()) != 0) {
+    LOG(ERROR) << "Rename access profile (" << tmpfile_ << ") to ("
+               << profile_ << ") failed: " << strerror(errno);
+  } else {
+    LOG(INFO) << "Access profile (" << profile_ << ") saved, "
+              << seen_.size() << " blocks recorded.";
+  }
+  seen_.clear();
+}
+
+void AccessTracer::Access(uint64_t ino, uint64_t offset, uint64_t length) {
+  uint64_t block_size = block_size_.load(std::memory_order_relaxed);
+  if (block_size == 0 || length == 0) {
+    return;
+  }
+
+  static thread_local AccessRecord last{0, 0};
+  uint64_t first_index = offset / block_size;
+  uint64_t last_index = (offset + length - 1) / block_size;
+  for (auto index = first_index; index <= last_index; index++) {
+    AccessRecord record{ino, index};
+    if (record == last) {
+      continue;
+    }
+    last = record;
+    OnAccess(record);
+  }
+}
+
+void AccessTracer::OnAccess(const AccessRecord& record) {
+  Listener listener;
+  {
+    std::unique_lock<std::mutex> lk(mutex_);
+    listener = listener_;
+    if (recording_ && seen_.size() < max_records_ &&
+        seen_.emplace(record).second) {
+      pending_.emplace_back(record);
+    }
+  }
+
+  if (listener != nullptr) {
+    listener(record);
+  }
+}
+
+uint64_t AccessTracer::RecordCount() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  return seen_.size();
+}
+
+void AccessTracer::FlushLoop() {
+  while (sleeper_.wait_for(std::chrono::seconds(1))) {
+    Flush();
+  }
+}
+
+void AccessTracer::Flush() {
+  std::vector<AccessRecord> records;
+  FILE* file;
+  {
+    std::unique_lock<std::mutex> lk(mutex_);
+    records.swap(pending_);
+    file = file_;
+  }
+
+  if (records.empty() || file == nullptr) {
+    return;
+  }
+  if (!AccessProfile::WriteRecords(file, records) || fflush(file) != 0) {
+    LOG_EVERY_N(ERROR, 100) << "Write access profile (" << tmpfile_
+                            << ") failed: " << strerror(errno);
+  }
+}
+
+}  // namespace filesystem
+}  // namespace client
+}  // namespace dingofs
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_CLIENT_FILESYSTEM_ACCESS_TRACE_H_
+#define DINGOFS_SRC_CLIENT_FILESYSTEM_ACCESS_TRACE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "utils/interruptible_sleeper.h"
+
+namespace dingofs {
+namespace client {
+namespace filesystem {
+
+// The block (inode, block index) which accessed by reader.
+struct AccessRecord {
+  uint64_t ino;
+  uint64_t index;
+
+  bool operator==(const AccessRecord& other) const {
+    return ino == other.ino && index == other.index;
+  }
+};
+
+struct AccessRecordHash {
+  size_t operator()(const AccessRecord& record) const {
+    return std::hash<uint64_t>()(record.ino) ^
+           (std::hash<uint64_t>()(record.index) << 1);
+  }
+};
+
+// The access profile of filesystem, which is a header followed by the
+// first access of each block in order:
+//
+//   | magic (8 bytes) | version (4 bytes) | record ... |
+//   record: | ino (8 bytes) | block index (4 bytes) |
+class AccessProfile {
+ public:
+  static bool Load(const std::string& path, std::vector<AccessRecord>* records);
+
+  static bool WriteHeader(FILE* file);
+
+  static bool WriteRecords(FILE* file, const std::vector<AccessRecord>& records);
+};
+
+// Records the block accesses of reader and notifies the listener
+// (e.g. warmup replayer). The consecutive accesses to the same block from
+// one thread are merged, so the sequential read only costs a thread-local
+// comparison for most of the calls.
+class AccessTracer {
+ public:
+  using Listener = std::function<void(const AccessRecord& record)>;
+
+  static AccessTracer& GetInstance() {
+    static AccessTracer instance;
+    return instance;
+  }
+
+  // record the accesses into profile, the profile is written to a temporary
+  // file and renamed to the profile path when stopped.
+  bool StartRecord(const std::string& profile, uint64_t block_size,
+                   uint64_t max_records);
+
+  void SetListener(uint64_t block_size, Listener listener);
+
+  void Stop();
+
+  void Access(uint64_t ino, uint64_t offset, uint64_t length);
+
+  bool Enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  uint64_t RecordCount();
+
+ private:
+  AccessTracer();
+
+  void OnAccess(const AccessRecord& record);
+
+  void FlushLoop();
+
+  void Flush();
+
+ private:
+  std::atomic<bool> enabled_;
+  std::atomic<uint64_t> block_size_;
+  std::mutex mutex_;
+  Listener listener_;
+  bool recording_;
+  uint64_t max_records_;
+  std::string profile_;
+  std::string tmpfile_;
+  FILE* file_;
+  std::unordered_set<AccessRecord, AccessRecordHash> seen_;
+  std::vector<AccessRecord> pending_;
+  std::thread flush_thread_;
+  utils::InterruptibleSleeper sleeper_;
+};
+
+// Trace the access after the read finished.
+struct AccessTraceGuard {
+  AccessTraceGuard(uint64_t ino, uint64_t offset, const size_t* length)
+      : ino(ino), offset(offset), length(length) {}
+
+  ~AccessTraceGuard() {
+    auto& tracer = AccessTracer::GetInstance();
+    if (tracer.Enabled()) {
+      tracer.Access(ino, offset, *length);
+    }
+  }
+
+  uint64_t ino;
+  uint64_t offset;
+  const size_t* length;
+};
+
+}  // namespace filesystem
+}  // namespace client
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_CLIENT_FILESYSTEM_ACCESS_TRACE_H_
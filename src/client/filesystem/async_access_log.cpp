@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/filesystem/async_access_log.h"
+
+#include <glog/logging.h>
+#include <spdlog/sinks/daily_file_sink.h>
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include "absl/strings/str_format.h"
+#include "client/filesystem/error.h"
+
+namespace dingofs {
+namespace client {
+namespace filesystem {
+
+namespace {
+
+constexpr char kAccessLogMagic[8] = {'D', 'F', 'S', 'A', 'L', 'O', 'G', '\0'};
+constexpr uint32_t kAccessLogVersion = 1;
+constexpr uint32_t kAccessLogRecordSize = sizeof(AccessLogRecord);
+
+const char* kAccessOpNames[] = {
+    "unknown",    "init",     "destroy",  "lookup",      "getattr",
+    "setattr",    "readlink", "mknod",    "mkdir",       "unlink",
+    "rmdir",      "symlink",  "rename",   "link",        "open",
+    "read",       "write",    "flush",    "release",     "fsync",
+    "opendir",    "readdir",  "readdirplus", "releasedir", "statfs",
+    "setxattr",   "getxattr", "listxattr", "create",
+};
+
+static_assert(sizeof(kAccessOpNames) / sizeof(kAccessOpNames[0]) ==
+                  static_cast<size_t>(AccessOp::kMax),
+              "access op names mismatch");
+
+uint64_t RoundUpPowerOfTwo(uint64_t n) {
+  uint64_t capacity = 1;
+  while (capacity < n) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+// Close the ring when its owner thread exits, the drain thread will
+// remove it after all records consumed.
+struct AccessLogRingHolder {
+  ~AccessLogRingHolder() {
+    if (ring != nullptr) {
+      ring->Close();
+    }
+  }
+
+  std::shared_ptr<AccessLogRing> ring;
+};
+
+}  // namespace
+
+const char* StrAccessOp(AccessOp op) {
+  auto index = static_cast<size_t>(op);
+  if (index >= static_cast<size_t>(AccessOp::kMax)) {
+    return kAccessOpNames[0];
+  }
+  return kAccessOpNames[index];
+}
+
+std::string StrAccessLogRecord(const AccessLogRecord& record) {
+  return absl::StrFormat(
+      "%s (%d,%d,%d): %s <%.6f>", StrAccessOp(AccessOp(record.op)),
+      record.ino, record.offset, record.length,
+      StrErr(static_cast<DINGOFS_ERROR>(record.status)),
+      record.latency_us / 1e6);
+}
+
+AccessLogRing::AccessLogRing(size_t capacity)
+    : mask_(RoundUpPowerOfTwo(std::max<size_t>(capacity, 2)) - 1),
+      slots_(new AccessLogRecord[mask_ + 1]),
+      head_(0),
+      tail_(0),
+      closed_(false) {}
+
+bool AccessLogRing::Push(const AccessLogRecord& record) {
+  uint64_t head = head_.load(std::memory_order_relaxed);
+  if (head - tail_.load(std::memory_order_acquire) > mask_) {
+    return false;  // full
+  }
+  slots_[head & mask_] = record;
+  head_.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+size_t AccessLogRing::Pop(std::vector<AccessLogRecord>* records) {
+  uint64_t tail = tail_.load(std::memory_order_relaxed);
+  uint64_t head = head_.load(std::memory_order_acquire);
+  for (auto i = tail; i < head; i++) {
+    records->emplace_back(slots_[i & mask_]);
+  }
+  tail_.store(head, std::memory_order_release);
+  return head - tail;
+}
+
+AsyncAccessLogger::AsyncAccessLogger()
+    : running_(false),
+      dropped_(0),
+      ring_capacity_(0),
+      binary_(false),
+      file_(nullptr),
+      reported_dropped_(0) {}
+
+bool AsyncAccessLogger::Start(const std::string& prefix, bool binary,
+                              size_t ring_capacity) {
+  std::unique_lock<std::mutex> lk(drain_mutex_);
+  if (running_.load(std::memory_order_relaxed)) {
+    return true;
+  }
+
+  binary_ = binary;
+  if (binary) {
+    path_ = absl::StrFormat("%s/access_%d.bin", prefix, getpid());
+    file_ = fopen(path_.c_str(), "ab");
+    // write header for new file only, the records are appended after restart
+    bool succ = (file_ != nullptr);
+    if (succ && ftell(file_) == 0) {
+      succ = fwrite(kAccessLogMagic, sizeof(kAccessLogMagic), 1, file_) == 1 &&
+             fwrite(&kAccessLogVersion, sizeof(uint32_t), 1, file_) == 1 &&
+             fwrite(&kAccessLogRecordSize, sizeof(uint32_t), 1, file_) == 1;
+    }
+    if (!succ) {
+      LOG(ERROR) << "Open access log (" << path_
+                 << ") failed: " << strerror(errno);
+      if (file_ != nullptr) {
+        fclose(file_);
+        file_ = nullptr;
+      }
+      return false;
+    }
+  } else {
+    path_ = absl::StrFormat("%s/access_%d.log", prefix, getpid());
+    logger_ = spdlog::get("fuse_access");
+    if (logger_ == nullptr) {
+      logger_ = spdlog::daily_logger_mt("fuse_access", path_, 0, 0);
+    }
+  }
+
+  {
+    std::unique_lock<std::mutex> rings_lk(mutex_);
+    ring_capacity_ = ring_capacity;
+  }
+  sleeper_.init();
+  drain_thread_ = std::thread(&AsyncAccessLogger::DrainLoop, this);
+  running_.store(true, std::memory_order_relaxed);
+  LOG(INFO) << "Async access log started, path = " << path_
+            << ", binary = " << binary << ", ring capacity = " << ring_capacity;
+  return true;
+}
+
+void AsyncAccessLogger::Stop() {
+  if (!running_.exchange(false, std::memory_order_relaxed)) {
+    return;
+  }
+
+  sleeper_.interrupt();
+  drain_thread_.join();
+  Drain();
+
+  std::unique_lock<std::mutex> lk(drain_mutex_);
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+  logger_ = nullptr;
+  LOG(INFO) << "Async access log stopped, " << Dropped()
+            << " records dropped.";
+}
+
+void AsyncAccessLogger::Append(const AccessLogRecord& record) {
+  static thread_local AccessLogRingHolder holder;
+  if (holder.ring == nullptr) {
+    holder.ring = NewRing();
+  }
+  if (!holder.ring->Push(record)) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+std::string AsyncAccessLogger::Path() {
+  std::unique_lock<std::mutex> lk(drain_mutex_);
+  return path_;
+}
+
+std::shared_ptr<AccessLogRing> AsyncAccessLogger::NewRing() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  auto ring = std::make_shared<AccessLogRing>(ring_capacity_);
+  rings_.emplace_back(ring);
+  return ring;
+}
+
+void AsyncAccessLogger::DrainLoop() {
+  while (sleeper_.wait_for(std::chrono::milliseconds(100))) {
+    Drain();
+  }
+}
+
+void AsyncAccessLogger::Drain() {
+  std::vector<std::shared_ptr<AccessLogRing>> rings;
+  {
+    std::unique_lock<std::mutex> lk(mutex_);
+    rings = rings_;
+  }
+
+  std::unique_lock<std::mutex> lk(drain_mutex_);
+  std::vector<AccessLogRecord> records;
+  std::vector<AccessLogRing*> exited;
+  for (const auto& ring : rings) {
+    // check closed before pop, no more record will be pushed after closed
+    bool closed = ring->Closed();
+    ring->Pop(&records);
+    if (closed) {
+      exited.emplace_back(ring.get());
+    }
+  }
+
+  if (!exited.empty()) {
+    std::unique_lock<std::mutex> rings_lk(mutex_);
+    rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                [&](const std::shared_ptr<AccessLogRing>& r) {
+                                  return std::find(exited.begin(),
+                                                   exited.end(),
+                                                   r.get()) != exited.end();
+                                }),
+                 rings_.end());
+  }
+
+  if (!records.empty()) {
+    std::stable_sort(records.begin(), records.end(),
+                     [](const AccessLogRecord& a, const AccessLogRecord& b) {
+                       return a.timestamp_us < b.timestamp_us;
+                     });
+    Write(records);
+  }
+
+  uint64_t dropped = Dropped();
+  if (dropped != reported_dropped_) {
+    LOG(WARNING) << (dropped - reported_dropped_)
+                 << " access log records dropped for ring buffer is full.";
+    reported_dropped_ = dropped;
+  }
+}
+
+void AsyncAccessLogger::Write(const std::vector<AccessLogRecord>& records) {
+  if (file_ != nullptr) {
+    if (fwrite(records.data(), sizeof(AccessLogRecord), records.size(),
+               file_) != records.size() ||
+        fflush(file_) != 0) {
+      LOG_EVERY_N(ERROR, 100) << "Write access log (" << path_
+                              << ") failed: " << strerror(errno);
+    }
+  } else if (logger_ != nullptr) {
+    for (const auto& record : records) {
+      logger_->info("{0}", StrAccessLogRecord(record));
+    }
+  }
+}
+
+bool AccessLogReader::ReadAll(const std::string& path, Handler handler) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    LOG(ERROR) << "Open access log (" << path
+               << ") failed: " << strerror(errno);
+    return false;
+  }
+
+  char magic[sizeof(kAccessLogMagic)];
+  uint32_t version, record_size;
+  if (fread(magic, sizeof(magic), 1, file) != 1 ||
+      memcmp(magic, kAccessLogMagic, sizeof(magic)) != 0 ||
+      fread(&version, sizeof(version), 1, file) != 1 ||
+      version != kAccessLogVersion ||
+      fread(&record_size, sizeof(record_size), 1, file) != 1 ||
+      record_size != kAccessLogRecordSize) {
+    LOG(ERROR) << "Invalid access log (" << path << ").";
+    fclose(file);
+    return false;
+  }
+
+  AccessLogRecord record;
+  while (fread(&record, sizeof(record), 1, file) == 1) {
+    handler(record);
+  }
+  fclose(file);
+  return true;
+}
+
+}  // namespace filesystem
+}  // namespace client
+}  // namespace dingofs
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_CLIENT_FILESYSTEM_ASYNC_ACCESS_LOG_H_
+#define DINGOFS_SRC_CLIENT_FILESYSTEM_ASYNC_ACCESS_LOG_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/interruptible_sleeper.h"
+
+namespace spdlog {
+class logger;
+}
+
+namespace dingofs {
+namespace client {
+namespace filesystem {
+
+enum class AccessOp : uint8_t {
+  kUnknown = 0,
+  kInit,
+  kDestroy,
+  kLookup,
+  kGetAttr,
+  kSetAttr,
+  kReadLink,
+  kMkNod,
+  kMkDir,
+  kUnlink,
+  kRmDir,
+  kSymlink,
+  kRename,
+  kLink,
+  kOpen,
+  kRead,
+  kWrite,
+  kFlush,
+  kRelease,
+  kFsync,
+  kOpenDir,
+  kReadDir,
+  kReadDirPlus,
+  kReleaseDir,
+  kStatFs,
+  kSetXattr,
+  kGetXattr,
+  kListXattr,
+  kCreate,
+  kMax,
+};
+
+const char* StrAccessOp(AccessOp op);
+
+// The fixed-size binary access log record, it is also the on-disk layout of
+// binary access log:
+//
+//   | magic (8 bytes) | version (4 bytes) | record size (4 bytes) | record ...
+struct AccessLogRecord {
+  uint64_t timestamp_us;  // start time of the operation
+  uint64_t ino;
+  uint64_t offset;
+  uint64_t length;
+  uint32_t latency_us;
+  int32_t status;  // DINGOFS_ERROR
+  uint8_t op;      // AccessOp
+  uint8_t reserved[7];
+};
+
+static_assert(sizeof(AccessLogRecord) == 48,
+              "access log record layout changed");
+
+// e.g. "read (100,0,4096): OK <0.000120>"
+std::string StrAccessLogRecord(const AccessLogRecord& record);
+
+// Single-producer single-consumer ring buffer of access log records.
+// The producer never blocks, the record is dropped if the ring is full.
+class AccessLogRing {
+ public:
+  explicit AccessLogRing(size_t capacity);
+
+  bool Push(const AccessLogRecord& record);
+
+  size_t Pop(std::vector<AccessLogRecord>* records);
+
+  void Close() { closed_.store(true, std::memory_order_release); }
+
+  bool Closed() const { return closed_.load(std::memory_order_acquire); }
+
+  bool Empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+ private:
+  const uint64_t mask_;
+  std::unique_ptr<AccessLogRecord[]> slots_;
+  alignas(64) std::atomic<uint64_t> head_;  // written by producer
+  alignas(64) std::atomic<uint64_t> tail_;  // written by consumer
+  std::atomic<bool> closed_;
+};
+
+// Collects the access log records from per-thread rings and writes them in
+// a background thread, the FUSE thread only copies a record into its own
+// ring. The records are written as text (same as the synchronous access log)
+// or as binary records which can be decoded by dingo-access-log-decoder.
+class AsyncAccessLogger {
+ public:
+  static AsyncAccessLogger& GetInstance() {
+    static AsyncAccessLogger instance;
+    return instance;
+  }
+
+  // ring_capacity: the number of records buffered per thread
+  bool Start(const std::string& prefix, bool binary, size_t ring_capacity);
+
+  void Stop();
+
+  bool Running() const { return running_.load(std::memory_order_relaxed); }
+
+  void Append(const AccessLogRecord& record);
+
+  uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  // the path of access log file which currently written
+  std::string Path();
+
+ private:
+  AsyncAccessLogger();
+
+  std::shared_ptr<AccessLogRing> NewRing();
+
+  void DrainLoop();
+
+  void Drain();
+
+  void Write(const std::vector<AccessLogRecord>& records);
+
+ private:
+  std::atomic<bool> running_;
+  std::atomic<uint64_t> dropped_;
+  size_t ring_capacity_;
+  bool binary_;
+  std::string path_;
+  FILE* file_;
+  std::shared_ptr<spdlog::logger> logger_;
+  std::mutex mutex_;  // protect rings_
+  std::vector<std::shared_ptr<AccessLogRing>> rings_;
+  std::mutex drain_mutex_;
+  uint64_t reported_dropped_;
+  std::thread drain_thread_;
+  utils::InterruptibleSleeper sleeper_;
+};
+
+// Binary access log file reader, used by decoder and tests.
+class AccessLogReader {
+ public:
+  using Handler = std::function<void(const AccessLogRecord& record)>;
+
+  static bool ReadAll(const std::string& path, Handler handler);
+};
+
+}  // namespace filesystem
+}  // namespace client
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_CLIENT_FILESYSTEM_ASYNC_ACCESS_LOG_H_
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/filesystem/dentry_cache.h"
+
+#include <glog/logging.h>
+
+#include "absl/strings/str_format.h"
+#include "client/filesystem/utils.h"
+
+namespace dingofs {
+namespace client {
+namespace filesystem {
+
+using base::time::TimeSpec;
+using common::DentryCacheOption;
+using pb::metaserver::InodeAttr;
+using utils::LockGuard;
+
+#define RETURN_IF_DISABLED(rc) \
+  do {                         \
+    if (!enable_) {            \
+      return rc;               \
+    }                          \
+  } while (0)
+
+DentryCache::DentryCache(DentryCacheOption option)
+    : enable_(option.timeoutSec > 0 && option.lruSize > 0),
+      option_(option),
+      nextGeneration_(1) {
+  entries_ = std::make_shared<EntryLRU>(option.lruSize);
+  dirs_ = std::make_shared<DirLRU>(option.lruSize);
+  if (enable_) {
+    LOG(INFO) << "Using dentry cache, timeout = " << option.timeoutSec
+              << ", capacity = " << option.lruSize;
+  }
+}
+
+std::string DentryCache::CacheKey(Ino parent, const std::string& name) {
+  return absl::StrFormat("%d:%s", parent, name);
+}
+
+bool DentryCache::Get(Ino parent, const std::string& name, Ino* ino) {
+  RETURN_IF_DISABLED(false);
+  LockGuard lk(mutex_);
+  CacheEntry entry;
+  DirVersion dir;
+  auto key = CacheKey(parent, name);
+  if (!entries_->Get(key, &entry)) {
+    miss_ << 1;
+    return false;
+  } else if (!dirs_->Get(parent, &dir) || dir.generation != entry.generation ||
+             entry.expireTime < Now()) {
+    entries_->Remove(key);
+    miss_ << 1;
+    return false;
+  }
+
+  *ino = entry.ino;
+  if (entry.ino == 0) {
+    negativeHit_ << 1;
+  } else {
+    positiveHit_ << 1;
+  }
+  return true;
+}
+
+bool DentryCache::Begin(Ino parent, Token* token) {
+  RETURN_IF_DISABLED(false);
+  LockGuard lk(mutex_);
+  DirVersion dir;
+  if (!dirs_->Get(parent, &dir)) {
+    return false;
+  }
+  *token = Token{parent, dir.generation, dir.sequence};
+  return true;
+}
+
+bool DentryCache::Put(const Token& token, const std::string& name, Ino ino) {
+  RETURN_IF_DISABLED(false);
+  LockGuard lk(mutex_);
+  DirVersion dir;
+  if (!dirs_->Get(token.parent, &dir) || dir.generation != token.generation ||
+      dir.sequence != token.sequence) {
+    return false;  // parent changed during lookup
+  }
+
+  auto entry = CacheEntry{ino, dir.generation,
+                          Now() + TimeSpec(option_.timeoutSec, 0)};
+  entries_->Put(CacheKey(token.parent, name), entry);
+  return true;
+}
+
+void DentryCache::Delete(Ino parent, const std::string& name) {
+  RETURN_IF_DISABLED();
+  LockGuard lk(mutex_);
+  entries_->Remove(CacheKey(parent, name));
+}
+
+void DentryCache::Observe(const InodeAttr& attr) {
+  RETURN_IF_DISABLED();
+  if (!IsDir(attr)) {
+    return;
+  }
+
+  LockGuard lk(mutex_);
+  DirVersion dir;
+  auto mtime = AttrMtime(attr);
+  auto ctime = AttrCtime(attr);
+  if (!dirs_->Get(attr.inodeid(), &dir)) {
+    dir = DirVersion{mtime, ctime, nextGeneration_++, 0};
+  } else if (dir.mtime != mtime || dir.ctime != ctime) {
+    dir = DirVersion{mtime, ctime, nextGeneration_++, dir.sequence + 1};
+    dropped_ << 1;
+  } else {
+    return;
+  }
+  dirs_->Put(attr.inodeid(), dir);
+}
+
+void DentryCache::Modify(Ino parent, const std::string& name,
+                         const InodeAttr& before, const InodeAttr& after) {
+  RETURN_IF_DISABLED();
+  LockGuard lk(mutex_);
+  entries_->Remove(CacheKey(parent, name));
+
+  DirVersion dir;
+  if (!dirs_->Get(parent, &dir)) {
+    return;
+  }
+
+  // the directory may be changed remotely before our change
+  if (dir.mtime != AttrMtime(before) || dir.ctime != AttrCtime(before)) {
+    dir.generation = nextGeneration_++;
+    dropped_ << 1;
+  }
+  dir.mtime = AttrMtime(after);
+  dir.ctime = AttrCtime(after);
+  dir.sequence++;
+  dirs_->Put(parent, dir);
+}
+
+void DentryCache::Drop(Ino parent) {
+  RETURN_IF_DISABLED();
+  LockGuard lk(mutex_);
+  dirs_->Remove(parent);
+  dropped_ << 1;
+}
+
+}  // namespace filesystem
+}  // namespace client
+}  // namespace dingofs
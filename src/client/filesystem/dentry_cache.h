@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_CLIENT_FILESYSTEM_DENTRY_CACHE_H_
+#define DINGOFS_SRC_CLIENT_FILESYSTEM_DENTRY_CACHE_H_
+
+#include <bvar/bvar.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "dingofs/metaserver.pb.h"
+#include "base/time/time.h"
+#include "client/common/config.h"
+#include "client/filesystem/meta.h"
+#include "utils/concurrent/concurrent.h"
+#include "utils/lru_cache.h"
+
+namespace dingofs {
+namespace client {
+namespace filesystem {
+
+// Memory cache for lookup result, both found (positive) and not found
+// (negative) entries are cached.
+//
+// Every entry is tagged with the generation of its parent directory, the
+// generation is bumped once the directory is observed changed remotely
+// (the mtime or ctime differs from the one we known), which drops all
+// entries under it at once. The changes made by ourselves only drop the
+// entry of that name, the directory keeps its generation.
+//
+// The entry is cached only if we know the version of its parent, which is
+// learned from the attribute of directory replied by metaserver.
+class DentryCache {
+ public:
+  // the version of parent when a lookup starts, the result of lookup is
+  // cached only if the parent is not changed during the lookup.
+  struct Token {
+    Ino parent;
+    uint64_t generation;
+    uint64_t sequence;
+  };
+
+  explicit DentryCache(common::DentryCacheOption option);
+
+  // return true if hit, |*ino| is 0 for negative entry
+  bool Get(Ino parent, const std::string& name, Ino* ino);
+
+  // return false if the version of parent is unknown
+  bool Begin(Ino parent, Token* token);
+
+  // cache the lookup result, |ino| is 0 if the entry not found
+  bool Put(const Token& token, const std::string& name, Ino ino);
+
+  void Delete(Ino parent, const std::string& name);
+
+  // the attribute of directory replied by metaserver
+  void Observe(const pb::metaserver::InodeAttr& attr);
+
+  // the entry |name| under |parent| is changed by ourselves, |before| and
+  // |after| are the attributes of parent around the change.
+  void Modify(Ino parent, const std::string& name,
+              const pb::metaserver::InodeAttr& before,
+              const pb::metaserver::InodeAttr& after);
+
+  // drop all entries under |parent|
+  void Drop(Ino parent);
+
+ private:
+  struct DirVersion {
+    base::time::TimeSpec mtime;
+    base::time::TimeSpec ctime;
+    uint64_t generation;
+    uint64_t sequence;  // bumped by every change, include ourselves
+  };
+
+  struct CacheEntry {
+    Ino ino;
+    uint64_t generation;
+    base::time::TimeSpec expireTime;
+  };
+
+  using EntryLRU = utils::LRUCache<std::string, CacheEntry>;
+  using DirLRU = utils::LRUCache<Ino, DirVersion>;
+
+  static std::string CacheKey(Ino parent, const std::string& name);
+
+  bool enable_;
+  common::DentryCacheOption option_;
+  utils::Mutex mutex_;
+  uint64_t nextGeneration_;
+  std::shared_ptr<EntryLRU> entries_;
+  std::shared_ptr<DirLRU> dirs_;
+
+  bvar::Adder<uint64_t> positiveHit_{"fuse_dentry_cache", "positive_hit"};
+  bvar::Adder<uint64_t> negativeHit_{"fuse_dentry_cache", "negative_hit"};
+  bvar::Adder<uint64_t> miss_{"fuse_dentry_cache", "miss"};
+  bvar::Adder<uint64_t> dropped_{"fuse_dentry_cache", "dir_dropped"};
+};
+
+}  // namespace filesystem
+}  // namespace client
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_CLIENT_FILESYSTEM_DENTRY_CACHE_H_
@@ -22,6 +22,9 @@
 
 #include "client/filesystem/dir_cache.h"
 
+#include <glog/logging.h>
+
+#include <limits>
 #include <utility>
 
 #include "dingofs/metaserver.pb.h"
@@ -40,18 +43,88 @@ using utils::ReadLockGuard;
 using utils::RWLock;
 using utils::WriteLockGuard;
 
+using pb::metaserver::FsFileType;
 using pb::metaserver::InodeAttr;
 
-DirEntryList::DirEntryList() : rwlock_(), mtime_(), entries_(), index_() {}
+DirEntryList::DirEntryList()
+    : rwlock_(), mtime_(), entries_(), names_(), index_() {}
 
 size_t DirEntryList::Size() {
   ReadLockGuard lk(rwlock_);
   return entries_.size();
 }
 
+size_t DirEntryList::Bytes() {
+  ReadLockGuard lk(rwlock_);
+  return sizeof(*this) + entries_.capacity() * sizeof(PackedEntry) +
+         names_.capacity() +
+         index_.capacity() * (sizeof(std::pair<const Ino, uint32_t>) + 1);
+}
+
+void DirEntryList::Reserve(size_t n, size_t nameBytes) {
+  WriteLockGuard lk(rwlock_);
+  entries_.reserve(n);
+  names_.reserve(nameBytes);
+  index_.reserve(n);
+}
+
+void DirEntryList::Pack(const InodeAttr& attr, PackedEntry* entry) {
+  entry->length = attr.length();
+  entry->rdev = attr.rdev();
+  entry->atime = attr.atime();
+  entry->mtime = attr.mtime();
+  entry->ctime = attr.ctime();
+  entry->atimeNs = attr.atime_ns();
+  entry->mtimeNs = attr.mtime_ns();
+  entry->ctimeNs = attr.ctime_ns();
+  entry->fsId = attr.fsid();
+  entry->uid = attr.uid();
+  entry->gid = attr.gid();
+  entry->mode = attr.mode();
+  entry->nlink = attr.nlink();
+  entry->type = static_cast<uint8_t>(attr.type());
+}
+
+void DirEntryList::Unpack(size_t index, DirEntry* dirEntry) {
+  const PackedEntry& entry = entries_[index];
+  size_t nameEnd = (index + 1 < entries_.size())
+                       ? entries_[index + 1].nameOffset
+                       : names_.size();
+  dirEntry->ino = entry.ino;
+  dirEntry->name.assign(names_, entry.nameOffset, nameEnd - entry.nameOffset);
+
+  InodeAttr* attr = &dirEntry->attr;
+  attr->Clear();
+  attr->set_inodeid(entry.ino);
+  attr->set_fsid(entry.fsId);
+  attr->set_length(entry.length);
+  attr->set_rdev(entry.rdev);
+  attr->set_atime(entry.atime);
+  attr->set_atime_ns(entry.atimeNs);
+  attr->set_mtime(entry.mtime);
+  attr->set_mtime_ns(entry.mtimeNs);
+  attr->set_ctime(entry.ctime);
+  attr->set_ctime_ns(entry.ctimeNs);
+  attr->set_uid(entry.uid);
+  attr->set_gid(entry.gid);
+  attr->set_mode(entry.mode);
+  attr->set_nlink(entry.nlink);
+  attr->set_type(static_cast<FsFileType>(entry.type));
+}
+
 void DirEntryList::Add(const DirEntry& dirEntry) {
   WriteLockGuard lk(rwlock_);
-  entries_.push_back(std::move(dirEntry));
+  PackedEntry entry;
+  Pack(dirEntry.attr, &entry);
+  entry.ino = dirEntry.ino;
+  // the offset is packed in 32 bits, 4GiB names in one directory is far
+  // beyond the capacity of cache
+  CHECK_LE(names_.size() + dirEntry.name.size(),
+           std::numeric_limits<uint32_t>::max())
+      << "Too many names in directory cache";
+  entry.nameOffset = names_.size();
+  names_.append(dirEntry.name);
+  entries_.push_back(entry);
   index_[dirEntry.ino] = entries_.size() - 1;
 }
 
@@ -62,7 +135,7 @@ bool DirEntryList::Get(Ino ino, DirEntry* dirEntry) {
     return false;
   }
 
-  *dirEntry = entries_[iter->second];
+  Unpack(iter->second, dirEntry);
   return true;
 }
 
@@ -73,8 +146,7 @@ bool DirEntryList::UpdateAttr(Ino ino, const InodeAttr& attr) {
     return false;
   }
 
-  DirEntry* dirEntry = &entries_[iter->second];
-  dirEntry->attr = std::move(attr);
+  Pack(attr, &entries_[iter->second]);
   return true;
 }
 
@@ -85,29 +157,32 @@ bool DirEntryList::UpdateLength(Ino ino, const InodeAttr& open) {
     return false;
   }
 
-  DirEntry* dirEntry = &entries_[iter->second];
-  InodeAttr* attr = &(dirEntry->attr);
-  attr->set_length(open.length());
-  attr->set_mtime(open.mtime());
-  attr->set_mtime_ns(open.mtime_ns());
-  if (AttrCtime(open) > AttrCtime(*attr)) {
-    attr->set_ctime(open.ctime());
-    attr->set_ctime_ns(open.ctime_ns());
+  PackedEntry* entry = &entries_[iter->second];
+  entry->length = open.length();
+  entry->mtime = open.mtime();
+  entry->mtimeNs = open.mtime_ns();
+  if (AttrCtime(open) > TimeSpec(entry->ctime, entry->ctimeNs)) {
+    entry->ctime = open.ctime();
+    entry->ctimeNs = open.ctime_ns();
   }
   return true;
 }
 
 void DirEntryList::Iterate(IterateHandler handler) {
   ReadLockGuard lk(rwlock_);
-  for (auto iter = entries_.begin(); iter != entries_.end(); iter++) {
-    handler(&(*iter));
+  DirEntry dirEntry;
+  for (size_t i = 0; i < entries_.size(); i++) {
+    Unpack(i, &dirEntry);
+    handler(&dirEntry);
   }
 }
 
 void DirEntryList::Clear() {
   WriteLockGuard lk(rwlock_);
-  entries_.clear();
-  index_.clear();
+  // release the memory
+  std::vector<PackedEntry>().swap(entries_);
+  std::string().swap(names_);
+  absl::flat_hash_map<Ino, uint32_t>().swap(index_);
 }
 
 void DirEntryList::SetMtime(TimeSpec mtime) {
@@ -121,47 +196,52 @@ TimeSpec DirEntryList::GetMtime() {
 }
 
 DirCache::DirCache(DirCacheOption option)
-    : rwlock_(), nentries_(0), option_(option) {
+    : rwlock_(), nentries_(0), nbytes_(0), option_(option) {
   lru_ = std::make_shared<LRUType>(0);  // control size by ourself
   mq_ = std::make_shared<MessageQueueType>("dircache", 10000);
   mq_->Subscribe(
       [&](const std::shared_ptr<DirEntryList>& entries) { entries->Clear(); });
   metric_ = std::make_shared<DirCacheMetric>();
 
-  LOG(INFO) << "Using directory lru cache, capacity = " << option_.lruSize;
+  LOG(INFO) << "Using directory lru cache, capacity = " << option_.lruSize
+            << " entries, " << option_.capacityMB << " MiB";
 }
 
 void DirCache::Start() { mq_->Start(); }
 
 void DirCache::Stop() {
   WriteLockGuard lk(rwlock_);
-  Evit(option_.lruSize);
+  Evit(option_.lruSize, 0);
   mq_->Stop();
 }
 
-void DirCache::Delete(Ino parent, std::shared_ptr<DirEntryList> entries,
-                      bool evit) {
-  size_t ndelete = entries->Size();
-  nentries_ -= ndelete;
-  metric_->AddEntries(-static_cast<int64_t>(ndelete));
-  mq_->Publish(entries);  // clear entries in background
+void DirCache::Delete(Ino parent, const CacheEntry& entry, bool evit) {
+  nentries_ -= entry.nentries;
+  nbytes_ -= entry.nbytes;
+  metric_->AddEntries(-static_cast<int64_t>(entry.nentries));
+  metric_->AddBytes(-static_cast<int64_t>(entry.nbytes));
+  mq_->Publish(entry.entries);  // clear entries in background
   lru_->Remove(parent);
 
   VLOG(1) << "Delete directory cache (evit=" << evit
           << "): " << "parent = " << parent
-          << ", mtime = " << entries->GetMtime()
-          << ", delete size = " << ndelete << ", nentries = " << nentries_;
+          << ", mtime = " << entry.entries->GetMtime()
+          << ", delete size = " << entry.nentries
+          << ", delete bytes = " << entry.nbytes
+          << ", nentries = " << nentries_ << ", nbytes = " << nbytes_;
 }
 
-void DirCache::Evit(size_t size) {
+void DirCache::Evit(size_t nentries, size_t nbytes) {
+  size_t capacity = option_.capacityMB * 1024 * 1024;
   Ino parent;
-  std::shared_ptr<DirEntryList> entries;
-  while (nentries_ + size >= option_.lruSize) {
-    bool yes = lru_->GetLast(&parent, &entries);
+  CacheEntry entry;
+  while (nentries_ + nentries >= option_.lruSize ||
+         nbytes_ + nbytes >= capacity) {
+    bool yes = lru_->GetLast(&parent, &entry);
     if (!yes) {
       break;
     }
-    Delete(parent, entries, true);
+    Delete(parent, entry, true);
   }
 }
 
@@ -171,28 +251,46 @@ void DirCache::Put(Ino parent, std::shared_ptr<DirEntryList> entries) {
     return;
   }
 
-  Evit(entries->Size());  // it guarantee put entries success
-  lru_->Put(parent, entries);
-  int64_t ninsert = entries->Size();
-  nentries_ += ninsert;
-  metric_->AddEntries(static_cast<int64_t>(ninsert));
+  CacheEntry old;
+  if (lru_->Get(parent, &old)) {
+    if (old.entries == entries) {
+      return;
+    }
+    Delete(parent, old, false);
+  }
+
+  // the charge is remembered, the entries may be changed after inserted
+  CacheEntry entry{entries, entries->Size(), entries->Bytes()};
+  Evit(entry.nentries, entry.nbytes);  // it guarantee put entries success
+  lru_->Put(parent, entry);
+  nentries_ += entry.nentries;
+  nbytes_ += entry.nbytes;
+  metric_->AddEntries(static_cast<int64_t>(entry.nentries));
+  metric_->AddBytes(static_cast<int64_t>(entry.nbytes));
 
   VLOG(1) << "Insert directory cache: parent = " << parent
           << ", mtime = " << entries->GetMtime()
-          << ", insert size = " << ninsert << ", nentries = " << nentries_;
+          << ", insert size = " << entry.nentries
+          << ", insert bytes = " << entry.nbytes
+          << ", nentries = " << nentries_ << ", nbytes = " << nbytes_;
 }
 
 bool DirCache::Get(Ino parent, std::shared_ptr<DirEntryList>* entries) {
   ReadLockGuard lk(rwlock_);
-  return lru_->Get(parent, entries);
+  CacheEntry entry;
+  if (!lru_->Get(parent, &entry)) {
+    return false;
+  }
+  *entries = entry.entries;
+  return true;
 }
 
 void DirCache::Drop(Ino parent) {
   WriteLockGuard lk(rwlock_);
-  std::shared_ptr<DirEntryList> entries;
-  bool yes = lru_->Get(parent, &entries);
+  CacheEntry entry;
+  bool yes = lru_->Get(parent, &entry);
   if (yes) {
-    Delete(parent, entries, false);
+    Delete(parent, entry, false);
   }
 }
 
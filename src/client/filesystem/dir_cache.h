@@ -23,10 +23,12 @@
 #ifndef DINGOFS_SRC_CLIENT_FILESYSTEM_DIR_CACHE_H_
 #define DINGOFS_SRC_CLIENT_FILESYSTEM_DIR_CACHE_H_
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
-#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
 #include "base/queue/message_queue.h"
 #include "base/time/time.h"
 #include "client/common/config.h"
@@ -39,6 +41,13 @@ namespace dingofs {
 namespace client {
 namespace filesystem {
 
+// The entries of one directory.
+//
+// A directory may have millions of entries, so the entries are not kept as
+// DirEntry (a std::string and a full InodeAttr each), but packed into a
+// fixed-size struct which only holds the fields replied to kernel, and all
+// names are appended to one string pool. The DirEntry is rebuilt when it is
+// read by Get() or Iterate().
 class DirEntryList {
  public:
   using IterateHandler = std::function<void(DirEntry* dirEntry)>;
@@ -47,6 +56,12 @@ class DirEntryList {
 
   size_t Size();
 
+  // the memory used by entries, in bytes
+  size_t Bytes();
+
+  // reserve the space for |n| entries whose names are |nameBytes| in total
+  void Reserve(size_t n, size_t nameBytes);
+
   void Add(const DirEntry& dirEntry);
 
   void Iterate(IterateHandler handler);
@@ -64,15 +79,46 @@ class DirEntryList {
   base::time::TimeSpec GetMtime();
 
  private:
+  struct PackedEntry {
+    uint64_t ino;
+    uint64_t length;
+    uint64_t rdev;
+    uint64_t atime;
+    uint64_t mtime;
+    uint64_t ctime;
+    uint32_t atimeNs;
+    uint32_t mtimeNs;
+    uint32_t ctimeNs;
+    uint32_t fsId;
+    uint32_t uid;
+    uint32_t gid;
+    uint32_t mode;
+    uint32_t nlink;
+    uint32_t nameOffset;  // name ends at the offset of next entry
+    uint8_t type;
+  };
+
+  static void Pack(const pb::metaserver::InodeAttr& attr, PackedEntry* entry);
+
+  // NOTE: the following functions should be called with rwlock_ held
+  void Unpack(size_t index, DirEntry* dirEntry);
+
   utils::RWLock rwlock_;
   base::time::TimeSpec mtime_;
-  std::vector<DirEntry> entries_;
-  absl::btree_map<Ino, uint32_t> index_;
+  std::vector<PackedEntry> entries_;
+  std::string names_;
+  absl::flat_hash_map<Ino, uint32_t> index_;
 };
 
 class DirCache {
  public:
-  using LRUType = utils::LRUCache<Ino, std::shared_ptr<DirEntryList>>;
+  struct CacheEntry {
+    std::shared_ptr<DirEntryList> entries;
+    size_t nentries;  // charged when inserted
+    size_t nbytes;
+  };
+
+  using LRUType = utils::LRUCache<Ino, CacheEntry>;
   using MessageType = std::shared_ptr<DirEntryList>;
   using MessageQueueType = base::queue::MessageQueue<MessageType>;
 
@@ -89,12 +135,15 @@ class DirCache {
   void Drop(Ino parent);
 
  private:
-  void Delete(Ino parent, std::shared_ptr<DirEntryList> entries, bool evit);
+  void Delete(Ino parent, const CacheEntry& entry, bool evit);
 
-  void Evit(size_t size);
+  // evict the least recently used directories until there is room for
+  // |nentries| entries which use |nbytes| memory
+  void Evit(size_t nentries, size_t nbytes);
 
   utils::RWLock rwlock_;
   size_t nentries_;
+  size_t nbytes_;
   common::DirCacheOption option_;
   std::shared_ptr<LRUType> lru_;
   std::shared_ptr<MessageQueueType> mq_;
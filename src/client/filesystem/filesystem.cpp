@@ -22,6 +22,7 @@
 
 #include "client/filesystem/filesystem.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 
@@ -50,8 +51,25 @@ USING_FLAG(stat_timer_thread_num);
 FileSystem::FileSystem(uint32_t fs_id, std::string fs_name,
                        FileSystemOption option, ExternalMember member)
     : fs_id_(fs_id), fs_name_(fs_name), option_(option), member(member) {
+  // without active invalidation the entry changed remotely is only dropped
+  // once we fetch the attribute of its parent again, so it can't be cached
+  // longer than kernel caches the entries.
+  auto& kernelCacheOption = option_.kernelCacheOption;
+  auto& dentryCacheOption = option_.dentryCacheOption;
+  uint32_t maxTimeoutSec = std::min(kernelCacheOption.entryTimeoutSec,
+                                    kernelCacheOption.dirEntryTimeoutSec);
+  if (!kernelCacheOption.activeInvalidate &&
+      dentryCacheOption.timeoutSec > maxTimeoutSec) {
+    LOG(WARNING) << "Dentry cache timeout (" << dentryCacheOption.timeoutSec
+                 << "s) exceeds the kernel entry timeout without active "
+                    "invalidation, use "
+                 << maxTimeoutSec << "s instead";
+    dentryCacheOption.timeoutSec = maxTimeoutSec;
+  }
+
   deferSync_ = std::make_shared<DeferSync>(option.deferSyncOption);
   negative_ = std::make_shared<LookupCache>(option.lookupCacheOption);
+  dentryCache_ = std::make_shared<DentryCache>(option_.dentryCacheOption);
   dirCache_ = std::make_shared<DirCache>(option.dirCacheOption);
   openFiles_ = std::make_shared<OpenFiles>(option_.openFilesOption, deferSync_);
   attrWatcher_ = std::make_shared<AttrWatcher>(option_.attrWatcherOption,
@@ -59,6 +77,9 @@ FileSystem::FileSystem(uint32_t fs_id, std::string fs_name,
   entry_watcher_ = std::make_shared<EntryWatcher>(option_.nocto_suffix);
   handlerManager_ = std::make_shared<HandlerManager>();
   rpc_ = std::make_shared<RPCClient>(option.rpcOption, member);
+  invalidator_ = std::make_shared<KernelInvalidator>(
+      option_.kernelCacheOption, member.inodeManager, openFiles_, dirCache_,
+      dentryCache_);
 }
 
 void FileSystem::Run() {
@@ -84,9 +105,18 @@ void FileSystem::Run() {
   fs_stat_manager_->Start();
   dir_quota_manager_->Start();
   fs_push_metrics_manager_->Start();
+
+  if (option_.kernelCacheOption.activeInvalidate) {
+    if (notifier_ != nullptr) {
+      invalidator_->Start(notifier_);
+    } else {
+      LOG(WARNING) << "Active invalidate is disabled: fuse session not set";
+    }
+  }
 }
 
 void FileSystem::Destory() {
+  invalidator_->Stop();
   openFiles_->CloseAll();
   deferSync_->Stop();
   dirCache_->Stop();
@@ -97,6 +127,10 @@ void FileSystem::Destory() {
   fs_push_metrics_manager_->Stop();
 }
 
+void FileSystem::SetSession(struct fuse_session* session) {
+  notifier_ = std::make_shared<FuseKernelNotifier>(session);
+}
+
 void FileSystem::Attr2Stat(InodeAttr* attr, struct stat* stat) {
   std::memset(stat, 0, sizeof(struct stat));
   stat->st_ino = attr->inodeid();        //  inode number
@@ -148,18 +182,43 @@ void FileSystem::SetAttrTimeout(AttrOut* attr_out) {
   }
 }
 
+void FileSystem::WatchEntry(Ino parent, const std::string& name,
+                            EntryOut* entry_out) {
+  if (!invalidator_->Running() ||
+      entry_out->attr.inodeid() == STATSINODEID) {
+    return;
+  }
+
+  auto timeout = option_.kernelCacheOption.invalidateTimeoutSec;
+  entry_out->attrTimeout = timeout;
+  if (invalidator_->WatchEntry(parent, name, entry_out->attr)) {
+    entry_out->entryTimeout = timeout;
+  }
+}
+
+void FileSystem::WatchAttr(AttrOut* attr_out) {
+  if (!invalidator_->Running() || attr_out->attr.inodeid() == STATSINODEID) {
+    return;
+  }
+
+  invalidator_->Watch(attr_out->attr);
+  attr_out->attrTimeout = option_.kernelCacheOption.invalidateTimeoutSec;
+}
+
 // fuse reply*
 void FileSystem::ReplyError(Request req, DINGOFS_ERROR code) {
   fuse_reply_err(req, SysErr(code));
 }
 
-void FileSystem::ReplyEntry(Request req, EntryOut* entry_out) {
+void FileSystem::ReplyEntry(Request req, Ino parent, const std::string& name,
+                            EntryOut* entry_out) {
   AttrWatcherGuard watcher(attrWatcher_, &entry_out->attr, ReplyType::ATTR,
                            true);
   DirParentWatcherGuard parent_watcher(dir_parent_watcher_, entry_out->attr);
 
   fuse_entry_param e;
   SetEntryTimeout(entry_out);
+  WatchEntry(parent, name, entry_out);
   Entry2Param(entry_out, &e);
   fuse_reply_entry(req, &e);
 }
@@ -169,6 +228,7 @@ void FileSystem::ReplyAttr(Request req, AttrOut* attr_out) {
                            true);
   struct stat stat;
   SetAttrTimeout(attr_out);
+  WatchAttr(attr_out);
   Attr2Stat(&attr_out->attr, &stat);
   fuse_reply_attr(req, &stat, attr_out->attrTimeout);
 }
@@ -210,11 +270,13 @@ void FileSystem::ReplyXattr(Request req, size_t size) {
   fuse_reply_xattr(req, size);
 }
 
-void FileSystem::ReplyCreate(Request req, EntryOut* entry_out, FileInfo* fi) {
+void FileSystem::ReplyCreate(Request req, Ino parent, const std::string& name,
+                             EntryOut* entry_out, FileInfo* fi) {
   AttrWatcherGuard watcher(attrWatcher_, &entry_out->attr, ReplyType::ATTR,
                            true);
   fuse_entry_param e;
   SetEntryTimeout(entry_out);
+  WatchEntry(parent, name, entry_out);
   Entry2Param(entry_out, &e);
   fuse_reply_create(req, &e, fi);
 }
@@ -228,28 +290,31 @@ void FileSystem::AddDirEntry(Request req, DirBufferHead* buffer,
   // add a directory entry to the buffer
   size_t oldsize = buffer->size;
   const char* name = dir_entry->name.c_str();
-  buffer->size += fuse_add_direntry(req, NULL, 0, name, NULL, 0);
-  buffer->p = static_cast<char*>(realloc(buffer->p, buffer->size));
+  size_t entrysize = fuse_add_direntry(req, NULL, 0, name, NULL, 0);
+  buffer->Reserve(oldsize + entrysize);
+  buffer->size += entrysize;
   fuse_add_direntry(req,
                     buffer->p + oldsize,     // char* buf
                     buffer->size - oldsize,  // size_t bufisze
                     name, &stat, buffer->size);
 }
 
-void FileSystem::AddDirEntryPlus(Request req, DirBufferHead* buffer,
-                                 DirEntry* dir_entry) {
+void FileSystem::AddDirEntryPlus(Request req, Ino parent,
+                                 DirBufferHead* buffer, DirEntry* dir_entry) {
   AttrWatcherGuard watcher(attrWatcher_, &dir_entry->attr, ReplyType::ATTR,
                            false);
   struct fuse_entry_param e;
   EntryOut entryOut(dir_entry->attr);
   SetEntryTimeout(&entryOut);
+  WatchEntry(parent, dir_entry->name, &entryOut);
   Entry2Param(&entryOut, &e);
 
   // add a directory entry to the buffer with the attributes
   size_t oldsize = buffer->size;
   const char* name = dir_entry->name.c_str();
-  buffer->size += fuse_add_direntry_plus(req, NULL, 0, name, NULL, 0);
-  buffer->p = static_cast<char*>(realloc(buffer->p, buffer->size));
+  size_t entrysize = fuse_add_direntry_plus(req, NULL, 0, name, NULL, 0);
+  buffer->Reserve(oldsize + entrysize);
+  buffer->size += entrysize;
   fuse_add_direntry_plus(req,
                          buffer->p + oldsize,     // char* buf
                          buffer->size - oldsize,  // size_t bufisze
@@ -269,6 +334,17 @@ void FileSystem::ReleaseHandler(uint64_t fh) {
   return handlerManager_->ReleaseHandler(fh);
 }
 
+void FileSystem::InvalidateDentry(Ino parent, const std::string& name,
+                                  const InodeAttr& before,
+                                  const InodeAttr& after) {
+  negative_->Delete(parent, name);
+  dentryCache_->Modify(parent, name, before, after);
+}
+
+void FileSystem::InvalidateDentries(Ino parent) {
+  dentryCache_->Drop(parent);
+}
+
 FileSystemMember FileSystem::BorrowMember() {
   return FileSystemMember(deferSync_, openFiles_, attrWatcher_, entry_watcher_);
 }
@@ -280,16 +356,39 @@ DINGOFS_ERROR FileSystem::Lookup(Request req, Ino parent,
     return DINGOFS_ERROR::NAMETOOLONG;
   }
 
-  bool yes = negative_->Get(parent, name);
+  // the attribute is always fetched, only the dentry is saved
+  Ino ino;
+  bool yes = dentryCache_->Get(parent, name, &ino);
+  if (yes && ino == 0) {
+    return DINGOFS_ERROR::NOTEXIST;
+  } else if (yes) {
+    auto rc = rpc_->GetAttr(ino, &entry_out->attr);
+    if (rc == DINGOFS_ERROR::OK && entry_out->attr.nlink() > 0) {
+      dentryCache_->Observe(entry_out->attr);
+      return rc;
+    }
+    dentryCache_->Delete(parent, name);
+  }
+
+  yes = negative_->Get(parent, name);
   if (yes) {
     return DINGOFS_ERROR::NOTEXIST;
   }
 
+  DentryCache::Token token;
+  bool cacheable = dentryCache_->Begin(parent, &token);
   auto rc = rpc_->Lookup(parent, name, entry_out);
   if (rc == DINGOFS_ERROR::OK) {
     negative_->Delete(parent, name);
+    dentryCache_->Observe(entry_out->attr);
+    if (cacheable) {
+      dentryCache_->Put(token, name, entry_out->attr.inodeid());
+    }
   } else if (rc == DINGOFS_ERROR::NOTEXIST) {
     negative_->Put(parent, name);
+    if (cacheable) {
+      dentryCache_->Put(token, name, 0);
+    }
   }
   return rc;
 }
@@ -298,6 +397,7 @@ DINGOFS_ERROR FileSystem::GetAttr(Request req, Ino ino, AttrOut* attr_out) {
   InodeAttr attr;
   auto rc = rpc_->GetAttr(ino, &attr);
   if (rc == DINGOFS_ERROR::OK) {
+    dentryCache_->Observe(attr);
     *attr_out = AttrOut(attr);
   }
   return rc;
@@ -309,6 +409,7 @@ DINGOFS_ERROR FileSystem::OpenDir(Request req, Ino ino, FileInfo* fi) {
   if (rc != DINGOFS_ERROR::OK) {
     return rc;
   }
+  dentryCache_->Observe(attr);
 
   // revalidate directory cache
   std::shared_ptr<DirEntryList> entries;
@@ -332,11 +433,19 @@ DINGOFS_ERROR FileSystem::ReadDir(Request req, Ino ino, FileInfo* fi,
     return DINGOFS_ERROR::OK;
   }
 
+  DentryCache::Token token;
+  bool cacheable = dentryCache_->Begin(ino, &token);
   DINGOFS_ERROR rc = rpc_->ReadDir(ino, entries);
   if (rc != DINGOFS_ERROR::OK) {
     return rc;
   }
 
+  if (cacheable) {
+    (*entries)->Iterate([&](DirEntry* dir_entry) {
+      dentryCache_->Put(token, dir_entry->name, dir_entry->ino);
+    });
+  }
+
   (*entries)->SetMtime(FindHandler(fi->fh)->mtime);
   dirCache_->Put(ino, *entries);
   return DINGOFS_ERROR::OK;
@@ -352,7 +461,8 @@ DINGOFS_ERROR FileSystem::Open(Request req, Ino ino, FileInfo* fi) {
   bool yes = openFiles_->IsOpened(ino, &inode);
   if (yes) {
     openFiles_->Open(ino, inode);
-    // fi->keep_cache = 1;
+    // the page cache is invalidated once the file changed remotely
+    fi->keep_cache = invalidator_->Running() && invalidator_->IsWatched(ino);
     return DINGOFS_ERROR::OK;
   }
 
@@ -376,6 +486,7 @@ DINGOFS_ERROR FileSystem::Open(Request req, Ino ino, FileInfo* fi) {
   }
 
   openFiles_->Open(ino, inode);
+  fi->keep_cache = invalidator_->Running() && invalidator_->IsWatched(ino);
   return DINGOFS_ERROR::OK;
 }
 
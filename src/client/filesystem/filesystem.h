@@ -33,6 +33,7 @@
 #include "client/common/config.h"
 #include "client/filesystem/attr_watcher.h"
 #include "client/filesystem/defer_sync.h"
+#include "client/filesystem/dentry_cache.h"
 #include "client/filesystem/dir_cache.h"
 #include "client/filesystem/dir_parent_watcher.h"
 #include "client/filesystem/dir_quota_manager.h"
@@ -40,6 +41,7 @@
 #include "client/filesystem/error.h"
 #include "client/filesystem/fs_push_metric_manager.h"
 #include "client/filesystem/fs_stat_manager.h"
+#include "client/filesystem/kernel_invalidator.h"
 #include "client/filesystem/lookup_cache.h"
 #include "client/filesystem/meta.h"
 #include "client/filesystem/openfile.h"
@@ -75,6 +77,10 @@ class FileSystem {
 
   void Destory();
 
+  // the kernel invalidator needs the fuse session to notify kernel,
+  // should be set before Run()
+  void SetSession(struct fuse_session* session);
+
   // fuse request
   DINGOFS_ERROR Lookup(Request req, Ino parent, const std::string& name,
                        EntryOut* entry_out);
@@ -95,7 +101,8 @@ class FileSystem {
   // fuse reply: we control all replies to vfs layer in same entrance.
   void ReplyError(Request req, DINGOFS_ERROR code);
 
-  void ReplyEntry(Request req, EntryOut* entry_out);
+  void ReplyEntry(Request req, Ino parent, const std::string& name,
+                  EntryOut* entry_out);
 
   void ReplyAttr(Request req, AttrOut* attr_out);
 
@@ -116,11 +123,13 @@ class FileSystem {
 
   void ReplyXattr(Request req, size_t size);
 
-  void ReplyCreate(Request req, EntryOut* entry_out, FileInfo* fi);
+  void ReplyCreate(Request req, Ino parent, const std::string& name,
+                   EntryOut* entry_out, FileInfo* fi);
 
   void AddDirEntry(Request req, DirBufferHead* buffer, DirEntry* dir_entry);
 
-  void AddDirEntryPlus(Request req, DirBufferHead* buffer, DirEntry* dir_entry);
+  void AddDirEntryPlus(Request req, Ino parent, DirBufferHead* buffer,
+                       DirEntry* dir_entry);
 
   // utility: file handler
   std::shared_ptr<FileHandler> NewHandler();
@@ -132,6 +141,13 @@ class FileSystem {
   // utility: others
   FileSystemMember BorrowMember();
 
+  // utility: the entries under |parent| changed by ourselves
+  void InvalidateDentry(Ino parent, const std::string& name,
+                        const pb::metaserver::InodeAttr& before,
+                        const pb::metaserver::InodeAttr& after);
+
+  void InvalidateDentries(Ino parent);
+
   // ----------- dispatch request  -----------
   void UpdateFsQuotaUsage(int64_t add_space, int64_t add_inode);
   void UpdateDirQuotaUsage(Ino ino, int64_t add_space, int64_t add_inode);
@@ -164,18 +180,27 @@ class FileSystem {
 
   void SetAttrTimeout(AttrOut* attr_out);
 
+  // utility: watch what kernel caches, which will be invalidated actively,
+  // so it can be cached with a long timeout
+  void WatchEntry(Ino parent, const std::string& name, EntryOut* entry_out);
+
+  void WatchAttr(AttrOut* attr_out);
+
   uint32_t fs_id_;
   std::string fs_name_;
   common::FileSystemOption option_;
   ExternalMember member;
   std::shared_ptr<DeferSync> deferSync_;
   std::shared_ptr<LookupCache> negative_;
+  std::shared_ptr<DentryCache> dentryCache_;
   std::shared_ptr<DirCache> dirCache_;
   std::shared_ptr<OpenFiles> openFiles_;
   std::shared_ptr<AttrWatcher> attrWatcher_;
   std::shared_ptr<EntryWatcher> entry_watcher_;
   std::shared_ptr<HandlerManager> handlerManager_;
   std::shared_ptr<RPCClient> rpc_;
+  std::shared_ptr<KernelNotifier> notifier_;
+  std::shared_ptr<KernelInvalidator> invalidator_;
 
   std::shared_ptr<DirParentWatcher> dir_parent_watcher_;
   // NOTE: filesytem own this timer, when destroy or stop, first stop
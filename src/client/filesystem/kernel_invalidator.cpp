@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/filesystem/kernel_invalidator.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <set>
+
+#include "client/filesystem/utils.h"
+
+namespace dingofs {
+namespace client {
+namespace filesystem {
+
+using ::dingofs::common::ChangeRecord;
+using ::dingofs::common::ChangeType;
+using pb::metaserver::InodeAttr;
+using utils::LockGuard;
+
+namespace {
+
+// the names remembered for one directory, entries beyond it are replied
+// with the short timeout instead.
+constexpr size_t kMaxNamesPerDir = 65536;
+
+}  // namespace
+
+void FuseKernelNotifier::InvalidateInode(Ino ino) {
+  int rc = fuse_lowlevel_notify_inval_inode(session_, ino, 0, 0);
+  if (rc != 0 && rc != -ENOENT) {
+    LOG(WARNING) << "Invalidate kernel inode failed, ino = " << ino
+                 << ", rc = " << rc;
+  }
+}
+
+void FuseKernelNotifier::InvalidateEntry(Ino parent, const std::string& name) {
+  int rc = fuse_lowlevel_notify_inval_entry(session_, parent, name.c_str(),
+                                            name.size());
+  if (rc != 0 && rc != -ENOENT) {
+    LOG(WARNING) << "Invalidate kernel entry failed, parent = " << parent
+                 << ", name = " << name << ", rc = " << rc;
+  }
+}
+
+KernelInvalidator::KernelInvalidator(
+    common::KernelCacheOption option,
+    std::shared_ptr<InodeCacheManager> inodeManager,
+    std::shared_ptr<OpenFiles> openFiles, std::shared_ptr<DirCache> dirCache,
+    std::shared_ptr<DentryCache> dentryCache)
+    : option_(option),
+      inodeManager_(inodeManager),
+      openFiles_(openFiles),
+      dirCache_(dirCache),
+      dentryCache_(dentryCache),
+      running_(false) {
+  // a remote change reaches the kernel within one round of polling, which
+  // must not be longer than the timeout the kernel caches for
+  uint64_t maxWatchSize =
+      static_cast<uint64_t>(option_.invalidateTimeoutSec) * 1000 /
+      std::max(option_.invalidateIntervalMs, 1U) * option_.invalidateBatchSize;
+  if (option_.invalidateWatchSize > maxWatchSize) {
+    LOG(WARNING) << "Polling " << option_.invalidateWatchSize
+                 << " inodes takes longer than the invalidate timeout ("
+                 << option_.invalidateTimeoutSec << "s), watch at most "
+                 << maxWatchSize << " inodes";
+    option_.invalidateWatchSize = maxWatchSize;
+  }
+}
+
+void KernelInvalidator::Start(std::shared_ptr<KernelNotifier> notifier) {
+  if (!running_.exchange(true)) {
+    notifier_ = notifier;
+    thread_ = std::thread(&KernelInvalidator::PollTask, this);
+    LOG(INFO) << "Kernel invalidator start success, interval = "
+              << option_.invalidateIntervalMs
+              << "ms, batch = " << option_.invalidateBatchSize;
+  }
+}
+
+void KernelInvalidator::Stop() {
+  if (running_.exchange(false)) {
+    LOG(INFO) << "Stop kernel invalidator...";
+    sleeper_.interrupt();
+    thread_.join();
+    LOG(INFO) << "Kernel invalidator stopped";
+  }
+}
+
+void KernelInvalidator::PollTask() {
+  auto interval = std::chrono::milliseconds(option_.invalidateIntervalMs);
+  while (sleeper_.wait_for(interval)) {
+    CheckOnce();
+  }
+}
+
+KernelInvalidator::Version KernelInvalidator::GetVersion(
+    const InodeAttr& attr) {
+  return Version{AttrMtime(attr), AttrCtime(attr), attr.length(),
+                 attr.nlink()};
+}
+
+void KernelInvalidator::Watch(const InodeAttr& attr) {
+  LockGuard lk(mutex_);
+  Touch(attr);
+}
+
+bool KernelInvalidator::WatchEntry(Ino parent, const std::string& name,
+                                   const InodeAttr& attr) {
+  LockGuard lk(mutex_);
+  Touch(attr);
+
+  auto iter = watched_.find(parent);
+  if (iter == watched_.end()) {
+    return false;
+  }
+
+  auto& children = iter->second.children;
+  if (children.size() >= kMaxNamesPerDir && children.count(name) == 0) {
+    return false;
+  }
+  children[name] = attr.inodeid();
+  return true;
+}
+
+bool KernelInvalidator::IsWatched(Ino ino) {
+  LockGuard lk(mutex_);
+  return watched_.find(ino) != watched_.end();
+}
+
+size_t KernelInvalidator::Size() {
+  LockGuard lk(mutex_);
+  return watched_.size();
+}
+
+void KernelInvalidator::Touch(const InodeAttr& attr) {
+  Ino ino = attr.inodeid();
+  auto version = GetVersion(attr);
+  auto iter = watched_.find(ino);
+  if (iter != watched_.end()) {
+    auto* watched = &iter->second;
+    lru_.splice(lru_.begin(), lru_, watched->lru);
+    // the kernel gets the fresh attribute with this reply, but the names it
+    // cached under the changed directory may be stale, and with writeback
+    // cache the kernel keeps the pages even if the mtime changed.
+    std::shared_ptr<InodeWrapper> inode;
+    if (watched->version == version) {
+      // nothing changed
+    } else if (watched->isDir) {
+      for (const auto& child : watched->children) {
+        pending_.push_back(Invalidation{ino, child.first});
+      }
+      watched->children.clear();
+    } else if (openFiles_ == nullptr || !openFiles_->IsOpened(ino, &inode)) {
+      pending_.push_back(Invalidation{ino, ""});
+    }
+    watched->version = version;
+    return;
+  }
+
+  lru_.push_front(ino);
+  auto& watched = watched_[ino];
+  watched.lru = lru_.begin();
+  watched.isDir = IsDir(attr);
+  watched.version = version;
+  Evict();
+}
+
+void KernelInvalidator::Evict() {
+  // the kernel keeps what it cached for a long time, so the inode which
+  // is not watched anymore must be dropped from kernel too.
+  while (watched_.size() > option_.invalidateWatchSize && !lru_.empty()) {
+    Ino ino = lru_.back();
+    auto iter = watched_.find(ino);
+    Invalidate(ino, &iter->second);
+    lru_.pop_back();
+    watched_.erase(iter);
+  }
+}
+
+void KernelInvalidator::Invalidate(Ino ino, Watched* watched) {
+  pending_.push_back(Invalidation{ino, ""});
+  for (const auto& child : watched->children) {
+    pending_.push_back(Invalidation{ino, child.first});
+  }
+  watched->children.clear();
+
+  if (watched->isDir && dirCache_ != nullptr) {
+    dirCache_->Drop(ino);
+  }
+}
+
+size_t KernelInvalidator::OnChanged(const std::vector<InodeAttr>& attrs,
+                                    const std::vector<Ino>& deleted) {
+  size_t count = 0;
+  LockGuard lk(mutex_);
+  for (const auto& attr : attrs) {
+    if (dentryCache_ != nullptr) {
+      dentryCache_->Observe(attr);
+    }
+
+    auto iter = watched_.find(attr.inodeid());
+    if (iter == watched_.end()) {
+      continue;
+    }
+
+    auto* watched = &iter->second;
+    auto version = GetVersion(attr);
+    if (watched->version == version) {
+      continue;
+    }
+    watched->version = version;
+
+    // the file opened locally is changed by ourselves, its page cache
+    // is coherent already.
+    std::shared_ptr<InodeWrapper> inode;
+    if (!watched->isDir && openFiles_ != nullptr &&
+        openFiles_->IsOpened(attr.inodeid(), &inode)) {
+      continue;
+    }
+    Invalidate(attr.inodeid(), watched);
+    count++;
+  }
+
+  for (Ino ino : deleted) {
+    if (dentryCache_ != nullptr) {
+      dentryCache_->Drop(ino);
+    }
+
+    auto iter = watched_.find(ino);
+    if (iter == watched_.end()) {
+      continue;
+    }
+    Invalidate(ino, &iter->second);
+    lru_.erase(iter->second.lru);
+    watched_.erase(iter);
+    count++;
+  }
+  return count;
+}
+
+size_t KernelInvalidator::OnChangeRecords(
+    const std::vector<ChangeRecord>& records) {
+  size_t count = 0;
+  LockGuard lk(mutex_);
+  for (const auto& record : records) {
+    // the dentries cached by client are dropped whether kernel caches them
+    if (dentryCache_ != nullptr && (record.type == ChangeType::kDentry ||
+                                    record.type == ChangeType::kDelete)) {
+      dentryCache_->Drop(record.inodeId);
+    }
+
+    auto iter = watched_.find(record.inodeId);
+    if (iter == watched_.end()) {
+      continue;
+    }
+
+    auto* watched = &iter->second;
+    std::shared_ptr<InodeWrapper> inode;
+    switch (record.type) {
+      case ChangeType::kInode:
+        if (!watched->isDir && openFiles_ != nullptr &&
+            openFiles_->IsOpened(record.inodeId, &inode)) {
+          continue;
+        }
+        Invalidate(record.inodeId, watched);
+        break;
+
+      case ChangeType::kDentry:
+        // the directory itself is changed too (mtime, nlink)
+        Invalidate(record.inodeId, watched);
+        break;
+
+      case ChangeType::kDelete:
+        Invalidate(record.inodeId, watched);
+        lru_.erase(watched->lru);
+        watched_.erase(iter);
+        break;
+
+      default:
+        continue;
+    }
+    count++;
+  }
+  return count;
+}
+
+// The metaserver fails the whole batch if any inode is not found (or its
+// nlink is 0), so the failed batch is split until the deleted ones found.
+DINGOFS_ERROR KernelInvalidator::GetAttrs(const std::vector<Ino>& inos,
+                                          std::list<InodeAttr>* attrs) {
+  std::set<uint64_t> request(inos.begin(), inos.end());
+  std::list<InodeAttr> out;
+  auto rc = inodeManager_->BatchGetInodeAttr(&request, &out);
+  if (rc == DINGOFS_ERROR::OK) {
+    attrs->splice(attrs->end(), out);
+    return rc;
+  } else if (rc != DINGOFS_ERROR::NOTEXIST) {
+    return rc;
+  } else if (inos.size() == 1) {
+    return DINGOFS_ERROR::OK;  // deleted
+  }
+
+  auto middle = inos.begin() + inos.size() / 2;
+  rc = GetAttrs(std::vector<Ino>(inos.begin(), middle), attrs);
+  if (rc != DINGOFS_ERROR::OK) {
+    return rc;
+  }
+  return GetAttrs(std::vector<Ino>(middle, inos.end()), attrs);
+}
+
+size_t KernelInvalidator::CheckOnce() {
+  std::set<uint64_t> inos;
+  {
+    LockGuard lk(mutex_);
+    if (cursor_.empty()) {
+      cursor_.assign(lru_.begin(), lru_.end());
+    }
+    while (!cursor_.empty() && inos.size() < option_.invalidateBatchSize) {
+      Ino ino = cursor_.back();
+      cursor_.pop_back();
+      if (watched_.find(ino) != watched_.end()) {
+        inos.insert(ino);
+      }
+    }
+  }
+
+  if (!inos.empty()) {
+    std::list<InodeAttr> out;
+    auto rc = GetAttrs(std::vector<Ino>(inos.begin(), inos.end()), &out);
+    if (rc == DINGOFS_ERROR::OK) {
+      polled_ << inos.size();
+      std::vector<InodeAttr> attrs(out.begin(), out.end());
+      for (const auto& attr : attrs) {
+        inos.erase(attr.inodeid());
+      }
+      OnChanged(attrs, std::vector<Ino>(inos.begin(), inos.end()));
+    } else {
+      LOG(WARNING) << "Poll the attributes of watched inodes failed, rc = "
+                   << rc;
+    }
+  }
+
+  std::vector<Invalidation> pending;
+  {
+    LockGuard lk(mutex_);
+    pending.swap(pending_);
+  }
+
+  if (notifier_ == nullptr) {
+    return 0;
+  }
+  for (const auto& item : pending) {
+    if (item.name.empty()) {
+      notifier_->InvalidateInode(item.ino);
+      inodeInvalidated_ << 1;
+    } else {
+      notifier_->InvalidateEntry(item.ino, item.name);
+      entryInvalidated_ << 1;
+    }
+  }
+  return pending.size();
+}
+
+}  // namespace filesystem
+}  // namespace client
+}  // namespace dingofs
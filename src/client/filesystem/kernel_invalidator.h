@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_CLIENT_FILESYSTEM_KERNEL_INVALIDATOR_H_
+#define DINGOFS_SRC_CLIENT_FILESYSTEM_KERNEL_INVALIDATOR_H_
+
+#include <bvar/bvar.h>
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "dingofs/metaserver.pb.h"
+#include "base/time/time.h"
+#include "client/common/config.h"
+#include "client/filesystem/dentry_cache.h"
+#include "client/filesystem/dir_cache.h"
+#include "client/filesystem/meta.h"
+#include "client/filesystem/openfile.h"
+#include "client/inode_cache_manager.h"
+#include "common/change_record.h"
+#include "utils/concurrent/concurrent.h"
+#include "utils/interruptible_sleeper.h"
+
+namespace dingofs {
+namespace client {
+namespace filesystem {
+
+// Push the invalidations to the kernel.
+class KernelNotifier {
+ public:
+  virtual ~KernelNotifier() = default;
+
+  // drop the attributes and page cache of inode
+  virtual void InvalidateInode(Ino ino) = 0;
+
+  // drop the dentry of |name| under |parent|
+  virtual void InvalidateEntry(Ino parent, const std::string& name) = 0;
+};
+
+class FuseKernelNotifier : public KernelNotifier {
+ public:
+  explicit FuseKernelNotifier(struct fuse_session* session)
+      : session_(session) {}
+
+  void InvalidateInode(Ino ino) override;
+
+  void InvalidateEntry(Ino parent, const std::string& name) override;
+
+ private:
+  struct fuse_session* session_;
+};
+
+// Keep the kernel caches coherent while they are long lived.
+//
+// With |activeInvalidate| the attributes and entries are replied to kernel
+// with a long timeout, the invalidator remembers the version of every inode
+// (and the names under every directory) which the kernel may cache, and
+// invalidates them once it learns the inode changed remotely. The changes
+// are learned by polling the attributes of watched inodes in batches, one
+// batch every |invalidateIntervalMs|, or fed by OnChanged() and
+// OnChangeRecords(). So the kernel may see a remote change late by one round
+// of polling, the watched inodes are limited so that the round fits in
+// |invalidateTimeoutSec|.
+//
+// The kernel is never notified inside a fuse request, since the kernel may
+// hold the lock of directory which the notification needs, all
+// notifications are sent by the background thread.
+class KernelInvalidator {
+ public:
+  KernelInvalidator(common::KernelCacheOption option,
+                    std::shared_ptr<InodeCacheManager> inodeManager,
+                    std::shared_ptr<OpenFiles> openFiles,
+                    std::shared_ptr<DirCache> dirCache,
+                    std::shared_ptr<DentryCache> dentryCache);
+
+  void Start(std::shared_ptr<KernelNotifier> notifier);
+
+  void Stop();
+
+  bool Running() const { return running_.load(std::memory_order_relaxed); }
+
+  // remember the attribute replied to kernel
+  void Watch(const pb::metaserver::InodeAttr& attr);
+
+  // remember the entry replied to kernel, return true if the parent
+  // is watched, which means the entry will be invalidated on change.
+  bool WatchEntry(Ino parent, const std::string& name,
+                  const pb::metaserver::InodeAttr& attr);
+
+  bool IsWatched(Ino ino);
+
+  // apply the latest attributes, |deleted| are inodes which not exist
+  // anymore, return the number of inodes need to be invalidated.
+  size_t OnChanged(const std::vector<pb::metaserver::InodeAttr>& attrs,
+                   const std::vector<Ino>& deleted);
+
+  // apply the changes pushed by the change feed of metaserver, it saves
+  // the polling of the changed inodes, a kReset record is left to polling.
+  // return the number of inodes need to be invalidated.
+  size_t OnChangeRecords(
+      const std::vector<::dingofs::common::ChangeRecord>& records);
+
+  // poll the next batch of watched inodes and send the pending
+  // invalidations, return the number of invalidations sent.
+  size_t CheckOnce();
+
+  size_t Size();
+
+ private:
+  struct Version {
+    base::time::TimeSpec mtime;
+    base::time::TimeSpec ctime;
+    uint64_t length;
+    uint32_t nlink;
+
+    bool operator==(const Version& other) const {
+      return mtime == other.mtime && ctime == other.ctime &&
+             length == other.length && nlink == other.nlink;
+    }
+    bool operator!=(const Version& other) const { return !(*this == other); }
+  };
+
+  struct Watched {
+    std::list<Ino>::iterator lru;
+    bool isDir;
+    Version version;
+    std::unordered_map<std::string, Ino> children;  // names kernel cached
+  };
+
+  struct Invalidation {
+    Ino ino;
+    std::string name;  // invalidate entry if name is not empty
+  };
+
+  static Version GetVersion(const pb::metaserver::InodeAttr& attr);
+
+  // the attributes of |inos|, the deleted inodes are left out
+  DINGOFS_ERROR GetAttrs(const std::vector<Ino>& inos,
+                         std::list<pb::metaserver::InodeAttr>* attrs);
+
+  // NOTE: the following functions should be called with mutex_ held
+  void Touch(const pb::metaserver::InodeAttr& attr);
+
+  void Evict();
+
+  void Invalidate(Ino ino, Watched* watched);
+
+  void PollTask();
+
+  common::KernelCacheOption option_;
+  std::shared_ptr<InodeCacheManager> inodeManager_;
+  std::shared_ptr<OpenFiles> openFiles_;
+  std::shared_ptr<DirCache> dirCache_;
+  std::shared_ptr<DentryCache> dentryCache_;
+  std::shared_ptr<KernelNotifier> notifier_;
+
+  utils::Mutex mutex_;
+  std::list<Ino> lru_;  // front is the most recently used
+  std::unordered_map<Ino, Watched> watched_;
+  std::vector<Invalidation> pending_;
+  std::vector<Ino> cursor_;  // inodes left to poll in this round
+
+  std::atomic<bool> running_;
+  std::thread thread_;
+  utils::InterruptibleSleeper sleeper_;
+
+  bvar::Adder<uint64_t> inodeInvalidated_{"fuse_kernel_invalidate",
+                                          "inode_num"};
+  bvar::Adder<uint64_t> entryInvalidated_{"fuse_kernel_invalidate",
+                                          "entry_num"};
+  bvar::Adder<uint64_t> polled_{"fuse_kernel_invalidate", "poll_num"};
+};
+
+}  // namespace filesystem
+}  // namespace client
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_CLIENT_FILESYSTEM_KERNEL_INVALIDATOR_H_
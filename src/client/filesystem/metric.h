@@ -37,10 +37,15 @@ class DirCacheMetric {
 
   void AddEntries(int64_t n) { metric_.nentries << n; }
 
+  void AddBytes(int64_t n) { metric_.nbytes << n; }
+
  private:
   struct Metric {
-    Metric() : nentries("filesystem_dircache", "nentries") {}
+    Metric()
+        : nentries("filesystem_dircache", "nentries"),
+          nbytes("filesystem_dircache", "nbytes") {}
     bvar::Adder<int64_t> nentries;
+    bvar::Adder<int64_t> nbytes;
   };
 
   Metric metric_;
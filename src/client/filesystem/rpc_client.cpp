@@ -89,8 +89,11 @@ DINGOFS_ERROR RPCClient::ReadDir(Ino ino,
 
   std::set<uint64_t> inos;
   std::map<uint64_t, pb::metaserver::InodeAttr> attrs;
-  std::for_each(dentries.begin(), dentries.end(),
-                [&](Dentry& dentry) { inos.emplace(dentry.inodeid()); });
+  size_t nameBytes = 0;
+  std::for_each(dentries.begin(), dentries.end(), [&](Dentry& dentry) {
+    inos.emplace(dentry.inodeid());
+    nameBytes += dentry.name().size();
+  });
   rc = inodeManager_->BatchGetInodeAttrAsync(ino, &inos, &attrs);
   if (rc != DINGOFS_ERROR::OK) {
     LOG(ERROR) << "rpc(readdir::BatchGetInodeAttrAsync) failed"
@@ -99,6 +102,7 @@ DINGOFS_ERROR RPCClient::ReadDir(Ino ino,
   }
 
   DirEntry dirEntry;
+  (*entries)->Reserve(dentries.size(), nameBytes);
   for (const auto& dentry : dentries) {
     Ino ino = dentry.inodeid();
     auto iter = attrs.find(ino);
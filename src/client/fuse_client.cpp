@@ -352,8 +352,8 @@ DINGOFS_ERROR FuseClient::FuseOpOpen(fuse_req_t req, fuse_ino_t ino,
     size_t len = contents.size();
     if (len == 0) return DINGOFS_ERROR::NODATA;
 
+    handler->buffer->Reserve(len);
     handler->buffer->size = len;
-    handler->buffer->p = static_cast<char*>(malloc(len));
     memcpy(handler->buffer->p, contents.c_str(), len);
 
     InodeAttr attr = GenerateVirtualInodeAttr(STATSINODEID, fsInfo_->fsid());
@@ -370,6 +370,7 @@ DINGOFS_ERROR FuseClient::FuseOpOpen(fuse_req_t req, fuse_ino_t ino,
 }
 
 DINGOFS_ERROR FuseClient::UpdateParentMCTimeAndNlink(fuse_ino_t parent,
+                                                     const std::string& name,
                                                      FsFileType type,
                                                      NlinkChange nlink) {
   std::shared_ptr<InodeWrapper> inode_wrapper;
@@ -377,17 +378,25 @@ DINGOFS_ERROR FuseClient::UpdateParentMCTimeAndNlink(fuse_ino_t parent,
   if (ret != DINGOFS_ERROR::OK) {
     LOG(ERROR) << "inodeManager get inode fail, ret = " << ret
                << ", inodeId=" << parent;
+    fs_->InvalidateDentries(parent);
     return ret;
   }
 
   {
     dingofs::utils::UniqueLock lk = inode_wrapper->GetUniqueLock();
+    InodeAttr before, after;
+    inode_wrapper->GetInodeAttrUnLocked(&before);
     inode_wrapper->UpdateTimestampLocked(kModifyTime | kChangeTime);
 
     if (FsFileType::TYPE_DIRECTORY == type) {
       inode_wrapper->UpdateNlinkLocked(nlink);
     }
 
+    // the entry is changed by ourselves, the other entries cached under
+    // parent are still valid.
+    inode_wrapper->GetInodeAttrUnLocked(&after);
+    fs_->InvalidateDentry(parent, name, before, after);
+
     if (option_.fileSystemOption.deferSyncOption.deferDirMtime) {
       inodeManager_->ShipToFlush(inode_wrapper);
     } else {
@@ -473,7 +482,7 @@ DINGOFS_ERROR FuseClient::MakeNode(
     return ret;
   }
 
-  ret = UpdateParentMCTimeAndNlink(parent, type, NlinkChange::kAddOne);
+  ret = UpdateParentMCTimeAndNlink(parent, name, type, NlinkChange::kAddOne);
   if (ret != DINGOFS_ERROR::OK) {
     LOG(ERROR) << "UpdateParentMCTimeAndNlink failed, parent: " << parent
                << ", name: " << name << ", type: " << type;
@@ -565,7 +574,7 @@ DINGOFS_ERROR FuseClient::FuseOpRmDir(fuse_req_t req, fuse_ino_t parent,
       return ret;
     }
 
-    ret = UpdateParentMCTimeAndNlink(parent, type, NlinkChange::kSubOne);
+    ret = UpdateParentMCTimeAndNlink(parent, name, type, NlinkChange::kSubOne);
     if (ret != DINGOFS_ERROR::OK) {
       LOG(ERROR) << "UpdateParentMCTimeAndNlink failed"
                  << ", parent: " << parent << ", name: " << name
@@ -658,7 +667,7 @@ DINGOFS_ERROR FuseClient::CreateManageNode(fuse_req_t req, uint64_t parent,
     return ret;
   }
 
-  ret = UpdateParentMCTimeAndNlink(parent, type, NlinkChange::kAddOne);
+  ret = UpdateParentMCTimeAndNlink(parent, name, type, NlinkChange::kAddOne);
   if (ret != DINGOFS_ERROR::OK) {
     LOG(ERROR) << "UpdateParentMCTimeAndNlink failed, parent: " << parent
                << ", name: " << name << ", type: " << type;
@@ -813,7 +822,7 @@ DINGOFS_ERROR FuseClient::OpUnlink(fuse_req_t req, fuse_ino_t parent,
       return ret;
     }
 
-    ret = UpdateParentMCTimeAndNlink(parent, type, NlinkChange::kSubOne);
+    ret = UpdateParentMCTimeAndNlink(parent, name, type, NlinkChange::kSubOne);
     if (ret != DINGOFS_ERROR::OK) {
       LOG(ERROR) << "UpdateParentMCTimeAndNlink failed"
                  << ", parent: " << parent << ", name: " << name
@@ -892,7 +901,7 @@ DINGOFS_ERROR FuseClient::FuseOpReadDir(fuse_req_t req, fuse_ino_t ino,
 
     entries->Iterate([&](DirEntry* dir_entry) {
       if (plus) {
-        fs_->AddDirEntryPlus(req, buffer, dir_entry);
+        fs_->AddDirEntryPlus(req, ino, buffer, dir_entry);
       } else {
         fs_->AddDirEntry(req, buffer, dir_entry);
       }
@@ -1002,9 +1011,14 @@ DINGOFS_ERROR FuseClient::FuseOpRename(fuse_req_t req, fuse_ino_t parent,
   auto renameOp = RenameOperator(fsInfo_->fsid(), fsInfo_->fsname(), parent,
                                  name, newparent, newname, dentryManager_,
                                  inodeManager_, metaClient_, mdsClient_,
-                                 option_.enableMultiMountPointRename);
+                                 option_.enableMultiMountPointRename,
+                                 option_.enableShardedRenameTx);
 
-  dingofs::utils::LockGuard lg(renameMutex_);
+  // renames are serialized by metaserver partitions in sharded mode
+  dingofs::utils::UniqueLock lk(renameMutex_, std::defer_lock);
+  if (!option_.enableShardedRenameTx) {
+    lk.lock();
+  }
   DINGOFS_ERROR rc = DINGOFS_ERROR::OK;
   VLOG(3) << "FuseOpRename [start]: " << renameOp.DebugString();
 
@@ -1033,6 +1047,8 @@ DINGOFS_ERROR FuseClient::FuseOpRename(fuse_req_t req, fuse_ino_t parent,
   }
   renameOp.UpdateInodeCtime();
   renameOp.UpdateCache();
+  fs_->InvalidateDentries(parent);
+  fs_->InvalidateDentries(newparent);
 
   renameOp.FinishUpdateUsage(fs_);
 
@@ -1143,6 +1159,32 @@ DINGOFS_ERROR FuseClient::FuseOpGetXattr(fuse_req_t req, fuse_ino_t ino,
                                          const char* name, std::string* value,
                                          size_t size) {
   (void)req;
+  InodeAttr inodeAttr;
+  const std::string* found = nullptr;
+  DINGOFS_ERROR ret = GetXattrValue(ino, name, size, &inodeAttr, &found);
+  if (found != nullptr) {
+    *value = *found;
+  }
+  return ret;
+}
+
+DINGOFS_ERROR FuseClient::FuseOpGetXattr(fuse_req_t req, fuse_ino_t ino,
+                                         const char* name, char* value,
+                                         size_t size, size_t* realSize) {
+  (void)req;
+  InodeAttr inodeAttr;
+  const std::string* found = nullptr;
+  DINGOFS_ERROR ret = GetXattrValue(ino, name, size, &inodeAttr, &found);
+  *realSize = found != nullptr ? found->length() : 0;
+  if (ret == DINGOFS_ERROR::OK && size > 0) {
+    memcpy(value, found->data(), found->length());
+  }
+  return ret;
+}
+
+DINGOFS_ERROR FuseClient::GetXattrValue(fuse_ino_t ino, const char* name,
+                                        size_t size, InodeAttr* attr,
+                                        const std::string** value) {
   VLOG(9) << "FuseOpGetXattr, inodeId=" << ino << ", name: " << name
           << ", size = " << size;
 
@@ -1153,28 +1195,26 @@ DINGOFS_ERROR FuseClient::FuseOpGetXattr(fuse_req_t req, fuse_ino_t ino,
     return DINGOFS_ERROR::NODATA;
   }
 
-  InodeAttr inodeAttr;
-  DINGOFS_ERROR ret = inodeManager_->GetInodeAttr(ino, &inodeAttr);
+  DINGOFS_ERROR ret = inodeManager_->GetInodeAttr(ino, attr);
   if (ret != DINGOFS_ERROR::OK) {
     LOG(ERROR) << "inodeManager get inodeAttr fail, ret = " << ret
                << ", inodeId=" << ino;
     return ret;
   }
 
-  ret =
-      xattrManager_->GetXattr(name, value, &inodeAttr, enableSumInDir_.load());
+  ret = xattrManager_->GetXattr(name, value, attr, enableSumInDir_.load());
   if (DINGOFS_ERROR::OK != ret) {
     LOG(ERROR) << "xattrManager get xattr failed, name = " << name;
     return ret;
   }
 
   ret = DINGOFS_ERROR::NODATA;
-  if (value->length() > 0) {
-    if ((size == 0 && value->length() <= MAX_XATTR_VALUE_LENGTH) ||
-        (size >= value->length() &&
-         value->length() <= MAX_XATTR_VALUE_LENGTH)) {
-      VLOG(1) << "FuseOpGetXattr name = " << name
-              << ", length = " << value->length() << ", value = " << *value;
+  size_t length = *value != nullptr ? (*value)->length() : 0;
+  if (length > 0) {
+    if ((size == 0 && length <= MAX_XATTR_VALUE_LENGTH) ||
+        (size >= length && length <= MAX_XATTR_VALUE_LENGTH)) {
+      VLOG(1) << "FuseOpGetXattr name = " << name << ", length = " << length
+              << ", value = " << **value;
       ret = DINGOFS_ERROR::OK;
     } else {
       ret = DINGOFS_ERROR::OUT_OF_RANGE;
@@ -1340,7 +1380,7 @@ DINGOFS_ERROR FuseClient::FuseOpSymlink(fuse_req_t req, const char* link,
     return ret;
   }
 
-  ret = UpdateParentMCTimeAndNlink(parent, FsFileType::TYPE_SYM_LINK,
+  ret = UpdateParentMCTimeAndNlink(parent, name, FsFileType::TYPE_SYM_LINK,
                                    NlinkChange::kAddOne);
   if (ret != DINGOFS_ERROR::OK) {
     LOG(ERROR) << "UpdateParentMCTimeAndNlink failed, link:" << link
@@ -1465,7 +1505,8 @@ DINGOFS_ERROR FuseClient::OpLink(fuse_req_t req, fuse_ino_t ino,
     return ret;
   }
 
-  ret = UpdateParentMCTimeAndNlink(newparent, type, NlinkChange::kAddOne);
+  ret = UpdateParentMCTimeAndNlink(newparent, newname, type,
+                                   NlinkChange::kAddOne);
   if (ret != DINGOFS_ERROR::OK) {
     LOG(ERROR) << "UpdateParentMCTimeAndNlink failed"
                << ", parent: " << newparent << ", name: " << newname
@@ -169,6 +169,12 @@ class FuseClient {
                                        const char* name, std::string* value,
                                        size_t size);
 
+  // same as above, but the value is copied into `value` which holds `size`
+  // bytes, `*realSize` is the length of value
+  virtual DINGOFS_ERROR FuseOpGetXattr(fuse_req_t req, fuse_ino_t ino,
+                                       const char* name, char* value,
+                                       size_t size, size_t* realSize);
+
   virtual DINGOFS_ERROR FuseOpSetXattr(fuse_req_t req, fuse_ino_t ino,
                                        const char* name, const char* value,
                                        size_t size, int flags);
@@ -304,7 +310,13 @@ class FuseClient {
  private:
   virtual void FlushData() = 0;
 
+  // `*value` points to the value in `attr`, or nullptr if not found
+  DINGOFS_ERROR GetXattrValue(fuse_ino_t ino, const char* name, size_t size,
+                              pb::metaserver::InodeAttr* attr,
+                              const std::string** value);
+
   DINGOFS_ERROR UpdateParentMCTimeAndNlink(fuse_ino_t parent,
+                                           const std::string& name,
                                            pb::metaserver::FsFileType type,
                                            common::NlinkChange nlink);
 
@@ -24,9 +24,12 @@
 
 #include <memory>
 
+#include "base/filepath/filepath.h"
 #include "client/blockcache/block_cache.h"
+#include "client/blockcache/local_filesystem.h"
 #include "client/blockcache/s3_client.h"
 #include "client/datastream/data_stream.h"
+#include "client/filesystem/access_trace.h"
 #include "client/kvclient/memcache_client.h"
 #include "common/define.h"
 #include "stub/filesystem/xattr.h"
@@ -48,10 +51,12 @@ namespace dingofs {
 namespace client {
 
 using aws::GetObjectAsyncCallBack;
+using base::filepath::PathJoin;
 using base::string::StrFormat;
 using blockcache::BlockCacheImpl;
 using blockcache::S3ClientImpl;
 using datastream::DataStream;
+using filesystem::AccessTracer;
 using filesystem::EntryOut;
 using utils::is_aligned;
 
@@ -111,10 +116,45 @@ DINGOFS_ERROR FuseS3Client::Init(const common::FuseClientOption& option) {
   RewriteCacheDir(&block_cache_option, uuid);
   auto block_cache = std::make_shared<BlockCacheImpl>(block_cache_option);
 
-  return s3Adaptor_->Init(opt.s3Opt.s3ClientAdaptorOpt,
-                          S3ClientImpl::GetInstance(), inodeManager_,
-                          mdsClient_, fsCacheManager, GetFileSystem(),
-                          block_cache, kvClientManager_, true);
+  ret = s3Adaptor_->Init(opt.s3Opt.s3ClientAdaptorOpt,
+                         S3ClientImpl::GetInstance(), inodeManager_,
+                         mdsClient_, fsCacheManager, GetFileSystem(),
+                         block_cache, kvClientManager_, true);
+  if (ret != DINGOFS_ERROR::OK) {
+    return ret;
+  }
+
+  // access trace
+  if (!InitAccessTrace(option, uuid)) {
+    return DINGOFS_ERROR::INTERNAL;
+  }
+  return DINGOFS_ERROR::OK;
+}
+
+bool FuseS3Client::InitAccessTrace(const common::FuseClientOption& option,
+                                   const std::string& uuid) {
+  const auto& trace_option = option.access_trace_option;
+  std::string profile =
+      PathJoin({trace_option.profile_dir, uuid + ".profile"});
+
+  // load the previous profile before recording overwrites it
+  if (option.warmup_option.replay_profile && warmupManager_ != nullptr &&
+      !warmupManager_->StartReplay(profile)) {
+    LOG(WARNING) << "Replay access profile (" << profile
+                 << ") failed, skip it.";
+  }
+
+  if (trace_option.record) {
+    auto fs = blockcache::NewTempLocalFileSystem();
+    if (fs->MkDirs(trace_option.profile_dir) != blockcache::BCACHE_ERROR::OK) {
+      LOG(ERROR) << "Create access profile directory ("
+                 << trace_option.profile_dir << ") failed.";
+      return false;
+    }
+    return AccessTracer::GetInstance().StartRecord(
+        profile, s3Adaptor_->GetBlockSize(), trace_option.max_records);
+  }
+  return true;
 }
 
 bool FuseS3Client::InitKVCache(const common::KVClientManagerOpt& opt) {
@@ -150,6 +190,7 @@ bool FuseS3Client::InitKVCache(const common::KVClientManagerOpt& opt) {
 }
 
 void FuseS3Client::UnInit() {
+  AccessTracer::GetInstance().Stop();
   FuseClient::UnInit();
   s3Adaptor_->Stop();
   S3ClientImpl::GetInstance()->Destroy();
@@ -102,6 +102,9 @@ class FuseS3Client : public FuseClient {
  private:
   bool InitKVCache(const common::KVClientManagerOpt& opt);
 
+  bool InitAccessTrace(const common::FuseClientOption& option,
+                       const std::string& uuid);
+
   void FlushData() override;
 
   DINGOFS_ERROR InitBrpcServer() override;
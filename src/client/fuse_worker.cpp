@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/fuse_worker.h"
+
+#include <glog/logging.h>
+
+#include "utils/cpu_affinity.h"
+
+namespace dingofs {
+namespace client {
+
+using utils::CpuAffinity;
+
+namespace {
+
+// -2: not bound yet, -1: binding disabled or failed
+thread_local int boundCpu = -2;
+
+}  // namespace
+
+void FuseWorkerAffinity::Init(const FuseWorkerOption& option) {
+  cpus_ = CpuAffinity::GetUsableCpus();
+  enabled_ = option.bind_cpu && !cpus_.empty();
+  workers_ = option.workers == 0 ? cpus_.size() : option.workers;
+  LOG(INFO) << "Fuse worker affinity " << (enabled_ ? "enabled" : "disabled")
+            << ", usable cpus = " << cpus_.size()
+            << ", workers = " << workers_;
+}
+
+int FuseWorkerAffinity::BindCurrentWorker() {
+  if (!enabled_) {
+    return -1;
+  } else if (boundCpu != -2) {
+    return boundCpu;
+  }
+
+  // the workers created beyond |workers_| (e.g. on bursts) are left to
+  // the scheduler, they would share the cpus with the bound ones
+  uint32_t index = next_.fetch_add(1, std::memory_order_relaxed);
+  if (index >= workers_) {
+    boundCpu = -1;
+    return boundCpu;
+  }
+
+  int cpu = cpus_[index % cpus_.size()];
+  if (CpuAffinity::BindCurrentThread(cpu)) {
+    boundCpu = cpu;
+    boundWorkers_ << 1;
+  } else {
+    LOG(WARNING) << "Bind fuse worker to cpu " << cpu << " failed.";
+    boundCpu = -1;
+  }
+  return boundCpu;
+}
+
+}  // namespace client
+}  // namespace dingofs
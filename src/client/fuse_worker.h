@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_CLIENT_FUSE_WORKER_H_
+#define DINGOFS_SRC_CLIENT_FUSE_WORKER_H_
+
+#include <bvar/bvar.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "client/common/config.h"
+
+namespace dingofs {
+namespace client {
+
+using common::FuseWorkerOption;
+
+// Bind the fuse workers to cpus.
+//
+// The workers of fuse_session_loop_mt are created by libfuse, with
+// `clone_fd` every worker reads the requests from its own channel. libfuse
+// has no hook on the start of worker, so a worker binds itself to the next
+// usable cpu on its first request (only a flag check afterwards), and the
+// fuse loop keeps the workers alive when idle. Only the first |workers|
+// workers are bound, more workers than usable cpus share the cpus in turn.
+class FuseWorkerAffinity {
+ public:
+  static FuseWorkerAffinity& GetInstance() {
+    static FuseWorkerAffinity instance;
+    return instance;
+  }
+
+  void Init(const FuseWorkerOption& option);
+
+  bool Enabled() const { return enabled_; }
+
+  // the number of workers which the fuse loop should keep
+  uint32_t Workers() const { return workers_; }
+
+  // bind the calling worker to one cpu if it's not bound yet,
+  // return the bound cpu or -1
+  int BindCurrentWorker();
+
+ private:
+  FuseWorkerAffinity() : enabled_(false), workers_(0), next_(0) {}
+
+ private:
+  bool enabled_;
+  uint32_t workers_;
+  std::vector<int> cpus_;
+  std::atomic<uint32_t> next_;
+
+  bvar::Adder<uint64_t> boundWorkers_{"fuse_worker", "bound_num"};
+};
+
+}  // namespace client
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_CLIENT_FUSE_WORKER_H_
@@ -24,6 +24,7 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <ctime>
 #include <memory>
@@ -91,6 +92,19 @@ void AppendS3ChunkInfoToMap(
   }
 }
 
+uint64_t MaxS3ChunkIdInMap(
+    uint64_t chunkIndex,
+    const google::protobuf::Map<uint64_t, S3ChunkInfoList>& s3ChunkInfoMap) {
+  uint64_t maxChunkId = 0;
+  auto it = s3ChunkInfoMap.find(chunkIndex);
+  if (it != s3ChunkInfoMap.end()) {
+    for (const auto& info : it->second.s3chunks()) {
+      maxChunkId = std::max(maxChunkId, info.chunkid());
+    }
+  }
+  return maxChunkId;
+}
+
 class UpdateInodeAsyncDone : public MetaServerClientDone {
  public:
   UpdateInodeAsyncDone(const std::shared_ptr<InodeWrapper>& inodeWrapper,
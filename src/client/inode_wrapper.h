@@ -60,6 +60,12 @@ void AppendS3ChunkInfoToMap(
     google::protobuf::Map<uint64_t, pb::metaserver::S3ChunkInfoList>*
         s3ChunkInfoMap);
 
+// The largest chunk id of the chunk, which is the latest version of its data.
+uint64_t MaxS3ChunkIdInMap(
+    uint64_t chunkIndex,
+    const google::protobuf::Map<uint64_t, pb::metaserver::S3ChunkInfoList>&
+        s3ChunkInfoMap);
+
 extern bvar::Adder<int64_t> g_alive_inode_count;
 
 class InodeWrapper : public std::enable_shared_from_this<InodeWrapper> {
@@ -257,6 +263,11 @@ class InodeWrapper : public std::enable_shared_from_this<InodeWrapper> {
     UpdateS3ChunkInfoMetric(2);
   }
 
+  uint64_t GetMaxS3ChunkId(uint64_t chunkIndex) {
+    dingofs::utils::UniqueLock lg(mtx_);
+    return MaxS3ChunkIdInMap(chunkIndex, inode_.s3chunkinfomap());
+  }
+
   google::protobuf::Map<uint64_t, pb::metaserver::S3ChunkInfoList>*
   GetChunkInfoMap() {
     return inode_.mutable_s3chunkinfomap();
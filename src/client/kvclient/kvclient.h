@@ -22,12 +22,25 @@
 #ifndef DINGOFS_SRC_CLIENT_KVCLIENT_KVCLIENT_H_
 #define DINGOFS_SRC_CLIENT_KVCLIENT_KVCLIENT_H_
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace dingofs {
 
 namespace client {
 
+/**
+ * A ranged read of one key, the unit of batch get.
+ */
+struct KVGetRange {
+  std::string key;
+  char* value;
+  uint64_t offset;
+  uint64_t length;
+  bool res;
+};
+
 /**
  * Single client to kv interface.
  */
@@ -51,6 +64,19 @@ class KVClient {
 
   virtual bool Get(const std::string& key, char* value, uint64_t offset,
                    uint64_t length, std::string* errorlog) = 0;
+
+  /**
+   * Get all ranges, the result of each range is set in its `res`.
+   * The client which supports multi-get should fetch them in one
+   * round trip, the default implementation gets them one by one.
+   */
+  virtual void BatchGet(std::vector<KVGetRange>* ranges) {
+    std::string errorlog;
+    for (auto& range : *ranges) {
+      range.res =
+          Get(range.key, range.value, range.offset, range.length, &errorlog);
+    }
+  }
 };
 
 }  // namespace client
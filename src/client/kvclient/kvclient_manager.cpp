@@ -22,9 +22,16 @@
 
 #include "client/kvclient/kvclient_manager.h"
 
+#include <glog/logging.h>
+
+#include <algorithm>
+
+#include "absl/strings/str_cat.h"
 #include "stub/metric/metric.h"
+#include "utils/timeutility.h"
 
 using dingofs::stub::metric::LatencyGuard;
+using dingofs::utils::TimeUtility;
 
 namespace dingofs {
 namespace client {
@@ -41,6 +48,12 @@ using common::KVClientManagerOpt;
 bool KVClientManager::Init(const KVClientManagerOpt& config,
                            const std::shared_ptr<KVClient>& kvclient) {
   client_ = kvclient;
+  option_ = config;
+  // no batch is ever flushed with 0 keys, every get would wait forever
+  if (option_.getBatchMaxKeys == 0) {
+    LOG(WARNING) << "fuseClient.kvcache.getBatchMaxKeys is 0, use 1 instead";
+    option_.getBatchMaxKeys = 1;
+  }
   return threadPool_.Start(config.setThreadPooln) == 0;
 }
 
@@ -49,12 +62,29 @@ void KVClientManager::Uninit() {
   threadPool_.Stop();
 }
 
+std::string KVClientManager::PartKey(const std::string& key, uint64_t index) {
+  // the first part use the origin key, so the value which not split
+  // is compatible with the client which disable split
+  return index == 0 ? key : absl::StrCat(key, "#", index);
+}
+
 void KVClientManager::Set(std::shared_ptr<SetKVCacheTask> task) {
   threadPool_.Enqueue([task, this]() {
     LatencyGuard guard(&kvClientMetric_.kvClientSet.latency);
 
     std::string error_log;
-    auto res = client_->Set(task->key, task->value, task->length, &error_log);
+    uint64_t splitSize = option_.valueSplitSize;
+    bool res = true;
+    if (splitSize == 0 || task->length <= splitSize) {
+      res = client_->Set(task->key, task->value, task->length, &error_log);
+    } else {
+      for (uint64_t off = 0, index = 0; res && off < task->length;
+           off += splitSize, index++) {
+        uint64_t len = std::min(splitSize, task->length - off);
+        res = client_->Set(PartKey(task->key, index), task->value + off, len,
+                           &error_log);
+      }
+    }
     ONRETURN(Set, res);
 
     task->done(task);
@@ -62,16 +92,83 @@ void KVClientManager::Set(std::shared_ptr<SetKVCacheTask> task) {
 }
 
 void KVClientManager::Get(std::shared_ptr<GetKVCacheTask> task) {
-  threadPool_.Enqueue([task, this]() {
-    LatencyGuard guard(&kvClientMetric_.kvClientGet.latency);
+  {
+    std::lock_guard<std::mutex> lk(pendingMtx_);
+    pendingGets_.emplace_back(
+        PendingGet{std::move(task), TimeUtility::GetTimeofDayUs()});
+  }
+  // every task schedules one drain, the drain which found nothing pending
+  // (taken by former batch) returns immediately
+  threadPool_.Enqueue([this]() { BatchGet(); });
+}
 
-    std::string error_log;
-    task->res = client_->Get(task->key, task->value, task->offset, task->length,
-                             &error_log);
+void KVClientManager::SplitRange(const GetKVCacheTask& task,
+                                 std::vector<KVGetRange>* ranges) {
+  uint64_t splitSize = option_.valueSplitSize;
+  if (splitSize == 0) {
+    ranges->emplace_back(KVGetRange{task.key, task.value, task.offset,
+                                    task.length, false});
+    return;
+  }
+
+  uint64_t offset = task.offset;
+  uint64_t end = task.offset + task.length;
+  while (offset < end) {
+    uint64_t index = offset / splitSize;
+    uint64_t partOffset = offset % splitSize;
+    uint64_t len = std::min(splitSize - partOffset, end - offset);
+    ranges->emplace_back(KVGetRange{PartKey(task.key, index),
+                                    task.value + (offset - task.offset),
+                                    partOffset, len, false});
+    offset += len;
+  }
+}
+
+void KVClientManager::BatchGet() {
+  std::vector<PendingGet> tasks;
+  {
+    std::lock_guard<std::mutex> lk(pendingMtx_);
+    while (!pendingGets_.empty() && tasks.size() < option_.getBatchMaxKeys) {
+      tasks.emplace_back(std::move(pendingGets_.front()));
+      pendingGets_.pop_front();
+    }
+  }
+  if (tasks.empty()) {
+    return;
+  }
+
+  uint64_t startUs = TimeUtility::GetTimeofDayUs();
+  std::vector<KVGetRange> ranges;
+  std::vector<size_t> owners;  // the index of task which range belongs to
+  for (size_t i = 0; i < tasks.size(); i++) {
+    size_t n = ranges.size();
+    SplitRange(*tasks[i].task, &ranges);
+    owners.insert(owners.end(), ranges.size() - n, i);
+  }
+
+  client_->BatchGet(&ranges);
+  kvClientMetric_.kvClientBatchGet.qps.count << 1;
+  kvClientMetric_.kvClientBatchGetKeys << ranges.size();
+
+  std::vector<bool> results(tasks.size(), true);
+  for (size_t i = 0; i < ranges.size(); i++) {
+    if (!ranges[i].res) {
+      results[owners[i]] = false;
+    }
+  }
+
+  // the round trip is recorded once for the batch, and every get records
+  // its own latency since it was queued, which is what the caller waits.
+  uint64_t nowUs = TimeUtility::GetTimeofDayUs();
+  kvClientMetric_.kvClientBatchGet.latency << nowUs - startUs;
+  for (size_t i = 0; i < tasks.size(); i++) {
+    auto& task = tasks[i].task;
+    task->res = results[i];
+    kvClientMetric_.kvClientGet.latency << nowUs - tasks[i].startUs;
     ONRETURN(Get, task->res);
 
     task->done(task);
-  });
+  }
 }
 
 }  // namespace client
@@ -25,9 +25,12 @@
 
 #include <bthread/condition_variable.h>
 
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "client/common/config.h"
 #include "client/kvclient/kvclient.h"
@@ -86,18 +89,38 @@ class KVClientManager {
    */
   void Set(std::shared_ptr<SetKVCacheTask> task);
 
+  /**
+   * The get task is queued, and the concurrent get tasks are batched
+   * into one multi-get of kvclient.
+   */
   void Get(std::shared_ptr<GetKVCacheTask> task);
 
   stub::metric::KVClientMetric* GetClientMetricForTesting() {
     return &kvClientMetric_;
   }
 
+  // the key of the index-th part when value is split over several keys
+  static std::string PartKey(const std::string& key, uint64_t index);
+
  private:
+  struct PendingGet {
+    std::shared_ptr<GetKVCacheTask> task;
+    uint64_t startUs;  // the time when the task is queued
+  };
+
   void Uninit();
 
+  void BatchGet();
+
+  // split the range of task into the ranges of parts
+  void SplitRange(const GetKVCacheTask& task, std::vector<KVGetRange>* ranges);
+
   utils::TaskThreadPool<bthread::Mutex, bthread::ConditionVariable> threadPool_;
   std::shared_ptr<KVClient> client_;
   stub::metric::KVClientMetric kvClientMetric_;
+  common::KVClientManagerOpt option_;
+  std::mutex pendingMtx_;
+  std::deque<PendingGet> pendingGets_;
 };
 
 }  // namespace client
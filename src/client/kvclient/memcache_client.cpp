@@ -22,10 +22,130 @@
 
 #include "client/kvclient/memcache_client.h"
 
+#include <unordered_map>
+
 namespace dingofs {
 namespace client {
 
-thread_local memcached_st* tcli = nullptr;
+namespace {
+
+// pool id -> connection of current thread, the id of pool is never reused,
+// so the stale entry of cleared pool will never be accessed.
+thread_local std::unordered_map<uint64_t, memcached_st*> tconns;
+
+}  // namespace
+
+std::atomic<uint64_t> MemcachedConnPool::nextId_(0);
+
+MemcachedConnPool::MemcachedConnPool() : id_(nextId_.fetch_add(1)) {}
+
+MemcachedConnPool::~MemcachedConnPool() { Clear(); }
+
+memcached_st* MemcachedConnPool::Acquire(memcached_st* origin) {
+  uint64_t id = id_.load(std::memory_order_acquire);
+  auto iter = tconns.find(id);
+  if (iter != tconns.end()) {
+    return iter->second;
+  }
+
+  memcached_st* conn = memcached_clone(nullptr, origin);
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    conns_.emplace(conn);
+  }
+  tconns.emplace(id, conn);
+  return conn;
+}
+
+void MemcachedConnPool::Discard() {
+  auto iter = tconns.find(id_.load(std::memory_order_acquire));
+  if (iter == tconns.end()) {
+    return;
+  }
+
+  memcached_st* conn = iter->second;
+  tconns.erase(iter);
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (conns_.erase(conn) == 0) {
+      return;  // already released by Clear()
+    }
+  }
+  memcached_free(conn);
+}
+
+void MemcachedConnPool::Clear() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  id_.store(nextId_.fetch_add(1), std::memory_order_release);
+  for (auto* conn : conns_) {
+    memcached_free(conn);
+  }
+  conns_.clear();
+}
+
+size_t MemcachedConnPool::Size() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return conns_.size();
+}
+
+void MemCachedClient::BatchGet(std::vector<KVGetRange>* ranges) {
+  if (ranges->empty()) {
+    return;
+  }
+
+  // key -> ranges
+  std::unordered_map<std::string, std::vector<KVGetRange*>> waiters;
+  std::vector<const char*> keys;
+  std::vector<size_t> keyLens;
+  for (auto& range : *ranges) {
+    range.res = false;
+    auto& waiter = waiters[range.key];
+    if (waiter.empty()) {
+      keys.emplace_back(range.key.c_str());
+      keyLens.emplace_back(range.key.length());
+    }
+    waiter.emplace_back(&range);
+  }
+
+  memcached_st* cli = pool_.Acquire(client_);
+  memcached_return_t rc =
+      memcached_mget(cli, keys.data(), keyLens.data(), keys.size());
+  if (rc != MEMCACHED_SUCCESS) {
+    LOG(ERROR) << "Multi get " << keys.size()
+               << " keys error = " << ResError(rc);
+    pool_.Discard();
+    return;
+  }
+
+  memcached_result_st result;
+  memcached_result_create(cli, &result);
+  while (memcached_fetch_result(cli, &result, &rc) != nullptr) {
+    std::string key(memcached_result_key_value(&result),
+                    memcached_result_key_length(&result));
+    auto iter = waiters.find(key);
+    if (iter == waiters.end()) {
+      continue;
+    }
+
+    const char* value = memcached_result_value(&result);
+    size_t valueLen = memcached_result_length(&result);
+    for (auto* range : iter->second) {
+      if (range->value != nullptr &&
+          valueLen >= range->offset + range->length) {
+        memcpy(range->value, value + range->offset, range->length);
+        range->res = true;
+      }
+    }
+  }
+  memcached_result_free(&result);
+
+  if (rc != MEMCACHED_END && rc != MEMCACHED_SUCCESS &&
+      rc != MEMCACHED_NOTFOUND) {
+    LOG(ERROR) << "Multi get fetch result error = " << ResError(rc);
+    pool_.Discard();
+  }
+  VLOG(9) << "Multi get " << keys.size() << " keys OK";
+}
 
 }  // namespace client
 }  // namespace dingofs
@@ -27,7 +27,12 @@
 #include <libmemcached-1.0/memcached.h>
 #include <libmemcached-1.0/types/return.h>
 
+#include <atomic>
+#include <cstring>
+#include <mutex>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "dingofs/topology.pb.h"
 #include "client/kvclient/kvclient.h"
@@ -37,10 +42,32 @@ namespace dingofs {
 namespace client {
 
 /**
- * only the threadpool will operate the kvclient,
- * for threadsafe and fast, we can make every thread has a client.
+ * Multi thread use a memcached_st* client is unsafe, so every thread
+ * clones its own connection from the origin client and keeps it for
+ * later requests. All connections are owned by the pool and released
+ * by Clear() or destructor.
  */
-extern thread_local memcached_st* tcli;
+class MemcachedConnPool {
+ public:
+  MemcachedConnPool();
+  ~MemcachedConnPool();
+
+  // return the connection of current thread, clone it if not exist
+  memcached_st* Acquire(memcached_st* origin);
+
+  // drop the connection of current thread, e.g. after network error
+  void Discard();
+
+  void Clear();
+
+  size_t Size();
+
+ private:
+  static std::atomic<uint64_t> nextId_;
+  std::atomic<uint64_t> id_;
+  std::mutex mutex_;
+  std::unordered_set<memcached_st*> conns_;
+};
 
 /**
  * MemCachedClient is a client to memcached cluster. You'd better
@@ -96,6 +123,7 @@ class MemCachedClient : public KVClient {
   }
 
   void UnInit() override {
+    pool_.Clear();
     if (client_) {
       memcached_free(client_);
       client_ = nullptr;
@@ -104,36 +132,29 @@ class MemCachedClient : public KVClient {
 
   bool Set(const std::string& key, const char* value, const uint64_t value_len,
            std::string* errorlog) override {
-    if (nullptr == tcli) {
-      tcli = memcached_clone(nullptr, client_);
-    }
+    memcached_st* cli = pool_.Acquire(client_);
     auto res =
-        memcached_set(tcli, key.c_str(), key.length(), value, value_len, 0, 0);
+        memcached_set(cli, key.c_str(), key.length(), value, value_len, 0, 0);
     if (MEMCACHED_SUCCESS == res) {
       VLOG(9) << "Set key = " << key << " OK";
       return true;
     }
     *errorlog = ResError(res);
-    memcached_free(tcli);
-    tcli = nullptr;
+    pool_.Discard();
     LOG(ERROR) << "Set key = " << key << " error = " << *errorlog;
     return false;
   }
 
   bool Get(const std::string& key, char* value, uint64_t offset,
            uint64_t length, std::string* errorlog) override {
-    if (nullptr == tcli) {
-      // multi thread use a memcached_st* client is unsafe.
-      // should clone it or use memcached_st_pool.
-      tcli = memcached_clone(nullptr, client_);
-    }
+    memcached_st* cli = pool_.Acquire(client_);
     uint32_t flags = 0;
     size_t value_length = 0;
     memcached_return_t ue;
-    char* res = memcached_get(tcli, key.c_str(), key.length(), &value_length,
+    char* res = memcached_get(cli, key.c_str(), key.length(), &value_length,
                               &flags, &ue);
     if (MEMCACHED_SUCCESS == ue && res != nullptr && value &&
-        value_length >= length) {
+        value_length >= offset + length) {
       VLOG(9) << "Get key = " << key << " OK";
       memcpy(value, res + offset, length);
       free(res);
@@ -144,14 +165,20 @@ class MemCachedClient : public KVClient {
     if (ue != MEMCACHED_NOTFOUND) {
       LOG(ERROR) << "Get key = " << key << " error = " << *errorlog
                  << ", get_value_len = " << value_length
-                 << ", expect_value_len = " << length;
-      memcached_free(tcli);
-      tcli = nullptr;
+                 << ", expect_value_len = " << offset + length;
+      pool_.Discard();
     }
+    free(res);
 
     return false;
   }
 
+  /**
+   * Fetch all ranges by one memcached multi-get, ranges of the same key
+   * share one fetched value.
+   */
+  void BatchGet(std::vector<KVGetRange>* ranges) override;
+
   // transform the res to a error string
   const std::string ResError(const memcached_return_t res) {
     return memcached_strerror(nullptr, res);
@@ -196,6 +223,7 @@ class MemCachedClient : public KVClient {
   using KVClient::Init;
   memcached_server_st* server_;
   memcached_st* client_;
+  MemcachedConnPool pool_;
 };
 
 }  //  namespace client
@@ -222,6 +222,7 @@ int main(int argc, char* argv[]) {
     LOG(ERROR) << "init fuse client fail, conf = " << mOpts.conf;
     goto err_out4;
   }
+  SetFuseSession(se);
 
   LOG(INFO) << "fuse start loop, singlethread = " << opts.singlethread
             << ", max_idle_threads = " << opts.max_idle_threads;
@@ -232,6 +233,9 @@ int main(int argc, char* argv[]) {
   } else {
     config.clone_fd = opts.clone_fd;
     config.max_idle_threads = opts.max_idle_threads;
+    InitFuseLoopConfig(&config);
+    LOG(INFO) << "fuse loop config, clone_fd = " << config.clone_fd
+              << ", max_idle_threads = " << config.max_idle_threads;
     ret = fuse_session_loop_mt(se, &config);
   }
 
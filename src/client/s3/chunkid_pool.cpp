@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/s3/chunkid_pool.h"
+
+#include <butil/time.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "utils/timeutility.h"
+
+namespace dingofs {
+namespace client {
+
+using common::ChunkIdPoolOption;
+using utils::TimeUtility;
+
+using pb::mds::FSStatusCode;
+
+ChunkIdPool::ChunkIdPool(const ChunkIdPoolOption& option, AllocFunc alloc)
+    : option_(option),
+      alloc_(std::move(alloc)),
+      refilling_(false),
+      running_(false),
+      bundleSize_(option.minBundleSize),
+      lastFetchMs_(0),
+      consumed_(0) {
+  option_.maxBundleSize =
+      std::max(option_.maxBundleSize, option_.minBundleSize);
+  localAllocs_.expose_as("chunkid_pool_", "local_alloc");
+  remoteAllocs_.expose_as("chunkid_pool_", "remote_alloc");
+  blockingFetches_.expose_as("chunkid_pool_", "blocking_fetch");
+  allocLatency_.expose("chunkid_pool_", "alloc");
+}
+
+ChunkIdPool::~ChunkIdPool() { Stop(); }
+
+void ChunkIdPool::Start() {
+  if (!Enabled() || running_.exchange(true)) {
+    return;
+  }
+
+  refiller_ = std::thread(&ChunkIdPool::RefillLoop, this);
+  LOG(INFO) << "Chunk id pool started, minBundleSize = "
+            << option_.minBundleSize
+            << ", maxBundleSize = " << option_.maxBundleSize
+            << ", refillPercent = " << option_.refillPercent
+            << ", bundleLifetimeSec = " << option_.bundleLifetimeSec;
+}
+
+void ChunkIdPool::Stop() {
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!running_.exchange(false)) {
+      return;
+    }
+  }
+
+  cond_.notify_all();
+  refiller_.join();
+  LOG(INFO) << "Chunk id pool stopped.";
+}
+
+uint32_t ChunkIdPool::BundleSize() { return bundleSize_.load(); }
+
+// the ids not larger than `minId` are skipped
+bool ChunkIdPool::TakeFrom(Range* range, uint32_t idNum, uint64_t minId,
+                           uint64_t* beginId) {
+  uint64_t next = range->next.load(std::memory_order_relaxed);
+  uint64_t begin;
+  do {
+    begin = std::max(next, minId + 1);
+    if (begin + idNum > range->end) {
+      return false;
+    }
+  } while (!range->next.compare_exchange_weak(next, begin + idNum,
+                                              std::memory_order_relaxed));
+  *beginId = begin;
+  return true;
+}
+
+FSStatusCode ChunkIdPool::Alloc(uint32_t idNum, uint64_t* beginId,
+                                uint64_t minId) {
+  butil::Timer timer;
+  timer.start();
+
+  // e.g. truncate a huge file, it would drain the pool at once
+  if (!Enabled() || idNum > option_.maxBundleSize / 2) {
+    remoteAllocs_ << 1;
+    return alloc_(idNum, beginId);
+  }
+
+  bool fetched = false;
+  while (true) {
+    auto range = std::atomic_load(&current_);
+    if (range != nullptr && TakeFrom(range.get(), idNum, minId, beginId)) {
+      consumed_.fetch_add(idNum, std::memory_order_relaxed);
+      localAllocs_ << 1;
+      MaybeRefill(*range);
+      timer.stop();
+      allocLatency_ << timer.u_elapsed();
+      return FSStatusCode::OK;
+    }
+
+    // the fresh range still can't exceed `minId`, which is not granted
+    // by the mds we know, let the mds decide
+    if (fetched) {
+      remoteAllocs_ << 1;
+      return alloc_(idNum, beginId);
+    }
+
+    std::unique_lock<std::mutex> lk(mutex_);
+    if (std::atomic_load(&current_) != range) {  // switched by others
+      continue;
+    } else if (standby_ != nullptr) {
+      std::atomic_store(&current_, std::move(standby_));
+      standby_ = nullptr;
+      continue;
+    } else if (refilling_.load()) {
+      cond_.wait(lk, [this]() { return !refilling_.load(); });
+      continue;
+    }
+
+    // the background refill can't keep up with the allocation
+    refilling_.store(true);
+    uint32_t bundleSize = NextBundleSizeLocked();
+    lk.unlock();
+    auto rc = Fetch(bundleSize, &range);
+    lk.lock();
+    refilling_.store(false);
+    cond_.notify_all();
+    blockingFetches_ << 1;
+    if (rc != FSStatusCode::OK) {
+      return rc;
+    }
+    std::atomic_store(&current_, std::move(range));
+    fetched = true;
+  }
+}
+
+void ChunkIdPool::MaybeRefill(const Range& range) {
+  uint64_t next = range.next.load(std::memory_order_relaxed);
+  uint64_t remain = range.end > next ? range.end - next : 0;
+  uint64_t size =
+      static_cast<uint64_t>(bundleSize_.load()) * option_.refillPercent;
+  if (remain * 100 > size || !running_.load() || refilling_.load()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (running_.load() && standby_ == nullptr && !refilling_.load()) {
+    refilling_.store(true);
+    cond_.notify_all();
+  }
+}
+
+void ChunkIdPool::RefillLoop() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  while (true) {
+    cond_.wait(lk, [this]() { return !running_.load() || refilling_.load(); });
+    if (!running_.load()) {
+      break;
+    }
+
+    uint32_t bundleSize = NextBundleSizeLocked();
+    lk.unlock();
+    std::shared_ptr<Range> fetched;
+    auto rc = Fetch(bundleSize, &fetched);
+    lk.lock();
+    if (rc == FSStatusCode::OK) {
+      standby_ = std::move(fetched);
+    } else {
+      LOG(WARNING) << "Refill chunk id pool failed, retCode = "
+                   << FSStatusCode_Name(rc);
+    }
+    refilling_.store(false);
+    cond_.notify_all();
+  }
+
+  refilling_.store(false);
+  cond_.notify_all();
+}
+
+// Grow to the allocation rate at once, but shrink by half at most, so a
+// short idle period doesn't make the next burst go to mds again.
+uint32_t ChunkIdPool::NextBundleSizeLocked() {
+  uint64_t now = TimeUtility::GetTimeofDayMs();
+  uint64_t consumed = consumed_.exchange(0, std::memory_order_relaxed);
+  uint64_t bundleSize = bundleSize_.load();
+  if (lastFetchMs_ != 0 && now > lastFetchMs_) {
+    uint64_t want = consumed * 1000 * option_.bundleLifetimeSec /
+                    (now - lastFetchMs_);
+    want = std::max(want, bundleSize / 2);
+    bundleSize = std::min<uint64_t>(
+        std::max<uint64_t>(want, option_.minBundleSize),
+        option_.maxBundleSize);
+    bundleSize_.store(static_cast<uint32_t>(bundleSize));
+  }
+  lastFetchMs_ = now;
+  return static_cast<uint32_t>(bundleSize);
+}
+
+FSStatusCode ChunkIdPool::Fetch(uint32_t bundleSize,
+                                std::shared_ptr<Range>* range) {
+  uint64_t beginId = 0;
+  remoteAllocs_ << 1;
+  auto rc = alloc_(bundleSize, &beginId);
+  if (rc == FSStatusCode::OK) {
+    *range = std::make_shared<Range>(beginId, beginId + bundleSize);
+    VLOG(3) << "Fetch chunk id range [" << beginId << ", "
+            << beginId + bundleSize << ") from mds";
+  }
+  return rc;
+}
+
+}  // namespace client
+}  // namespace dingofs
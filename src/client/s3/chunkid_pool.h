@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_CLIENT_S3_CHUNKID_POOL_H_
+#define DINGOFS_SRC_CLIENT_S3_CHUNKID_POOL_H_
+
+#include <bvar/bvar.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "client/common/config.h"
+#include "dingofs/mds.pb.h"
+
+namespace dingofs {
+namespace client {
+
+// Allocate chunk ids from the ranges which are granted by mds in batch.
+//
+// The ids of current range are taken by CAS without any lock, a standby
+// range is fetched in background before the current one runs out, so the
+// write path only sends the rpc to mds when the background refill can't
+// keep up. The size of range follows the allocation rate, so one range
+// lasts about `bundleLifetimeSec`. The unused ids are simply dropped when
+// the client exits.
+//
+// NOTE: the chunk id is also the version of data, the overlapped data in
+// one chunk is resolved by it, so the ids are not globally ordered by the
+// time of allocation once they come from the ranges of different clients.
+// The caller passes the largest chunk id it seen in the chunk, the ids
+// below it are skipped and a new range is fetched if the current one can't
+// exceed it, so the data written later always wins over the data the
+// client seen. Concurrent writers on one chunk are not ordered.
+class ChunkIdPool {
+ public:
+  // allocate `idNum` continuous ids from mds
+  using AllocFunc =
+      std::function<pb::mds::FSStatusCode(uint32_t idNum, uint64_t* beginId)>;
+
+  ChunkIdPool(const common::ChunkIdPoolOption& option, AllocFunc alloc);
+
+  ~ChunkIdPool();
+
+  void Start();
+
+  void Stop();
+
+  // allocate `idNum` continuous ids which are larger than `minId`
+  pb::mds::FSStatusCode Alloc(uint32_t idNum, uint64_t* beginId,
+                              uint64_t minId = 0);
+
+  uint32_t BundleSize();
+
+ private:
+  struct Range {
+    Range(uint64_t begin, uint64_t end) : next(begin), end(end) {}
+
+    std::atomic<uint64_t> next;
+    const uint64_t end;
+  };
+
+  bool Enabled() const { return option_.minBundleSize > 0; }
+
+  static bool TakeFrom(Range* range, uint32_t idNum, uint64_t minId,
+                       uint64_t* beginId);
+
+  void MaybeRefill(const Range& range);
+
+  void RefillLoop();
+
+  uint32_t NextBundleSizeLocked();
+
+  pb::mds::FSStatusCode Fetch(uint32_t bundleSize,
+                              std::shared_ptr<Range>* range);
+
+ private:
+  common::ChunkIdPoolOption option_;
+  AllocFunc alloc_;
+
+  // accessed by std::atomic_load/std::atomic_store only
+  std::shared_ptr<Range> current_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::shared_ptr<Range> standby_;
+  // one fetch is in flight, either in background or in the write path
+  std::atomic<bool> refilling_;
+  std::atomic<bool> running_;
+  std::thread refiller_;
+
+  std::atomic<uint32_t> bundleSize_;
+  uint64_t lastFetchMs_;
+  std::atomic<uint64_t> consumed_;  // ids allocated since the last fetch
+
+  bvar::Adder<uint64_t> localAllocs_;
+  bvar::Adder<uint64_t> remoteAllocs_;
+  bvar::Adder<uint64_t> blockingFetches_;
+  bvar::LatencyRecorder allocLatency_;
+};
+
+}  // namespace client
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_CLIENT_S3_CHUNKID_POOL_H_
@@ -25,6 +25,7 @@
 #include <brpc/channel.h>
 #include <brpc/controller.h>
 
+#include <algorithm>
 #include <utility>
 
 #include "client/blockcache/error.h"
@@ -77,6 +78,10 @@ S3ClientAdaptorImpl::Init(const S3ClientAdaptorOption& option,
   client_ = client;
   inodeManager_ = inodeManager;
   mdsClient_ = mdsClient;
+  chunkIdPool_ = std::make_unique<ChunkIdPool>(
+      option.chunkIdPoolOpt, [this](uint32_t idNum, uint64_t* beginId) {
+        return mdsClient_->AllocS3ChunkId(fsId_, idNum, beginId);
+      });
   fsCacheManager_ = fsCacheManager;
   waitInterval_.Init(option.intervalMs);
   filesystem_ = filesystem;
@@ -107,6 +112,7 @@ S3ClientAdaptorImpl::Init(const S3ClientAdaptorOption& option,
   if (startBackGround) {
     toStop_.store(false, std::memory_order_release);
     bgFlushThread_ = Thread(&S3ClientAdaptorImpl::BackGroundFlush, this);
+    chunkIdPool_->Start();
   }
 
   LOG(INFO) << "S3ClientAdaptorImpl Init. block size:" << blockSize_
@@ -189,7 +195,13 @@ DINGOFS_ERROR S3ClientAdaptorImpl::Truncate(InodeWrapper* inodeWrapper,
     FSStatusCode ret;
     uint64_t fsId = inode->fsid();
     uint32_t chunkIdNum = len / chunkSize_ + 1;
-    ret = AllocS3ChunkId(fsId, chunkIdNum, &beginChunkId);
+    uint64_t minChunkId = 0;
+    for (uint64_t i = index; i < index + chunkIdNum; i++) {
+      minChunkId = std::max(
+          minChunkId,
+          MaxS3ChunkIdInMap(i, *inodeWrapper->GetChunkInfoMap()));
+    }
+    ret = AllocS3ChunkId(fsId, chunkIdNum, &beginChunkId, minChunkId);
     if (ret != FSStatusCode::OK) {
       LOG(ERROR) << "Truncate alloc s3 chunkid fail. ret:" << ret;
       return DINGOFS_ERROR::INTERNAL;
@@ -260,6 +272,16 @@ DINGOFS_ERROR S3ClientAdaptorImpl::FsSync() {
 
 FSStatusCode S3ClientAdaptorImpl::AllocS3ChunkId(uint32_t fsId, uint32_t idNum,
                                                  uint64_t* chunkId) {
+  return AllocS3ChunkId(fsId, idNum, chunkId, 0);
+}
+
+FSStatusCode S3ClientAdaptorImpl::AllocS3ChunkId(uint32_t fsId, uint32_t idNum,
+                                                 uint64_t* chunkId,
+                                                 uint64_t minChunkId) {
+  // the pool only serves the mounted filesystem
+  if (chunkIdPool_ != nullptr && fsId == fsId_) {
+    return chunkIdPool_->Alloc(idNum, chunkId, minChunkId);
+  }
   return mdsClient_->AllocS3ChunkId(fsId, idNum, chunkId);
 }
 
@@ -296,6 +318,9 @@ int S3ClientAdaptorImpl::Stop() {
   if (bgFlushThread_.joinable()) {
     bgFlushThread_.join();
   }
+  if (chunkIdPool_ != nullptr) {
+    chunkIdPool_->Stop();
+  }
   if (HasDiskCache()) {
     for (auto& q : downloadTaskQueues_) {
       bthread::execution_queue_stop(q);
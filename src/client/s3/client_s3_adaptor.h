@@ -34,6 +34,7 @@
 #include "client/filesystem/error.h"
 #include "client/filesystem/filesystem.h"
 #include "client/inode_cache_manager.h"
+#include "client/s3/chunkid_pool.h"
 #include "client/s3/client_s3_cache_manager.h"
 #include "stub/rpcclient/mds_client.h"
 #include "utils/wait_interval.h"
@@ -167,6 +168,11 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
   pb::mds::FSStatusCode AllocS3ChunkId(uint32_t fsId, uint32_t idNum,
                                        uint64_t* chunkId) override;
 
+  // the ids are larger than `minChunkId`, which is the largest chunk id the
+  // caller seen in the chunks it writes, see ChunkIdPool
+  pb::mds::FSStatusCode AllocS3ChunkId(uint32_t fsId, uint32_t idNum,
+                                       uint64_t* chunkId, uint64_t minChunkId);
+
   void FsSyncSignal() {
     std::lock_guard<std::mutex> lk(mtx_);
     VLOG(3) << "fs sync signal";
@@ -234,6 +240,7 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
   std::shared_ptr<filesystem::FileSystem> filesystem_;
   std::shared_ptr<blockcache::BlockCache> block_cache_;
   std::shared_ptr<stub::rpcclient::MdsClient> mdsClient_;
+  std::unique_ptr<ChunkIdPool> chunkIdPool_;
   uint32_t fsId_;
   std::string fsName_;
   std::vector<bthread::ExecutionQueueId<AsyncDownloadTask>> downloadTaskQueues_;
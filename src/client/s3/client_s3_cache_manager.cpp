@@ -260,14 +260,15 @@ DINGOFS_ERROR FsCacheManager::FsSync(bool force) {
   for (const auto& item : pending) {
     Ino ino = item.first;
     auto file = item.second;
-    DataStream::GetInstance().EnterFlushFileQueue([&, ino, file, post_flush]() {
-      auto code = file->Flush(force);
-      post_flush(ino, file, code);
-      if (code != DINGOFS_ERROR::OK && code != DINGOFS_ERROR::NOTEXIST) {
-        rc = code;
-      }
-      count_down_event.Signal();
-    });
+    DataStream::GetInstance().EnterFlushFileQueue(
+        ino, [&, ino, file, post_flush]() {
+          auto code = file->Flush(force);
+          post_flush(ino, file, code);
+          if (code != DINGOFS_ERROR::OK && code != DINGOFS_ERROR::NOTEXIST) {
+            rc = code;
+          }
+          count_down_event.Signal();
+        });
   }
   count_down_event.Wait();
   return rc;
@@ -1187,13 +1188,17 @@ void ChunkCacheManager::ReadChunk(uint64_t index, uint64_t chunkPos,
   flushingDataCacheMtx_.lock();
   if (!IsFlushDataEmpty()) {
     // read by flushing data cache
-    for (auto request : cache_miss_write_requests) {
-      std::vector<ReadRequest> tmp_requests;
-      ReadByFlushData(request.chunkPos, request.len, dataBuf, request.bufOffset,
-                      &tmp_requests);
-      cache_miss_flush_data_request.insert(cache_miss_flush_data_request.end(),
-                                           tmp_requests.begin(),
-                                           tmp_requests.end());
+    cache_miss_flush_data_request = cache_miss_write_requests;
+    for (const auto& dataCache : flushingDataCaches_) {
+      std::vector<ReadRequest> miss_requests;
+      for (auto request : cache_miss_flush_data_request) {
+        std::vector<ReadRequest> tmp_requests;
+        ReadByFlushData(dataCache, request.chunkPos, request.len, dataBuf,
+                        request.bufOffset, &tmp_requests);
+        miss_requests.insert(miss_requests.end(), tmp_requests.begin(),
+                             tmp_requests.end());
+      }
+      cache_miss_flush_data_request.swap(miss_requests);
     }
     flushingDataCacheMtx_.unlock();
 
@@ -1418,11 +1423,12 @@ void ChunkCacheManager::ReadByReadCache(uint64_t chunkPos, uint64_t readLen,
   return;
 }
 
-void ChunkCacheManager::ReadByFlushData(uint64_t chunkPos, uint64_t readLen,
+void ChunkCacheManager::ReadByFlushData(const DataCachePtr& flushingDataCache,
+                                        uint64_t chunkPos, uint64_t readLen,
                                         char* dataBuf, uint64_t dataBufOffset,
                                         std::vector<ReadRequest>* requests) {
-  uint64_t dcChunkPos = flushingDataCache_->GetChunkPos();
-  uint64_t dcLen = flushingDataCache_->GetLen();
+  uint64_t dcChunkPos = flushingDataCache->GetChunkPos();
+  uint64_t dcLen = flushingDataCache->GetLen();
   ReadRequest request;
   VLOG(9) << "Try to ReadByFlushData chunkPos: " << chunkPos
           << ", readLen: " << readLen << ", dcChunkPos: " << dcChunkPos
@@ -1447,7 +1453,7 @@ void ChunkCacheManager::ReadByFlushData(uint64_t chunkPos, uint64_t readLen,
             ------           DataCache
     */
     if (chunkPos + readLen <= dcChunkPos + dcLen) {
-      flushingDataCache_->CopyDataCacheToBuf(
+      flushingDataCache->CopyDataCacheToBuf(
           0, chunkPos + readLen - dcChunkPos,
           dataBuf + request.len + dataBufOffset);
       readLen = 0;
@@ -1457,7 +1463,7 @@ void ChunkCacheManager::ReadByFlushData(uint64_t chunkPos, uint64_t readLen,
               ------           DataCache
       */
     } else {
-      flushingDataCache_->CopyDataCacheToBuf(
+      flushingDataCache->CopyDataCacheToBuf(
           0, dcLen, dataBuf + request.len + dataBufOffset);
       readLen = chunkPos + readLen - (dcChunkPos + dcLen);
       dataBufOffset = dcChunkPos + dcLen - chunkPos + dataBufOffset;
@@ -1469,8 +1475,8 @@ void ChunkCacheManager::ReadByFlushData(uint64_t chunkPos, uint64_t readLen,
            ---------           DataCache
     */
     if (chunkPos + readLen <= dcChunkPos + dcLen) {
-      flushingDataCache_->CopyDataCacheToBuf(chunkPos - dcChunkPos, readLen,
-                                             dataBuf + dataBufOffset);
+      flushingDataCache->CopyDataCacheToBuf(chunkPos - dcChunkPos, readLen,
+                                            dataBuf + dataBufOffset);
       readLen = 0;
       return;
       /*
@@ -1478,9 +1484,9 @@ void ChunkCacheManager::ReadByFlushData(uint64_t chunkPos, uint64_t readLen,
              ---------                DataCache
       */
     } else {
-      flushingDataCache_->CopyDataCacheToBuf(chunkPos - dcChunkPos,
-                                             dcChunkPos + dcLen - chunkPos,
-                                             dataBuf + dataBufOffset);
+      flushingDataCache->CopyDataCacheToBuf(chunkPos - dcChunkPos,
+                                            dcChunkPos + dcLen - chunkPos,
+                                            dataBuf + dataBufOffset);
       readLen = chunkPos + readLen - dcChunkPos - dcLen;
       dataBufOffset = dcChunkPos + dcLen - chunkPos + dataBufOffset;
       chunkPos = dcChunkPos + dcLen;
@@ -1700,10 +1706,14 @@ void ChunkCacheManager::ReleaseWriteDataCache(const DataCachePtr& dataCache) {
 
 DINGOFS_ERROR ChunkCacheManager::Flush(uint64_t inodeId, bool force,
                                        bool toS3) {
+  if (DataStream::GetInstance().FlushPipelineEnabled()) {
+    return FlushByPipeline(inodeId, force);
+  }
+
   std::map<uint64_t, DataCachePtr> tmp;
   dingofs::utils::LockGuard lg(flushMtx_);
   DINGOFS_ERROR ret = DINGOFS_ERROR::OK;
-  // DataCachePtr dataCache;
+  DataCachePtr dataCache;
   while (1) {
     bool isFlush = false;
     {
@@ -1712,9 +1722,10 @@ DINGOFS_ERROR ChunkCacheManager::Flush(uint64_t inodeId, bool force,
       auto iter = dataWCacheMap_.begin();
       while (iter != dataWCacheMap_.end()) {
         if (iter->second->CanFlush(force)) {
+          dataCache = std::move(iter->second);
           {
             dingofs::utils::LockGuard lg(flushingDataCacheMtx_);
-            flushingDataCache_ = std::move(iter->second);
+            flushingDataCaches_.emplace_back(dataCache);
           }
           dataWCacheMap_.erase(iter);
           isFlush = true;
@@ -1725,36 +1736,34 @@ DINGOFS_ERROR ChunkCacheManager::Flush(uint64_t inodeId, bool force,
       }
     }
     if (isFlush) {
-      VLOG(9) << "Flush datacache chunkPos:"
-              << flushingDataCache_->GetChunkPos()
-              << ", len:" << flushingDataCache_->GetLen()
-              << ", inodeId=" << inodeId << ", chunkIndex:" << index_;
-      assert(flushingDataCache_->IsDirty());
+      VLOG(9) << "Flush datacache chunkPos:" << dataCache->GetChunkPos()
+              << ", len:" << dataCache->GetLen() << ", inodeId=" << inodeId
+              << ", chunkIndex:" << index_;
+      assert(dataCache->IsDirty());
       do {
-        ret = flushingDataCache_->Flush(inodeId, toS3);
+        ret = dataCache->Flush(inodeId, toS3);
         if (ret == DINGOFS_ERROR::NOTEXIST) {
           LOG(WARNING) << "dataCache flush failed. ret:" << ret
-                       << ", index:" << index_ << ", data chunkpos:"
-                       << flushingDataCache_->GetChunkPos();
-          ReleaseWriteDataCache(flushingDataCache_);
+                       << ", index:" << index_
+                       << ", data chunkpos:" << dataCache->GetChunkPos();
+          ReleaseWriteDataCache(dataCache);
           break;
         } else if (ret == DINGOFS_ERROR::INTERNAL) {
           LOG(WARNING) << "dataCache flush failed. ret:" << ret
-                       << ", index:" << index_ << ", data chunkpos:"
-                       << flushingDataCache_->GetChunkPos()
+                       << ", index:" << index_
+                       << ", data chunkpos:" << dataCache->GetChunkPos()
                        << ", should retry.";
           ::sleep(3);
           continue;
         }
         VLOG(9) << "ReleaseWriteDataCache chunkPos:"
-                << flushingDataCache_->GetChunkPos()
-                << ", len:" << flushingDataCache_->GetLen()
+                << dataCache->GetChunkPos() << ", len:" << dataCache->GetLen()
                 << ", inodeId=" << inodeId << ", chunkIndex:" << index_;
-        ReleaseWriteDataCache(flushingDataCache_);
+        ReleaseWriteDataCache(dataCache);
       } while (ret != DINGOFS_ERROR::OK);
       {
         dingofs::utils::LockGuard lg(flushingDataCacheMtx_);
-        flushingDataCache_ = nullptr;
+        flushingDataCaches_.clear();
       }
     } else {
       VLOG(9) << "can not find flush datacache, inodeId=" << inodeId
@@ -1765,6 +1774,78 @@ DINGOFS_ERROR ChunkCacheManager::Flush(uint64_t inodeId, bool force,
   return DINGOFS_ERROR::OK;
 }
 
+// All flushable data caches of chunk are submitted to the flush pipeline at
+// once and waited together, so the blocks of different slices are uploaded
+// in parallel. The failed ones are retried like the serial flush does.
+DINGOFS_ERROR ChunkCacheManager::FlushByPipeline(uint64_t inodeId,
+                                                 bool force) {
+  dingofs::utils::LockGuard lg(flushMtx_);
+  while (1) {
+    std::vector<DataCachePtr> dataCaches;
+    {
+      WriteLockGuard writeLockGuard(rwLockChunk_);
+      dingofs::utils::LockGuard lg(flushingDataCacheMtx_);
+      auto iter = dataWCacheMap_.begin();
+      while (iter != dataWCacheMap_.end()) {
+        if (iter->second->CanFlush(force)) {
+          dataCaches.emplace_back(std::move(iter->second));
+          iter = dataWCacheMap_.erase(iter);
+        } else {
+          iter++;
+        }
+      }
+      flushingDataCaches_ = dataCaches;
+    }
+    if (dataCaches.empty()) {
+      VLOG(9) << "can not find flush datacache, inodeId=" << inodeId
+              << ", chunkIndex:" << index_;
+      break;
+    }
+
+    while (!dataCaches.empty()) {
+      std::vector<DINGOFS_ERROR> rets(dataCaches.size(), DINGOFS_ERROR::OK);
+      CountDownEvent done(dataCaches.size());
+      for (size_t i = 0; i < dataCaches.size(); i++) {
+        assert(dataCaches[i]->IsDirty());
+        rets[i] = dataCaches[i]->FlushByPipeline(
+            inodeId, [&done]() { done.Signal(); });
+        if (rets[i] != DINGOFS_ERROR::OK) {
+          done.Signal();
+        }
+      }
+      done.Wait();
+
+      std::vector<DataCachePtr> retries;
+      for (size_t i = 0; i < dataCaches.size(); i++) {
+        if (rets[i] == DINGOFS_ERROR::INTERNAL) {
+          LOG(WARNING) << "dataCache flush failed. ret:" << rets[i]
+                       << ", index:" << index_
+                       << ", data chunkpos:" << dataCaches[i]->GetChunkPos()
+                       << ", should retry.";
+          retries.emplace_back(dataCaches[i]);
+          continue;
+        } else if (rets[i] == DINGOFS_ERROR::NOTEXIST) {
+          LOG(WARNING) << "dataCache flush failed. ret:" << rets[i]
+                       << ", index:" << index_
+                       << ", data chunkpos:" << dataCaches[i]->GetChunkPos();
+        }
+        ReleaseWriteDataCache(dataCaches[i]);
+      }
+
+      if (!retries.empty()) {
+        ::sleep(3);
+      }
+      dataCaches.swap(retries);
+    }
+
+    {
+      dingofs::utils::LockGuard lg(flushingDataCacheMtx_);
+      flushingDataCaches_.clear();
+    }
+  }
+  return DINGOFS_ERROR::OK;
+}
+
 void ChunkCacheManager::UpdateWriteCacheMap(uint64_t oldChunkPos,
                                             DataCache* pDataCache) {
   auto iter = dataWCacheMap_.find(oldChunkPos);
@@ -2283,6 +2364,15 @@ DINGOFS_ERROR DataCache::Flush(uint64_t inodeId, bool toS3) {
           << ", chunkIndex=" << chunkCacheManager_->GetIndex()
           << ", inodeId=" << inodeId;
 
+  std::shared_ptr<InodeWrapper> inodeWrapper;
+  DINGOFS_ERROR ret =
+      s3ClientAdaptor_->GetInodeCacheManager()->GetInode(inodeId, inodeWrapper);
+  if (ret != DINGOFS_ERROR::OK) {
+    LOG(WARNING) << "get inode fail, ret:" << ret;
+    status_.store(DataCacheStatus::Dirty, std::memory_order_release);
+    return ret;
+  }
+
   // generate flush task
   std::vector<FlushBlock> s3Tasks;
   std::vector<std::shared_ptr<SetKVCacheTask>> kvCacheTasks;
@@ -2294,8 +2384,10 @@ DINGOFS_ERROR DataCache::Flush(uint64_t inodeId, bool toS3) {
   CopyDataCacheToBuf(0, len_, data);
   uint64_t writeOffset = 0;
   uint64_t chunkId = 0;
-  DINGOFS_ERROR ret = PrepareFlushTasks(inodeId, data, &s3Tasks, &kvCacheTasks,
-                                        &chunkId, &writeOffset);
+  uint64_t chunkIndex = chunkCacheManager_->GetIndex();
+  ret = PrepareFlushTasks(inodeId, inodeWrapper->GetMaxS3ChunkId(chunkIndex),
+                          data, &s3Tasks, &kvCacheTasks, &chunkId,
+                          &writeOffset);
   if (DINGOFS_ERROR::OK != ret) {
     return ret;
   }
@@ -2305,17 +2397,7 @@ DINGOFS_ERROR DataCache::Flush(uint64_t inodeId, bool toS3) {
   free(data);
 
   // inode ship to flush
-  std::shared_ptr<InodeWrapper> inodeWrapper;
-  ret =
-      s3ClientAdaptor_->GetInodeCacheManager()->GetInode(inodeId, inodeWrapper);
-  if (ret != DINGOFS_ERROR::OK) {
-    LOG(WARNING) << "get inode fail, ret:" << ret;
-    status_.store(DataCacheStatus::Dirty, std::memory_order_release);
-    return ret;
-  }
-
   S3ChunkInfo info;
-  uint64_t chunkIndex = chunkCacheManager_->GetIndex();
   uint64_t chunkSize = s3ClientAdaptor_->GetChunkSize();
   int64_t offset = chunkIndex * chunkSize + chunkPos_;
   PrepareS3ChunkInfo(chunkId, offset, writeOffset, &info);
@@ -2326,12 +2408,14 @@ DINGOFS_ERROR DataCache::Flush(uint64_t inodeId, bool toS3) {
 }
 
 DINGOFS_ERROR DataCache::PrepareFlushTasks(
-    uint64_t inodeId, char* data, std::vector<FlushBlock>* s3Tasks,
+    uint64_t inodeId, uint64_t minChunkId, char* data,
+    std::vector<FlushBlock>* s3Tasks,
     std::vector<std::shared_ptr<SetKVCacheTask>>* kvCacheTasks,
     uint64_t* chunkId, uint64_t* writeOffset) {
-  // allocate chunkid
+  // allocate chunkid, it must be newer than the data we seen in the chunk
   uint32_t fsId = s3ClientAdaptor_->GetFsId();
-  FSStatusCode ret = s3ClientAdaptor_->AllocS3ChunkId(fsId, 1, chunkId);
+  FSStatusCode ret =
+      s3ClientAdaptor_->AllocS3ChunkId(fsId, 1, chunkId, minChunkId);
   if (ret != FSStatusCode::OK) {
     LOG(ERROR) << "alloc s3 chunkid fail. ret:" << ret;
     return DINGOFS_ERROR::INTERNAL;
@@ -2437,6 +2521,105 @@ void DataCache::FlushTaskExecute(
   s3TaskEvent.Wait();
 }
 
+DINGOFS_ERROR DataCache::FlushByPipeline(uint64_t inodeId,
+                                         std::function<void()> done) {
+  VLOG(9) << "DataCache FlushByPipeline. chunkPos=" << chunkPos_
+          << ", len=" << len_
+          << ", chunkIndex=" << chunkCacheManager_->GetIndex()
+          << ", inodeId=" << inodeId;
+
+  std::shared_ptr<InodeWrapper> inodeWrapper;
+  DINGOFS_ERROR ret =
+      s3ClientAdaptor_->GetInodeCacheManager()->GetInode(inodeId, inodeWrapper);
+  if (ret != DINGOFS_ERROR::OK) {
+    LOG(WARNING) << "get inode fail, ret:" << ret;
+    status_.store(DataCacheStatus::Dirty, std::memory_order_release);
+    return ret;
+  }
+
+  // allocate chunkid, it must be newer than the data we seen in the chunk
+  uint64_t chunkId = 0;
+  uint32_t fsId = s3ClientAdaptor_->GetFsId();
+  FSStatusCode rc = s3ClientAdaptor_->AllocS3ChunkId(
+      fsId, 1, &chunkId,
+      inodeWrapper->GetMaxS3ChunkId(chunkCacheManager_->GetIndex()));
+  if (rc != FSStatusCode::OK) {
+    LOG(ERROR) << "alloc s3 chunkid fail. ret:" << rc;
+    status_.store(DataCacheStatus::Dirty, std::memory_order_release);
+    return DINGOFS_ERROR::INTERNAL;
+  }
+
+  auto fs = s3ClientAdaptor_->GetFileSystem();
+  auto entry_watcher = fs->BorrowMember().entry_watcher;
+  auto block_cache = s3ClientAdaptor_->GetBlockCache();
+  auto from = entry_watcher->ShouldWriteback(inodeId) ? BlockFrom::NOCTO_FLUSH
+                                                      : BlockFrom::CTO_FLUSH;
+
+  // slice -> blocks, the data cache is kept alive until the slice committed
+  auto self = shared_from_this();
+  datastream::FlushSliceTask task;
+  task.ino = inodeId;
+  uint64_t blockSize = s3ClientAdaptor_->GetBlockSize();
+  uint64_t blockPos = chunkPos_ % blockSize;
+  uint64_t blockIndex = chunkPos_ / blockSize;
+  uint64_t remainLen = len_;
+  uint64_t writeOffset = 0;
+  while (remainLen > 0) {
+    uint64_t curentLen =
+        blockPos + remainLen > blockSize ? blockSize - blockPos : remainLen;
+
+    BlockKey key(fsId, inodeId, chunkId, blockIndex, 0);
+    datastream::FlushBlockTask block;
+    block.length = curentLen;
+    block.encode = [self, writeOffset, curentLen](char* buffer) {
+      self->CopyDataCacheToBuf(writeOffset, curentLen, buffer);
+    };
+    block.upload = [self, key, curentLen, from,
+                    block_cache](const char* buffer) {
+      Block block(buffer, curentLen);
+      BlockContext ctx(from);
+      for (;;) {
+        auto rc = block_cache->Put(key, block, ctx);
+        if (rc == BCACHE_ERROR::OK) {
+          break;
+        }
+      }
+
+      if (self->kvClientManager_) {
+        CountDownEvent kvTaskEvent(1);
+        auto kvTask = std::make_shared<SetKVCacheTask>(
+            key.Filename(), buffer, curentLen,
+            [&](const std::shared_ptr<SetKVCacheTask>&) {
+              kvTaskEvent.Signal();
+            });
+        self->kvClientManager_->Set(kvTask);
+        kvTaskEvent.Wait();
+      }
+    };
+    task.blocks.emplace_back(std::move(block));
+
+    remainLen -= curentLen;
+    blockIndex++;
+    writeOffset += curentLen;
+    blockPos = (blockPos + curentLen) % blockSize;
+  }
+
+  // metadata commit, ordered by the pipeline for the same inode
+  uint64_t chunkIndex = chunkCacheManager_->GetIndex();
+  uint64_t offset = chunkIndex * s3ClientAdaptor_->GetChunkSize() + chunkPos_;
+  task.commit = [self, inodeWrapper, chunkId, chunkIndex, offset,
+                 writeOffset]() {
+    S3ChunkInfo info;
+    self->PrepareS3ChunkInfo(chunkId, offset, writeOffset, &info);
+    inodeWrapper->AppendS3ChunkInfo(chunkIndex, info);
+    self->s3ClientAdaptor_->GetInodeCacheManager()->ShipToFlush(inodeWrapper);
+  };
+  task.done = std::move(done);
+
+  DataStream::GetInstance().EnterFlushPipeline(std::move(task));
+  return DINGOFS_ERROR::OK;
+}
+
 void DataCache::PrepareS3ChunkInfo(uint64_t chunkId, uint64_t offset,
                                    uint64_t len, S3ChunkInfo* info) {
   info->set_chunkid(chunkId);
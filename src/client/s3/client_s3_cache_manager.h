@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
@@ -169,6 +170,10 @@ class DataCache : public std::enable_shared_from_this<DataCache> {
   uint64_t GetActualLen() { return actualLen_; }
 
   virtual DINGOFS_ERROR Flush(uint64_t inodeId, bool toS3 = false);
+  // submit the flush to the pipeline of data stream, |done| is invoked once
+  // the slice is committed, it is not invoked if an error returned.
+  virtual DINGOFS_ERROR FlushByPipeline(uint64_t inodeId,
+                                        std::function<void()> done);
   void Release();
   bool IsDirty() {
     return status_.load(std::memory_order_acquire) == DataCacheStatus::Dirty;
@@ -197,7 +202,8 @@ class DataCache : public std::enable_shared_from_this<DataCache> {
   void AddDataBefore(uint64_t len, const char* data);
 
   DINGOFS_ERROR PrepareFlushTasks(
-      uint64_t inodeId, char* data, std::vector<FlushBlock>* s3Tasks,
+      uint64_t inodeId, uint64_t minChunkId, char* data,
+      std::vector<FlushBlock>* s3Tasks,
       std::vector<std::shared_ptr<SetKVCacheTask>>* kvCacheTasks,
       uint64_t* chunkId, uint64_t* writeOffset);
 
@@ -241,7 +247,6 @@ class ChunkCacheManager
                     std::shared_ptr<KVClientManager> kvClientManager)
       : index_(index),
         s3ClientAdaptor_(s3ClientAdaptor),
-        flushingDataCache_(nullptr),
         kvClientManager_(std::move(kvClientManager)) {}
   virtual ~ChunkCacheManager() = default;
   void ReadChunk(uint64_t index, uint64_t chunkPos, uint64_t readLen,
@@ -260,10 +265,13 @@ class ChunkCacheManager
   virtual void ReadByReadCache(uint64_t chunkPos, uint64_t readLen,
                                char* dataBuf, uint64_t dataBufOffset,
                                std::vector<ReadRequest>* requests);
-  virtual void ReadByFlushData(uint64_t chunkPos, uint64_t readLen,
+  virtual void ReadByFlushData(const DataCachePtr& flushingDataCache,
+                               uint64_t chunkPos, uint64_t readLen,
                                char* dataBuf, uint64_t dataBufOffset,
                                std::vector<ReadRequest>* requests);
   virtual DINGOFS_ERROR Flush(uint64_t inodeId, bool force, bool toS3 = false);
+  // flush all flushable data caches by the pipeline of data stream
+  DINGOFS_ERROR FlushByPipeline(uint64_t inodeId, bool force);
   uint64_t GetIndex() { return index_; }
   bool IsEmpty() {
     utils::ReadLockGuard writeCacheLock(rwLockChunk_);
@@ -291,7 +299,7 @@ class ChunkCacheManager
   void ReleaseWriteDataCache(const DataCachePtr& dataCache);
   void TruncateWriteCache(uint64_t chunkPos);
   void TruncateReadCache(uint64_t chunkPos);
-  bool IsFlushDataEmpty() { return flushingDataCache_ == nullptr; }
+  bool IsFlushDataEmpty() { return flushingDataCaches_.empty(); }
 
   uint64_t index_;
   std::map<uint64_t, DataCachePtr> dataWCacheMap_;  // first is pos in chunk
@@ -301,7 +309,7 @@ class ChunkCacheManager
   utils::RWLock rwLockRead_;  //  for read cache
   S3ClientAdaptorImpl* s3ClientAdaptor_;
   dingofs::utils::Mutex flushMtx_;
-  DataCachePtr flushingDataCache_;
+  std::vector<DataCachePtr> flushingDataCaches_;
   dingofs::utils::Mutex flushingDataCacheMtx_;
 
   std::shared_ptr<KVClientManager> kvClientManager_;
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/warmup/warmup_checkpoint.h"
+
+#include <glog/logging.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+
+namespace dingofs {
+namespace client {
+namespace warmup {
+
+WarmupCheckpoint::WarmupCheckpoint(const std::string& path)
+    : path_(path), file_(nullptr) {}
+
+WarmupCheckpoint::~WarmupCheckpoint() {
+  if (file_ != nullptr) {
+    fclose(file_);
+  }
+}
+
+bool WarmupCheckpoint::Open() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  Load();
+  file_ = fopen(path_.c_str(), "a");
+  if (file_ == nullptr) {
+    LOG(ERROR) << "Open warmup checkpoint (" << path_
+               << ") failed: " << strerror(errno);
+    return false;
+  }
+  LOG(INFO) << "Open warmup checkpoint (" << path_ << ") success, "
+            << finished_.size() << " files already finished.";
+  return true;
+}
+
+// NOTE: the last line may be partial if the client crashed while appending,
+// the scanf stops there and that file will be warmed up again.
+void WarmupCheckpoint::Load() {
+  FILE* file = fopen(path_.c_str(), "r");
+  if (file == nullptr) {
+    return;
+  }
+
+  uint64_t ino, length;
+  while (fscanf(file, "%" SCNu64 " %" SCNu64, &ino, &length) == 2) {
+    finished_[ino] = length;
+  }
+  fclose(file);
+}
+
+bool WarmupCheckpoint::IsFinished(uint64_t ino, uint64_t length) {
+  std::unique_lock<std::mutex> lk(mutex_);
+  auto iter = finished_.find(ino);
+  return iter != finished_.end() && iter->second == length;
+}
+
+void WarmupCheckpoint::MarkFinished(uint64_t ino, uint64_t length) {
+  std::unique_lock<std::mutex> lk(mutex_);
+  finished_[ino] = length;
+  if (file_ != nullptr) {
+    fprintf(file_, "%" PRIu64 " %" PRIu64 "\n", ino, length);
+    fflush(file_);
+  }
+}
+
+size_t WarmupCheckpoint::FinishedCount() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  return finished_.size();
+}
+
+void WarmupCheckpoint::Remove() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+  if (unlink(path_.c_str()) != 0 && errno != ENOENT) {
+    LOG(WARNING) << "Remove warmup checkpoint (" << path_
+                 << ") failed: " << strerror(errno);
+  }
+  finished_.clear();
+}
+
+}  // namespace warmup
+}  // namespace client
+}  // namespace dingofs
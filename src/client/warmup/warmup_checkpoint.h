@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_CLIENT_WARMUP_WARMUP_CHECKPOINT_H_
+#define DINGOFS_SRC_CLIENT_WARMUP_WARMUP_CHECKPOINT_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace dingofs {
+namespace client {
+namespace warmup {
+
+// The checkpoint of one warmup task, it records the files which have been
+// warmed up completely, one line "<inodeid> <length>" per file. The file is
+// skipped when the same task is submitted again, unless its length changed.
+class WarmupCheckpoint {
+ public:
+  explicit WarmupCheckpoint(const std::string& path);
+
+  virtual ~WarmupCheckpoint();
+
+  // load the finished files (if any) and open the checkpoint for append
+  bool Open();
+
+  bool IsFinished(uint64_t ino, uint64_t length);
+
+  void MarkFinished(uint64_t ino, uint64_t length);
+
+  size_t FinishedCount();
+
+  // remove the checkpoint after the warmup task succeeds
+  void Remove();
+
+ private:
+  void Load();
+
+ private:
+  std::string path_;
+  std::mutex mutex_;
+  FILE* file_;
+  std::unordered_map<uint64_t, uint64_t> finished_;  // ino -> length
+};
+
+}  // namespace warmup
+}  // namespace client
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_CLIENT_WARMUP_WARMUP_CHECKPOINT_H_
@@ -26,7 +26,6 @@
 #include <unistd.h>
 
 #include <atomic>
-#include <deque>
 #include <list>
 #include <memory>
 #include <utility>
@@ -34,8 +33,10 @@
 #include "dingofs/metaserver.pb.h"
 #include "base/filepath/filepath.h"
 #include "client/blockcache/cache_store.h"
+#include "client/blockcache/local_filesystem.h"
 #include "client/blockcache/s3_client.h"
 #include "client/common/common.h"
+#include "client/filesystem/access_trace.h"
 #include "client/inode_wrapper.h"
 #include "client/kvclient/kvclient_manager.h"
 #include "stub/metric/metric.h"
@@ -46,8 +47,8 @@ namespace dingofs {
 namespace client {
 namespace warmup {
 
-using aws::GetObjectAsyncCallBack;
 using aws::GetObjectAsyncContext;
+using base::filepath::PathJoin;
 using base::filepath::PathSplit;
 using blockcache::BCACHE_ERROR;
 using blockcache::Block;
@@ -55,16 +56,19 @@ using blockcache::BlockKey;
 using blockcache::S3ClientImpl;
 using common::FuseClientOption;
 using common::WarmupStorageType;
-using stub::metric::MetricGuard;
-using stub::metric::S3Metric;
 using utils::ReadLockGuard;
 using utils::WriteLockGuard;
 
 using pb::metaserver::Dentry;
 using pb::metaserver::FsFileType;
+using pb::metaserver::InodeAttr;
 
 #define WARMUP_CHECKINTERVAL_US (1000 * 1000)
 
+// the scheduler key of blocks prefetched by replaying access profile,
+// inode 0 is never a warmup task.
+static constexpr fuse_ino_t kReplayWarmupKey = 0;
+
 bool WarmupManagerS3Impl::AddWarmupFilelist(fuse_ino_t key,
                                             WarmupStorageType type) {
   if (!mounted_.load(std::memory_order_acquire)) {
@@ -86,6 +90,7 @@ bool WarmupManagerS3Impl::AddWarmupFilelist(fuse_ino_t key,
       }
       uint64_t len = inodeWrapper->GetLength();
       warmupFilelistDeque_.emplace_back(key, len);
+      OpenCheckpoint(key);
     }
   }  // Skip already added
   return true;
@@ -100,6 +105,7 @@ bool WarmupManagerS3Impl::AddWarmupFile(fuse_ino_t key, const std::string& path,
   // add warmup Progress
   if (AddWarmupProcess(key, type)) {
     VLOG(9) << "add warmup single task:" << key;
+    OpenCheckpoint(key);
     FetchDentryEnqueue(key, path);
   }
   return true;
@@ -123,8 +129,18 @@ void WarmupManagerS3Impl::UnInit() {
   WriteLockGuard lockS3Objects(inode2FetchS3ObjectsPoolMutex_);
   inode2FetchS3ObjectsPool_.clear();
 
-  WriteLockGuard lockInodes(warmupInodesDequeMutex_);
-  warmupInodesDeque_.clear();
+  if (replayer_ != nullptr) {
+    filesystem::AccessTracer::GetInstance().SetListener(0, nullptr);
+    replayer_ = nullptr;
+  }
+
+  if (scheduler_ != nullptr) {
+    scheduler_->Stop();
+  }
+
+  // keep the checkpoint files, the interrupted tasks can be resumed
+  WriteLockGuard lockCheckpoints(checkpointsMutex_);
+  checkpoints_.clear();
 
   WriteLockGuard lockFileList(warmupFilelistDequeMutex_);
   warmupFilelistDeque_.clear();
@@ -134,6 +150,8 @@ void WarmupManagerS3Impl::UnInit() {
 
 void WarmupManagerS3Impl::Init(const FuseClientOption& option) {
   WarmupManager::Init(option);
+  scheduler_ = std::make_unique<WarmupScheduler>();
+  scheduler_->Start(option.warmup_option);
   bgFetchStop_.store(false, std::memory_order_release);
   bgFetchThread_ = utils::Thread(&WarmupManagerS3Impl::BackGroundFetch, this);
   initbgFetchThread_ = true;
@@ -143,7 +161,6 @@ void WarmupManagerS3Impl::BackGroundFetch() {
   while (!bgFetchStop_.load(std::memory_order_acquire)) {
     usleep(WARMUP_CHECKINTERVAL_US);
     ScanWarmupFilelist();
-    ScanWarmupInodes();
     ScanCleanFetchS3ObjectsPool();
     ScanCleanFetchDentryPool();
     ScanCleanWarmupProgress();
@@ -261,14 +278,7 @@ void WarmupManagerS3Impl::FetchDentry(fuse_ino_t key, fuse_ino_t ino,
     return;
   }
   if (FsFileType::TYPE_S3 == dentry.type()) {
-    WriteLockGuard lock(warmupInodesDequeMutex_);
-    auto iterDeque = FindWarmupInodesByKeyLocked(key);
-    if (iterDeque == warmupInodesDeque_.end()) {
-      warmupInodesDeque_.emplace_back(key,
-                                      std::set<fuse_ino_t>{dentry.inodeid()});
-    } else {
-      iterDeque->AddFileInode(dentry.inodeid());
-    }
+    FetchDataEnqueue(key, dentry.inodeid());
     return;
   } else if (FsFileType::TYPE_DIRECTORY == dentry.type()) {
     auto task = [this, key, dentry]() {
@@ -287,6 +297,10 @@ void WarmupManagerS3Impl::FetchDentry(fuse_ino_t key, fuse_ino_t ino,
   VLOG(9) << "FetchDentry end: " << file << ", ino: " << ino;
 }
 
+// The directory tree is walked in BFS order by the dentry thread pool of
+// the warmup task, which bounds the concurrency. The attributes of the child
+// files are fetched in batch, so the empty or already warmed up files are
+// skipped without fetching the whole inode.
 void WarmupManagerS3Impl::FetchChildDentry(fuse_ino_t key, fuse_ino_t ino) {
   VLOG(9) << "FetchChildDentry start: key:" << key << " inode: " << ino;
   std::list<Dentry> dentryList;
@@ -297,18 +311,12 @@ void WarmupManagerS3Impl::FetchChildDentry(fuse_ino_t key, fuse_ino_t ino) {
                << ", parent = " << ino;
     return;
   }
+
+  std::set<uint64_t> files;
   for (const auto& dentry : dentryList) {
     VLOG(9) << "FetchChildDentry: key:" << key << " dentry: " << dentry.name();
     if (FsFileType::TYPE_S3 == dentry.type()) {
-      WriteLockGuard lock(warmupInodesDequeMutex_);
-      auto iterDeque = FindWarmupInodesByKeyLocked(key);
-      if (iterDeque == warmupInodesDeque_.end()) {
-        warmupInodesDeque_.emplace_back(key,
-                                        std::set<fuse_ino_t>{dentry.inodeid()});
-      } else {
-        iterDeque->AddFileInode(dentry.inodeid());
-      }
-      VLOG(9) << "FetchChildDentry: " << dentry.inodeid();
+      files.emplace(dentry.inodeid());
     } else if (FsFileType::TYPE_DIRECTORY == dentry.type()) {
       auto task = [this, key, dentry]() {
         FetchChildDentry(key, dentry.inodeid());
@@ -320,12 +328,39 @@ void WarmupManagerS3Impl::FetchChildDentry(fuse_ino_t key, fuse_ino_t ino) {
       VLOG(9) << "unknown type";
     }
   }
+  if (files.empty()) {
+    return;
+  }
+
+  // the attribute is only used for filtering, the file is still warmed up
+  // if its attribute is missing.
+  std::list<InodeAttr> attrs;
+  ret = inodeManager_->BatchGetInodeAttr(&files, &attrs);
+  if (ret != DINGOFS_ERROR::OK) {
+    LOG(WARNING) << "inodeManager BatchGetInodeAttr fail, ret = " << ret
+                 << ", parent = " << ino;
+    attrs.clear();
+  }
+  auto checkpoint = GetCheckpoint(key);
+  for (const auto& attr : attrs) {
+    if (attr.length() == 0 ||
+        (checkpoint != nullptr &&
+         checkpoint->IsFinished(attr.inodeid(), attr.length()))) {
+      VLOG(9) << "FetchChildDentry skip file: " << attr.inodeid();
+      files.erase(attr.inodeid());
+    }
+  }
+  for (const auto& file : files) {
+    VLOG(9) << "FetchChildDentry: " << file;
+    FetchDataEnqueue(key, file);
+  }
   VLOG(9) << "FetchChildDentry end: key:" << key << " inode: " << ino;
 }
 
 void WarmupManagerS3Impl::FetchDataEnqueue(fuse_ino_t key, fuse_ino_t ino) {
   VLOG(9) << "FetchDataEnqueue start: key:" << key << " inode: " << ino;
-  auto task = [key, ino, this]() {
+  uint64_t priority = nextFilePriority_.fetch_add(1, std::memory_order_relaxed);
+  auto task = [key, ino, priority, this]() {
     std::shared_ptr<InodeWrapper> inodeWrapper;
     DINGOFS_ERROR ret = inodeManager_->GetInode(ino, inodeWrapper);
     if (ret != DINGOFS_ERROR::OK) {
@@ -334,40 +369,70 @@ void WarmupManagerS3Impl::FetchDataEnqueue(fuse_ino_t key, fuse_ino_t ino) {
       return;
     }
     S3ChunkInfoMapType s3ChunkInfoMap;
+    uint64_t length;
     {
       ::dingofs::utils::UniqueLock lgGuard = inodeWrapper->GetUniqueLock();
       s3ChunkInfoMap = *inodeWrapper->GetChunkInfoMap();
+      length = inodeWrapper->GetLengthLocked();
     }
     if (s3ChunkInfoMap.empty()) {
       return;
     }
-    TravelChunks(key, ino, s3ChunkInfoMap);
+
+    auto checkpoint = GetCheckpoint(key);
+    if (checkpoint != nullptr && checkpoint->IsFinished(ino, length)) {
+      VLOG(9) << "FetchDataEnqueue skip finished file: " << ino;
+      return;
+    }
+
+    WarmupStorageType type;
+    {
+      ReadLockGuard lock(inode2ProgressMutex_);
+      auto iter = FindWarmupProgressByKeyLocked(key);
+      if (iter == inode2Progress_.end()) {
+        LOG(ERROR) << "no such warmup progress: " << key;
+        return;
+      }
+      type = iter->second.GetStorageType();
+    }
+    auto file =
+        std::make_shared<WarmupFileContext>(key, ino, length, priority, type);
+    TravelChunks(file, s3ChunkInfoMap);
   };
   AddFetchS3objectsTask(key, task);
   VLOG(9) << "FetchDataEnqueue end: key:" << key << " inode: " << ino;
 }
 
 void WarmupManagerS3Impl::TravelChunks(
-    fuse_ino_t key, fuse_ino_t ino, const S3ChunkInfoMapType& s3ChunkInfoMap) {
-  VLOG(9) << "travel chunk start: " << ino
+    const WarmupFileContextPtr& file,
+    const S3ChunkInfoMapType& s3ChunkInfoMap) {
+  VLOG(9) << "travel chunk start: " << file->ino
           << ", size: " << s3ChunkInfoMap.size();
+  ObjectListType prefetchObjs;
   for (auto const& infoIter : s3ChunkInfoMap) {
     VLOG(9) << "travel chunk: " << infoIter.first;
-    std::list<std::pair<BlockKey, uint64_t>> prefetchObjs;
-    TravelChunk(ino, infoIter.second, &prefetchObjs);
-    {
-      ReadLockGuard lock(inode2ProgressMutex_);
-      auto iter = FindWarmupProgressByKeyLocked(key);
-      if (iter != inode2Progress_.end()) {
-        iter->second.AddTotal(prefetchObjs.size());
-      } else {
-        LOG(ERROR) << "no such warmup progress: " << key;
-      }
+    TravelChunk(file->ino, infoIter.second, &prefetchObjs);
+  }
+
+  {
+    ReadLockGuard lock(inode2ProgressMutex_);
+    auto iter = FindWarmupProgressByKeyLocked(file->key);
+    if (iter != inode2Progress_.end()) {
+      iter->second.AddTotal(prefetchObjs.size());
+    } else {
+      LOG(ERROR) << "no such warmup progress: " << file->key;
     }
-    auto task = [this, key, prefetchObjs]() {
-      WarmUpAllObjs(key, prefetchObjs);
-    };
-    AddFetchS3objectsTask(key, task);
+  }
+
+  // blocks in the front of file are scheduled first
+  file->pendingBlocks.store(prefetchObjs.size());
+  for (const auto& obj : prefetchObjs) {
+    WarmupBlockTask task;
+    task.key = file->key;
+    task.priority = file->priority;
+    task.length = obj.second;
+    task.run = [this, file, obj]() { FetchBlock(file, obj.first, obj.second); };
+    scheduler_->Submit(std::move(task));
   }
   VLOG(9) << "travel chunks end";
 }
@@ -455,88 +520,208 @@ void WarmupManagerS3Impl::TravelChunk(
   }
 }
 
-// TODO(hzwuhongsong): These logics are very similar to other place,
-// try to merge it
-void WarmupManagerS3Impl::WarmUpAllObjs(
-    fuse_ino_t ino,
-    const std::list<std::pair<BlockKey, uint64_t>>& prefetchObjs) {
-  std::atomic<uint64_t> pendingReq(0);
-  dingofs::utils::CountDownEvent cond(1);
+void WarmupManagerS3Impl::FetchBlock(const WarmupFileContextPtr& file,
+                                     const BlockKey& key, uint64_t length) {
+  if (bgFetchStop_.load(std::memory_order_acquire)) {
+    VLOG(9) << "need stop warmup";
+    FinishBlock(file, false);
+    return;
+  }
+
+  if (file->storageType == WarmupStorageType::kWarmupStorageTypeDisk &&
+      s3Adaptor_->GetBlockCache()->IsCached(key)) {
+    // storage in disk and has cached
+    ReadLockGuard lock(inode2ProgressMutex_);
+    auto iter = FindWarmupProgressByKeyLocked(file->key);
+    if (iter != inode2Progress_.end()) {
+      iter->second.FinishedPlusOne();
+    }
+    FinishBlock(file, true);
+    return;
+  }
+
   uint64_t start = butil::cpuwide_time_us();
-  // callback function
-  GetObjectAsyncCallBack cb =
-      [&](const aws::S3Adapter* adapter,
-          const std::shared_ptr<GetObjectAsyncContext>& context) {
-        (void)adapter;
-        // metrics for async get data from s3
-        MetricGuard guard(&context->retCode, &S3Metric::GetInstance().read_s3,
-                          context->len, start);
-        if (bgFetchStop_.load(std::memory_order_acquire)) {
-          VLOG(9) << "need stop warmup";
-          cond.Signal();
-          return;
-        }
-        if (context->retCode == 0) {
-          VLOG(9) << "Get Object success: " << context->key;
-          PutObjectToCache(ino, context);
-          CollectMetrics(&warmupS3Metric_.warmupS3Cached, context->len, start);
-          warmupS3Metric_.warmupS3CacheSize << context->len;
-          if (pendingReq.fetch_sub(1, std::memory_order_seq_cst) == 1) {
-            VLOG(6) << "pendingReq is over";
-            cond.Signal();
-          }
-          return;
-        }
-        warmupS3Metric_.warmupS3Cached.eps.count << 1;
-        if (++context->retry >= option_.downloadMaxRetryTimes) {
-          if (pendingReq.fetch_sub(1, std::memory_order_seq_cst) == 1) {
-            VLOG(6) << "pendingReq is over";
-            cond.Signal();
-          }
-          VLOG(9) << "Up to max retry times, "
-                  << "download object failed, key: " << context->key;
-          delete[] context->buf;
-          return;
-        }
+  auto context = std::make_shared<GetObjectAsyncContext>();
+  context->key = key.StoreKey();
+  context->buf = new char[length];
+  context->offset = 0;
+  context->len = length;
+  if (!DownloadObject(context->key, context->buf, length)) {
+    delete[] context->buf;
+    ReadLockGuard lock(inode2ProgressMutex_);
+    auto iter = FindWarmupProgressByKeyLocked(file->key);
+    if (iter != inode2Progress_.end()) {
+      iter->second.ErrorsPlusOne();
+    }
+    FinishBlock(file, false);
+    return;
+  }
 
-        LOG(WARNING) << "Get Object failed, key: " << context->key
-                     << ", offset: " << context->offset;
-        S3ClientImpl::GetInstance()->AsyncGet(context);
-      };
+  bool success = PutObjectToCache(file->key, context);
+  CollectMetrics(&warmupS3Metric_.warmupS3Cached, length, start);
+  warmupS3Metric_.warmupS3CacheSize << length;
+  FinishBlock(file, success);
+}
 
-  pendingReq.fetch_add(prefetchObjs.size(), std::memory_order_seq_cst);
-  if (pendingReq.load(std::memory_order_seq_cst)) {
-    VLOG(9) << "wait for pendingReq";
-    for (auto iter : prefetchObjs) {
-      BlockKey bkey = iter.first;
-      std::string name = bkey.StoreKey();
-      uint64_t readLen = iter.second;
-      VLOG(9) << "download start: " << name;
-      {
-        ReadLockGuard lock(inode2ProgressMutex_);
-        auto iterProgress = FindWarmupProgressByKeyLocked(ino);
-        if (iterProgress->second.GetStorageType() ==
-                dingofs::client::common::WarmupStorageType::
-                    kWarmupStorageTypeDisk &&
-            s3Adaptor_->GetBlockCache()->IsCached(bkey)) {
-          // storage in disk and has cached
-          pendingReq.fetch_sub(1);
-          continue;
-        }
-      }
-      char* cacheS3 = new char[readLen];
-      memset(cacheS3, 0, readLen);
-      auto context = std::make_shared<GetObjectAsyncContext>();
-      context->key = name;
-      context->buf = cacheS3;
-      context->offset = 0;
-      context->len = readLen;
-      context->cb = cb;
-      context->retry = 0;
-      S3ClientImpl::GetInstance()->AsyncGet(context);
+void WarmupManagerS3Impl::FinishBlock(const WarmupFileContextPtr& file,
+                                      bool success) {
+  if (!success) {
+    file->failed.store(true);
+  }
+  if (file->pendingBlocks.fetch_sub(1) != 1 || file->failed.load()) {
+    return;
+  }
+
+  auto checkpoint = GetCheckpoint(file->key);
+  if (checkpoint != nullptr) {
+    checkpoint->MarkFinished(file->ino, file->length);
+  }
+}
+
+bool WarmupManagerS3Impl::DownloadObject(const std::string& name,
+                                         char* buffer, uint64_t length) {
+  uint32_t retry = 0;
+  for (;;) {
+    auto rc = S3ClientImpl::GetInstance()->Range(name, 0, length, buffer);
+    if (rc == BCACHE_ERROR::OK) {
+      VLOG(9) << "Get Object success: " << name;
+      return true;
+    }
+    warmupS3Metric_.warmupS3Cached.eps.count << 1;
+    if (++retry >= option_.downloadMaxRetryTimes) {
+      VLOG(9) << "Up to max retry times, "
+              << "download object failed, key: " << name;
+      return false;
+    }
+    LOG(WARNING) << "Get Object failed, key: " << name << ", retry: " << retry;
+  }
+}
+
+bool WarmupManagerS3Impl::StartReplay(const std::string& profile) {
+  std::vector<AccessRecord> records;
+  if (!filesystem::AccessProfile::Load(profile, &records)) {
+    return false;
+  } else if (records.empty()) {
+    LOG(INFO) << "Access profile (" << profile << ") is empty, skip replay.";
+    return true;
+  }
+
+  // the prefetch of nearer block has higher priority
+  auto prefetch = [this](const AccessRecord& record, uint64_t position) {
+    WarmupBlockTask task;
+    task.key = kReplayWarmupKey;
+    task.priority = position;
+    task.length = s3Adaptor_->GetBlockSize();
+    task.run = [this, record]() { PrefetchBlock(record); };
+    scheduler_->Submit(std::move(task));
+  };
+  replayer_ = std::make_shared<WarmupReplayer>(
+      std::move(records), option_.warmup_option.replay_distance, prefetch);
+
+  auto replayer = replayer_;
+  filesystem::AccessTracer::GetInstance().SetListener(
+      s3Adaptor_->GetBlockSize(),
+      [replayer](const AccessRecord& record) { replayer->OnAccess(record); });
+  LOG(INFO) << "Start replaying access profile (" << profile << ").";
+  return true;
+}
+
+void WarmupManagerS3Impl::PrefetchBlock(const AccessRecord& record) {
+  if (bgFetchStop_.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  std::shared_ptr<InodeWrapper> inodeWrapper;
+  DINGOFS_ERROR ret = inodeManager_->GetInode(record.ino, inodeWrapper);
+  if (ret != DINGOFS_ERROR::OK) {
+    VLOG(3) << "inodeManager get inode fail, ret = " << ret
+            << ", inodeid = " << record.ino;
+    return;
+  }
+
+  uint64_t blocksPerChunk =
+      s3Adaptor_->GetChunkSize() / s3Adaptor_->GetBlockSize();
+  uint64_t chunkIndex = record.index / blocksPerChunk;
+  pb::metaserver::S3ChunkInfoList chunkInfo;
+  {
+    ::dingofs::utils::UniqueLock lgGuard = inodeWrapper->GetUniqueLock();
+    auto* s3ChunkInfoMap = inodeWrapper->GetChunkInfoMap();
+    auto iter = s3ChunkInfoMap->find(chunkIndex);
+    if (iter == s3ChunkInfoMap->end()) {
+      return;
+    }
+    chunkInfo = iter->second;
+  }
+
+  // all the objects (maybe written by different slices) of the block
+  ObjectListType objs;
+  TravelChunk(record.ino, chunkInfo, &objs);
+  auto block_cache = s3Adaptor_->GetBlockCache();
+  for (const auto& obj : objs) {
+    const auto& key = obj.first;
+    if (key.index != record.index % blocksPerChunk ||
+        block_cache->IsCached(key)) {
+      continue;
+    }
+
+    uint64_t start = butil::cpuwide_time_us();
+    std::unique_ptr<char[]> buffer(new char[obj.second]);
+    if (!DownloadObject(key.StoreKey(), buffer.get(), obj.second)) {
+      continue;
     }
-    if (pendingReq.load()) cond.Wait();
+    auto rc = block_cache->Cache(key, Block(buffer.get(), obj.second));
+    if (rc != BCACHE_ERROR::OK) {
+      LOG_EVERY_SECOND(INFO) << "Cache block (" << key.Filename() << ")"
+                             << " failed: " << StrErr(rc);
+      continue;
+    }
+    CollectMetrics(&warmupS3Metric_.warmupS3Cached, obj.second, start);
+    warmupS3Metric_.warmupS3CacheSize << obj.second;
+  }
+}
+
+void WarmupManagerS3Impl::OpenCheckpoint(fuse_ino_t key) {
+  const auto& dir = option_.warmup_option.checkpoint_dir;
+  if (dir.empty()) {
+    return;
+  }
+
+  auto rc = blockcache::NewTempLocalFileSystem()->MkDirs(dir);
+  if (rc != BCACHE_ERROR::OK) {
+    LOG(ERROR) << "Create warmup checkpoint directory (" << dir
+               << ") failed: " << StrErr(rc);
+    return;
   }
+
+  std::string filename = std::to_string(fsInfo_->fsid()) + "_" +
+                         std::to_string(key) + ".checkpoint";
+  auto checkpoint =
+      std::make_shared<WarmupCheckpoint>(PathJoin({dir, filename}));
+  if (!checkpoint->Open()) {
+    return;
+  }
+
+  WriteLockGuard lock(checkpointsMutex_);
+  checkpoints_[key] = checkpoint;
+}
+
+std::shared_ptr<WarmupCheckpoint> WarmupManagerS3Impl::GetCheckpoint(
+    fuse_ino_t key) {
+  ReadLockGuard lock(checkpointsMutex_);
+  auto iter = checkpoints_.find(key);
+  return iter == checkpoints_.end() ? nullptr : iter->second;
+}
+
+void WarmupManagerS3Impl::CloseCheckpoint(fuse_ino_t key, bool success) {
+  WriteLockGuard lock(checkpointsMutex_);
+  auto iter = checkpoints_.find(key);
+  if (iter == checkpoints_.end()) {
+    return;
+  }
+  if (success) {
+    iter->second->Remove();
+  }
+  checkpoints_.erase(iter);
 }
 
 bool WarmupManagerS3Impl::ProgressDone(fuse_ino_t key) {
@@ -552,16 +737,13 @@ bool WarmupManagerS3Impl::ProgressDone(fuse_ino_t key) {
           (FindFetchDentryPoolByKeyLocked(key) == inode2FetchDentryPool_.end());
   }
 
-  {
-    ReadLockGuard lockInodes(warmupInodesDequeMutex_);
-    ret = ret && (FindWarmupInodesByKeyLocked(key) == warmupInodesDeque_.end());
-  }
-
   {
     ReadLockGuard lockS3Objects(inode2FetchS3ObjectsPoolMutex_);
     ret = ret && (FindFetchS3ObjectsPoolByKeyLocked(key) ==
                   inode2FetchS3ObjectsPool_.end());
   }
+
+  ret = ret && scheduler_->PendingTasks(key) == 0;
   return ret;
 }
 
@@ -570,7 +752,6 @@ void WarmupManagerS3Impl::ScanCleanFetchDentryPool() {
   WriteLockGuard lock(inode2FetchDentryPoolMutex_);
   for (auto iter = inode2FetchDentryPool_.begin();
        iter != inode2FetchDentryPool_.end();) {
-    std::deque<WarmupInodes>::iterator iterInode;
     if (iter->second->QueueSize() == 0) {
       VLOG(9) << "remove FetchDentry task: " << iter->first;
       iter->second->Stop();
@@ -598,10 +779,11 @@ void WarmupManagerS3Impl::ScanCleanFetchS3ObjectsPool() {
 
 void WarmupManagerS3Impl::ScanCleanWarmupProgress() {
   // clean done warmupProgress
-  ReadLockGuard lock(inode2ProgressMutex_);
+  WriteLockGuard lock(inode2ProgressMutex_);
   for (auto iter = inode2Progress_.begin(); iter != inode2Progress_.end();) {
     if (ProgressDone(iter->first)) {
       VLOG(9) << "warmup key: " << iter->first << " done!";
+      CloseCheckpoint(iter->first, iter->second.GetErrors() == 0);
       iter = inode2Progress_.erase(iter);
     } else {
       ++iter;
@@ -609,20 +791,6 @@ void WarmupManagerS3Impl::ScanCleanWarmupProgress() {
   }
 }
 
-void WarmupManagerS3Impl::ScanWarmupInodes() {
-  // file need warmup
-  WriteLockGuard lock(warmupInodesDequeMutex_);
-  if (!warmupInodesDeque_.empty()) {
-    WarmupInodes inodes = warmupInodesDeque_.front();
-    for (auto const& iter : inodes.GetReadAheadFiles()) {
-      VLOG(9) << "BackGroundFetch: key: " << inodes.GetKey()
-              << " inode:" << iter;
-      FetchDataEnqueue(inodes.GetKey(), iter);
-    }
-    warmupInodesDeque_.pop_front();
-  }
-}
-
 void WarmupManagerS3Impl::ScanWarmupFilelist() {
   // Use a write lock to ensure that all parsing tasks are added.
   WriteLockGuard lock(warmupFilelistDequeMutex_);
@@ -678,14 +846,16 @@ void WarmupManagerS3Impl::AddFetchS3objectsTask(fuse_ino_t key,
   }
 }
 
-void WarmupManagerS3Impl::PutObjectToCache(
+bool WarmupManagerS3Impl::PutObjectToCache(
     fuse_ino_t ino, const std::shared_ptr<GetObjectAsyncContext>& context) {
   ReadLockGuard lock(inode2ProgressMutex_);
   auto iter = FindWarmupProgressByKeyLocked(ino);
   if (iter == inode2Progress_.end()) {
     VLOG(9) << "no this warmup task progress: " << ino;
-    return;
+    delete[] context->buf;
+    return false;
   }
+  bool success = true;
   // update progress
   iter->second.FinishedPlusOne();
   switch (iter->second.GetStorageType()) {
@@ -700,6 +870,7 @@ void WarmupManagerS3Impl::PutObjectToCache(
       if (rc != BCACHE_ERROR::OK) {
         // cache failed,add error count
         iter->second.ErrorsPlusOne();
+        success = false;
         LOG_EVERY_SECOND(INFO) << "Cache block (" << key.Filename() << ")"
                                << " failed: " << StrErr(rc);
       }
@@ -716,8 +887,11 @@ void WarmupManagerS3Impl::PutObjectToCache(
       }
       break;
     default:
+      delete[] context->buf;
+      success = false;
       LOG_EVERY_N(ERROR, 1000) << "unsupported warmup storage type";
   }
+  return success;
 }
 
 void WarmupManager::CollectMetrics(stub::metric::InterfaceMetric* interface,
@@ -46,6 +46,9 @@
 #include "client/kvclient/kvclient_manager.h"
 #include "client/s3/client_s3_adaptor.h"
 #include "client/s3/client_s3_cache_manager.h"
+#include "client/warmup/warmup_checkpoint.h"
+#include "client/warmup/warmup_replayer.h"
+#include "client/warmup/warmup_scheduler.h"
 #include "common/task_thread_pool.h"
 #include "stub/metric/metric.h"
 #include "stub/rpcclient/metaserver_client.h"
@@ -75,28 +78,12 @@ class WarmupFile {
 
 using WarmupFilelist = WarmupFile;
 
-class WarmupInodes {
- public:
-  explicit WarmupInodes(fuse_ino_t key = 0,
-                        std::set<fuse_ino_t> list = std::set<fuse_ino_t>())
-      : key_(key), readAheadFiles_(std::move(list)) {}
-
-  fuse_ino_t GetKey() const { return key_; }
-  const std::set<fuse_ino_t>& GetReadAheadFiles() const {
-    return readAheadFiles_;
-  }
-
-  void AddFileInode(fuse_ino_t file) { readAheadFiles_.emplace(file); }
-
- private:
-  fuse_ino_t key_;
-  std::set<fuse_ino_t> readAheadFiles_;
-};
-
 using FuseOpReadFunctionType =
     std::function<DINGOFS_ERROR(fuse_req_t, fuse_ino_t, size_t, off_t,
                                 struct fuse_file_info*, char*, size_t*)>;
 
+// The counters are updated by many download workers concurrently,
+// so they are atomic rather than guarded by mutex.
 class WarmupProgress {
  public:
   explicit WarmupProgress(
@@ -105,66 +92,48 @@ class WarmupProgress {
       : total_(0), finished_(0), error_(0), storageType_(type) {}
 
   WarmupProgress(const WarmupProgress& wp)
-      : total_(wp.total_),
-        finished_(wp.finished_),
-        error_(wp.error_),
+      : total_(wp.total_.load(std::memory_order_relaxed)),
+        finished_(wp.finished_.load(std::memory_order_relaxed)),
+        error_(wp.error_.load(std::memory_order_relaxed)),
         storageType_(wp.storageType_) {}
 
   void AddTotal(uint64_t add) {
-    std::lock_guard<std::mutex> lock(totalMutex_);
-    total_ += add;
+    total_.fetch_add(add, std::memory_order_relaxed);
   }
 
   WarmupProgress& operator=(const WarmupProgress& wp) {
-    total_ = wp.total_;
-    finished_ = wp.finished_;
-    error_ = wp.error_;
+    total_.store(wp.total_.load(std::memory_order_relaxed),
+                 std::memory_order_relaxed);
+    finished_.store(wp.finished_.load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+    error_.store(wp.error_.load(std::memory_order_relaxed),
+                 std::memory_order_relaxed);
     return *this;
   }
 
-  void FinishedPlusOne() {
-    std::lock_guard<std::mutex> lock(finishedMutex_);
-    ++finished_;
-  }
+  void FinishedPlusOne() { finished_.fetch_add(1, std::memory_order_relaxed); }
 
-  uint64_t GetTotal() {
-    std::lock_guard<std::mutex> lock(totalMutex_);
-    return total_;
-  }
+  uint64_t GetTotal() { return total_.load(std::memory_order_relaxed); }
 
-  uint64_t GetFinished() {
-    std::lock_guard<std::mutex> lock(finishedMutex_);
-    return finished_;
-  }
+  uint64_t GetFinished() { return finished_.load(std::memory_order_relaxed); }
 
-  void ErrorsPlusOne() {
-    std::lock_guard<std::mutex> lock(errorMutex_);
-    ++error_;
-  }
+  void ErrorsPlusOne() { error_.fetch_add(1, std::memory_order_relaxed); }
+
+  uint64_t GetErrors() { return error_.load(std::memory_order_relaxed); }
 
-  uint64_t GetErrors() {
-    std::lock_guard<std::mutex> lock(errorMutex_);
-    return error_;
-  }
   std::string ToString() {
-    std::lock_guard<std::mutex> lockT(totalMutex_);
-    std::lock_guard<std::mutex> lockF(finishedMutex_);
-    std::lock_guard<std::mutex> lockE(errorMutex_);
-    return "total:" + std::to_string(total_) +
-           ",finished:" + std::to_string(finished_) +
-           ",error:" + std::to_string(error_);
+    return "total:" + std::to_string(GetTotal()) +
+           ",finished:" + std::to_string(GetFinished()) +
+           ",error:" + std::to_string(GetErrors());
   }
 
   common::WarmupStorageType GetStorageType() { return storageType_; }
 
  private:
-  uint64_t total_;
-  std::mutex totalMutex_;
-  uint64_t finished_;
-  std::mutex finishedMutex_;
+  std::atomic<uint64_t> total_;
+  std::atomic<uint64_t> finished_;
+  std::atomic<uint64_t> error_;
   common::WarmupStorageType storageType_;
-  uint64_t error_;  // TODO may be better to use atomic types
-  std::mutex errorMutex_;
 };
 
 class WarmupManager {
@@ -201,6 +170,9 @@ class WarmupManager {
   virtual bool AddWarmupFile(fuse_ino_t key, const std::string& path,
                              common::WarmupStorageType type) = 0;
 
+  // prefetch blocks into cache by replaying the access profile
+  virtual bool StartReplay(const std::string& profile) = 0;
+
   void SetMounted(bool mounted) {
     mounted_.store(mounted, std::memory_order_release);
   }
@@ -314,6 +286,8 @@ class WarmupManagerS3Impl : public WarmupManager {
   bool AddWarmupFile(fuse_ino_t key, const std::string& path,
                      common::WarmupStorageType type) override;
 
+  bool StartReplay(const std::string& profile) override;
+
   void Init(const common::FuseClientOption& option) override;
   void UnInit() override;
 
@@ -331,19 +305,6 @@ class WarmupManagerS3Impl : public WarmupManager {
 
   void FetchChildDentry(fuse_ino_t key, fuse_ino_t ino);
 
-  /**
-   * @brief
-   * Please use it with the lock warmupInodesDequeMutex_
-   * @param key
-   * @return std::deque<WarmupInodes>::iterator
-   */
-  std::deque<WarmupInodes>::iterator FindWarmupInodesByKeyLocked(
-      fuse_ino_t key) {
-    return std::find_if(
-        warmupInodesDeque_.begin(), warmupInodesDeque_.end(),
-        [key](const WarmupInodes& inodes) { return key == inodes.GetKey(); });
-  }
-
   /**
    * @brief
    * Please use it with the lock warmupFilelistDequeMutex_
@@ -383,13 +344,37 @@ class WarmupManagerS3Impl : public WarmupManager {
     return inode2FetchS3ObjectsPool_.find(key);
   }
 
+  // the file which is being warmed up, it's finished after all its blocks
+  // have been downloaded.
+  struct WarmupFileContext {
+    WarmupFileContext(fuse_ino_t key, fuse_ino_t ino, uint64_t length,
+                      uint64_t priority, common::WarmupStorageType type)
+        : key(key),
+          ino(ino),
+          length(length),
+          priority(priority),
+          storageType(type),
+          pendingBlocks(0),
+          failed(false) {}
+
+    fuse_ino_t key;
+    fuse_ino_t ino;
+    uint64_t length;
+    uint64_t priority;
+    common::WarmupStorageType storageType;
+    std::atomic<uint64_t> pendingBlocks;
+    std::atomic<bool> failed;
+  };
+
+  using WarmupFileContextPtr = std::shared_ptr<WarmupFileContext>;
+
   void FetchDataEnqueue(fuse_ino_t key, fuse_ino_t ino);
 
   using S3ChunkInfoMapType =
       google::protobuf::Map<uint64_t, pb::metaserver::S3ChunkInfoList>;
 
-  // travel all chunks
-  void TravelChunks(fuse_ino_t key, fuse_ino_t ino,
+  // travel all chunks and schedule the download of blocks
+  void TravelChunks(const WarmupFileContextPtr& file,
                     const S3ChunkInfoMapType& s3ChunkInfoMap);
 
   using ObjectListType = std::list<std::pair<blockcache::BlockKey, uint64_t>>;
@@ -398,10 +383,24 @@ class WarmupManagerS3Impl : public WarmupManager {
                    const pb::metaserver::S3ChunkInfoList& chunkInfo,
                    ObjectListType* prefetchObjs);
 
-  // warmup all the prefetchObjs
-  void WarmUpAllObjs(
-      fuse_ino_t ino,
-      const std::list<std::pair<blockcache::BlockKey, uint64_t>>& prefetchObjs);
+  // download the block and put it to cache, invoked by scheduler
+  void FetchBlock(const WarmupFileContextPtr& file,
+                  const blockcache::BlockKey& key, uint64_t length);
+
+  void FinishBlock(const WarmupFileContextPtr& file, bool success);
+
+  bool DownloadObject(const std::string& name, char* buffer, uint64_t length);
+
+  // prefetch the block which recorded in access profile into block cache
+  void PrefetchBlock(const AccessRecord& record);
+
+  void OpenCheckpoint(fuse_ino_t key);
+
+  std::shared_ptr<WarmupCheckpoint> GetCheckpoint(fuse_ino_t key);
+
+  // the checkpoint is removed if the warmup task succeeds,
+  // otherwise it's kept for resuming.
+  void CloseCheckpoint(fuse_ino_t key, bool success);
 
   /**
    * @brief Whether the warmup task[key] is completed (or terminated)
@@ -417,15 +416,13 @@ class WarmupManagerS3Impl : public WarmupManager {
 
   void ScanCleanWarmupProgress();
 
-  void ScanWarmupInodes();
-
   void ScanWarmupFilelist();
 
   void AddFetchDentryTask(fuse_ino_t key, std::function<void()> task);
 
   void AddFetchS3objectsTask(fuse_ino_t key, std::function<void()> task);
 
-  void PutObjectToCache(
+  bool PutObjectToCache(
       fuse_ino_t ino,
       const std::shared_ptr<aws::GetObjectAsyncContext>& context);
 
@@ -442,9 +439,6 @@ class WarmupManagerS3Impl : public WarmupManager {
       inode2FetchDentryPool_;
   mutable utils::RWLock inode2FetchDentryPoolMutex_;
 
-  std::deque<WarmupInodes> warmupInodesDeque_;
-  mutable utils::RWLock warmupInodesDequeMutex_;
-
   // s3 adaptor
   std::shared_ptr<S3ClientAdaptor> s3Adaptor_;
 
@@ -453,6 +447,19 @@ class WarmupManagerS3Impl : public WarmupManager {
       inode2FetchS3ObjectsPool_;
   mutable utils::RWLock inode2FetchS3ObjectsPoolMutex_;
 
+  // block downloads of all warmup tasks
+  std::unique_ptr<WarmupScheduler> scheduler_;
+
+  std::shared_ptr<WarmupReplayer> replayer_;
+
+  // files are downloaded in discovery order, so every file is finished
+  // (and checkpointed) as early as possible
+  std::atomic<uint64_t> nextFilePriority_{0};
+
+  std::unordered_map<fuse_ino_t, std::shared_ptr<WarmupCheckpoint>>
+      checkpoints_;
+  mutable utils::RWLock checkpointsMutex_;
+
   dingofs::stub::metric::WarmupManagerS3Metric warmupS3Metric_;
 };
 
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/warmup/warmup_replayer.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace dingofs {
+namespace client {
+namespace warmup {
+
+WarmupReplayer::WarmupReplayer(std::vector<AccessRecord> profile,
+                               uint64_t distance, PrefetchFunc prefetch)
+    : profile_(std::move(profile)),
+      distance_(distance),
+      prefetch_(std::move(prefetch)),
+      cursor_(0) {
+  positions_.reserve(profile_.size());
+  for (uint64_t i = 0; i < profile_.size(); i++) {
+    positions_.emplace(profile_[i], i);  // keep the first position
+  }
+}
+
+void WarmupReplayer::OnAccess(const AccessRecord& record) {
+  auto iter = positions_.find(record);
+  if (iter == positions_.end()) {
+    return;
+  }
+
+  uint64_t position = iter->second;
+  uint64_t begin, end;
+  {
+    std::unique_lock<std::mutex> lk(mutex_);
+    if (position + 1 > cursor_ ||  // reader is ahead of us
+        cursor_ - position > 2 * distance_ + 1) {  // reader jumps back
+      cursor_ = position + 1;
+    }
+    begin = cursor_;
+    end = std::min(position + 1 + distance_, profile_.size());
+    if (begin >= end) {
+      return;
+    }
+    cursor_ = end;
+  }
+
+  for (auto i = begin; i < end; i++) {
+    prefetch_(profile_[i], i);
+  }
+}
+
+uint64_t WarmupReplayer::Cursor() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  return cursor_;
+}
+
+}  // namespace warmup
+}  // namespace client
+}  // namespace dingofs
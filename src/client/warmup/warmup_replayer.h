@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_CLIENT_WARMUP_WARMUP_REPLAYER_H_
+#define DINGOFS_SRC_CLIENT_WARMUP_WARMUP_REPLAYER_H_
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "client/filesystem/access_trace.h"
+
+namespace dingofs {
+namespace client {
+namespace warmup {
+
+using ::dingofs::client::filesystem::AccessRecord;
+using ::dingofs::client::filesystem::AccessRecordHash;
+
+// Replays the recorded access profile ahead of the reader: when the reader
+// accesses the N-th block of profile, the blocks up to N+distance are
+// prefetched in profile order. A reader jumps far behind (e.g. next epoch)
+// restarts the replay from there.
+class WarmupReplayer {
+ public:
+  // position is the index of record in the profile
+  using PrefetchFunc =
+      std::function<void(const AccessRecord& record, uint64_t position)>;
+
+  WarmupReplayer(std::vector<AccessRecord> profile, uint64_t distance,
+                 PrefetchFunc prefetch);
+
+  void OnAccess(const AccessRecord& record);
+
+  // the next position of profile to prefetch
+  uint64_t Cursor();
+
+ private:
+  std::vector<AccessRecord> profile_;
+  std::unordered_map<AccessRecord, uint64_t, AccessRecordHash> positions_;
+  uint64_t distance_;
+  PrefetchFunc prefetch_;
+  std::mutex mutex_;
+  uint64_t cursor_;
+};
+
+}  // namespace warmup
+}  // namespace client
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_CLIENT_WARMUP_WARMUP_REPLAYER_H_
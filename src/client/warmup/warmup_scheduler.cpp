@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/warmup/warmup_scheduler.h"
+
+#include <glog/logging.h>
+
+#include <utility>
+
+namespace dingofs {
+namespace client {
+namespace warmup {
+
+using ::dingofs::utils::ReadWriteThrottleParams;
+using ::dingofs::utils::ThrottleParams;
+
+WarmupScheduler::WarmupScheduler()
+    : running_(false), next_seq_(0), pending_(0) {}
+
+bool WarmupScheduler::Start(const WarmupOption& option) {
+  if (running_.exchange(true)) {
+    return true;
+  }
+
+  ReadWriteThrottleParams params;
+  params.iopsTotal = ThrottleParams(option.iops, 0, 0);
+  params.bpsTotal = ThrottleParams(option.bandwidth_bytes, 0, 0);
+  throttle_.UpdateThrottleParams(params);
+
+  for (uint32_t i = 0; i < option.download_workers; i++) {
+    workers_.emplace_back(&WarmupScheduler::WorkerLoop, this);
+  }
+  LOG(INFO) << "Warmup scheduler started, workers = "
+            << option.download_workers
+            << ", bandwidth = " << option.bandwidth_bytes
+            << ", iops = " << option.iops;
+  return true;
+}
+
+void WarmupScheduler::Stop() {
+  if (!running_.exchange(false)) {
+    return;
+  }
+
+  cond_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+
+  // drop the blocks which are not scheduled yet
+  std::unique_lock<std::mutex> lk(mutex_);
+  queue_ = decltype(queue_)();
+  key_pending_.clear();
+  pending_ = 0;
+}
+
+void WarmupScheduler::Submit(WarmupBlockTask task) {
+  {
+    std::unique_lock<std::mutex> lk(mutex_);
+    key_pending_[task.key]++;
+    pending_++;
+    queue_.push(QueueItem{next_seq_++, std::move(task)});
+  }
+  cond_.notify_one();
+}
+
+uint64_t WarmupScheduler::PendingTasks(uint64_t key) {
+  std::unique_lock<std::mutex> lk(mutex_);
+  auto iter = key_pending_.find(key);
+  return iter == key_pending_.end() ? 0 : iter->second;
+}
+
+uint64_t WarmupScheduler::PendingTasks() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  return pending_;
+}
+
+void WarmupScheduler::WorkerLoop() {
+  for (;;) {
+    WarmupBlockTask task;
+    {
+      std::unique_lock<std::mutex> lk(mutex_);
+      cond_.wait(lk, [&]() { return !running_.load() || !queue_.empty(); });
+      if (!running_.load()) {
+        return;
+      }
+      task = queue_.top().task;
+      queue_.pop();
+    }
+
+    throttle_.Add(true, task.length);  // wait for budget
+    task.run();
+    TaskDone(task.key);
+  }
+}
+
+void WarmupScheduler::TaskDone(uint64_t key) {
+  std::unique_lock<std::mutex> lk(mutex_);
+  auto iter = key_pending_.find(key);
+  CHECK(iter != key_pending_.end());
+  if (--iter->second == 0) {
+    key_pending_.erase(iter);
+  }
+  pending_--;
+}
+
+}  // namespace warmup
+}  // namespace client
+}  // namespace dingofs
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_CLIENT_WARMUP_WARMUP_SCHEDULER_H_
+#define DINGOFS_SRC_CLIENT_WARMUP_WARMUP_SCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "client/common/config.h"
+#include "utils/throttle.h"
+
+namespace dingofs {
+namespace client {
+namespace warmup {
+
+using ::dingofs::client::common::WarmupOption;
+
+// The download of one block:
+//   key: the warmup task which the block belongs to
+//   priority: the smaller one is scheduled first
+struct WarmupBlockTask {
+  uint64_t key;
+  uint64_t priority;
+  uint64_t length;
+  std::function<void()> run;
+};
+
+// Schedules the block downloads of all warmup tasks with a fixed number of
+// workers, the downloads are limited by a global bandwidth/IOPS budget.
+class WarmupScheduler {
+  struct QueueItem {
+    uint64_t seq;
+    WarmupBlockTask task;
+  };
+
+  struct Compare {
+    bool operator()(const QueueItem& lhs, const QueueItem& rhs) const {
+      if (lhs.task.priority != rhs.task.priority) {
+        return lhs.task.priority > rhs.task.priority;
+      }
+      return lhs.seq > rhs.seq;
+    }
+  };
+
+ public:
+  WarmupScheduler();
+
+  virtual ~WarmupScheduler() = default;
+
+  bool Start(const WarmupOption& option);
+
+  void Stop();
+
+  void Submit(WarmupBlockTask task);
+
+  // the number of blocks which are queued or downloading
+  uint64_t PendingTasks(uint64_t key);
+
+  uint64_t PendingTasks();
+
+ private:
+  void WorkerLoop();
+
+  void TaskDone(uint64_t key);
+
+ private:
+  std::atomic<bool> running_;
+  uint64_t next_seq_;
+  uint64_t pending_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::priority_queue<QueueItem, std::vector<QueueItem>, Compare> queue_;
+  std::unordered_map<uint64_t, uint64_t> key_pending_;
+  std::vector<std::thread> workers_;
+  utils::Throttle throttle_;
+};
+
+}  // namespace warmup
+}  // namespace client
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_CLIENT_WARMUP_WARMUP_SCHEDULER_H_
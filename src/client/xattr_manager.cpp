@@ -427,7 +427,19 @@ DINGOFS_ERROR XattrManager::FastCalAllLayerSumInfo(InodeAttr* attr) {
 
 DINGOFS_ERROR XattrManager::GetXattr(const char* name, std::string* value,
                                      InodeAttr* attr, bool enableSumInDir) {
+  const std::string* found = nullptr;
+  DINGOFS_ERROR ret = GetXattr(name, &found, attr, enableSumInDir);
+  if (found != nullptr) {
+    *value = *found;
+  }
+  return ret;
+}
+
+DINGOFS_ERROR XattrManager::GetXattr(const char* name,
+                                     const std::string** value,
+                                     InodeAttr* attr, bool enableSumInDir) {
   DINGOFS_ERROR ret = DINGOFS_ERROR::OK;
+  *value = nullptr;
   // get summary info if the xattr name is summary type
   if (IsSummaryInfo(name) && attr->type() == FsFileType::TYPE_DIRECTORY) {
     // if not enable record summary info in dir xattr,
@@ -455,7 +467,7 @@ DINGOFS_ERROR XattrManager::GetXattr(const char* name, std::string* value,
 
   auto it = attr->xattr().find(name);
   if (it != attr->xattr().end()) {
-    *value = it->second;
+    *value = &it->second;
   }
   return ret;
 }
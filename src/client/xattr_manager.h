@@ -66,6 +66,11 @@ class XattrManager {
   DINGOFS_ERROR GetXattr(const char* name, std::string* value,
                          pb::metaserver::InodeAttr* attr, bool enableSumInDir);
 
+  // same as above, but `*value` points to the value in `attr` without
+  // copying, or nullptr if not found
+  DINGOFS_ERROR GetXattr(const char* name, const std::string** value,
+                         pb::metaserver::InodeAttr* attr, bool enableSumInDir);
+
   DINGOFS_ERROR UpdateParentInodeXattr(uint64_t parentId,
                                        const pb::metaserver::XAttr& xattr,
                                        bool direction);
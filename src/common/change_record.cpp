@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/change_record.h"
+
+#include <butil/sys_byteorder.h>
+
+#include <cstring>
+
+namespace dingofs {
+namespace common {
+
+namespace {
+
+template <typename T>
+void Put(char** p, T value) {
+  std::memcpy(*p, &value, sizeof(T));
+  *p += sizeof(T);
+}
+
+template <typename T>
+T Get(const char** p) {
+  T value;
+  std::memcpy(&value, *p, sizeof(T));
+  *p += sizeof(T);
+  return value;
+}
+
+}  // namespace
+
+std::ostream& operator<<(std::ostream& os, ChangeType type) {
+  switch (type) {
+    case ChangeType::kInode:
+      return os << "INODE";
+    case ChangeType::kDentry:
+      return os << "DENTRY";
+    case ChangeType::kDelete:
+      return os << "DELETE";
+    case ChangeType::kReset:
+      return os << "RESET";
+    default:
+      return os << "UNKNOWN";
+  }
+}
+
+void EncodeChangeRecords(const std::vector<ChangeRecord>& records,
+                         butil::IOBuf* buffer) {
+  char data[kChangeRecordSize];
+  for (const auto& record : records) {
+    char* p = data;
+    std::memset(data, 0, sizeof(data));
+    Put(&p, butil::HostToNet64(record.index));
+    Put(&p, butil::HostToNet64(record.inodeId));
+    Put(&p, butil::HostToNet32(record.fsId));
+    Put(&p, butil::HostToNet32(record.partitionId));
+    Put(&p, static_cast<uint8_t>(record.type));
+    buffer->append(data, sizeof(data));
+  }
+}
+
+bool DecodeChangeRecords(const butil::IOBuf& buffer,
+                         std::vector<ChangeRecord>* records) {
+  if (buffer.size() % kChangeRecordSize != 0) {
+    return false;
+  }
+
+  char data[kChangeRecordSize];
+  for (size_t offset = 0; offset < buffer.size();
+       offset += kChangeRecordSize) {
+    buffer.copy_to(data, kChangeRecordSize, offset);
+    const char* p = data;
+    ChangeRecord record;
+    record.index = butil::NetToHost64(Get<uint64_t>(&p));
+    record.inodeId = butil::NetToHost64(Get<uint64_t>(&p));
+    record.fsId = butil::NetToHost32(Get<uint32_t>(&p));
+    record.partitionId = butil::NetToHost32(Get<uint32_t>(&p));
+    uint8_t type = Get<uint8_t>(&p);
+    if (type > static_cast<uint8_t>(ChangeType::kReset)) {
+      return false;
+    }
+    record.type = static_cast<ChangeType>(type);
+    records->push_back(record);
+  }
+  return true;
+}
+
+}  // namespace common
+}  // namespace dingofs
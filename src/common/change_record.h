@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_COMMON_CHANGE_RECORD_H_
+#define DINGOFS_SRC_COMMON_CHANGE_RECORD_H_
+
+#include <butil/iobuf.h>
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace dingofs {
+namespace common {
+
+enum class ChangeType : uint8_t {
+  kInode = 0,   // the attributes or data of inode changed
+  kDentry = 1,  // the dentries under the directory changed
+  kDelete = 2,  // the inode deleted
+  kReset = 3,   // some records of partition are lost, drop all its caches
+};
+
+std::ostream& operator<<(std::ostream& os, ChangeType type);
+
+// A change applied to partition, which is sent to the subscribers of
+// partition by stream. |inodeId| is the parent for kDentry, and not used
+// for kReset.
+struct ChangeRecord {
+  uint64_t index;  // applied index of raft log
+  uint32_t fsId;
+  uint32_t partitionId;
+  uint64_t inodeId;
+  ChangeType type;
+
+  bool operator==(const ChangeRecord& other) const {
+    return index == other.index && fsId == other.fsId &&
+           partitionId == other.partitionId && inodeId == other.inodeId &&
+           type == other.type;
+  }
+};
+
+// Every record is encoded into fixed 32 bytes:
+//   index(8) | inodeId(8) | fsId(4) | partitionId(4) | type(1) | reserved(7)
+constexpr size_t kChangeRecordSize = 32;
+
+void EncodeChangeRecords(const std::vector<ChangeRecord>& records,
+                         butil::IOBuf* buffer);
+
+// return false if the buffer is not a list of encoded records
+bool DecodeChangeRecords(const butil::IOBuf& buffer,
+                         std::vector<ChangeRecord>* records);
+
+}  // namespace common
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_COMMON_CHANGE_RECORD_H_
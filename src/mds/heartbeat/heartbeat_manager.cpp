@@ -44,7 +44,7 @@ using mds::topology::UNINITIALIZE_ID;
 HeartbeatManager::HeartbeatManager(
     const HeartbeatOption& option, const std::shared_ptr<Topology>& topology,
     const std::shared_ptr<Coordinator>& coordinator)
-    : topology_(topology) {
+    : topology_(topology), coordinator_(coordinator) {
   healthyChecker_ =
       std::make_shared<MetaserverHealthyChecker>(option, topology);
 
@@ -125,8 +125,16 @@ void HeartbeatManager::MetaServerHeartbeat(
 
   UpdateMetaServerSpace(request);
 
+  if (!CheckFullReported(request)) {
+    response->set_statuscode(
+        pb::mds::heartbeat::HeartbeatStatusCode::hbAnalyseCopysetError);
+    return;
+  }
+
   // dealing with copysets included in the heartbeat request
+  std::set<CopySetKey> reported;
   for (const auto& value : request.copysetinfos()) {
+    reported.emplace(value.poolid(), value.copysetid());
     // convert copysetInfo from heartbeat format to topology format
     mds::topology::CopySetInfo report_copy_set_info;
     if (!TransformHeartbeatCopySetInfoToTopologyOne(value,
@@ -165,6 +173,54 @@ void HeartbeatManager::MetaServerHeartbeat(
       }
     }
   }
+
+  // copysetcount is always the number of all copysets on the metaserver,
+  // the copysets which are not included are unchanged since the last
+  // heartbeat acknowledged
+  if (request.copysetinfos_size() < request.copysetcount()) {
+    DispatchPendingOperators(request.metaserverid(), reported, response);
+  }
+}
+
+bool HeartbeatManager::CheckFullReported(
+    const MetaServerHeartbeatRequest& request) {
+  std::lock_guard<std::mutex> lk(fullReportedMutex_);
+  if (request.copysetinfos_size() >= request.copysetcount()) {
+    fullReported_.insert(request.metaserverid());
+    return true;
+  } else if (fullReported_.count(request.metaserverid()) != 0) {
+    return true;
+  }
+
+  LOG(INFO) << "metaserver " << request.metaserverid()
+            << " sends delta heartbeat before full one, reject it";
+  return false;
+}
+
+void HeartbeatManager::DispatchPendingOperators(
+    MetaServerIdType ms_id, const std::set<CopySetKey>& reported,
+    MetaServerHeartbeatResponse* response) {
+  for (const auto& key : coordinator_->GetPendingCopySets()) {
+    if (reported.count(key) != 0) {
+      continue;
+    }
+
+    // the record is what the leader reported last time, copysets under
+    // configuration change are always reported by the metaserver
+    mds::topology::CopySetInfo record;
+    if (!topology_->GetCopySet(key, &record) || record.GetLeader() != ms_id ||
+        record.HasCandidate()) {
+      continue;
+    }
+
+    pb::mds::heartbeat::CopySetConf conf;
+    if (copysetConfGenerator_->GenCopysetConf(ms_id, record,
+                                              ConfigChangeInfo(), &conf)) {
+      VLOG(3) << "dispatch operator on unreported copyset(" << key.first
+              << "," << key.second << ") to metaserver " << ms_id;
+      *response->add_needupdatecopysets() = conf;
+    }
+  }
 }
 
 pb::mds::heartbeat::HeartbeatStatusCode HeartbeatManager::CheckRequest(
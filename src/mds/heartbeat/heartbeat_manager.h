@@ -24,7 +24,10 @@
 #define DINGOFS_SRC_MDS_HEARTBEAT_HEARTBEAT_MANAGER_H_
 
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <unordered_set>
 
 #include "dingofs/heartbeat.pb.h"
 #include "mds/common/mds_define.h"
@@ -42,6 +45,7 @@ namespace heartbeat {
 
 using mds::schedule::Coordinator;
 using mds::topology::CopySetIdType;
+using mds::topology::CopySetKey;
 using mds::topology::PoolIdType;
 using mds::topology::Topology;
 
@@ -140,6 +144,30 @@ class HeartbeatManager {
 
   void UpdateMetaServerSpace(const MetaServerHeartbeatRequest& request);
 
+  /**
+   * @brief The metaserver in delta mode only reports the changed copysets,
+   *        so the operators on the unchanged copysets it leads are
+   *        generated from the topology record
+   *
+   * @param[in] msId Metaserver which sends the heartbeat
+   * @param[in] reported Copysets included in the heartbeat request
+   * @param[out] response Response of heartbeat request
+   */
+  void DispatchPendingOperators(MetaServerIdType ms_id,
+                                const std::set<CopySetKey>& reported,
+                                MetaServerHeartbeatResponse* response);
+
+  /**
+   * @brief A delta report is only based on the copysets acknowledged by the
+   *        previous mds, the mds which is restarted or newly elected asks
+   *        the metaserver for a full report by rejecting the delta one
+   *
+   * @param[in] request Heartbeat request reported by metaserver
+   *
+   * @return false if it's a delta report before any full one
+   */
+  bool CheckFullReported(const MetaServerHeartbeatRequest& request);
+
   // Dependencies of heartbeat
   std::shared_ptr<Topology> topology_;
   std::shared_ptr<Coordinator> coordinator_;
@@ -152,6 +180,10 @@ class HeartbeatManager {
 
   std::shared_ptr<CopysetConfGenerator> copysetConfGenerator_;
 
+  // metaservers which sent a full report to this mds
+  std::mutex fullReportedMutex_;
+  std::unordered_set<MetaServerIdType> fullReported_;
+
   // Manage metaserverHealthyChecker threads
   Thread backEndThread_;
 
@@ -26,6 +26,7 @@
 #include <brpc/server.h>
 #include <glog/logging.h>
 
+#include <string>
 #include <utility>
 
 #include "mds/heartbeat/heartbeat_service.h"
@@ -55,6 +56,7 @@ using mds::schedule::ScheduleOption;
 using mds::schedule::TopoAdapterImpl;
 using mds::topology::DefaultIdGenerator;
 using mds::topology::DefaultTokenGenerator;
+using mds::topology::PartitionSplitter;
 using mds::topology::TopologyImpl;
 using mds::topology::TopologyManager;
 using mds::topology::TopologyMetricService;
@@ -64,6 +66,17 @@ using mds::topology::TopologyStorageEtcd;
 using topology::TopologyOption;
 using utils::Configuration;
 
+// The option which is added later uses its default value if the key is not
+// found, so the conf of older version still works.
+template <typename T>
+static void GetValueOrDefault(Configuration* conf, const std::string& key,
+                              T* value) {
+  if (!conf->GetValue(key, value)) {
+    LOG(WARNING) << "Not found `" << key << "` in conf, use default value `"
+                 << std::boolalpha << *value << '`';
+  }
+}
+
 MDS::MDS()
     : conf_(),
       inited_(false),
@@ -116,6 +129,16 @@ void MDS::InitTopologyOption(TopologyOption* topology_option) {
                              &topology_option->maxCopysetNumInMetaserver);
   conf_->GetValueFatalIfFail("mds.topology.UpdateMetricIntervalSec",
                              &topology_option->UpdateMetricIntervalSec);
+  GetValueOrDefault(conf_.get(), "mds.topology.EnablePartitionSplit",
+                    &topology_option->enablePartitionSplit);
+  GetValueOrDefault(conf_.get(), "mds.topology.PartitionSplitIntervalSec",
+                    &topology_option->partitionSplitIntervalSec);
+  GetValueOrDefault(conf_.get(), "mds.topology.PartitionSplitRowNum",
+                    &topology_option->partitionSplitRowNum);
+  GetValueOrDefault(conf_.get(), "mds.topology.PartitionSplitOpsPerSec",
+                    &topology_option->partitionSplitOpsPerSec);
+  GetValueOrDefault(conf_.get(), "mds.topology.PartitionSplitMinFreeIds",
+                    &topology_option->partitionSplitMinFreeIds);
 }
 
 void MDS::InitScheduleOption(ScheduleOption* schedule_option) {
@@ -147,6 +170,17 @@ void MDS::InitScheduleOption(ScheduleOption* schedule_option) {
                              &schedule_option->changePeerTimeLimitSec);
   conf_->GetValueFatalIfFail("mds.scheduler.metaserver.cooling.timeSec",
                              &schedule_option->metaserverCoolingTimeSec);
+
+  GetValueOrDefault(conf_.get(), "mds.enable.load.scheduler",
+                    &schedule_option->enableLoadScheduler);
+  GetValueOrDefault(conf_.get(), "mds.load.scheduler.intervalSec",
+                    &schedule_option->loadSchedulerIntervalSec);
+  GetValueOrDefault(conf_.get(), "mds.load.scheduler.balanceRatioPercent",
+                    &schedule_option->loadBalanceRatioPercent);
+  GetValueOrDefault(conf_.get(), "mds.load.scheduler.coolingTimeSec",
+                    &schedule_option->loadCoolingTimeSec);
+  GetValueOrDefault(conf_.get(), "mds.load.scheduler.minOpsPerSec",
+                    &schedule_option->loadMinOpsPerSec);
 }
 
 void MDS::InitDLockOptions(DLockOptions* d_lock_options) {
@@ -192,6 +226,7 @@ void MDS::Init() {
   InitTopology(options_.topologyOptions);
   InitTopologyMetricService(options_.topologyOptions);
   InitTopologyManager(options_.topologyOptions);
+  InitPartitionSplitter(options_.topologyOptions);
   InitCoordinator();
   InitHeartbeatManager();
   FsManagerOption fs_manager_option;
@@ -238,6 +273,13 @@ void MDS::InitTopologyMetricService(const TopologyOption& option) {
   LOG(INFO) << "init topologyMetricService success.";
 }
 
+void MDS::InitPartitionSplitter(const TopologyOption& option) {
+  partitionSplitter_ =
+      std::make_shared<PartitionSplitter>(topology_, topologyManager_);
+  partitionSplitter_->Init(option);
+  LOG(INFO) << "init partitionSplitter success.";
+}
+
 void MDS::InitCoordinator() {
   auto schedule_metrics = std::make_shared<ScheduleMetrics>(topology_);
   auto topo_adapter =
@@ -258,6 +300,7 @@ void MDS::Run() {
 
   LOG_IF(FATAL, topology_->Run()) << "run topology module fail";
   topologyMetricService_->Run();
+  partitionSplitter_->Run();
   coordinator_->Run();
   heartbeatManager_->Run();
   fsManager_->Run();
@@ -301,6 +344,7 @@ void MDS::Stop() {
   heartbeatManager_->Stop();
   coordinator_->Stop();
   topologyMetricService_->Stop();
+  partitionSplitter_->Stop();
   fsManager_->Uninit();
   topology_->Stop();
 }
@@ -37,6 +37,7 @@
 #include "mds/heartbeat/metaserver_healthy_checker.h"
 #include "mds/leader_election/leader_election.h"
 #include "mds/schedule/schedule_define.h"
+#include "mds/topology/partition_splitter.h"
 #include "mds/topology/topology.h"
 #include "mds/topology/topology_config.h"
 #include "mds/topology/topology_metric.h"
@@ -101,6 +102,8 @@ class MDS {
 
   void InitTopologyMetricService(const topology::TopologyOption& option);
 
+  void InitPartitionSplitter(const topology::TopologyOption& option);
+
   void InitHeartbeatManager();
 
   void InitCoordinator();
@@ -122,6 +125,7 @@ class MDS {
   std::shared_ptr<heartbeat::Coordinator> coordinator_;
   std::shared_ptr<heartbeat::HeartbeatManager> heartbeatManager_;
   std::shared_ptr<topology::TopologyMetricService> topologyMetricService_;
+  std::shared_ptr<topology::PartitionSplitter> partitionSplitter_;
   std::shared_ptr<aws::S3Adapter> s3Adapter_;
   MDSOptions options_;
 
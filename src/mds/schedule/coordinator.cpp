@@ -22,6 +22,7 @@
 
 #include "mds/schedule/coordinator.h"
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include <memory>
@@ -47,6 +48,10 @@ DEFINE_bool(enableCopySetScheduler, true, "switch of copyset scheduler");
 DEFINE_validator(enableCopySetScheduler, &PassBool);
 DEFINE_bool(enableLeaderScheduler, true, "switch of leader scheduler");
 DEFINE_validator(enableLeaderScheduler, &PassBool);
+// off by default as mds.enable.load.scheduler, it's turned on with the
+// load scheduler created
+DEFINE_bool(enableLoadScheduler, false, "switch of load scheduler");
+DEFINE_validator(enableLoadScheduler, &PassBool);
 
 Coordinator::Coordinator(const std::shared_ptr<TopoAdapter>& topo) {
   this->topo_ = topo;
@@ -78,6 +83,15 @@ void Coordinator::InitScheduler(const ScheduleOption& conf,
         std::make_shared<LeaderScheduler>(conf, topo_, opController_);
     LOG(INFO) << "init leader scheduler ok!";
   }
+
+  if (conf.enableLoadScheduler) {
+    schedulerController_[SchedulerType::LoadSchedulerType] =
+        std::make_shared<LoadScheduler>(conf, topo_, opController_);
+    // the value set explicitly (e.g. by curl) is kept
+    gflags::SetCommandLineOptionWithMode("enableLoadScheduler", "true",
+                                         gflags::SET_FLAGS_DEFAULT);
+    LOG(INFO) << "init load scheduler ok!";
+  }
 }
 
 void Coordinator::Run() {
@@ -299,6 +313,8 @@ bool Coordinator::ScheduleNeedRun(SchedulerType type) {
       return FLAGS_enableCopySetScheduler;
     case SchedulerType::LeaderSchedulerType:
       return FLAGS_enableLeaderScheduler;
+    case SchedulerType::LoadSchedulerType:
+      return FLAGS_enableLoadScheduler;
     default:
       return false;
   }
@@ -312,11 +328,25 @@ std::string Coordinator::ScheduleName(SchedulerType type) {
       return "CopySetScheduler";
     case SchedulerType::LeaderSchedulerType:
       return "LeaderScheduler";
+    case SchedulerType::LoadSchedulerType:
+      return "LoadScheduler";
     default:
       return "Unknown";
   }
 }
 
+std::vector<CopySetKey> Coordinator::GetPendingCopySets() {
+  std::vector<CopySetKey> keys;
+  if (opController_ == nullptr) {
+    return keys;
+  }
+
+  for (const auto& op : opController_->GetOperators()) {
+    keys.emplace_back(op.copysetID);
+  }
+  return keys;
+}
+
 std::shared_ptr<OperatorController> Coordinator::GetOpController() {
   return opController_;
 }
@@ -77,6 +77,12 @@ class Coordinator {
    */
   virtual bool MetaserverGoingToAdd(MetaServerIdType ms_id, CopySetKey key);
 
+  /**
+   * @brief Get the copysets which have operator to be dispatched, the
+   *        heartbeat in delta mode may not report them
+   */
+  virtual std::vector<CopySetKey> GetPendingCopySets();
+
   /**
    * @brief Initialize the scheduler according to the configuration
    *
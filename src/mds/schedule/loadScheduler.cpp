@@ -0,0 +1,396 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+#include "mds/schedule/operatorFactory.h"
+#include "mds/schedule/scheduler.h"
+#include "utils/timeutility.h"
+
+namespace dingofs {
+namespace mds {
+namespace schedule {
+
+using ::dingofs::utils::TimeUtility;
+using ::std::chrono::steady_clock;
+
+namespace {
+
+// a follower handles no request from client, it only applies the log
+constexpr double kFollowerLoadFactor = 0.5;
+
+uint64_t Diff(uint64_t lhs, uint64_t rhs) {
+  return lhs > rhs ? lhs - rhs : rhs - lhs;
+}
+
+}  // namespace
+
+int LoadScheduler::Schedule() {
+  LOG(INFO) << "LoadScheduler begin";
+
+  int oneRoundGenOp = 0;
+  for (auto poolId : topo_->Getpools()) {
+    oneRoundGenOp += LoadSchedulerForPool(poolId);
+  }
+
+  LOG(INFO) << "LoadScheduler generate " << oneRoundGenOp
+            << " operators at this round";
+  return oneRoundGenOp;
+}
+
+int64_t LoadScheduler::GetRunningInterval() const { return runInterval_; }
+
+double LoadScheduler::GetCopySetLoad(const CopySetKey& key) {
+  auto iter = samples_.find(key);
+  return iter == samples_.end() ? 0 : iter->second.opsPerSec;
+}
+
+// The partition statistics are updated by the heartbeat of leader, every
+// create, unlink, link and rename changes at least one of them.
+void LoadScheduler::UpdateCopySetLoad(PoolIdType poolId) {
+  uint64_t nowMs = TimeUtility::GetTimeofDayMs();
+  auto statistics = topo_->GetCopySetStatisticsInPool(poolId);
+
+  for (auto iter = samples_.begin(); iter != samples_.end();) {
+    if (iter->first.first == poolId &&
+        statistics.find(iter->first.second) == statistics.end()) {
+      iter = samples_.erase(iter);
+    } else {
+      iter++;
+    }
+  }
+
+  for (const auto& item : statistics) {
+    CopySetKey key(poolId, item.first);
+    const CopySetStatistic& statistic = item.second;
+    auto iter = samples_.find(key);
+    if (iter == samples_.end()) {
+      samples_.emplace(key, LoadSample{statistic, nowMs, 0});
+      continue;
+    }
+
+    auto& sample = iter->second;
+    uint64_t ops = Diff(statistic.inodeNum, sample.statistic.inodeNum) +
+                   Diff(statistic.dentryNum, sample.statistic.dentryNum) +
+                   Diff(statistic.allocatedIds, sample.statistic.allocatedIds) +
+                   Diff(statistic.txId, sample.statistic.txId);
+    uint64_t elapsedMs = std::max<uint64_t>(nowMs - sample.timeMs, 1);
+    sample.opsPerSec = ops * 1000.0 / elapsedMs;
+    sample.statistic = statistic;
+    sample.timeMs = nowMs;
+  }
+}
+
+double LoadScheduler::ReplicaLoad(const CopySetInfo& info,
+                                  MetaServerIdType id) {
+  double load = GetCopySetLoad(info.id);
+  return info.leader == id ? load : load * kFollowerLoadFactor;
+}
+
+int LoadScheduler::LoadSchedulerForPool(PoolIdType poolId) {
+  uint16_t replicaNum = topo_->GetStandardReplicaNumInPool(poolId);
+  if (replicaNum == 0) {
+    LOG(ERROR) << "load scheduler for pool = " << poolId
+               << " fail, replicaNum is 0";
+    return 0;
+  }
+
+  UpdateCopySetLoad(poolId);
+
+  std::map<MetaServerIdType, MetaServerInfo> metaservers;
+  std::map<MetaServerIdType, double> loads;
+  for (const auto& msInfo : topo_->GetMetaServersInPool(poolId)) {
+    if (msInfo.IsHealthy()) {
+      metaservers.emplace(msInfo.info.id, msInfo);
+      loads.emplace(msInfo.info.id, 0);
+    }
+  }
+  if (metaservers.empty()) {
+    return 0;
+  }
+
+  std::vector<CopySetInfo> copysets = topo_->GetCopySetInfosInPool(poolId);
+  double total = 0;
+  for (const auto& copyset : copysets) {
+    for (const auto& peer : copyset.peers) {
+      auto iter = loads.find(peer.id);
+      if (iter != loads.end()) {
+        double load = ReplicaLoad(copyset, peer.id);
+        iter->second += load;
+        total += load;
+      }
+    }
+  }
+
+  double average = total / loads.size();
+  if (average < minOpsPerSec_) {
+    VLOG(3) << "loadScheduler skip pool " << poolId
+            << ", average load = " << average;
+    return 0;
+  }
+
+  std::vector<std::pair<MetaServerIdType, double>> hots;
+  for (const auto& item : loads) {
+    if (item.second * 100 > average * (100 + balanceRatioPercent_)) {
+      hots.emplace_back(item);
+    }
+  }
+  if (hots.empty()) {
+    LOG(INFO) << "loadScheduler find no hot metaserver in pool " << poolId
+              << ", average load = " << average;
+    return 0;
+  }
+
+  // the hottest first, try the next one if nothing can be moved out of it
+  std::stable_sort(hots.begin(), hots.end(),
+                   [](const std::pair<MetaServerIdType, double>& lhs,
+                      const std::pair<MetaServerIdType, double>& rhs) {
+                     return lhs.second > rhs.second;
+                   });
+  for (const auto& hot : hots) {
+    LOG(INFO) << "loadScheduler select hot metaserver " << hot.first
+              << " on pool " << poolId << ", load = " << hot.second
+              << ", average load = " << average;
+
+    // transferring leader is much cheaper than moving a replica
+    if (TransferLeaderOut(hot.first, replicaNum, copysets, metaservers,
+                          loads) ||
+        ChangePeerOut(hot.first, copysets, metaservers, loads)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// 1. pick the copysets whose leader is the source, the hottest first
+// 2. transfer the leader to the coolest follower, unless it would make the
+//    follower hotter than the source, or break the leader balance kept by
+//    LeaderScheduler
+bool LoadScheduler::TransferLeaderOut(
+    MetaServerIdType source, uint16_t replicaNum,
+    const std::vector<CopySetInfo>& copysets,
+    const std::map<MetaServerIdType, MetaServerInfo>& metaservers,
+    const std::map<MetaServerIdType, double>& loads) {
+  const MetaServerInfo& sourceInfo = metaservers.at(source);
+  double sourceStandard = sourceInfo.copysetNum * 1.0 / replicaNum;
+  if ((sourceInfo.leaderNum - 1.0) - sourceStandard < -1) {
+    LOG(INFO) << "loadScheduler can not transfer leader out of metaserver "
+              << source << ", leaderNum = " << sourceInfo.leaderNum;
+    return false;
+  }
+
+  std::vector<const CopySetInfo*> candidates;
+  for (const auto& copyset : copysets) {
+    if (copyset.leader == source && CopySetCanMove(copyset)) {
+      candidates.emplace_back(&copyset);
+    }
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [this](const CopySetInfo* lhs, const CopySetInfo* rhs) {
+                     return GetCopySetLoad(lhs->id) > GetCopySetLoad(rhs->id);
+                   });
+
+  double sourceLoad = loads.at(source);
+  for (const auto* copyset : candidates) {
+    double delta = GetCopySetLoad(copyset->id) * (1 - kFollowerLoadFactor);
+    MetaServerIdType target = UNINITIALIZE_ID;
+    double targetLoad = 0;
+    for (const auto& peer : copyset->peers) {
+      auto iter = metaservers.find(peer.id);
+      if (peer.id == source || iter == metaservers.end() ||
+          !CoolingTimeExpired(iter->second.startUpTime)) {
+        continue;
+      }
+
+      const MetaServerInfo& msInfo = iter->second;
+      double standard = msInfo.copysetNum * 1.0 / replicaNum;
+      if ((msInfo.leaderNum + 1.0) - standard > 1) {
+        continue;
+      }
+
+      double load = loads.at(peer.id);
+      if (target == UNINITIALIZE_ID || load < targetLoad) {
+        target = peer.id;
+        targetLoad = load;
+      }
+    }
+
+    // never overshoot, otherwise the leader would move back next round
+    if (target == UNINITIALIZE_ID || targetLoad + delta >= sourceLoad - delta) {
+      continue;
+    }
+
+    Operator op = operatorFactory.CreateTransferLeaderOperator(
+        *copyset, target, OperatorPriority::NormalPriority);
+    op.timeLimit = std::chrono::seconds(transTimeSec_);
+    if (!opController_->AddOperator(op)) {
+      LOG(WARNING) << "loadScheduler generate operator " << op.OpToString()
+                   << " for " << copyset->CopySetInfoStr()
+                   << ", but add operator fail";
+      continue;
+    }
+
+    lastMoved_[copyset->id] = steady_clock::now();
+    LOG(INFO) << "loadScheduler generate operator " << op.OpToString()
+              << " for " << copyset->CopySetInfoStr()
+              << ", copyset load = " << GetCopySetLoad(copyset->id);
+    return true;
+  }
+
+  LOG(INFO) << "loadScheduler can not select copyset for metaserver "
+            << source << " to transfer leader out";
+  return false;
+}
+
+// 1. pick the copysets on the source, the one moves most load first
+// 2. replace the source with the coolest metaserver in the same zone, so
+//    the replicas are still spread over zones, unless it just started or
+//    would be rebalanced by CopySetScheduler
+bool LoadScheduler::ChangePeerOut(
+    MetaServerIdType source, const std::vector<CopySetInfo>& copysets,
+    const std::map<MetaServerIdType, MetaServerInfo>& metaservers,
+    const std::map<MetaServerIdType, double>& loads) {
+  std::vector<const CopySetInfo*> candidates;
+  for (const auto& copyset : copysets) {
+    if (copyset.ContainPeer(source) && CopySetCanMove(copyset)) {
+      candidates.emplace_back(&copyset);
+    }
+  }
+  std::stable_sort(
+      candidates.begin(), candidates.end(),
+      [this, source](const CopySetInfo* lhs, const CopySetInfo* rhs) {
+        return ReplicaLoad(*lhs, source) > ReplicaLoad(*rhs, source);
+      });
+
+  ZoneIdType zoneId = metaservers.at(source).info.zoneId;
+  double sourceLoad = loads.at(source);
+  for (const auto* copyset : candidates) {
+    MetaServerIdType target = UNINITIALIZE_ID;
+    double targetLoad = 0;
+    for (const auto& item : metaservers) {
+      const MetaServerInfo& msInfo = item.second;
+      if (msInfo.info.zoneId != zoneId || copyset->ContainPeer(item.first) ||
+          !msInfo.IsMetaserverResourceAvailable() ||
+          !CoolingTimeExpired(msInfo.startUpTime) ||
+          !KeepResourceBalance(source, item.first, metaservers)) {
+        continue;
+      }
+
+      double load = loads.at(item.first);
+      if (target == UNINITIALIZE_ID || load < targetLoad) {
+        target = item.first;
+        targetLoad = load;
+      }
+    }
+
+    // the new replica is a follower until the leader is transferred to it
+    double added = GetCopySetLoad(copyset->id) * kFollowerLoadFactor;
+    double removed = ReplicaLoad(*copyset, source);
+    if (target == UNINITIALIZE_ID ||
+        targetLoad + added >= sourceLoad - removed) {
+      continue;
+    }
+
+    Operator op = operatorFactory.CreateChangePeerOperator(
+        *copyset, source, target, OperatorPriority::NormalPriority);
+    op.timeLimit = std::chrono::seconds(changeTimeSec_);
+    if (!opController_->AddOperator(op)) {
+      LOG(WARNING) << "loadScheduler generate operator " << op.OpToString()
+                   << " for " << copyset->CopySetInfoStr()
+                   << ", but add operator fail";
+      continue;
+    }
+
+    if (!topo_->CreateCopySetAtMetaServer(copyset->id, target)) {
+      LOG(ERROR) << "loadScheduler create " << copyset->CopySetInfoStr()
+                 << " on metaServer: " << target << " error, delete operator"
+                 << op.OpToString();
+      opController_->RemoveOperator(copyset->id);
+      continue;
+    }
+
+    lastMoved_[copyset->id] = steady_clock::now();
+    LOG(INFO) << "loadScheduler generate operator " << op.OpToString()
+              << " for " << copyset->CopySetInfoStr()
+              << ", copyset load = " << GetCopySetLoad(copyset->id);
+    return true;
+  }
+
+  LOG(INFO) << "loadScheduler can not select copyset for metaserver "
+            << source << " to change peer out";
+  return false;
+}
+
+// CopySetScheduler moves copysets out of the metaserver whose disk usage
+// exceeds the lowest one in zone by its balanceRatioPercent, the replica
+// must not be moved to such a metaserver, otherwise it would be moved back
+bool LoadScheduler::KeepResourceBalance(
+    MetaServerIdType source, MetaServerIdType target,
+    const std::map<MetaServerIdType, MetaServerInfo>& metaservers) {
+  const MetaServerInfo& sourceInfo = metaservers.at(source);
+  const MetaServerInfo& targetInfo = metaservers.at(target);
+
+  // the disk usage of copyset is unknown, take the average on source
+  uint64_t used = sourceInfo.space.GetDiskUsed() /
+                  std::max<uint32_t>(sourceInfo.copysetNum, 1);
+  MetaServerSpace sourceSpace = sourceInfo.space;
+  sourceSpace.SetDiskUsed(sourceSpace.GetDiskUsed() - used);
+  MetaServerSpace targetSpace = targetInfo.space;
+  targetSpace.SetDiskUsed(targetSpace.GetDiskUsed() + used);
+
+  double minRatio = sourceSpace.GetResourceUseRatioPercent();
+  for (const auto& item : metaservers) {
+    if (item.first != source && item.first != target &&
+        item.second.info.zoneId == targetInfo.info.zoneId) {
+      minRatio = std::min(minRatio, item.second.GetResourceUseRatioPercent());
+    }
+  }
+  return targetSpace.GetResourceUseRatioPercent() <=
+         minRatio + copysetBalanceRatioPercent_;
+}
+
+bool LoadScheduler::CopySetCanMove(const CopySetInfo& info) {
+  if (info.HasCandidate() || !CopysetAllPeersOnline(info)) {
+    return false;
+  }
+
+  Operator exist;
+  if (opController_->GetOperatorById(info.id, &exist)) {
+    return false;
+  }
+
+  // the load of copyset is re-estimated after it moved, this avoids moving
+  // it back and forth between metaservers
+  auto iter = lastMoved_.find(info.id);
+  return iter == lastMoved_.end() ||
+         steady_clock::now() - iter->second >=
+             std::chrono::seconds(coolingTimeSec_);
+}
+
+bool LoadScheduler::CoolingTimeExpired(uint64_t startUpTime) {
+  if (startUpTime == 0) {
+    return false;
+  }
+
+  uint64_t currentTime = TimeUtility::GetTimeofDaySec();
+  return currentTime - startUpTime > metaserverCoolingTimeSec_;
+}
+
+}  // namespace schedule
+}  // namespace mds
+}  // namespace dingofs
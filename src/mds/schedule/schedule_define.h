@@ -32,6 +32,7 @@ enum class SchedulerType {
   RecoverSchedulerType,
   CopysetSchedulerType,
   LeaderSchedulerType,
+  LoadSchedulerType,
 };
 
 struct ScheduleOption {
@@ -68,6 +69,17 @@ struct ScheduleOption {
   uint32_t metaserverCoolingTimeSec;
 
   uint32_t balanceRatioPercent;
+
+  // load scheduler switch and round interval
+  bool enableLoadScheduler = false;
+  uint32_t loadSchedulerIntervalSec = 30;
+  // the metaserver whose load exceeds the average of pool by this percent
+  // is considered hot
+  uint32_t loadBalanceRatioPercent = 20;
+  // a copyset won't be moved again by load scheduler within this time
+  uint32_t loadCoolingTimeSec = 600;
+  // pool with average load below this is too idle to balance
+  uint32_t loadMinOpsPerSec = 100;
 };
 
 }  // namespace schedule
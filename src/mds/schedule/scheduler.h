@@ -23,6 +23,7 @@
 #ifndef DINGOFS_SRC_MDS_SCHEDULE_SCHEDULER_H_
 #define DINGOFS_SRC_MDS_SCHEDULE_SCHEDULER_H_
 
+#include <chrono>
 #include <map>
 #include <memory>
 #include <vector>
@@ -282,6 +283,91 @@ class LeaderScheduler : public Scheduler {
   const int maxRetryTransferLeader = 10;
 };
 
+// LoadScheduler balances the write load of metaservers in pool, which is
+// estimated from the growth of partition statistics between two rounds.
+// It prefers transferring the leader of a hot copyset, and moves a replica
+// to another metaserver in the same zone only if no leader can be moved.
+class LoadScheduler : public Scheduler {
+ public:
+  LoadScheduler(const ScheduleOption& opt,
+                const std::shared_ptr<TopoAdapter>& topo,
+                const std::shared_ptr<OperatorController>& opController)
+      : Scheduler(opt, topo, opController) {
+    runInterval_ = opt.loadSchedulerIntervalSec;
+    balanceRatioPercent_ = opt.loadBalanceRatioPercent;
+    coolingTimeSec_ = opt.loadCoolingTimeSec;
+    minOpsPerSec_ = opt.loadMinOpsPerSec;
+    metaserverCoolingTimeSec_ = opt.metaserverCoolingTimeSec;
+    copysetBalanceRatioPercent_ = opt.balanceRatioPercent;
+  }
+
+  /**
+   * @brief Schedule Generate operators according to the load of metaservers
+   *
+   * @return number of operators generated
+   */
+  int Schedule() override;
+
+  /**
+   * @brief Get running interval of LoadScheduler
+   *
+   * @return time interval
+   */
+  int64_t GetRunningInterval() const override;
+
+  // for test
+  double GetCopySetLoad(const CopySetKey& key);
+
+ private:
+  struct LoadSample {
+    CopySetStatistic statistic;
+    uint64_t timeMs;
+    double opsPerSec;
+  };
+
+  int LoadSchedulerForPool(PoolIdType poolId);
+
+  void UpdateCopySetLoad(PoolIdType poolId);
+
+  // the load of metaserver, a follower replica is weighed less than the
+  // leader as it only applies the log
+  double ReplicaLoad(const CopySetInfo& info, MetaServerIdType id);
+
+  bool TransferLeaderOut(
+      MetaServerIdType source, uint16_t replicaNum,
+      const std::vector<CopySetInfo>& copysets,
+      const std::map<MetaServerIdType, MetaServerInfo>& metaservers,
+      const std::map<MetaServerIdType, double>& loads);
+
+  bool ChangePeerOut(
+      MetaServerIdType source, const std::vector<CopySetInfo>& copysets,
+      const std::map<MetaServerIdType, MetaServerInfo>& metaservers,
+      const std::map<MetaServerIdType, double>& loads);
+
+  // the disk usage of zone is still balanced for CopySetScheduler after a
+  // replica moved from source to target
+  bool KeepResourceBalance(
+      MetaServerIdType source, MetaServerIdType target,
+      const std::map<MetaServerIdType, MetaServerInfo>& metaservers);
+
+  // the copyset is healthy, has no operator and not moved recently
+  bool CopySetCanMove(const CopySetInfo& info);
+
+  bool CoolingTimeExpired(uint64_t aliveTime);
+
+ private:
+  int64_t runInterval_;
+  uint32_t balanceRatioPercent_;
+  uint32_t coolingTimeSec_;
+  uint32_t minOpsPerSec_;
+  uint32_t metaserverCoolingTimeSec_;
+  uint32_t copysetBalanceRatioPercent_;
+
+  // only accessed by the scheduler thread
+  std::map<CopySetKey, LoadSample> samples_;
+  std::map<CopySetKey, std::chrono::steady_clock::time_point> lastMoved_;
+};
+
 }  // namespace schedule
 }  // namespace mds
 }  // namespace dingofs
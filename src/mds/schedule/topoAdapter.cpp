@@ -334,6 +334,21 @@ bool TopoAdapterImpl::ChooseNewMetaServerForCopyset(
   return ret == TopoStatusCode::TOPO_OK;
 }
 
+std::map<CopySetIdType, CopySetStatistic>
+TopoAdapterImpl::GetCopySetStatisticsInPool(PoolIdType poolId) {
+  std::map<CopySetIdType, CopySetStatistic> out;
+  for (const auto& partition : topo_->GetPartitionInfosInPool(poolId)) {
+    auto& statistic = out[partition.GetCopySetId()];
+    statistic.inodeNum += partition.GetInodeNum();
+    statistic.dentryNum += partition.GetDentryNum();
+    statistic.txId += partition.GetTxId();
+    if (partition.GetIdNext() > partition.GetIdStart()) {
+      statistic.allocatedIds += partition.GetIdNext() - partition.GetIdStart();
+    }
+  }
+  return out;
+}
+
 }  // namespace schedule
 }  // namespace mds
 }  // namespace dingofs
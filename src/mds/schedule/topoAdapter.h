@@ -113,6 +113,16 @@ struct CopySetInfo {
   ConfigChangeInfo configChangeInfo;
 };
 
+// sum of the statistics of partitions in copyset, which are reported by
+// the leader in heartbeat. they only grow or shrink by the mutations, so
+// the difference between two samples reflects the write load of copyset.
+struct CopySetStatistic {
+  uint64_t inodeNum = 0;
+  uint64_t dentryNum = 0;
+  uint64_t allocatedIds = 0;
+  uint64_t txId = 0;
+};
+
 struct MetaServerInfo {
  public:
   MetaServerInfo() : startUpTime(0) {}
@@ -280,6 +290,17 @@ class TopoAdapter {
       PoolIdType poolId, const std::set<ZoneIdType>& excludeZones,
       const std::set<MetaServerIdType>& excludeMetaservers,
       MetaServerIdType* target) = 0;
+
+  /**
+   * @brief GetCopySetStatisticsInPool get the statistics of every copyset
+   *                                   which has partitions in the pool
+   *
+   * @param[in] poolId the id of the pool
+   *
+   * @return copyset id to statistic
+   */
+  virtual std::map<CopySetIdType, CopySetStatistic> GetCopySetStatisticsInPool(
+      PoolIdType poolId) = 0;
 };
 
 // implementation of virtual class TopoAdapter
@@ -328,6 +349,9 @@ class TopoAdapterImpl : public TopoAdapter {
       const std::set<MetaServerIdType>& excludeMetaservers,
       MetaServerIdType* target) override;
 
+  std::map<CopySetIdType, CopySetStatistic> GetCopySetStatisticsInPool(
+      PoolIdType poolId) override;
+
  private:
   bool GetPeerInfo(MetaServerIdType id, PeerInfo* peerInfo);
 
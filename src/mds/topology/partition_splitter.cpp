@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mds/topology/partition_splitter.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <utility>
+
+#include "utils/timeutility.h"
+
+namespace dingofs {
+namespace mds {
+namespace topology {
+
+using utils::TimeUtility;
+
+namespace {
+
+uint64_t AbsDiff(uint64_t lhs, uint64_t rhs) {
+  return lhs > rhs ? lhs - rhs : rhs - lhs;
+}
+
+}  // namespace
+
+void PartitionSplitter::Init(const TopologyOption& option) {
+  option_ = option;
+}
+
+void PartitionSplitter::Run() {
+  if (!option_.enablePartitionSplit) {
+    LOG(INFO) << "partition split is disabled";
+    return;
+  }
+
+  if (isStop_.exchange(false)) {
+    backEndThread_ =
+        dingofs::utils::Thread(&PartitionSplitter::BackEndFunc, this);
+  }
+}
+
+void PartitionSplitter::Stop() {
+  if (!isStop_.exchange(true)) {
+    LOG(INFO) << "stop PartitionSplitter...";
+    sleeper_.interrupt();
+    backEndThread_.join();
+    LOG(INFO) << "stop PartitionSplitter ok.";
+  }
+}
+
+void PartitionSplitter::BackEndFunc() {
+  while (sleeper_.wait_for(
+      std::chrono::seconds(option_.partitionSplitIntervalSec))) {
+    SplitPartitions();
+  }
+}
+
+int PartitionSplitter::SplitPartitions() {
+  uint64_t nowMs = TimeUtility::GetTimeofDayMs();
+  std::unordered_map<PartitionIdType, Sample> samples;
+  int splitNum = 0;
+
+  for (PoolIdType poolId : topo_->GetPoolInCluster()) {
+    for (const auto& partition : topo_->GetPartitionInfosInPool(poolId)) {
+      Sample sample = TakeSample(partition, nowMs);
+      samples.emplace(partition.GetPartitionId(), sample);
+
+      uint64_t splitKey = GetSplitKey(partition, sample);
+      if (splitKey == 0) {
+        continue;
+      }
+
+      LOG(INFO) << "split partition, partitionId = "
+                << partition.GetPartitionId()
+                << ", rowNum = " << sample.rowNum
+                << ", opsPerSec = " << sample.opsPerSec
+                << ", splitKey = " << splitKey;
+      pb::common::PartitionInfo info;
+      TopoStatusCode ret = topologyManager_->SplitPartition(
+          partition.GetPartitionId(), splitKey, &info);
+      if (ret != TopoStatusCode::TOPO_OK) {
+        LOG(WARNING) << "split partition failed, partitionId = "
+                     << partition.GetPartitionId()
+                     << ", error code = "
+                     << pb::mds::topology::TopoStatusCode_Name(ret);
+        splitFailCount_ << 1;
+        continue;
+      }
+      splitCount_ << 1;
+      splitNum++;
+    }
+  }
+
+  samples_.swap(samples);
+  return splitNum;
+}
+
+double PartitionSplitter::GetWriteRate(PartitionIdType id) const {
+  auto iter = samples_.find(id);
+  return iter == samples_.end() ? 0 : iter->second.opsPerSec;
+}
+
+PartitionSplitter::Sample PartitionSplitter::TakeSample(
+    const Partition& partition, uint64_t nowMs) const {
+  Sample sample;
+  sample.nextId = std::max(partition.GetIdNext(), partition.GetIdStart());
+  sample.rowNum = partition.GetInodeNum() + partition.GetDentryNum();
+  sample.timeMs = nowMs;
+  sample.opsPerSec = 0;
+
+  // the new inodes move the next id forward, the deletions and the dentry
+  // writes change the number of rows
+  auto iter = samples_.find(partition.GetPartitionId());
+  if (iter != samples_.end() && nowMs > iter->second.timeMs) {
+    const Sample& last = iter->second;
+    uint64_t ops = AbsDiff(sample.nextId, last.nextId) +
+                   AbsDiff(sample.rowNum, last.rowNum);
+    sample.opsPerSec =
+        static_cast<double>(ops) * 1000 / (nowMs - last.timeMs);
+  }
+  return sample;
+}
+
+uint64_t PartitionSplitter::GetSplitKey(const Partition& partition,
+                                        const Sample& sample) const {
+  if (partition.GetStatus() != pb::common::PartitionStatus::READWRITE ||
+      sample.nextId > partition.GetIdEnd()) {
+    return 0;
+  }
+
+  // the end of partition is aligned to idNumberInPartition until it's
+  // split, the rows stay in it after the split, so the trigger never goes
+  // away and splitting it again only takes more free ids
+  if (option_.idNumberInPartition != 0 &&
+      (partition.GetIdEnd() + 1) % option_.idNumberInPartition != 0) {
+    return 0;
+  }
+
+  uint64_t freeIds = partition.GetIdEnd() - sample.nextId + 1;
+  if (freeIds < std::max<uint64_t>(option_.partitionSplitMinFreeIds, 2)) {
+    return 0;
+  }
+
+  if (sample.rowNum < option_.partitionSplitRowNum &&
+      sample.opsPerSec < option_.partitionSplitOpsPerSec) {
+    return 0;
+  }
+
+  // the new inodes go to the new partition once the few ids kept here are
+  // used up, they are kept as the next id reported by heartbeat may fall
+  // behind a little
+  uint64_t keepIds = std::max<uint64_t>(option_.partitionSplitMinFreeIds, 2);
+  return sample.nextId + keepIds / 2 - 1;
+}
+
+}  // namespace topology
+}  // namespace mds
+}  // namespace dingofs
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_MDS_TOPOLOGY_PARTITION_SPLITTER_H_
+#define DINGOFS_SRC_MDS_TOPOLOGY_PARTITION_SPLITTER_H_
+
+#include <bvar/bvar.h>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "mds/common/mds_define.h"
+#include "mds/topology/topology.h"
+#include "mds/topology/topology_config.h"
+#include "mds/topology/topology_manager.h"
+#include "utils/concurrent/concurrent.h"
+#include "utils/interruptible_sleeper.h"
+
+namespace dingofs {
+namespace mds {
+namespace topology {
+
+// Split the partitions which are too big or too hot in background.
+//
+// The statistics of partition come from the metaserver heartbeat, the write
+// rate is estimated from the changes of the next inode id and the number of
+// inodes and dentries between two rounds. The inodes and dentries can't be
+// moved between copysets, so only the free inode ids are split: the
+// partition keeps its allocated ids and a few free ones, a new partition on
+// another copyset takes the rest and thus the following new inodes. A
+// partition is split at most once, as its rows stay where they are.
+class PartitionSplitter {
+ public:
+  PartitionSplitter(std::shared_ptr<Topology> topo,
+                    std::shared_ptr<TopologyManager> topologyManager)
+      : topo_(topo), topologyManager_(topologyManager), isStop_(true) {}
+  ~PartitionSplitter() { Stop(); }
+
+  void Init(const TopologyOption& option);
+
+  void Run();
+
+  void Stop();
+
+  // check all partitions once, return the number of partitions split
+  int SplitPartitions();
+
+  // the estimated write rate of partition in last round, 0 if unknown
+  double GetWriteRate(PartitionIdType id) const;
+
+ private:
+  struct Sample {
+    uint64_t nextId;
+    uint64_t rowNum;
+    uint64_t timeMs;
+    double opsPerSec;
+  };
+
+  void BackEndFunc();
+
+  Sample TakeSample(const Partition& partition, uint64_t nowMs) const;
+
+  // return the split key, or 0 if the partition needn't be split
+  uint64_t GetSplitKey(const Partition& partition, const Sample& sample) const;
+
+ private:
+  std::shared_ptr<Topology> topo_;
+  std::shared_ptr<TopologyManager> topologyManager_;
+
+  std::unordered_map<PartitionIdType, Sample> samples_;
+
+  dingofs::utils::Thread backEndThread_;
+  dingofs::utils::Atomic<bool> isStop_;
+  utils::InterruptibleSleeper sleeper_;
+
+  TopologyOption option_;
+
+  bvar::Adder<uint64_t> splitCount_{"topology_partition_split", "count"};
+  bvar::Adder<uint64_t> splitFailCount_{"topology_partition_split",
+                                        "fail_count"};
+};
+
+}  // namespace topology
+}  // namespace mds
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_MDS_TOPOLOGY_PARTITION_SPLITTER_H_
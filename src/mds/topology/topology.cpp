@@ -351,8 +351,8 @@ TopoStatusCode TopologyImpl::UpdateMetaServerSpace(const MetaServerSpace& space,
     return ret;
   }
 
-  // fetch write lock of the pool and read lock of metaserver map
-  WriteLockGuard wlockl_pool(poolMutex_);
+  // the pool is locked only if its threshold changes, most heartbeats only
+  // update the usage of metaserver
   int64_t diff_threshold = 0;
   {
     ReadLockGuard rlock_meta_server_map(metaServerMutex_);
@@ -395,6 +395,7 @@ TopoStatusCode TopologyImpl::UpdateMetaServerSpace(const MetaServerSpace& space,
 
   if (diff_threshold != 0) {
     // update pool
+    WriteLockGuard wlockl_pool(poolMutex_);
     auto it = poolMap_.find(belong_pool_id);
     if (it != poolMap_.end()) {
       uint64_t total_threshold = it->second.GetDiskThreshold();
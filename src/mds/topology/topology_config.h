@@ -41,6 +41,16 @@ struct TopologyOption {
   uint32_t maxCopysetNumInMetaserver;
   // time interval for updating topology metric
   uint32_t UpdateMetricIntervalSec;
+  // split the hot or big partitions in background
+  bool enablePartitionSplit;
+  // time interval for checking the partitions to split
+  uint32_t partitionSplitIntervalSec;
+  // split the partition with more inodes and dentries than this
+  uint64_t partitionSplitRowNum;
+  // split the partition with more writes per second than this
+  uint64_t partitionSplitOpsPerSec;
+  // don't split the partition with less free inode ids than this
+  uint64_t partitionSplitMinFreeIds;
 
   TopologyOption()
       : topologyUpdateToRepoSec(0),
@@ -48,7 +58,12 @@ struct TopologyOption {
         idNumberInPartition(1048576),
         createPartitionNumber(12),
         maxCopysetNumInMetaserver(100),
-        UpdateMetricIntervalSec(60) {}
+        UpdateMetricIntervalSec(60),
+        enablePartitionSplit(false),
+        partitionSplitIntervalSec(60),
+        partitionSplitRowNum(4194304),
+        partitionSplitOpsPerSec(2000),
+        partitionSplitMinFreeIds(65536) {}
 };
 
 }  // namespace topology
@@ -644,13 +644,10 @@ TopoStatusCode TopologyManager::CreatePartitionsAndGetMinPartition(
   return TopoStatusCode::TOPO_OK;
 }
 
-TopoStatusCode TopologyManager::CreatePartitionOnCopyset(
-    FsIdType fsId, const CopySetInfo& copyset,
-    pb::common::PartitionInfo* info) {
-  // get copyset members
-  std::set<MetaServerIdType> copysetMembers = copyset.GetCopySetMembers();
+std::set<std::string> TopologyManager::GetCopysetMemberInternalAddrs(
+    const CopySetInfo& copyset) {
   std::set<std::string> copysetMemberAddr;
-  for (auto item : copysetMembers) {
+  for (auto item : copyset.GetCopySetMembers()) {
     MetaServer metaserver;
     if (topology_->GetMetaServer(item, &metaserver)) {
       std::string addr = metaserver.GetInternalIp() + ":" +
@@ -660,11 +657,24 @@ TopoStatusCode TopologyManager::CreatePartitionOnCopyset(
       LOG(WARNING) << "Get metaserver info failed.";
     }
   }
+  return copysetMemberAddr;
+}
 
+TopoStatusCode TopologyManager::CreatePartitionOnCopyset(
+    FsIdType fsId, const CopySetInfo& copyset,
+    pb::common::PartitionInfo* info) {
   // calculate inodeId start and end of partition
   uint32_t index = topology_->GetPartitionIndexOfFS(fsId);
   uint64_t idStart = index * option_.idNumberInPartition;
   uint64_t idEnd = (index + 1) * option_.idNumberInPartition - 1;
+  return CreatePartitionOnCopyset(fsId, copyset, idStart, idEnd, info);
+}
+
+TopoStatusCode TopologyManager::CreatePartitionOnCopyset(
+    FsIdType fsId, const CopySetInfo& copyset, uint64_t idStart,
+    uint64_t idEnd, pb::common::PartitionInfo* info) {
+  std::set<std::string> copysetMemberAddr =
+      GetCopysetMemberInternalAddrs(copyset);
   PartitionIdType partitionId = topology_->AllocatePartitionId();
 
   if (partitionId == static_cast<ServerIdType>(UNINITIALIZE_ID)) {
@@ -760,6 +770,99 @@ void TopologyManager::CreatePartitions(
   }
 }
 
+TopoStatusCode TopologyManager::SplitPartition(
+    PartitionIdType partitionId, uint64_t splitKey,
+    pb::common::PartitionInfo* info) {
+  Partition partition;
+  if (!topology_->GetPartition(partitionId, &partition)) {
+    LOG(WARNING) << "SplitPartition, partition not found, id = "
+                 << partitionId;
+    return TopoStatusCode::TOPO_PARTITION_NOT_FOUND;
+  }
+
+  // serialize with the partition creation of the same fs
+  FsIdType fsId = partition.GetFsId();
+  NameLockGuard lock(createPartitionMutex_, std::to_string(fsId));
+  if (!topology_->GetPartition(partitionId, &partition)) {
+    return TopoStatusCode::TOPO_PARTITION_NOT_FOUND;
+  }
+
+  // the next id reported by heartbeat may fall behind, the metaserver
+  // rejects the split if the ids above the split key are in use already
+  uint64_t idStart = partition.GetIdStart();
+  uint64_t idEnd = partition.GetIdEnd();
+  uint64_t idNext = std::max(partition.GetIdNext(), idStart);
+  if (partition.GetStatus() != pb::common::PartitionStatus::READWRITE ||
+      splitKey < idNext || splitKey >= idEnd) {
+    LOG(WARNING) << "SplitPartition, invalid split key, partitionId = "
+                 << partitionId << ", status = " << partition.GetStatus()
+                 << ", start = " << idStart << ", next = " << idNext
+                 << ", end = " << idEnd << ", splitKey = " << splitKey;
+    return TopoStatusCode::TOPO_INVALID_PARAM;
+  }
+
+  CopySetKey sourceKey(partition.GetPoolId(), partition.GetCopySetId());
+  CopySetInfo source;
+  if (!topology_->GetCopySet(sourceKey, &source)) {
+    return TopoStatusCode::TOPO_COPYSET_NOT_FOUND;
+  }
+
+  // the new partition goes to the least loaded copyset except the source
+  std::vector<CopySetInfo> copysetVec = topology_->GetAvailableCopysetList();
+  copysetVec.erase(std::remove_if(copysetVec.begin(), copysetVec.end(),
+                                  [&](const CopySetInfo& copyset) {
+                                    return copyset.GetCopySetKey() ==
+                                           sourceKey;
+                                  }),
+                   copysetVec.end());
+  if (copysetVec.empty()) {
+    LOG(WARNING) << "SplitPartition, no available copyset, partitionId = "
+                 << partitionId;
+    return TopoStatusCode::TOPO_GET_AVAILABLE_COPYSET_ERROR;
+  }
+  auto target = std::min_element(
+      copysetVec.begin(), copysetVec.end(),
+      [](const CopySetInfo& a, const CopySetInfo& b) {
+        return a.GetPartitionNum() < b.GetPartitionNum();
+      });
+
+  // shrink the source first, a crash before the new partition is created
+  // leaves the upper ids unused instead of owned by two partitions
+  FSStatusCode retcode = metaserverClient_->CreatePartition(
+      fsId, partition.GetPoolId(), partition.GetCopySetId(), partitionId,
+      idStart, splitKey, GetCopysetMemberInternalAddrs(source));
+  if (FSStatusCode::OK != retcode) {
+    LOG(ERROR) << "SplitPartition, shrink partition failed, partitionId = "
+               << partitionId << ", splitKey = " << splitKey
+               << ", retcode = " << FSStatusCode_Name(retcode);
+    return TopoStatusCode::TOPO_CREATE_PARTITION_FAIL;
+  }
+
+  if (!topology_->GetPartition(partitionId, &partition)) {
+    return TopoStatusCode::TOPO_PARTITION_NOT_FOUND;
+  }
+  partition.SetIdEnd(splitKey);
+  TopoStatusCode ret = topology_->UpdatePartition(partition);
+  if (TopoStatusCode::TOPO_OK != ret) {
+    LOG(ERROR) << "SplitPartition, update partition failed, partitionId = "
+               << partitionId << ", error code = " << ret;
+    return ret;
+  }
+
+  ret = CreatePartitionOnCopyset(fsId, *target, splitKey + 1, idEnd, info);
+  if (TopoStatusCode::TOPO_OK != ret) {
+    LOG(ERROR) << "SplitPartition, create partition failed, partitionId = "
+               << partitionId << ", error code = " << ret;
+    return ret;
+  }
+
+  LOG(INFO) << "SplitPartition success, partitionId = " << partitionId
+            << ", range: [" << idStart << ", " << splitKey << "]"
+            << ", new partitionId = " << info->partitionid() << ", range: ["
+            << info->start() << ", " << info->end() << "]";
+  return TopoStatusCode::TOPO_OK;
+}
+
 TopoStatusCode TopologyManager::DeletePartition(uint32_t partition_id) {
   pb::mds::topology::DeletePartitionRequest request;
   pb::mds::topology::DeletePartitionResponse response;
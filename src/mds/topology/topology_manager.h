@@ -121,6 +121,15 @@ class TopologyManager {
 
   virtual TopoStatusCode DeletePartition(uint32_t partition_id);
 
+  // split the inode range of partition at `split_key`, the partition keeps
+  // [start, split_key] and a new partition on another copyset takes
+  // (split_key, end]. Only the unallocated ids can be split off, so no inode
+  // or dentry needs to move and the clients pick up the new range by
+  // listing the partitions again.
+  virtual TopoStatusCode SplitPartition(PartitionIdType partition_id,
+                                        uint64_t split_key,
+                                        pb::common::PartitionInfo* info);
+
   virtual TopoStatusCode CommitTxId(
       const std::vector<pb::mds::topology::PartitionTxId>& tx_ids);
 
@@ -203,6 +212,14 @@ class TopologyManager {
                                           const CopySetInfo& copyset,
                                           pb::common::PartitionInfo* info);
 
+  TopoStatusCode CreatePartitionOnCopyset(FsIdType fs_id,
+                                          const CopySetInfo& copyset,
+                                          uint64_t id_start, uint64_t id_end,
+                                          pb::common::PartitionInfo* info);
+
+  std::set<std::string> GetCopysetMemberInternalAddrs(
+      const CopySetInfo& copyset);
+
   std::shared_ptr<Topology> topology_;
   std::shared_ptr<MetaserverClient> metaserverClient_;
 
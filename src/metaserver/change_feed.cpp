@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metaserver/change_feed.h"
+
+#include <bvar/bvar.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+
+static bvar::Adder<uint64_t> g_change_feed_record_count(
+    "change_feed_record_count");
+static bvar::Adder<int64_t> g_change_feed_subscriber_count(
+    "change_feed_subscriber_count");
+
+namespace dingofs {
+namespace metaserver {
+
+namespace {
+
+ChangeRecord ResetRecord(uint32_t partitionId, uint64_t index) {
+  return ChangeRecord{index, 0, partitionId, 0, ChangeType::kReset};
+}
+
+}  // namespace
+
+void PartitionChangeFeed::Append(const ChangeRecord& record) {
+  if (capacity_ == 0) {
+    droppedIndex_ = record.index;
+    return;
+  }
+
+  if (records_.size() >= capacity_) {
+    droppedIndex_ = records_.front().index;
+    records_.pop_front();
+  }
+  records_.push_back(record);
+}
+
+bool PartitionChangeFeed::ReadAfter(uint64_t index,
+                                    std::vector<ChangeRecord>* records) const {
+  auto iter = std::upper_bound(
+      records_.begin(), records_.end(), index,
+      [](uint64_t index, const ChangeRecord& r) { return index < r.index; });
+  records->insert(records->end(), iter, records_.end());
+  return index >= droppedIndex_;
+}
+
+ChangeFeed::ChangeFeed() : capacity_(0), startIndex_(0) {}
+
+void ChangeFeed::Init(uint32_t capacity) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  capacity_.store(capacity, std::memory_order_relaxed);
+}
+
+void ChangeFeed::Reset(uint64_t index) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  startIndex_ = index;
+  partitions_.clear();
+
+  for (const auto& item : subscribers_) {
+    butil::IOBuf buffer;
+    EncodeChangeRecords({ResetRecord(item.first, index)}, &buffer);
+    for (const auto& connection : item.second) {
+      connection->Write(buffer);
+      connection->WriteDone();
+      g_change_feed_subscriber_count << -1;
+    }
+  }
+  subscribers_.clear();
+}
+
+void ChangeFeed::Append(uint32_t partitionId,
+                        const std::vector<ChangeRecord>& records) {
+  if (records.empty()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  uint32_t capacity = capacity_.load(std::memory_order_relaxed);
+  auto& feed =
+      partitions_.try_emplace(partitionId, PartitionChangeFeed(capacity))
+          .first->second;
+  for (const auto& record : records) {
+    feed.Append(record);
+  }
+  g_change_feed_record_count << records.size();
+
+  auto iter = subscribers_.find(partitionId);
+  if (iter == subscribers_.end()) {
+    return;
+  }
+
+  // the stream write never blocks, the subscriber which can't keep up
+  // with the changes is dropped, it will subscribe again
+  butil::IOBuf buffer;
+  EncodeChangeRecords(records, &buffer);
+  auto& connections = iter->second;
+  for (auto it = connections.begin(); it != connections.end();) {
+    if ((*it)->Write(buffer)) {
+      it++;
+      continue;
+    }
+    LOG(WARNING) << "Push changes of partition " << partitionId
+                 << " failed, drop the subscriber, streamId = "
+                 << (*it)->GetStreamId();
+    it = connections.erase(it);
+    g_change_feed_subscriber_count << -1;
+  }
+  if (connections.empty()) {
+    subscribers_.erase(iter);
+  }
+}
+
+bool ChangeFeed::ReadAfterLocked(uint32_t partitionId, uint64_t index,
+                                 std::vector<ChangeRecord>* records) {
+  bool complete = index >= startIndex_;
+  auto iter = partitions_.find(partitionId);
+  if (iter == partitions_.end()) {
+    return complete;
+  }
+  return iter->second.ReadAfter(index, records) && complete;
+}
+
+bool ChangeFeed::ReadAfter(uint32_t partitionId, uint64_t index,
+                           std::vector<ChangeRecord>* records) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return ReadAfterLocked(partitionId, index, records);
+}
+
+bool ChangeFeed::Subscribe(uint32_t partitionId, uint64_t index,
+                           std::shared_ptr<StreamConnection> connection) {
+  if (!Enabled()) {
+    LOG(WARNING) << "Subscribe changes of partition " << partitionId
+                 << " failed, the change feed is disabled";
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  std::vector<ChangeRecord> records;
+  if (!ReadAfterLocked(partitionId, index, &records)) {
+    records.insert(records.begin(), ResetRecord(partitionId, startIndex_));
+  }
+
+  if (!records.empty()) {
+    butil::IOBuf buffer;
+    EncodeChangeRecords(records, &buffer);
+    if (!connection->Write(buffer)) {
+      LOG(ERROR) << "Send changes of partition " << partitionId
+                 << " failed, streamId = " << connection->GetStreamId();
+      return false;
+    }
+  }
+
+  subscribers_[partitionId].push_back(connection);
+  g_change_feed_subscriber_count << 1;
+  return true;
+}
+
+size_t ChangeFeed::Subscribers() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  size_t count = 0;
+  for (const auto& item : subscribers_) {
+    count += item.second.size();
+  }
+  return count;
+}
+
+}  // namespace metaserver
+}  // namespace dingofs
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_METASERVER_CHANGE_FEED_H_
+#define DINGOFS_SRC_METASERVER_CHANGE_FEED_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "common/change_record.h"
+#include "common/rpc_stream.h"
+
+namespace dingofs {
+namespace metaserver {
+
+using ::dingofs::common::ChangeRecord;
+using ::dingofs::common::ChangeType;
+using ::dingofs::common::StreamConnection;
+
+// The latest changes of one partition, ordered by applied index.
+class PartitionChangeFeed {
+ public:
+  explicit PartitionChangeFeed(uint32_t capacity)
+      : capacity_(capacity), droppedIndex_(0) {}
+
+  // the index of record must not be less than the last one
+  void Append(const ChangeRecord& record);
+
+  // read the records whose index is greater than |index|,
+  // return false if some of them are dropped from the ring already
+  bool ReadAfter(uint64_t index, std::vector<ChangeRecord>* records) const;
+
+  size_t Size() const { return records_.size(); }
+
+ private:
+  uint32_t capacity_;
+  std::deque<ChangeRecord> records_;
+  uint64_t droppedIndex_;  // the largest index which dropped
+};
+
+// The change feeds of partitions in one copyset.
+//
+// The records are appended by the apply queue after the operator applied
+// successfully on leader, and pushed to the stream connections which
+// subscribe the partition. The feed only lives in memory, it's reset once
+// the leadership changed, the subscribers receive a kReset record then and
+// should drop the caches of partition and subscribe again.
+class ChangeFeed {
+ public:
+  ChangeFeed();
+
+  // |capacity| is 0 means the feed is disabled
+  void Init(uint32_t capacity);
+
+  bool Enabled() const { return capacity_.load(std::memory_order_relaxed) > 0; }
+
+  // drop all records after (re)elected or stepped down
+  void Reset(uint64_t index);
+
+  void Append(uint32_t partitionId, const std::vector<ChangeRecord>& records);
+
+  // read the records of partition whose index is greater than |index|,
+  // return false if some of them are lost
+  bool ReadAfter(uint32_t partitionId, uint64_t index,
+                 std::vector<ChangeRecord>* records);
+
+  // send the records after |index| and then all new records of partition
+  // to |connection|, a kReset record is sent first if some of them are lost
+  bool Subscribe(uint32_t partitionId, uint64_t index,
+                 std::shared_ptr<StreamConnection> connection);
+
+  size_t Subscribers();
+
+ private:
+  bool ReadAfterLocked(uint32_t partitionId, uint64_t index,
+                       std::vector<ChangeRecord>* records);
+
+  std::mutex mutex_;
+  std::atomic<uint32_t> capacity_;
+  uint64_t startIndex_;  // records before it are lost
+  std::unordered_map<uint32_t, PartitionChangeFeed> partitions_;
+  std::unordered_map<uint32_t, std::vector<std::shared_ptr<StreamConnection>>>
+      subscribers_;
+};
+
+}  // namespace metaserver
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_METASERVER_CHANGE_FEED_H_
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metaserver/clean_executor.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+#include "utils/concurrent/count_down_event.h"
+
+namespace dingofs {
+namespace metaserver {
+
+using pb::common::S3Info;
+using pb::mds::FsInfo;
+using utils::Configuration;
+
+void CleanExecutorOption::InitCleanExecutorOptionFromConf(
+    std::shared_ptr<Configuration> conf) {
+  // the defaults keep the cleaners serial, just like before the executor
+  LOG_IF(WARNING, !conf->GetValue("clean.executor.threadNum", &threadNum))
+      << "Not found `clean.executor.threadNum` in conf, default: "
+      << threadNum;
+  LOG_IF(WARNING, !conf->GetValue("clean.executor.batchSize", &batchSize))
+      << "Not found `clean.executor.batchSize` in conf, default: "
+      << batchSize;
+  LOG_IF(WARNING,
+         !conf->GetValue("clean.executor.maxInodesPerSec", &maxInodesPerSec))
+      << "Not found `clean.executor.maxInodesPerSec` in conf, default: "
+      << maxInodesPerSec;
+}
+
+CleanExecutor::CleanExecutor() : running_(false) {
+  pendingTasks_.expose_as("clean_executor_", "pending_tasks");
+  throttledInodes_.expose_as("clean_executor_", "throttled_inodes");
+}
+
+void CleanExecutor::Init(const CleanExecutorOption& option) {
+  option_ = option;
+  option_.batchSize = std::max(1U, option_.batchSize);
+  throttle_ = nullptr;
+  if (option_.maxInodesPerSec > 0) {
+    throttle_ = std::make_unique<utils::LeakyBucket>("clean_executor");
+    LOG_IF(ERROR, !throttle_->SetLimit(option_.maxInodesPerSec, 0, 0))
+        << "Set clean executor limit failed, limit = "
+        << option_.maxInodesPerSec;
+  }
+
+  std::lock_guard<std::mutex> lk(s3Mutex_);
+  s3Adaptors_.clear();
+}
+
+void CleanExecutor::Start() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (running_) {
+    return;
+  }
+
+  running_ = true;
+  for (uint32_t i = 0; i < option_.threadNum; i++) {
+    workers_.emplace_back(&CleanExecutor::WorkerLoop, this);
+  }
+  LOG(INFO) << "Clean executor started, threads = " << option_.threadNum
+            << ", batch size = " << option_.batchSize
+            << ", max inodes per second = " << option_.maxInodesPerSec;
+}
+
+void CleanExecutor::Stop() {
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+  }
+
+  cond_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+
+  // the owner of tasks (e.g. trash manager) should be stopped before
+  size_t ndropped = 0;
+  for (const auto& item : queues_) {
+    ndropped += item.second.size();
+  }
+  pendingTasks_ << -static_cast<int64_t>(ndropped);
+  queues_.clear();
+  ready_.clear();
+  LOG(INFO) << "Clean executor stopped, " << ndropped << " tasks dropped.";
+}
+
+void CleanExecutor::Submit(uint64_t key, Task task) {
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (running_ && !workers_.empty()) {
+      auto iter = queues_.find(key);
+      if (iter == queues_.end()) {  // neither queued nor running
+        iter = queues_.emplace(key, std::deque<Task>()).first;
+        ready_.push_back(key);
+      }
+      iter->second.emplace_back(std::move(task));
+      pendingTasks_ << 1;
+      cond_.notify_one();
+      return;
+    }
+  }
+
+  task();
+}
+
+void CleanExecutor::SubmitAndWait(
+    std::vector<std::pair<uint64_t, Task>> tasks) {
+  utils::CountDownEvent event(tasks.size());
+  for (auto& item : tasks) {
+    auto task = std::move(item.second);
+    Submit(item.first, [task, &event]() {
+      task();
+      event.Signal();
+    });
+  }
+  event.Wait();
+}
+
+void CleanExecutor::Throttle(uint64_t ninodes) {
+  if (throttle_ != nullptr && ninodes > 0) {
+    throttle_->Add(ninodes);
+    throttledInodes_ << ninodes;
+  }
+}
+
+void CleanExecutor::WorkerLoop() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  while (true) {
+    cond_.wait(lk, [this]() { return !running_ || !ready_.empty(); });
+    if (!running_) {
+      return;
+    }
+
+    uint64_t key = ready_.front();
+    ready_.pop_front();
+    auto& queue = queues_[key];
+    Task task = std::move(queue.front());
+    queue.pop_front();
+    pendingTasks_ << -1;
+
+    lk.unlock();
+    task();
+    lk.lock();
+
+    // the key is still in queues_ while running, so the new tasks of it
+    // are appended without scheduling, reschedule it at the tail here
+    auto iter = queues_.find(key);
+    if (iter->second.empty()) {
+      queues_.erase(iter);
+    } else {
+      ready_.push_back(key);
+      cond_.notify_one();
+    }
+  }
+}
+
+std::shared_ptr<S3ClientAdaptor> CleanExecutor::GetS3Adaptor(
+    const FsInfo& fsInfo, const std::shared_ptr<S3ClientAdaptor>& shared) {
+  const auto& s3Info = fsInfo.detail().s3info();
+  if (!option_.newS3Adaptor) {
+    ReinitS3Adaptor(s3Info, shared.get());
+    return shared;
+  }
+
+  std::string signature = s3Info.SerializeAsString();
+  std::lock_guard<std::mutex> lk(s3Mutex_);
+  auto iter = s3Adaptors_.find(fsInfo.fsid());
+  if (iter != s3Adaptors_.end() && iter->second.first == signature) {
+    return iter->second.second;
+  }
+
+  // the old adaptor is released after all its users finished
+  auto s3Adaptor = option_.newS3Adaptor();
+  ReinitS3Adaptor(s3Info, s3Adaptor.get());
+  s3Adaptors_[fsInfo.fsid()] = std::make_pair(signature, s3Adaptor);
+  LOG(INFO) << "Create s3 adaptor for clean, fsId = " << fsInfo.fsid()
+            << ", bucket = " << s3Info.bucketname();
+  return s3Adaptor;
+}
+
+void CleanExecutor::ReinitS3Adaptor(const S3Info& s3Info,
+                                    S3ClientAdaptor* s3Adaptor) {
+  S3ClientAdaptorOption clientAdaptorOption;
+  s3Adaptor->GetS3ClientAdaptorOption(&clientAdaptorOption);
+  clientAdaptorOption.blockSize = s3Info.blocksize();
+  clientAdaptorOption.chunkSize = s3Info.chunksize();
+  clientAdaptorOption.objectPrefix = s3Info.objectprefix();
+  s3Adaptor->Reinit(clientAdaptorOption, s3Info.ak(), s3Info.sk(),
+                    s3Info.endpoint(), s3Info.bucketname());
+}
+
+}  // namespace metaserver
+}  // namespace dingofs
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_METASERVER_CLEAN_EXECUTOR_H_
+#define DINGOFS_SRC_METASERVER_CLEAN_EXECUTOR_H_
+
+#include <bvar/bvar.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dingofs/mds.pb.h"
+#include "metaserver/s3/metaserver_s3_adaptor.h"
+#include "utils/configuration.h"
+#include "utils/leaky_bucket.h"
+
+namespace dingofs {
+namespace metaserver {
+
+struct CleanExecutorOption {
+  // number of worker threads, 0 means run tasks in the caller thread
+  uint32_t threadNum = 0;
+  // max number of inodes deleted in one batch
+  uint32_t batchSize = 1;
+  // max number of inodes deleted per second, 0 means no limit
+  uint64_t maxInodesPerSec = 0;
+  // create a s3 adaptor which is dedicated for one filesystem
+  std::function<std::shared_ptr<S3ClientAdaptor>()> newS3Adaptor;
+
+  void InitCleanExecutorOptionFromConf(
+      std::shared_ptr<utils::Configuration> conf);
+};
+
+// Executor shared by the trash, partition cleaner and recycle cleaner.
+//
+// Tasks with the same key (e.g. partition id) are queued in submission order
+// and executed one at a time, tasks with different keys are executed in
+// parallel and scheduled in round robin, so one huge partition can not
+// starve the others. A task MUST NOT wait for other tasks of the executor.
+class CleanExecutor {
+ public:
+  using Task = std::function<void()>;
+
+  CleanExecutor();
+
+  static CleanExecutor& GetInstance() {
+    static CleanExecutor instance_;
+    return instance_;
+  }
+
+  void Init(const CleanExecutorOption& option);
+
+  void Start();
+
+  void Stop();
+
+  void Submit(uint64_t key, Task task);
+
+  // Submit all tasks and wait them finished.
+  void SubmitAndWait(std::vector<std::pair<uint64_t, Task>> tasks);
+
+  // Block until the global rate limit allows to delete `ninodes` inodes.
+  void Throttle(uint64_t ninodes);
+
+  uint32_t BatchSize() const { return option_.batchSize; }
+
+  // Return the s3 adaptor for the filesystem. Reinit a shared adaptor is not
+  // thread safe, so each filesystem has its own adaptor which is only
+  // reinitialized when the s3 info changed. The `shared` adaptor is
+  // reinitialized and returned if no factory is provided.
+  std::shared_ptr<S3ClientAdaptor> GetS3Adaptor(
+      const pb::mds::FsInfo& fsInfo,
+      const std::shared_ptr<S3ClientAdaptor>& shared);
+
+ private:
+  void WorkerLoop();
+
+  static void ReinitS3Adaptor(const pb::common::S3Info& s3Info,
+                              S3ClientAdaptor* s3Adaptor);
+
+ private:
+  CleanExecutorOption option_;
+
+  bool running_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  // pending tasks of the queued or running keys
+  std::unordered_map<uint64_t, std::deque<Task>> queues_;
+  // keys which have pending tasks and are not running
+  std::deque<uint64_t> ready_;
+  std::vector<std::thread> workers_;
+
+  std::unique_ptr<utils::LeakyBucket> throttle_;
+
+  std::mutex s3Mutex_;
+  // fsId => (serialized s3 info, adaptor)
+  std::unordered_map<uint32_t,
+                     std::pair<std::string, std::shared_ptr<S3ClientAdaptor>>>
+      s3Adaptors_;
+
+  bvar::Adder<int64_t> pendingTasks_;
+  bvar::Adder<uint64_t> throttledInodes_;
+};
+
+}  // namespace metaserver
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_METASERVER_CLEAN_EXECUTOR_H_
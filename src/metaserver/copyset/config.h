@@ -88,6 +88,12 @@ struct CopysetNodeOptions {
   // Default: 1000
   uint32_t checkLoadMarginIntervalMs;
 
+  // the number of changes remembered for every partition, a subscriber
+  // which falls further behind is told to reset its caches, 0 disables
+  // the feed and nothing is recorded
+  // Default: 0
+  uint32_t changeFeedCapacity;
+
   // apply queue options
   ApplyQueueOption applyQueueOption;
 
@@ -111,6 +117,7 @@ inline CopysetNodeOptions::CopysetNodeOptions()
       checkRetryTimes(3),
       finishLoadMargin(2000),
       checkLoadMarginIntervalMs(1000),
+      changeFeedCapacity(0),
       applyQueueOption(),
       localFileSystem(nullptr),
       trashOptions(),
@@ -122,6 +122,8 @@ bool CopysetNode::Init(const CopysetNodeOptions& options) {
 
   epochFile_ = absl::make_unique<ConfEpochFile>(options_.localFileSystem);
 
+  changeFeed_.Init(options_.changeFeedCapacity);
+
   // init apply queue
   applyQueue_ = absl::make_unique<ApplyQueue>();
   options_.applyQueueOption.copysetNode = this;
@@ -425,6 +427,9 @@ int CopysetNode::on_snapshot_load(braft::SnapshotReader* reader) {
 
 void CopysetNode::on_leader_start(int64_t term) {
   leaderTerm_.store(term, std::memory_order_release);
+  // changes are only recorded by leader, the ones applied as follower
+  // are unknown to the feed
+  changeFeed_.Reset(GetAppliedIndex());
 
   LOG(INFO) << "Copyset: " << name_ << ", peer id: " << peerId_.to_string()
             << " become leader, term is " << term;
@@ -432,6 +437,7 @@ void CopysetNode::on_leader_start(int64_t term) {
 
 void CopysetNode::on_leader_stop(const butil::Status& status) {
   int64_t prevTerm = leaderTerm_.exchange(-1, std::memory_order_release);
+  changeFeed_.Reset(GetAppliedIndex());
 
   LOG(INFO) << "Copyset: " << name_ << ", peer id: " << peerId_.to_string()
             << " stepped down, previous term is " << prevTerm
@@ -31,6 +31,7 @@
 #include <memory>
 #include <string>
 
+#include "metaserver/change_feed.h"
 #include "metaserver/common/types.h"
 #include "metaserver/copyset/apply_queue.h"
 #include "metaserver/copyset/conf_epoch_file.h"
@@ -108,6 +109,8 @@ class CopysetNode : public braft::StateMachine {
 
   OperatorMetric* GetMetric() const;
 
+  ChangeFeed* GetChangeFeed() { return &changeFeed_; }
+
   const std::string& Name() const;
 
   int64_t LatestLoadSnapshotIndex() const;
@@ -230,6 +233,9 @@ class CopysetNode : public braft::StateMachine {
   std::unique_ptr<OperatorMetric> metric_;
 
   std::atomic<bool> isLoading_;
+
+  // changes applied since this node became leader
+  ChangeFeed changeFeed_;
 };
 
 inline void CopysetNode::Propose(const braft::Task& task) {
@@ -100,6 +100,8 @@ using pb::metaserver::UpdateVolumeExtentResponse;
 using pb::metaserver::MetaStatusCode;
 using pb::metaserver::VolumeExtentList;
 
+using ::dingofs::common::ChangeType;
+
 using common::StreamConnection;
 using storage::Iterator;
 using utils::TimeUtility;
@@ -168,6 +170,25 @@ void MetaOperator::FastApplyTask() {
   g_concurrent_fast_apply_wait_latency << timer.u_elapsed();
 }
 
+void MetaOperator::RecordChanges(int64_t index) {
+  // only leader serves the subscribers, see CopysetNode::on_leader_start()
+  auto* feed = node_->GetChangeFeed();
+  if (!feed->Enabled() || !node_->IsLeaderTerm()) {
+    return;
+  }
+
+  std::vector<ChangeRecord> changes;
+  CollectChanges(&changes);
+  if (changes.empty()) {
+    return;
+  }
+
+  for (auto& change : changes) {
+    change.index = index;
+  }
+  feed->Append(changes.front().partitionId, changes);
+}
+
 #define OPERATOR_CAN_BYPASS_PROPOSE(TYPE) \
   bool TYPE##Operator::CanBypassPropose() const { return false; }
 
@@ -238,6 +259,7 @@ bool GetVolumeExtentOperator::CanBypassPropose() const {
     node_->GetMetric()->ExecuteLatency(OperatorType::TYPE, executeTime);       \
     if (status == MetaStatusCode::OK) {                                        \
       node_->UpdateAppliedIndex(index);                                        \
+      RecordChanges(index);                                                    \
       static_cast<TYPE##Response*>(response_)->set_appliedindex(               \
           std::max<uint64_t>(index, node_->GetAppliedIndex()));                \
       node_->GetMetric()->OnOperatorComplete(                                  \
@@ -297,6 +319,7 @@ void GetOrModifyS3ChunkInfoOperator::OnApply(int64_t index,
     rc = metastore->GetOrModifyS3ChunkInfo(request, response, &iterator);
     if (rc == MetaStatusCode::OK) {
       node_->UpdateAppliedIndex(index);
+      RecordChanges(index);
       response->set_appliedindex(
           std::max<uint64_t>(index, node_->GetAppliedIndex()));
       node_->GetMetric()->OnOperatorComplete(
@@ -596,6 +619,74 @@ OPERATOR_TYPE(UpdateVolumeExtent);
 
 #undef OPERATOR_TYPE
 
+namespace {
+
+ChangeRecord MakeChange(uint32_t fsId, uint32_t partitionId, uint64_t inodeId,
+                        ChangeType type) {
+  // index is filled by MetaOperator::RecordChanges()
+  return ChangeRecord{0, fsId, partitionId, inodeId, type};
+}
+
+}  // namespace
+
+void CreateDentryOperator::CollectChanges(
+    std::vector<ChangeRecord>* changes) const {
+  const auto* request = static_cast<const CreateDentryRequest*>(request_);
+  changes->push_back(MakeChange(request->dentry().fsid(),
+                                request->partitionid(),
+                                request->dentry().parentinodeid(),
+                                ChangeType::kDentry));
+}
+
+void DeleteDentryOperator::CollectChanges(
+    std::vector<ChangeRecord>* changes) const {
+  const auto* request = static_cast<const DeleteDentryRequest*>(request_);
+  changes->push_back(MakeChange(request->fsid(), request->partitionid(),
+                                request->parentinodeid(), ChangeType::kDentry));
+}
+
+void UpdateInodeOperator::CollectChanges(
+    std::vector<ChangeRecord>* changes) const {
+  const auto* request = static_cast<const UpdateInodeRequest*>(request_);
+  changes->push_back(MakeChange(request->fsid(), request->partitionid(),
+                                request->inodeid(), ChangeType::kInode));
+}
+
+void GetOrModifyS3ChunkInfoOperator::CollectChanges(
+    std::vector<ChangeRecord>* changes) const {
+  const auto* request =
+      static_cast<const GetOrModifyS3ChunkInfoRequest*>(request_);
+  if (request->s3chunkinfoadd().empty() &&
+      request->s3chunkinforemove().empty()) {
+    return;
+  }
+  changes->push_back(MakeChange(request->fsid(), request->partitionid(),
+                                request->inodeid(), ChangeType::kInode));
+}
+
+void DeleteInodeOperator::CollectChanges(
+    std::vector<ChangeRecord>* changes) const {
+  const auto* request = static_cast<const DeleteInodeRequest*>(request_);
+  changes->push_back(MakeChange(request->fsid(), request->partitionid(),
+                                request->inodeid(), ChangeType::kDelete));
+}
+
+void PrepareRenameTxOperator::CollectChanges(
+    std::vector<ChangeRecord>* changes) const {
+  const auto* request = static_cast<const PrepareRenameTxRequest*>(request_);
+  for (const auto& dentry : request->dentrys()) {
+    changes->push_back(MakeChange(dentry.fsid(), request->partitionid(),
+                                  dentry.parentinodeid(), ChangeType::kDentry));
+  }
+}
+
+void UpdateVolumeExtentOperator::CollectChanges(
+    std::vector<ChangeRecord>* changes) const {
+  const auto* request = static_cast<const UpdateVolumeExtentRequest*>(request_);
+  changes->push_back(MakeChange(request->fsid(), request->partitionid(),
+                                request->inodeid(), ChangeType::kInode));
+}
+
 }  // namespace copyset
 }  // namespace metaserver
 }  // namespace dingofs
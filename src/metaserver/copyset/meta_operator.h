@@ -26,7 +26,10 @@
 #include <brpc/controller.h>
 #include <google/protobuf/message.h>
 
+#include <vector>
+
 #include "dingofs/metaserver.pb.h"
+#include "common/change_record.h"
 #include "common/rpc_stream.h"
 #include "metaserver/copyset/copyset_node.h"
 #include "metaserver/copyset/operator_type.h"
@@ -35,6 +38,8 @@ namespace dingofs {
 namespace metaserver {
 namespace copyset {
 
+using ::dingofs::common::ChangeRecord;
+
 class MetaOperator {
  public:
   MetaOperator(CopysetNode* node, google::protobuf::RpcController* cntl,
@@ -134,7 +139,19 @@ class MetaOperator {
    */
   virtual bool CanBypassPropose() const { return false; }
 
+  /**
+   * @brief Collect the changes which subscribers of partition should know,
+   *        only the operators which modify the metadata have changes
+   */
+  virtual void CollectChanges(std::vector<ChangeRecord>* changes) const {}
+
  protected:
+  /**
+   * @brief Append the changes of current operator to the change feed,
+   *        called after the operator applied successfully
+   */
+  void RecordChanges(int64_t index);
+
   CopysetNode* node_;
 
   // rpc controller
@@ -246,6 +263,8 @@ class CreateDentryOperator : public MetaOperator {
   void Redirect() override;
 
   void OnFailed(pb::metaserver::MetaStatusCode code) override;
+
+  void CollectChanges(std::vector<ChangeRecord>* changes) const override;
 };
 
 class DeleteDentryOperator : public MetaOperator {
@@ -265,6 +284,8 @@ class DeleteDentryOperator : public MetaOperator {
   void Redirect() override;
 
   void OnFailed(pb::metaserver::MetaStatusCode code) override;
+
+  void CollectChanges(std::vector<ChangeRecord>* changes) const override;
 };
 
 class GetInodeOperator : public MetaOperator {
@@ -366,6 +387,8 @@ class UpdateInodeOperator : public MetaOperator {
   void Redirect() override;
 
   void OnFailed(pb::metaserver::MetaStatusCode code) override;
+
+  void CollectChanges(std::vector<ChangeRecord>* changes) const override;
 };
 
 class GetOrModifyS3ChunkInfoOperator : public MetaOperator {
@@ -385,6 +408,8 @@ class GetOrModifyS3ChunkInfoOperator : public MetaOperator {
   void Redirect() override;
 
   void OnFailed(pb::metaserver::MetaStatusCode code) override;
+
+  void CollectChanges(std::vector<ChangeRecord>* changes) const override;
 };
 
 class DeleteInodeOperator : public MetaOperator {
@@ -404,6 +429,8 @@ class DeleteInodeOperator : public MetaOperator {
   void Redirect() override;
 
   void OnFailed(pb::metaserver::MetaStatusCode code) override;
+
+  void CollectChanges(std::vector<ChangeRecord>* changes) const override;
 };
 
 class CreateRootInodeOperator : public MetaOperator {
@@ -518,6 +545,8 @@ class PrepareRenameTxOperator : public MetaOperator {
   void Redirect() override;
 
   void OnFailed(pb::metaserver::MetaStatusCode code) override;
+
+  void CollectChanges(std::vector<ChangeRecord>* changes) const override;
 };
 
 class GetVolumeExtentOperator : public MetaOperator {
@@ -558,6 +587,8 @@ class UpdateVolumeExtentOperator : public MetaOperator {
   void Redirect() override;
 
   void OnFailed(pb::metaserver::MetaStatusCode code) override;
+
+  void CollectChanges(std::vector<ChangeRecord>* changes) const override;
 };
 
 }  // namespace copyset
@@ -60,6 +60,10 @@ void DentryManager::Log4Code(const std::string& request, MetaStatusCode rc) {
 
 MetaStatusCode DentryManager::CreateDentry(const Dentry& dentry) {
   Log4Dentry("CreateDentry", dentry);
+  if (txManager_->IsLocked(dentry)) {
+    Log4Code("CreateDentry", MetaStatusCode::HANDLE_PENDING_TX_FAILED);
+    return MetaStatusCode::HANDLE_PENDING_TX_FAILED;
+  }
   MetaStatusCode rc = dentryStorage_->Insert(dentry);
   Log4Code("CreateDentry", rc);
   return rc;
@@ -76,6 +80,10 @@ MetaStatusCode DentryManager::CreateDentry(const pb::metaserver::DentryVec& vec,
 
 MetaStatusCode DentryManager::DeleteDentry(const Dentry& dentry) {
   Log4Dentry("DeleteDentry", dentry);
+  if (txManager_->IsLocked(dentry)) {
+    Log4Code("DeleteDentry", MetaStatusCode::HANDLE_PENDING_TX_FAILED);
+    return MetaStatusCode::HANDLE_PENDING_TX_FAILED;
+  }
   MetaStatusCode rc = dentryStorage_->Delete(dentry);
   Log4Code("DeleteDentry", rc);
   return rc;
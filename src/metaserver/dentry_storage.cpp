@@ -24,6 +24,7 @@
 
 #include <butil/time.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <vector>
@@ -155,13 +156,49 @@ DentryStorage::DentryStorage(std::shared_ptr<KVStorage> kvStorage,
     : kvStorage_(kvStorage),
       table4Dentry_(nameGenerator->GetDentryTableName()),
       nDentry_(nDentry),
-      conv_() {}
+      conv_(),
+      rowCache_(nullptr),
+      cacheTableId_(storage::NewRowCacheTableId()) {
+  if (kvStorage_->Type() == KVStorage::STORAGE_TYPE::ROCKSDB_STORAGE &&
+      storage::GetDentryRowCache()->Enabled()) {
+    rowCache_ = storage::GetDentryRowCache();
+  }
+}
 
 std::string DentryStorage::DentryKey(const pb::metaserver::Dentry& dentry) {
   Key4Dentry key(dentry.fsid(), dentry.parentinodeid(), dentry.name());
   return conv_.SerializeToString(key);
 }
 
+Status DentryStorage::GetDentryVec(const std::string& skey, DentryVec* vec) {
+  std::string ckey;
+  storage::DentryRowCache::ValueType cached;
+  if (rowCache_ != nullptr) {
+    ckey = storage::RowCacheKey(cacheTableId_, skey);
+    if (rowCache_->Get(ckey, &cached)) {
+      *vec = *cached;
+      return Status::OK();
+    }
+  }
+
+  Status s = kvStorage_->SGet(table4Dentry_, skey, vec);
+  if (s.ok() && rowCache_ != nullptr) {
+    rowCache_->Put(ckey, std::make_shared<DentryVec>(*vec));
+  }
+  return s;
+}
+
+void DentryStorage::EraseCache(const std::string& skey) {
+  if (rowCache_ != nullptr) {
+    rowCache_->Remove(storage::RowCacheKey(cacheTableId_, skey));
+  }
+}
+
+void DentryStorage::InvalidateCache() {
+  WriteLockGuard lg(rwLock_);
+  cacheTableId_ = storage::NewRowCacheTableId();
+}
+
 bool DentryStorage::CompressDentry(DentryVec* vec, BTree* dentrys) {
   DentryVector vector(vec);
   std::vector<pb::metaserver::Dentry> deleted;
@@ -182,6 +219,7 @@ bool DentryStorage::CompressDentry(DentryVec* vec, BTree* dentrys) {
   } else {
     s = kvStorage_->SSet(table4Dentry_, skey, *vec);
   }
+  EraseCache(skey);
 
   if (s.ok()) {
     vector.Confirm(&nDentry_);
@@ -196,7 +234,7 @@ MetaStatusCode DentryStorage::Find(const pb::metaserver::Dentry& in,
                                    pb::metaserver::Dentry* out, DentryVec* vec,
                                    bool compress) {
   std::string skey = DentryKey(in);
-  Status s = kvStorage_->SGet(table4Dentry_, skey, vec);
+  Status s = GetDentryVec(skey, vec);
   if (s.IsNotFound()) {
     return MetaStatusCode::NOT_FOUND;
   } else if (!s.ok()) {
@@ -250,6 +288,7 @@ MetaStatusCode DentryStorage::Insert(const pb::metaserver::Dentry& dentry) {
   vector.Insert(dentry);
   std::string skey = DentryKey(dentry);
   Status s = kvStorage_->SSet(table4Dentry_, skey, vec);
+  EraseCache(skey);
   if (!s.ok()) {
     LOG(ERROR) << "Insert dentry failed, status = " << s.ToString();
     return MetaStatusCode::STORAGE_INTERNAL_ERROR;
@@ -276,6 +315,7 @@ MetaStatusCode DentryStorage::Insert(const DentryVec& vec, bool merge) {
   DentryVector vector(&oldVec);
   vector.Merge(vec);
   s = kvStorage_->SSet(table4Dentry_, skey, oldVec);
+  EraseCache(skey);
   if (!s.ok()) {
     LOG(ERROR) << "Insert dentry vector failed, status = " << s.ToString();
     return MetaStatusCode::STORAGE_INTERNAL_ERROR;
@@ -305,6 +345,7 @@ MetaStatusCode DentryStorage::Delete(const pb::metaserver::Dentry& dentry) {
   } else {
     s = kvStorage_->SSet(table4Dentry_, skey, vec);
   }
+  EraseCache(skey);
 
   if (s.ok()) {
     vector.Confirm(&nDentry_);
@@ -400,7 +441,7 @@ MetaStatusCode DentryStorage::HandleTx(TX_OP_TYPE type,
   MetaStatusCode rc = MetaStatusCode::OK;
   switch (type) {
     case TX_OP_TYPE::PREPARE:
-      s = kvStorage_->SGet(table4Dentry_, skey, &vec);
+      s = GetDentryVec(skey, &vec);
       if (!s.ok() && !s.IsNotFound()) {
         rc = MetaStatusCode::STORAGE_INTERNAL_ERROR;
         break;
@@ -409,6 +450,7 @@ MetaStatusCode DentryStorage::HandleTx(TX_OP_TYPE type,
       // OK || NOT_FOUND
       vector.Insert(dentry);
       s = kvStorage_->SSet(table4Dentry_, skey, vec);
+      EraseCache(skey);
       if (!s.ok()) {
         rc = MetaStatusCode::STORAGE_INTERNAL_ERROR;
       } else {
@@ -424,7 +466,7 @@ MetaStatusCode DentryStorage::HandleTx(TX_OP_TYPE type,
       break;
 
     case TX_OP_TYPE::ROLLBACK:
-      s = kvStorage_->SGet(table4Dentry_, skey, &vec);
+      s = GetDentryVec(skey, &vec);
       if (!s.ok() && !s.IsNotFound()) {
         rc = MetaStatusCode::STORAGE_INTERNAL_ERROR;
         break;
@@ -437,12 +479,63 @@ MetaStatusCode DentryStorage::HandleTx(TX_OP_TYPE type,
       } else {
         s = kvStorage_->SSet(table4Dentry_, skey, vec);
       }
+      EraseCache(skey);
+      if (!s.ok()) {
+        rc = MetaStatusCode::STORAGE_INTERNAL_ERROR;
+      } else {
+        vector.Confirm(&nDentry_);
+      }
+      break;
+
+    // replace all versions of the name with the dentry, the version keeps
+    // the largest txid so it is visible to whom can see the replaced ones
+    case TX_OP_TYPE::APPLY: {
+      s = GetDentryVec(skey, &vec);
+      if (!s.ok() && !s.IsNotFound()) {
+        rc = MetaStatusCode::STORAGE_INTERNAL_ERROR;
+        break;
+      }
+
+      // OK || NOT_FOUND
+      pb::metaserver::Dentry latest(dentry);
+      std::vector<pb::metaserver::Dentry> versions{vec.dentrys().begin(),
+                                                   vec.dentrys().end()};
+      // only the expected dentry can be removed, the name may be
+      // created again after the transaction checked it
+      if (HasDeleteMarkFlag(dentry)) {
+        const pb::metaserver::Dentry* current = nullptr;
+        for (const auto& item : versions) {
+          if (current == nullptr || item.txid() > current->txid()) {
+            current = &item;
+          }
+        }
+        if (current == nullptr || HasDeleteMarkFlag(*current) ||
+            current->inodeid() != dentry.inodeid()) {
+          rc = MetaStatusCode::NOT_FOUND;
+          break;
+        }
+      }
+
+      for (const auto& item : versions) {
+        latest.set_txid(std::max(latest.txid(), item.txid()));
+        vector.Delete(item);
+      }
+
+      if (HasDeleteMarkFlag(latest)) {
+        s = kvStorage_->SDel(table4Dentry_, skey);
+      } else {
+        latest.set_flag(latest.flag() & ~DentryFlag::TRANSACTION_PREPARE_FLAG);
+        vector.Insert(latest);
+        s = kvStorage_->SSet(table4Dentry_, skey, vec);
+      }
+      EraseCache(skey);
       if (!s.ok()) {
         rc = MetaStatusCode::STORAGE_INTERNAL_ERROR;
       } else {
         vector.Confirm(&nDentry_);
       }
       break;
+    }
 
     default:
       rc = MetaStatusCode::PARAM_ERROR;
@@ -480,6 +573,7 @@ bool DentryStorage::Empty() {
 MetaStatusCode DentryStorage::Clear() {
   WriteLockGuard lg(rwLock_);
   Status s = kvStorage_->SClear(table4Dentry_);
+  cacheTableId_ = storage::NewRowCacheTableId();
   if (!s.ok()) {
     LOG(ERROR) << "failed to clear dentry table, status = " << s.ToString();
     return MetaStatusCode::STORAGE_INTERNAL_ERROR;
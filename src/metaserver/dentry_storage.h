@@ -30,6 +30,7 @@
 #include "absl/container/btree_set.h"
 #include "dingofs/metaserver.pb.h"
 #include "metaserver/storage/converter.h"
+#include "metaserver/storage/row_cache.h"
 #include "metaserver/storage/storage.h"
 #include "utils/concurrent/concurrent.h"
 
@@ -107,6 +108,8 @@ class DentryStorage {
     PREPARE,
     COMMIT,
     ROLLBACK,
+    // apply the dentry of sharded rename transaction
+    APPLY,
   };
 
  public:
@@ -140,9 +143,19 @@ class DentryStorage {
 
   pb::metaserver::MetaStatusCode Clear();
 
+  // drop all cached dentry vectors, it should be invoked after the underlying
+  // storage changed out of DentryStorage (e.g. recover from raft snapshot)
+  void InvalidateCache();
+
  private:
   std::string DentryKey(const pb::metaserver::Dentry& entry);
 
+  // get dentry vector from row cache first, the caller should hold the rwLock_
+  storage::Status GetDentryVec(const std::string& skey,
+                               pb::metaserver::DentryVec* vec);
+
+  void EraseCache(const std::string& skey);
+
   bool CompressDentry(pb::metaserver::DentryVec* vec, BTree* dentrys);
 
   pb::metaserver::MetaStatusCode Find(const pb::metaserver::Dentry& in,
@@ -156,6 +169,9 @@ class DentryStorage {
   std::string table4Dentry_;
   uint64_t nDentry_;
   storage::Converter conv_;
+  // only for rocksdb storage
+  storage::DentryRowCache* rowCache_;
+  uint64_t cacheTableId_;
 };
 
 }  // namespace metaserver
@@ -25,10 +25,13 @@
 #include <braft/closure_helper.h>
 #include <brpc/channel.h>
 #include <brpc/controller.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include <sys/statvfs.h>
 #include <sys/time.h>
 #include <unistd.h>
 
+#include <functional>
 #include <utility>
 
 #include "dingofs/common.pb.h"
@@ -42,6 +45,7 @@ namespace dingofs {
 namespace metaserver {
 
 using copyset::CopysetNode;
+using metaserver::copyset::ToGroupId;
 using metaserver::copyset::ToGroupIdString;
 
 using pb::common::Peer;
@@ -82,6 +86,19 @@ Peer EndPointToPeer(const butil::EndPoint& ep) {
   return peer;
 }
 
+// the partition info contains map fields, serialize it deterministically
+// so that an unchanged copyset always has the same signature
+size_t CopysetSignature(const pb::mds::heartbeat::CopySetInfo& info) {
+  std::string data;
+  {
+    google::protobuf::io::StringOutputStream output(&data);
+    google::protobuf::io::CodedOutputStream coded(&output);
+    coded.SetSerializationDeterministic(true);
+    info.SerializeToCodedStream(&coded);
+  }
+  return std::hash<std::string>()(data);
+}
+
 }  // namespace
 
 int Heartbeat::Init(const HeartbeatOptions& options) {
@@ -138,6 +155,10 @@ int Heartbeat::Init(const HeartbeatOptions& options) {
 
   taskExecutor_ = std::make_unique<HeartbeatTaskExecutor>(copysetMan_, msEp_);
 
+  LOG(INFO) << "Heartbeat deltaReport: " << options_.deltaReport
+            << ", fullReportIntervalSec: " << options_.fullReportIntervalSec;
+  ResetReported();
+
   return 0;
 }
 
@@ -258,19 +279,20 @@ int Heartbeat::BuildRequest(HeartbeatRequest* req) {
   std::vector<CopysetNode*> copysets;
   copysetMan_->GetAllCopysets(&copysets);
 
+  // copysetcount is always the number of all copysets, mds knows it's a
+  // delta report if fewer copysets are included
   req->set_copysetcount(copysets.size());
   int leaders = 0;
 
-  for (auto* copyset : copysets) {
-    pb::mds::heartbeat::CopySetInfo* info = req->add_copysetinfos();
-
-    BuildCopysetInfo(info, copyset);
-
-    if (copyset->IsLeaderTerm()) {
+  std::vector<pb::mds::heartbeat::CopySetInfo> infos(copysets.size());
+  for (size_t i = 0; i < copysets.size(); i++) {
+    BuildCopysetInfo(&infos[i], copysets[i]);
+    if (copysets[i]->IsLeaderTerm()) {
       ++leaders;
     }
   }
   req->set_leadercount(leaders);
+  AddCopysetInfos(&infos, req);
 
   MetaServerSpaceStatus* status = req->mutable_spacestatus();
   if (!GetMetaserverSpaceStatus(status, copysets.size())) {
@@ -281,6 +303,48 @@ int Heartbeat::BuildRequest(HeartbeatRequest* req) {
   return 0;
 }
 
+void Heartbeat::AddCopysetInfos(
+    std::vector<pb::mds::heartbeat::CopySetInfo>* infos,
+    HeartbeatRequest* req) {
+  uint64_t now = utils::TimeUtility::GetTimeofDaySec();
+  fullReporting_ = !options_.deltaReport || reported_.empty() ||
+                   now >= lastFullReportSec_ + options_.fullReportIntervalSec;
+  reporting_.clear();
+  for (auto& info : *infos) {
+    uint64_t group_id = ToGroupId(info.poolid(), info.copysetid());
+    size_t signature = CopysetSignature(info);
+    reporting_.emplace(group_id, signature);
+
+    // copysets under configuration change or loading are always reported,
+    // mds drives the operators according to them
+    auto iter = reported_.find(group_id);
+    if (fullReporting_ || iter == reported_.end() ||
+        iter->second != signature || info.has_configchangeinfo() ||
+        info.iscopysetloading()) {
+      req->add_copysetinfos()->Swap(&info);
+    }
+  }
+
+  if (!fullReporting_) {
+    VLOG(3) << "delta heartbeat reports " << req->copysetinfos_size()
+            << " of " << infos->size() << " copysets";
+  }
+}
+
+void Heartbeat::AckRequest() {
+  reported_.swap(reporting_);
+  reporting_.clear();
+  if (fullReporting_) {
+    lastFullReportSec_ = utils::TimeUtility::GetTimeofDaySec();
+  }
+}
+
+void Heartbeat::ResetReported() {
+  reported_.clear();
+  reporting_.clear();
+  lastFullReportSec_ = 0;
+}
+
 void Heartbeat::DumpHeartbeatRequest(const HeartbeatRequest& request) {
   VLOG(6) << "Heartbeat request: Metaserver ID: " << request.metaserverid()
           << ", IP = " << request.ip() << ", port = " << request.port()
@@ -391,11 +455,21 @@ void Heartbeat::HeartbeatWorker() {
     VLOG(3) << "sending heartbeat info";
     ret = SendHeartbeat(req, &resp);
     if (ret != 0) {
+      // the mds may be switched or restarted, report all copysets again
       LOG(WARNING) << "Failed to send heartbeat to MDS";
+      ResetReported();
       ::sleep(error_interval_sec);
       continue;
     }
 
+    // the mds which is restarted or newly elected asks for a full report by
+    // rejecting the delta one
+    if (resp.statuscode() == pb::mds::heartbeat::HeartbeatStatusCode::hbOK) {
+      AckRequest();
+    } else {
+      ResetReported();
+    }
+
     taskExecutor_->ExecTasks(resp);
     waitInterval_.WaitForNextExcution();
   }
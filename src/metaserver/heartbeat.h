@@ -29,6 +29,7 @@
 #include <atomic>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "dingofs/heartbeat.pb.h"
@@ -56,6 +57,10 @@ struct HeartbeatOptions {
   copyset::CopysetNodeManager* copysetNodeManager;
   ResourceCollector* resourceCollector;
   std::shared_ptr<fs::LocalFileSystem> fs;
+  // only report the copysets changed since the last heartbeat acknowledged
+  bool deltaReport = false;
+  // report all copysets every fullReportIntervalSec in delta mode
+  uint32_t fullReportIntervalSec = 300;
 };
 
 class HeartbeatTaskExecutor;
@@ -104,6 +109,24 @@ class Heartbeat {
 
   int BuildRequest(pb::mds::heartbeat::MetaServerHeartbeatRequest* request);
 
+  /*
+   * add the copysets which need to be reported to request, they are all
+   * copysets in full report, or the changed ones in delta report
+   */
+  void AddCopysetInfos(std::vector<pb::mds::heartbeat::CopySetInfo>* infos,
+                       pb::mds::heartbeat::MetaServerHeartbeatRequest* request);
+
+  /*
+   * the reported copysets are acknowledged by mds, the next request only
+   * includes the copysets changed since then in delta mode
+   */
+  void AckRequest();
+
+  /*
+   * report all copysets in the next request
+   */
+  void ResetReported();
+
   int SendHeartbeat(
       const pb::mds::heartbeat::MetaServerHeartbeatRequest& request,
       pb::mds::heartbeat::MetaServerHeartbeatResponse* response);
@@ -151,6 +174,13 @@ class Heartbeat {
   uint64_t startUpTime_;
 
   std::unique_ptr<HeartbeatTaskExecutor> taskExecutor_;
+
+  // signature of copysets acknowledged by mds, indexed by group id
+  std::unordered_map<uint64_t, size_t> reported_;
+  // signature of copysets in the request being sent
+  std::unordered_map<uint64_t, size_t> reporting_;
+  bool fullReporting_ = false;
+  uint64_t lastFullReportSec_ = 0;
 };
 
 // execute tasks from heartbeat response
@@ -349,7 +349,10 @@ MetaStatusCode InodeManager::UpdateInode(
   }
 
   if (needUpdate) {
-    ret = inodeStorage_->Update(old);
+    // the unlinked inode is added into trash in the same transaction,
+    // so it will never be leaked even if the metaserver crashed
+    ret = needAddTrash ? inodeStorage_->UpdateAndAddTrashItem(old)
+                       : inodeStorage_->Update(old);
     if (ret != MetaStatusCode::OK) {
       LOG(ERROR) << "UpdateInode fail, " << request.ShortDebugString()
                  << ", ret: " << MetaStatusCode_Name(ret);
@@ -358,7 +361,6 @@ MetaStatusCode InodeManager::UpdateInode(
   }
 
   if (needAddTrash) {
-    trash_->Add(old.fsid(), old.inodeid(), old.dtime());
     --(*type2InodeNum_)[old.type()];
   }
 
@@ -589,5 +591,27 @@ MetaStatusCode InodeManager::GetVolumeExtent(
   return MetaStatusCode::OK;
 }
 
+bool InodeManager::GetAllInodeS3MetaSize(
+    std::unordered_map<uint64_t, uint64_t>* sizes) {
+  return inodeStorage_->GetAllInodeS3MetaSize(sizes);
+}
+
+void InodeManager::RecordS3ChunkInfoRead(uint64_t inodeId) {
+  std::lock_guard<std::mutex> lk(readsMutex_);
+  auto iter = s3ChunkInfoReads_.find(inodeId);
+  if (iter != s3ChunkInfoReads_.end()) {
+    iter->second++;
+  } else if (s3ChunkInfoReads_.size() < kMaxS3ChunkInfoReads) {
+    s3ChunkInfoReads_.emplace(inodeId, 1);
+  }
+}
+
+std::unordered_map<uint64_t, uint64_t> InodeManager::TakeS3ChunkInfoReads() {
+  std::unordered_map<uint64_t, uint64_t> reads;
+  std::lock_guard<std::mutex> lk(readsMutex_);
+  reads.swap(s3ChunkInfoReads_);
+  return reads;
+}
+
 }  // namespace metaserver
 }  // namespace dingofs
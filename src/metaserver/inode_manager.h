@@ -25,7 +25,9 @@
 
 #include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "absl/types/optional.h"
@@ -120,6 +122,17 @@ class InodeManager {
       uint32_t fsId, uint64_t inodeId, const std::vector<uint64_t>& slices,
       pb::metaserver::VolumeExtentList* extents);
 
+  // Get the number of s3chunkinfos of all inodes without padding them,
+  // the inodes without s3chunkinfo are absent.
+  bool GetAllInodeS3MetaSize(std::unordered_map<uint64_t, uint64_t>* sizes);
+
+  // Record one read of inode's s3chunkinfo from client, s3 compaction uses
+  // the read counts to compact the most read amplified inodes first.
+  void RecordS3ChunkInfoRead(uint64_t inodeId);
+
+  // Return the read counts recorded since last call and reset them.
+  std::unordered_map<uint64_t, uint64_t> TakeS3ChunkInfoReads();
+
  private:
   void GenerateInodeInternal(uint64_t inodeId, const InodeParam& param,
                              pb::metaserver::Inode* inode);
@@ -139,6 +152,12 @@ class InodeManager {
   FileType2InodeNumMap* type2InodeNum_;
 
   utils::NameLock inodeLock_;
+
+  // bound the memory of read counts, reads of new inodes are ignored
+  // when it is full until next compaction round takes them
+  static constexpr size_t kMaxS3ChunkInfoReads = 65536;
+  std::mutex readsMutex_;
+  std::unordered_map<uint64_t, uint64_t> s3ChunkInfoReads_;
 };
 
 }  // namespace metaserver
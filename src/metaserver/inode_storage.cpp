@@ -22,6 +22,8 @@
 
 #include "metaserver/inode_storage.h"
 
+#include <google/protobuf/empty.pb.h>
+
 #include <limits>
 #include <memory>
 #include <string>
@@ -44,6 +46,7 @@ using storage::Iterator;
 using storage::Key4Inode;
 using storage::Key4InodeAuxInfo;
 using storage::Key4S3ChunkInfoList;
+using storage::Key4TrashItem;
 using storage::Key4VolumeExtentSlice;
 using storage::KVStorage;
 using storage::NameGenerator;
@@ -57,6 +60,8 @@ using storage::StorageTransaction;
 using pb::metaserver::Inode;
 using pb::metaserver::MetaStatusCode;
 
+static const char* const kTrashMigratedKey = "trash_migrated";
+
 InodeStorage::InodeStorage(std::shared_ptr<KVStorage> kvStorage,
                            std::shared_ptr<NameGenerator> nameGenerator,
                            uint64_t nInode)
@@ -65,8 +70,81 @@ InodeStorage::InodeStorage(std::shared_ptr<KVStorage> kvStorage,
       table4S3ChunkInfo_(nameGenerator->GetS3ChunkInfoTableName()),
       table4VolumeExtent_(nameGenerator->GetVolumeExtentTableName()),
       table4InodeAuxInfo_(nameGenerator->GetInodeAuxInfoTableName()),
+      table4TrashItem_(nameGenerator->GetTrashItemTableName()),
       nInode_(nInode),
-      conv_() {}
+      conv_(),
+      rowCache_(nullptr),
+      cacheTableId_(storage::NewRowCacheTableId()) {
+  if (kvStorage_->Type() == KVStorage::STORAGE_TYPE::ROCKSDB_STORAGE &&
+      storage::GetInodeRowCache()->Enabled()) {
+    rowCache_ = storage::GetInodeRowCache();
+  }
+}
+
+void InodeStorage::FillAttr(const Inode& inode,
+                            pb::metaserver::InodeAttr* attr) {
+  attr->set_inodeid(inode.inodeid());
+  attr->set_fsid(inode.fsid());
+  attr->set_length(inode.length());
+  attr->set_ctime(inode.ctime());
+  attr->set_ctime_ns(inode.ctime_ns());
+  attr->set_mtime(inode.mtime());
+  attr->set_mtime_ns(inode.mtime_ns());
+  attr->set_atime(inode.atime());
+  attr->set_atime_ns(inode.atime_ns());
+  attr->set_uid(inode.uid());
+  attr->set_gid(inode.gid());
+  attr->set_mode(inode.mode());
+  attr->set_nlink(inode.nlink());
+  attr->set_type(inode.type());
+  *(attr->mutable_parent()) = inode.parent();
+  if (inode.has_symlink()) {
+    attr->set_symlink(inode.symlink());
+  }
+  if (inode.has_rdev()) {
+    attr->set_rdev(inode.rdev());
+  }
+  if (inode.has_dtime()) {
+    attr->set_dtime(inode.dtime());
+  }
+  if (inode.xattr_size() > 0) {
+    *(attr->mutable_xattr()) = inode.xattr();
+  }
+}
+
+Status InodeStorage::GetInodeAttr(const std::string& skey,
+                                  storage::InodeRowCache::ValueType* attr) {
+  std::string ckey;
+  if (rowCache_ != nullptr) {
+    ckey = storage::RowCacheKey(cacheTableId_, skey);
+    if (rowCache_->Get(ckey, attr)) {
+      return Status::OK();
+    }
+  }
+
+  Inode inode;
+  Status s = kvStorage_->HGet(table4Inode_, skey, &inode);
+  if (s.ok()) {
+    auto out = std::make_shared<pb::metaserver::InodeAttr>();
+    FillAttr(inode, out.get());
+    if (rowCache_ != nullptr) {
+      rowCache_->Put(ckey, out);
+    }
+    *attr = std::move(out);
+  }
+  return s;
+}
+
+void InodeStorage::EraseCache(const std::string& skey) {
+  if (rowCache_ != nullptr) {
+    rowCache_->Remove(storage::RowCacheKey(cacheTableId_, skey));
+  }
+}
+
+void InodeStorage::InvalidateCache() {
+  WriteLockGuard lg(rwLock_);
+  cacheTableId_ = storage::NewRowCacheTableId();
+}
 
 MetaStatusCode InodeStorage::Insert(const Inode& inode) {
   WriteLockGuard lg(rwLock_);
@@ -85,6 +163,7 @@ MetaStatusCode InodeStorage::Insert(const Inode& inode) {
 
   // key not found
   s = kvStorage_->HSet(table4Inode_, skey, inode);
+  EraseCache(skey);
   if (s.ok()) {
     nInode_++;
     return MetaStatusCode::OK;
@@ -112,60 +191,33 @@ MetaStatusCode InodeStorage::Get(const Key4Inode& key, Inode* inode) {
 MetaStatusCode InodeStorage::GetAttr(const Key4Inode& key,
                                      pb::metaserver::InodeAttr* attr) {
   ReadLockGuard lg(rwLock_);
-  Inode inode;
+  storage::InodeRowCache::ValueType out;
   std::string skey = conv_.SerializeToString(key);
-  Status s = kvStorage_->HGet(table4Inode_, skey, &inode);
+  Status s = GetInodeAttr(skey, &out);
   if (s.IsNotFound()) {
     return MetaStatusCode::NOT_FOUND;
   } else if (!s.ok()) {
     return MetaStatusCode::STORAGE_INTERNAL_ERROR;
   }
 
-  // get attr from inode
-  attr->set_inodeid(inode.inodeid());
-  attr->set_fsid(inode.fsid());
-  attr->set_length(inode.length());
-  attr->set_ctime(inode.ctime());
-  attr->set_ctime_ns(inode.ctime_ns());
-  attr->set_mtime(inode.mtime());
-  attr->set_mtime_ns(inode.mtime_ns());
-  attr->set_atime(inode.atime());
-  attr->set_atime_ns(inode.atime_ns());
-  attr->set_uid(inode.uid());
-  attr->set_gid(inode.gid());
-  attr->set_mode(inode.mode());
-  attr->set_nlink(inode.nlink());
-  attr->set_type(inode.type());
-  *(attr->mutable_parent()) = inode.parent();
-  if (inode.has_symlink()) {
-    attr->set_symlink(inode.symlink());
-  }
-  if (inode.has_rdev()) {
-    attr->set_rdev(inode.rdev());
-  }
-  if (inode.has_dtime()) {
-    attr->set_dtime(inode.dtime());
-  }
-  if (inode.xattr_size() > 0) {
-    *(attr->mutable_xattr()) = inode.xattr();
-  }
+  *attr = *out;
   return MetaStatusCode::OK;
 }
 
 MetaStatusCode InodeStorage::GetXAttr(const Key4Inode& key,
                                       pb::metaserver::XAttr* xattr) {
   ReadLockGuard lg(rwLock_);
-  Inode inode;
+  storage::InodeRowCache::ValueType attr;
   std::string skey = conv_.SerializeToString(key);
-  Status s = kvStorage_->HGet(table4Inode_, skey, &inode);
+  Status s = GetInodeAttr(skey, &attr);
   if (s.IsNotFound()) {
     return MetaStatusCode::NOT_FOUND;
   } else if (!s.ok()) {
     return MetaStatusCode::STORAGE_INTERNAL_ERROR;
   }
 
-  if (!inode.xattr().empty()) {
-    *(xattr->mutable_xattrinfos()) = inode.xattr();
+  if (!attr->xattr().empty()) {
+    *(xattr->mutable_xattrinfos()) = attr->xattr();
   }
   return MetaStatusCode::OK;
 }
@@ -174,6 +226,7 @@ MetaStatusCode InodeStorage::Delete(const Key4Inode& key) {
   WriteLockGuard lg(rwLock_);
   std::string skey = conv_.SerializeToString(key);
   Status s = kvStorage_->HDel(table4Inode_, skey);
+  EraseCache(skey);
   if (s.ok()) {
     // NOTE: for rocksdb storage, it will never check whether
     // the key exist in delete(), so if the client delete the
@@ -194,12 +247,138 @@ MetaStatusCode InodeStorage::Update(const Inode& inode) {
   std::string skey = conv_.SerializeToString(key);
 
   Status s = kvStorage_->HSet(table4Inode_, skey, inode);
+  EraseCache(skey);
   if (s.ok()) {
     return MetaStatusCode::OK;
   }
   return MetaStatusCode::STORAGE_INTERNAL_ERROR;
 }
 
+MetaStatusCode InodeStorage::UpdateAndAddTrashItem(const Inode& inode) {
+  WriteLockGuard lg(rwLock_);
+  Key4Inode key(inode.fsid(), inode.inodeid());
+  std::string skey = conv_.SerializeToString(key);
+  Key4TrashItem trashKey(inode.dtime(), inode.fsid(), inode.inodeid());
+
+  auto txn = kvStorage_->BeginTransaction();
+  if (nullptr == txn) {
+    return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+  }
+
+  // all information of trash item is in the key
+  Status s = txn->HSet(table4Inode_, skey, inode);
+  if (s.ok()) {
+    s = txn->SSet(table4TrashItem_, conv_.SerializeToString(trashKey),
+                  google::protobuf::Empty());
+  }
+  if (s.ok()) {
+    s = txn->Commit();
+  } else if (!txn->Rollback().ok()) {
+    LOG(ERROR) << "Rollback transaction failed";
+  }
+  EraseCache(skey);
+
+  if (!s.ok()) {
+    LOG(ERROR) << "Update inode and add trash item failed, fsId = "
+               << inode.fsid() << ", inodeId = " << inode.inodeid()
+               << ", status = " << s.ToString();
+    return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+  }
+  return MetaStatusCode::OK;
+}
+
+MetaStatusCode InodeStorage::AddTrashItem(const Key4TrashItem& key) {
+  WriteLockGuard lg(rwLock_);
+  Status s = kvStorage_->SSet(table4TrashItem_, conv_.SerializeToString(key),
+                              google::protobuf::Empty());
+  if (!s.ok()) {
+    LOG(ERROR) << "Add trash item failed, status = " << s.ToString();
+    return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+  }
+  return MetaStatusCode::OK;
+}
+
+MetaStatusCode InodeStorage::DeleteTrashItem(const Key4TrashItem& key) {
+  WriteLockGuard lg(rwLock_);
+  Status s = kvStorage_->SDel(table4TrashItem_, conv_.SerializeToString(key));
+  if (!s.ok()) {
+    LOG(ERROR) << "Delete trash item failed, status = " << s.ToString();
+    return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+  }
+  return MetaStatusCode::OK;
+}
+
+std::shared_ptr<Iterator> InodeStorage::GetAllTrashItem() {
+  ReadLockGuard lg(rwLock_);
+  return kvStorage_->SGetAll(table4TrashItem_);
+}
+
+MetaStatusCode InodeStorage::MigrateTrashItems() {
+  // the memory storage is refilled by InsertInode() which adds the trash
+  // items, only the rocksdb storage is recovered from a checkpoint directly
+  if (kvStorage_->Type() != KVStorage::STORAGE_TYPE::ROCKSDB_STORAGE) {
+    return MetaStatusCode::OK;
+  }
+
+  // the marker lives in the hash table of the same name, so it is never
+  // visited by the scan of trash items
+  WriteLockGuard lg(rwLock_);
+  google::protobuf::Empty marker;
+  Status s = kvStorage_->HGet(table4TrashItem_, kTrashMigratedKey, &marker);
+  if (s.ok()) {
+    return MetaStatusCode::OK;
+  } else if (!s.IsNotFound()) {
+    LOG(ERROR) << "Get trash migrated marker failed, status = "
+               << s.ToString();
+    return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+  }
+
+  auto iterator = kvStorage_->HGetAll(table4Inode_);
+  if (iterator->Status() != 0) {
+    LOG(ERROR) << "Failed to get iterator for all inode";
+    return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+  }
+
+  std::vector<Key4TrashItem> items;
+  Inode inode;
+  for (iterator->SeekToFirst(); iterator->Valid(); iterator->Next()) {
+    if (!iterator->ParseFromValue(&inode)) {
+      return MetaStatusCode::PARSE_FROM_STRING_FAILED;
+    } else if (inode.nlink() == 0) {
+      items.emplace_back(inode.dtime(), inode.fsid(), inode.inodeid());
+    }
+  }
+
+  auto txn = kvStorage_->BeginTransaction();
+  if (nullptr == txn) {
+    return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+  }
+  for (const auto& key : items) {
+    s = txn->SSet(table4TrashItem_, conv_.SerializeToString(key),
+                  google::protobuf::Empty());
+    if (!s.ok()) {
+      break;
+    }
+  }
+  if (s.ok()) {
+    s = txn->HSet(table4TrashItem_, kTrashMigratedKey,
+                  google::protobuf::Empty());
+  }
+  if (s.ok()) {
+    s = txn->Commit();
+  } else if (!txn->Rollback().ok()) {
+    LOG(ERROR) << "Rollback transaction failed";
+  }
+
+  if (!s.ok()) {
+    LOG(ERROR) << "Migrate trash items failed, status = " << s.ToString();
+    return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+  }
+  LOG(INFO) << "Migrate " << items.size()
+            << " unlinked inodes into trash item table";
+  return MetaStatusCode::OK;
+}
+
 std::shared_ptr<Iterator> InodeStorage::GetAllInode() {
   ReadLockGuard lg(rwLock_);
   std::string sprefix = conv_.SerializeToString(Prefix4AllInode());
@@ -246,6 +425,7 @@ bool InodeStorage::Empty() {
 MetaStatusCode InodeStorage::Clear() {
   WriteLockGuard lg(rwLock_);
   Status s = kvStorage_->HClear(table4Inode_);
+  cacheTableId_ = storage::NewRowCacheTableId();
   if (!s.ok()) {
     LOG(ERROR) << "InodeStorage clear inode table failed";
     return MetaStatusCode::STORAGE_INTERNAL_ERROR;
@@ -270,6 +450,15 @@ MetaStatusCode InodeStorage::Clear() {
     return MetaStatusCode::STORAGE_INTERNAL_ERROR;
   }
 
+  s = kvStorage_->SClear(table4TrashItem_);
+  if (s.ok()) {
+    s = kvStorage_->HClear(table4TrashItem_);
+  }
+  if (!s.ok()) {
+    LOG(ERROR) << "InodeStorage clear trash item table failed";
+    return MetaStatusCode::STORAGE_INTERNAL_ERROR;
+  }
+
   return MetaStatusCode::OK;
 }
 
@@ -325,6 +514,28 @@ uint64_t InodeStorage::GetInodeS3MetaSize(uint32_t fsId, uint64_t inodeId) {
   return size;
 }
 
+bool InodeStorage::GetAllInodeS3MetaSize(
+    std::unordered_map<uint64_t, uint64_t>* sizes) {
+  ReadLockGuard lg(rwLock_);
+  auto iterator = kvStorage_->HGetAll(table4InodeAuxInfo_);
+  if (iterator->Status() != 0) {
+    LOG(ERROR) << "failed to get iterator for all inode aux info";
+    return false;
+  }
+
+  Key4InodeAuxInfo key;
+  pb::metaserver::InodeAuxInfo out;
+  for (iterator->SeekToFirst(); iterator->Valid(); iterator->Next()) {
+    if (!conv_.ParseFromString(iterator->Key(), &key) ||
+        !iterator->ParseFromValue(&out)) {
+      LOG(ERROR) << "failed to parse inode aux info";
+      return false;
+    }
+    (*sizes)[key.inodeId] = out.s3metasize();
+  }
+  return true;
+}
+
 MetaStatusCode InodeStorage::AddS3ChunkInfoList(
     Transaction txn, uint32_t fsId, uint64_t inodeId, uint64_t chunkIndex,
     const pb::metaserver::S3ChunkInfoList* list2add) {
@@ -26,9 +26,11 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "dingofs/metaserver.pb.h"
 #include "metaserver/storage/converter.h"
+#include "metaserver/storage/row_cache.h"
 #include "metaserver/storage/storage.h"
 #include "utils/concurrent/rw_lock.h"
 
@@ -94,6 +96,33 @@ class InodeStorage {
    */
   pb::metaserver::MetaStatusCode Update(const pb::metaserver::Inode& inode);
 
+  // trash
+
+  /**
+   * @brief update the inode whose nlink dropped to 0 and add it into
+   *        the trash item table in one transaction
+   * @param[in] inode: the unlinked inode with its dtime
+   * @return If update or add failed, return STORAGE_INTERNAL_ERROR
+   */
+  pb::metaserver::MetaStatusCode UpdateAndAddTrashItem(
+      const pb::metaserver::Inode& inode);
+
+  pb::metaserver::MetaStatusCode AddTrashItem(
+      const storage::Key4TrashItem& key);
+
+  pb::metaserver::MetaStatusCode DeleteTrashItem(
+      const storage::Key4TrashItem& key);
+
+  // return all trash items in the order of dtime
+  std::shared_ptr<storage::Iterator> GetAllTrashItem();
+
+  /**
+   * @brief add the unlinked inodes written before the trash item table
+   *        existed into the table, it only takes effect once per partition
+   * @return If scan or write failed, return STORAGE_INTERNAL_ERROR
+   */
+  pb::metaserver::MetaStatusCode MigrateTrashItems();
+
   std::shared_ptr<storage::Iterator> GetAllInode();
 
   bool GetAllInodeId(std::list<uint64_t>* ids);
@@ -107,6 +136,10 @@ class InodeStorage {
 
   pb::metaserver::MetaStatusCode Clear();
 
+  // drop all cached inodes, it should be invoked after the underlying
+  // storage changed out of InodeStorage (e.g. recover from raft snapshot)
+  void InvalidateCache();
+
   // s3chunkinfo
   pb::metaserver::MetaStatusCode ModifyInodeS3ChunkInfoList(
       uint32_t fsId, uint64_t inodeId, uint64_t chunkIndex,
@@ -138,6 +171,10 @@ class InodeStorage {
       uint32_t fsId, uint64_t inodeId, uint64_t offset,
       pb::metaserver::VolumeExtentSlice* slice);
 
+  // get the number of s3chunkinfos of all inodes which have any, it scans
+  // the aux info table once instead of looking up the inodes one by one
+  bool GetAllInodeS3MetaSize(std::unordered_map<uint64_t, uint64_t>* sizes);
+
   pb::metaserver::MetaStatusCode AddS3ChunkInfoList(
       std::shared_ptr<storage::StorageTransaction> txn, uint32_t fsId,
       uint64_t inodeId, uint64_t chunkIndex,
@@ -152,6 +189,16 @@ class InodeStorage {
 
   uint64_t GetInodeS3MetaSize(uint32_t fsId, uint64_t inodeId);
 
+  static void FillAttr(const pb::metaserver::Inode& inode,
+                       pb::metaserver::InodeAttr* attr);
+
+  // get inode attribute from row cache first,
+  // the caller should hold the rwLock_
+  storage::Status GetInodeAttr(const std::string& skey,
+                               storage::InodeRowCache::ValueType* attr);
+
+  void EraseCache(const std::string& skey);
+
   pb::metaserver::MetaStatusCode DelS3ChunkInfoList(
       std::shared_ptr<storage::StorageTransaction> txn, uint32_t fsId,
       uint64_t inodeId, uint64_t chunkIndex,
@@ -166,8 +213,13 @@ class InodeStorage {
   std::string table4S3ChunkInfo_;
   std::string table4VolumeExtent_;
   std::string table4InodeAuxInfo_;
+  std::string table4TrashItem_;
   size_t nInode_;
   storage::Converter conv_;
+  // cache of inode attributes, only for rocksdb storage, because the memory
+  // storage already stores the decoded inode
+  storage::InodeRowCache* rowCache_;
+  uint64_t cacheTableId_;
 };
 
 }  // namespace metaserver
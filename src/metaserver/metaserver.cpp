@@ -34,6 +34,7 @@
 
 #include "absl/memory/memory.h"
 #include "aws/s3_adapter.h"
+#include "metaserver/clean_executor.h"
 #include "metaserver/common/dynamic_config.h"
 #include "metaserver/common/types.h"
 #include "metaserver/copyset/copyset_service.h"
@@ -173,6 +174,19 @@ void Metaserver::InitRecycleManagerOption(
                                        &recycleManagerOption->scanLimit));
 }
 
+void Metaserver::InitRenameTxResolverOption(RenameTxResolverOption* option) {
+  option->metaClient = metaClient_;
+  option->copysetNodeManager = copysetNodeManager_;
+  LOG_IF(WARNING, !conf_->GetUInt32Value("renameTx.resolver.scanPeriodSec",
+                                         &option->scanPeriodSec))
+      << "Not found `renameTx.resolver.scanPeriodSec` in conf, default: "
+      << option->scanPeriodSec;
+  LOG_IF(WARNING, !conf_->GetUInt32Value("renameTx.resolver.timeoutSec",
+                                         &option->timeoutSec))
+      << "Not found `renameTx.resolver.timeoutSec` in conf, default: "
+      << option->timeoutSec;
+}
+
 void InitExcutorOption(const std::shared_ptr<Configuration>& conf,
                        stub::common::ExcutorOpt* opts, bool internal) {
   if (internal) {
@@ -245,6 +259,15 @@ void Metaserver::Init() {
   aws::S3AdapterOption s3_adapter_option;
   aws::InitS3AdaptorOptionExceptS3InfoOption(conf_.get(), &s3_adapter_option);
 
+  // each filesystem has its own s3 adaptor in clean executor
+  CleanExecutorOption cleanExecutorOption;
+  cleanExecutorOption.InitCleanExecutorOptionFromConf(conf_);
+  cleanExecutorOption.newS3Adaptor = [s3_adapter_option,
+                                      s3_client_adaptor_option]() {
+    return CreateS3Adaptor(s3_adapter_option, s3_client_adaptor_option);
+  };
+  CleanExecutor::GetInstance().Init(cleanExecutorOption);
+
   trashOption.s3Adaptor =
       CreateS3Adaptor(s3_adapter_option, s3_client_adaptor_option);
   trashOption.mdsClient = mdsClient_;
@@ -260,6 +283,10 @@ void Metaserver::Init() {
   InitStorage();
   InitCopysetNodeManager();
 
+  RenameTxResolverOption renameTxResolverOption;
+  InitRenameTxResolverOption(&renameTxResolverOption);
+  RenameTxResolver::GetInstance().Init(renameTxResolverOption);
+
   // get metaserver id and token before heartbeat
   GetMetaserverDataByLoadOrRegister();
   InitResourceCollector();
@@ -440,10 +467,14 @@ void Metaserver::Run() {
     return;
   }
 
+  CleanExecutor::GetInstance().Start();
+
   TrashManager::GetInstance().Run();
 
   RecycleManager::GetInstance().Run();
 
+  RenameTxResolver::GetInstance().Run();
+
   // start heartbeat
   LOG_IF(FATAL, heartbeat_.Run() != 0) << "Failed to start heartbeat manager.";
 
@@ -545,7 +576,12 @@ void Metaserver::Stop() {
 
   RecycleManager::GetInstance().Stop();
 
+  RenameTxResolver::GetInstance().Stop();
+
   TrashManager::GetInstance().Fini();
+
+  // stop after all cleaners stopped, they may wait for the tasks
+  CleanExecutor::GetInstance().Stop();
   LOG_IF(ERROR, !copysetNodeManager_->Stop())
       << "Failed to stop copyset node manager";
 
@@ -564,6 +600,15 @@ void Metaserver::InitHeartbeatOptions() {
                                        &heartbeatOptions_.intervalSec));
   LOG_IF(FATAL, !conf_->GetUInt32Value("mds.heartbeat_timeoutMs",
                                        &heartbeatOptions_.timeout));
+  LOG_IF(WARNING, !conf_->GetBoolValue("mds.heartbeat_deltaReport",
+                                       &heartbeatOptions_.deltaReport))
+      << "Not found `mds.heartbeat_deltaReport` in conf, default: "
+      << heartbeatOptions_.deltaReport;
+  LOG_IF(WARNING,
+         !conf_->GetUInt32Value("mds.heartbeat_fullReportIntervalSec",
+                                &heartbeatOptions_.fullReportIntervalSec))
+      << "Not found `mds.heartbeat_fullReportIntervalSec` in conf, default: "
+      << heartbeatOptions_.fullReportIntervalSec;
 }
 
 void Metaserver::InitHeartbeat() {
@@ -670,6 +715,11 @@ void Metaserver::InitCopysetNodeOptions() {
   LOG_IF(FATAL, !conf_->GetUInt32Value(
                     "copyset.check_loadmargin_interval_ms",
                     &copysetNodeOptions_.checkLoadMarginIntervalMs));
+  LOG_IF(WARNING,
+         !conf_->GetUInt32Value("copyset.change_feed_capacity",
+                                &copysetNodeOptions_.changeFeedCapacity))
+      << "Not found `copyset.change_feed_capacity` in conf, default: "
+      << copysetNodeOptions_.changeFeedCapacity;
 
   LOG_IF(FATAL, !conf_->GetUInt32Value(
                     "applyqueue.worker_count",
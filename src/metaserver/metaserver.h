@@ -38,6 +38,7 @@
 #include "metaserver/partition_clean_manager.h"
 #include "metaserver/recycle_manager.h"
 #include "metaserver/register.h"
+#include "metaserver/rename_tx_resolver.h"
 #include "metaserver/resource_statistic.h"
 #include "stub/rpcclient/base_client.h"
 #include "stub/rpcclient/mds_client.h"
@@ -80,6 +81,8 @@ class Metaserver {
       std::shared_ptr<stub::rpcclient::MdsClient> mdsClient,
       PartitionCleanOption* partitionCleanOption);
   void InitRecycleManagerOption(RecycleManagerOption* recycleManagerOption);
+
+  void InitRenameTxResolverOption(RenameTxResolverOption* option);
   void GetMetaserverDataByLoadOrRegister();
   int PersistMetaserverMeta(std::string path,
                             pb::metaserver::MetaServerMetadata* metadata);
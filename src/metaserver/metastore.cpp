@@ -195,6 +195,17 @@ bool MetaStoreImpl::Load(const std::string& pathname) {
     return false;
   }
 
+  // the cached inodes and dentries may be filled from the previous storage
+  for (auto& part : partitionMap_) {
+    part.second->InvalidateCache();
+    if (part.second->GetStatus() != PartitionStatus::DELETING &&
+        !part.second->MigrateTrashItems()) {
+      LOG(ERROR) << "Failed to migrate trash items, partitionId = "
+                 << part.first;
+      return false;
+    }
+  }
+
   startCompacts();
   return true;
 }
@@ -368,6 +379,17 @@ MetaStatusCode MetaStoreImpl::CreatePartition(
   const auto& partition = request->partition();
   auto it = partitionMap_.find(partition.partitionid());
   if (it != partitionMap_.end()) {
+    // a request with a smaller end comes from mds splitting the partition,
+    // the upper part of the range is moved to a new partition
+    auto current = it->second->GetPartitionInfo();
+    if (partition.fsid() == current.fsid() &&
+        partition.start() == current.start() &&
+        partition.end() < current.end()) {
+      status = it->second->ShrinkRange(partition.end());
+      response->set_statuscode(status);
+      return status;
+    }
+
     // keep idempotence
     status = MetaStatusCode::OK;
     response->set_statuscode(status);
@@ -584,6 +606,14 @@ MetaStatusCode MetaStoreImpl::PrepareRenameTx(
   return rc;
 }
 
+void MetaStoreImpl::GetExpiredRenameTxs(uint64_t timeoutSec,
+                                        std::vector<ShardedTx>* txs) {
+  ReadLockGuard readLockGuard(rwLock_);
+  for (const auto& item : partitionMap_) {
+    item.second->GetExpiredShardedTxs(timeoutSec, txs);
+  }
+}
+
 // inode
 MetaStatusCode MetaStoreImpl::CreateInode(const CreateInodeRequest* request,
                                           CreateInodeResponse* response) {
@@ -752,6 +782,7 @@ MetaStatusCode MetaStoreImpl::GetInode(const GetInodeRequest* request,
       if (request->supportstreaming()) {
         limit = kvStorage_->GetStorageOptions().s3MetaLimitSizeInsideInode;
       }
+      partition->RecordS3ChunkInfoRead(inodeId);
       rc = partition->PaddingInodeS3ChunkInfo(
           fsId, inodeId, inode->mutable_s3chunkinfomap(), limit);
       if (rc == MetaStatusCode::INODE_S3_META_TOO_LARGE) {
@@ -887,6 +918,9 @@ MetaStatusCode MetaStoreImpl::GetOrModifyS3ChunkInfo(
   rc = partition->GetOrModifyS3ChunkInfo(
       fsId, inodeId, request->s3chunkinfoadd(), request->s3chunkinforemove(),
       request->returns3chunkinfomap(), iterator);
+  if (rc == MetaStatusCode::OK && request->returns3chunkinfomap()) {
+    partition->RecordS3ChunkInfoRead(inodeId);
+  }
   if (rc == MetaStatusCode::OK && !request->supportstreaming() &&
       request->returns3chunkinfomap()) {
     rc = partition->PaddingInodeS3ChunkInfo(
@@ -126,6 +126,11 @@ class MetaStore {
       const pb::metaserver::PrepareRenameTxRequest* request,
       pb::metaserver::PrepareRenameTxResponse* response) = 0;
 
+  // sharded rename transactions which are prepared for more than
+  // `timeoutSec` seconds
+  virtual void GetExpiredRenameTxs(uint64_t timeoutSec,
+                                   std::vector<ShardedTx>* txs) = 0;
+
   // inode
   virtual pb::metaserver::MetaStatusCode CreateInode(
       const pb::metaserver::CreateInodeRequest* request,
@@ -257,6 +262,9 @@ class MetaStoreImpl : public MetaStore {
       const pb::metaserver::PrepareRenameTxRequest* request,
       pb::metaserver::PrepareRenameTxResponse* response) override;
 
+  void GetExpiredRenameTxs(uint64_t timeoutSec,
+                           std::vector<ShardedTx>* txs) override;
+
   // inode
   pb::metaserver::MetaStatusCode CreateInode(
       const pb::metaserver::CreateInodeRequest* request,
@@ -301,6 +301,16 @@ std::shared_ptr<Iterator> MetaStoreFStream::NewPendingTxIterator(
     container->emplace("", value);
   }
 
+  // one request per prepared sharded tx, and one for all decisions
+  std::vector<pb::metaserver::PrepareRenameTxRequest> shardedTxs;
+  partition->GetShardedTxs(&shardedTxs);
+  for (size_t i = 0; i < shardedTxs.size(); i++) {
+    if (!conv_->SerializeToString(shardedTxs[i], &value)) {
+      return nullptr;
+    }
+    container->emplace("sharded:" + std::to_string(i), value);
+  }
+
   auto partitionId = partition->GetPartitionId();
   auto iterator = std::make_shared<ContainerIterator<ContainerType>>(container);
   return std::make_shared<IteratorWrapper>(ENTRY_TYPE::PENDING_TX, partitionId,
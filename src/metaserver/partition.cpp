@@ -33,6 +33,7 @@
 #include "metaserver/s3compact_manager.h"
 #include "metaserver/storage/converter.h"
 #include "metaserver/trash_manager.h"
+#include "stub/common/rename_tx.h"
 
 namespace dingofs {
 namespace metaserver {
@@ -75,7 +76,10 @@ Partition::Partition(PartitionInfo partition,
   trash_ = std::make_shared<TrashImpl>(inodeStorage_);
   inodeManager_ = std::make_shared<InodeManager>(
       inodeStorage_, trash_, partitionInfo_.mutable_filetype2inodenum());
-  txManager_ = std::make_shared<TxManager>(dentryStorage_);
+  txManager_ = std::make_shared<TxManager>(
+      dentryStorage_, [this](const Dentry& dentry) {
+        return IsInodeBelongs(dentry.fsid(), dentry.parentinodeid());
+      });
   dentryManager_ = std::make_shared<DentryManager>(dentryStorage_, txManager_);
   if (!partitionInfo_.has_nextid()) {
     partitionInfo_.set_nextid(
@@ -179,8 +183,13 @@ MetaStatusCode Partition::ListDentry(const Dentry& dentry,
 void Partition::ClearDentry() { dentryManager_->ClearDentry(); }
 
 MetaStatusCode Partition::HandleRenameTx(const std::vector<Dentry>& dentrys) {
-  for (const auto& it : dentrys) {
-    if (!IsInodeBelongs(it.fsid(), it.parentinodeid())) {
+  // sharded tx carries the dentries of other partitions behind the first one
+  size_t nlocal = dentrys.size();
+  if (!dentrys.empty() && stub::common::IsShardedTx(dentrys[0])) {
+    nlocal = 1;
+  }
+  for (size_t i = 0; i < nlocal; i++) {
+    if (!IsInodeBelongs(dentrys[i].fsid(), dentrys[i].parentinodeid())) {
       return MetaStatusCode::PARTITION_ID_MISSMATCH;
     }
   }
@@ -196,6 +205,10 @@ bool Partition::InsertPendingTx(
     const pb::metaserver::PrepareRenameTxRequest& pending_tx) {
   std::vector<Dentry> dentrys{pending_tx.dentrys().begin(),
                               pending_tx.dentrys().end()};
+  if (!dentrys.empty() && stub::common::IsShardedTx(dentrys[0])) {
+    return txManager_->RestoreShardedTx(dentrys);
+  }
+
   for (const auto& it : dentrys) {
     if (!IsInodeBelongs(it.fsid(), it.parentinodeid())) {
       return false;
@@ -230,6 +243,31 @@ bool Partition::FindPendingTx(
   return true;
 }
 
+void Partition::GetShardedTxs(
+    std::vector<pb::metaserver::PrepareRenameTxRequest>* txs) {
+  if (GetStatus() == PartitionStatus::DELETING) {
+    return;
+  }
+
+  std::vector<std::vector<Dentry>> encoded;
+  txManager_->GetShardedTxs(&encoded);
+  for (const auto& dentrys : encoded) {
+    pb::metaserver::PrepareRenameTxRequest tx;
+    tx.set_poolid(partitionInfo_.poolid());
+    tx.set_copysetid(partitionInfo_.copysetid());
+    tx.set_partitionid(partitionInfo_.partitionid());
+    *tx.mutable_dentrys() = {dentrys.begin(), dentrys.end()};
+    txs->push_back(std::move(tx));
+  }
+}
+
+void Partition::GetExpiredShardedTxs(uint64_t timeout_sec,
+                                     std::vector<ShardedTx>* txs) {
+  if (GetStatus() != PartitionStatus::DELETING) {
+    txManager_->GetExpiredShardedTxs(timeout_sec, txs);
+  }
+}
+
 // inode
 MetaStatusCode Partition::CreateInode(const InodeParam& param, Inode* inode) {
   if (GetStatus() == PartitionStatus::READONLY) {
@@ -358,6 +396,10 @@ MetaStatusCode Partition::PaddingInodeS3ChunkInfo(int32_t fs_id,
   return inodeManager_->PaddingInodeS3ChunkInfo(fs_id, inode_id, m, limit);
 }
 
+void Partition::RecordS3ChunkInfoRead(uint64_t inode_id) {
+  inodeManager_->RecordS3ChunkInfoRead(inode_id);
+}
+
 MetaStatusCode Partition::InsertInode(const Inode& inode) {
   if (!IsInodeBelongs(inode.fsid(), inode.inodeid())) {
     return MetaStatusCode::PARTITION_ID_MISSMATCH;
@@ -453,6 +495,15 @@ bool Partition::Clear() {
   return true;
 }
 
+void Partition::InvalidateCache() {
+  inodeStorage_->InvalidateCache();
+  dentryStorage_->InvalidateCache();
+}
+
+bool Partition::MigrateTrashItems() {
+  return inodeStorage_->MigrateTrashItems() == MetaStatusCode::OK;
+}
+
 uint64_t Partition::GetNewInodeId() {
   if (partitionInfo_.nextid() > partitionInfo_.end()) {
     partitionInfo_.set_status(PartitionStatus::READONLY);
@@ -463,6 +514,24 @@ uint64_t Partition::GetNewInodeId() {
   return new_inode_id;
 }
 
+MetaStatusCode Partition::ShrinkRange(uint64_t end) {
+  if (end < partitionInfo_.start() || end + 1 < partitionInfo_.nextid()) {
+    LOG(ERROR) << "shrink partition failed, partitionId = "
+               << GetPartitionId() << ", start = " << partitionInfo_.start()
+               << ", nextId = " << partitionInfo_.nextid()
+               << ", new end = " << end;
+    return MetaStatusCode::PARAM_ERROR;
+  }
+
+  LOG(INFO) << "shrink partition, partitionId = " << GetPartitionId()
+            << ", end: " << partitionInfo_.end() << " -> " << end;
+  partitionInfo_.set_end(end);
+  if (partitionInfo_.nextid() > end) {
+    partitionInfo_.set_status(PartitionStatus::READONLY);
+  }
+  return MetaStatusCode::OK;
+}
+
 uint32_t Partition::GetInodeNum() {
   return static_cast<uint32_t>(inodeStorage_->Size());
 }
@@ -75,6 +75,12 @@ class Partition {
 
   bool FindPendingTx(pb::metaserver::PrepareRenameTxRequest* pending_tx);
 
+  // sharded rename transactions for the snapshot, which are loaded
+  // by InsertPendingTx
+  void GetShardedTxs(std::vector<pb::metaserver::PrepareRenameTxRequest>* txs);
+
+  void GetExpiredShardedTxs(uint64_t timeout_sec, std::vector<ShardedTx>* txs);
+
   // inode
   pb::metaserver::MetaStatusCode CreateInode(const InodeParam& param,
                                              pb::metaserver::Inode* inode);
@@ -112,6 +118,8 @@ class Partition {
                                                          S3ChunkInfoMap* m,
                                                          uint64_t limit = 0);
 
+  void RecordS3ChunkInfoRead(uint64_t inode_id);
+
   pb::metaserver::MetaStatusCode UpdateVolumeExtent(
       uint32_t fs_id, uint64_t inode_id,
       const pb::metaserver::VolumeExtentList& extents);
@@ -152,6 +160,10 @@ class Partition {
   // if no available inode id in this partiton ,return UINT64_MAX
   uint64_t GetNewInodeId();
 
+  // shrink the inode range to [start, end], the ids above `end` must not
+  // be allocated yet, so no inode or dentry needs to move out
+  pb::metaserver::MetaStatusCode ShrinkRange(uint64_t end);
+
   uint32_t GetInodeNum();
 
   uint32_t GetDentryNum();
@@ -182,6 +194,13 @@ class Partition {
 
   bool Clear();
 
+  // invalidate the row caches after storage recovered from snapshot
+  void InvalidateCache();
+
+  // add the unlinked inodes of the storage written by older version
+  // into trash, see InodeStorage::MigrateTrashItems()
+  bool MigrateTrashItems();
+
   void SetManageFlag(bool flag) { partitionInfo_.set_manageflag(flag); }
 
   bool GetManageFlag() {
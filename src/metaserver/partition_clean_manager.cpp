@@ -21,6 +21,10 @@
  */
 #include "metaserver/partition_clean_manager.h"
 
+#include <utility>
+#include <vector>
+
+#include "metaserver/clean_executor.h"
 #include "utils/concurrent/concurrent.h"
 
 namespace dingofs {
@@ -44,14 +48,15 @@ void PartitionCleanManager::Add(
 
 void PartitionCleanManager::Remove(uint32_t partitionId) {
   dingofs::utils::WriteLockGuard lockGuard(rwLock_);
-  // 1. first check inProcessingCleaner
-  if (inProcessingCleaner_ != nullptr &&
-      inProcessingCleaner_->GetPartitionId() == partitionId) {
-    inProcessingCleaner_->Stop();
-    LOG(INFO) << "remove partition from PartitionCleanManager, partition is"
-              << " in processing, stop this cleaner, partitionId = "
-              << partitionId;
-    return;
+  // 1. first check inProcessingCleaners
+  for (const auto& cleaner : inProcessingCleaners_) {
+    if (cleaner->GetPartitionId() == partitionId) {
+      cleaner->Stop();
+      LOG(INFO) << "remove partition from PartitionCleanManager, partition is"
+                << " in processing, stop this cleaner, partitionId = "
+                << partitionId;
+      return;
+    }
   }
 
   // 2. then check partitonCleanerList
@@ -83,7 +88,7 @@ void PartitionCleanManager::Fini() {
     sleeper_.interrupt();
     thread_.join();
     partitonCleanerList_.clear();
-    inProcessingCleaner_ = nullptr;
+    inProcessingCleaners_.clear();
     S3ClientAdaptor_ = nullptr;
   }
   LOG(INFO) << "stop PartitionCleanManager manager ok.";
@@ -93,34 +98,45 @@ void PartitionCleanManager::ScanLoop() {
   LOG(INFO) << "PartitionCleanManager start scan thread, scanPeriodSec = "
             << scanPeriodSec_;
   while (sleeper_.wait_for(std::chrono::seconds(scanPeriodSec_))) {
+    std::list<std::shared_ptr<PartitionCleaner>> cleaners;
     {
       dingofs::utils::WriteLockGuard lockGuard(rwLock_);
       if (partitonCleanerList_.empty()) {
         continue;
       }
 
-      inProcessingCleaner_ = partitonCleanerList_.front();
-      partitonCleanerList_.pop_front();
+      inProcessingCleaners_.swap(partitonCleanerList_);
+      cleaners = inProcessingCleaners_;
     }
 
-    uint32_t partitionId = inProcessingCleaner_->GetPartitionId();
-    LOG(INFO) << "scan partition, partitionId = " << partitionId;
-    bool deleteRecord = inProcessingCleaner_->ScanPartition();
-    if (deleteRecord) {
-      LOG(INFO) << "scan partition, partition is empty"
-                << ", delete record from clean manager, partitionId = "
-                << partitionId;
-      partitionCleanerCount << -1;
-    } else {
-      dingofs::utils::WriteLockGuard lockGuard(rwLock_);
-      if (!inProcessingCleaner_->IsStop()) {
-        partitonCleanerList_.push_back(inProcessingCleaner_);
-      } else {
-        LOG(INFO) << "scan partition, cleaner is mark stoped, remove it"
-                  << ", partitionId = " << partitionId;
-      }
+    // scan partitions in parallel, the deleted partitions are not requeued
+    std::vector<std::pair<uint64_t, CleanExecutor::Task>> tasks;
+    for (const auto& cleaner : cleaners) {
+      tasks.emplace_back(cleaner->GetPartitionId(), [this, cleaner]() {
+        uint32_t partitionId = cleaner->GetPartitionId();
+        LOG(INFO) << "scan partition, partitionId = " << partitionId;
+        bool deleteRecord = cleaner->ScanPartition();
+        if (deleteRecord) {
+          LOG(INFO) << "scan partition, partition is empty"
+                    << ", delete record from clean manager, partitionId = "
+                    << partitionId;
+          partitionCleanerCount << -1;
+          return;
+        }
+
+        dingofs::utils::WriteLockGuard lockGuard(rwLock_);
+        if (!cleaner->IsStop()) {
+          partitonCleanerList_.push_back(cleaner);
+        } else {
+          LOG(INFO) << "scan partition, cleaner is mark stoped, remove it"
+                    << ", partitionId = " << partitionId;
+        }
+      });
     }
-    inProcessingCleaner_ = nullptr;
+    CleanExecutor::GetInstance().SubmitAndWait(std::move(tasks));
+
+    dingofs::utils::WriteLockGuard lockGuard(rwLock_);
+    inProcessingCleaners_.clear();
   }
   LOG(INFO) << "PartitionCleanManager stop scan thread.";
 }
@@ -42,7 +42,6 @@ class PartitionCleanManager {
  public:
   PartitionCleanManager() {
     isStop_ = true;
-    inProcessingCleaner_ = nullptr;
     LOG(INFO) << "PartitionCleanManager constructor.";
   }
 
@@ -75,7 +74,8 @@ class PartitionCleanManager {
 
  private:
   std::list<std::shared_ptr<PartitionCleaner>> partitonCleanerList_;
-  std::shared_ptr<PartitionCleaner> inProcessingCleaner_;
+  // cleaners which are scanning by clean executor in parallel
+  std::list<std::shared_ptr<PartitionCleaner>> inProcessingCleaners_;
   std::shared_ptr<S3ClientAdaptor> S3ClientAdaptor_;
   std::shared_ptr<stub::rpcclient::MdsClient> mdsClient_;
   uint32_t scanPeriodSec_;
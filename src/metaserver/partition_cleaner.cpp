@@ -24,6 +24,7 @@
 #include <list>
 
 #include "dingofs/metaserver.pb.h"
+#include "metaserver/clean_executor.h"
 #include "metaserver/copyset/meta_operator.h"
 
 namespace dingofs {
@@ -46,23 +47,34 @@ bool PartitionCleaner::ScanPartition() {
     return false;
   }
 
-  for (auto inode_id : inode_id_list) {
-    if (isStop_ || !copysetNode_->IsLeaderTerm()) {
-      return false;
+  uint32_t batch_size = CleanExecutor::GetInstance().BatchSize();
+  auto iter = inode_id_list.begin();
+  while (iter != inode_id_list.end()) {
+    std::vector<Inode> inodes;
+    for (; iter != inode_id_list.end() && inodes.size() < batch_size; iter++) {
+      if (isStop_ || !copysetNode_->IsLeaderTerm()) {
+        return false;
+      }
+      Inode inode;
+      MetaStatusCode ret = partition_->GetInodeWithChunkInfo(
+          partition_->GetFsId(), *iter, &inode);
+      if (ret != MetaStatusCode::OK) {
+        LOG(WARNING) << "ScanPartition get inode fail, fsId = "
+                     << partition_->GetFsId() << ", inodeId = " << *iter;
+        continue;
+      }
+      inodes.emplace_back(std::move(inode));
     }
-    Inode inode;
-    MetaStatusCode ret = partition_->GetInodeWithChunkInfo(
-        partition_->GetFsId(), inode_id, &inode);
-    if (ret != MetaStatusCode::OK) {
-      LOG(WARNING) << "ScanPartition get inode fail, fsId = "
-                   << partition_->GetFsId() << ", inodeId = " << inode_id;
+    if (inodes.empty()) {
       continue;
     }
 
-    ret = CleanDataAndDeleteInode(inode);
+    MetaStatusCode ret = CleanDataAndDeleteInodes(inodes);
     if (ret != MetaStatusCode::OK) {
-      LOG(WARNING) << "ScanPartition clean inode fail, inode = "
-                   << inode.ShortDebugString();
+      LOG(WARNING) << "ScanPartition clean inodes fail, fsId = "
+                   << partition_->GetFsId()
+                   << ", first inodeId = " << inodes.front().inodeid()
+                   << ", count = " << inodes.size();
       continue;
     }
     usleep(inodeDeletePeriodMs_);
@@ -86,55 +98,67 @@ bool PartitionCleaner::ScanPartition() {
   return false;
 }
 
+MetaStatusCode PartitionCleaner::GetFsInfo(uint32_t fsId, FsInfo* fs_info) {
+  auto iter = fsInfoMap_.find(fsId);
+  if (iter != fsInfoMap_.end()) {
+    *fs_info = iter->second;
+    return MetaStatusCode::OK;
+  }
+
+  auto ret = mdsClient_->GetFsInfo(fsId, fs_info);
+  if (ret != FSStatusCode::OK) {
+    if (FSStatusCode::NOT_FOUND == ret) {
+      LOG(ERROR) << "The fsName not exist, fsId = " << fsId;
+    } else {
+      LOG(ERROR) << "GetFsInfo failed, FSStatusCode = " << ret
+                 << ", FSStatusCode_Name = " << FSStatusCode_Name(ret)
+                 << ", fsId = " << fsId;
+    }
+    return MetaStatusCode::S3_DELETE_ERR;
+  }
+  fsInfoMap_.insert({fsId, *fs_info});
+  return MetaStatusCode::OK;
+}
+
 MetaStatusCode PartitionCleaner::CleanDataAndDeleteInode(const Inode& inode) {
+  return CleanDataAndDeleteInodes({inode});
+}
+
+MetaStatusCode PartitionCleaner::CleanDataAndDeleteInodes(
+    const std::vector<Inode>& inodes) {
+  auto& executor = CleanExecutor::GetInstance();
+  executor.Throttle(inodes.size());
+
   // TODO(cw123) : consider FsFileType::TYPE_FILE
-  if (pb::metaserver::FsFileType::TYPE_S3 == inode.type()) {
-    // get s3info from mds
+  std::vector<Inode> s3_inodes;
+  for (const auto& inode : inodes) {
+    if (pb::metaserver::FsFileType::TYPE_S3 == inode.type()) {
+      s3_inodes.push_back(inode);
+    }
+  }
+
+  // all inodes in partition belong to the same filesystem
+  if (!s3_inodes.empty()) {
     FsInfo fs_info;
-    if (fsInfoMap_.find(inode.fsid()) == fsInfoMap_.end()) {
-      auto ret = mdsClient_->GetFsInfo(inode.fsid(), &fs_info);
-      if (ret != FSStatusCode::OK) {
-        if (FSStatusCode::NOT_FOUND == ret) {
-          LOG(ERROR) << "The fsName not exist, fsId = " << inode.fsid();
-          return MetaStatusCode::S3_DELETE_ERR;
-        } else {
-          LOG(ERROR) << "GetFsInfo failed, FSStatusCode = " << ret
-                     << ", FSStatusCode_Name = " << FSStatusCode_Name(ret)
-                     << ", fsId = " << inode.fsid();
-          return MetaStatusCode::S3_DELETE_ERR;
-        }
-      }
-      fsInfoMap_.insert({inode.fsid(), fs_info});
-    } else {
-      fs_info = fsInfoMap_.find(inode.fsid())->second;
+    uint32_t fs_id = s3_inodes.front().fsid();
+    MetaStatusCode ret = GetFsInfo(fs_id, &fs_info);
+    if (ret != MetaStatusCode::OK) {
+      return ret;
     }
-    const auto& s3_info = fs_info.detail().s3info();
-    // reinit s3 adaptor
-    S3ClientAdaptorOption client_adaptor_option;
-    s3Adaptor_->GetS3ClientAdaptorOption(&client_adaptor_option);
-    client_adaptor_option.blockSize = s3_info.blocksize();
-    client_adaptor_option.chunkSize = s3_info.chunksize();
-    client_adaptor_option.objectPrefix = s3_info.objectprefix();
-    s3Adaptor_->Reinit(client_adaptor_option, s3_info.ak(), s3_info.sk(),
-                       s3_info.endpoint(), s3_info.bucketname());
-    int ret_val = s3Adaptor_->Delete(inode);
+
+    auto s3_adaptor = executor.GetS3Adaptor(fs_info, s3Adaptor_);
+    int ret_val = s3_adaptor->DeleteInodes(s3_inodes);
     if (ret_val != 0) {
       LOG(ERROR) << "S3ClientAdaptor delete s3 data failed"
-                 << ", ret = " << ret_val << ", fsId = " << inode.fsid()
-                 << ", inodeId = " << inode.inodeid();
+                 << ", ret = " << ret_val << ", fsId = " << fs_id
+                 << ", first inodeId = " << s3_inodes.front().inodeid()
+                 << ", count = " << s3_inodes.size();
       return MetaStatusCode::S3_DELETE_ERR;
     }
   }
 
-  // send request to copyset to delete inode
-  MetaStatusCode ret = DeleteInode(inode);
-  if (ret != MetaStatusCode::OK && ret != MetaStatusCode::NOT_FOUND) {
-    LOG(ERROR) << "Delete Inode fail, fsId = " << inode.fsid()
-               << ", inodeId = " << inode.inodeid()
-               << ", ret = " << MetaStatusCode_Name(ret);
-    return ret;
-  }
-  return MetaStatusCode::OK;
+  // send request to copyset to delete inodes
+  return DeleteInodes(inodes);
 }
 
 MetaStatusCode PartitionCleaner::DeleteInode(const Inode& inode) {
@@ -153,6 +177,38 @@ MetaStatusCode PartitionCleaner::DeleteInode(const Inode& inode) {
   return response.statuscode();
 }
 
+MetaStatusCode PartitionCleaner::DeleteInodes(
+    const std::vector<Inode>& inodes) {
+  size_t count = inodes.size();
+  std::vector<pb::metaserver::DeleteInodeRequest> requests(count);
+  std::vector<pb::metaserver::DeleteInodeResponse> responses(count);
+  std::vector<PartitionCleanerClosure> dones(count);
+  for (size_t i = 0; i < count; i++) {
+    auto& request = requests[i];
+    request.set_poolid(partition_->GetPoolId());
+    request.set_copysetid(partition_->GetCopySetId());
+    request.set_partitionid(partition_->GetPartitionId());
+    request.set_fsid(inodes[i].fsid());
+    request.set_inodeid(inodes[i].inodeid());
+    auto* delete_inode_op = new copyset::DeleteInodeOperator(
+        copysetNode_, nullptr, &request, &responses[i], &dones[i]);
+    delete_inode_op->Propose();
+  }
+
+  MetaStatusCode ret = MetaStatusCode::OK;
+  for (size_t i = 0; i < count; i++) {
+    dones[i].WaitRunned();
+    auto status = responses[i].statuscode();
+    if (status != MetaStatusCode::OK && status != MetaStatusCode::NOT_FOUND) {
+      LOG(ERROR) << "Delete Inode fail, fsId = " << inodes[i].fsid()
+                 << ", inodeId = " << inodes[i].inodeid()
+                 << ", ret = " << MetaStatusCode_Name(status);
+      ret = status;
+    }
+  }
+  return ret;
+}
+
 MetaStatusCode PartitionCleaner::DeletePartition() {
   pb::metaserver::DeletePartitionRequest request;
   request.set_poolid(partition_->GetPoolId());
@@ -25,6 +25,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "dingofs/mds.pb.h"
 #include "metaserver/copyset/copyset_node.h"
@@ -63,8 +64,15 @@ class PartitionCleaner {
   bool ScanPartition();
   pb::metaserver::MetaStatusCode CleanDataAndDeleteInode(
       const pb::metaserver::Inode& inode);
+  // Delete the data of inodes from s3 in batch, then delete inodes.
+  pb::metaserver::MetaStatusCode CleanDataAndDeleteInodes(
+      const std::vector<pb::metaserver::Inode>& inodes);
   pb::metaserver::MetaStatusCode DeleteInode(
       const pb::metaserver::Inode& inode);
+  // All deletions are proposed before waiting, so they are batched by raft
+  // into the same log entries flush.
+  pb::metaserver::MetaStatusCode DeleteInodes(
+      const std::vector<pb::metaserver::Inode>& inodes);
   pb::metaserver::MetaStatusCode DeletePartition();
   uint32_t GetPartitionId() { return partition_->GetPartitionId(); }
 
@@ -72,6 +80,10 @@ class PartitionCleaner {
 
   bool IsStop() { return isStop_; }
 
+ private:
+  pb::metaserver::MetaStatusCode GetFsInfo(uint32_t fsId,
+                                           pb::mds::FsInfo* fsInfo);
+
  private:
   std::shared_ptr<Partition> partition_;
   copyset::CopysetNode* copysetNode_;
@@ -22,10 +22,13 @@
 
 #include "metaserver/recycle_cleaner.h"
 
+#include <atomic>
 #include <list>
+#include <utility>
 #include <vector>
 
 #include "dingofs/metaserver.pb.h"
+#include "metaserver/clean_executor.h"
 
 namespace dingofs {
 namespace metaserver {
@@ -199,6 +202,8 @@ bool RecycleCleaner::DeleteDirRecursive(const Dentry& dentry) {
       return false;
     }
     // 2. delete file under dir
+    std::vector<std::pair<uint64_t, CleanExecutor::Task>> tasks;
+    std::atomic<bool> succ(true);
     for (const auto& it : dentryList) {
       if (isStop_ || !copysetNode_->IsLeaderTerm()) {
         LOG(WARNING) << "recycle cleaner stop or not leader, isStop = "
@@ -230,14 +235,23 @@ bool RecycleCleaner::DeleteDirRecursive(const Dentry& dentry) {
           return false;
         }
       } else {
-        // if type is not directory, delete direct
-        if (!DeleteNode(it)) {
-          LOG(WARNING) << "DeleteDirRecursive delete node fail, "
-                       << "dentry: " << it.ShortDebugString();
-          return false;
-        }
+        // if type is not directory, delete direct. The files are deleted
+        // in parallel, but the dentries of the same inode (hard links) are
+        // deleted in order, for the nlink is updated by read-modify-write.
+        tasks.emplace_back(it.inodeid(), [this, &it, &succ]() {
+          CleanExecutor::GetInstance().Throttle(1);
+          if (!DeleteNode(it)) {
+            LOG(WARNING) << "DeleteDirRecursive delete node fail, "
+                         << "dentry: " << it.ShortDebugString();
+            succ.store(false);
+          }
+        });
       }
     }
+    CleanExecutor::GetInstance().SubmitAndWait(std::move(tasks));
+    if (!succ.load()) {
+      return false;
+    }
 
     if (dentryList.size() < limit_) {
       break;
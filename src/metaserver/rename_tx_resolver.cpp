@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metaserver/rename_tx_resolver.h"
+
+#include <glog/logging.h>
+
+#include <vector>
+
+#include "stub/common/rename_tx.h"
+
+namespace dingofs {
+namespace metaserver {
+
+using pb::metaserver::DentryFlag;
+using pb::metaserver::MetaStatusCode;
+using stub::common::EncodeShardedTx;
+using stub::common::ShardedTxOp;
+
+RenameTxResolver::RenameTxResolver() : isStop_(true) {
+  committed_.expose_as("rename_tx_resolver_", "committed");
+  aborted_.expose_as("rename_tx_resolver_", "aborted");
+}
+
+void RenameTxResolver::Init(const RenameTxResolverOption& option) {
+  option_ = option;
+}
+
+void RenameTxResolver::Run() {
+  if (isStop_.exchange(false)) {
+    sleeper_.init();
+    thread_ = utils::Thread(&RenameTxResolver::ScanLoop, this);
+    LOG(INFO) << "Start rename tx resolver thread ok.";
+  }
+}
+
+void RenameTxResolver::Stop() {
+  if (!isStop_.exchange(true)) {
+    LOG(INFO) << "Stop rename tx resolver ...";
+    sleeper_.interrupt();
+    thread_.join();
+  }
+  LOG(INFO) << "Stop rename tx resolver ok.";
+}
+
+bool RenameTxResolver::Resolve(const ShardedTx& tx) {
+  if (tx.dentrys.size() != 2) {
+    return false;
+  }
+
+  size_t coordinator = 0;
+  if (!(tx.dentrys[0].flag() & DentryFlag::DELETE_MARK_FLAG)) {
+    coordinator = 1;
+  }
+  size_t participant = 1 - coordinator;
+
+  // the abort fails only if the transaction is committed on coordinator
+  auto rc = option_.metaClient->PrepareRenameTx(
+      EncodeShardedTx(ShardedTxOp::kAbort, tx.dentrys, coordinator));
+  ShardedTxOp op;
+  if (rc == MetaStatusCode::OK) {
+    op = ShardedTxOp::kAbort;
+  } else if (rc == MetaStatusCode::HANDLE_TX_FAILED) {
+    op = ShardedTxOp::kCommit;
+  } else {
+    LOG(WARNING) << "Abort sharded rename tx on coordinator failed"
+                 << ", retCode = " << MetaStatusCode_Name(rc)
+                 << ", dentry = " << tx.dentrys[coordinator].ShortDebugString();
+    return false;
+  }
+
+  rc = option_.metaClient->PrepareRenameTx(
+      EncodeShardedTx(op, tx.dentrys, participant));
+  if (rc != MetaStatusCode::OK) {
+    LOG(WARNING) << "Resolve sharded rename tx on participant failed"
+                 << ", retCode = " << MetaStatusCode_Name(rc)
+                 << ", dentry = " << tx.dentrys[participant].ShortDebugString();
+    return false;
+  }
+
+  // the decision is needed until the participant finished
+  if (op == ShardedTxOp::kCommit || tx.decided) {
+    rc = option_.metaClient->PrepareRenameTx(
+        EncodeShardedTx(ShardedTxOp::kForget, tx.dentrys, coordinator));
+    if (rc != MetaStatusCode::OK) {
+      LOG(WARNING) << "Forget sharded rename tx on coordinator failed"
+                   << ", retCode = " << MetaStatusCode_Name(rc)
+                   << ", dentry = "
+                   << tx.dentrys[coordinator].ShortDebugString();
+      return false;
+    }
+  }
+
+  if (op == ShardedTxOp::kCommit) {
+    committed_ << 1;
+  } else {
+    aborted_ << 1;
+  }
+  LOG(INFO) << "Resolve sharded rename tx success, txId = "
+            << tx.dentrys[0].txsequence()
+            << ", committed = " << (op == ShardedTxOp::kCommit);
+  return true;
+}
+
+void RenameTxResolver::ScanLoop() {
+  LOG(INFO) << "Rename tx resolver start scan thread, scanPeriodSec = "
+            << option_.scanPeriodSec << ", timeoutSec = " << option_.timeoutSec;
+  while (sleeper_.wait_for(std::chrono::seconds(option_.scanPeriodSec))) {
+    std::vector<copyset::CopysetNode*> nodes;
+    option_.copysetNodeManager->GetAllCopysets(&nodes);
+    for (auto* node : nodes) {
+      if (!node->IsLeaderTerm()) {
+        continue;
+      }
+
+      std::vector<ShardedTx> txs;
+      node->GetMetaStore()->GetExpiredRenameTxs(option_.timeoutSec, &txs);
+      for (const auto& tx : txs) {
+        if (isStop_.load()) {
+          return;
+        }
+        Resolve(tx);
+      }
+    }
+  }
+  LOG(INFO) << "Rename tx resolver stop scan thread.";
+}
+
+}  // namespace metaserver
+}  // namespace dingofs
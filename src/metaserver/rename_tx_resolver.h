@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_METASERVER_RENAME_TX_RESOLVER_H_
+#define DINGOFS_SRC_METASERVER_RENAME_TX_RESOLVER_H_
+
+#include <bvar/bvar.h>
+
+#include <memory>
+
+#include "metaserver/copyset/copyset_node_manager.h"
+#include "metaserver/transaction.h"
+#include "stub/rpcclient/metaserver_client.h"
+#include "utils/concurrent/concurrent.h"
+#include "utils/interruptible_sleeper.h"
+
+namespace dingofs {
+namespace metaserver {
+
+struct RenameTxResolverOption {
+  std::shared_ptr<stub::rpcclient::MetaServerClient> metaClient;
+  copyset::CopysetNodeManager* copysetNodeManager;
+  uint32_t scanPeriodSec = 60;
+  // a prepared transaction is resolved after it is not finished in time,
+  // and the aborted decision which fences the late commit is dropped after
+  // it, so it should be much larger than the rpc timeout of client
+  uint32_t timeoutSec = 120;
+};
+
+// Resolve the sharded rename transactions which are left by the crashed
+// clients, only the leader of partition does it.
+class RenameTxResolver {
+ public:
+  RenameTxResolver();
+
+  static RenameTxResolver& GetInstance() {
+    static RenameTxResolver instance_;
+    return instance_;
+  }
+
+  void Init(const RenameTxResolverOption& option);
+
+  void Run();
+
+  void Stop();
+
+  // Abort the transaction on the coordinator, then abort or commit it on
+  // the participant according to the result, and drop the decision on the
+  // coordinator at last, return true if it finished.
+  bool Resolve(const ShardedTx& tx);
+
+ private:
+  void ScanLoop();
+
+ private:
+  RenameTxResolverOption option_;
+  utils::Atomic<bool> isStop_;
+  utils::Thread thread_;
+  utils::InterruptibleSleeper sleeper_;
+
+  bvar::Adder<uint64_t> committed_;
+  bvar::Adder<uint64_t> aborted_;
+};
+
+}  // namespace metaserver
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_METASERVER_RENAME_TX_RESOLVER_H_
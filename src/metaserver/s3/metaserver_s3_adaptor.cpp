@@ -31,6 +31,14 @@
 
 namespace dingofs {
 namespace metaserver {
+
+namespace {
+
+// the limit of keys per DeleteObjects request of s3 protocol
+constexpr uint64_t kMaxDeleteObjectsPerRequest = 1000;
+
+}  // namespace
+
 void S3ClientAdaptorImpl::Init(const S3ClientAdaptorOption& option,
                                S3Client* client) {
   blockSize_ = option.blockSize;
@@ -61,6 +69,28 @@ int S3ClientAdaptorImpl::Delete(const pb::metaserver::Inode& inode) {
   }
 }
 
+int S3ClientAdaptorImpl::DeleteInodes(
+    const std::vector<pb::metaserver::Inode>& inodes) {
+  if (!enableDeleteObjects_) {
+    return S3ClientAdaptor::DeleteInodes(inodes);
+  }
+
+  // objects of small files are packed into the same requests
+  std::list<std::string> obj_list;
+  for (const auto& inode : inodes) {
+    for (const auto& item : inode.s3chunkinfomap()) {
+      GenObjNameListForChunkInfoList(inode.fsid(), inode.inodeid(),
+                                     item.second, &obj_list);
+    }
+  }
+
+  size_t nobjs = obj_list.size();
+  int ret = DeleteObjects(&obj_list);
+  LOG(INFO) << "delete data of " << inodes.size() << " inodes, " << nobjs
+            << " objects, ret = " << ret;
+  return ret;
+}
+
 int S3ClientAdaptorImpl::DeleteInodeByDeleteSingleChunk(
     const pb::metaserver::Inode& inode) {
   auto s3_chunk_info_map = inode.s3chunkinfomap();
@@ -159,17 +189,28 @@ int S3ClientAdaptorImpl::DeleteS3ChunkInfoList(
   std::list<std::string> obj_list;
 
   GenObjNameListForChunkInfoList(fs_id, inode_id, s3_chunk_infolist, &obj_list);
+  if (DeleteObjects(&obj_list) != 0) {
+    LOG(ERROR) << "DeleteS3ChunkInfoList failed, fsId = " << fs_id
+               << ", inodeId =  " << inode_id;
+    return -1;
+  }
+
+  return 0;
+}
 
-  while (obj_list.size() != 0) {
+int S3ClientAdaptorImpl::DeleteObjects(std::list<std::string>* obj_list) {
+  uint64_t batch_size =
+      std::max<uint64_t>(1, std::min(batchSize_, kMaxDeleteObjectsPerRequest));
+  while (obj_list->size() != 0) {
     std::list<std::string> temp_obj_list;
-    auto begin = obj_list.begin();
-    auto end = obj_list.begin();
-    std::advance(end, std::min(batchSize_, obj_list.size()));
-    temp_obj_list.splice(temp_obj_list.begin(), obj_list, begin, end);
+    auto begin = obj_list->begin();
+    auto end = obj_list->begin();
+    std::advance(end, std::min<uint64_t>(batch_size, obj_list->size()));
+    temp_obj_list.splice(temp_obj_list.begin(), *obj_list, begin, end);
     int ret = client_->DeleteBatch(temp_obj_list);
     if (ret != 0) {
-      LOG(ERROR) << "DeleteS3ChunkInfoList failed, fsId = " << fs_id
-                 << ", inodeId =  " << inode_id << ", status code = " << ret;
+      LOG(ERROR) << "DeleteObjects failed, status code = " << ret
+                 << ", first object = " << temp_obj_list.front();
       return -1;
     }
   }
@@ -25,6 +25,7 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include "dingofs/metaserver.pb.h"
 #include "metaserver/s3/metaserver_s3.h"
@@ -73,6 +74,23 @@ class S3ClientAdaptor {
    */
   virtual int Delete(const pb::metaserver::Inode& inode) = 0;
 
+  /**
+   * @brief delete inodes of the same filesystem from s3
+   * @return int
+   *  0   : all inodes delete sucess
+   *  -1  : some inodes delete fail
+   * @details the default implementation deletes inodes one by one
+   */
+  virtual int DeleteInodes(const std::vector<pb::metaserver::Inode>& inodes) {
+    int ret = 0;
+    for (const auto& inode : inodes) {
+      if (Delete(inode) != 0) {
+        ret = -1;
+      }
+    }
+    return ret;
+  }
+
   /**
    * @brief get S3ClientAdaptorOption
    *
@@ -115,6 +133,13 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
    */
   int Delete(const pb::metaserver::Inode& inode) override;
 
+  /**
+   * @brief delete inodes from s3
+   * @details the objects of all inodes are deleted by DeleteObjects in
+   * batch if enableDeleteObjects is true, otherwise one by one
+   */
+  int DeleteInodes(const std::vector<pb::metaserver::Inode>& inodes) override;
+
   /**
    * @brief get S3ClientAdaptorOption
    *
@@ -141,6 +166,8 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
   int DeleteS3ChunkInfoList(uint32_t fs_id, uint64_t inode_id,
                             const S3ChunkInfoList& s3_chunk_infolist);
 
+  int DeleteObjects(std::list<std::string>* obj_list);
+
   void GenObjNameListForChunkInfoList(uint32_t fs_id, uint64_t inode_id,
                                       const S3ChunkInfoList& s3_chunk_infolist,
                                       std::list<std::string>* obj_list);
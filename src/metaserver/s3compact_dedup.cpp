@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metaserver/s3compact_dedup.h"
+
+#include <openssl/sha.h>
+
+namespace dingofs {
+namespace metaserver {
+
+S3DedupTable::S3DedupTable(uint64_t capacity)
+    : cache_(capacity,
+             std::make_shared<utils::CacheMetrics>("s3compact_dedup")),
+      staleBlocks_("s3compact_dedup", "stale_blocks") {}
+
+std::string S3DedupTable::Hash(const std::string& data) {
+  unsigned char digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const unsigned char*>(data.data()), data.size(),
+         digest);
+  return std::string(reinterpret_cast<const char*>(digest), sizeof(digest));
+}
+
+bool S3DedupTable::Get(uint32_t fsId, const std::string& hash,
+                       std::string* objName) {
+  return cache_.Get(Key(fsId, hash), objName);
+}
+
+void S3DedupTable::Put(uint32_t fsId, const std::string& hash,
+                       const std::string& objName) {
+  cache_.Put(Key(fsId, hash), objName);
+}
+
+void S3DedupTable::Remove(uint32_t fsId, const std::string& hash) {
+  staleBlocks_ << 1;
+  cache_.Remove(Key(fsId, hash));
+}
+
+std::string S3DedupTable::Key(uint32_t fsId, const std::string& hash) {
+  std::string key(reinterpret_cast<const char*>(&fsId), sizeof(fsId));
+  key.append(hash);
+  return key;
+}
+
+}  // namespace metaserver
+}  // namespace dingofs
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_METASERVER_S3COMPACT_DEDUP_H_
+#define DINGOFS_SRC_METASERVER_S3COMPACT_DEDUP_H_
+
+#include <bvar/bvar.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "utils/lru_cache.h"
+
+namespace dingofs {
+namespace metaserver {
+
+// Content hash of the objects written by s3 compaction => object name.
+//
+// It is NOT a content-addressed store: the object name is derived from the
+// inode and chunk, and S3ChunkInfo has no indirection, so identical blocks
+// written by different inodes still occupy their own objects. It only lets
+// compaction copy the later block from the earlier one inside s3 instead of
+// uploading the merged data again, which saves the upload bandwidth but not
+// the stored bytes. The entry may be stale
+// because the object is deleted later, the caller should remove it when
+// the copy failed and fall back to upload.
+class S3DedupTable {
+ public:
+  explicit S3DedupTable(uint64_t capacity);
+
+  // Return the sha256 digest of data, which is used as the content hash.
+  static std::string Hash(const std::string& data);
+
+  bool Get(uint32_t fsId, const std::string& hash, std::string* objName);
+
+  void Put(uint32_t fsId, const std::string& hash, const std::string& objName);
+
+  void Remove(uint32_t fsId, const std::string& hash);
+
+ private:
+  // objects of different filesystems may be in different buckets
+  static std::string Key(uint32_t fsId, const std::string& hash);
+
+ private:
+  utils::LRUCache<std::string, std::string> cache_;
+  bvar::Adder<uint64_t> staleBlocks_;
+};
+
+}  // namespace metaserver
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_METASERVER_S3COMPACT_DEDUP_H_
@@ -23,10 +23,16 @@
 #include "metaserver/s3compact_inode.h"
 
 #include <algorithm>
+#include <deque>
+#include <functional>
+#include <future>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -36,6 +42,7 @@
 #include "dingofs/metaserver.pb.h"
 #include "common/s3util.h"
 #include "metaserver/copyset/meta_operator.h"
+#include "metaserver/s3compact_dedup.h"
 #include "metaserver/s3compact_manager.h"
 
 namespace dingofs {
@@ -51,31 +58,47 @@ using pb::metaserver::MetaStatusCode;
 std::vector<uint64_t> CompactInodeJob::GetNeedCompact(
     const ::google::protobuf::Map<uint64_t, S3ChunkInfoList>& s3chunkinfoMap,
     uint64_t inodeLen, uint64_t chunkSize) {
-  std::vector<uint64_t> needCompact;
+  // (priority, index), the chunks out of inode length come first because
+  // they are only removed, then the chunks with more fragments
+  std::vector<std::pair<uint64_t, uint64_t>> candidates;
   for (const auto& item : s3chunkinfoMap) {
-    if (needCompact.size() >= opts_->maxChunksPerCompact) {
-      VLOG(9) << "s3compact: reach max chunks to compact per time";
-      break;
-    }
     if (item.first * chunkSize > inodeLen - 1) {
       // we need delete this chunk
-      needCompact.push_back(item.first);
+      candidates.emplace_back(std::numeric_limits<uint64_t>::max(),
+                              item.first);
       continue;
     }
-    if (static_cast<uint64_t>(item.second.s3chunks_size()) >
-        opts_->fragmentThreshold) {
-      needCompact.push_back(item.first);
+    const auto& l = item.second;
+    const uint64_t fragments = l.s3chunks_size();
+    if (fragments > opts_->fragmentThreshold) {
+      candidates.emplace_back(fragments, item.first);
     } else {
-      const auto& l = item.second;
       for (int i = 0; i < l.s3chunks_size(); i++) {
         if (l.s3chunks(i).offset() + l.s3chunks(i).len() > inodeLen) {
           // part of chunk is useless, we need to delete them
-          needCompact.push_back(item.first);
+          candidates.emplace_back(fragments, item.first);
           break;
         }
       }
     }
   }
+
+  std::sort(candidates.begin(), candidates.end(),
+            [](const std::pair<uint64_t, uint64_t>& lhs,
+               const std::pair<uint64_t, uint64_t>& rhs) {
+              return lhs.first > rhs.first ||
+                     (lhs.first == rhs.first && lhs.second < rhs.second);
+            });
+  if (candidates.size() > opts_->maxChunksPerCompact) {
+    VLOG(9) << "s3compact: reach max chunks to compact per time";
+    candidates.resize(opts_->maxChunksPerCompact);
+  }
+
+  std::vector<uint64_t> needCompact;
+  needCompact.reserve(candidates.size());
+  for (const auto& item : candidates) {
+    needCompact.push_back(item.second);
+  }
   return needCompact;
 }
 
@@ -237,12 +260,37 @@ void CompactInodeJob::GenS3ReadRequests(const struct S3CompactCtx& ctx,
   newChunkInfo->newCompaction = newCompaction;
 }
 
-int CompactInodeJob::ReadFullChunk(const struct S3CompactCtx& ctx,
-                                   const std::list<struct Node>& validList,
-                                   std::string* fullChunk,
-                                   struct S3NewChunkInfo* newChunkInfo) {
+int CompactInodeJob::ReadObject(const struct S3CompactCtx& ctx,
+                                const std::string& objName, std::string* buf) {
+  const Aws::String aws_key(objName.c_str(), objName.size());
+  const auto maxRetry = opts_->s3ReadMaxRetry;
+  const auto retryInterval = opts_->s3ReadRetryInterval;
+  for (uint64_t retry = 0;; retry++) {
+    // why we need retry
+    // if you enable client's diskcache,
+    // metadata may be newer than data in s3
+    // which means you cannot read data from s3
+    // we have to wait data to be flushed to s3
+    int ret = ctx.s3adapter->GetObject(aws_key, buf);
+    if (ret == 0) {
+      S3CompactMetric::GetInstance().readBytes << buf->size();
+      return 0;
+    }
+
+    LOG(WARNING) << "s3compact: get s3 obj " << objName << " failed";
+    if (retry >= maxRetry) return -1;  // no chance
+    LOG(WARNING) << "s3compact: will retry after " << retryInterval
+                 << " seconds, current retry time:" << retry + 1;
+    std::this_thread::sleep_for(std::chrono::seconds(retryInterval));
+  }
+}
+
+int CompactInodeJob::StreamMergeChunk(const struct S3CompactCtx& ctx,
+                                      const std::list<struct Node>& validList,
+                                      struct S3NewChunkInfo* newChunkInfo,
+                                      uint64_t* chunkLen,
+                                      std::vector<std::string>* objsAdded) {
   std::vector<struct S3Request> s3reqs;
-  std::vector<std::string> readContent;
   // generate s3request first
   GenS3ReadRequests(ctx, validList, &s3reqs, newChunkInfo);
   VLOG(9) << "s3compact: s3 request generated";
@@ -251,60 +299,287 @@ int CompactInodeJob::ReadFullChunk(const struct S3CompactCtx& ctx,
             << ", s3objname:" << s3req.objName << ", off:" << s3req.off
             << ", len:" << s3req.len;
   }
-  readContent.resize(s3reqs.size());
-  std::unordered_map<std::string, std::vector<struct S3Request*>> objReqs;
-  for (auto& req : s3reqs) {
-    if (req.zero) {
-      objReqs["zero"].emplace_back(&req);
-    } else {
-      objReqs[req.objName].emplace_back(&req);
+
+  // split the requests into new blocks, the new objs share the block grid
+  // of chunk with the old objs, and the first block starts at newOff which
+  // may be not aligned
+  const auto& blockSize = ctx.blockSize;
+  const uint64_t newOff = newChunkInfo->newOff;
+  const uint64_t offRoundDown = newOff / ctx.chunkSize * ctx.chunkSize;
+  const uint64_t startIndex = (newOff - offRoundDown) / blockSize;
+  std::vector<BlockPlan> plans;
+  plans.push_back(BlockPlan{
+      startIndex, offRoundDown + (startIndex + 1) * blockSize - newOff, 0, {}});
+  *chunkLen = 0;
+  for (const auto& req : s3reqs) {
+    uint64_t off = req.off;
+    uint64_t left = req.len;
+    while (left > 0) {
+      if (plans.back().len == plans.back().capacity) {
+        plans.push_back(BlockPlan{plans.back().index + 1, blockSize, 0, {}});
+      }
+      auto& plan = plans.back();
+      uint64_t n = std::min(left, plan.capacity - plan.len);
+      plan.pieces.push_back(BlockPiece{&req, off, n});
+      plan.len += n;
+      off += n;
+      left -= n;
+      *chunkLen += n;
     }
   }
-  // process zero first and will not fail
-  if (objReqs.find("zero") != objReqs.end()) {
-    for (const auto& req : objReqs["zero"]) {
-      readContent[req->reqIndex] = std::string(req->len, '\0');
+
+  struct PendingPut {
+    std::string objName;
+    uint64_t size;
+    // content hash for dedup, empty if unknown
+    std::string hash;
+    std::future<int> result;
+  };
+
+  auto& metric = S3CompactMetric::GetInstance();
+  int64_t bufferBytes = 0;
+  auto account = [&](int64_t n) {
+    bufferBytes += n;
+    metric.bufferBytes << n;
+    metric.maxChunkBufferBytes << bufferBytes;
+  };
+
+  int ret = 0;
+  std::deque<PendingPut> inflight;
+  auto waitOne = [&]() {
+    auto& put = inflight.front();
+    int r = put.result.get();
+    account(-static_cast<int64_t>(put.size));
+    if (r != 0) {
+      LOG(WARNING) << "s3compact: put s3 object " << put.objName << " failed";
+      ret = r;
+    } else {
+      if (opts_->dedupTable != nullptr && !put.hash.empty()) {
+        opts_->dedupTable->Put(ctx.fsId, put.hash, put.objName);
+      }
+      objsAdded->emplace_back(std::move(put.objName));
+    }
+    inflight.pop_front();
+  };
+  // the put tasks refer to s3adapter and requests, wait them before return
+  auto cleanup = absl::MakeCleanup([&]() {
+    while (!inflight.empty()) {
+      waitOne();
     }
-    objReqs.erase("zero");
-  }
-  // read and process objs one by one
-  uint64_t retry = 0;
-  for (auto it = objReqs.begin(); it != objReqs.end(); it++) {
-    std::string buf;
-    const std::string& objName = it->first;
-    const auto& reqs = it->second;
-    const Aws::String aws_key(objName.c_str(), objName.size());
-    const auto maxRetry = opts_->s3ReadMaxRetry;
-    const auto retryInterval = opts_->s3ReadRetryInterval;
-    while (retry <= maxRetry) {
-      // why we need retry
-      // if you enable client's diskcache,
-      // metadata may be newer than data in s3
-      // which means you cannot read data from s3
-      // we have to wait data to be flushed to s3
-      int ret = ctx.s3adapter->GetObject(aws_key, &buf);
-      if (ret != 0) {
-        LOG(WARNING) << "s3compact: get s3 obj " << objName << " failed";
-        if (retry == maxRetry) return -1;  // no chance
-        retry++;
-        LOG(WARNING) << "s3compact: will retry after " << retryInterval
-                     << " seconds, current retry time:" << retry;
-        std::this_thread::sleep_for(std::chrono::seconds(retryInterval));
+    account(-bufferBytes);
+  });
+
+  const uint64_t maxInflight = std::max<uint64_t>(1, opts_->maxInflightBlocks);
+  auto submit = [&](std::string objName, uint64_t size, std::string hash,
+                    std::function<int()> task) {
+    while (inflight.size() >= maxInflight) {
+      waitOne();
+    }
+    auto put = std::make_shared<std::packaged_task<int()>>(std::move(task));
+    auto result = put->get_future();
+    if (opts_->putPool != nullptr) {
+      opts_->putPool->Enqueue([put]() { (*put)(); });
+    } else {
+      (*put)();
+    }
+    inflight.push_back(PendingPut{std::move(objName), size, std::move(hash),
+                                  std::move(result)});
+  };
+
+  auto* s3adapter = ctx.s3adapter;
+  for (const auto& plan : plans) {
+    if (ret != 0) {
+      return ret;
+    }
+
+    std::string objName = common::s3util::GenObjName(
+        newChunkInfo->newChunkId, plan.index, newChunkInfo->newCompaction,
+        ctx.fsId, ctx.inodeId, ctx.objectPrefix);
+    Aws::String aws_key(objName.c_str(), objName.size());
+
+    // 1. copy the ranges of old objs inside s3, no data is transferred
+    if (CanCopyInS3(plan)) {
+      VLOG(9) << "s3compact: copy " << objName << " in s3, size " << plan.len
+              << ", parts " << plan.pieces.size();
+      auto pieces = plan.pieces;
+      submit(std::move(objName), 0, "",
+             [s3adapter, aws_key, pieces, blockSize]() {
+               return CopyBlockInS3(s3adapter, aws_key, pieces, blockSize);
+             });
+      continue;
+    }
+
+    // 2. read the old objs which are needed by this block, a request never
+    // crosses the block boundary of old objs
+    std::unordered_map<std::string, std::string> objs;
+    std::string block;
+    block.reserve(plan.len);
+    for (const auto& piece : plan.pieces) {
+      const auto& req = *piece.req;
+      if (req.zero) {
+        block.append(piece.len, '\0');
         continue;
       }
-      for (const auto& req : reqs) {
-        readContent[req->reqIndex] = buf.substr(req->off, req->len);
+
+      auto iter = objs.find(req.objName);
+      if (iter == objs.end()) {
+        std::string buf;
+        if (ReadObject(ctx, req.objName, &buf) != 0) {
+          return -1;
+        }
+        account(buf.size());
+        iter = objs.emplace(req.objName, std::move(buf)).first;
+      }
+      const auto& src = iter->second;
+      if (piece.off + piece.len > src.size()) {
+        LOG(WARNING) << "s3compact: s3 obj " << req.objName
+                     << " is too short, size: " << src.size() << ", need: ["
+                     << piece.off << ", " << piece.off + piece.len << ")";
+        return -1;
+      }
+      block.append(src, piece.off, piece.len);
+    }
+    account(block.size());
+    for (const auto& obj : objs) {
+      account(-static_cast<int64_t>(obj.second.size()));
+    }
+
+    // 3. write the block, copy from the identical obj if there is one
+    std::string hash;
+    std::string dupName;
+    auto* dedupTable = opts_->dedupTable;
+    if (dedupTable != nullptr) {
+      hash = S3DedupTable::Hash(block);
+      if (!dedupTable->Get(ctx.fsId, hash, &dupName) || dupName == objName) {
+        dupName.clear();
       }
-      break;
     }
+    VLOG(9) << "s3compact: put " << objName << ", size " << block.size()
+            << (dupName.empty() ? "" : ", copy from " + dupName);
+    uint64_t size = block.size();
+    uint32_t fsId = ctx.fsId;
+    submit(std::move(objName), size, hash,
+           [s3adapter, aws_key, data = std::move(block), dupName, dedupTable,
+            fsId, hash]() {
+             auto& metric = S3CompactMetric::GetInstance();
+             if (!dupName.empty()) {
+               Aws::String src(dupName.c_str(), dupName.size());
+               if (s3adapter->CopyObject(src, aws_key) == 0) {
+                 metric.dedupBytes << data.size();
+                 return 0;
+               }
+               // the identical obj may be deleted
+               dedupTable->Remove(fsId, hash);
+             }
+             metric.writeBytes << data.size();
+             return s3adapter->PutObject(aws_key, data);
+           });
+  }
+
+  while (!inflight.empty()) {
+    waitOne();
   }
+  return ret;
+}
 
-  // merge all read content
-  for (auto content : readContent) {
-    (*fullChunk) += std::move(content);
+bool CompactInodeJob::CanCopyInS3(const BlockPlan& plan) const {
+  const auto minBytes = opts_->serverSideCopyMinBytes;
+  if (minBytes == 0) {
+    return false;
   }
 
-  return 0;
+  for (size_t i = 0; i < plan.pieces.size(); i++) {
+    const auto& piece = plan.pieces[i];
+    if (piece.req->zero || piece.len < minBytes) {
+      return false;
+    }
+    // all parts except the last one of multipart upload must be >= 5MiB
+    if (i + 1 < plan.pieces.size() && piece.len < kMinPartSize) {
+      return false;
+    }
+  }
+  return !plan.pieces.empty();
+}
+
+int CompactInodeJob::CopyBlockInS3(S3Adapter* s3adapter,
+                                   const Aws::String& key,
+                                   const std::vector<BlockPiece>& pieces,
+                                   uint64_t blockSize) {
+  auto& metric = S3CompactMetric::GetInstance();
+  uint64_t size = 0;
+  for (const auto& piece : pieces) {
+    size += piece.len;
+  }
+
+  // the whole old obj, a full block is always a whole obj
+  const auto& first = pieces.front();
+  if (pieces.size() == 1 && first.off == 0 && first.len == blockSize) {
+    Aws::String src(first.req->objName.c_str(), first.req->objName.size());
+    int ret = s3adapter->CopyObject(src, key);
+    if (ret == 0) {
+      metric.copiedBytes << size;
+    }
+    return ret;
+  }
+
+  Aws::String uploadId = s3adapter->MultiUploadInit(key);
+  if (uploadId.empty()) {
+    return -1;
+  }
+  Aws::Vector<Aws::S3::Model::CompletedPart> parts;
+  int partNum = 1;
+  for (const auto& piece : pieces) {
+    Aws::String src(piece.req->objName.c_str(), piece.req->objName.size());
+    auto part = s3adapter->UploadPartCopy(key, uploadId, partNum, src,
+                                          piece.off, piece.len);
+    if (part.GetPartNumber() < 0) {
+      s3adapter->AbortMultiUpload(key, uploadId);
+      return -1;
+    }
+    parts.push_back(std::move(part));
+    partNum++;
+  }
+
+  int ret = s3adapter->CompleteMultiUpload(key, uploadId, parts);
+  if (ret == 0) {
+    metric.copiedBytes << size;
+  }
+  return ret;
+}
+
+bool CompactInodeJob::GetRetainedChunkInfos(
+    const S3ChunkInfoList& s3chunkinfolist,
+    const std::list<struct Node>& validList, S3ChunkInfoList* retained) {
+  // nothing to drop, or still too many fragments after dropping
+  const auto total = static_cast<size_t>(s3chunkinfolist.s3chunks_size());
+  if (validList.size() >= total ||
+      validList.size() > opts_->fragmentThreshold) {
+    return false;
+  }
+
+  std::set<std::pair<uint64_t, uint64_t>> visible;  // (chunkid, compaction)
+  for (const auto& node : validList) {
+    if (node.begin != node.chunkoff ||
+        node.end + 1 != node.chunkoff + node.chunklen) {
+      return false;  // part of s3chunkinfo is visible
+    }
+    visible.emplace(node.chunkid, node.compaction);
+  }
+
+  retained->Clear();
+  for (const auto& info : s3chunkinfolist.s3chunks()) {
+    if (visible.count(std::make_pair(info.chunkid(), info.compaction()))) {
+      *retained->add_s3chunks() = info;
+    }
+  }
+  // the retained ones never overlap, keep them sorted by chunkid which
+  // the range of s3chunkinfo list key is built from
+  std::sort(retained->mutable_s3chunks()->begin(),
+            retained->mutable_s3chunks()->end(),
+            [](const S3ChunkInfo& lhs, const S3ChunkInfo& rhs) {
+              return lhs.chunkid() < rhs.chunkid();
+            });
+  return true;
 }
 
 MetaStatusCode CompactInodeJob::UpdateInode(
@@ -332,41 +607,6 @@ MetaStatusCode CompactInodeJob::UpdateInode(
   return response.statuscode();
 }
 
-int CompactInodeJob::WriteFullChunk(const struct S3CompactCtx& ctx,
-                                    const struct S3NewChunkInfo& newChunkInfo,
-                                    const std::string& fullChunk,
-                                    std::vector<std::string>* objsAdded) {
-  uint64_t chunkLen = fullChunk.length();
-  const auto& blockSize = ctx.blockSize;
-  const auto& chunkSize = ctx.chunkSize;
-  const auto& newOff = newChunkInfo.newOff;
-  uint64_t offRoundDown = newOff / chunkSize * chunkSize;
-  uint64_t startIndex = (newOff - newOff / chunkSize * chunkSize) / blockSize;
-  for (uint64_t index = startIndex;
-       index * blockSize + offRoundDown < newOff + chunkLen; index += 1) {
-    std::string objName = common::s3util::GenObjName(
-        newChunkInfo.newChunkId, index, newChunkInfo.newCompaction, ctx.fsId,
-        ctx.inodeId, ctx.objectPrefix);
-    const Aws::String aws_key(objName.c_str(), objName.size());
-    int ret;
-    uint64_t s3objBegin = std::max(newOff, offRoundDown + index * blockSize);
-    uint64_t s3objEnd = std::min(newOff + chunkLen - 1,
-                                 offRoundDown + (index + 1) * blockSize - 1);
-    VLOG(9) << "s3compact: put " << objName << ", [" << s3objBegin << "-"
-            << s3objEnd << "]";
-    ret = ctx.s3adapter->PutObject(
-        aws_key,
-        fullChunk.substr(s3objBegin - newOff, s3objEnd - s3objBegin + 1));
-    if (ret != 0) {
-      LOG(WARNING) << "s3compact: put s3 object " << objName << " failed";
-      return ret;
-    } else {
-      objsAdded->emplace_back(std::move(objName));
-    }
-  }
-  return 0;
-}
-
 bool CompactInodeJob::CompactPrecheck(const struct S3CompactTask& task,
                                       Inode* inode) {
   // am i copysetnode leader?
@@ -470,31 +710,43 @@ void CompactInodeJob::CompactChunk(
     s3ChunkInfoRemove->insert({index, s3chunkinfolist});
     return;
   }
-  // 1.2  first read full chunk
-  struct S3NewChunkInfo newChunkInfo;
-  std::string fullChunk;
-  int ret = ReadFullChunk(compactCtx, validList, &fullChunk, &newChunkInfo);
-  if (ret != 0) {
-    LOG(WARNING) << "s3compact: ReadFullChunk failed, index " << index;
-    opts_->s3infoCache->InvalidateS3Info(
-        compactCtx.fsId);  // maybe s3info changed?
+  // 1.2 all valid ranges are whole s3chunkinfos, just drop the others
+  S3ChunkInfoList retained;
+  if (GetRetainedChunkInfos(s3chunkinfolist, validList, &retained)) {
+    uint64_t skipped = 0;
+    for (const auto& info : retained.s3chunks()) {
+      skipped += info.len();
+    }
+    VLOG(6) << "s3compact: retain " << retained.s3chunks_size()
+            << " s3chunkinfos of " << s3chunkinfolist.s3chunks_size()
+            << ", skip copying " << skipped << " bytes";
+    auto& metric = S3CompactMetric::GetInstance();
+    metric.retainedChunks << 1;
+    metric.skippedBytes << skipped;
+    s3ChunkInfoAdd->insert({index, std::move(retained)});
+    s3ChunkInfoRemove->insert({index, s3chunkinfolist});
     return;
   }
-  VLOG(6) << "s3compact: finish read full chunk, size: " << fullChunk.size();
-  VLOG(6) << "s3compact: new s3chunk info will be id:"
-          << newChunkInfo.newChunkId << ", off:" << newChunkInfo.newOff
-          << ", compaction:" << newChunkInfo.newCompaction;
-  // 1.3 then write objs with newChunkid and newCompaction
+
+  // 1.3 read the valid ranges and write objs with newChunkid and
+  // newCompaction in a streaming way
+  struct S3NewChunkInfo newChunkInfo;
+  uint64_t chunkLen = 0;
   std::vector<std::string> objsAdded;
-  ret = WriteFullChunk(compactCtx, newChunkInfo, fullChunk, &objsAdded);
+  int ret = StreamMergeChunk(compactCtx, validList, &newChunkInfo, &chunkLen,
+                             &objsAdded);
   if (ret != 0) {
-    LOG(WARNING) << "s3compact: WriteFullChunk failed, index " << index;
+    LOG(WARNING) << "s3compact: StreamMergeChunk failed, index " << index;
     opts_->s3infoCache->InvalidateS3Info(
         compactCtx.fsId);  // maybe s3info changed?
     DeleteObjs(objsAdded, compactCtx.s3adapter);
     return;
   }
-  VLOG(6) << "s3compact: finish write full chunk";
+  VLOG(6) << "s3compact: finish merge chunk, size: " << chunkLen
+          << ", new s3chunk info id:" << newChunkInfo.newChunkId
+          << ", off:" << newChunkInfo.newOff
+          << ", compaction:" << newChunkInfo.newCompaction;
+  S3CompactMetric::GetInstance().compactedChunks << 1;
   // 1.4 record add/delete
   objsAddedMap->emplace(index, std::move(objsAdded));
   // to add
@@ -503,8 +755,8 @@ void CompactInodeJob::CompactChunk(
   toAdd.set_chunkid(newChunkInfo.newChunkId);
   toAdd.set_compaction(newChunkInfo.newCompaction);
   toAdd.set_offset(newChunkInfo.newOff);
-  toAdd.set_len(fullChunk.length());
-  toAdd.set_size(fullChunk.length());
+  toAdd.set_len(chunkLen);
+  toAdd.set_size(chunkLen);
   toAdd.set_zero(false);
   *toAddList.add_s3chunks() = std::move(toAdd);
   s3ChunkInfoAdd->insert({index, std::move(toAddList)});
@@ -513,9 +765,19 @@ void CompactInodeJob::CompactChunk(
 }
 
 void CompactInodeJob::DeleteObjsOfS3ChunkInfoList(
-    const struct S3CompactCtx& ctx, const S3ChunkInfoList& s3chunkinfolist) {
+    const struct S3CompactCtx& ctx, const S3ChunkInfoList& s3chunkinfolist,
+    const S3ChunkInfoList& kept) {
+  std::set<std::pair<uint64_t, uint64_t>> keptSet;  // (chunkid, compaction)
+  for (const auto& info : kept.s3chunks()) {
+    keptSet.emplace(info.chunkid(), info.compaction());
+  }
+
   for (auto i = 0; i < s3chunkinfolist.s3chunks_size(); i++) {
     const auto& chunkinfo = s3chunkinfolist.s3chunks(i);
+    if (keptSet.count(
+            std::make_pair(chunkinfo.chunkid(), chunkinfo.compaction()))) {
+      continue;
+    }
     uint64_t off = chunkinfo.offset();
     uint64_t len = chunkinfo.len();
     uint64_t offRoundDown = off / ctx.chunkSize * ctx.chunkSize;
@@ -597,6 +859,8 @@ void CompactInodeJob::CompactChunks(const S3CompactTask& task) {
   for (const auto& element : s3ChunkInfoRemove) {
     s3ChunkInfoRemoveIndex.push_back(element.first);
   }
+  // the objs of added (e.g. retained) s3chunkinfos must not be deleted
+  auto s3ChunkInfoKept = s3ChunkInfoAdd;
   auto ret =
       UpdateInode(task.copysetNodeWrapper->Get(), compactCtx.pinfo, inodeId,
                   std::move(s3ChunkInfoAdd), std::move(s3ChunkInfoRemove));
@@ -616,7 +880,10 @@ void CompactInodeJob::CompactChunks(const S3CompactTask& task) {
   VLOG(6) << "s3compact: start delete old objs";
   for (const auto& index : s3ChunkInfoRemoveIndex) {
     const auto& l = inode.s3chunkinfomap().at(index);
-    DeleteObjsOfS3ChunkInfoList(compactCtx, l);
+    auto iter = s3ChunkInfoKept.find(index);
+    DeleteObjsOfS3ChunkInfoList(
+        compactCtx, l,
+        iter == s3ChunkInfoKept.end() ? S3ChunkInfoList() : iter->second);
   }
   VLOG(6) << "s3compact: finish delete objs";
   opts_->s3adapterManager->ReleaseS3Adapter(s3adapterIndex);
@@ -23,6 +23,8 @@
 #ifndef DINGOFS_SRC_METASERVER_S3COMPACT_INODE_H_
 #define DINGOFS_SRC_METASERVER_S3COMPACT_INODE_H_
 
+#include <bvar/bvar.h>
+
 #include <condition_variable>
 #include <list>
 #include <memory>
@@ -56,6 +58,46 @@ class CopysetNodeWrapper {
 
 struct S3CompactionWorkerOptions;
 
+// metrics of s3 compaction, shared by all workers
+struct S3CompactMetric {
+  S3CompactMetric()
+      : readBytes("s3compact", "read_bytes"),
+        readBps("s3compact", "read_bps", &readBytes, 1),
+        writeBytes("s3compact", "write_bytes"),
+        writeBps("s3compact", "write_bps", &writeBytes, 1),
+        compactedChunks("s3compact", "compacted_chunks"),
+        retainedChunks("s3compact", "retained_chunks"),
+        skippedBytes("s3compact", "skipped_bytes"),
+        copiedBytes("s3compact", "copied_bytes"),
+        dedupBytes("s3compact", "dedup_bytes"),
+        bufferBytes("s3compact", "buffer_bytes"),
+        maxChunkBufferBytes("s3compact", "max_chunk_buffer_bytes") {}
+
+  static S3CompactMetric& GetInstance() {
+    static S3CompactMetric instance;
+    return instance;
+  }
+
+  bvar::Adder<uint64_t> readBytes;
+  bvar::PerSecond<bvar::Adder<uint64_t>> readBps;
+  bvar::Adder<uint64_t> writeBytes;
+  bvar::PerSecond<bvar::Adder<uint64_t>> writeBps;
+  // chunks rewritten to new objects
+  bvar::Adder<uint64_t> compactedChunks;
+  // chunks compacted by only dropping the invisible s3chunkinfos
+  bvar::Adder<uint64_t> retainedChunks;
+  // bytes of retained s3chunkinfos which are not copied
+  bvar::Adder<uint64_t> skippedBytes;
+  // bytes of new objs copied from old objs inside s3
+  bvar::Adder<uint64_t> copiedBytes;
+  // upload bytes saved by copying from the identical objs inside s3,
+  // the copies still take their own storage
+  bvar::Adder<uint64_t> dedupBytes;
+  // bytes held by the buffers of merging chunks
+  bvar::Adder<int64_t> bufferBytes;
+  bvar::Maxer<int64_t> maxChunkBufferBytes;
+};
+
 class CompactInodeJob {
  public:
   explicit CompactInodeJob(const S3CompactWorkerOptions* opts) : opts_(opts) {}
@@ -106,6 +148,21 @@ class CompactInodeJob {
           len(len) {}
   };
 
+  // range of new block, which comes from old obj or zero
+  struct BlockPiece {
+    const S3Request* req;
+    // offset in old obj
+    uint64_t off;
+    uint64_t len;
+  };
+
+  struct BlockPlan {
+    uint64_t index;
+    uint64_t capacity;
+    uint64_t len;
+    std::vector<BlockPiece> pieces;
+  };
+
   // node for building valid list
   struct Node {
     uint64_t begin;
@@ -163,19 +220,39 @@ class CompactInodeJob {
                          const std::list<struct Node>& validList,
                          std::vector<struct S3Request>* reqs,
                          struct S3NewChunkInfo* newChunkInfo);
-  int ReadFullChunk(const struct S3CompactCtx& ctx,
-                    const std::list<struct Node>& validList,
-                    std::string* fullChunk,
-                    struct S3NewChunkInfo* newChunkInfo);
+  // read the whole object, retry if failed
+  int ReadObject(const struct S3CompactCtx& ctx, const std::string& objName,
+                 std::string* buf);
+  // Read the valid ranges in order and write them to new objs block by
+  // block, only the objs of current block and at most `maxInflightBlocks`
+  // blocks being written are buffered. The reading of next block overlaps
+  // with the writing of previous blocks. The blocks made up of large ranges
+  // are copied inside s3, and the blocks identical to the objs written
+  // before are copied from them if dedup is enabled.
+  int StreamMergeChunk(const struct S3CompactCtx& ctx,
+                       const std::list<struct Node>& validList,
+                       struct S3NewChunkInfo* newChunkInfo,
+                       uint64_t* chunkLen, std::vector<std::string>* objsAdded);
+  // min size of the parts except the last one in multipart upload
+  static constexpr uint64_t kMinPartSize = 5 * 1024 * 1024;
+  // Whether the block can be assembled from old objs inside s3, which
+  // requires all pieces are from old objs and large enough.
+  bool CanCopyInS3(const struct BlockPlan& plan) const;
+  // Copy the whole old obj or upload the pieces by UploadPartCopy.
+  static int CopyBlockInS3(aws::S3Adapter* s3adapter, const Aws::String& key,
+                           const std::vector<struct BlockPiece>& pieces,
+                           uint64_t blockSize);
+  // If all valid ranges are whole s3chunkinfos, return them in `retained`,
+  // the chunk can be compacted by only dropping the other s3chunkinfos
+  // instead of copying data.
+  bool GetRetainedChunkInfos(const S3ChunkInfoList& s3chunkinfolist,
+                             const std::list<struct Node>& validList,
+                             S3ChunkInfoList* retained);
   virtual pb::metaserver::MetaStatusCode UpdateInode(
       copyset::CopysetNode* copysetNode, const pb::common::PartitionInfo& pinfo,
       uint64_t inodeId,
       ::google::protobuf::Map<uint64_t, S3ChunkInfoList>&& s3ChunkInfoAdd,
       ::google::protobuf::Map<uint64_t, S3ChunkInfoList>&& s3ChunkInfoRemove);
-  int WriteFullChunk(const struct S3CompactCtx& ctx,
-                     const struct S3NewChunkInfo& newChunkInfo,
-                     const std::string& fullChunk,
-                     std::vector<std::string>* objsAdded);
   void CompactChunk(
       const struct S3CompactCtx& compactCtx, uint64_t index,
       const pb::metaserver::Inode& inode,
@@ -183,8 +260,10 @@ class CompactInodeJob {
       ::google::protobuf::Map<uint64_t, S3ChunkInfoList>* s3ChunkInfoAdd,
       ::google::protobuf::Map<uint64_t, S3ChunkInfoList>* s3ChunkInfoRemove);
 
+  // delete objs of s3chunkinfos except the ones in `kept`
   void DeleteObjsOfS3ChunkInfoList(const struct S3CompactCtx& ctx,
-                                   const S3ChunkInfoList& s3chunkinfolist);
+                                   const S3ChunkInfoList& s3chunkinfolist,
+                                   const S3ChunkInfoList& kept);
   // func bind with task
   void CompactChunks(const S3CompactTask& task);
 };
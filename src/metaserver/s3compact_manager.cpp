@@ -22,6 +22,7 @@
 
 #include "metaserver/s3compact_manager.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <list>
 #include <mutex>
@@ -117,6 +118,19 @@ void S3CompactWorkQueueOption::Init(std::shared_ptr<Configuration> conf) {
   conf->GetValueFatalIfFail("s3compactwq.s3_read_max_retry", &s3ReadMaxRetry);
   conf->GetValueFatalIfFail("s3compactwq.s3_read_retry_interval",
                             &s3ReadRetryInterval);
+  LOG_IF(WARNING, !conf->GetUInt64Value("s3compactwq.max_inflight_blocks",
+                                         &maxInflightBlocks))
+      << "Not found `s3compactwq.max_inflight_blocks` in conf, default: "
+      << maxInflightBlocks;
+  LOG_IF(WARNING,
+         !conf->GetUInt64Value("s3compactwq.server_side_copy_min_bytes",
+                               &serverSideCopyMinBytes))
+      << "Not found `s3compactwq.server_side_copy_min_bytes` in conf, "
+      << "default: " << serverSideCopyMinBytes;
+  LOG_IF(WARNING,
+         !conf->GetUInt64Value("s3compactwq.dedup_table_size", &dedupTableSize))
+      << "Not found `s3compactwq.dedup_table_size` in conf, default: "
+      << dedupTableSize;
 }
 
 void S3CompactManager::Init(std::shared_ptr<Configuration> conf) {
@@ -142,6 +156,14 @@ void S3CompactManager::Init(std::shared_ptr<Configuration> conf) {
     workerOptions_.fragmentThreshold = opts_.fragmentThreshold;
     workerOptions_.s3ReadMaxRetry = opts_.s3ReadMaxRetry;
     workerOptions_.s3ReadRetryInterval = opts_.s3ReadRetryInterval;
+    workerOptions_.maxInflightBlocks = opts_.maxInflightBlocks;
+    workerOptions_.serverSideCopyMinBytes = opts_.serverSideCopyMinBytes;
+    if (opts_.dedupTableSize > 0) {
+      dedupTable_ = absl::make_unique<S3DedupTable>(opts_.dedupTableSize);
+    }
+    workerOptions_.dedupTable = dedupTable_.get();
+    putPool_ = absl::make_unique<TaskThreadPool<>>("s3compact_put");
+    workerOptions_.putPool = putPool_.get();
     workerOptions_.sleepMS = opts_.enqueueSleepMS;
 
     inited_ = true;
@@ -187,6 +209,9 @@ int S3CompactManager::Run() {
   }
 
   if (!workerContext_.running.exchange(true)) {
+    // every worker puts at most maxInflightBlocks blocks at the same time
+    putPool_->Start(
+        std::max<uint64_t>(1, opts_.threadNum * opts_.maxInflightBlocks));
     for (uint64_t i = 0; i < opts_.threadNum; ++i) {
       workers_.push_back(absl::make_unique<S3CompactWorker>(
           this, &workerContext_, &workerOptions_));
@@ -206,6 +231,8 @@ void S3CompactManager::Stop() {
   for (auto& worker : workers_) {
     worker->Stop();
   }
+  // the workers wait for their puts before exit
+  putPool_->Stop();
 
   s3adapterManager_->Deinit();
 }
@@ -30,6 +30,7 @@
 #include <vector>
 
 #include "metaserver/s3compact.h"
+#include "metaserver/s3compact_dedup.h"
 #include "metaserver/s3compact_worker.h"
 #include "metaserver/s3infocache.h"
 #include "utils/configuration.h"
@@ -70,6 +71,9 @@ struct S3CompactWorkQueueOption {
   uint64_t s3infocacheSize;
   uint64_t s3ReadMaxRetry;
   uint64_t s3ReadRetryInterval;
+  uint64_t maxInflightBlocks = 4;
+  uint64_t serverSideCopyMinBytes = 0;
+  uint64_t dedupTableSize = 0;
 
   void Init(std::shared_ptr<utils::Configuration> conf);
 };
@@ -79,6 +83,8 @@ class S3CompactManager {
   S3CompactWorkQueueOption opts_;
   std::unique_ptr<S3InfoCache> s3infoCache_;
   std::unique_ptr<S3AdapterManager> s3adapterManager_;
+  std::unique_ptr<S3DedupTable> dedupTable_;
+  std::unique_ptr<utils::TaskThreadPool<>> putPool_;
 
   S3CompactWorkerContext workerContext_;
   S3CompactWorkerOptions workerOptions_;
@@ -24,11 +24,14 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/cleanup/cleanup.h"
 #include "common/threading.h"
@@ -107,6 +110,36 @@ void S3CompactWorker::CleanupCompact(bool again) {
   s3Compact_.reset();
 }
 
+void S3CompactWorker::SortByReadAmplification(std::list<uint64_t>* inodes) {
+  const auto& inodeManager = s3Compact_->inodeManager;
+  auto reads = inodeManager->TakeS3ChunkInfoReads();
+  // one scan of the partition for all inodes, keep the id order if failed
+  std::unordered_map<uint64_t, uint64_t> fragments;
+  if (!inodeManager->GetAllInodeS3MetaSize(&fragments)) {
+    return;
+  }
+
+  std::vector<std::pair<uint64_t, uint64_t>> scores;  // (score, inodeId)
+  scores.reserve(inodes->size());
+  for (auto ino : *inodes) {
+    auto iter = fragments.find(ino);
+    uint64_t nfragment = (iter == fragments.end()) ? 0 : iter->second;
+    iter = reads.find(ino);
+    uint64_t nread = (iter == reads.end()) ? 0 : iter->second;
+    scores.emplace_back(nfragment * (1 + nread), ino);
+  }
+
+  std::stable_sort(scores.begin(), scores.end(),
+                   [](const std::pair<uint64_t, uint64_t>& lhs,
+                      const std::pair<uint64_t, uint64_t>& rhs) {
+                     return lhs.first > rhs.first;
+                   });
+  inodes->clear();
+  for (const auto& item : scores) {
+    inodes->push_back(item.second);
+  }
+}
+
 bool S3CompactWorker::CompactInodes(const std::list<uint64_t>& inodes,
                                     copyset::CopysetNode* node) {
   if (inodes.empty()) {
@@ -187,6 +220,7 @@ void S3CompactWorker::CompactWorker() {
       continue;
     }
 
+    SortByReadAmplification(&inodes);
     compactAgain = CompactInodes(inodes, s3Compact_->copysetNode.get());
   }
 
@@ -32,6 +32,7 @@
 
 #include "absl/types/optional.h"
 #include "metaserver/s3compact.h"
+#include "utils/concurrent/task_thread_pool.h"
 #include "utils/interruptible_sleeper.h"
 
 namespace dingofs {
@@ -43,6 +44,7 @@ class CopysetNode;
 
 class S3AdapterManager;
 class S3CompactManager;
+class S3DedupTable;
 class S3CompactWorker;
 class S3InfoCache;
 
@@ -65,6 +67,16 @@ struct S3CompactWorkerOptions {
   uint64_t fragmentThreshold;
   uint64_t s3ReadMaxRetry;
   uint64_t s3ReadRetryInterval;
+  // max number of new blocks being written while merging one chunk
+  uint64_t maxInflightBlocks = 4;
+  // copy the block inside s3 if all its ranges are at least this size,
+  // 0 means always download and upload
+  uint64_t serverSideCopyMinBytes = 0;
+  // content hash => obj written before, nullptr means dedup disabled
+  S3DedupTable* dedupTable = nullptr;
+  // pool shared by all workers to put the new blocks,
+  // nullptr means put them in the worker thread
+  utils::TaskThreadPool<>* putPool = nullptr;
 
   // sleep interval in ms between compacting two inodes
   uint64_t sleepMS;
@@ -90,6 +102,11 @@ class S3CompactWorker {
   // Return true if we've got a partition to compact, otherwise return false
   bool WaitCompact();
 
+  // Sort inodes by read amplification, which is estimated by the number of
+  // s3chunkinfos (fragments) and the reads of them since last round, so the
+  // inodes hurting read most are compacted first
+  void SortByReadAmplification(std::list<uint64_t>* inodes);
+
   // Return whether compact current partition again
   bool CompactInodes(const std::list<uint64_t>& inodes,
                      copyset::CopysetNode* node);
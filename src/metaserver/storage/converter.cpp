@@ -61,7 +61,8 @@ NameGenerator::NameGenerator(uint32_t partitionId)
       tableName4VolumeExtent_(Format(kTypeVolumeExtent, partitionId)),
       tableName4InodeAuxInfo_(Format(kTypeInodeAuxInfo, partitionId)),
       tableName4FsQuota_(Format(kTypeFsQuota, 0)),
-      tableName4DirQuota_(Format(kTypeDirQuota, 0)) {}
+      tableName4DirQuota_(Format(kTypeDirQuota, 0)),
+      tableName4TrashItem_(Format(kTypeTrashItem, partitionId)) {}
 
 std::string NameGenerator::GetInodeTableName() const {
   return tableName4Inode_;
@@ -91,12 +92,27 @@ std::string NameGenerator::GetDirQuotaTableName() const {
   return tableName4DirQuota_;
 }
 
+std::string NameGenerator::GetTrashItemTableName() const {
+  return tableName4TrashItem_;
+}
+
 size_t NameGenerator::GetFixedLength() {
   size_t length = sizeof(kTypeInode) + sizeof(uint32_t) + strlen(kDelimiter);
   LOG(INFO) << "Tablename fixed length is " << length;
   return length;
 }
 
+KEY_TYPE NameGenerator::GetTableType(const std::string& name) {
+  // e.g. "1:" + 4 bytes partition id
+  static const size_t length = GetFixedLength();
+  uint32_t type;
+  if (name.size() != length || name[1] != kDelimiter[0] ||
+      !StringToUl(name.substr(0, 1), &type)) {
+    return static_cast<KEY_TYPE>(0);
+  }
+  return static_cast<KEY_TYPE>(type);
+}
+
 std::string NameGenerator::Format(KEY_TYPE type, uint32_t partitionId) {
   char buf[sizeof(partitionId)];
   std::memcpy(buf, reinterpret_cast<char*>(&partitionId), sizeof(buf));
@@ -375,6 +391,25 @@ bool Prefix4DirQuotas::ParseFromString(const std::string& value) {
          StringToUl(items[1], &fs_id);
 }
 
+Key4TrashItem::Key4TrashItem() : dtime(0), fsId(0), inodeId(0) {}
+
+Key4TrashItem::Key4TrashItem(uint32_t dtime, uint32_t fsId, uint64_t inodeId)
+    : dtime(dtime), fsId(fsId), inodeId(inodeId) {}
+
+std::string Key4TrashItem::SerializeToString() const {
+  return absl::StrCat(kKeyType, kDelimiter,
+                      absl::StrFormat("%010" PRIu32 "", dtime), kDelimiter,
+                      fsId, kDelimiter, inodeId);
+}
+
+bool Key4TrashItem::ParseFromString(const std::string& value) {
+  std::vector<std::string> items;
+  SplitString(value, kDelimiter, &items);
+  return items.size() == 4 && CompareType(items[0], kKeyType) &&
+         StringToUl(items[1], &dtime) && StringToUl(items[2], &fsId) &&
+         StringToUll(items[3], &inodeId);
+}
+
 std::string Converter::SerializeToString(const StorageKey& key) {
   return key.SerializeToString();
 }
@@ -45,6 +45,7 @@ enum KEY_TYPE : unsigned char {
   kTypeInodeAuxInfo = 5,
   kTypeFsQuota = 6,
   kTypeDirQuota = 7,
+  kTypeTrashItem = 8,
 };
 
 // NOTE: you must generate all table name by NameGenerator class for
@@ -68,8 +69,14 @@ class NameGenerator {
 
   std::string GetDirQuotaTableName() const;
 
+  std::string GetTrashItemTableName() const;
+
   static size_t GetFixedLength();
 
+  // Return the table type of the name generated by NameGenerator,
+  // or 0 if the name is not generated by NameGenerator.
+  static KEY_TYPE GetTableType(const std::string& name);
+
  private:
   std::string Format(KEY_TYPE type, uint32_t partitionId);
 
@@ -81,6 +88,7 @@ class NameGenerator {
   std::string tableName4InodeAuxInfo_;
   std::string tableName4FsQuota_;
   std::string tableName4DirQuota_;
+  std::string tableName4TrashItem_;
 };
 
 class StorageKey {
@@ -110,6 +118,7 @@ class StorageKey {
  *   Key4FsQuota                      : kTypeFsQuota:fsId
  *   Key4DirQuota                     : kTypeDirQuota:fsId:inodeId
  *   Prefix4DirQuota                  : kTypeDirQuota:fsId:
+ *   Key4TrashItem                    : kTypeTrashItem:dtime:fsId:inodeId
  */
 
 class Key4Inode : public StorageKey {
@@ -379,6 +388,28 @@ class Prefix4DirQuotas : public StorageKey {
   static constexpr KEY_TYPE kKeyType = kTypeDirQuota;
 };
 
+// The dtime is formatted in fixed width, so the trash items are sorted
+// by the time they were deleted, and the expired items are always
+// a prefix of the trash item table.
+class Key4TrashItem : public StorageKey {
+ public:
+  Key4TrashItem();
+
+  Key4TrashItem(uint32_t dtime, uint32_t fsId, uint64_t inodeId);
+
+  std::string SerializeToString() const override;
+
+  bool ParseFromString(const std::string& value) override;
+
+ public:
+  uint32_t dtime;
+  uint32_t fsId;
+  uint64_t inodeId;
+
+ private:
+  static constexpr KEY_TYPE kKeyType = kTypeTrashItem;
+};
+
 // converter
 class Converter {
  public:
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metaserver/storage/rocksdb_counter.h"
+
+namespace dingofs {
+namespace metaserver {
+namespace storage {
+
+std::string EncodeCounter(int64_t value) {
+  auto u = static_cast<uint64_t>(value);
+  std::string buffer(sizeof(uint64_t), '\0');
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    buffer[i] = static_cast<char>((u >> (i * 8)) & 0xff);
+  }
+  return buffer;
+}
+
+int64_t DecodeCounter(const rocksdb::Slice& value) {
+  if (value.size() != sizeof(uint64_t)) {
+    return 0;
+  }
+
+  uint64_t u = 0;
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    u |= static_cast<uint64_t>(static_cast<unsigned char>(value[i])) << (i * 8);
+  }
+  return static_cast<int64_t>(u);
+}
+
+bool CounterMergeOperator::Merge(const rocksdb::Slice& /*key*/,
+                                 const rocksdb::Slice* existing_value,
+                                 const rocksdb::Slice& value,
+                                 std::string* new_value,
+                                 rocksdb::Logger* /*logger*/) const {
+  int64_t counter = (existing_value == nullptr) ? 0
+                                                : DecodeCounter(*existing_value);
+  *new_value = EncodeCounter(counter + DecodeCounter(value));
+  return true;
+}
+
+}  // namespace storage
+}  // namespace metaserver
+}  // namespace dingofs
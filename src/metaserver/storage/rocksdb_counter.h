@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_METASERVER_STORAGE_ROCKSDB_COUNTER_H_
+#define DINGOFS_SRC_METASERVER_STORAGE_ROCKSDB_COUNTER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "rocksdb/merge_operator.h"
+#include "rocksdb/slice.h"
+
+namespace dingofs {
+namespace metaserver {
+namespace storage {
+
+// The counter value is a 8 bytes little-endian signed integer.
+std::string EncodeCounter(int64_t value);
+
+int64_t DecodeCounter(const rocksdb::Slice& value);
+
+// Merge operator which adds the delta to counter, so the counter can be
+// updated by rocksdb's merge without read-modify-write.
+class CounterMergeOperator : public rocksdb::AssociativeMergeOperator {
+ public:
+  bool Merge(const rocksdb::Slice& key, const rocksdb::Slice* existing_value,
+             const rocksdb::Slice& value, std::string* new_value,
+             rocksdb::Logger* logger) const override;
+
+  const char* Name() const override { return "DingoFSCounterMergeOperator"; }
+};
+
+}  // namespace storage
+}  // namespace metaserver
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_METASERVER_STORAGE_ROCKSDB_COUNTER_H_
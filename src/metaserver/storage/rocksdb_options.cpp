@@ -27,8 +27,10 @@
 #include <memory>
 #include <mutex>
 
+#include "metaserver/storage/rocksdb_counter.h"
 #include "metaserver/storage/rocksdb_event_listener.h"
 #include "metaserver/storage/rocksdb_storage.h"
+#include "metaserver/storage/row_cache.h"
 #include "rocksdb/filter_policy.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/table.h"
@@ -93,6 +95,18 @@ DEFINE_int32(rocksdb_max_write_buffer_size_to_maintain, 20ULL << 20,
 DEFINE_int32(rocksdb_stats_dump_period_sec, 180,
              "Dump rocksdb.stats to LOG every stats_dump_period_sec");
 
+DEFINE_bool(rocksdb_per_table_column_family, false,
+            "Store inode, dentry and s3chunkinfo tables in dedicated column "
+            "families, the existing data will be migrated when open");
+
+DEFINE_int64(rocksdb_s3chunkinfo_cf_ttl_sec, 86400,
+             "Files older than ttl in s3chunkinfo column family will be "
+             "compacted, which drops the tombstones of compacted lists");
+
+DEFINE_int32(rocksdb_s3chunkinfo_cf_level0_file_num_compaction_trigger, 4,
+             "Number of files to trigger level-0 compaction for s3chunkinfo "
+             "column family");
+
 namespace {
 
 std::shared_ptr<rocksdb::Cache> rocksdbBlockCache;
@@ -100,6 +114,40 @@ std::shared_ptr<rocksdb::WriteBufferManager> rocksdbWriteBufferManager;
 std::shared_ptr<MetricEventListener> metricEventListener;
 
 const char* const kOrderedColumnFamilyName = "ordered_column_family";
+const char* const kInodeColumnFamilyName = "inode_column_family";
+const char* const kDentryColumnFamilyName = "dentry_column_family";
+const char* const kS3ChunkInfoColumnFamilyName = "s3chunkinfo_column_family";
+
+class DentryPrefixTransform : public rocksdb::SliceTransform {
+ public:
+  explicit DentryPrefixTransform(size_t keyOffset) : keyOffset_(keyOffset) {}
+
+  const char* Name() const override { return "dingofs.DentryPrefix"; }
+
+  rocksdb::Slice Transform(const rocksdb::Slice& key) const override {
+    return rocksdb::Slice(key.data(), PrefixLength(key));
+  }
+
+  bool InDomain(const rocksdb::Slice& key) const override {
+    return PrefixLength(key) != 0;
+  }
+
+ private:
+  // internal key: ordered:name:0:kTypeDentry:fsId:parentInodeId:name,
+  // and the name of table may contain the delimiter, so we skip it.
+  size_t PrefixLength(const rocksdb::Slice& key) const {
+    size_t ndelimiter = 0;
+    for (size_t i = keyOffset_; i < key.size(); i++) {
+      if (key[i] == ':' && ++ndelimiter == 3) {
+        return i + 1;
+      }
+    }
+    return 0;
+  }
+
+ private:
+  size_t keyOffset_;  // offset of user key in internal key
+};
 
 void CreateBlockCacheAndWriterBufferManager() {
   static std::once_flag createBlockCache;
@@ -127,6 +175,10 @@ std::shared_ptr<MetricEventListener> GetMetricEventListener() {
 
 }  // namespace
 
+const rocksdb::SliceTransform* NewDentryPrefixTransform(size_t keyOffset) {
+  return new DentryPrefixTransform(keyOffset);
+}
+
 void InitRocksdbOptions(
     rocksdb::DBOptions* options,
     std::vector<rocksdb::ColumnFamilyDescriptor>* columnFamilies,
@@ -173,6 +225,8 @@ void InitRocksdbOptions(
       FLAGS_rocksdb_memtable_prefix_bloom_size_ratio;
   defaultCfOptions.table_factory.reset(
       rocksdb::NewBlockBasedTableFactory(tableOptions));
+  // for table counters, see also RocksDBStorage::Size()
+  defaultCfOptions.merge_operator = std::make_shared<CounterMergeOperator>();
   const size_t slidingWindowSize = 10000;
   const size_t deletionTrigger = 1000;
   const double deletionRatio = 0.2;
@@ -192,10 +246,33 @@ void InitRocksdbOptions(
   unorderedCfOptions.max_write_buffer_number =
       FLAGS_rocksdb_unordered_cf_max_write_buffer_number;
 
+  // inode: only point lookup is hot, so whole key filter is enough
+  rocksdb::ColumnFamilyOptions inodeCfOptions = unorderedCfOptions;
+  inodeCfOptions.prefix_extractor.reset();
+  inodeCfOptions.memtable_whole_key_filtering = true;
+
+  // dentry: list dentries under the same parent
+  rocksdb::ColumnFamilyOptions dentryCfOptions = orderedCfOptions;
+  dentryCfOptions.prefix_extractor.reset(
+      NewDentryPrefixTransform(RocksDBStorage::GetKeyPrefixLength() + 1));
+
+  // s3chunkinfo: append-only lists which will be deleted after compaction
+  rocksdb::ColumnFamilyOptions s3ChunkInfoCfOptions = orderedCfOptions;
+  s3ChunkInfoCfOptions.ttl = FLAGS_rocksdb_s3chunkinfo_cf_ttl_sec;
+  s3ChunkInfoCfOptions.level0_file_num_compaction_trigger =
+      FLAGS_rocksdb_s3chunkinfo_cf_level0_file_num_compaction_trigger;
+
+  // NOTE: the order MUST be same as ColumnFamilyIndex
   columnFamilies->push_back(rocksdb::ColumnFamilyDescriptor{
       rocksdb::kDefaultColumnFamilyName, unorderedCfOptions});
   columnFamilies->push_back(rocksdb::ColumnFamilyDescriptor{
       kOrderedColumnFamilyName, orderedCfOptions});
+  columnFamilies->push_back(rocksdb::ColumnFamilyDescriptor{
+      kInodeColumnFamilyName, inodeCfOptions});
+  columnFamilies->push_back(rocksdb::ColumnFamilyDescriptor{
+      kDentryColumnFamilyName, dentryCfOptions});
+  columnFamilies->push_back(rocksdb::ColumnFamilyDescriptor{
+      kS3ChunkInfoColumnFamilyName, s3ChunkInfoCfOptions});
 }
 
 void ParseRocksdbOptions(dingofs::utils::Configuration* conf) {
@@ -251,6 +328,22 @@ void ParseRocksdbOptions(dingofs::utils::Configuration* conf) {
   dummy.Load(conf, "rocksdb_stats_dump_period_sec",
              "storage.rocksdb.stats_dump_period_sec",
              &FLAGS_rocksdb_stats_dump_period_sec, /*fatalIfMissing*/ false);
+  dummy.Load(conf, "rocksdb_per_table_column_family",
+             "storage.rocksdb.per_table_column_family",
+             &FLAGS_rocksdb_per_table_column_family, /*fatalIfMissing*/ false);
+  dummy.Load(conf, "rocksdb_s3chunkinfo_cf_ttl_sec",
+             "storage.rocksdb.s3chunkinfo_cf_ttl_sec",
+             &FLAGS_rocksdb_s3chunkinfo_cf_ttl_sec, /*fatalIfMissing*/ false);
+  dummy.Load(conf, "rocksdb_s3chunkinfo_cf_level0_file_num_compaction_trigger",
+             "storage.rocksdb.s3chunkinfo_cf_level0_file_num_compaction_trigger",
+             &FLAGS_rocksdb_s3chunkinfo_cf_level0_file_num_compaction_trigger,
+             /*fatalIfMissing*/ false);
+  dummy.Load(conf, "rocksdb_row_cache_capacity_mb",
+             "storage.rocksdb.row_cache_capacity_mb",
+             &FLAGS_rocksdb_row_cache_capacity_mb, /*fatalIfMissing*/ false);
+  dummy.Load(conf, "rocksdb_row_cache_shards",
+             "storage.rocksdb.row_cache_shards",
+             &FLAGS_rocksdb_row_cache_shards, /*fatalIfMissing*/ false);
 }
 
 }  // namespace storage
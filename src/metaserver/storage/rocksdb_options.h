@@ -25,8 +25,10 @@
 
 #include <vector>
 
+#include "gflags/gflags.h"
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
+#include "rocksdb/slice_transform.h"
 
 namespace dingofs {
 namespace utils {
@@ -38,6 +40,26 @@ namespace dingofs {
 namespace metaserver {
 namespace storage {
 
+DECLARE_bool(rocksdb_per_table_column_family);
+
+// The index of column family in the descriptors returned by
+// InitRocksdbOptions(), all column families are always opened,
+// but the per-table ones only be used when
+// `rocksdb_per_table_column_family` is true.
+enum ColumnFamilyIndex : size_t {
+  kUnorderedColumnFamily = 0,  // default column family
+  kOrderedColumnFamily = 1,
+  kInodeColumnFamily = 2,
+  kDentryColumnFamily = 3,
+  kS3ChunkInfoColumnFamily = 4,
+  kNumColumnFamily = 5,
+};
+
+// Extract (table, fsId, parentInodeId) as prefix from the internal key of
+// dentry, e.g. "1:<name>:0:3:1:100:a" => "1:<name>:0:3:1:100:", the
+// `keyOffset` is the offset of user key in the internal key.
+const rocksdb::SliceTransform* NewDentryPrefixTransform(size_t keyOffset);
+
 // Parse rocksdb related options from conf
 void ParseRocksdbOptions(dingofs::utils::Configuration* conf);
 
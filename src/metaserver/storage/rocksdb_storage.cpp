@@ -25,13 +25,16 @@
 #include <glog/logging.h>
 
 #include <iostream>
+#include <map>
 #include <ostream>
 
 #include "metaserver/storage/converter.h"
+#include "metaserver/storage/rocksdb_counter.h"
 #include "metaserver/storage/rocksdb_options.h"
 #include "metaserver/storage/rocksdb_perf.h"
 #include "metaserver/storage/storage.h"
 #include "rocksdb/utilities/checkpoint.h"
+#include "rocksdb/write_batch.h"
 #include "fs/local_filesystem.h"
 
 namespace dingofs {
@@ -39,6 +42,10 @@ namespace metaserver {
 namespace storage {
 
 const std::string RocksDBStorage::kDelimiter_ = ":";  // NOLINT
+const std::string RocksDBStorage::kCounterInitedKey_ =  // NOLINT
+    "table_counter_inited";
+const std::string RocksDBStorage::kLayoutKey_ =  // NOLINT
+    "column_family_layout";
 
 Status ToStorageStatus(const ROCKSDB_NAMESPACE::Status& s) {
   if (s.ok()) {
@@ -76,6 +83,7 @@ RocksDBStorage::RocksDBStorage(const RocksDBStorage& storage,
       db_(storage.db_),
       txnDB_(storage.txnDB_),
       handles_(storage.handles_),
+      perTableColumnFamily_(storage.perTableColumnFamily_),
       InTransaction_(true),
       txn_(txn),
       dbOptions_(storage.dbOptions_),
@@ -116,6 +124,10 @@ bool RocksDBStorage::Open() {
   db_ = txnDB_->GetBaseDB();
 
   inited_ = true;
+  if (!MigrateColumnFamilies() || !InitTableCounters()) {
+    Close();
+    return false;
+  }
   return true;
 }
 
@@ -149,8 +161,43 @@ bool RocksDBStorage::Close() {
   return true;
 }
 
-inline ColumnFamilyHandle* RocksDBStorage::GetColumnFamilyHandle(bool ordered) {
-  return ordered ? handles_[1] : handles_[0];
+ColumnFamilyHandle* RocksDBStorage::GetColumnFamilyHandle(
+    const std::string& name, bool ordered) {
+  if (perTableColumnFamily_) {
+    switch (NameGenerator::GetTableType(name)) {
+      case kTypeInode:
+        if (!ordered) {
+          return handles_[kInodeColumnFamily];
+        }
+        break;
+      case kTypeDentry:
+        if (ordered) {
+          return handles_[kDentryColumnFamily];
+        }
+        break;
+      case kTypeS3ChunkInfo:
+        if (ordered) {
+          return handles_[kS3ChunkInfoColumnFamily];
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return ordered ? handles_[kOrderedColumnFamily]
+                 : handles_[kUnorderedColumnFamily];
+}
+
+bool RocksDBStorage::PrefixSeekable(ColumnFamilyHandle* handle,
+                                    const std::string& key) {
+  static std::unique_ptr<const ROCKSDB_NAMESPACE::SliceTransform> dentryPrefix(
+      NewDentryPrefixTransform(GetKeyPrefixLength() + kDelimiter_.size()));
+  if (handle == handles_[kInodeColumnFamily]) {
+    return false;  // no prefix extractor
+  } else if (handle == handles_[kDentryColumnFamily]) {
+    return dentryPrefix->InDomain(key);
+  }
+  return true;  // fixed prefix extractor
 }
 
 /* NOTE:
@@ -158,6 +205,8 @@ inline ColumnFamilyHandle* RocksDBStorage::GetColumnFamilyHandle(bool ordered) {
  *    [ordered:name:0, ordered:name:1)
  * 2. please gurantee the length of name is fixed for
  *    we can determine the rocksdb's prefix key
+ * 3. the counter of table is stored in `ordered:name:2:count`,
+ *    which is out of the key range of table
  */
 std::string RocksDBStorage::ToInternalName(const std::string& name,
                                            bool ordered, bool start) {
@@ -184,6 +233,35 @@ std::string RocksDBStorage::ToUserKey(const std::string& ikey) {
   return ikey.substr(GetKeyPrefixLength() + kDelimiter_.size());
 }
 
+std::string RocksDBStorage::ToCounterKey(const std::string& name,
+                                         bool ordered) {
+  std::ostringstream oss;
+  oss << ordered << kDelimiter_ << name << kDelimiter_ << "2" << kDelimiter_
+      << "count";
+  return oss.str();
+}
+
+Status RocksDBStorage::KeyExist(ColumnFamilyHandle* handle,
+                                const std::string& ikey, bool* exist) {
+  ROCKSDB_NAMESPACE::PinnableSlice svalue;
+  ROCKSDB_NAMESPACE::Status s;
+  {
+    RocksDBPerfGuard guard(OP_GET);
+    // lock the key in transaction, so the counter is accurate
+    s = InTransaction_
+            ? txn_->GetForUpdate(dbReadOptions_, handle, ikey, &svalue)
+            : db_->Get(dbReadOptions_, handle, ikey, &svalue);
+  }
+  if (s.ok()) {
+    *exist = true;
+  } else if (s.IsNotFound()) {
+    *exist = false;
+  } else {
+    return ToStorageStatus(s);
+  }
+  return Status::OK();
+}
+
 Status RocksDBStorage::Get(const std::string& name, const std::string& key,
                            ValueType* value, bool ordered) {
   if (!inited_) {
@@ -193,7 +271,7 @@ Status RocksDBStorage::Get(const std::string& name, const std::string& key,
   ROCKSDB_NAMESPACE::Status s;
   std::string svalue;
   std::string ikey = ToInternalKey(name, key, ordered);
-  auto handle = GetColumnFamilyHandle(ordered);
+  auto handle = GetColumnFamilyHandle(name, ordered);
   {
     RocksDBPerfGuard guard(OP_GET);
     s = InTransaction_ ? txn_->Get(dbReadOptions_, handle, ikey, &svalue)
@@ -214,12 +292,31 @@ Status RocksDBStorage::Set(const std::string& name, const std::string& key,
     return Status::SerializedFailed();
   }
 
-  auto handle = GetColumnFamilyHandle(ordered);
+  bool exist;
+  auto handle = GetColumnFamilyHandle(name, ordered);
   std::string ikey = ToInternalKey(name, key, ordered);
+  Status status = KeyExist(handle, ikey, &exist);
+  if (!status.ok()) {
+    return status;
+  }
+
   RocksDBPerfGuard guard(OP_PUT);
-  ROCKSDB_NAMESPACE::Status s =
-      InTransaction_ ? txn_->Put(handle, ikey, svalue)
-                     : db_->Put(dbWriteOptions_, handle, ikey, svalue);
+  ROCKSDB_NAMESPACE::Status s;
+  if (InTransaction_) {
+    s = txn_->Put(handle, ikey, svalue);
+    if (s.ok() && !exist) {
+      // untracked: the counter key should not be locked by transaction
+      s = txn_->MergeUntracked(handle, ToCounterKey(name, ordered),
+                               EncodeCounter(1));
+    }
+  } else {
+    ROCKSDB_NAMESPACE::WriteBatch batch;
+    batch.Put(handle, ikey, svalue);
+    if (!exist) {
+      batch.Merge(handle, ToCounterKey(name, ordered), EncodeCounter(1));
+    }
+    s = db_->Write(dbWriteOptions_, &batch);
+  }
   return ToStorageStatus(s);
 }
 
@@ -229,12 +326,30 @@ Status RocksDBStorage::Del(const std::string& name, const std::string& key,
     return Status::DBClosed();
   }
 
+  bool exist;
   std::string ikey = ToInternalKey(name, key, ordered);
-  auto handle = GetColumnFamilyHandle(ordered);
+  auto handle = GetColumnFamilyHandle(name, ordered);
+  Status status = KeyExist(handle, ikey, &exist);
+  if (!status.ok()) {
+    return status;
+  }
+
   RocksDBPerfGuard guard(OP_DELETE);
-  ROCKSDB_NAMESPACE::Status s =
-      InTransaction_ ? txn_->Delete(handle, ikey)
-                     : db_->Delete(dbWriteOptions_, handle, ikey);
+  ROCKSDB_NAMESPACE::Status s;
+  if (InTransaction_) {
+    s = txn_->Delete(handle, ikey);
+    if (s.ok() && exist) {
+      s = txn_->MergeUntracked(handle, ToCounterKey(name, ordered),
+                               EncodeCounter(-1));
+    }
+  } else {
+    ROCKSDB_NAMESPACE::WriteBatch batch;
+    batch.Delete(handle, ikey);
+    if (exist) {
+      batch.Merge(handle, ToCounterKey(name, ordered), EncodeCounter(-1));
+    }
+    s = db_->Write(dbWriteOptions_, &batch);
+  }
   return ToStorageStatus(s);
 }
 
@@ -242,28 +357,44 @@ std::shared_ptr<Iterator> RocksDBStorage::Seek(const std::string& name,
                                                const std::string& prefix) {
   int status = inited_ ? 0 : -1;
   std::string ikey = ToInternalKey(name, prefix, true);
-  return std::make_shared<RocksDBStorageIterator>(this, ikey, 0, status, true);
+  auto handle = inited_ ? GetColumnFamilyHandle(name, true) : nullptr;
+  return std::make_shared<RocksDBStorageIterator>(this, ikey, 0, status,
+                                                  handle);
 }
 
 std::shared_ptr<Iterator> RocksDBStorage::GetAll(const std::string& name,
                                                  bool ordered) {
   int status = inited_ ? 0 : -1;
   std::string ikey = ToInternalKey(name, "", ordered);
+  auto handle = inited_ ? GetColumnFamilyHandle(name, ordered) : nullptr;
   return std::make_shared<RocksDBStorageIterator>(this, std::move(ikey), 0,
-                                                  status, ordered);
+                                                  status, handle);
 }
 
 size_t RocksDBStorage::Size(const std::string& name, bool ordered) {
-  auto iterator = GetAll(name, ordered);
-  if (iterator->Status() != 0) {
+  if (!inited_) {
     return 0;
   }
 
-  size_t size = 0;
-  for (iterator->SeekToFirst(); iterator->Valid(); iterator->Next()) {
-    size++;
+  ROCKSDB_NAMESPACE::Status s;
+  std::string svalue;
+  std::string ckey = ToCounterKey(name, ordered);
+  auto handle = GetColumnFamilyHandle(name, ordered);
+  {
+    RocksDBPerfGuard guard(OP_GET);
+    s = InTransaction_ ? txn_->Get(dbReadOptions_, handle, ckey, &svalue)
+                       : db_->Get(dbReadOptions_, handle, ckey, &svalue);
   }
-  return size;
+  if (s.IsNotFound()) {
+    return 0;
+  } else if (!s.ok()) {
+    LOG(ERROR) << "Get counter of table failed, tablename = " << name
+               << ", ordered = " << ordered << ", status = " << s.ToString();
+    return 0;
+  }
+
+  int64_t size = DecodeCounter(svalue);
+  return size > 0 ? static_cast<size_t>(size) : 0;
 }
 
 Status RocksDBStorage::Clear(const std::string& name, bool ordered) {
@@ -279,17 +410,162 @@ Status RocksDBStorage::Clear(const std::string& name, bool ordered) {
   // database's checkpoint in raft snapshot
   // But, currently, many unittest cases depend it
 
-  auto handle = GetColumnFamilyHandle(ordered);
+  auto handle = GetColumnFamilyHandle(name, ordered);
   std::string lower = ToInternalName(name, ordered, true);
   std::string upper = ToInternalName(name, ordered, false);
+  ROCKSDB_NAMESPACE::WriteBatch batch;
+  batch.DeleteRange(handle, lower, upper);
+  batch.Put(handle, ToCounterKey(name, ordered), EncodeCounter(0));
   RocksDBPerfGuard guard(OP_DELETE_RANGE);
-  ROCKSDB_NAMESPACE::Status s =
-      db_->DeleteRange(dbWriteOptions_, handle, lower, upper);
+  ROCKSDB_NAMESPACE::Status s = db_->Write(dbWriteOptions_, &batch);
   LOG(INFO) << "Clear(), tablename = " << name << ", ordered = " << ordered
             << ", lower key = " << lower << ", upper key = " << upper;
   return ToStorageStatus(s);
 }
 
+bool RocksDBStorage::InitTableCounters() {
+  std::string svalue;
+  auto s = db_->Get(dbReadOptions_, handles_[kUnorderedColumnFamily],
+                    kCounterInitedKey_, &svalue);
+  if (s.ok()) {
+    return true;
+  } else if (!s.IsNotFound()) {
+    LOG(ERROR) << "Get table counter flag failed, status = " << s.ToString();
+    return false;
+  }
+
+  // the database opened from a clean directory has no data
+  ROCKSDB_NAMESPACE::WriteBatch batch;
+  for (auto handle : cleanOpen_ ? std::vector<ColumnFamilyHandle*>{}
+                                : handles_) {
+    std::map<std::pair<std::string, bool>, int64_t> counters;
+    auto readOptions = dbReadOptions_;
+    readOptions.total_order_seek = true;
+    std::unique_ptr<ROCKSDB_NAMESPACE::Iterator> iter(
+        db_->NewIterator(readOptions, handle));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      std::string name;
+      bool ordered;
+      if (ParseInternalKey(iter->key(), &name, &ordered) &&
+          iter->key()[GetKeyPrefixLength() - 1] == '0') {
+        counters[{name, ordered}]++;
+      }
+    }
+    if (!iter->status().ok()) {
+      LOG(ERROR) << "Scan database for table counters failed, status = "
+                 << iter->status().ToString();
+      return false;
+    }
+
+    for (const auto& item : counters) {
+      const auto& name = item.first.first;
+      bool ordered = item.first.second;
+      batch.Put(handle, ToCounterKey(name, ordered),
+                EncodeCounter(item.second));
+      LOG(INFO) << "Init table counter, tablename = " << name
+                << ", ordered = " << ordered << ", count = " << item.second;
+    }
+  }
+
+  batch.Put(handles_[kUnorderedColumnFamily], kCounterInitedKey_, "1");
+  s = db_->Write(dbWriteOptions_, &batch);
+  if (!s.ok()) {
+    LOG(ERROR) << "Write table counters failed, status = " << s.ToString();
+    return false;
+  }
+  return true;
+}
+
+bool RocksDBStorage::ParseInternalKey(const ROCKSDB_NAMESPACE::Slice& ikey,
+                                      std::string* name, bool* ordered) {
+  // internal key: ordered:name:{0,1,2}:key
+  size_t prefixLength = GetKeyPrefixLength();
+  if (ikey.size() <= prefixLength || (ikey[0] != '0' && ikey[0] != '1') ||
+      ikey[1] != kDelimiter_[0] || ikey[prefixLength - 2] != kDelimiter_[0] ||
+      ikey[prefixLength] != kDelimiter_[0]) {
+    return false;  // not a key of table
+  }
+
+  *ordered = (ikey[0] == '1');
+  *name = std::string(ikey.data() + 2, prefixLength - 4);
+  return true;
+}
+
+bool RocksDBStorage::MigrateColumnFamilies() {
+  const std::string layout = perTableColumnFamily_ ? "per_table" : "shared";
+  std::string svalue;
+  auto s = db_->Get(dbReadOptions_, handles_[kUnorderedColumnFamily],
+                    kLayoutKey_, &svalue);
+  if (s.ok() && svalue == layout) {
+    return true;
+  } else if (!s.ok() && !s.IsNotFound()) {
+    LOG(ERROR) << "Get column family layout failed, status = "
+               << s.ToString();
+    return false;
+  }
+
+  // the database without layout is created by the shared layout
+  bool migrate = !cleanOpen_ && (s.ok() || perTableColumnFamily_);
+  if (migrate) {
+    LOG(INFO) << "Migrate column family layout from `"
+              << (s.ok() ? svalue : "shared") << "` to `" << layout
+              << "`, dir = " << options_.dataDir;
+  }
+
+  const size_t kBatchSize = 1024;
+  uint64_t nmoved = 0;
+  ROCKSDB_NAMESPACE::WriteBatch batch;
+  s = ROCKSDB_NAMESPACE::Status::OK();
+  for (auto handle : migrate ? handles_ : std::vector<ColumnFamilyHandle*>{}) {
+    auto readOptions = dbReadOptions_;
+    readOptions.total_order_seek = true;
+    std::unique_ptr<ROCKSDB_NAMESPACE::Iterator> iter(
+        db_->NewIterator(readOptions, handle));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      std::string name;
+      bool ordered;
+      if (!ParseInternalKey(iter->key(), &name, &ordered)) {
+        continue;
+      }
+
+      // the table counter is moved together with its table
+      auto target = GetColumnFamilyHandle(name, ordered);
+      if (target == handle) {
+        continue;
+      }
+      batch.Put(target, iter->key(), iter->value());
+      batch.Delete(handle, iter->key());
+      if (++nmoved % kBatchSize == 0) {
+        s = db_->Write(dbWriteOptions_, &batch);
+        if (!s.ok()) {
+          break;
+        }
+        batch.Clear();
+      }
+    }
+    if (s.ok() && !iter->status().ok()) {
+      s = iter->status();
+    }
+    if (!s.ok()) {
+      LOG(ERROR) << "Migrate column family layout failed, status = "
+                 << s.ToString();
+      return false;
+    }
+  }
+
+  batch.Put(handles_[kUnorderedColumnFamily], kLayoutKey_, layout);
+  s = db_->Write(dbWriteOptions_, &batch);
+  if (!s.ok()) {
+    LOG(ERROR) << "Write column family layout failed, status = "
+               << s.ToString();
+    return false;
+  }
+
+  LOG_IF(INFO, migrate) << "Migrate column family layout success, " << nmoved
+                        << " keys moved.";
+  return true;
+}
+
 std::shared_ptr<StorageTransaction> RocksDBStorage::BeginTransaction() {
   RocksDBPerfGuard guard(OP_BEGIN_TRANSACTION);
   ROCKSDB_NAMESPACE::Transaction* txn =
@@ -348,6 +624,8 @@ void RocksDBStorage::InitDbOptions() {
   dbWriteOptions_.sync = false;
 
   dbReadOptions_ = rocksdb::ReadOptions();
+
+  perTableColumnFamily_ = FLAGS_rocksdb_per_table_column_family;
 }
 
 namespace {
@@ -60,8 +60,9 @@ using ROCKSDB_NAMESPACE::Transaction;
 using ROCKSDB_NAMESPACE::TransactionDB;
 using STORAGE_TYPE = KVStorage::STORAGE_TYPE;
 
-// NOTE: The HSize() and SSize() is an expensive operation for rocksdb storage,
-// you should only invoke it in test cases.
+// NOTE: The number of keys for each table is maintained by a counter which
+// updated within the same write batch (or transaction) of HSet/HDel/SSet/SDel,
+// so the HSize() and SSize() only cost a point lookup.
 class RocksDBStorage : public KVStorage, public StorageTransaction {
  public:
   RocksDBStorage();
@@ -123,7 +124,15 @@ class RocksDBStorage : public KVStorage, public StorageTransaction {
   bool Recover(const std::string& dir) override;
 
  private:
-  ColumnFamilyHandle* GetColumnFamilyHandle(bool ordered);
+  // NOTE: the table is stored in dedicated column family according to its
+  // type if `rocksdb_per_table_column_family` is true, otherwise it is
+  // stored in the ordered or unordered column family.
+  ColumnFamilyHandle* GetColumnFamilyHandle(const std::string& name,
+                                            bool ordered);
+
+  // Whether the iterator can seek the key in prefix mode, the total order
+  // seek is required if the key is out of the domain of prefix extractor.
+  bool PrefixSeekable(ColumnFamilyHandle* handle, const std::string& key);
 
   static size_t GetKeyPrefixLength();
 
@@ -135,6 +144,29 @@ class RocksDBStorage : public KVStorage, public StorageTransaction {
 
   std::string ToUserKey(const std::string& ikey);
 
+  static std::string ToCounterKey(const std::string& name, bool ordered);
+
+  // NOTE: the key is locked by GetForUpdate() in transaction, but outside
+  // transaction the writes for the same key must be serialized by caller
+  // (e.g. the rwlock of InodeStorage/DentryStorage), otherwise the table
+  // counter may be inaccurate.
+  Status KeyExist(ColumnFamilyHandle* handle, const std::string& ikey,
+                  bool* exist);
+
+  // Initialize counters for database which created before table counter
+  // introduced, it will scan the whole database only once.
+  bool InitTableCounters();
+
+  // Parse the table name and type from internal key, return false if the
+  // key is not belong to any table.
+  static bool ParseInternalKey(const ROCKSDB_NAMESPACE::Slice& ikey,
+                               std::string* name, bool* ordered);
+
+  // Move tables into the column families of current layout if the database
+  // is created with another layout, it is idempotent and can be resumed
+  // after crash.
+  bool MigrateColumnFamilies();
+
   Status Get(const std::string& name, const std::string& key, ValueType* value,
              bool ordered);
 
@@ -147,14 +179,14 @@ class RocksDBStorage : public KVStorage, public StorageTransaction {
                                  const std::string& prefix);
 
   // TODO(@Wine93): We do not support transactions for the
-  // below 3 methods, maybe we should return Status::NotSupported
+  // below 2 methods, maybe we should return Status::NotSupported
   // when user invoke it in transaction.
   std::shared_ptr<Iterator> GetAll(const std::string& name, bool ordered);
 
-  size_t Size(const std::string& name, bool ordered);
-
   Status Clear(const std::string& name, bool ordered);
 
+  size_t Size(const std::string& name, bool ordered);
+
  private:
   friend class RocksDBStorageIterator;
   friend class RocksDBStorageTest;
@@ -173,6 +205,9 @@ class RocksDBStorage : public KVStorage, public StorageTransaction {
   TransactionDB* txnDB_ = nullptr;
   std::vector<ColumnFamilyHandle*> handles_;
   static const std::string kDelimiter_;
+  static const std::string kCounterInitedKey_;
+  static const std::string kLayoutKey_;
+  bool perTableColumnFamily_ = false;
 
   // open a clean database or recovery from a checkpoint
   bool cleanOpen_ = true;
@@ -255,17 +290,19 @@ inline Status RocksDBStorage::SClear(const std::string& name) {
 class RocksDBStorageIterator : public Iterator {
  public:
   RocksDBStorageIterator(RocksDBStorage* storage, std::string prefix,
-                         size_t size, int status, bool ordered)
+                         size_t size, int status, ColumnFamilyHandle* handle)
       : storage_(storage),
         prefix_(std::move(prefix)),
         size_(size),
         status_(status),
         prefixChecking_(true),
-        ordered_(ordered),
+        handle_(handle),
         iter_(nullptr) {
     RocksDBPerfGuard guard(OP_GET_SNAPSHOT);
     if (status_ == 0) {
       readOptions_ = storage_->dbReadOptions_;
+      readOptions_.total_order_seek =
+          !storage_->PrefixSeekable(handle_, prefix_);
       if (storage_->InTransaction_) {
         readOptions_.snapshot = storage_->txn_->GetSnapshot();
       } else {
@@ -299,13 +336,12 @@ class RocksDBStorageIterator : public Iterator {
   }
 
   void SeekToFirst() {
-    auto handler = storage_->GetColumnFamilyHandle(ordered_);
     {
       RocksDBPerfGuard guard(OP_GET_ITERATOR);
       if (storage_->InTransaction_) {
-        iter_.reset(storage_->txn_->GetIterator(readOptions_, handler));
+        iter_.reset(storage_->txn_->GetIterator(readOptions_, handle_));
       } else {
-        iter_.reset(storage_->db_->NewIterator(readOptions_, handler));
+        iter_.reset(storage_->db_->NewIterator(readOptions_, handle_));
       }
     }
 
@@ -350,7 +386,7 @@ class RocksDBStorageIterator : public Iterator {
   uint64_t size_;
   int status_;
   bool prefixChecking_;
-  bool ordered_;
+  ColumnFamilyHandle* handle_;
   std::unique_ptr<rocksdb::Iterator> iter_;
   rocksdb::ReadOptions readOptions_;
 };
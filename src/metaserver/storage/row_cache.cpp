@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metaserver/storage/row_cache.h"
+
+#include <atomic>
+
+DEFINE_uint64(rocksdb_row_cache_capacity_mb, 128,
+              "max memory (MB) used by decoded inode attributes (and dentry "
+              "vectors respectively) cached in front of rocksdb storage, "
+              "0 means disabled");
+DEFINE_uint32(rocksdb_row_cache_shards, 32,
+              "number of shards for rocksdb row cache");
+
+namespace dingofs {
+namespace metaserver {
+namespace storage {
+
+static constexpr uint64_t kMiB = 1024ULL * 1024;
+
+InodeRowCache* GetInodeRowCache() {
+  static InodeRowCache cache("metaserver_inode_row",
+                             FLAGS_rocksdb_row_cache_capacity_mb * kMiB,
+                             FLAGS_rocksdb_row_cache_shards);
+  return &cache;
+}
+
+DentryRowCache* GetDentryRowCache() {
+  static DentryRowCache cache("metaserver_dentry_row",
+                              FLAGS_rocksdb_row_cache_capacity_mb * kMiB,
+                              FLAGS_rocksdb_row_cache_shards);
+  return &cache;
+}
+
+uint64_t NewRowCacheTableId() {
+  static std::atomic<uint64_t> nextId(1);
+  return nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string RowCacheKey(uint64_t tableId, const std::string& key) {
+  std::string ckey(reinterpret_cast<const char*>(&tableId), sizeof(tableId));
+  ckey.append(key);
+  return ckey;
+}
+
+}  // namespace storage
+}  // namespace metaserver
+}  // namespace dingofs
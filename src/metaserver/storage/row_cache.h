@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_METASERVER_STORAGE_ROW_CACHE_H_
+#define DINGOFS_SRC_METASERVER_STORAGE_ROW_CACHE_H_
+
+#include <bvar/bvar.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dingofs/metaserver.pb.h"
+#include "gflags/gflags.h"
+#include "utils/concurrent/concurrent.h"
+#include "utils/lru_cache.h"
+
+DECLARE_uint64(rocksdb_row_cache_capacity_mb);
+DECLARE_uint32(rocksdb_row_cache_shards);
+
+namespace dingofs {
+namespace metaserver {
+namespace storage {
+
+// Cache for decoded values (e.g. inode attribute, dentry vector) of rocksdb
+// storage, which saves the point lookup and the protobuf parsing for hot keys.
+//
+// The cache is bounded by the memory used by its entries (key and
+// SpaceUsedLong() of value) and sharded by the hash of key to reduce the lock
+// contention. It never validate the entry, so the owner of table MUST remove
+// the key after writes, and the writes and the cache fills for the same key
+// must be serialized by the owner's lock.
+template <typename T>
+class RowCache {
+ public:
+  using ValueType = std::shared_ptr<const T>;
+
+  RowCache(const std::string& name, uint64_t capacityBytes, uint32_t nshards);
+
+  bool Enabled() const { return !shards_.empty(); }
+
+  bool Get(const std::string& key, ValueType* value);
+
+  void Put(const std::string& key, const ValueType& value);
+
+  void Remove(const std::string& key);
+
+  double HitRatio() const;
+
+ private:
+  struct Item {
+    std::string key;
+    ValueType value;
+    uint64_t bytes;
+  };
+
+  struct Shard {
+    explicit Shard(uint64_t capacity) : capacity(capacity), usedBytes(0) {}
+
+    utils::Mutex mutex;
+    uint64_t capacity;
+    uint64_t usedBytes;
+    std::list<Item> items;  // the front is the most recently used
+    std::unordered_map<std::string, typename std::list<Item>::iterator> index;
+  };
+
+  Shard* GetShard(const std::string& key) {
+    return shards_[std::hash<std::string>{}(key) % shards_.size()].get();
+  }
+
+  void EraseLocked(Shard* shard, typename std::list<Item>::iterator iter);
+
+  static double GetHitRatio(void* arg) {
+    return static_cast<RowCache<T>*>(arg)->HitRatio();
+  }
+
+ private:
+  std::shared_ptr<utils::CacheMetrics> metrics_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  bvar::PassiveStatus<double> hitRatio_;
+};
+
+template <typename T>
+RowCache<T>::RowCache(const std::string& name, uint64_t capacityBytes,
+                      uint32_t nshards)
+    : metrics_(std::make_shared<utils::CacheMetrics>(name)),
+      hitRatio_(name, "cache_hit_ratio", &RowCache<T>::GetHitRatio, this) {
+  if (capacityBytes == 0) {  // disabled
+    return;
+  }
+
+  nshards = std::max(1U, nshards);
+  uint64_t capacityPerShard = std::max<uint64_t>(1, capacityBytes / nshards);
+  for (uint32_t i = 0; i < nshards; i++) {
+    shards_.emplace_back(std::make_unique<Shard>(capacityPerShard));
+  }
+}
+
+template <typename T>
+bool RowCache<T>::Get(const std::string& key, ValueType* value) {
+  if (!Enabled()) {
+    return false;
+  }
+
+  Shard* shard = GetShard(key);
+  utils::LockGuard lk(shard->mutex);
+  auto iter = shard->index.find(key);
+  if (iter == shard->index.end()) {
+    metrics_->OnCacheMiss();
+    return false;
+  }
+
+  shard->items.splice(shard->items.begin(), shard->items, iter->second);
+  *value = iter->second->value;
+  metrics_->OnCacheHit();
+  return true;
+}
+
+template <typename T>
+void RowCache<T>::Put(const std::string& key, const ValueType& value) {
+  if (!Enabled()) {
+    return;
+  }
+
+  uint64_t bytes = key.size() + value->SpaceUsedLong();
+  Shard* shard = GetShard(key);
+  utils::LockGuard lk(shard->mutex);
+  auto iter = shard->index.find(key);
+  if (iter != shard->index.end()) {
+    EraseLocked(shard, iter->second);
+  }
+  if (bytes > shard->capacity) {  // never fits
+    return;
+  }
+
+  while (shard->usedBytes + bytes > shard->capacity) {
+    EraseLocked(shard, std::prev(shard->items.end()));
+  }
+  shard->items.push_front(Item{key, value, bytes});
+  shard->index[key] = shard->items.begin();
+  shard->usedBytes += bytes;
+  metrics_->UpdateAddToCacheCount();
+  metrics_->UpdateAddToCacheBytes(bytes);
+}
+
+template <typename T>
+void RowCache<T>::Remove(const std::string& key) {
+  if (!Enabled()) {
+    return;
+  }
+
+  Shard* shard = GetShard(key);
+  utils::LockGuard lk(shard->mutex);
+  auto iter = shard->index.find(key);
+  if (iter != shard->index.end()) {
+    EraseLocked(shard, iter->second);
+  }
+}
+
+template <typename T>
+void RowCache<T>::EraseLocked(Shard* shard,
+                              typename std::list<Item>::iterator iter) {
+  shard->usedBytes -= iter->bytes;
+  metrics_->UpdateRemoveFromCacheCount();
+  metrics_->UpdateRemoveFromCacheBytes(iter->bytes);
+  shard->index.erase(iter->key);
+  shard->items.erase(iter);
+}
+
+template <typename T>
+double RowCache<T>::HitRatio() const {
+  double hit = metrics_->cacheHit.get_value();
+  double miss = metrics_->cacheMiss.get_value();
+  return (hit + miss == 0) ? 0 : hit / (hit + miss);
+}
+
+// The attribute is all what GetAttr and GetXAttr need, caching it instead of
+// the whole inode keeps the s3 chunk infos of large files out of the cache.
+using InodeRowCache = RowCache<pb::metaserver::InodeAttr>;
+
+using DentryRowCache = RowCache<pb::metaserver::DentryVec>;
+
+// Global row caches shared by all partitions, each of them is bounded by
+// the flag rocksdb_row_cache_capacity_mb which is read when it is first used.
+InodeRowCache* GetInodeRowCache();
+
+DentryRowCache* GetDentryRowCache();
+
+// Each table holds a unique id as the prefix of its cache keys, and it
+// should switch to a new id when the table changed out of its write path
+// (e.g. cleared or recovered from raft snapshot), so the stale entries can
+// never be hit and will be evicted by LRU later.
+uint64_t NewRowCacheTableId();
+
+std::string RowCacheKey(uint64_t tableId, const std::string& key);
+
+}  // namespace storage
+}  // namespace metaserver
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_METASERVER_STORAGE_ROW_CACHE_H_
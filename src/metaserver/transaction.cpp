@@ -22,15 +22,33 @@
 
 #include "metaserver/transaction.h"
 
+#include <limits>
+
 #include "metaserver/dentry_storage.h"
+#include "stub/common/rename_tx.h"
+#include "utils/timeutility.h"
 
 namespace dingofs {
 namespace metaserver {
 
 using dingofs::utils::ReadLockGuard;
 using dingofs::utils::WriteLockGuard;
+using stub::common::GetShardedTxOp;
+using stub::common::IsShardedTx;
+using stub::common::SetShardedTxOp;
+using stub::common::ShardedTxOp;
+using utils::TimeUtility;
+
+namespace {
+
+// the tombstones kept by one partition, a prepare which arrives after this
+// many aborts forgotten is not fenced anymore
+constexpr size_t kMaxShardedTxTombstones = 16384;
+
+}  // namespace
 
 using pb::metaserver::Dentry;
+using pb::metaserver::DentryFlag;
 using pb::metaserver::MetaStatusCode;
 
 #define FOR_EACH_DENTRY(action)                                                \
@@ -84,8 +102,9 @@ std::ostream& operator<<(std::ostream& os, const RenameTx& renameTx) {
   return os;
 }
 
-TxManager::TxManager(std::shared_ptr<DentryStorage> storage)
-    : storage_(storage) {}
+TxManager::TxManager(std::shared_ptr<DentryStorage> storage,
+                     LocalChecker isLocal)
+    : storage_(storage), isLocal_(std::move(isLocal)) {}
 
 MetaStatusCode TxManager::PreCheck(const std::vector<Dentry>& dentrys) {
   auto size = dentrys.size();
@@ -103,11 +122,26 @@ MetaStatusCode TxManager::PreCheck(const std::vector<Dentry>& dentrys) {
 }
 
 MetaStatusCode TxManager::HandleRenameTx(const std::vector<Dentry>& dentrys) {
+  if (!dentrys.empty() && IsShardedTx(dentrys[0])) {
+    return HandleShardedTx(dentrys);
+  }
+
   auto rc = PreCheck(dentrys);
   if (rc != MetaStatusCode::OK) {
     return rc;
   }
 
+  // the names may be locked by the sharded transactions, which share
+  // the partition with the transactions coordinated by mds
+  {
+    ShardedTx tx;
+    tx.dentrys = dentrys;
+    std::lock_guard<std::mutex> lk(shardedMutex_);
+    if (!CheckLocks(0, tx)) {
+      return MetaStatusCode::HANDLE_PENDING_TX_FAILED;
+    }
+  }
+
   // Handle pending TX
   RenameTx pendingTx;
   if (FindPendingTx(&pendingTx)) {
@@ -168,5 +202,346 @@ bool TxManager::HandlePendingTx(uint64_t txId, RenameTx* pendingTx) {
   return pendingTx->Rollback();
 }
 
+MetaStatusCode TxManager::HandleShardedTx(const std::vector<Dentry>& dentrys) {
+  auto op = GetShardedTxOp(dentrys[0]);
+  uint64_t txId = dentrys[0].txsequence();
+  if (dentrys.size() != 2 || txId == 0) {
+    return MetaStatusCode::PARAM_ERROR;
+  }
+
+  ShardedTx tx;
+  tx.prepareTimeSec = TimeUtility::GetTimeofDaySec();
+  for (const auto& dentry : dentrys) {
+    if (GetShardedTxOp(dentry) != op || dentry.txsequence() != txId ||
+        dentry.fsid() != dentrys[0].fsid()) {
+      return MetaStatusCode::PARAM_ERROR;
+    }
+    tx.dentrys.push_back(dentry);
+    SetShardedTxOp(ShardedTxOp::kNone, &tx.dentrys.back());
+  }
+
+  std::lock_guard<std::mutex> lk(shardedMutex_);
+  if (op == ShardedTxOp::kForget) {
+    return ForgetShardedTx(txId);
+  }
+
+  auto iter = decisions_.find(txId);
+  if (iter != decisions_.end()) {  // retried or resolved
+    bool committed = iter->second.committed;
+    if (op == ShardedTxOp::kAbort) {
+      return committed ? MetaStatusCode::HANDLE_TX_FAILED : MetaStatusCode::OK;
+    }
+    return committed ? MetaStatusCode::OK : MetaStatusCode::HANDLE_TX_FAILED;
+  } else if (tombstoneSet_.count(txId) != 0) {  // aborted and forgotten
+    return op == ShardedTxOp::kAbort ? MetaStatusCode::OK
+                                     : MetaStatusCode::HANDLE_TX_FAILED;
+  }
+
+  switch (op) {
+    case ShardedTxOp::kPrepare:
+      return PrepareShardedTx(txId, tx);
+    case ShardedTxOp::kCommit:
+      return CommitShardedTx(txId, tx);
+    case ShardedTxOp::kAbort:
+      return AbortShardedTx(txId, tx);
+    default:
+      return MetaStatusCode::PARAM_ERROR;
+  }
+}
+
+MetaStatusCode TxManager::PrepareShardedTx(uint64_t txId,
+                                           const ShardedTx& tx) {
+  auto iter = preparedTxs_.find(txId);
+  if (iter != preparedTxs_.end()) {
+    return iter->second.dentrys == tx.dentrys ? MetaStatusCode::OK
+                                              : MetaStatusCode::PARAM_ERROR;
+  } else if (IsAllLocal(tx)) {  // committed directly
+    return MetaStatusCode::PARAM_ERROR;
+  } else if (!CheckLocks(txId, tx)) {
+    return MetaStatusCode::HANDLE_PENDING_TX_FAILED;
+  } else if (IsCoordinator(tx) && !CheckSource(tx)) {
+    return MetaStatusCode::HANDLE_TX_FAILED;
+  }
+
+  preparedTxs_.emplace(txId, tx);
+  Lock(txId, tx, true);
+  return MetaStatusCode::OK;
+}
+
+MetaStatusCode TxManager::CommitShardedTx(uint64_t txId, const ShardedTx& tx) {
+  auto iter = preparedTxs_.find(txId);
+  if (!IsCoordinator(tx)) {
+    // the coordinator commits only after the participant prepared, so the
+    // transaction which is not prepared here has been committed already
+    if (iter != preparedTxs_.end()) {
+      if (!ApplyLocal(iter->second)) {
+        return MetaStatusCode::HANDLE_TX_FAILED;
+      }
+      Lock(txId, iter->second, false);
+      preparedTxs_.erase(iter);
+    }
+    return MetaStatusCode::OK;
+  }
+
+  if (iter == preparedTxs_.end() && !IsAllLocal(tx)) {
+    LOG(ERROR) << "Commit sharded rename tx which is not prepared"
+               << ", txId = " << txId;
+    return MetaStatusCode::HANDLE_TX_FAILED;
+  } else if (!CheckLocks(txId, tx)) {
+    return MetaStatusCode::HANDLE_PENDING_TX_FAILED;
+  } else if (!CheckSource(tx)) {
+    return MetaStatusCode::HANDLE_TX_FAILED;
+  } else if (!ApplyLocal(tx)) {
+    return MetaStatusCode::HANDLE_TX_FAILED;
+  }
+
+  if (iter != preparedTxs_.end()) {
+    Lock(txId, iter->second, false);
+    preparedTxs_.erase(iter);
+  }
+  RecordDecision(txId, tx, true);
+  return MetaStatusCode::OK;
+}
+
+MetaStatusCode TxManager::AbortShardedTx(uint64_t txId, const ShardedTx& tx) {
+  auto iter = preparedTxs_.find(txId);
+  if (iter != preparedTxs_.end()) {
+    Lock(txId, iter->second, false);
+    preparedTxs_.erase(iter);
+  }
+
+  // fence the commit which arrives late
+  if (IsCoordinator(tx)) {
+    RecordDecision(txId, tx, false);
+  }
+  return MetaStatusCode::OK;
+}
+
+MetaStatusCode TxManager::ForgetShardedTx(uint64_t txId) {
+  auto iter = decisions_.find(txId);
+  if (iter == decisions_.end()) {
+    return MetaStatusCode::OK;
+  }
+
+  // the participant may have dropped its prepare, the late prepare on
+  // coordinator must not be committed alone
+  if (!iter->second.committed) {
+    AddTombstone(txId);
+  }
+  decisions_.erase(iter);
+  return MetaStatusCode::OK;
+}
+
+void TxManager::AddTombstone(uint64_t txId) {
+  if (!tombstoneSet_.insert(txId).second) {
+    return;
+  }
+  tombstones_.push_back(txId);
+  if (tombstones_.size() > kMaxShardedTxTombstones) {
+    tombstoneSet_.erase(tombstones_.front());
+    tombstones_.pop_front();
+  }
+}
+
+bool TxManager::IsCoordinator(const ShardedTx& tx) {
+  for (const auto& dentry : tx.dentrys) {
+    if ((dentry.flag() & DentryFlag::DELETE_MARK_FLAG) && IsLocal(dentry)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TxManager::IsAllLocal(const ShardedTx& tx) {
+  for (const auto& dentry : tx.dentrys) {
+    if (!IsLocal(dentry)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TxManager::IsLocal(const Dentry& dentry) {
+  return isLocal_ == nullptr || isLocal_(dentry);
+}
+
+// the old dentry may be renamed or deleted by others after the client checked
+bool TxManager::CheckSource(const ShardedTx& tx) {
+  for (const auto& dentry : tx.dentrys) {
+    if (!(dentry.flag() & DentryFlag::DELETE_MARK_FLAG) || !IsLocal(dentry)) {
+      continue;
+    }
+
+    Dentry current(dentry);
+    current.set_txid(std::numeric_limits<uint64_t>::max());
+    auto rc = storage_->Get(&current);
+    if (rc != MetaStatusCode::OK || current.inodeid() != dentry.inodeid()) {
+      LOG(WARNING) << "Source of sharded rename tx changed, retCode = "
+                   << MetaStatusCode_Name(rc)
+                   << ", dentry = " << dentry.ShortDebugString();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TxManager::CheckLocks(uint64_t txId, const ShardedTx& tx) {
+  for (const auto& dentry : tx.dentrys) {
+    auto iter = lockedNames_.find(NameKey(dentry));
+    if (iter != lockedNames_.end() && iter->second != txId) {
+      LOG(WARNING) << "Dentry is locked by sharded rename tx " << iter->second
+                   << ", txId = " << txId
+                   << ", dentry = " << dentry.ShortDebugString();
+      return false;
+    }
+  }
+  return true;
+}
+
+void TxManager::Lock(uint64_t txId, const ShardedTx& tx, bool lock) {
+  for (const auto& dentry : tx.dentrys) {
+    if (!IsLocal(dentry)) {
+      continue;
+    } else if (lock) {
+      lockedNames_[NameKey(dentry)] = txId;
+    } else {
+      lockedNames_.erase(NameKey(dentry));
+    }
+  }
+}
+
+bool TxManager::ApplyLocal(const ShardedTx& tx) {
+  for (const auto& dentry : tx.dentrys) {
+    if (!IsLocal(dentry)) {
+      continue;
+    }
+
+    auto rc = storage_->HandleTx(DentryStorage::TX_OP_TYPE::APPLY, dentry);
+    if (rc != MetaStatusCode::OK) {
+      LOG(ERROR) << "Apply dentry of sharded rename tx failed, retCode = "
+                 << MetaStatusCode_Name(rc)
+                 << ", dentry = " << dentry.ShortDebugString();
+      return false;
+    }
+  }
+  return true;
+}
+
+void TxManager::RecordDecision(uint64_t txId, const ShardedTx& tx,
+                               bool committed) {
+  Decision decision{tx, committed};
+  decision.tx.prepareTimeSec = TimeUtility::GetTimeofDaySec();
+  decision.tx.decided = true;
+  decisions_.emplace(txId, std::move(decision));
+}
+
+bool TxManager::IsLocked(const Dentry& dentry) {
+  std::lock_guard<std::mutex> lk(shardedMutex_);
+  return lockedNames_.find(NameKey(dentry)) != lockedNames_.end();
+}
+
+std::string TxManager::NameKey(const Dentry& dentry) {
+  return std::to_string(dentry.fsid()) + ":" +
+         std::to_string(dentry.parentinodeid()) + ":" + dentry.name();
+}
+
+void TxManager::GetShardedTxs(std::vector<std::vector<Dentry>>* txs) {
+  std::lock_guard<std::mutex> lk(shardedMutex_);
+  for (const auto& item : preparedTxs_) {
+    auto dentrys = item.second.dentrys;
+    for (auto& dentry : dentrys) {
+      SetShardedTxOp(ShardedTxOp::kPrepare, &dentry);
+    }
+    txs->emplace_back(std::move(dentrys));
+  }
+
+  // all decisions in one request, every transaction has two dentries
+  std::vector<Dentry> decisions;
+  for (const auto& item : decisions_) {
+    auto op =
+        item.second.committed ? ShardedTxOp::kCommit : ShardedTxOp::kAbort;
+    for (auto dentry : item.second.tx.dentrys) {
+      SetShardedTxOp(op, &dentry);
+      decisions.push_back(std::move(dentry));
+    }
+  }
+  if (!decisions.empty()) {
+    txs->push_back(std::move(decisions));
+  }
+
+  // all tombstones in one request, only the txid is meaningful
+  std::vector<Dentry> tombstones;
+  for (uint64_t txId : tombstones_) {
+    Dentry dentry;
+    dentry.set_fsid(0);
+    dentry.set_inodeid(0);
+    dentry.set_parentinodeid(0);
+    dentry.set_name("");
+    dentry.set_txid(0);
+    dentry.set_txsequence(txId);
+    SetShardedTxOp(ShardedTxOp::kForget, &dentry);
+    tombstones.push_back(std::move(dentry));
+  }
+  if (!tombstones.empty()) {
+    txs->push_back(std::move(tombstones));
+  }
+}
+
+bool TxManager::RestoreShardedTx(const std::vector<Dentry>& dentrys) {
+  if (dentrys.empty() || !IsShardedTx(dentrys[0])) {
+    return false;
+  }
+
+  auto op = GetShardedTxOp(dentrys[0]);
+  uint64_t txId = dentrys[0].txsequence();
+  std::lock_guard<std::mutex> lk(shardedMutex_);
+  if (op == ShardedTxOp::kForget) {
+    for (const auto& dentry : dentrys) {
+      AddTombstone(dentry.txsequence());
+    }
+    return true;
+  } else if (op != ShardedTxOp::kPrepare) {
+    if (dentrys.size() % 2 != 0) {
+      return false;
+    }
+    for (size_t i = 0; i < dentrys.size(); i += 2) {
+      ShardedTx tx;
+      tx.dentrys = {dentrys[i], dentrys[i + 1]};
+      for (auto& dentry : tx.dentrys) {
+        SetShardedTxOp(ShardedTxOp::kNone, &dentry);
+      }
+      RecordDecision(dentrys[i].txsequence(), tx,
+                     GetShardedTxOp(dentrys[i]) == ShardedTxOp::kCommit);
+    }
+    return true;
+  }
+
+  ShardedTx tx;
+  tx.prepareTimeSec = TimeUtility::GetTimeofDaySec();
+  tx.dentrys = dentrys;
+  for (auto& dentry : tx.dentrys) {
+    SetShardedTxOp(ShardedTxOp::kNone, &dentry);
+  }
+  preparedTxs_.emplace(txId, tx);
+  Lock(txId, tx, true);
+  return true;
+}
+
+void TxManager::GetExpiredShardedTxs(uint64_t timeoutSec,
+                                     std::vector<ShardedTx>* txs) {
+  uint64_t now = TimeUtility::GetTimeofDaySec();
+  std::lock_guard<std::mutex> lk(shardedMutex_);
+  for (const auto& item : preparedTxs_) {
+    if (item.second.prepareTimeSec + timeoutSec <= now) {
+      txs->push_back(item.second);
+    }
+  }
+  for (const auto& item : decisions_) {
+    if (item.second.tx.prepareTimeSec + timeoutSec <= now) {
+      txs->push_back(item.second.tx);
+    }
+  }
+}
+
 };  // namespace metaserver
 };  // namespace dingofs
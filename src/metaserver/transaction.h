@@ -23,7 +23,14 @@
 #ifndef DINGOFS_SRC_METASERVER_TRANSACTION_H_
 #define DINGOFS_SRC_METASERVER_TRANSACTION_H_
 
+#include <deque>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "metaserver/dentry_storage.h"
@@ -65,13 +72,61 @@ class RenameTx {
   std::shared_ptr<DentryStorage> storage_;
 };
 
+// Sharded rename transaction, which is coordinated by the involved partitions
+// without the mds. The partition of the old dentry (which has the delete mark)
+// is the coordinator, and the partition of the new dentry is the participant:
+//   (1) prepare on the participant, then on the coordinator, both record the
+//       transaction and lock the names of their local dentries;
+//   (2) commit on the coordinator, it applies the old dentry and records the
+//       decision, this is the commit point of the whole transaction;
+//   (3) commit on the participant, it applies the new dentry;
+//   (4) forget on the coordinator, it drops the decision.
+// If both dentries belong to one partition, the transaction is committed by
+// step (2) directly. The coordinator only commits the transaction which is
+// prepared on it, and aborting drops the prepared one and records the abort
+// decision, so anyone can resolve an unfinished transaction by aborting it on
+// the coordinator first. The committed decision is kept until the participant
+// acknowledged it by (4), the aborted one is kept until it expired, both are
+// dropped by the RenameTxResolver of the coordinator at last. The participant
+// commits whatever it prepared, so the id of forgotten abort is kept as a
+// tombstone, which fences the coordinator prepare arriving that late.
+struct ShardedTx {
+  // all dentries of the transaction, without the operation flags
+  std::vector<pb::metaserver::Dentry> dentrys;
+  // local time of prepare or decision, only for finding the unfinished ones
+  uint64_t prepareTimeSec;
+  // whether it is a decision which is waiting for being forgotten
+  bool decided = false;
+};
+
 class TxManager {
  public:
-  explicit TxManager(std::shared_ptr<DentryStorage> storage);
+  using LocalChecker = std::function<bool(const pb::metaserver::Dentry&)>;
+
+  // `isLocal` tells whether the dentry belongs to this partition,
+  // all dentries are local if it is not specified.
+  explicit TxManager(std::shared_ptr<DentryStorage> storage,
+                     LocalChecker isLocal = nullptr);
 
   pb::metaserver::MetaStatusCode HandleRenameTx(
       const std::vector<pb::metaserver::Dentry>& dentrys);
 
+  // Whether the name of dentry is locked by a sharded transaction, which
+  // can't be created or deleted by others until the transaction finished.
+  bool IsLocked(const pb::metaserver::Dentry& dentry);
+
+  // Dump the prepared transactions as encoded requests for the snapshot,
+  // one request per transaction, all decisions in one request and all
+  // tombstones in another.
+  // They are loaded by RestoreShardedTx.
+  void GetShardedTxs(std::vector<std::vector<pb::metaserver::Dentry>>* txs);
+
+  bool RestoreShardedTx(const std::vector<pb::metaserver::Dentry>& dentrys);
+
+  // Transactions which are prepared or decided for more than `timeoutSec`
+  // seconds.
+  void GetExpiredShardedTxs(uint64_t timeoutSec, std::vector<ShardedTx>* txs);
+
   pb::metaserver::MetaStatusCode PreCheck(
       const std::vector<pb::metaserver::Dentry>& dentrys);
 
@@ -83,12 +138,69 @@ class TxManager {
 
   bool HandlePendingTx(uint64_t txId, RenameTx* pendingTx);
 
+ private:
+  pb::metaserver::MetaStatusCode HandleShardedTx(
+      const std::vector<pb::metaserver::Dentry>& dentrys);
+
+  pb::metaserver::MetaStatusCode PrepareShardedTx(uint64_t txId,
+                                                  const ShardedTx& tx);
+
+  pb::metaserver::MetaStatusCode CommitShardedTx(uint64_t txId,
+                                                 const ShardedTx& tx);
+
+  pb::metaserver::MetaStatusCode AbortShardedTx(uint64_t txId,
+                                                const ShardedTx& tx);
+
+  pb::metaserver::MetaStatusCode ForgetShardedTx(uint64_t txId);
+
+  bool IsLocal(const pb::metaserver::Dentry& dentry);
+
+  bool IsCoordinator(const ShardedTx& tx);
+
+  // all dentries belong to this partition
+  bool IsAllLocal(const ShardedTx& tx);
+
+  bool CheckSource(const ShardedTx& tx);
+
+  // return false if any local name is locked by another transaction
+  bool CheckLocks(uint64_t txId, const ShardedTx& tx);
+
+  void Lock(uint64_t txId, const ShardedTx& tx, bool lock);
+
+  bool ApplyLocal(const ShardedTx& tx);
+
+  void RecordDecision(uint64_t txId, const ShardedTx& tx, bool committed);
+
+  void AddTombstone(uint64_t txId);
+
+  static std::string NameKey(const pb::metaserver::Dentry& dentry);
+
  private:
   utils::RWLock rwLock_;
 
   std::shared_ptr<DentryStorage> storage_;
 
   RenameTx EMPTY_TX, pendingTx_;
+
+  LocalChecker isLocal_;
+
+  // sharded transactions, they are only modified by the raft apply thread,
+  // the mutex protects them from the snapshot and the resolver
+  std::mutex shardedMutex_;
+  // txid => transaction prepared on this partition
+  std::map<uint64_t, ShardedTx> preparedTxs_;
+  // name of local dentry => txid which locks it
+  std::unordered_map<std::string, uint64_t> lockedNames_;
+  // txid => decision of the transaction coordinated by this partition
+  struct Decision {
+    ShardedTx tx;
+    bool committed;
+  };
+  std::map<uint64_t, Decision> decisions_;
+  // ids of the forgotten aborts in the order of forgetting, the oldest one
+  // is dropped once exceeding the limit
+  std::deque<uint64_t> tombstones_;
+  std::unordered_set<uint64_t> tombstoneSet_;
 };
 
 }  // namespace metaserver
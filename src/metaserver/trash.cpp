@@ -22,8 +22,14 @@
 
 #include "metaserver/trash.h"
 
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <vector>
+
 #include "dingofs/mds.pb.h"
 #include "dingofs/metaserver.pb.h"
+#include "metaserver/clean_executor.h"
 #include "metaserver/storage/converter.h"
 #include "utils/timeutility.h"
 
@@ -38,6 +44,7 @@ using pb::metaserver::FsFileType;
 using pb::metaserver::Inode;
 using pb::metaserver::MetaStatusCode;
 using storage::Key4Inode;
+using storage::Key4TrashItem;
 using utils::Configuration;
 using utils::LockGuard;
 
@@ -54,87 +61,86 @@ void TrashImpl::Init(const TrashOption& option) {
 }
 
 void TrashImpl::Add(uint32_t fsId, uint64_t inodeId, uint32_t dtime) {
-  TrashItem item;
-  item.fsId = fsId;
-  item.inodeId = inodeId;
-  item.dtime = dtime;
-
-  LockGuard lg(itemsMutex_);
   if (isStop_) {
     return;
   }
-  trashItems_.push_back(item);
-  VLOG(6) << "Add Trash Item success, item.fsId = " << item.fsId
-          << ", item.inodeId = " << item.inodeId
-          << ", item.dtime = " << item.dtime;
+
+  auto ret = inodeStorage_->AddTrashItem(Key4TrashItem(dtime, fsId, inodeId));
+  if (ret != MetaStatusCode::OK) {
+    LOG(ERROR) << "Add Trash Item failed, fsId = " << fsId
+               << ", inodeId = " << inodeId << ", dtime = " << dtime
+               << ", ret = " << MetaStatusCode_Name(ret);
+    return;
+  }
+  VLOG(6) << "Add Trash Item success, item.fsId = " << fsId
+          << ", item.inodeId = " << inodeId << ", item.dtime = " << dtime;
 }
 
 void TrashImpl::ScanTrash() {
   LockGuard lgScan(scanMutex_);
-  std::list<TrashItem> temp;
-  {
-    LockGuard lgItems(itemsMutex_);
-    trashItems_.swap(temp);
+  std::list<TrashItem> expired;
+  if (!GetExpiredItems(&expired)) {
+    return;
   }
 
-  for (auto it = temp.begin(); it != temp.end();) {
+  // the expired items are deleted in batch, and the failed items are
+  // left in the trash item table for the next scan
+  auto& executor = CleanExecutor::GetInstance();
+  while (!expired.empty()) {
     if (isStop_) {
       return;
     }
-    if (NeedDelete(*it)) {
-      MetaStatusCode ret = DeleteInodeAndData(*it);
-      if (MetaStatusCode::NOT_FOUND == ret) {
-        it = temp.erase(it);
-        continue;
-      }
-      if (ret != MetaStatusCode::OK) {
-        LOG(ERROR) << "DeleteInodeAndData fail, fsId = " << it->fsId
-                   << ", inodeId = " << it->inodeId
-                   << ", ret = " << MetaStatusCode_Name(ret);
-        it++;
-        continue;
-      }
-      VLOG(6) << "Trash Delete Inode, fsId = " << it->fsId
-              << ", inodeId = " << it->inodeId;
-      it = temp.erase(it);
-    } else {
-      it++;
-    }
+    std::list<TrashItem> batch;
+    auto end = expired.begin();
+    std::advance(end, std::min<size_t>(executor.BatchSize(), expired.size()));
+    batch.splice(batch.end(), expired, expired.begin(), end);
+    DeleteInodesAndData(&batch);
   }
+}
+
+bool TrashImpl::GetExpiredItems(std::list<TrashItem>* items) {
+  auto iterator = inodeStorage_->GetAllTrashItem();
+  if (iterator->Status() != 0) {
+    LOG(ERROR) << "Failed to get iterator for all trash items";
+    return false;
+  }
+
+  uint32_t now = TimeUtility::GetTimeofDaySec();
+  Key4TrashItem key;
+  for (iterator->SeekToFirst(); iterator->Valid(); iterator->Next()) {
+    if (isStop_) {
+      return false;
+    }
+    if (!key.ParseFromString(iterator->Key())) {
+      LOG(ERROR) << "Decode trash item failed, key = " << iterator->Key();
+      continue;
+    }
 
-  {
-    LockGuard lgItems(itemsMutex_);
-    trashItems_.splice(trashItems_.end(), temp);
+    TrashItem item;
+    item.fsId = key.fsId;
+    item.inodeId = key.inodeId;
+    item.dtime = key.dtime;
+    // the items are sorted by dtime and all items of one partition belong
+    // to the same filesystem, so the rest items are not expired either
+    if (!NeedDelete(item, now)) {
+      break;
+    }
+    items->push_back(item);
   }
+  return true;
 }
 
 void TrashImpl::StopScan() { isStop_ = true; }
 
 bool TrashImpl::IsStop() { return isStop_; }
 
-bool TrashImpl::NeedDelete(const TrashItem& item) {
-  uint32_t now = TimeUtility::GetTimeofDaySec();
-  Inode inode;
-  MetaStatusCode ret =
-      inodeStorage_->Get(Key4Inode(item.fsId, item.inodeId), &inode);
-  if (MetaStatusCode::NOT_FOUND == ret) {
-    LOG(WARNING) << "GetInode find inode not exist, fsId = " << item.fsId
-                 << ", inodeId = " << item.inodeId
-                 << ", ret = " << MetaStatusCode_Name(ret);
-    return true;
-  } else if (ret != MetaStatusCode::OK) {
-    LOG(WARNING) << "GetInode fail, fsId = " << item.fsId
-                 << ", inodeId = " << item.inodeId
-                 << ", ret = " << MetaStatusCode_Name(ret);
-    return false;
-  }
-
+bool TrashImpl::NeedDelete(const TrashItem& item, uint32_t now) {
   // for compatibility, if fs recycleTimeHour is 0, use old trash logic
   // if fs recycleTimeHour is 0, use trash wait until expiredAfterSec
   // if fs recycleTimeHour is not 0, return true
   uint64_t recycleTimeHour = GetFsRecycleTimeHour(item.fsId);
   if (recycleTimeHour == 0) {
-    return ((now - item.dtime) >= options_.expiredAfterSec);
+    return static_cast<uint64_t>(item.dtime) + options_.expiredAfterSec <= now;
   } else {
     return true;
   }
@@ -169,10 +175,33 @@ uint64_t TrashImpl::GetFsRecycleTimeHour(uint32_t fsId) {
   return recycleTimeHour;
 }
 
-MetaStatusCode TrashImpl::DeleteInodeAndData(const TrashItem& item) {
-  Inode inode;
+MetaStatusCode TrashImpl::GetFsInfo(uint32_t fsId, FsInfo* fsInfo) {
+  auto iter = fsInfoMap_.find(fsId);
+  if (iter != fsInfoMap_.end()) {
+    *fsInfo = iter->second;
+    return MetaStatusCode::OK;
+  }
+
+  auto ret = mdsClient_->GetFsInfo(fsId, fsInfo);
+  if (ret != FSStatusCode::OK) {
+    if (FSStatusCode::NOT_FOUND == ret) {
+      LOG(ERROR) << "The fsName not exist, fsId = " << fsId;
+    } else {
+      LOG(ERROR) << "GetFsInfo failed, FSStatusCode = " << ret
+                 << ", FSStatusCode_Name = " << FSStatusCode_Name(ret)
+                 << ", fsId = " << fsId;
+    }
+    return MetaStatusCode::S3_DELETE_ERR;
+  }
+  fsInfoMap_.insert({fsId, *fsInfo});
+  return MetaStatusCode::OK;
+}
+
+MetaStatusCode TrashImpl::GetInodeToDelete(const TrashItem& item, Inode* inode,
+                                           bool* hasData) {
+  *hasData = false;
   MetaStatusCode ret =
-      inodeStorage_->Get(Key4Inode(item.fsId, item.inodeId), &inode);
+      inodeStorage_->Get(Key4Inode(item.fsId, item.inodeId), inode);
   if (ret != MetaStatusCode::OK) {
     LOG(WARNING) << "GetInode fail, fsId = " << item.fsId
                  << ", inodeId = " << item.inodeId
@@ -180,73 +209,130 @@ MetaStatusCode TrashImpl::DeleteInodeAndData(const TrashItem& item) {
     return ret;
   }
 
-  if (FsFileType::TYPE_FILE == inode.type()) {
+  if (FsFileType::TYPE_FILE == inode->type()) {
     // TODO(xuchaojie) : delete on volume
-  } else if (FsFileType::TYPE_S3 == inode.type()) {
+  } else if (FsFileType::TYPE_S3 == inode->type()) {
     // get s3info from mds
     FsInfo fsInfo;
-    if (fsInfoMap_.find(item.fsId) == fsInfoMap_.end()) {
-      auto ret = mdsClient_->GetFsInfo(item.fsId, &fsInfo);
-      if (ret != FSStatusCode::OK) {
-        if (FSStatusCode::NOT_FOUND == ret) {
-          LOG(ERROR) << "The fsName not exist, fsId = " << item.fsId;
-          return MetaStatusCode::S3_DELETE_ERR;
-        } else {
-          LOG(ERROR) << "GetFsInfo failed, FSStatusCode = " << ret
-                     << ", FSStatusCode_Name = " << FSStatusCode_Name(ret)
-                     << ", fsId = " << item.fsId;
-          return MetaStatusCode::S3_DELETE_ERR;
-        }
-      }
-      fsInfoMap_.insert({item.fsId, fsInfo});
-    } else {
-      fsInfo = fsInfoMap_.find(item.fsId)->second;
+    ret = GetFsInfo(item.fsId, &fsInfo);
+    if (ret != MetaStatusCode::OK) {
+      return ret;
     }
-    const auto& s3Info = fsInfo.detail().s3info();
-    // reinit s3 adaptor
-    S3ClientAdaptorOption clientAdaptorOption;
-    s3Adaptor_->GetS3ClientAdaptorOption(&clientAdaptorOption);
-    clientAdaptorOption.blockSize = s3Info.blocksize();
-    clientAdaptorOption.chunkSize = s3Info.chunksize();
-    clientAdaptorOption.objectPrefix = s3Info.objectprefix();
-    s3Adaptor_->Reinit(clientAdaptorOption, s3Info.ak(), s3Info.sk(),
-                       s3Info.endpoint(), s3Info.bucketname());
     ret = inodeStorage_->PaddingInodeS3ChunkInfo(
-        item.fsId, item.inodeId, inode.mutable_s3chunkinfomap());
+        item.fsId, item.inodeId, inode->mutable_s3chunkinfomap());
     if (ret != MetaStatusCode::OK) {
       LOG(ERROR) << "GetInode chunklist fail, fsId = " << item.fsId
                  << ", inodeId = " << item.inodeId
                  << ", retCode = " << MetaStatusCode_Name(ret);
       return ret;
     }
-    if (inode.s3chunkinfomap().empty()) {
+    if (inode->s3chunkinfomap().empty()) {
       LOG(WARNING) << "GetInode chunklist empty, fsId = " << item.fsId
                    << ", inodeId = " << item.inodeId;
       return MetaStatusCode::NOT_FOUND;
     }
-    VLOG(9) << "DeleteInodeAndData, inode: " << inode.ShortDebugString();
-    int retVal = s3Adaptor_->Delete(inode);
-    if (retVal != 0) {
-      LOG(ERROR) << "S3ClientAdaptor delete s3 data failed"
-                 << ", ret = " << retVal << ", fsId = " << item.fsId
-                 << ", inodeId = " << item.inodeId;
-      return MetaStatusCode::S3_DELETE_ERR;
+    *hasData = true;
+  }
+  return MetaStatusCode::OK;
+}
+
+void TrashImpl::DeleteInodesAndData(std::list<TrashItem>* items) {
+  // fsId => (items, inodes which has data)
+  std::map<uint32_t, std::pair<std::list<TrashItem>, std::vector<Inode>>>
+      pendings;
+  std::list<TrashItem> failed;
+  for (const auto& item : *items) {
+    Inode inode;
+    bool hasData;
+    MetaStatusCode ret = GetInodeToDelete(item, &inode, &hasData);
+    if (MetaStatusCode::NOT_FOUND == ret) {
+      if (DeleteItem(item) != MetaStatusCode::OK) {
+        failed.push_back(item);
+      }
+      continue;
+    } else if (ret != MetaStatusCode::OK) {
+      LOG(ERROR) << "DeleteInodeAndData fail, fsId = " << item.fsId
+                 << ", inodeId = " << item.inodeId
+                 << ", ret = " << MetaStatusCode_Name(ret);
+      failed.push_back(item);
+      continue;
+    }
+
+    auto& pending = pendings[item.fsId];
+    pending.first.push_back(item);
+    if (hasData) {
+      VLOG(9) << "DeleteInodeAndData, inode: " << inode.ShortDebugString();
+      pending.second.emplace_back(std::move(inode));
     }
   }
-  ret = inodeStorage_->Delete(Key4Inode(item.fsId, item.inodeId));
-  if (ret != MetaStatusCode::OK && ret != MetaStatusCode::NOT_FOUND) {
-    LOG(ERROR) << "Delete Inode fail, fsId = " << item.fsId
+
+  auto& executor = CleanExecutor::GetInstance();
+  for (auto& pair : pendings) {
+    uint32_t fsId = pair.first;
+    auto& pendingItems = pair.second.first;
+    const auto& inodes = pair.second.second;
+    executor.Throttle(pendingItems.size());
+    if (!inodes.empty()) {
+      auto s3Adaptor = executor.GetS3Adaptor(fsInfoMap_[fsId], s3Adaptor_);
+      int retVal = s3Adaptor->DeleteInodes(inodes);
+      if (retVal != 0) {
+        LOG(ERROR) << "S3ClientAdaptor delete s3 data failed"
+                   << ", ret = " << retVal << ", fsId = " << fsId
+                   << ", inodes = " << inodes.size();
+        failed.splice(failed.end(), pendingItems);
+        continue;
+      }
+    }
+
+    for (const auto& item : pendingItems) {
+      auto ret = inodeStorage_->Delete(Key4Inode(item.fsId, item.inodeId));
+      if (ret != MetaStatusCode::OK && ret != MetaStatusCode::NOT_FOUND) {
+        LOG(ERROR) << "Delete Inode fail, fsId = " << item.fsId
+                   << ", inodeId = " << item.inodeId
+                   << ", ret = " << MetaStatusCode_Name(ret);
+        failed.push_back(item);
+        continue;
+      } else if (DeleteItem(item) != MetaStatusCode::OK) {
+        failed.push_back(item);
+        continue;
+      }
+      VLOG(6) << "Trash Delete Inode, fsId = " << item.fsId
+              << ", inodeId = " << item.inodeId;
+    }
+  }
+
+  items->swap(failed);
+}
+
+MetaStatusCode TrashImpl::DeleteItem(const TrashItem& item) {
+  auto ret = inodeStorage_->DeleteTrashItem(
+      Key4TrashItem(item.dtime, item.fsId, item.inodeId));
+  if (ret != MetaStatusCode::OK) {
+    LOG(ERROR) << "Delete Trash Item failed, fsId = " << item.fsId
                << ", inodeId = " << item.inodeId
                << ", ret = " << MetaStatusCode_Name(ret);
-    return ret;
   }
-  return MetaStatusCode::OK;
+  return ret;
 }
 
 void TrashImpl::ListItems(std::list<TrashItem>* items) {
   LockGuard lgScan(scanMutex_);
-  LockGuard lgItems(itemsMutex_);
-  *items = trashItems_;
+  auto iterator = inodeStorage_->GetAllTrashItem();
+  if (iterator->Status() != 0) {
+    LOG(ERROR) << "Failed to get iterator for all trash items";
+    return;
+  }
+
+  Key4TrashItem key;
+  for (iterator->SeekToFirst(); iterator->Valid(); iterator->Next()) {
+    if (key.ParseFromString(iterator->Key())) {
+      TrashItem item;
+      item.fsId = key.fsId;
+      item.inodeId = key.inodeId;
+      item.dtime = key.dtime;
+      items->push_back(item);
+    }
+  }
 }
 
 }  // namespace metaserver
@@ -76,6 +76,9 @@ class Trash {
   virtual bool IsStop() = 0;
 };
 
+// The trash items are persisted in the trash item table of inode storage,
+// which is sorted by dtime, so the scan only visits the expired prefix
+// and the items survive the restart of metaserver.
 class TrashImpl : public Trash {
  public:
   explicit TrashImpl(const std::shared_ptr<InodeStorage>& inodeStorage)
@@ -96,9 +99,25 @@ class TrashImpl : public Trash {
   bool IsStop() override;
 
  private:
-  bool NeedDelete(const TrashItem& item);
+  bool NeedDelete(const TrashItem& item, uint32_t now);
 
-  pb::metaserver::MetaStatusCode DeleteInodeAndData(const TrashItem& item);
+  // Get the expired items from the head of trash item table.
+  bool GetExpiredItems(std::list<TrashItem>* items);
+
+  pb::metaserver::MetaStatusCode DeleteItem(const TrashItem& item);
+
+  // Get the inode of item with its s3chunkinfo, `hasData` is set if the
+  // data of inode should be deleted from s3.
+  pb::metaserver::MetaStatusCode GetInodeToDelete(const TrashItem& item,
+                                                  pb::metaserver::Inode* inode,
+                                                  bool* hasData);
+
+  pb::metaserver::MetaStatusCode GetFsInfo(uint32_t fsId,
+                                           pb::mds::FsInfo* fsInfo);
+
+  // Delete inodes and its data in batch, the items failed to delete are
+  // left in `items` for retry.
+  void DeleteInodesAndData(std::list<TrashItem>* items);
 
   uint64_t GetFsRecycleTimeHour(uint32_t fsId);
 
@@ -107,10 +126,6 @@ class TrashImpl : public Trash {
   std::shared_ptr<stub::rpcclient::MdsClient> mdsClient_;
   std::unordered_map<uint32_t, pb::mds::FsInfo> fsInfoMap_;
 
-  std::list<TrashItem> trashItems_;
-
-  mutable utils::Mutex itemsMutex_;
-
   TrashOption options_;
 
   mutable utils::Mutex scanMutex_;
@@ -23,6 +23,10 @@
 #include "metaserver/trash_manager.h"
 
 #include <list>
+#include <utility>
+#include <vector>
+
+#include "metaserver/clean_executor.h"
 
 namespace dingofs {
 namespace metaserver {
@@ -58,11 +62,18 @@ void TrashManager::ScanEveryTrash() {
     dingofs::utils::ReadLockGuard lg(rwLock_);
     temp = trashs_;
   }
+
+  // scan trashes of different partitions in parallel
+  std::vector<std::pair<uint64_t, CleanExecutor::Task>> tasks;
   for (auto& pair : temp) {
-    if (!pair.second->IsStop()) {
-      pair.second->ScanTrash();
-    }
+    auto trash = pair.second;
+    tasks.emplace_back(pair.first, [trash]() {
+      if (!trash->IsStop()) {
+        trash->ScanTrash();
+      }
+    });
   }
+  CleanExecutor::GetInstance().SubmitAndWait(std::move(tasks));
 }
 
 void TrashManager::Remove(uint32_t partitionId) {
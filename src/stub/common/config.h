@@ -35,6 +35,14 @@ namespace common {
 
 using ::dingofs::utils::Configuration;
 
+enum class InodePlacementPolicy {
+  // a random readwrite partition
+  kRandom = 0,
+  // the partition of parent while it is readwrite, otherwise a readwrite
+  // partition weighted by its free inode ids
+  kLocality = 1,
+};
+
 struct MetaCacheOpt {
   int metacacheGetLeaderRetry = 3;
   int metacacheRPCRetryIntervalUS = 500;
@@ -42,6 +50,8 @@ struct MetaCacheOpt {
 
   uint16_t getPartitionCountOnce = 3;
   uint16_t createPartitionOnce = 3;
+
+  InodePlacementPolicy inodePlacementPolicy = InodePlacementPolicy::kRandom;
 };
 
 struct ExcutorOpt {
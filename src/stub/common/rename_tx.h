@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_STUB_COMMON_RENAME_TX_H_
+#define DINGOFS_SRC_STUB_COMMON_RENAME_TX_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "dingofs/metaserver.pb.h"
+
+namespace dingofs {
+namespace stub {
+namespace common {
+
+// The sharded rename transaction is coordinated by the involved partitions
+// instead of the mds, it reuses the PrepareRenameTx request:
+//   (1) the operation is carried in the high bits of Dentry::flag, which are
+//       cleared before the dentry is persisted;
+//   (2) Dentry::txsequence is the id of transaction, which is unique
+//       among all clients;
+//   (3) the request contains all dentries of the transaction, and it is
+//       routed to the partition of the first dentry.
+enum class ShardedTxOp : uint32_t {
+  kNone = 0,
+  kPrepare = 1U << 16,
+  kCommit = 1U << 17,
+  kAbort = 1U << 18,
+  // the transaction finished on all partitions, the coordinator drops
+  // its decision
+  kForget = 1U << 19,
+};
+
+constexpr uint32_t kShardedTxOpMask =
+    (1U << 16) | (1U << 17) | (1U << 18) | (1U << 19);
+
+inline ShardedTxOp GetShardedTxOp(const pb::metaserver::Dentry& dentry) {
+  return static_cast<ShardedTxOp>(dentry.flag() & kShardedTxOpMask);
+}
+
+inline bool IsShardedTx(const pb::metaserver::Dentry& dentry) {
+  return GetShardedTxOp(dentry) != ShardedTxOp::kNone;
+}
+
+inline void SetShardedTxOp(ShardedTxOp op, pb::metaserver::Dentry* dentry) {
+  dentry->set_flag((dentry->flag() & ~kShardedTxOpMask) |
+                   static_cast<uint32_t>(op));
+}
+
+// Build the request of `op` which is sent to the partition of
+// dentrys[target], the other dentries keep their order.
+inline std::vector<pb::metaserver::Dentry> EncodeShardedTx(
+    ShardedTxOp op, const std::vector<pb::metaserver::Dentry>& dentrys,
+    size_t target) {
+  std::vector<pb::metaserver::Dentry> out{dentrys[target]};
+  for (size_t i = 0; i < dentrys.size(); i++) {
+    if (i != target) {
+      out.push_back(dentrys[i]);
+    }
+  }
+  for (auto& dentry : out) {
+    SetShardedTxOp(op, &dentry);
+  }
+  return out;
+}
+
+}  // namespace common
+}  // namespace stub
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_STUB_COMMON_RENAME_TX_H_
@@ -136,6 +136,9 @@ struct MetaServerClientMetric {
   // all
   InterfaceMetric getAllOperation;
 
+  // number of partitions touched by one batch of inodes, e.g. readdirplus
+  bvar::IntRecorder batchInodePartitions;
+
   MetaServerClientMetric()
       : getDentry(prefix, "getDentry"),
         listDentry(prefix, "listDentry"),
@@ -156,7 +159,8 @@ struct MetaServerClientMetric {
         flush_fs_usage(prefix, "flushFsUsage"),
         load_dir_quotas(prefix, "loadDirQuotas"),
         flush_dir_usages(prefix, "flushDirUsages"),
-        getAllOperation(prefix, "getAllopt") {}
+        getAllOperation(prefix, "getAllopt"),
+        batchInodePartitions(prefix, "batchInodePartitions") {}
 };
 
 struct OpMetric {
@@ -314,8 +318,14 @@ struct KVClientMetric {
   static const std::string prefix;
   InterfaceMetric kvClientGet;
   InterfaceMetric kvClientSet;
-
-  KVClientMetric() : kvClientGet(prefix, "get"), kvClientSet(prefix, "set") {}
+  InterfaceMetric kvClientBatchGet;
+  bvar::Adder<uint64_t> kvClientBatchGetKeys;
+
+  KVClientMetric()
+      : kvClientGet(prefix, "get"),
+        kvClientSet(prefix, "set"),
+        kvClientBatchGet(prefix, "batch_get"),
+        kvClientBatchGetKeys(prefix, "batch_get_keys") {}
 };
 
 struct S3ChunkInfoMetric {
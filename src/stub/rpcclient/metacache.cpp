@@ -37,6 +37,7 @@ namespace rpcclient {
 using common::CopysetID;
 using common::CopysetInfo;
 using common::CopysetPeerInfo;
+using common::InodePlacementPolicy;
 using common::LogicPoolID;
 using common::MetaserverID;
 using common::PartitionID;
@@ -48,7 +49,6 @@ using pb::mds::FSStatusCode;
 using pb::mds::topology::Copyset;
 using pb::mds::topology::PartitionTxId;
 using utils::ReadLockGuard;
-using utils::RWLock;
 using utils::WriteLockGuard;
 
 using Mutex = ::bthread::Mutex;
@@ -69,16 +69,16 @@ void MetaCache::GetTxId(uint32_t partitionId, uint64_t* txId) {
 
 bool MetaCache::GetTxId(uint32_t fsId, uint64_t inodeId, uint32_t* partitionId,
                         uint64_t* txId) {
-  for (const auto& partition : partitionInfos_) {
-    if (fsId == partition.fsid() && inodeId >= partition.start() &&
-        inodeId <= partition.end()) {
-      *partitionId = partition.partitionid();
-      *txId = partition.txid();
-      GetTxId(*partitionId, txId);
-      return true;
-    }
+  auto routingTable = GetRoutingTable();
+  const auto* route = routingTable->Lookup(inodeId);
+  if (route == nullptr || route->fsId != fsId) {
+    return false;
   }
-  return false;
+
+  *partitionId = route->partitionId;
+  *txId = route->txId;
+  GetTxId(*partitionId, txId);
+  return true;
 }
 
 void MetaCache::GetAllTxIds(std::vector<PartitionTxId>* txIds) {
@@ -132,9 +132,9 @@ bool MetaCache::GetTarget(uint32_t fsID, uint64_t inodeID,
 }
 
 bool MetaCache::SelectTarget(uint32_t fsID, CopysetTarget* target,
-                             uint64_t* applyIndex) {
+                             uint64_t* applyIndex, uint64_t parentId) {
   // select a partition
-  if (!SelectPartition(target)) {
+  if (!SelectPartition(target, parentId)) {
     // list from mds
     if (!ListPartitions(fsID)) {
       LOG(ERROR) << "select target for {fsid:" << fsID
@@ -142,7 +142,7 @@ bool MetaCache::SelectTarget(uint32_t fsID, CopysetTarget* target,
       return false;
     }
 
-    if (!SelectPartition(target)) {
+    if (!SelectPartition(target, parentId)) {
       LOG(ERROR) << "select target for {fsid:" << fsID
                  << "} fail,  select partition fail";
       return false;
@@ -414,6 +414,17 @@ void MetaCache::DoAddOrResetPartitionAndCopyset(
   // add copysetInfo
   copysetInfoMap_.insert(std::make_move_iterator(copysetMap.begin()),
                          std::make_move_iterator(copysetMap.end()));
+
+  PublishRoutingTable();
+}
+
+void MetaCache::PublishRoutingTable() {
+  std::shared_ptr<const RoutingTable> routingTable =
+      std::make_shared<RoutingTable>(partitionInfos_, ++routingVersion_);
+  std::atomic_store(&routingTable_, std::move(routingTable));
+  VLOG(3) << "publish routing table for {fsid:" << fsID_
+          << "}, version = " << routingVersion_
+          << ", partition size = " << partitionInfos_.size();
 }
 
 bool MetaCache::UpdateCopysetInfoFromMDS(
@@ -475,7 +486,10 @@ bool MetaCache::MarkPartitionUnavailable(PartitionID pid) {
   for (auto iter = partitionInfos_.begin(); iter != partitionInfos_.end();
        iter++) {
     if (iter->partitionid() == pid) {
-      iter->set_status(PartitionStatus::READONLY);
+      if (iter->status() != PartitionStatus::READONLY) {
+        iter->set_status(PartitionStatus::READONLY);
+        PublishRoutingTable();
+      }
       break;
     }
   }
@@ -498,27 +512,32 @@ void MetaCache::UpdateCopysetInfoIfMatchCurrentLeader(
   }
 }
 
-bool MetaCache::SelectPartition(CopysetTarget* target) {
-  // exclude partition which is readonly
-  std::map<PartitionID, PartitionInfo> candidate;
-  int currentNum = 0;
-  {
-    ReadLockGuard rl(rwlock4Partitions_);
-    currentNum = partitionInfos_.size();
-    for_each(partitionInfos_.begin(), partitionInfos_.end(),
-             [&](const PartitionInfo& pInfo) {
-               if (pInfo.status() == PartitionStatus::READWRITE) {
-                 candidate[pInfo.partitionid()] = pInfo;
-               }
-             });
+bool MetaCache::SelectPartition(CopysetTarget* target, uint64_t parentId) {
+  // only the partition which is readwrite can be selected
+  auto routingTable = GetRoutingTable();
+  const RoutingTable::Route* route = nullptr;
+  if (metacacheopt_.inodePlacementPolicy == InodePlacementPolicy::kLocality) {
+    // the dentries of parent are in the partition of parent, the create
+    // and readdirplus touch one partition if the inode is placed there.
+    // the partition which is filled much faster than others is skipped,
+    // so a hot directory doesn't pile up in one partition
+    route = parentId == 0 ? nullptr : routingTable->SelectLocal(parentId);
+    if (route != nullptr) {
+      localPlacement_ << 1;
+    } else {
+      route = routingTable->SelectWeighted(butil::fast_rand());
+      spillPlacement_ << (route != nullptr && parentId != 0 ? 1 : 0);
+    }
+  } else {
+    route = routingTable->Select(butil::fast_rand());
   }
 
-  if (candidate.empty()) {
+  if (route == nullptr) {
     // create partition for fs
     LOG(INFO) << "no partition can be select for fsid:" << fsID_
               << ", need create new partitions";
     PartitionInfoList newPartitions;
-    if (!CreatePartitions(currentNum, &newPartitions)) {
+    if (!CreatePartitions(routingTable->Size(), &newPartitions)) {
       LOG(ERROR) << "create partition for fsid:" << fsID_ << " fail";
       return false;
     }
@@ -529,14 +548,9 @@ bool MetaCache::SelectPartition(CopysetTarget* target) {
     target->partitionID = iter->partitionid();
     target->txId = iter->txid();
   } else {
-    // random select a partition
-    const auto index = butil::fast_rand() % candidate.size();
-    auto iter = candidate.begin();
-    std::advance(iter, index);
-    target->groupID =
-        CopysetGroupID(iter->second.poolid(), iter->second.copysetid());
-    target->partitionID = iter->first;
-    target->txId = iter->second.txid();
+    target->groupID = CopysetGroupID(route->poolId, route->copysetId);
+    target->partitionID = route->partitionId;
+    target->txId = route->txId;
   }
 
   return true;
@@ -546,18 +560,17 @@ bool MetaCache::GetCopysetIDwithInodeID(uint64_t inodeID,
                                         CopysetGroupID* groupID,
                                         PartitionID* partitionID,
                                         uint64_t* txId) {
-  ReadLockGuard rl(rwlock4Partitions_);
-  for (auto iter = partitionInfos_.begin(); iter != partitionInfos_.end();
-       ++iter) {
-    if (iter->start() <= inodeID && iter->end() >= inodeID) {
-      *groupID = CopysetGroupID(iter->poolid(), iter->copysetid());
-      *partitionID = iter->partitionid();
-      *txId = iter->txid();
-      GetTxId(*partitionID, txId);
-      return true;
-    }
+  auto routingTable = GetRoutingTable();
+  const auto* route = routingTable->Lookup(inodeID);
+  if (route == nullptr) {
+    return false;
   }
-  return false;
+
+  *groupID = CopysetGroupID(route->poolId, route->copysetId);
+  *partitionID = route->partitionId;
+  *txId = route->txId;
+  GetTxId(*partitionID, txId);
+  return true;
 }
 
 bool MetaCache::GetCopysetInfowithCopySetID(
@@ -573,32 +586,25 @@ bool MetaCache::GetCopysetInfowithCopySetID(
   return true;
 }
 
-bool TryGetPartitionIdByInodeId(const std::vector<PartitionInfo>& plist,
-                                RWLock* lock, uint64_t inodeID,
-                                PartitionID* pid) {
-  ReadLockGuard rl(*lock);
-  for (const auto& it : plist) {
-    if (it.start() <= inodeID && it.end() >= inodeID) {
-      *pid = it.partitionid();
-      return true;
-    }
-  }
-  return false;
-}
-
 bool MetaCache::GetPartitionIdByInodeId(uint32_t fsID, uint64_t inodeID,
                                         PartitionID* pid) {
-  if (!TryGetPartitionIdByInodeId(partitionInfos_, &rwlock4Partitions_, inodeID,
-                                  pid)) {
+  auto routingTable = GetRoutingTable();
+  const auto* route = routingTable->Lookup(inodeID);
+  if (route == nullptr) {
     // list form mds
     if (!ListPartitions(fsID)) {
       LOG(ERROR) << "ListPartitions for {fsid:" << fsID
                  << "} fail, partition list not exist";
       return false;
     }
-    return TryGetPartitionIdByInodeId(partitionInfos_, &rwlock4Partitions_,
-                                      inodeID, pid);
+    routingTable = GetRoutingTable();
+    route = routingTable->Lookup(inodeID);
+    if (route == nullptr) {
+      return false;
+    }
   }
+
+  *pid = route->partitionId;
   return true;
 }
 
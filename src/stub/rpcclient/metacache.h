@@ -25,6 +25,7 @@
 
 #include <brpc/channel.h>
 #include <brpc/controller.h>
+#include <bvar/bvar.h>
 
 #include <map>
 #include <memory>
@@ -39,6 +40,7 @@
 #include "stub/common/metacache_struct.h"
 #include "stub/rpcclient/cli2_client.h"
 #include "stub/rpcclient/mds_client.h"
+#include "stub/rpcclient/routing_table.h"
 #include "utils/concurrent/concurrent.h"
 
 namespace dingofs {
@@ -125,8 +127,10 @@ class MetaCache {
   virtual bool GetTarget(uint32_t fsID, uint64_t inodeID, CopysetTarget* target,
                          uint64_t* applyIndex, bool refresh = false);
 
+  // select a partition for the new inode whose parent is `parentId`,
+  // `parentId` is 0 if the inode has no preferred partition
   virtual bool SelectTarget(uint32_t fsID, CopysetTarget* target,
-                            uint64_t* applyIndex);
+                            uint64_t* applyIndex, uint64_t parentId = 0);
 
   virtual void UpdateApplyIndex(const CopysetGroupID& groupID,
                                 uint64_t applyIndex);
@@ -179,7 +183,7 @@ class MetaCache {
   // select a dest parition for inode create
   // TODO(@lixiaocui): select parititon may be need SelectPolicy to support
   // more policies
-  bool SelectPartition(CopysetTarget* target);
+  bool SelectPartition(CopysetTarget* target, uint64_t parentId);
 
   // get info from partitionMap or copysetMap
   bool GetCopysetIDwithInodeID(uint64_t inodeID, CopysetGroupID* groupID,
@@ -189,6 +193,14 @@ class MetaCache {
       const CopysetGroupID& groupID,
       common::CopysetInfo<common::MetaserverID>* targetInfo);
 
+  // rebuild the routing table from partitionInfos_ and publish it,
+  // the caller must hold the write lock of rwlock4Partitions_
+  void PublishRoutingTable();
+
+  std::shared_ptr<const RoutingTable> GetRoutingTable() const {
+    return std::atomic_load(&routingTable_);
+  }
+
   // key tansform
   static PoolIDCopysetID CalcLogicPoolCopysetID(const CopysetGroupID& groupID) {
     return (static_cast<uint64_t>(groupID.poolID) << 32) |
@@ -198,8 +210,14 @@ class MetaCache {
   utils::RWLock txIdLock_;
   std::unordered_map<uint32_t, uint64_t> partitionTxId_;
 
+  // partitionInfos_ is only accessed by the writers, the readers resolve
+  // the inode with routingTable_ which is accessed by std::atomic_load and
+  // std::atomic_store only
   utils::RWLock rwlock4Partitions_;
   PartitionInfoList partitionInfos_;
+  uint64_t routingVersion_ = 0;
+  std::shared_ptr<const RoutingTable> routingTable_ =
+      std::make_shared<RoutingTable>();
   utils::RWLock rwlock4copysetInfoMap_;
   CopysetInfoMap copysetInfoMap_;
 
@@ -211,6 +229,10 @@ class MetaCache {
 
   uint32_t fsID_;
   std::atomic_bool init_;
+
+  // the new inodes which are placed in the partition of parent or not
+  bvar::Adder<uint64_t> localPlacement_{"metacache", "inode_placement_local"};
+  bvar::Adder<uint64_t> spillPlacement_{"metacache", "inode_placement_spill"};
 };
 
 }  // namespace rpcclient
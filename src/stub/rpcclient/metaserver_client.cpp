@@ -596,6 +596,7 @@ bool MetaServerClientImpl::SplitRequestInodes(
   if (!ret) {
     return false;
   }
+  metric_.batchInodePartitions << groups.size();
   for (const auto& it : groups) {
     auto iter = it.second.begin();
     while (iter != it.second.end()) {
@@ -1400,8 +1401,12 @@ MetaStatusCode MetaServerClientImpl::CreateInode(const InodeParam& param,
     return ret;
   };
 
+  // the directories are spread over partitions by their free inode ids,
+  // the other inodes are placed with their parent
+  uint64_t placement =
+      param.type == FsFileType::TYPE_DIRECTORY ? 0 : param.parent;
   auto task_ctx = std::make_shared<TaskContext>(MetaServerOpType::CreateInode,
-                                                task, param.fsId, 0);
+                                                task, param.fsId, placement);
   CreateInodeExcutor excutor(opt_, metaCache_, channelManager_, task_ctx);
   return ConvertToMetaStatusCode(excutor.DoRPCTask());
 }
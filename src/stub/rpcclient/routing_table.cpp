@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stub/rpcclient/routing_table.h"
+
+#include <algorithm>
+
+namespace dingofs {
+namespace stub {
+namespace rpcclient {
+
+using pb::common::PartitionInfo;
+using pb::common::PartitionStatus;
+
+RoutingTable::RoutingTable(const std::vector<PartitionInfo>& partitions,
+                           uint64_t version)
+    : averageFreeIds_(0), version_(version) {
+  routes_.reserve(partitions.size());
+  for (const auto& info : partitions) {
+    Route route;
+    route.start = info.start();
+    route.end = info.end();
+    route.txId = info.txid();
+    route.fsId = info.fsid();
+    route.poolId = info.poolid();
+    route.copysetId = info.copysetid();
+    route.partitionId = info.partitionid();
+    route.readWrite = info.status() == PartitionStatus::READWRITE;
+    // the next id is reported by mds when the partitions are listed, so
+    // the free ids are only a hint of the load of partition
+    uint64_t next = std::max(info.start(), info.nextid());
+    route.freeIds = info.end() >= next ? info.end() - next + 1 : 0;
+    routes_.emplace_back(route);
+  }
+
+  std::stable_sort(
+      routes_.begin(), routes_.end(),
+      [](const Route& lhs, const Route& rhs) { return lhs.start < rhs.start; });
+
+  starts_.reserve(routes_.size());
+  for (const auto& route : routes_) {
+    starts_.emplace_back(route.start);
+  }
+
+  // the candidates are ordered by partition id, so the selection doesn't
+  // depend on the order of partitions returned by mds
+  for (size_t i = 0; i < routes_.size(); i++) {
+    if (routes_[i].readWrite) {
+      candidates_.emplace_back(i);
+    }
+  }
+  std::sort(candidates_.begin(), candidates_.end(),
+            [this](uint32_t lhs, uint32_t rhs) {
+              return routes_[lhs].partitionId < routes_[rhs].partitionId;
+            });
+
+  uint64_t sum = 0;
+  weights_.reserve(candidates_.size());
+  for (auto index : candidates_) {
+    sum += std::max<uint64_t>(routes_[index].freeIds, 1);
+    weights_.emplace_back(sum);
+  }
+  if (!candidates_.empty()) {
+    averageFreeIds_ = sum / candidates_.size();
+  }
+}
+
+const RoutingTable::Route* RoutingTable::Lookup(uint64_t inodeId) const {
+  auto iter = std::upper_bound(starts_.begin(), starts_.end(), inodeId);
+  if (iter == starts_.begin()) {
+    return nullptr;
+  }
+
+  const Route& route = routes_[iter - starts_.begin() - 1];
+  return inodeId <= route.end ? &route : nullptr;
+}
+
+const RoutingTable::Route* RoutingTable::Select(uint64_t rand) const {
+  if (candidates_.empty()) {
+    return nullptr;
+  }
+  return &routes_[candidates_[rand % candidates_.size()]];
+}
+
+const RoutingTable::Route* RoutingTable::SelectWeighted(uint64_t rand) const {
+  if (candidates_.empty()) {
+    return nullptr;
+  }
+
+  uint64_t weight = rand % weights_.back();
+  auto iter = std::upper_bound(weights_.begin(), weights_.end(), weight);
+  return &routes_[candidates_[iter - weights_.begin()]];
+}
+
+const RoutingTable::Route* RoutingTable::SelectLocal(uint64_t inodeId) const {
+  const auto* route = Lookup(inodeId);
+  if (route == nullptr || !route->readWrite ||
+      route->freeIds * 2 < averageFreeIds_) {
+    return nullptr;
+  }
+  return route;
+}
+
+}  // namespace rpcclient
+}  // namespace stub
+}  // namespace dingofs
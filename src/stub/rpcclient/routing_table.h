@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_STUB_RPCCLIENT_ROUTING_TABLE_H_
+#define DINGOFS_SRC_STUB_RPCCLIENT_ROUTING_TABLE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "dingofs/common.pb.h"
+
+namespace dingofs {
+namespace stub {
+namespace rpcclient {
+
+// An immutable snapshot of the partitions of fs, it is rebuilt and
+// published as a whole by MetaCache when the partitions change, so the
+// readers resolve the inode without any lock.
+//
+// The inode ranges of partitions are disjoint, the starts are kept sorted
+// in a dense array for binary search.
+class RoutingTable {
+ public:
+  struct Route {
+    uint64_t start;
+    uint64_t end;
+    uint64_t txId;
+    uint64_t freeIds;
+    uint32_t fsId;
+    uint32_t poolId;
+    uint32_t copysetId;
+    uint32_t partitionId;
+    bool readWrite;
+  };
+
+  RoutingTable() : averageFreeIds_(0), version_(0) {}
+
+  RoutingTable(const std::vector<pb::common::PartitionInfo>& partitions,
+               uint64_t version);
+
+  // return the partition whose inode range contains `inodeId`, or nullptr
+  const Route* Lookup(uint64_t inodeId) const;
+
+  // return a READWRITE partition picked by `rand`, or nullptr if none
+  const Route* Select(uint64_t rand) const;
+
+  // same as Select(), but the partition with more free inode ids is more
+  // likely to be picked
+  const Route* SelectWeighted(uint64_t rand) const;
+
+  // return the partition of `inodeId` if it's READWRITE and its free inode
+  // ids are not less than half of the average of READWRITE partitions,
+  // otherwise nullptr
+  const Route* SelectLocal(uint64_t inodeId) const;
+
+  // number of all partitions, including the readonly ones
+  size_t Size() const { return routes_.size(); }
+
+  uint64_t Version() const { return version_; }
+
+ private:
+  std::vector<uint64_t> starts_;  // sorted, same order as routes_
+  std::vector<Route> routes_;
+  std::vector<uint32_t> candidates_;  // index of READWRITE routes
+  std::vector<uint64_t> weights_;     // prefix sum of candidates' weight
+  uint64_t averageFreeIds_;           // average free ids of candidates
+  uint64_t version_;
+};
+
+}  // namespace rpcclient
+}  // namespace stub
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_STUB_RPCCLIENT_ROUTING_TABLE_H_
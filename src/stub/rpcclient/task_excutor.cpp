@@ -34,6 +34,7 @@ namespace rpcclient {
 using pb::metaserver::MetaStatusCode;
 
 using common::MetaserverID;
+using common::PartitionID;
 
 MetaStatusCode ConvertToMetaStatusCode(int retcode) {
   if (retcode < 0) {
@@ -146,6 +147,11 @@ bool TaskExecutor::OnReturn(int retCode) {
         }
         break;
 
+      case MetaStatusCode::PARTITION_ID_MISSMATCH:
+        // the partition may be split, the inode belongs to another one
+        needRetry = OnPartitionIdMismatch();
+        break;
+
       case MetaStatusCode::PARTITION_ALLOC_ID_FAIL:
         // TODO(@lixiaocui @cw123): metaserver and mds heartbeat should
         // report this status
@@ -243,6 +249,21 @@ bool TaskExecutor::OnPartitionNotExist() {
   return metaCache_->ListPartitions(task_->fsID);
 }
 
+bool TaskExecutor::OnPartitionIdMismatch() {
+  // retry only if the inode is routed to another partition after refreshing,
+  // otherwise the mismatch is not caused by a stale route
+  PartitionID oldPartition = task_->target.partitionID;
+  if (!metaCache_->ListPartitions(task_->fsID)) {
+    return false;
+  }
+
+  task_->target.Reset();
+  if (!GetTarget()) {
+    return false;
+  }
+  return task_->target.partitionID != oldPartition;
+}
+
 void TaskExecutor::OnReDirected() { RefreshLeader(); }
 
 void TaskExecutor::RefreshLeader() {
@@ -326,7 +347,7 @@ void TaskExecutorDone::Run() {
 
 bool CreateInodeExcutor::GetTarget() {
   if (!metaCache_->SelectTarget(task_->fsID, &task_->target,
-                                &task_->applyIndex)) {
+                                &task_->applyIndex, task_->inodeID)) {
     LOG(ERROR) << "select target for task fail, " << task_->TaskContextStr();
     return false;
   }
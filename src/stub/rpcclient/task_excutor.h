@@ -72,7 +72,7 @@ class TaskContext {
   RpcFunc rpctask = nullptr;
   uint32_t fsID = 0;
   // inode used to locate replacement of dentry or inode. for CreateDentry
-  // inodeid,`task_->inodeID` is parentinodeID
+  // and CreateInode, `task_->inodeID` is parentinodeID
   uint64_t inodeID = 0;
 
   CopysetTarget target;
@@ -130,6 +130,7 @@ class TaskExecutor {
   void OnReDirected();
   void OnCopysetNotExist();
   bool OnPartitionNotExist();
+  bool OnPartitionIdMismatch();
   void OnPartitionAllocIDFail();
 
   // retry policy
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_UTILS_CONCURRENT_SHARDED_TASK_POOL_H_
+#define DINGOFS_SRC_UTILS_CONCURRENT_SHARDED_TASK_POOL_H_
+
+#include <glog/logging.h>
+
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "utils/concurrent/task_thread_pool.h"
+#include "utils/cpu_affinity.h"
+#include "utils/uncopyable.h"
+
+namespace dingofs {
+namespace utils {
+
+// A thread pool which runs the tasks of the same key on the same shard.
+//
+// Every shard has its own queue and threads, so the shards never contend
+// for the same queue lock. With one thread per shard, the state touched by
+// the tasks of one key (e.g. the caches of one inode) stays in the cache of
+// one core, the shard threads can be bound to the usable cpus in turn.
+class ShardedTaskPool : public Uncopyable {
+ public:
+  explicit ShardedTaskPool(const std::string& thread_name = "sharded_pool")
+      : thread_name_(thread_name) {}
+
+  virtual ~ShardedTaskPool() { Stop(); }
+
+  /**
+   * @param numShards the number of shards, must be greater than 0
+   * @param threadsPerShard the number of threads of each shard
+   * @param queueCapacity the queue capacity of each shard
+   * @param bindCpu bind the threads of every shard to one cpu or not
+   * @return 0 on success, -1 on invalid arguments
+   */
+  int Start(int numShards, int threadsPerShard, int queueCapacity = INT_MAX,
+            bool bindCpu = false) {
+    if (numShards <= 0) {
+      return -1;
+    }
+    if (!shards_.empty()) {
+      return 0;
+    }
+
+    std::vector<int> cpus;
+    if (bindCpu) {
+      cpus = CpuAffinity::GetUsableCpus();
+    }
+
+    for (int i = 0; i < numShards; i++) {
+      int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+      auto shard = std::make_unique<Shard>(thread_name_, cpu);
+      int rc = shard->Start(threadsPerShard, queueCapacity);
+      if (rc != 0) {
+        Stop();
+        return rc;
+      }
+      shards_.emplace_back(std::move(shard));
+    }
+    return 0;
+  }
+
+  void Stop() {
+    for (auto& shard : shards_) {
+      shard->Stop();
+    }
+    shards_.clear();
+  }
+
+  template <class F, class... Args>
+  void Enqueue(uint64_t key, F&& f, Args&&... args) {
+    shards_[key % shards_.size()]->Enqueue(std::forward<F>(f),
+                                           std::forward<Args>(args)...);
+  }
+
+  /* the number of tasks in all queues */
+  int QueueSize() const {
+    int size = 0;
+    for (const auto& shard : shards_) {
+      size += shard->QueueSize();
+    }
+    return size;
+  }
+
+  int ShardOfNums() const { return shards_.size(); }
+
+ private:
+  class Shard : public TaskThreadPool<> {
+   public:
+    Shard(const std::string& thread_name, int cpu)
+        : TaskThreadPool<>(thread_name), cpu_(cpu) {}
+
+   protected:
+    void ThreadFunc() override {
+      if (cpu_ >= 0 && !CpuAffinity::BindCurrentThread(cpu_)) {
+        LOG(WARNING) << "Bind " << thread_name_ << " to cpu " << cpu_
+                     << " failed.";
+      }
+      TaskThreadPool<>::ThreadFunc();
+    }
+
+   private:
+    int cpu_;
+  };
+
+ private:
+  std::string thread_name_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace utils
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_UTILS_CONCURRENT_SHARDED_TASK_POOL_H_
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DINGOFS_SRC_UTILS_CPU_AFFINITY_H_
+#define DINGOFS_SRC_UTILS_CPU_AFFINITY_H_
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <vector>
+
+namespace dingofs {
+namespace utils {
+
+class CpuAffinity {
+ public:
+  // return the cpus which the process is allowed to run on
+  static std::vector<int> GetUsableCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+      return cpus;
+    }
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+    return cpus;
+  }
+
+  // bind the calling thread to `cpu`
+  static bool BindCurrentThread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+  }
+};
+
+}  // namespace utils
+}  // namespace dingofs
+
+#endif  // DINGOFS_SRC_UTILS_CPU_AFFINITY_H_
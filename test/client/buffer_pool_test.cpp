@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/buffer_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "client/common/dynamic_config.h"
+#include "client/dir_buffer.h"
+
+namespace dingofs {
+namespace client {
+
+TEST(BufferPoolTest, SizeClass) {
+  ASSERT_EQ(BufferPool::SizeClass(0), 0);
+  ASSERT_EQ(BufferPool::SizeClass(1), 0);
+  ASSERT_EQ(BufferPool::SizeClass(4096), 0);
+  ASSERT_EQ(BufferPool::SizeClass(4097), 1);
+  ASSERT_EQ(BufferPool::SizeClass(128 * 1024), 5);
+  ASSERT_EQ(BufferPool::SizeClass(BufferPool::kMaxBufferSize),
+            BufferPool::kNumSizeClasses - 1);
+  ASSERT_EQ(BufferPool::SizeClass(BufferPool::kMaxBufferSize + 1), -1);
+}
+
+TEST(BufferPoolTest, ReuseInThread) {
+  auto& pool = BufferPool::GetInstance();
+  size_t capacity = 0;
+  char* buffer = pool.Allocate(100 * 1024, &capacity);
+  ASSERT_EQ(capacity, 128 * 1024);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(buffer) % 4096, 0);
+  pool.Release(buffer, capacity);
+
+  // the same buffer comes back from the thread cache
+  uint64_t hits = pool.Hits();
+  size_t capacity2 = 0;
+  ASSERT_EQ(pool.Allocate(128 * 1024, &capacity2), buffer);
+  ASSERT_EQ(capacity2, capacity);
+  ASSERT_EQ(pool.Hits(), hits + 1);
+  pool.Release(buffer, capacity2);
+}
+
+TEST(BufferPoolTest, LargeBuffer) {
+  auto& pool = BufferPool::GetInstance();
+  size_t size = BufferPool::kMaxBufferSize + 1;
+  uint64_t misses = pool.Misses();
+  size_t capacity = 0;
+  char* buffer = pool.Allocate(size, &capacity);
+  ASSERT_EQ(capacity, size);
+  ASSERT_EQ(pool.Misses(), misses + 1);
+  std::memset(buffer, 0, size);
+  pool.Release(buffer, capacity);
+
+  // never cached
+  buffer = pool.Allocate(size, &capacity);
+  ASSERT_EQ(pool.Misses(), misses + 2);
+  pool.Release(buffer, capacity);
+}
+
+TEST(BufferPoolTest, ShareBetweenThreads) {
+  auto& pool = BufferPool::GetInstance();
+  constexpr size_t kSize = 2 * 1024 * 1024;
+
+  // more buffers than one thread can cache, the rest are shared
+  std::vector<char*> buffers;
+  std::thread producer([&]() {
+    std::vector<std::pair<char*, size_t>> allocated;
+    for (int i = 0; i < 4; i++) {
+      size_t capacity = 0;
+      allocated.emplace_back(pool.Allocate(kSize, &capacity), capacity);
+      buffers.push_back(allocated.back().first);
+    }
+    for (const auto& item : allocated) {
+      pool.Release(item.first, item.second);
+    }
+  });
+  producer.join();
+
+  uint64_t hits = pool.Hits();
+  size_t capacity = 0;
+  char* buffer = pool.Allocate(kSize, &capacity);
+  ASSERT_EQ(pool.Hits(), hits + 1);
+  ASSERT_NE(std::find(buffers.begin(), buffers.end(), buffer), buffers.end());
+  pool.Release(buffer, capacity);
+}
+
+TEST(BufferPoolTest, CachedBytes) {
+  auto& pool = BufferPool::GetInstance();
+  constexpr size_t kSize = 64 * 1024;
+
+  // the buffers cached by thread are counted, and still counted after they
+  // are given back to the shared lists on thread exit
+  uint64_t cached = 0;
+  std::thread worker([&]() {
+    std::vector<std::pair<char*, size_t>> allocated;
+    for (int i = 0; i < 4; i++) {
+      size_t capacity = 0;
+      allocated.emplace_back(pool.Allocate(kSize, &capacity), capacity);
+    }
+    cached = pool.CachedBytes();
+    for (const auto& item : allocated) {
+      pool.Release(item.first, item.second);
+    }
+    ASSERT_EQ(pool.CachedBytes(), cached + 4 * kSize);
+  });
+  worker.join();
+  ASSERT_EQ(pool.CachedBytes(), cached + 4 * kSize);
+
+  // nothing is cached beyond the limit
+  uint32_t limit = common::FLAGS_fuse_buffer_pool_max_cached_mb;
+  size_t capacity = 0;
+  char* buffer = pool.Allocate(kSize, &capacity);
+  cached = pool.CachedBytes();
+  common::FLAGS_fuse_buffer_pool_max_cached_mb = 0;
+  pool.Release(buffer, capacity);
+  ASSERT_EQ(pool.CachedBytes(), cached);
+  common::FLAGS_fuse_buffer_pool_max_cached_mb = limit;
+}
+
+TEST(BufferPoolTest, PooledBuffer) {
+  PooledBuffer buffer(10);
+  ASSERT_NE(buffer.Data(), nullptr);
+  ASSERT_EQ(buffer.Capacity(), BufferPool::kMinBufferSize);
+  std::memcpy(buffer.Data(), "0123456789", 10);
+
+  // grow and keep the content
+  buffer.Reserve(5000, 10);
+  ASSERT_EQ(buffer.Capacity(), 2 * BufferPool::kMinBufferSize);
+  ASSERT_EQ(std::memcmp(buffer.Data(), "0123456789", 10), 0);
+
+  // never shrink
+  char* data = buffer.Data();
+  buffer.Reserve(10, 10);
+  ASSERT_EQ(buffer.Data(), data);
+
+  PooledBuffer other(std::move(buffer));
+  ASSERT_EQ(buffer.Data(), nullptr);
+  ASSERT_EQ(other.Data(), data);
+  other.Reset();
+  ASSERT_EQ(other.Data(), nullptr);
+  ASSERT_EQ(other.Capacity(), 0);
+}
+
+TEST(BufferPoolTest, DirBuffer) {
+  DirBuffer dirBuffer;
+  uint64_t dindex = dirBuffer.DirBufferNew();
+  DirBufferHead* head = dirBuffer.DirBufferGet(dindex);
+  ASSERT_NE(head, nullptr);
+
+  // append entries like readdir
+  std::string expect;
+  for (int i = 0; i < 1000; i++) {
+    std::string entry = "entry" + std::to_string(i);
+    head->Reserve(head->size + entry.size());
+    std::memcpy(head->p + head->size, entry.data(), entry.size());
+    head->size += entry.size();
+    expect += entry;
+  }
+  ASSERT_EQ(std::string(head->p, head->size), expect);
+  dirBuffer.DirBufferRelease(dindex);
+  ASSERT_EQ(dirBuffer.DirBufferGet(dindex), nullptr);
+}
+
+}  // namespace client
+}  // namespace dingofs
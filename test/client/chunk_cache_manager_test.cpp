@@ -333,6 +333,78 @@ TEST_F(ChunkCacheManagerTest, test_flush) {
   delete[] buf;
 }
 
+TEST_F(ChunkCacheManagerTest, test_flush_by_pipeline) {
+  uint64_t inodeId = 1;
+  uint64_t len = 1024 * 1024;
+  std::vector<char*> bufs;
+  std::vector<std::shared_ptr<MockDataCache>> dataCaches;
+  for (int i = 0; i < 3; i++) {
+    char* buf = new char[len];
+    memset(buf, 'a' + i, len);
+    bufs.push_back(buf);
+    dataCaches.push_back(std::make_shared<MockDataCache>(
+        s3ClientAdaptor_, chunkCacheManager_, i * len, len, buf, nullptr));
+  }
+
+  // all slices are submitted before any of them is done, and the flushing
+  // ones are still readable until the flush finished
+  std::vector<std::function<void()>> dones;
+  char* readBuf = new char[3 * len];
+  std::vector<ReadRequest> requests;
+  auto submit = [&](uint64_t, std::function<void()> done) {
+    dones.push_back(done);
+    if (dones.size() == 3) {
+      chunkCacheManager_->ReadChunk(0, 0, 3 * len, readBuf, 0, &requests);
+      for (auto& d : dones) {
+        d();
+      }
+    }
+    return DINGOFS_ERROR::OK;
+  };
+  for (auto& dataCache : dataCaches) {
+    EXPECT_CALL(*dataCache, CanFlush(_)).WillOnce(Return(true));
+    EXPECT_CALL(*dataCache, FlushByPipeline(_, _)).WillOnce(Invoke(submit));
+    chunkCacheManager_->AddWriteDataCacheForTest(dataCache);
+  }
+
+  ASSERT_EQ(DINGOFS_ERROR::OK,
+            chunkCacheManager_->FlushByPipeline(inodeId, true));
+  ASSERT_EQ(3, dones.size());
+  ASSERT_EQ(0, requests.size());
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(std::string(len, 'a' + i), std::string(readBuf + i * len, len));
+  }
+  ASSERT_TRUE(chunkCacheManager_->IsEmpty());
+
+  delete[] readBuf;
+  for (auto* buf : bufs) {
+    delete[] buf;
+  }
+}
+
+TEST_F(ChunkCacheManagerTest, test_flush_by_pipeline_retry) {
+  uint64_t inodeId = 1;
+  uint64_t len = 1024 * 1024;
+  char* buf = new char[len];
+  auto dataCache = std::make_shared<MockDataCache>(
+      s3ClientAdaptor_, chunkCacheManager_, 0, len, buf, nullptr);
+  auto done = [](uint64_t, std::function<void()> done) {
+    done();
+    return DINGOFS_ERROR::OK;
+  };
+  EXPECT_CALL(*dataCache, CanFlush(_)).WillOnce(Return(true));
+  EXPECT_CALL(*dataCache, FlushByPipeline(_, _))
+      .WillOnce(Return(DINGOFS_ERROR::INTERNAL))
+      .WillOnce(Invoke(done));
+
+  chunkCacheManager_->AddWriteDataCacheForTest(dataCache);
+  ASSERT_EQ(DINGOFS_ERROR::OK,
+            chunkCacheManager_->FlushByPipeline(inodeId, true));
+  ASSERT_TRUE(chunkCacheManager_->IsEmpty());
+
+  delete[] buf;
+}
+
 TEST_F(ChunkCacheManagerTest, test_release_read_dataCache) {
   uint64_t offset = 0;
   uint64_t len = 1024 * 1024;
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/s3/chunkid_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace dingofs {
+namespace client {
+
+using ::dingofs::client::common::ChunkIdPoolOption;
+using ::dingofs::pb::mds::FSStatusCode;
+
+class ChunkIdPoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    nextId_ = 1;
+    calls_ = 0;
+    fail_ = false;
+  }
+
+  // the mds which grants continuous ids
+  ChunkIdPool::AllocFunc MdsAlloc() {
+    return [this](uint32_t idNum, uint64_t* beginId) {
+      calls_.fetch_add(1);
+      if (fail_.load()) {
+        return FSStatusCode::ALLOCATE_CHUNKID_ERROR;
+      }
+      *beginId = nextId_.fetch_add(idNum);
+      return FSStatusCode::OK;
+    };
+  }
+
+  static ChunkIdPoolOption Option(uint32_t minBundleSize,
+                                  uint32_t maxBundleSize) {
+    ChunkIdPoolOption option;
+    option.minBundleSize = minBundleSize;
+    option.maxBundleSize = maxBundleSize;
+    return option;
+  }
+
+ protected:
+  std::atomic<uint64_t> nextId_;
+  std::atomic<uint32_t> calls_;
+  std::atomic<bool> fail_;
+};
+
+TEST_F(ChunkIdPoolTest, Disabled) {
+  ChunkIdPool pool(Option(0, 0), MdsAlloc());
+  pool.Start();
+
+  uint64_t chunkId;
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(pool.Alloc(1, &chunkId), FSStatusCode::OK);
+    ASSERT_EQ(chunkId, i + 1);
+  }
+  ASSERT_EQ(calls_.load(), 10);
+}
+
+TEST_F(ChunkIdPoolTest, AllocLocally) {
+  ChunkIdPool pool(Option(16, 16), MdsAlloc());
+
+  // CASE 1: one rpc serves the whole range
+  uint64_t chunkId;
+  for (int i = 0; i < 16; i++) {
+    ASSERT_EQ(pool.Alloc(1, &chunkId), FSStatusCode::OK);
+    ASSERT_EQ(chunkId, i + 1);
+  }
+  ASSERT_EQ(calls_.load(), 1);
+
+  // CASE 2: continuous ids never span two ranges
+  ASSERT_EQ(pool.Alloc(4, &chunkId), FSStatusCode::OK);
+  ASSERT_EQ(chunkId, 17);
+  ASSERT_EQ(pool.Alloc(8, &chunkId), FSStatusCode::OK);
+  ASSERT_EQ(chunkId, 21);
+  ASSERT_EQ(pool.Alloc(8, &chunkId), FSStatusCode::OK);
+  ASSERT_EQ(chunkId, 33);
+  ASSERT_EQ(calls_.load(), 3);
+
+  // CASE 3: large request goes to mds directly
+  ASSERT_EQ(pool.Alloc(9, &chunkId), FSStatusCode::OK);
+  ASSERT_EQ(chunkId, 49);
+  ASSERT_EQ(calls_.load(), 4);
+}
+
+TEST_F(ChunkIdPoolTest, NewerThanSeen) {
+  ChunkIdPool pool(Option(16, 16), MdsAlloc());
+
+  uint64_t chunkId;
+  ASSERT_EQ(pool.Alloc(1, &chunkId), FSStatusCode::OK);
+  ASSERT_EQ(chunkId, 1);
+  nextId_ += 100;  // ranges granted to other clients
+
+  // CASE 1: skip the ids which are not newer in current range
+  ASSERT_EQ(pool.Alloc(1, &chunkId, 5), FSStatusCode::OK);
+  ASSERT_EQ(chunkId, 6);
+  ASSERT_EQ(calls_.load(), 1);
+
+  // CASE 2: current range is older than the id seen
+  ASSERT_EQ(pool.Alloc(1, &chunkId, 110), FSStatusCode::OK);
+  ASSERT_EQ(chunkId, 117);
+  ASSERT_EQ(calls_.load(), 2);
+
+  // CASE 3: the fresh range is still older, ask mds directly
+  ASSERT_EQ(pool.Alloc(1, &chunkId, 1000), FSStatusCode::OK);
+  ASSERT_EQ(chunkId, 149);
+  ASSERT_EQ(calls_.load(), 4);
+  ASSERT_EQ(pool.Alloc(1, &chunkId), FSStatusCode::OK);
+  ASSERT_EQ(chunkId, 133);
+}
+
+TEST_F(ChunkIdPoolTest, AllocFailed) {
+  ChunkIdPool pool(Option(16, 16), MdsAlloc());
+  fail_ = true;
+
+  uint64_t chunkId;
+  ASSERT_EQ(pool.Alloc(1, &chunkId), FSStatusCode::ALLOCATE_CHUNKID_ERROR);
+
+  fail_ = false;
+  ASSERT_EQ(pool.Alloc(1, &chunkId), FSStatusCode::OK);
+  ASSERT_EQ(chunkId, 1);
+}
+
+TEST_F(ChunkIdPoolTest, RefillInBackground) {
+  ChunkIdPool pool(Option(16, 16), MdsAlloc());
+  pool.Start();
+
+  uint64_t chunkId;
+  for (int i = 0; i < 12; i++) {  // below the refill watermark
+    ASSERT_EQ(pool.Alloc(1, &chunkId), FSStatusCode::OK);
+  }
+  while (calls_.load() < 2) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  // the standby range is switched in without any rpc
+  for (int i = 12; i < 32; i++) {
+    ASSERT_EQ(pool.Alloc(1, &chunkId), FSStatusCode::OK);
+    ASSERT_EQ(chunkId, i + 1);
+  }
+  pool.Stop();
+  ASSERT_LE(calls_.load(), 3);
+}
+
+TEST_F(ChunkIdPoolTest, BundleSizeFollowsRate) {
+  auto option = Option(16, 1024);
+  option.bundleLifetimeSec = 1000;
+  ChunkIdPool pool(option, MdsAlloc());
+  ASSERT_EQ(pool.BundleSize(), 16);
+
+  uint64_t chunkId;
+  for (int i = 0; i < 64; i++) {
+    ASSERT_EQ(pool.Alloc(1, &chunkId), FSStatusCode::OK);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_GT(pool.BundleSize(), 16);
+  ASSERT_LE(pool.BundleSize(), 1024);
+}
+
+TEST_F(ChunkIdPoolTest, ConcurrentAlloc) {
+  ChunkIdPool pool(Option(64, 1024), MdsAlloc());
+  pool.Start();
+
+  std::mutex mutex;
+  std::set<uint64_t> ids;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; i++) {
+    threads.emplace_back([&]() {
+      std::vector<uint64_t> local;
+      for (int j = 0; j < 1000; j++) {
+        uint64_t chunkId;
+        ASSERT_EQ(pool.Alloc(2, &chunkId), FSStatusCode::OK);
+        local.push_back(chunkId);
+        local.push_back(chunkId + 1);
+      }
+      std::lock_guard<std::mutex> lk(mutex);
+      ids.insert(local.begin(), local.end());
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  pool.Stop();
+
+  ASSERT_EQ(ids.size(), 8 * 1000 * 2);
+  ASSERT_LT(calls_.load(), 8 * 1000 / 10);
+}
+
+}  // namespace client
+}  // namespace dingofs
@@ -23,10 +23,12 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "client/kvclient/kvclient_manager.h"
@@ -133,5 +135,144 @@ TEST_F(MemCachedTest, MultiThreadTask) {
     }
   }
 }
+
+TEST_F(MemCachedTest, BatchGet) {
+  std::shared_ptr<MemCachedClient> client(new MemCachedClient());
+  ASSERT_TRUE(client->AddServer("127.0.0.1", 18080));
+  ASSERT_TRUE(client->PushServer());
+
+  std::string errorlog;
+  ASSERT_TRUE(client->Set("k1", "hello", 5, &errorlog));
+  ASSERT_TRUE(client->Set("k2", "world", 5, &errorlog));
+
+  char buf1[3], buf2[5], buf3[2], buf4[5];
+  std::vector<KVGetRange> ranges{
+      {"k1", buf1, 1, 3, false},     // ranged read
+      {"k2", buf2, 0, 5, false},     // full read
+      {"k1", buf3, 3, 2, false},     // same key with another range
+      {"nokey", buf4, 0, 5, false},  // not found
+  };
+  client->BatchGet(&ranges);
+  ASSERT_TRUE(ranges[0].res);
+  ASSERT_EQ(0, memcmp(buf1, "ell", 3));
+  ASSERT_TRUE(ranges[1].res);
+  ASSERT_EQ(0, memcmp(buf2, "world", 5));
+  ASSERT_TRUE(ranges[2].res);
+  ASSERT_EQ(0, memcmp(buf3, "lo", 2));
+  ASSERT_FALSE(ranges[3].res);
+
+  // out of value range
+  std::vector<KVGetRange> outOfRange{{"k1", buf4, 3, 5, false}};
+  client->BatchGet(&outOfRange);
+  ASSERT_FALSE(outOfRange[0].res);
+}
+
+TEST_F(MemCachedTest, SplitValue) {
+  std::shared_ptr<MemCachedClient> client(new MemCachedClient());
+  ASSERT_TRUE(client->AddServer("127.0.0.1", 18080));
+  ASSERT_TRUE(client->PushServer());
+  common::KVClientManagerOpt opt;
+  opt.setThreadPooln = 4;
+  opt.valueSplitSize = 4;
+  KVClientManager manager;
+  ASSERT_TRUE(manager.Init(opt, client));
+
+  std::string key = "split";
+  std::string value = "0123456789";
+  {
+    CountDownEvent event(1);
+    auto task = std::make_shared<SetKVCacheTask>(
+        key, value.c_str(), value.length(),
+        [&](const std::shared_ptr<SetKVCacheTask>&) { event.Signal(); });
+    manager.Set(task);
+    event.Wait();
+  }
+
+  // parts are stored under different keys
+  std::string errorlog;
+  char part[4];
+  ASSERT_TRUE(client->Get(KVClientManager::PartKey(key, 0), part, 0, 4,
+                          &errorlog));
+  ASSERT_EQ(0, memcmp(part, "0123", 4));
+  ASSERT_TRUE(client->Get(KVClientManager::PartKey(key, 2), part, 0, 2,
+                          &errorlog));
+  ASSERT_EQ(0, memcmp(part, "89", 2));
+
+  // ranged read across parts
+  char result[7];
+  CountDownEvent event(1);
+  auto task = std::make_shared<GetKVCacheTask>(key, result, 2, 7);
+  task->done = [&](const std::shared_ptr<GetKVCacheTask>&) { event.Signal(); };
+  manager.Get(task);
+  event.Wait();
+  ASSERT_TRUE(task->res);
+  ASSERT_EQ(0, memcmp(result, "2345678", 7));
+}
+
+// Concurrent gets are merged into multi-gets which never exceed the batch
+// size, and every get still receives its own value.
+TEST_F(MemCachedTest, BatchedGet) {
+  constexpr int kKeys = 256;
+  constexpr uint64_t kValueSize = 64 * 1024;
+  std::vector<std::string> keys;
+  {
+    std::shared_ptr<MemCachedClient> client(new MemCachedClient());
+    ASSERT_TRUE(client->AddServer("127.0.0.1", 18080));
+    ASSERT_TRUE(client->PushServer());
+    std::string errorlog;
+    for (int i = 0; i < kKeys; i++) {
+      keys.emplace_back(absl::StrCat("batched_", i));
+      std::string value(kValueSize, 'a' + i % 26);
+      ASSERT_TRUE(
+          client->Set(keys.back(), value.c_str(), value.size(), &errorlog));
+    }
+  }
+
+  auto run = [&](uint32_t batchMaxKeys) {
+    std::shared_ptr<MemCachedClient> client(new MemCachedClient());
+    ASSERT_TRUE(client->AddServer("127.0.0.1", 18080));
+    ASSERT_TRUE(client->PushServer());
+    common::KVClientManagerOpt opt;
+    opt.setThreadPooln = 4;
+    opt.getBatchMaxKeys = batchMaxKeys;
+    KVClientManager manager;
+    ASSERT_TRUE(manager.Init(opt, client));
+
+    std::vector<char> buffer(kKeys * kValueSize);
+    CountDownEvent event(kKeys);
+    std::vector<std::shared_ptr<GetKVCacheTask>> tasks;
+    for (int i = 0; i < kKeys; i++) {
+      auto task = std::make_shared<GetKVCacheTask>(
+          keys[i], buffer.data() + i * kValueSize, 0, kValueSize);
+      task->done = [&](const std::shared_ptr<GetKVCacheTask>&) {
+        event.Signal();
+      };
+      tasks.emplace_back(task);
+      manager.Get(task);
+    }
+    event.Wait();
+
+    for (int i = 0; i < kKeys; i++) {
+      ASSERT_TRUE(tasks[i]->res);
+      ASSERT_EQ(std::string(kValueSize, 'a' + i % 26),
+                std::string(buffer.data() + i * kValueSize, kValueSize));
+    }
+
+    auto* metric = manager.GetClientMetricForTesting();
+    uint64_t batches = metric->kvClientBatchGet.qps.count.get_value();
+    ASSERT_EQ(kKeys, metric->kvClientBatchGetKeys.get_value());
+    ASSERT_EQ(kKeys, metric->kvClientGet.qps.count.get_value());
+    ASSERT_GE(batches * std::max(batchMaxKeys, 1U), kKeys);
+    ASSERT_LE(batches, kKeys);
+    if (batchMaxKeys <= 1) {
+      ASSERT_EQ(kKeys, batches);
+    }
+  };
+
+  run(0);  // same as 1
+  run(1);
+  run(32);
+}
+
 }  // namespace client
 }  // namespace dingofs
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/filesystem/access_trace.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dingofs {
+namespace client {
+namespace filesystem {
+
+class AccessTraceTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    profile_ = "/tmp/access_trace_test_" + std::to_string(getpid());
+  }
+
+  void TearDown() override {
+    AccessTracer::GetInstance().Stop();
+    unlink(profile_.c_str());
+  }
+
+ protected:
+  std::string profile_;
+};
+
+TEST_F(AccessTraceTest, RecordAndLoad) {
+  auto& tracer = AccessTracer::GetInstance();
+  ASSERT_TRUE(tracer.StartRecord(profile_, 4096, 100));
+  ASSERT_TRUE(tracer.Enabled());
+
+  tracer.Access(100, 0, 1024);     // block 0
+  tracer.Access(100, 1024, 1024);  // block 0, merged
+  tracer.Access(100, 4000, 200);   // block 0, 1
+  tracer.Access(200, 0, 4096);     // block 0
+  tracer.Access(100, 0, 4096);     // block 0, recorded before
+  tracer.Access(100, 8192, 0);     // empty read
+  ASSERT_EQ(tracer.RecordCount(), 3);
+  tracer.Stop();
+  ASSERT_FALSE(tracer.Enabled());
+
+  std::vector<AccessRecord> records;
+  ASSERT_TRUE(AccessProfile::Load(profile_, &records));
+  ASSERT_EQ(records.size(), 3);
+  ASSERT_EQ(records[0], (AccessRecord{100, 0}));
+  ASSERT_EQ(records[1], (AccessRecord{100, 1}));
+  ASSERT_EQ(records[2], (AccessRecord{200, 0}));
+}
+
+TEST_F(AccessTraceTest, MaxRecords) {
+  auto& tracer = AccessTracer::GetInstance();
+  ASSERT_TRUE(tracer.StartRecord(profile_, 4096, 10));
+  tracer.Access(300, 0, 4096 * 100);
+  tracer.Stop();
+
+  std::vector<AccessRecord> records;
+  ASSERT_TRUE(AccessProfile::Load(profile_, &records));
+  ASSERT_EQ(records.size(), 10);
+  for (uint64_t i = 0; i < records.size(); i++) {
+    ASSERT_EQ(records[i], (AccessRecord{300, i}));
+  }
+}
+
+TEST_F(AccessTraceTest, KeepProfileIfNothingRecorded) {
+  auto& tracer = AccessTracer::GetInstance();
+  ASSERT_TRUE(tracer.StartRecord(profile_, 4096, 10));
+  tracer.Access(400, 0, 4096);
+  tracer.Stop();
+
+  ASSERT_TRUE(tracer.StartRecord(profile_, 4096, 10));
+  tracer.Stop();
+
+  std::vector<AccessRecord> records;
+  ASSERT_TRUE(AccessProfile::Load(profile_, &records));
+  ASSERT_EQ(records.size(), 1);
+}
+
+TEST_F(AccessTraceTest, Listener) {
+  auto& tracer = AccessTracer::GetInstance();
+  std::vector<AccessRecord> records;
+  tracer.SetListener(4096, [&](const AccessRecord& record) {
+    records.emplace_back(record);
+  });
+  ASSERT_TRUE(tracer.Enabled());
+
+  // run in new thread to avoid merging with accesses of other cases
+  std::thread([&]() {
+    tracer.Access(100, 0, 8192);
+    tracer.Access(100, 4096, 4096);
+    tracer.Access(100, 0, 4096);
+  }).join();
+  ASSERT_EQ(records.size(), 3);
+  ASSERT_EQ(records[2], (AccessRecord{100, 0}));
+
+  tracer.SetListener(0, nullptr);
+  ASSERT_FALSE(tracer.Enabled());
+}
+
+TEST_F(AccessTraceTest, LoadInvalidProfile) {
+  std::vector<AccessRecord> records;
+  ASSERT_FALSE(AccessProfile::Load(profile_, &records));
+
+  FILE* file = fopen(profile_.c_str(), "w");
+  ASSERT_NE(file, nullptr);
+  fputs("not a profile", file);
+  fclose(file);
+  ASSERT_FALSE(AccessProfile::Load(profile_, &records));
+}
+
+}  // namespace filesystem
+}  // namespace client
+}  // namespace dingofs
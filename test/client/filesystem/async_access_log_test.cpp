@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/filesystem/async_access_log.h"
+
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/filesystem/access_log.h"
+
+namespace dingofs {
+namespace client {
+namespace filesystem {
+
+namespace {
+
+AccessLogRecord NewRecord(AccessOp op, uint64_t ino, uint64_t offset) {
+  AccessLogRecord record{};
+  record.timestamp_us = offset;
+  record.ino = ino;
+  record.offset = offset;
+  record.length = 4096;
+  record.latency_us = 120;
+  record.status = 0;
+  record.op = static_cast<uint8_t>(op);
+  return record;
+}
+
+}  // namespace
+
+class AsyncAccessLoggerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::string tmpl = ::testing::TempDir() + "access_log_test_XXXXXX";
+    ASSERT_NE(mkdtemp(&tmpl[0]), nullptr);
+    dir_ = tmpl;
+  }
+
+  void TearDown() override {
+    for (const auto& path : files_) {
+      unlink(path.c_str());
+    }
+    rmdir(dir_.c_str());
+  }
+
+  // the file under the test directory which removed after test
+  std::string TestFile(const std::string& name) {
+    files_.push_back(dir_ + "/" + name);
+    return files_.back();
+  }
+
+  std::string BinaryLogPath() {
+    return TestFile("access_" + std::to_string(getpid()) + ".bin");
+  }
+
+  std::string dir_;
+  std::vector<std::string> files_;
+};
+
+TEST(AccessLogRingTest, PushAndPop) {
+  AccessLogRing ring(3);  // round up to 4
+  for (uint64_t i = 0; i < 4; i++) {
+    ASSERT_TRUE(ring.Push(NewRecord(AccessOp::kRead, 1, i)));
+  }
+  ASSERT_FALSE(ring.Push(NewRecord(AccessOp::kRead, 1, 4)));
+
+  std::vector<AccessLogRecord> records;
+  ASSERT_EQ(ring.Pop(&records), 4);
+  ASSERT_TRUE(ring.Empty());
+  for (uint64_t i = 0; i < 4; i++) {
+    ASSERT_EQ(records[i].offset, i);
+  }
+
+  ASSERT_TRUE(ring.Push(NewRecord(AccessOp::kWrite, 2, 5)));
+  ASSERT_EQ(ring.Pop(&records), 1);
+  ASSERT_EQ(records.back().ino, 2);
+}
+
+TEST(AccessLogRecordTest, Format) {
+  auto record = NewRecord(AccessOp::kRead, 100, 0);
+  ASSERT_EQ(StrAccessLogRecord(record), "read (100,0,4096): OK <0.000120>");
+  ASSERT_STREQ(StrAccessOp(AccessOp::kMax), "unknown");
+}
+
+TEST_F(AsyncAccessLoggerTest, BinaryLog) {
+  auto path = BinaryLogPath();
+  auto& logger = AsyncAccessLogger::GetInstance();
+  ASSERT_TRUE(logger.Start(dir_, true, 1 << 16));
+  ASSERT_TRUE(logger.Running());
+  ASSERT_EQ(logger.Path(), path);
+
+  // appended from the exited threads
+  auto dropped = logger.Dropped();
+  std::vector<std::thread> threads;
+  for (uint64_t ino = 1; ino <= 4; ino++) {
+    threads.emplace_back([&logger, ino]() {
+      for (uint64_t i = 0; i < 1000; i++) {
+        logger.Append(NewRecord(AccessOp::kRead, ino, i));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  logger.Stop();
+  ASSERT_FALSE(logger.Running());
+
+  std::map<uint64_t, uint64_t> next_offset;
+  uint64_t count = 0;
+  ASSERT_TRUE(AccessLogReader::ReadAll(path, [&](const AccessLogRecord& r) {
+    ASSERT_EQ(AccessOp(r.op), AccessOp::kRead);
+    ASSERT_EQ(r.offset, next_offset[r.ino]++);  // in order per thread
+    count++;
+  }));
+  ASSERT_EQ(count + logger.Dropped() - dropped, 4000);
+}
+
+TEST_F(AsyncAccessLoggerTest, ReadInvalidLog) {
+  auto path = TestFile("invalid.bin");
+  FILE* file = fopen(path.c_str(), "w");
+  ASSERT_NE(file, nullptr);
+  fputs("not an access log", file);
+  fclose(file);
+  ASSERT_FALSE(AccessLogReader::ReadAll(path, [](const AccessLogRecord&) {}));
+}
+
+TEST_F(AsyncAccessLoggerTest, GuardRecordsActualLength) {
+  common::FLAGS_access_logging = true;
+  auto path = BinaryLogPath();
+  auto& logger = AsyncAccessLogger::GetInstance();
+  ASSERT_TRUE(logger.Start(dir_, true, 1 << 10));
+
+  {  // short read
+    DINGOFS_ERROR rc;
+    size_t r_size = 0;
+    AccessLogGuard log(AccessOp::kRead, 1, 0, &r_size, &rc,
+                       []() { return ""; });
+    rc = DINGOFS_ERROR::OK;
+    r_size = 100;
+  }
+  {  // failed read, the size is not filled
+    DINGOFS_ERROR rc;
+    size_t r_size = 4096;
+    AccessLogGuard log(AccessOp::kRead, 2, 0, &r_size, &rc,
+                       []() { return ""; });
+    rc = DINGOFS_ERROR::INTERNAL;
+  }
+  logger.Stop();
+
+  std::vector<AccessLogRecord> records;
+  ASSERT_TRUE(AccessLogReader::ReadAll(
+      path, [&](const AccessLogRecord& r) { records.push_back(r); }));
+  ASSERT_EQ(records.size(), 2);
+  ASSERT_EQ(records[0].ino, 1);
+  ASSERT_EQ(records[0].length, 100);
+  ASSERT_EQ(records[1].ino, 2);
+  ASSERT_EQ(records[1].length, 0);
+}
+
+TEST_F(AsyncAccessLoggerTest, NoDropWithinRingCapacity) {
+  auto path = BinaryLogPath();
+  auto& logger = AsyncAccessLogger::GetInstance();
+  uint64_t n = 100000;
+  ASSERT_TRUE(logger.Start(dir_, true, n));
+
+  // appended from a new thread, which gets a ring with the given capacity
+  auto dropped = logger.Dropped();
+  std::thread thread([&logger, n]() {
+    auto record = NewRecord(AccessOp::kGetAttr, 1, 0);
+    for (uint64_t i = 0; i < n; i++) {
+      record.offset = i;
+      logger.Append(record);
+    }
+  });
+  thread.join();
+  logger.Stop();
+  ASSERT_EQ(logger.Dropped(), dropped);
+
+  uint64_t count = 0;
+  ASSERT_TRUE(AccessLogReader::ReadAll(path, [&](const AccessLogRecord& r) {
+    ASSERT_EQ(r.offset, count++);
+  }));
+  ASSERT_EQ(count, n);
+
+  // header (magic, version and record size) and the records
+  struct stat st;
+  ASSERT_EQ(stat(path.c_str(), &st), 0);
+  ASSERT_EQ(static_cast<uint64_t>(st.st_size),
+            16 + n * sizeof(AccessLogRecord));
+}
+
+}  // namespace filesystem
+}  // namespace client
+}  // namespace dingofs
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/filesystem/dentry_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "client/filesystem/helper/helper.h"
+
+namespace dingofs {
+namespace client {
+namespace filesystem {
+
+using ::dingofs::client::common::DentryCacheOption;
+
+class DentryCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    cache_ = std::make_shared<DentryCache>(
+        DentryCacheOption{lruSize : 100, timeoutSec : 3600});
+  }
+
+  static InodeAttr DirAttr(Ino ino, uint64_t mtime) {
+    return MkAttr(
+        ino, AttrOption().type(FsFileType::TYPE_DIRECTORY).mtime(mtime, 0));
+  }
+
+  // lookup under |parent| and cache the result
+  bool Lookup(Ino parent, const std::string& name, Ino ino) {
+    DentryCache::Token token;
+    return cache_->Begin(parent, &token) && cache_->Put(token, name, ino);
+  }
+
+  std::shared_ptr<DentryCache> cache_;
+};
+
+TEST_F(DentryCacheTest, Disabled) {
+  cache_ = std::make_shared<DentryCache>(
+      DentryCacheOption{lruSize : 100, timeoutSec : 0});
+  cache_->Observe(DirAttr(1, 1));
+  ASSERT_FALSE(Lookup(1, "f1", 100));
+
+  Ino ino;
+  ASSERT_FALSE(cache_->Get(1, "f1", &ino));
+}
+
+TEST_F(DentryCacheTest, ParentUnknown) {
+  ASSERT_FALSE(Lookup(1, "f1", 100));
+
+  cache_->Observe(MkAttr(1, AttrOption().type(FsFileType::TYPE_S3)));
+  ASSERT_FALSE(Lookup(1, "f1", 100));
+}
+
+TEST_F(DentryCacheTest, PositiveAndNegative) {
+  cache_->Observe(DirAttr(1, 1));
+  ASSERT_TRUE(Lookup(1, "f1", 100));
+  ASSERT_TRUE(Lookup(1, "f2", 0));
+
+  Ino ino;
+  ASSERT_TRUE(cache_->Get(1, "f1", &ino));
+  ASSERT_EQ(ino, 100);
+  ASSERT_TRUE(cache_->Get(1, "f2", &ino));
+  ASSERT_EQ(ino, 0);
+  ASSERT_FALSE(cache_->Get(1, "f3", &ino));
+
+  cache_->Delete(1, "f1");
+  ASSERT_FALSE(cache_->Get(1, "f1", &ino));
+}
+
+TEST_F(DentryCacheTest, ChangedRemotely) {
+  cache_->Observe(DirAttr(1, 1));
+  ASSERT_TRUE(Lookup(1, "f1", 100));
+
+  // same version
+  Ino ino;
+  cache_->Observe(DirAttr(1, 1));
+  ASSERT_TRUE(cache_->Get(1, "f1", &ino));
+
+  cache_->Observe(DirAttr(1, 2));
+  ASSERT_FALSE(cache_->Get(1, "f1", &ino));
+}
+
+TEST_F(DentryCacheTest, ChangedByOurselves) {
+  cache_->Observe(DirAttr(1, 1));
+  ASSERT_TRUE(Lookup(1, "f1", 100));
+  ASSERT_TRUE(Lookup(1, "f2", 0));
+
+  // create f2
+  cache_->Modify(1, "f2", DirAttr(1, 1), DirAttr(1, 2));
+  Ino ino;
+  ASSERT_TRUE(cache_->Get(1, "f1", &ino));
+  ASSERT_FALSE(cache_->Get(1, "f2", &ino));
+
+  // the version replied by metaserver is the one we changed to
+  cache_->Observe(DirAttr(1, 2));
+  ASSERT_TRUE(cache_->Get(1, "f1", &ino));
+
+  // changed remotely before our change
+  cache_->Modify(1, "f3", DirAttr(1, 3), DirAttr(1, 4));
+  ASSERT_FALSE(cache_->Get(1, "f1", &ino));
+}
+
+TEST_F(DentryCacheTest, ChangedDuringLookup) {
+  cache_->Observe(DirAttr(1, 1));
+
+  DentryCache::Token token;
+  ASSERT_TRUE(cache_->Begin(1, &token));
+  cache_->Modify(1, "f1", DirAttr(1, 1), DirAttr(1, 2));
+  ASSERT_FALSE(cache_->Put(token, "f1", 0));
+
+  ASSERT_TRUE(cache_->Begin(1, &token));
+  cache_->Drop(1);
+  ASSERT_FALSE(cache_->Put(token, "f1", 0));
+
+  cache_->Observe(DirAttr(1, 2));
+  ASSERT_FALSE(cache_->Put(token, "f1", 0));
+}
+
+TEST_F(DentryCacheTest, Timeout) {
+  cache_ = std::make_shared<DentryCache>(
+      DentryCacheOption{lruSize : 100, timeoutSec : 1});
+  cache_->Observe(DirAttr(1, 1));
+  ASSERT_TRUE(Lookup(1, "f1", 100));
+
+  Ino ino;
+  ASSERT_TRUE(cache_->Get(1, "f1", &ino));
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  ASSERT_FALSE(cache_->Get(1, "f1", &ino));
+}
+
+}  // namespace filesystem
+}  // namespace client
+}  // namespace dingofs
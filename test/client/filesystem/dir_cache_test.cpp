@@ -22,6 +22,10 @@
 
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_format.h"
 #include "client/filesystem/utils.h"
 #include "client/filesystem/helper/helper.h"
 
@@ -208,6 +212,120 @@ TEST_F(DirEntryListTest, Mtime) {
   ASSERT_EQ(time, TimeSpec(123, 456));
 }
 
+TEST_F(DirEntryListTest, PackedAttr) {
+  DirEntryList entries;
+  InodeAttr attr = MkAttr(100, AttrOption()
+                                   .type(FsFileType::TYPE_SYM_LINK)
+                                   .mode(41471)
+                                   .nlink(1)
+                                   .uid(1000)
+                                   .gid(1001)
+                                   .length(4)
+                                   .rdev(2048)
+                                   .atime(100, 101)
+                                   .mtime(200, 201)
+                                   .ctime(300, 301));
+  entries.Add(MkDirEntry(100, "link", attr));
+  entries.Add(MkDirEntry(200, ""));
+  entries.Add(MkDirEntry(300, std::string(255, 'x')));
+
+  DirEntry dirEntry;
+  ASSERT_TRUE(entries.Get(100, &dirEntry));
+  ASSERT_EQ(dirEntry.name, "link");
+  ASSERT_EQ(dirEntry.attr.type(), FsFileType::TYPE_SYM_LINK);
+  ASSERT_EQ(dirEntry.attr.mode(), 41471);
+  ASSERT_EQ(dirEntry.attr.nlink(), 1);
+  ASSERT_EQ(dirEntry.attr.uid(), 1000);
+  ASSERT_EQ(dirEntry.attr.gid(), 1001);
+  ASSERT_EQ(dirEntry.attr.length(), 4);
+  ASSERT_EQ(dirEntry.attr.rdev(), 2048);
+  ASSERT_EQ(dirEntry.attr.atime(), 100);
+  ASSERT_EQ(dirEntry.attr.atime_ns(), 101);
+  ASSERT_EQ(AttrMtime(dirEntry.attr), TimeSpec(200, 201));
+  ASSERT_EQ(AttrCtime(dirEntry.attr), TimeSpec(300, 301));
+
+  ASSERT_TRUE(entries.Get(200, &dirEntry));
+  ASSERT_EQ(dirEntry.name, "");
+  ASSERT_TRUE(entries.Get(300, &dirEntry));
+  ASSERT_EQ(dirEntry.name, std::string(255, 'x'));
+}
+
+TEST_F(DirEntryListTest, Bytes) {
+  DirEntryList entries;
+  size_t empty = entries.Bytes();
+
+  entries.Reserve(1000, 1000 * 8);
+  size_t reserved = entries.Bytes();
+  ASSERT_GT(reserved, empty + 1000 * 8);
+
+  for (Ino ino = 1; ino <= 1000; ino++) {
+    entries.Add(MkDirEntry(ino, absl::StrFormat("%08d", ino)));
+  }
+  ASSERT_EQ(entries.Bytes(), reserved);
+
+  entries.Clear();
+  ASSERT_EQ(entries.Bytes(), empty);
+}
+
+std::shared_ptr<DirEntryList> MkDirEntryList(size_t n) {
+  auto entries = std::make_shared<DirEntryList>();
+  entries->Reserve(n, n * 8);
+  for (Ino ino = 1; ino <= n; ino++) {
+    entries->Add(MkDirEntry(ino, absl::StrFormat("%08d", ino)));
+  }
+  return entries;
+}
+
+TEST_F(DirCacheTest, EvitByEntries) {
+  DirCache cache(DirCacheOption{
+    lruSize : 5,
+    timeoutSec : 0,
+    capacityMB : 1024,
+  });
+  cache.Start();
+
+  std::shared_ptr<DirEntryList> entries;
+  cache.Put(1, MkDirEntryList(2));
+  cache.Put(2, MkDirEntryList(2));
+  ASSERT_TRUE(cache.Get(1, &entries));
+  ASSERT_TRUE(cache.Get(2, &entries));
+
+  cache.Put(3, MkDirEntryList(2));  // evit the least recently used one
+  ASSERT_FALSE(cache.Get(1, &entries));
+  ASSERT_TRUE(cache.Get(2, &entries));
+  ASSERT_TRUE(cache.Get(3, &entries));
+  cache.Stop();
+}
+
+TEST_F(DirCacheTest, EvitByBytes) {
+  DirCache cache(DirCacheOption{
+    lruSize : 5000000,
+    timeoutSec : 0,
+    capacityMB : 1,
+  });
+  cache.Start();
+
+  // two lists fit in the capacity, three don't
+  auto entries = MkDirEntryList(3500);
+  ASSERT_GT(entries->Bytes(), 1024 * 1024 / 3);
+  ASSERT_LT(entries->Bytes(), 1024 * 1024 / 2);
+
+  cache.Put(1, entries);
+  cache.Put(2, MkDirEntryList(3500));
+  cache.Put(3, MkDirEntryList(3500));
+  ASSERT_TRUE(cache.Get(2, &entries));
+  ASSERT_TRUE(cache.Get(3, &entries));
+  ASSERT_FALSE(cache.Get(1, &entries));
+
+  // drop and put again
+  cache.Drop(2);
+  ASSERT_FALSE(cache.Get(2, &entries));
+  cache.Put(2, MkDirEntryList(3500));
+  ASSERT_TRUE(cache.Get(2, &entries));
+  ASSERT_TRUE(cache.Get(3, &entries));
+  cache.Stop();
+}
+
 }  // namespace filesystem
 }  // namespace client
 }  // namespace dingofs
@@ -25,6 +25,8 @@
 
 #include <gtest/gtest.h>
 
+#include <map>
+
 #include "client/filesystem/helper/helper.h"
 
 namespace dingofs {
@@ -212,6 +214,156 @@ TEST_F(FileSystemTest, Lookup_NegativeCache) {
   ASSERT_EQ(rc, DINGOFS_ERROR::NOTEXIST);
 }
 
+TEST_F(FileSystemTest, Lookup_DentryCache) {
+  auto builder = FileSystemBuilder();
+  auto fs = builder
+                .SetOption([](FileSystemOption* option) {
+                  option->dentryCacheOption.timeoutSec = 3600;
+                })
+                .Build();
+
+  // learn the version of parent
+  EXPECT_CALL_INVOKE_GetInodeAttr(
+      *builder.GetInodeManager(),
+      [&](uint64_t ino, InodeAttr* attr) -> DINGOFS_ERROR {
+        *attr = MkAttr(ino, AttrOption()
+                                .type(FsFileType::TYPE_DIRECTORY)
+                                .mtime(123, 0));
+        return DINGOFS_ERROR::OK;
+      });
+  AttrOut attrOut;
+  auto rc = fs->GetAttr(Request(), 1, &attrOut);
+  ASSERT_EQ(rc, DINGOFS_ERROR::OK);
+
+  // CASE 1: negative entry is cached
+  EXPECT_CALL_RETURN_GetDentry(*builder.GetDentryManager(),
+                               DINGOFS_ERROR::NOTEXIST);
+  EntryOut entryOut;
+  rc = fs->Lookup(Request(), 1, "f1", &entryOut);
+  ASSERT_EQ(rc, DINGOFS_ERROR::NOTEXIST);
+  rc = fs->Lookup(Request(), 1, "f1", &entryOut);
+  ASSERT_EQ(rc, DINGOFS_ERROR::NOTEXIST);
+
+  // CASE 2: created by ourselves
+  auto before = MkAttr(1, AttrOption()
+                              .type(FsFileType::TYPE_DIRECTORY)
+                              .mtime(123, 0));
+  auto after = MkAttr(1, AttrOption()
+                             .type(FsFileType::TYPE_DIRECTORY)
+                             .mtime(124, 0));
+  fs->InvalidateDentry(1, "f1", before, after);
+
+  EXPECT_CALL(*builder.GetDentryManager(), GetDentry(1, "f1", _))
+      .WillOnce(Invoke([&](uint64_t parent, const std::string& name,
+                           pb::metaserver::Dentry* dentry) {
+        dentry->set_inodeid(100);
+        return DINGOFS_ERROR::OK;
+      }));
+  EXPECT_CALL(*builder.GetInodeManager(), GetInodeAttr(100, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](uint64_t ino, InodeAttr* attr) {
+        *attr = MkAttr(ino, AttrOption().nlink(1));
+        return DINGOFS_ERROR::OK;
+      }));
+  rc = fs->Lookup(Request(), 1, "f1", &entryOut);
+  ASSERT_EQ(rc, DINGOFS_ERROR::OK);
+
+  // CASE 3: positive entry is cached, only the attribute is fetched
+  rc = fs->Lookup(Request(), 1, "f1", &entryOut);
+  ASSERT_EQ(rc, DINGOFS_ERROR::OK);
+  ASSERT_EQ(entryOut.attr.inodeid(), 100);
+}
+
+TEST_F(FileSystemTest, Lookup_DentryCacheSavedRPC) {
+  auto builder = FileSystemBuilder();
+  auto fs = builder
+                .SetOption([](FileSystemOption* option) {
+                  option->dentryCacheOption.timeoutSec = 3600;
+                })
+                .Build();
+
+  EXPECT_CALL(*builder.GetInodeManager(), GetInodeAttr(_, _))
+      .WillRepeatedly(Invoke([&](uint64_t ino, InodeAttr* attr) {
+        if (ino == 1) {
+          *attr = MkAttr(ino, AttrOption()
+                                  .type(FsFileType::TYPE_DIRECTORY)
+                                  .mtime(123, 0));
+        } else {
+          *attr = MkAttr(ino, AttrOption().nlink(1));
+        }
+        return DINGOFS_ERROR::OK;
+      }));
+  std::map<std::string, uint64_t> dentries{{"a", 100}, {"b", 101}, {"c", 102}};
+  int rpcCount = 0;
+  EXPECT_CALL(*builder.GetDentryManager(), GetDentry(1, _, _))
+      .WillRepeatedly(Invoke([&](uint64_t parent, const std::string& name,
+                                 pb::metaserver::Dentry* dentry) {
+        rpcCount++;
+        auto iter = dentries.find(name);
+        if (iter == dentries.end()) {
+          return DINGOFS_ERROR::NOTEXIST;
+        }
+        dentry->set_inodeid(iter->second);
+        return DINGOFS_ERROR::OK;
+      }));
+
+  // learn the version of parent
+  AttrOut attrOut;
+  auto rc = fs->GetAttr(Request(), 1, &attrOut);
+  ASSERT_EQ(rc, DINGOFS_ERROR::OK);
+
+  // e.g. searching the modules in python path
+  std::vector<std::string> names{"a", "b", "a", "x", "a",
+                                 "b", "x", "c", "x", "c"};
+  EntryOut entryOut;
+  for (const auto& name : names) {
+    rc = fs->Lookup(Request(), 1, name, &entryOut);
+    auto iter = dentries.find(name);
+    if (iter == dentries.end()) {
+      ASSERT_EQ(rc, DINGOFS_ERROR::NOTEXIST);
+    } else {
+      ASSERT_EQ(rc, DINGOFS_ERROR::OK);
+      ASSERT_EQ(entryOut.attr.inodeid(), iter->second);
+    }
+  }
+
+  // only the first lookup of every name goes to metaserver
+  ASSERT_EQ(rpcCount, 4);
+}
+
+TEST_F(FileSystemTest, Lookup_DentryCacheWithoutInvalidation) {
+  auto builder = FileSystemBuilder();
+  auto fs = builder
+                .SetOption([](FileSystemOption* option) {
+                  option->kernelCacheOption.entryTimeoutSec = 0;
+                  option->kernelCacheOption.activeInvalidate = false;
+                  option->dentryCacheOption.timeoutSec = 3600;
+                })
+                .Build();
+
+  EXPECT_CALL_INVOKE_GetInodeAttr(
+      *builder.GetInodeManager(),
+      [&](uint64_t ino, InodeAttr* attr) -> DINGOFS_ERROR {
+        *attr = MkAttr(ino, AttrOption()
+                                .type(FsFileType::TYPE_DIRECTORY)
+                                .mtime(123, 0));
+        return DINGOFS_ERROR::OK;
+      });
+  AttrOut attrOut;
+  auto rc = fs->GetAttr(Request(), 1, &attrOut);
+  ASSERT_EQ(rc, DINGOFS_ERROR::OK);
+
+  // the timeout is limited to the kernel entry timeout, nothing is cached
+  EXPECT_CALL(*builder.GetDentryManager(), GetDentry(1, "f1", _))
+      .Times(2)
+      .WillRepeatedly(Return(DINGOFS_ERROR::NOTEXIST));
+  EntryOut entryOut;
+  rc = fs->Lookup(Request(), 1, "f1", &entryOut);
+  ASSERT_EQ(rc, DINGOFS_ERROR::NOTEXIST);
+  rc = fs->Lookup(Request(), 1, "f1", &entryOut);
+  ASSERT_EQ(rc, DINGOFS_ERROR::NOTEXIST);
+}
+
 TEST_F(FileSystemTest, GetAttr_Basic) {
   auto builder = FileSystemBuilder();
   auto fs = builder.Build();
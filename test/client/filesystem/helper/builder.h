@@ -41,6 +41,7 @@ namespace filesystem {
 
 using dingofs::client::common::AttrWatcherOption;
 using dingofs::client::common::DeferSyncOption;
+using dingofs::client::common::DentryCacheOption;
 using dingofs::client::common::DirCacheOption;
 using dingofs::client::common::FileSystemOption;
 using dingofs::client::common::KernelCacheOption;
@@ -100,6 +101,8 @@ class DirCacheBuilder {
   static DirCacheOption DefaultOption() {
     return DirCacheOption{
       lruSize : 5000000,
+      timeoutSec : 0,
+      capacityMB : 1024,
     };
   }
 
@@ -206,6 +209,10 @@ class FileSystemBuilder {
       lruSize : 100000,
       negativeTimeoutSec : 0,
     };
+    auto dentryCacheOption = DentryCacheOption{
+      lruSize : 100000,
+      timeoutSec : 0,
+    };
     auto attrWatcherOption = AttrWatcherOption{
       lruSize : 5000000,
     };
@@ -216,6 +223,7 @@ class FileSystemBuilder {
     option.blockSize = 0x10000u;
     option.kernelCacheOption = kernelCacheOption;
     option.lookupCacheOption = lookupCacheOption;
+    option.dentryCacheOption = dentryCacheOption;
     option.dirCacheOption = DirCacheBuilder::DefaultOption();
     option.openFilesOption = OpenFilesBuilder::DefaultOption();
     option.attrWatcherOption = attrWatcherOption;
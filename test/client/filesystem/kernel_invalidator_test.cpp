@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "client/filesystem/kernel_invalidator.h"
+
+#include <set>
+#include <string>
+#include <utility>
+
+#include "client/filesystem/helper/helper.h"
+#include "client/mock_inode_cache_manager.h"
+#include "gmock/gmock.h"
+
+namespace dingofs {
+namespace client {
+namespace filesystem {
+
+using ::dingofs::client::common::KernelCacheOption;
+using ::dingofs::common::ChangeRecord;
+using ::dingofs::common::ChangeType;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+class RecordNotifier : public KernelNotifier {
+ public:
+  void InvalidateInode(Ino ino) override { inodes.insert(ino); }
+
+  void InvalidateEntry(Ino parent, const std::string& name) override {
+    entries.insert(std::make_pair(parent, name));
+  }
+
+  std::set<Ino> inodes;
+  std::set<std::pair<Ino, std::string>> entries;
+};
+
+class KernelInvalidatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    option_.invalidateTimeoutSec = 3600;
+    option_.invalidateIntervalMs = 3600 * 1000;  // poll by test
+    option_.invalidateBatchSize = 100;
+    option_.invalidateWatchSize = 100;
+    inodeManager_ = std::make_shared<MockInodeCacheManager>();
+    notifier_ = std::make_shared<RecordNotifier>();
+  }
+
+  std::shared_ptr<KernelInvalidator> Build() {
+    auto invalidator = std::make_shared<KernelInvalidator>(
+        option_, inodeManager_, nullptr, nullptr, nullptr);
+    invalidator->Start(notifier_);
+    return invalidator;
+  }
+
+  // the inodes not in |attrs| are deleted, the batch fails as the
+  // metaserver does if any of them is requested
+  void ExpectPoll(const std::vector<InodeAttr>& attrs) {
+    EXPECT_CALL(*inodeManager_, BatchGetInodeAttr(_, _))
+        .WillRepeatedly(Invoke([attrs](std::set<uint64_t>* inos,
+                                       std::list<InodeAttr>* out) {
+          std::list<InodeAttr> found;
+          for (const auto& attr : attrs) {
+            if (inos->count(attr.inodeid()) != 0) {
+              found.push_back(attr);
+            }
+          }
+          if (found.size() != inos->size()) {
+            return DINGOFS_ERROR::NOTEXIST;
+          }
+          out->splice(out->end(), found);
+          return DINGOFS_ERROR::OK;
+        }));
+  }
+
+  static InodeAttr DirAttr(Ino ino, uint64_t mtime) {
+    return MkAttr(ino, AttrOption()
+                           .type(FsFileType::TYPE_DIRECTORY)
+                           .mtime(mtime, 0)
+                           .nlink(2));
+  }
+
+  static InodeAttr FileAttr(Ino ino, uint64_t length) {
+    return MkAttr(
+        ino, AttrOption().type(FsFileType::TYPE_S3).length(length).nlink(1));
+  }
+
+  KernelCacheOption option_;
+  std::shared_ptr<MockInodeCacheManager> inodeManager_;
+  std::shared_ptr<RecordNotifier> notifier_;
+};
+
+TEST_F(KernelInvalidatorTest, WatchEntry) {
+  auto invalidator = Build();
+
+  // parent not watched
+  ASSERT_FALSE(invalidator->WatchEntry(1, "f1", FileAttr(100, 0)));
+  ASSERT_TRUE(invalidator->IsWatched(100));
+
+  invalidator->Watch(DirAttr(1, 1));
+  ASSERT_TRUE(invalidator->WatchEntry(1, "f1", FileAttr(100, 0)));
+  ASSERT_EQ(invalidator->Size(), 2);
+  invalidator->Stop();
+}
+
+TEST_F(KernelInvalidatorTest, Unchanged) {
+  auto invalidator = Build();
+  invalidator->Watch(DirAttr(1, 1));
+  invalidator->WatchEntry(1, "f1", FileAttr(100, 0));
+
+  ExpectPoll({DirAttr(1, 1), FileAttr(100, 0)});
+  ASSERT_EQ(invalidator->CheckOnce(), 0);
+  ASSERT_TRUE(notifier_->inodes.empty());
+  ASSERT_TRUE(notifier_->entries.empty());
+  invalidator->Stop();
+}
+
+TEST_F(KernelInvalidatorTest, DirChanged) {
+  auto invalidator = Build();
+  invalidator->Watch(DirAttr(1, 1));
+  invalidator->WatchEntry(1, "f1", FileAttr(100, 0));
+  invalidator->WatchEntry(1, "f2", FileAttr(200, 0));
+
+  ExpectPoll({DirAttr(1, 2), FileAttr(100, 0), FileAttr(200, 0)});
+  ASSERT_EQ(invalidator->CheckOnce(), 3);
+  ASSERT_EQ(notifier_->inodes, std::set<Ino>({1}));
+  ASSERT_EQ(notifier_->entries.size(), 2);
+  ASSERT_EQ(notifier_->entries.count(std::make_pair(Ino(1), "f1")), 1);
+  ASSERT_EQ(notifier_->entries.count(std::make_pair(Ino(1), "f2")), 1);
+
+  // the names are forgotten after invalidated
+  ExpectPoll({DirAttr(1, 3), FileAttr(100, 0), FileAttr(200, 0)});
+  ASSERT_EQ(invalidator->CheckOnce(), 1);
+  invalidator->Stop();
+}
+
+TEST_F(KernelInvalidatorTest, FileChanged) {
+  auto invalidator = Build();
+  invalidator->Watch(FileAttr(100, 0));
+
+  ExpectPoll({FileAttr(100, 4096)});
+  ASSERT_EQ(invalidator->CheckOnce(), 1);
+  ASSERT_EQ(notifier_->inodes, std::set<Ino>({100}));
+  ASSERT_TRUE(invalidator->IsWatched(100));
+  invalidator->Stop();
+}
+
+TEST_F(KernelInvalidatorTest, Deleted) {
+  auto invalidator = Build();
+  invalidator->Watch(DirAttr(1, 1));
+  invalidator->WatchEntry(1, "f1", FileAttr(100, 0));
+
+  ExpectPoll({DirAttr(1, 1)});
+  ASSERT_EQ(invalidator->CheckOnce(), 1);
+  ASSERT_EQ(notifier_->inodes, std::set<Ino>({100}));
+  ASSERT_FALSE(invalidator->IsWatched(100));
+  invalidator->Stop();
+}
+
+TEST_F(KernelInvalidatorTest, DeletedInBatch) {
+  auto invalidator = Build();
+  invalidator->Watch(DirAttr(1, 1));
+  invalidator->WatchEntry(1, "f1", FileAttr(100, 0));
+  invalidator->WatchEntry(1, "f2", FileAttr(200, 0));
+  invalidator->WatchEntry(1, "f3", FileAttr(300, 0));
+
+  // the others in the failed batch are still checked
+  ExpectPoll({DirAttr(1, 2), FileAttr(100, 0), FileAttr(300, 1)});
+  ASSERT_EQ(invalidator->CheckOnce(), 6);
+  ASSERT_EQ(notifier_->inodes, std::set<Ino>({1, 200, 300}));
+  ASSERT_EQ(notifier_->entries.size(), 3);
+  ASSERT_FALSE(invalidator->IsWatched(200));
+  ASSERT_EQ(invalidator->Size(), 3);
+
+  // the deleted one is not polled anymore
+  EXPECT_CALL(*inodeManager_, BatchGetInodeAttr(_, _))
+      .WillOnce(Invoke([](std::set<uint64_t>* inos,
+                          std::list<InodeAttr>* out) {
+        EXPECT_EQ(*inos, std::set<uint64_t>({1, 100, 300}));
+        out->push_back(DirAttr(1, 2));
+        out->push_back(FileAttr(100, 0));
+        out->push_back(FileAttr(300, 1));
+        return DINGOFS_ERROR::OK;
+      }));
+  ASSERT_EQ(invalidator->CheckOnce(), 0);
+  invalidator->Stop();
+}
+
+TEST_F(KernelInvalidatorTest, PollFailed) {
+  auto invalidator = Build();
+  invalidator->Watch(FileAttr(100, 0));
+
+  EXPECT_CALL(*inodeManager_, BatchGetInodeAttr(_, _))
+      .WillOnce(Return(DINGOFS_ERROR::INTERNAL));
+  ASSERT_EQ(invalidator->CheckOnce(), 0);
+  ASSERT_TRUE(invalidator->IsWatched(100));
+  invalidator->Stop();
+}
+
+TEST_F(KernelInvalidatorTest, Evict) {
+  option_.invalidateWatchSize = 2;
+  auto invalidator = Build();
+  invalidator->Watch(DirAttr(1, 1));
+  invalidator->WatchEntry(1, "f1", FileAttr(100, 0));
+  invalidator->WatchEntry(1, "f2", FileAttr(200, 0));  // evict dir 1
+  ASSERT_FALSE(invalidator->IsWatched(1));
+  ASSERT_EQ(invalidator->Size(), 2);
+
+  ExpectPoll({FileAttr(100, 0), FileAttr(200, 0)});
+  ASSERT_EQ(invalidator->CheckOnce(), 2);
+  ASSERT_EQ(notifier_->inodes, std::set<Ino>({1}));
+  ASSERT_EQ(notifier_->entries.count(std::make_pair(Ino(1), "f1")), 1);
+  invalidator->Stop();
+}
+
+TEST_F(KernelInvalidatorTest, RoundFitsTimeout) {
+  // 5 inodes every 100ms, 50 inodes in 1 second
+  option_.invalidateTimeoutSec = 1;
+  option_.invalidateIntervalMs = 100;
+  option_.invalidateBatchSize = 5;
+  option_.invalidateWatchSize = 100;
+  auto invalidator = std::make_shared<KernelInvalidator>(
+      option_, inodeManager_, nullptr, nullptr, nullptr);
+  for (Ino ino = 100; ino < 200; ino++) {
+    invalidator->Watch(FileAttr(ino, 0));
+  }
+  ASSERT_EQ(invalidator->Size(), 50);
+}
+
+TEST_F(KernelInvalidatorTest, ChangedOnReply) {
+  auto invalidator = Build();
+  invalidator->Watch(DirAttr(1, 1));
+  invalidator->WatchEntry(1, "f1", FileAttr(100, 0));
+
+  // the fresh attribute of directory is replied to kernel
+  invalidator->Watch(DirAttr(1, 2));
+
+  ExpectPoll({DirAttr(1, 2), FileAttr(100, 0)});
+  ASSERT_EQ(invalidator->CheckOnce(), 1);
+  ASSERT_TRUE(notifier_->inodes.empty());
+  ASSERT_EQ(notifier_->entries.count(std::make_pair(Ino(1), "f1")), 1);
+  invalidator->Stop();
+}
+
+TEST_F(KernelInvalidatorTest, OnChangeRecords) {
+  auto invalidator = Build();
+  invalidator->Watch(DirAttr(1, 1));
+  invalidator->WatchEntry(1, "f1", FileAttr(100, 0));
+  invalidator->WatchEntry(1, "f2", FileAttr(200, 0));
+
+  std::vector<ChangeRecord> records{
+      {10, 1, 1, 1, ChangeType::kDentry},
+      {11, 1, 1, 200, ChangeType::kDelete},
+      {12, 1, 1, 300, ChangeType::kInode},  // not watched
+      {13, 1, 1, 0, ChangeType::kReset},
+  };
+  ASSERT_EQ(invalidator->OnChangeRecords(records), 2);
+  ASSERT_TRUE(invalidator->IsWatched(100));
+  ASSERT_FALSE(invalidator->IsWatched(200));
+
+  ExpectPoll({DirAttr(1, 1), FileAttr(100, 0)});
+  ASSERT_EQ(invalidator->CheckOnce(), 4);
+  ASSERT_EQ(notifier_->inodes, std::set<Ino>({1, 200}));
+  ASSERT_EQ(notifier_->entries.size(), 2);
+  invalidator->Stop();
+}
+
+}  // namespace filesystem
+}  // namespace client
+}  // namespace dingofs
@@ -74,8 +74,8 @@ TEST_F(HandlerManagerTest, ModfidyHandler) {
   ASSERT_NE(handler->buffer, nullptr);
 
   auto buffer = handler->buffer;
+  buffer->Reserve(10);
   buffer->size = 10;
-  buffer->p = static_cast<char*>(realloc(buffer->p, buffer->size));
   handler->padding = true;
   char* position = buffer->p;
 
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base/math/math.h"
+#include "client/datastream/flush_pipeline.h"
+#include "gtest/gtest.h"
+#include "utils/concurrent/count_down_event.h"
+
+namespace dingofs {
+namespace client {
+
+using ::dingofs::base::math::kMiB;
+using ::dingofs::client::common::FlushPipelineOption;
+using ::dingofs::client::datastream::FlushBlockTask;
+using ::dingofs::client::datastream::FlushPipeline;
+using ::dingofs::client::datastream::FlushSliceTask;
+using ::dingofs::client::datastream::InflightBudget;
+using ::dingofs::utils::CountDownEvent;
+
+class FlushPipelineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {}
+  void TearDown() override {}
+
+  static FlushPipelineOption DefaultOption() {
+    FlushPipelineOption option;
+    option.enable = true;
+    option.slice_workers = 4;
+    option.encode_workers = 4;
+    option.upload_workers = 16;
+    option.commit_workers = 2;
+    option.queue_size = 10000;
+    option.inode_max_inflight_bytes = 64 * kMiB;
+    option.max_inflight_bytes = 256 * kMiB;
+    return option;
+  }
+
+  static FlushSliceTask NewSlice(uint64_t ino, uint64_t num_blocks,
+                                 uint64_t block_size,
+                                 std::function<void()> upload_hook) {
+    FlushSliceTask task;
+    task.ino = ino;
+    for (uint64_t i = 0; i < num_blocks; i++) {
+      FlushBlockTask block;
+      block.length = block_size;
+      block.encode = [block_size](char* buffer) {
+        std::memset(buffer, 'a', block_size);
+      };
+      block.upload = [upload_hook](const char*) { upload_hook(); };
+      task.blocks.emplace_back(block);
+    }
+    return task;
+  }
+};
+
+TEST_F(FlushPipelineTest, InflightBudget) {
+  InflightBudget budget(2 * kMiB, 3 * kMiB);
+
+  budget.Acquire(1, 2 * kMiB);
+  ASSERT_EQ(budget.InflightBytes(), 2 * kMiB);
+  ASSERT_EQ(budget.InflightBytes(1), 2 * kMiB);
+
+  // blocked by inode limit
+  std::atomic<bool> acquired(false);
+  std::thread t([&]() {
+    budget.Acquire(1, kMiB);
+    acquired.store(true);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_FALSE(acquired.load());
+
+  // other inode is not blocked
+  budget.Acquire(2, kMiB);
+  ASSERT_EQ(budget.InflightBytes(), 3 * kMiB);
+
+  budget.Release(1, 2 * kMiB);
+  t.join();
+  ASSERT_TRUE(acquired.load());
+  ASSERT_EQ(budget.InflightBytes(1), kMiB);
+
+  // larger than limit is allowed when nothing in flight
+  budget.Release(1, kMiB);
+  budget.Release(2, kMiB);
+  budget.Acquire(3, 10 * kMiB);
+  ASSERT_EQ(budget.InflightBytes(), 10 * kMiB);
+  budget.Release(3, 10 * kMiB);
+  ASSERT_EQ(budget.InflightBytes(), 0);
+}
+
+TEST_F(FlushPipelineTest, CommitInSubmitOrder) {
+  FlushPipeline pipeline;
+  ASSERT_TRUE(pipeline.Start(DefaultOption()));
+
+  constexpr int kSlices = 64;
+  std::mutex mutex;
+  std::vector<int> commits;
+  CountDownEvent done(kSlices);
+  for (int i = 0; i < kSlices; i++) {
+    // former slices upload slower than latter ones
+    auto delay = std::chrono::microseconds((kSlices - i) * 100);
+    auto task = NewSlice(1, 4, 4096, [delay]() {
+      std::this_thread::sleep_for(delay);
+    });
+    task.commit = [&, i]() {
+      std::lock_guard<std::mutex> lk(mutex);
+      commits.push_back(i);
+    };
+    task.done = [&]() { done.Signal(); };
+    pipeline.Submit(std::move(task));
+  }
+  done.Wait();
+
+  ASSERT_EQ(commits.size(), kSlices);
+  for (int i = 0; i < kSlices; i++) {
+    ASSERT_EQ(commits[i], i);
+  }
+  ASSERT_EQ(pipeline.InflightBytes(), 0);
+  ASSERT_EQ(pipeline.InflightSlices(), 0);
+  pipeline.Stop();
+}
+
+TEST_F(FlushPipelineTest, BoundedInflightBytes) {
+  auto option = DefaultOption();
+  option.inode_max_inflight_bytes = 4 * kMiB;
+  option.max_inflight_bytes = 4 * kMiB;
+  FlushPipeline pipeline;
+  ASSERT_TRUE(pipeline.Start(option));
+
+  std::atomic<uint64_t> max_inflight(0);
+  CountDownEvent done(1);
+  auto task = NewSlice(1, 64, kMiB, [&]() {
+    uint64_t inflight = pipeline.InflightBytes();
+    uint64_t prev = max_inflight.load();
+    while (inflight > prev &&
+           !max_inflight.compare_exchange_weak(prev, inflight)) {
+    }
+  });
+  task.done = [&]() { done.Signal(); };
+  pipeline.Submit(std::move(task));
+  done.Wait();
+
+  ASSERT_LE(max_inflight.load(), 4 * kMiB);
+  ASSERT_EQ(pipeline.InflightBytes(), 0);
+  pipeline.Stop();
+}
+
+TEST_F(FlushPipelineTest, EmptySlice) {
+  FlushPipeline pipeline;
+  ASSERT_TRUE(pipeline.Start(DefaultOption()));
+
+  CountDownEvent done(1);
+  bool committed = false;
+  FlushSliceTask task;
+  task.ino = 1;
+  task.commit = [&]() { committed = true; };
+  task.done = [&]() { done.Signal(); };
+  pipeline.Submit(std::move(task));
+  done.Wait();
+
+  ASSERT_TRUE(committed);
+  pipeline.Stop();
+}
+
+// All blocks of a slice must be in upload together: every upload waits
+// until the others arrived, which never happens if they are serialized.
+TEST_F(FlushPipelineTest, BlocksUploadInParallel) {
+  constexpr int kBlocks = 8;
+  FlushPipeline pipeline;
+  ASSERT_TRUE(pipeline.Start(DefaultOption()));
+
+  CountDownEvent arrived(kBlocks);
+  std::atomic<int> met(0);
+  CountDownEvent done(1);
+  auto task = NewSlice(1, kBlocks, kMiB, [&]() {
+    arrived.Signal();
+    if (arrived.WaitFor(10000)) {
+      met.fetch_add(1);
+    }
+  });
+  task.done = [&]() { done.Signal(); };
+  pipeline.Submit(std::move(task));
+  done.Wait();
+
+  ASSERT_EQ(met.load(), kBlocks);
+  pipeline.Stop();
+}
+
+// Slices of different inodes are in flight together, and the commit of one
+// inode never waits for another.
+TEST_F(FlushPipelineTest, SlicesUploadInParallel) {
+  constexpr int kSlices = 4;
+  FlushPipeline pipeline;
+  ASSERT_TRUE(pipeline.Start(DefaultOption()));
+
+  CountDownEvent arrived(kSlices);
+  std::atomic<int> met(0);
+  std::atomic<int> commits(0);
+  CountDownEvent done(kSlices);
+  for (int i = 0; i < kSlices; i++) {
+    auto task = NewSlice(i + 1, 1, kMiB, [&]() {
+      arrived.Signal();
+      if (arrived.WaitFor(10000)) {
+        met.fetch_add(1);
+      }
+    });
+    task.commit = [&]() { commits.fetch_add(1); };
+    task.done = [&]() { done.Signal(); };
+    pipeline.Submit(std::move(task));
+  }
+  done.Wait();
+
+  ASSERT_EQ(met.load(), kSlices);
+  ASSERT_EQ(commits.load(), kSlices);
+  ASSERT_EQ(pipeline.InflightSlices(), 0);
+  pipeline.Stop();
+}
+
+}  // namespace client
+}  // namespace dingofs
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/warmup/warmup_checkpoint.h"
+#include "client/warmup/warmup_manager.h"
+#include "client/warmup/warmup_replayer.h"
+#include "client/warmup/warmup_scheduler.h"
+#include "utils/concurrent/count_down_event.h"
+
+namespace dingofs {
+namespace client {
+namespace warmup {
+
+using ::dingofs::client::common::WarmupOption;
+using ::dingofs::utils::CountDownEvent;
+
+class WarmupSchedulerTest : public ::testing::Test {
+ protected:
+  static WarmupOption DefaultOption(uint32_t workers) {
+    WarmupOption option;
+    option.download_workers = workers;
+    option.bandwidth_bytes = 0;
+    option.iops = 0;
+    return option;
+  }
+};
+
+TEST_F(WarmupSchedulerTest, ScheduleByPriority) {
+  WarmupScheduler scheduler;
+  ASSERT_TRUE(scheduler.Start(DefaultOption(1)));
+
+  // block the only worker until all tasks are submitted
+  CountDownEvent blocked(1);
+  CountDownEvent started(1);
+  scheduler.Submit(WarmupBlockTask{1, 0, 4096, [&]() {
+    started.Signal();
+    blocked.Wait();
+  }});
+  started.Wait();
+
+  std::mutex mutex;
+  std::vector<uint64_t> order;
+  CountDownEvent done(6);
+  for (uint64_t priority : {5, 3, 1, 4, 2, 1}) {
+    auto run = [&, priority]() {
+      std::lock_guard<std::mutex> lk(mutex);
+      order.push_back(priority);
+      done.Signal();
+    };
+    scheduler.Submit(WarmupBlockTask{priority % 2, priority, 4096, run});
+  }
+  ASSERT_EQ(scheduler.PendingTasks(), 7);
+  ASSERT_EQ(scheduler.PendingTasks(1), 5);
+  ASSERT_EQ(scheduler.PendingTasks(0), 2);
+
+  blocked.Signal();
+  done.Wait();
+  ASSERT_EQ(order, std::vector<uint64_t>({1, 1, 2, 3, 4, 5}));
+
+  scheduler.Stop();
+  ASSERT_EQ(scheduler.PendingTasks(), 0);
+  ASSERT_EQ(scheduler.PendingTasks(1), 0);
+}
+
+TEST(WarmupCheckpointTest, Resume) {
+  char path[] = "/tmp/warmup_checkpoint_XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  close(fd);
+
+  {
+    WarmupCheckpoint checkpoint(path);
+    ASSERT_TRUE(checkpoint.Open());
+    ASSERT_EQ(checkpoint.FinishedCount(), 0);
+    checkpoint.MarkFinished(100, 4096);
+    checkpoint.MarkFinished(101, 8192);
+    ASSERT_TRUE(checkpoint.IsFinished(100, 4096));
+  }
+
+  // interrupted, reopen it
+  {
+    WarmupCheckpoint checkpoint(path);
+    ASSERT_TRUE(checkpoint.Open());
+    ASSERT_EQ(checkpoint.FinishedCount(), 2);
+    ASSERT_TRUE(checkpoint.IsFinished(100, 4096));
+    ASSERT_TRUE(checkpoint.IsFinished(101, 8192));
+    ASSERT_FALSE(checkpoint.IsFinished(101, 4096));  // length changed
+    ASSERT_FALSE(checkpoint.IsFinished(102, 4096));
+    checkpoint.Remove();
+    ASSERT_NE(access(path, F_OK), 0);
+  }
+
+  // start over after removed
+  {
+    WarmupCheckpoint checkpoint(path);
+    ASSERT_TRUE(checkpoint.Open());
+    ASSERT_EQ(checkpoint.FinishedCount(), 0);
+    checkpoint.Remove();
+  }
+}
+
+TEST(WarmupReplayerTest, StayAheadOfReader) {
+  std::vector<AccessRecord> profile;
+  for (uint64_t i = 0; i < 100; i++) {
+    profile.push_back(AccessRecord{i / 10 + 1, i % 10});
+  }
+
+  std::vector<uint64_t> prefetched;
+  WarmupReplayer replayer(
+      profile, 8, [&](const AccessRecord& record, uint64_t position) {
+        ASSERT_EQ(record, profile[position]);
+        prefetched.push_back(position);
+      });
+
+  // CASE 1: first access, prefetch next 8 blocks
+  replayer.OnAccess(AccessRecord{1, 0});
+  ASSERT_EQ(prefetched, std::vector<uint64_t>({1, 2, 3, 4, 5, 6, 7, 8}));
+  ASSERT_EQ(replayer.Cursor(), 9);
+
+  // CASE 2: read sequentially, only one more block
+  prefetched.clear();
+  replayer.OnAccess(AccessRecord{1, 1});
+  ASSERT_EQ(prefetched, std::vector<uint64_t>({9}));
+
+  // CASE 3: unknown block
+  prefetched.clear();
+  replayer.OnAccess(AccessRecord{100, 0});
+  ASSERT_TRUE(prefetched.empty());
+
+  // CASE 4: reader is ahead of replayer, skip the blocks already read
+  replayer.OnAccess(AccessRecord{3, 0});  // position 20
+  ASSERT_EQ(prefetched.front(), 21);
+  ASSERT_EQ(prefetched.back(), 28);
+
+  // CASE 5: end of profile
+  prefetched.clear();
+  replayer.OnAccess(AccessRecord{10, 5});  // position 95
+  ASSERT_EQ(prefetched, std::vector<uint64_t>({96, 97, 98, 99}));
+
+  // CASE 6: next epoch, replay from the beginning
+  prefetched.clear();
+  replayer.OnAccess(AccessRecord{1, 0});
+  ASSERT_EQ(prefetched, std::vector<uint64_t>({1, 2, 3, 4, 5, 6, 7, 8}));
+}
+
+TEST(WarmupProgressTest, ConcurrentUpdate) {
+  WarmupProgress progress;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; i++) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 10000; j++) {
+        progress.AddTotal(1);
+        progress.FinishedPlusOne();
+        if (j % 10 == 0) {
+          progress.ErrorsPlusOne();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  WarmupProgress copy = progress;
+  ASSERT_EQ(copy.GetTotal(), 80000);
+  ASSERT_EQ(copy.GetFinished(), 80000);
+  ASSERT_EQ(copy.GetErrors(), 8000);
+  ASSERT_EQ(copy.ToString(), "total:80000,finished:80000,error:8000");
+}
+
+}  // namespace warmup
+}  // namespace client
+}  // namespace dingofs
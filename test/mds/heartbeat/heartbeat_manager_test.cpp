@@ -83,8 +83,8 @@ MetaServerHeartbeatRequest GetMetaServerHeartbeatRequestForTest() {
   request.set_ip("192.168.10.1");
   request.set_port(9000);
   request.set_starttime(1000);
-  request.set_leadercount(10);
-  request.set_copysetcount(100);
+  request.set_leadercount(1);
+  request.set_copysetcount(1);
   pb::mds::heartbeat::MetaServerSpaceStatus status;
   status.set_diskthresholdbyte(0);
   status.set_diskcopysetminrequirebyte(0);
@@ -919,6 +919,97 @@ TEST_F(TestHeartbeatManager, test_update_partition) {
   heartbeatManager_->MetaServerHeartbeat(request, &response);
   ASSERT_EQ(HeartbeatStatusCode::hbOK, response.statuscode());
 }
+
+TEST_F(TestHeartbeatManager, test_delta_report_dispatch_pending_operator) {
+  auto request = GetMetaServerHeartbeatRequestForTest();
+  MetaServerHeartbeatResponse response;
+
+  // full report with no copyset before delta one
+  request.clear_copysetinfos();
+  request.set_copysetcount(0);
+  ::dingofs::mds::topology::MetaServer metaServer1(
+      1, "hostname", "hello", 1, "192.168.10.1", 9000, "", 9000);
+  EXPECT_CALL(*topology_, GetMetaServer(1, _))
+      .Times(2)
+      .WillRepeatedly(DoAll(SetArgPointee<1>(metaServer1), Return(true)));
+  heartbeatManager_->MetaServerHeartbeat(request, &response);
+  ASSERT_EQ(HeartbeatStatusCode::hbOK, response.statuscode());
+
+  // all copysets are unchanged since the last heartbeat
+  request.set_copysetcount(100);
+
+  // operators on copyset(1,1) led by metaserver 1 and copyset(1,2) led by
+  // metaserver 2
+  auto* coordinator = static_cast<MockCoordinator*>(coordinator_.get());
+  std::vector<CopySetKey> pending{{1, 1}, {1, 2}};
+  EXPECT_CALL(*coordinator, GetPendingCopySets()).WillOnce(Return(pending));
+  ::dingofs::mds::topology::CopySetInfo recordCopySetInfo1(1, 1);
+  recordCopySetInfo1.SetEpoch(1);
+  recordCopySetInfo1.SetLeader(1);
+  ::dingofs::mds::topology::CopySetInfo recordCopySetInfo2(1, 2);
+  recordCopySetInfo2.SetEpoch(1);
+  recordCopySetInfo2.SetLeader(2);
+  EXPECT_CALL(*topology_, GetCopySet(CopySetKey{1, 1}, _))
+      .Times(2)
+      .WillRepeatedly(
+          DoAll(SetArgPointee<1>(recordCopySetInfo1), Return(true)));
+  EXPECT_CALL(*topology_, GetCopySet(CopySetKey{1, 2}, _))
+      .WillOnce(DoAll(SetArgPointee<1>(recordCopySetInfo2), Return(true)));
+
+  pb::mds::heartbeat::CopySetConf conf;
+  conf.set_poolid(1);
+  conf.set_copysetid(1);
+  conf.set_epoch(1);
+  conf.set_type(ConfigChangeType::TRANSFER_LEADER);
+  EXPECT_CALL(*coordinator, CopySetHeartbeat(_, _, _))
+      .WillOnce(DoAll(SetArgPointee<2>(conf), Return(2)));
+  EXPECT_CALL(*topology_, UpdateCopySetTopo(_))
+      .WillOnce(Return(TopoStatusCode::TOPO_OK));
+
+  heartbeatManager_->MetaServerHeartbeat(request, &response);
+  ASSERT_EQ(HeartbeatStatusCode::hbOK, response.statuscode());
+  ASSERT_EQ(1, response.needupdatecopysets_size());
+  ASSERT_EQ(1, response.needupdatecopysets(0).copysetid());
+  ASSERT_EQ(ConfigChangeType::TRANSFER_LEADER,
+            response.needupdatecopysets(0).type());
+}
+
+TEST_F(TestHeartbeatManager, test_delta_report_before_full_report) {
+  auto request = GetMetaServerHeartbeatRequestForTest();
+  MetaServerHeartbeatResponse response;
+
+  // e.g. the mds is restarted or newly elected
+  request.clear_copysetinfos();
+  request.set_copysetcount(100);
+  ::dingofs::mds::topology::MetaServer metaServer1(
+      1, "hostname", "hello", 1, "192.168.10.1", 9000, "", 9000);
+  EXPECT_CALL(*topology_, GetMetaServer(1, _))
+      .WillOnce(DoAll(SetArgPointee<1>(metaServer1), Return(true)));
+  auto* coordinator = static_cast<MockCoordinator*>(coordinator_.get());
+  EXPECT_CALL(*coordinator, GetPendingCopySets()).Times(0);
+
+  heartbeatManager_->MetaServerHeartbeat(request, &response);
+  ASSERT_EQ(HeartbeatStatusCode::hbAnalyseCopysetError, response.statuscode());
+  ASSERT_EQ(0, response.needupdatecopysets_size());
+}
+
+TEST_F(TestHeartbeatManager, test_full_report_skip_pending_operator) {
+  auto request = GetMetaServerHeartbeatRequestForTest();
+  MetaServerHeartbeatResponse response;
+
+  request.clear_copysetinfos();
+  request.set_copysetcount(0);
+  ::dingofs::mds::topology::MetaServer metaServer1(
+      1, "hostname", "hello", 1, "192.168.10.1", 9000, "", 9000);
+  EXPECT_CALL(*topology_, GetMetaServer(1, _))
+      .WillOnce(DoAll(SetArgPointee<1>(metaServer1), Return(true)));
+  auto* coordinator = static_cast<MockCoordinator*>(coordinator_.get());
+  EXPECT_CALL(*coordinator, GetPendingCopySets()).Times(0);
+
+  heartbeatManager_->MetaServerHeartbeat(request, &response);
+  ASSERT_EQ(HeartbeatStatusCode::hbOK, response.statuscode());
+  ASSERT_EQ(0, response.needupdatecopysets_size());
+}
 }  // namespace heartbeat
 }  // namespace mds
 }  // namespace dingofs
@@ -49,6 +49,7 @@ class MockCoordinator : public ::dingofs::mds::schedule::Coordinator {
                        pb::mds::heartbeat::CopySetConf* newConf));
 
   MOCK_METHOD2(MetaserverGoingToAdd, bool(MetaServerIdType, CopySetKey));
+  MOCK_METHOD0(GetPendingCopySets, std::vector<CopySetKey>());
 
   MOCK_METHOD2(QueryMetaServerRecoverStatus,
                pb::mds::schedule::ScheduleStatusCode(
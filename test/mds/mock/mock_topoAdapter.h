@@ -34,6 +34,8 @@
 namespace dingofs {
 namespace mds {
 namespace schedule {
+using CopySetStatistics = std::map<CopySetIdType, CopySetStatistic>;
+
 class MockTopoAdapter : public TopoAdapter {
  public:
   MockTopoAdapter() {}
@@ -86,6 +88,8 @@ class MockTopoAdapter : public TopoAdapter {
                bool(PoolIdType poolId, const std::set<ZoneIdType>& excludeZones,
                     const std::set<MetaServerIdType>& excludeMetaservers,
                     MetaServerIdType* target));
+
+  MOCK_METHOD1(GetCopySetStatisticsInPool, CopySetStatistics(PoolIdType));
 };
 }  // namespace schedule
 }  // namespace mds
@@ -347,6 +347,9 @@ class MockTopology : public TopologyImpl {
 
   MOCK_CONST_METHOD1(GetPartitionInfosInCopyset,
                      std::list<Partition>(CopySetIdType copysetId));
+  MOCK_CONST_METHOD2(GetPartitionInfosInPool,
+                     std::list<Partition>(PoolIdType poolId,
+                                          PartitionFilter filter));
 };
 
 class MockTopologyManager : public TopologyManager {
@@ -416,6 +419,10 @@ class MockTopologyManager : public TopologyManager {
   MOCK_METHOD2(CreatePartitionsAndGetMinPartition,
                TopoStatusCode(FsIdType fsId, PartitionInfo* partition));
 
+  MOCK_METHOD3(SplitPartition,
+               TopoStatusCode(PartitionIdType partitionId, uint64_t splitKey,
+                              PartitionInfo* info));
+
   MOCK_METHOD2(CommitTx, void(const CommitTxRequest* request,
                               CommitTxResponse* response));
 
@@ -98,6 +98,8 @@ ScheduleOption GetTrueScheduleOption() {
   scheduleOption.enableCopysetScheduler = true;
   scheduleOption.enableLeaderScheduler = true;
   scheduleOption.enableRecoverScheduler = true;
+  scheduleOption.enableLoadScheduler = true;
+  scheduleOption.loadSchedulerIntervalSec = 10;
   scheduleOption.copysetSchedulerIntervalSec = 10;
   scheduleOption.leaderSchedulerIntervalSec = 10;
   scheduleOption.recoverSchedulerIntervalSec = 10;
@@ -438,6 +440,7 @@ TEST_F(CoordinatorTest, test_SchedulerSwitch) {
   scheduleOption.copysetSchedulerIntervalSec = 0;
   scheduleOption.leaderSchedulerIntervalSec = 0;
   scheduleOption.recoverSchedulerIntervalSec = 0;
+  scheduleOption.loadSchedulerIntervalSec = 0;
   coordinator_->InitScheduler(scheduleOption, metric_);
 
   EXPECT_CALL(*topoAdapter_, GetCopySetInfos()).Times(0);
@@ -448,6 +451,7 @@ TEST_F(CoordinatorTest, test_SchedulerSwitch) {
   gflags::SetCommandLineOption("enableCopySetScheduler", "false");
   gflags::SetCommandLineOption("enableRecoverScheduler", "false");
   gflags::SetCommandLineOption("enableLeaderScheduler", "false");
+  gflags::SetCommandLineOption("enableLoadScheduler", "false");
 
   coordinator_->Run();
   ::sleep(1);
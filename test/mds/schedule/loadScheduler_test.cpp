@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "mds/mock/mock_topoAdapter.h"
+#include "mds/mock/mock_topology.h"
+#include "mds/schedule/operatorController.h"
+#include "mds/schedule/scheduleMetrics.h"
+#include "mds/schedule/scheduler.h"
+#include "utils/timeutility.h"
+
+using ::dingofs::mds::topology::MockIdGenerator;
+using ::dingofs::mds::topology::MockStorage;
+using ::dingofs::mds::topology::MockTokenGenerator;
+using ::dingofs::mds::topology::MockTopology;
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace dingofs {
+namespace mds {
+namespace schedule {
+
+// A simulated pool: 3 zones with 2 metaservers each, every copyset has one
+// replica in each zone. The copysets led by metaserver 1 are 10x hotter
+// than the others, the operators are applied at once after every round.
+class LoadSchedulerTest : public ::testing::Test {
+ protected:
+  struct SimCopySet {
+    std::vector<MetaServerIdType> peers;
+    MetaServerIdType leader;
+    uint64_t opsPerRound;
+    CopySetStatistic statistic;
+  };
+
+  void SetUp() override {
+    topo_ =
+        std::make_shared<MockTopology>(idGenerator_, tokenGenerator_, storage_);
+    metric_ = std::make_shared<ScheduleMetrics>(topo_);
+    opController_ = std::make_shared<OperatorController>(2, metric_);
+    topoAdapter_ = std::make_shared<NiceMock<MockTopoAdapter>>();
+
+    opt_.transferLeaderTimeLimitSec = 10;
+    opt_.removePeerTimeLimitSec = 100;
+    opt_.addPeerTimeLimitSec = 1000;
+    opt_.changePeerTimeLimitSec = 1000;
+    opt_.metaserverCoolingTimeSec = 10;
+    opt_.balanceRatioPercent = 15;
+    opt_.loadSchedulerIntervalSec = 1;
+    opt_.loadBalanceRatioPercent = 25;
+    opt_.loadCoolingTimeSec = 600;
+    opt_.loadMinOpsPerSec = 0;
+
+    BuildPool(2, 24);
+    BindTopoAdapter();
+  }
+
+  void BuildPool(uint32_t msPerZone, uint32_t copysetNum) {
+    for (uint32_t zone = 0; zone < 3; zone++) {
+      for (uint32_t i = 0; i < msPerZone; i++) {
+        zones_[zone * msPerZone + i + 1] = zone + 1;
+      }
+    }
+
+    std::map<MetaServerIdType, int> leaderNum;
+    for (uint32_t i = 0; i < copysetNum; i++) {
+      SimCopySet copyset;
+      for (uint32_t zone = 0; zone < 3; zone++) {
+        copyset.peers.emplace_back(zone * msPerZone + 1 +
+                                   (i + zone * (i / msPerZone)) % msPerZone);
+      }
+      copyset.leader = *std::min_element(
+          copyset.peers.begin(), copyset.peers.end(),
+          [&](MetaServerIdType lhs, MetaServerIdType rhs) {
+            return leaderNum[lhs] < leaderNum[rhs] ||
+                   (leaderNum[lhs] == leaderNum[rhs] && lhs < rhs);
+          });
+      leaderNum[copyset.leader]++;
+      copyset.opsPerRound = copyset.leader == 1 ? 1000 : 100;
+      copysets_[i + 1] = copyset;
+    }
+  }
+
+  PeerInfo GetPeer(MetaServerIdType id) {
+    return PeerInfo(id, zones_[id], id, "127.0.0.1", 9000 + id);
+  }
+
+  MetaServerInfo GetMetaServer(MetaServerIdType id) {
+    uint64_t diskUsed = diskUsed_.count(id) != 0 ? diskUsed_[id] : 10;
+    MetaServerInfo info(GetPeer(id), OnlineState::ONLINE,
+                        MetaServerSpace(100, diskUsed, 1));
+    info.startUpTime = startUpTime_.count(id) != 0
+                           ? startUpTime_[id]
+                           : utils::TimeUtility::GetTimeofDaySec() - 3600;
+    for (const auto& item : copysets_) {
+      const auto& peers = item.second.peers;
+      if (std::find(peers.begin(), peers.end(), id) != peers.end()) {
+        info.copysetNum++;
+      }
+      if (item.second.leader == id) {
+        info.leaderNum++;
+      }
+    }
+    return info;
+  }
+
+  std::vector<CopySetInfo> GetCopySets() {
+    std::vector<CopySetInfo> out;
+    for (const auto& item : copysets_) {
+      std::vector<PeerInfo> peers;
+      for (auto id : item.second.peers) {
+        peers.emplace_back(GetPeer(id));
+      }
+      out.emplace_back(CopySetKey{1, item.first}, 1, item.second.leader, peers,
+                       ConfigChangeInfo());
+    }
+    return out;
+  }
+
+  void BindTopoAdapter() {
+    ON_CALL(*topoAdapter_, Getpools())
+        .WillByDefault(Return(std::vector<PoolIdType>({1})));
+    ON_CALL(*topoAdapter_, GetStandardReplicaNumInPool(1))
+        .WillByDefault(Return(3));
+    ON_CALL(*topoAdapter_, GetCopySetInfosInPool(1))
+        .WillByDefault(Invoke([this](PoolIdType) { return GetCopySets(); }));
+    ON_CALL(*topoAdapter_, GetMetaServersInPool(1))
+        .WillByDefault(Invoke([this](PoolIdType) {
+          std::vector<MetaServerInfo> out;
+          for (const auto& item : zones_) {
+            out.emplace_back(GetMetaServer(item.first));
+          }
+          return out;
+        }));
+    ON_CALL(*topoAdapter_, GetMetaServerInfo(_, _))
+        .WillByDefault(Invoke([this](MetaServerIdType id, MetaServerInfo* out) {
+          *out = GetMetaServer(id);
+          return true;
+        }));
+    ON_CALL(*topoAdapter_, GetCopySetStatisticsInPool(1))
+        .WillByDefault(Invoke([this](PoolIdType) {
+          CopySetStatistics out;
+          for (const auto& item : copysets_) {
+            out[item.first] = item.second.statistic;
+          }
+          return out;
+        }));
+    ON_CALL(*topoAdapter_, CreateCopySetAtMetaServer(_, _))
+        .WillByDefault(Return(true));
+  }
+
+  // the mutations of one round, e.g. creates bump the inode, dentry and id
+  void Advance() {
+    for (auto& item : copysets_) {
+      auto& statistic = item.second.statistic;
+      uint64_t ops = item.second.opsPerRound;
+      statistic.inodeNum += ops / 4;
+      statistic.dentryNum += ops / 4;
+      statistic.allocatedIds += ops / 4;
+      statistic.txId += ops / 4;
+    }
+  }
+
+  // finish the operators as if the metaservers executed them
+  int ApplyOperators() {
+    int applied = 0;
+    for (const auto& op : opController_->GetOperators()) {
+      auto& copyset = copysets_[op.copysetID.second];
+      auto* transfer = dynamic_cast<TransferLeader*>(op.step.get());
+      auto* change = dynamic_cast<ChangePeer*>(op.step.get());
+      if (transfer != nullptr) {
+        copyset.leader = transfer->GetTargetPeer();
+      } else if (change != nullptr) {
+        changedTo_[change->GetTargetPeer()]++;
+        std::replace(copyset.peers.begin(), copyset.peers.end(),
+                     change->GetOldPeer(), change->GetTargetPeer());
+        if (copyset.leader == change->GetOldPeer()) {
+          copyset.leader = copyset.peers[0] == change->GetTargetPeer()
+                               ? copyset.peers[1]
+                               : copyset.peers[0];
+        }
+      }
+      moved_[op.copysetID.second]++;
+      opController_->RemoveOperator(op.copysetID);
+      applied++;
+    }
+    return applied;
+  }
+
+  std::map<MetaServerIdType, double> GetLoads() {
+    std::map<MetaServerIdType, double> loads;
+    for (const auto& item : copysets_) {
+      for (auto id : item.second.peers) {
+        double ops = item.second.opsPerRound;
+        loads[id] += item.second.leader == id ? ops : ops / 2;
+      }
+    }
+    return loads;
+  }
+
+  double MaxLoadRatio() {
+    auto loads = GetLoads();
+    double total = 0;
+    double max = 0;
+    for (const auto& item : loads) {
+      total += item.second;
+      max = std::max(max, item.second);
+    }
+    return max * loads.size() / total;
+  }
+
+ protected:
+  std::shared_ptr<NiceMock<MockTopoAdapter>> topoAdapter_;
+  std::shared_ptr<OperatorController> opController_;
+  std::shared_ptr<MockIdGenerator> idGenerator_;
+  std::shared_ptr<MockTokenGenerator> tokenGenerator_;
+  std::shared_ptr<MockStorage> storage_;
+  std::shared_ptr<MockTopology> topo_;
+  std::shared_ptr<ScheduleMetrics> metric_;
+  ScheduleOption opt_;
+
+  std::map<MetaServerIdType, ZoneIdType> zones_;
+  std::map<CopySetIdType, SimCopySet> copysets_;
+  std::map<CopySetIdType, int> moved_;
+  std::map<MetaServerIdType, int> changedTo_;
+  std::map<MetaServerIdType, uint64_t> diskUsed_;
+  std::map<MetaServerIdType, uint64_t> startUpTime_;
+};
+
+TEST_F(LoadSchedulerTest, EstimateLoad) {
+  LoadScheduler scheduler(opt_, topoAdapter_, opController_);
+
+  // the first round only takes the samples
+  ASSERT_EQ(scheduler.Schedule(), 0);
+  ASSERT_EQ(scheduler.GetCopySetLoad(CopySetKey{1, 1}), 0);
+
+  Advance();
+  scheduler.Schedule();
+  for (const auto& item : copysets_) {
+    double load = scheduler.GetCopySetLoad(CopySetKey{1, item.first});
+    double expect = scheduler.GetCopySetLoad(CopySetKey{1, 2}) *
+                    item.second.opsPerRound / copysets_[2].opsPerRound;
+    ASSERT_GT(load, 0);
+    ASSERT_NEAR(load, expect, expect * 0.001);
+  }
+}
+
+TEST_F(LoadSchedulerTest, SkipIdlePool) {
+  opt_.loadMinOpsPerSec = UINT32_MAX;
+  LoadScheduler scheduler(opt_, topoAdapter_, opController_);
+
+  for (int round = 0; round < 5; round++) {
+    Advance();
+    ASSERT_EQ(scheduler.Schedule(), 0);
+  }
+  ASSERT_TRUE(opController_->GetOperators().empty());
+}
+
+TEST_F(LoadSchedulerTest, Converge) {
+  LoadScheduler scheduler(opt_, topoAdapter_, opController_);
+  double initRatio = MaxLoadRatio();
+  ASSERT_GT(initRatio, 2);
+
+  scheduler.Schedule();
+  int rounds = 0;
+  int ops = 0;
+  for (; rounds < 50; rounds++) {
+    Advance();
+    if (scheduler.Schedule() == 0) {
+      break;
+    }
+    ops += ApplyOperators();
+  }
+
+  LOG(INFO) << "load scheduler converge after " << rounds << " rounds, "
+            << ops << " operators, max/avg load " << initRatio << " -> "
+            << MaxLoadRatio();
+  ASSERT_LT(rounds, 50);
+  ASSERT_GT(ops, 0);
+  ASSERT_LE(MaxLoadRatio() * 100, 100 + opt_.loadBalanceRatioPercent);
+
+  // the cooling time keeps every copyset from moving twice
+  for (const auto& item : moved_) {
+    ASSERT_EQ(item.second, 1) << "copyset " << item.first;
+  }
+
+  // the leader balance of LeaderScheduler is kept
+  for (const auto& item : zones_) {
+    auto info = GetMetaServer(item.first);
+    double different = info.leaderNum - info.copysetNum / 3.0;
+    ASSERT_GE(different, -1) << "metaserver " << item.first;
+    ASSERT_LE(different, 1) << "metaserver " << item.first;
+  }
+
+  // stable once balanced
+  for (int round = 0; round < 5; round++) {
+    Advance();
+    ASSERT_EQ(scheduler.Schedule(), 0);
+  }
+}
+
+// metaserver 2 is the only target in the zone of the hot metaserver 1 for
+// changing peer
+TEST_F(LoadSchedulerTest, ChangePeerKeepCopySetBalance) {
+  // the disk usage of metaserver 2 exceeds balanceRatioPercent
+  diskUsed_[2] = 30;
+  LoadScheduler scheduler(opt_, topoAdapter_, opController_);
+  scheduler.Schedule();
+  for (int round = 0; round < 10; round++) {
+    Advance();
+    scheduler.Schedule();
+    ApplyOperators();
+  }
+  ASSERT_EQ(changedTo_[2], 0);
+}
+
+TEST_F(LoadSchedulerTest, ChangePeerSkipCoolingMetaServer) {
+  // metaserver 2 just started
+  startUpTime_[2] = utils::TimeUtility::GetTimeofDaySec();
+  LoadScheduler scheduler(opt_, topoAdapter_, opController_);
+  scheduler.Schedule();
+  for (int round = 0; round < 10; round++) {
+    Advance();
+    scheduler.Schedule();
+    ApplyOperators();
+  }
+  ASSERT_EQ(changedTo_[2], 0);
+}
+
+}  // namespace schedule
+}  // namespace mds
+}  // namespace dingofs
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <list>
+#include <thread>
+
+#include "mds/mock/mock_topology.h"
+#include "mds/topology/partition_splitter.h"
+
+namespace dingofs {
+namespace mds {
+namespace topology {
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+class TestPartitionSplitter : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    topology_ = std::make_shared<MockTopology>(
+        std::make_shared<MockIdGenerator>(),
+        std::make_shared<MockTokenGenerator>(),
+        std::make_shared<MockStorage>());
+    topologyManager_ =
+        std::make_shared<MockTopologyManager>(topology_, nullptr);
+
+    option_.partitionSplitIntervalSec = 1;
+    option_.partitionSplitRowNum = 10000;
+    option_.partitionSplitOpsPerSec = 1000;
+    option_.partitionSplitMinFreeIds = 1024;
+    splitter_ =
+        std::make_shared<PartitionSplitter>(topology_, topologyManager_);
+    splitter_->Init(option_);
+
+    EXPECT_CALL(*topology_, GetPoolInCluster(_))
+        .WillRepeatedly(Return(std::vector<PoolIdType>({1})));
+    EXPECT_CALL(*topology_, GetPartitionInfosInPool(1, _))
+        .WillRepeatedly(Invoke(
+            [this](PoolIdType, PartitionFilter) { return partitions_; }));
+  }
+
+  Partition& AddPartition(PartitionIdType id, uint64_t start, uint64_t end,
+                          uint64_t next) {
+    Partition partition(1, 1, id, id, start, end);
+    partition.SetIdNext(next);
+    partitions_.emplace_back(partition);
+    return partitions_.back();
+  }
+
+ protected:
+  std::shared_ptr<MockTopology> topology_;
+  std::shared_ptr<MockTopologyManager> topologyManager_;
+  std::shared_ptr<PartitionSplitter> splitter_;
+  TopologyOption option_;
+  std::list<Partition> partitions_;
+};
+
+TEST_F(TestPartitionSplitter, SplitBigPartition) {
+  AddPartition(1, 0, 1048575, 0).SetInodeNum(100);
+  auto& big = AddPartition(2, 1048576, 2097151, 1048576 + 20000);
+  big.SetInodeNum(6000);
+  big.SetDentryNum(6000);
+
+  // keep a half of partitionSplitMinFreeIds free ids
+  EXPECT_CALL(*topologyManager_, SplitPartition(2, 1048576 + 20000 + 511, _))
+      .WillOnce(Return(TopoStatusCode::TOPO_OK));
+  ASSERT_EQ(1, splitter_->SplitPartitions());
+}
+
+TEST_F(TestPartitionSplitter, SplitOnce) {
+  // the big partition was split at 500000, the new partition takes the rest
+  auto& big = AddPartition(1, 0, 500000, 20000);
+  big.SetInodeNum(6000);
+  big.SetDentryNum(6000);
+  auto& next = AddPartition(2, 500001, 1048575, 500001);
+  next.SetInodeNum(100);
+
+  EXPECT_CALL(*topologyManager_, SplitPartition(_, _, _)).Times(0);
+  ASSERT_EQ(0, splitter_->SplitPartitions());
+
+  // the new partition is split once it becomes big
+  next.SetIdNext(500001 + 12000);
+  next.SetInodeNum(12000);
+  EXPECT_CALL(*topologyManager_, SplitPartition(2, 500001 + 12000 + 511, _))
+      .WillOnce(Return(TopoStatusCode::TOPO_OK));
+  ASSERT_EQ(1, splitter_->SplitPartitions());
+}
+
+TEST_F(TestPartitionSplitter, SplitHotPartition) {
+  auto& hot = AddPartition(1, 0, 1048575, 100);
+  AddPartition(2, 1048576, 2097151, 1048576 + 100);
+
+  // the first round only takes the samples
+  EXPECT_CALL(*topologyManager_, SplitPartition(_, _, _)).Times(0);
+  ASSERT_EQ(0, splitter_->SplitPartitions());
+  ASSERT_EQ(0, splitter_->GetWriteRate(1));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  hot.SetIdNext(100 + 10000);
+  hot.SetInodeNum(10000);
+  EXPECT_CALL(*topologyManager_, SplitPartition(1, _, _))
+      .WillOnce(Return(TopoStatusCode::TOPO_OK));
+  ASSERT_EQ(1, splitter_->SplitPartitions());
+  ASSERT_GT(splitter_->GetWriteRate(1), option_.partitionSplitOpsPerSec);
+  ASSERT_EQ(0, splitter_->GetWriteRate(2));
+}
+
+TEST_F(TestPartitionSplitter, SkipPartition) {
+  // readonly
+  auto& readonly = AddPartition(1, 0, 1048575, 100);
+  readonly.SetInodeNum(20000);
+  readonly.SetStatus(pb::common::PartitionStatus::READONLY);
+  // too few free ids
+  AddPartition(2, 1048576, 2097151, 2097151 - 100).SetInodeNum(20000);
+  // small and idle
+  AddPartition(3, 2097152, 3145727, 2097152 + 100).SetInodeNum(100);
+
+  EXPECT_CALL(*topologyManager_, SplitPartition(_, _, _)).Times(0);
+  ASSERT_EQ(0, splitter_->SplitPartitions());
+}
+
+TEST_F(TestPartitionSplitter, SplitFail) {
+  AddPartition(1, 0, 1048575, 100).SetInodeNum(20000);
+
+  EXPECT_CALL(*topologyManager_, SplitPartition(1, _, _))
+      .WillOnce(Return(TopoStatusCode::TOPO_INVALID_PARAM));
+  ASSERT_EQ(0, splitter_->SplitPartitions());
+}
+
+}  // namespace topology
+}  // namespace mds
+}  // namespace dingofs
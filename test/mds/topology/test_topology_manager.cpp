@@ -2273,6 +2273,116 @@ TEST_F(TestTopologyManager, test_DeletePartition_Success) {
   ASSERT_EQ(PartitionStatus::DELETING, info.GetStatus());
 }
 
+TEST_F(TestTopologyManager, test_SplitPartition_Success) {
+  FsIdType fsId = 0x01;
+  PoolIdType poolId = 0x11;
+  CopySetIdType copysetId1 = 0x51;
+  CopySetIdType copysetId2 = 0x52;
+  PartitionIdType partitionId = 0x61;
+  PartitionIdType newPartitionId = 0x62;
+
+  PrepareAddPool(poolId);
+  PrepareAddZone(0x21, "zone1", poolId);
+  PrepareAddZone(0x22, "zone2", poolId);
+  PrepareAddZone(0x23, "zone3", poolId);
+  PrepareAddServer(0x31, "server1", "127.0.0.1", 0, "127.0.0.1", 0, 0x21, 0x11);
+  PrepareAddServer(0x32, "server2", "127.0.0.1", 0, "127.0.0.1", 0, 0x22, 0x11);
+  PrepareAddServer(0x33, "server3", "127.0.0.1", 0, "127.0.0.1", 0, 0x23, 0x11);
+  PrepareAddMetaServer(0x41, "ms1", "token1", 0x31, "127.0.0.1", 7777, "ip2",
+                       8888);
+  PrepareAddMetaServer(0x42, "ms2", "token2", 0x32, "127.0.0.1", 7777, "ip2",
+                       8888);
+  PrepareAddMetaServer(0x43, "ms3", "token3", 0x33, "127.0.0.1", 7777, "ip2",
+                       8888);
+
+  std::set<MetaServerIdType> replicas;
+  replicas.insert(0x41);
+  replicas.insert(0x42);
+  replicas.insert(0x43);
+  PrepareAddCopySet(copysetId1, poolId, replicas);
+  PrepareAddCopySet(copysetId2, poolId, replicas);
+  PrepareAddPartition(fsId, poolId, copysetId1, partitionId, 0, 1023);
+
+  Partition partition;
+  ASSERT_TRUE(topology_->GetPartition(partitionId, &partition));
+  partition.SetIdNext(100);
+  EXPECT_CALL(*storage_, UpdatePartition(_)).WillOnce(Return(true));
+  ASSERT_EQ(TopoStatusCode::TOPO_OK, topology_->UpdatePartition(partition));
+
+  // the source is shrunk before the new partition is created
+  EXPECT_CALL(*idGenerator_, GenPartitionId()).WillOnce(Return(newPartitionId));
+  EXPECT_CALL(*storage_, UpdatePartition(_)).WillOnce(Return(true));
+  EXPECT_CALL(*storage_, StoragePartition(_)).WillOnce(Return(true));
+  EXPECT_CALL(*storage_, StorageClusterInfo(_)).WillOnce(Return(true));
+  {
+    ::testing::InSequence seq;
+    EXPECT_CALL(*mockMetaserverClient_,
+                CreatePartition(fsId, poolId, copysetId1, partitionId, 0, 599,
+                                _))
+        .WillOnce(Return(FSStatusCode::OK));
+    EXPECT_CALL(*mockMetaserverClient_,
+                CreatePartition(fsId, poolId, copysetId2, newPartitionId, 600,
+                                1023, _))
+        .WillOnce(Return(FSStatusCode::OK));
+  }
+
+  PartitionInfo info;
+  ASSERT_EQ(TopoStatusCode::TOPO_OK,
+            serviceManager_->SplitPartition(partitionId, 599, &info));
+  ASSERT_EQ(newPartitionId, info.partitionid());
+  ASSERT_EQ(copysetId2, info.copysetid());
+  ASSERT_EQ(600, info.start());
+  ASSERT_EQ(1023, info.end());
+
+  ASSERT_TRUE(topology_->GetPartition(partitionId, &partition));
+  ASSERT_EQ(0, partition.GetIdStart());
+  ASSERT_EQ(599, partition.GetIdEnd());
+  ASSERT_TRUE(topology_->GetPartition(newPartitionId, &partition));
+  ASSERT_EQ(600, partition.GetIdStart());
+  ASSERT_EQ(1023, partition.GetIdEnd());
+}
+
+TEST_F(TestTopologyManager, test_SplitPartition_Fail) {
+  FsIdType fsId = 0x01;
+  PoolIdType poolId = 0x11;
+  CopySetIdType copysetId = 0x51;
+  PartitionIdType partitionId = 0x61;
+
+  PrepareAddPool(poolId);
+  std::set<MetaServerIdType> replicas;
+  PrepareAddCopySet(copysetId, poolId, replicas);
+  PrepareAddPartition(fsId, poolId, copysetId, partitionId, 0, 1023);
+
+  Partition partition;
+  ASSERT_TRUE(topology_->GetPartition(partitionId, &partition));
+  partition.SetIdNext(100);
+  EXPECT_CALL(*storage_, UpdatePartition(_)).WillOnce(Return(true));
+  ASSERT_EQ(TopoStatusCode::TOPO_OK, topology_->UpdatePartition(partition));
+
+  PartitionInfo info;
+  ASSERT_EQ(TopoStatusCode::TOPO_PARTITION_NOT_FOUND,
+            serviceManager_->SplitPartition(0x62, 599, &info));
+
+  // the ids below the next id are allocated already
+  ASSERT_EQ(TopoStatusCode::TOPO_INVALID_PARAM,
+            serviceManager_->SplitPartition(partitionId, 98, &info));
+  ASSERT_EQ(TopoStatusCode::TOPO_INVALID_PARAM,
+            serviceManager_->SplitPartition(partitionId, 1023, &info));
+
+  // no other copyset to hold the new partition
+  ASSERT_EQ(TopoStatusCode::TOPO_GET_AVAILABLE_COPYSET_ERROR,
+            serviceManager_->SplitPartition(partitionId, 599, &info));
+
+  // the metaserver rejects the split
+  PrepareAddCopySet(0x52, poolId, replicas);
+  EXPECT_CALL(*mockMetaserverClient_, CreatePartition(_, _, _, _, _, _, _))
+      .WillOnce(Return(FSStatusCode::UNKNOWN_ERROR));
+  ASSERT_EQ(TopoStatusCode::TOPO_CREATE_PARTITION_FAIL,
+            serviceManager_->SplitPartition(partitionId, 599, &info));
+  ASSERT_TRUE(topology_->GetPartition(partitionId, &partition));
+  ASSERT_EQ(1023, partition.GetIdEnd());
+}
+
 TEST_F(TestTopologyManager, test_CommitTx_Success) {
   PoolIdType poolId = 0x11;
   CopySetIdType copysetId = 0x51;
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metaserver/change_feed.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace dingofs {
+namespace metaserver {
+
+using ::dingofs::common::DecodeChangeRecords;
+using ::dingofs::common::EncodeChangeRecords;
+using ::dingofs::common::kChangeRecordSize;
+
+namespace {
+
+ChangeRecord Record(uint64_t index, uint64_t inodeId,
+                    ChangeType type = ChangeType::kInode) {
+  return ChangeRecord{index, 1, 100, inodeId, type};
+}
+
+}  // namespace
+
+TEST(ChangeFeedTest, Codec) {
+  std::vector<ChangeRecord> records{
+      Record(1, 10), Record(2, 20, ChangeType::kDentry),
+      Record(UINT64_MAX, UINT64_MAX, ChangeType::kDelete)};
+  butil::IOBuf buffer;
+  EncodeChangeRecords(records, &buffer);
+  ASSERT_EQ(buffer.size(), records.size() * kChangeRecordSize);
+
+  std::vector<ChangeRecord> out;
+  ASSERT_TRUE(DecodeChangeRecords(buffer, &out));
+  ASSERT_EQ(out, records);
+
+  // truncated buffer
+  buffer.pop_back(1);
+  out.clear();
+  ASSERT_FALSE(DecodeChangeRecords(buffer, &out));
+}
+
+TEST(ChangeFeedTest, PartitionRing) {
+  PartitionChangeFeed feed(3);
+  for (uint64_t index = 1; index <= 5; index++) {
+    feed.Append(Record(index, index));
+  }
+  ASSERT_EQ(feed.Size(), 3);
+
+  std::vector<ChangeRecord> records;
+  ASSERT_TRUE(feed.ReadAfter(3, &records));
+  ASSERT_EQ(records.size(), 2);
+  ASSERT_EQ(records[0].index, 4);
+
+  // index 2 and 3 is dropped, the reader has missed them
+  records.clear();
+  ASSERT_FALSE(feed.ReadAfter(1, &records));
+  ASSERT_EQ(records.size(), 3);
+
+  records.clear();
+  ASSERT_TRUE(feed.ReadAfter(5, &records));
+  ASSERT_TRUE(records.empty());
+}
+
+TEST(ChangeFeedTest, Disabled) {
+  ChangeFeed feed;
+  ASSERT_FALSE(feed.Enabled());
+  ASSERT_FALSE(feed.Subscribe(100, 0, nullptr));
+
+  feed.Init(16);
+  ASSERT_TRUE(feed.Enabled());
+  feed.Init(0);
+  ASSERT_FALSE(feed.Enabled());
+}
+
+TEST(ChangeFeedTest, ResetOnLeaderChange) {
+  ChangeFeed feed;
+  feed.Init(16);
+  feed.Reset(10);
+  feed.Append(100, {Record(11, 1), Record(12, 2)});
+
+  std::vector<ChangeRecord> records;
+  ASSERT_TRUE(feed.ReadAfter(100, 10, &records));
+  ASSERT_EQ(records.size(), 2);
+
+  // the changes before the feed started are unknown
+  records.clear();
+  ASSERT_FALSE(feed.ReadAfter(100, 5, &records));
+
+  feed.Reset(20);
+  records.clear();
+  ASSERT_TRUE(feed.ReadAfter(100, 20, &records));
+  ASSERT_TRUE(records.empty());
+  ASSERT_FALSE(feed.ReadAfter(100, 12, &records));
+}
+
+}  // namespace metaserver
+}  // namespace dingofs
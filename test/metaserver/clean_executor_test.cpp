@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metaserver/clean_executor.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dingofs {
+namespace metaserver {
+
+class CleanExecutorTest : public testing::Test {
+ protected:
+  void TearDown() override { executor_.Stop(); }
+
+ protected:
+  CleanExecutor executor_;
+};
+
+TEST_F(CleanExecutorTest, RunInline) {
+  CleanExecutorOption option;
+  option.threadNum = 0;
+  option.batchSize = 0;
+  executor_.Init(option);
+  executor_.Start();
+  ASSERT_EQ(executor_.BatchSize(), 1);
+
+  auto caller = std::this_thread::get_id();
+  std::thread::id runner;
+  executor_.Submit(1, [&runner]() { runner = std::this_thread::get_id(); });
+  ASSERT_EQ(runner, caller);
+}
+
+TEST_F(CleanExecutorTest, SameKeySerialized) {
+  CleanExecutorOption option;
+  option.threadNum = 4;
+  executor_.Init(option);
+  executor_.Start();
+
+  std::mutex mtx;
+  std::vector<int> order;
+  std::atomic<int> running(0);
+  std::atomic<bool> overlapped(false);
+  std::vector<std::pair<uint64_t, CleanExecutor::Task>> tasks;
+  for (int i = 0; i < 100; i++) {
+    tasks.emplace_back(1, [&, i]() {
+      if (running.fetch_add(1) != 0) {
+        overlapped = true;
+      }
+      {
+        std::lock_guard<std::mutex> lk(mtx);
+        order.push_back(i);
+      }
+      running.fetch_sub(1);
+    });
+  }
+  executor_.SubmitAndWait(std::move(tasks));
+
+  ASSERT_FALSE(overlapped);
+  ASSERT_EQ(order.size(), 100);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(order[i], i);
+  }
+}
+
+TEST_F(CleanExecutorTest, DifferentKeysParallel) {
+  CleanExecutorOption option;
+  option.threadNum = 4;
+  executor_.Init(option);
+  executor_.Start();
+
+  // every task waits until all of them are running, which only succeeds
+  // if the tasks of different keys are executed at the same time
+  std::mutex mtx;
+  std::condition_variable cond;
+  int arrived = 0;
+  std::atomic<int> rendezvous(0);
+  std::vector<std::pair<uint64_t, CleanExecutor::Task>> tasks;
+  for (uint64_t key = 0; key < 4; key++) {
+    tasks.emplace_back(key, [&]() {
+      std::unique_lock<std::mutex> lk(mtx);
+      arrived++;
+      cond.notify_all();
+      if (cond.wait_for(lk, std::chrono::seconds(10),
+                        [&]() { return arrived == 4; })) {
+        rendezvous.fetch_add(1);
+      }
+    });
+  }
+
+  executor_.SubmitAndWait(std::move(tasks));
+  ASSERT_EQ(arrived, 4);
+  ASSERT_EQ(rendezvous.load(), 4);
+}
+
+TEST_F(CleanExecutorTest, Throttle) {
+  CleanExecutorOption option;
+  option.maxInodesPerSec = 100;
+  executor_.Init(option);
+  executor_.Start();
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 3; i++) {
+    executor_.Throttle(100);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start);
+  ASSERT_GE(elapsed.count(), 1000);
+}
+
+}  // namespace metaserver
+}  // namespace dingofs
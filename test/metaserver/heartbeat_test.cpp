@@ -24,6 +24,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <vector>
+
 #include "metaserver/resource_statistic.h"
 #include "metaserver/storage/storage.h"
 #include "metaserver/mock_heartbeat_service.h"
@@ -71,6 +73,23 @@ class HeartbeatTest : public ::testing::Test {
     return heartbeat.GetMetaserverSpaceStatus(status, ncopysets);
   }
 
+  // return the copysets included in the request
+  std::vector<uint32_t> ReportCopysets(
+      Heartbeat* heartbeat,
+      std::vector<pb::mds::heartbeat::CopySetInfo> infos) {
+    MetaServerHeartbeatRequest request;
+    heartbeat->AddCopysetInfos(&infos, &request);
+    std::vector<uint32_t> reported;
+    for (const auto& info : request.copysetinfos()) {
+      reported.push_back(info.copysetid());
+    }
+    return reported;
+  }
+
+  void AckRequest(Heartbeat* heartbeat) { heartbeat->AckRequest(); }
+
+  void ResetReported(Heartbeat* heartbeat) { heartbeat->ResetReported(); }
+
  protected:
   StorageOptions options_;
   std::unique_ptr<ResourceCollector> resourceCollector_;
@@ -213,6 +232,72 @@ TEST_F(HeartbeatTest, test_fail) {
   server.Join();
 }
 
+namespace {
+
+pb::mds::heartbeat::CopySetInfo GetCopysetInfo(uint32_t copysetId,
+                                               uint64_t epoch) {
+  pb::mds::heartbeat::CopySetInfo info;
+  info.set_poolid(1);
+  info.set_copysetid(copysetId);
+  info.set_epoch(epoch);
+  info.mutable_leaderpeer()->set_address("127.0.0.1:6000:0");
+  return info;
+}
+
+}  // namespace
+
+TEST_F(HeartbeatTest, DeltaReport) {
+  HeartbeatOptions options;
+  Heartbeat heartbeat;
+  options.ip = "127.0.0.1";
+  options.port = 6000;
+  options.mdsListenAddr = "127.0.0.1:6001";
+  options.storeUri = "local://metaserver_data/copysets";
+  options.deltaReport = true;
+  options.fullReportIntervalSec = 3600;
+  ASSERT_EQ(heartbeat.Init(options), 0);
+
+  using Reported = std::vector<uint32_t>;
+  std::vector<pb::mds::heartbeat::CopySetInfo> infos{
+      GetCopysetInfo(1, 1), GetCopysetInfo(2, 1), GetCopysetInfo(3, 1)};
+
+  // CASE 1: nothing acknowledged, full report
+  ASSERT_EQ(ReportCopysets(&heartbeat, infos), (Reported{1, 2, 3}));
+  ASSERT_EQ(ReportCopysets(&heartbeat, infos), (Reported{1, 2, 3}));
+  AckRequest(&heartbeat);
+
+  // CASE 2: only the changed copysets are reported
+  ASSERT_EQ(ReportCopysets(&heartbeat, infos), Reported{});
+  AckRequest(&heartbeat);
+  infos[1].set_epoch(2);
+  ASSERT_EQ(ReportCopysets(&heartbeat, infos), Reported{2});
+  AckRequest(&heartbeat);
+  ASSERT_EQ(ReportCopysets(&heartbeat, infos), Reported{});
+
+  // CASE 3: the change is reported again until it is acknowledged
+  infos[0].set_epoch(2);
+  ASSERT_EQ(ReportCopysets(&heartbeat, infos), Reported{1});
+  ASSERT_EQ(ReportCopysets(&heartbeat, infos), Reported{1});
+  AckRequest(&heartbeat);
+
+  // CASE 4: new copyset and copyset under configuration change are reported
+  infos.push_back(GetCopysetInfo(4, 1));
+  auto* change = infos[2].mutable_configchangeinfo();
+  change->mutable_peer()->set_address("127.0.0.1:6002:0");
+  change->set_type(pb::mds::heartbeat::ConfigChangeType::ADD_PEER);
+  change->set_finished(false);
+  ASSERT_EQ(ReportCopysets(&heartbeat, infos), (Reported{3, 4}));
+  AckRequest(&heartbeat);
+  ASSERT_EQ(ReportCopysets(&heartbeat, infos), Reported{3});
+  AckRequest(&heartbeat);
+
+  // CASE 5: full report after mds rejects the request
+  ResetReported(&heartbeat);
+  ASSERT_EQ(ReportCopysets(&heartbeat, infos), (Reported{1, 2, 3, 4}));
+  AckRequest(&heartbeat);
+  ASSERT_EQ(ReportCopysets(&heartbeat, infos), Reported{3});
+}
+
 TEST_F(HeartbeatTest, GetMetaServerSpaceStatusTest) {
   StorageStatistics statistics;
   bool succ = resourceCollector_->GetResourceStatistic(&statistics);
@@ -31,6 +31,7 @@
 #include <ostream>
 #include <random>
 #include <string>
+#include <unordered_map>
 
 #include "fs/ext4_filesystem_impl.h"
 #include "metaserver/mock/mock_kv_storage.h"
@@ -49,6 +50,7 @@ using ::testing::Return;
 using ::dingofs::metaserver::storage::Converter;
 using ::dingofs::metaserver::storage::Key4Inode;
 using ::dingofs::metaserver::storage::Key4S3ChunkInfoList;
+using ::dingofs::metaserver::storage::Key4TrashItem;
 using ::dingofs::metaserver::storage::KVStorage;
 using ::dingofs::metaserver::storage::NameGenerator;
 using ::dingofs::metaserver::storage::RandomStoragePath;
@@ -328,6 +330,73 @@ TEST_F(InodeStorageTest, testGetAttr) {
   ASSERT_EQ(attr.mode(), 777);
 }
 
+TEST_F(InodeStorageTest, testRowCache) {
+  InodeStorage storage(kvStorage_, nameGenerator_, 0);
+  Inode inode = GenInode(1, 1);
+  inode.set_atime(100);
+  ASSERT_EQ(storage.Insert(inode), MetaStatusCode::OK);
+
+  // update should invalidate the cached inode
+  InodeAttr attr;
+  ASSERT_EQ(storage.GetAttr(Key4Inode(inode), &attr), MetaStatusCode::OK);
+  ASSERT_EQ(attr.atime(), 100);
+  inode.set_atime(200);
+  ASSERT_EQ(storage.Update(inode), MetaStatusCode::OK);
+  ASSERT_EQ(storage.GetAttr(Key4Inode(inode), &attr), MetaStatusCode::OK);
+  ASSERT_EQ(attr.atime(), 200);
+
+  // modify the storage out of InodeStorage, e.g. recover from snapshot
+  inode.set_atime(300);
+  ASSERT_TRUE(kvStorage_
+                  ->HSet(nameGenerator_->GetInodeTableName(),
+                         conv_->SerializeToString(Key4Inode(inode)), inode)
+                  .ok());
+  ASSERT_EQ(storage.GetAttr(Key4Inode(inode), &attr), MetaStatusCode::OK);
+  ASSERT_EQ(attr.atime(), 200);
+  storage.InvalidateCache();
+  ASSERT_EQ(storage.GetAttr(Key4Inode(inode), &attr), MetaStatusCode::OK);
+  ASSERT_EQ(attr.atime(), 300);
+
+  // delete
+  ASSERT_EQ(storage.Delete(Key4Inode(inode)), MetaStatusCode::OK);
+  ASSERT_EQ(storage.GetAttr(Key4Inode(inode), &attr),
+            MetaStatusCode::NOT_FOUND);
+}
+
+TEST_F(InodeStorageTest, testMigrateTrashItems) {
+  InodeStorage storage(kvStorage_, nameGenerator_, 0);
+  Inode unlinked = GenInode(1, 1);
+  unlinked.set_nlink(0);
+  unlinked.set_dtime(100);
+  Inode linked = GenInode(1, 2);
+  linked.set_nlink(1);
+  ASSERT_EQ(storage.Insert(unlinked), MetaStatusCode::OK);
+  ASSERT_EQ(storage.Insert(linked), MetaStatusCode::OK);
+
+  auto listItems = [&]() {
+    std::vector<uint64_t> inodeIds;
+    auto iterator = storage.GetAllTrashItem();
+    Key4TrashItem key;
+    for (iterator->SeekToFirst(); iterator->Valid(); iterator->Next()) {
+      EXPECT_TRUE(conv_->ParseFromString(iterator->Key(), &key));
+      EXPECT_EQ(key.dtime, 100);
+      inodeIds.push_back(key.inodeId);
+    }
+    return inodeIds;
+  };
+
+  // the inode written by older version has no trash item
+  ASSERT_TRUE(listItems().empty());
+  ASSERT_EQ(storage.MigrateTrashItems(), MetaStatusCode::OK);
+  ASSERT_EQ(listItems(), std::vector<uint64_t>{1});
+
+  // only once, the deleted item is never added back
+  ASSERT_EQ(storage.DeleteTrashItem(Key4TrashItem(100, 1, 1)),
+            MetaStatusCode::OK);
+  ASSERT_EQ(storage.MigrateTrashItems(), MetaStatusCode::OK);
+  ASSERT_TRUE(listItems().empty());
+}
+
 TEST_F(InodeStorageTest, testGetXAttr) {
   InodeStorage storage(kvStorage_, nameGenerator_, 0);
   Inode inode;
@@ -371,6 +440,24 @@ TEST_F(InodeStorageTest, testGetXAttr) {
   ASSERT_EQ(xattr.xattrinfos().find(XATTR_DIR_RFBYTES)->second, "1000");
 }
 
+TEST_F(InodeStorageTest, GetAllInodeS3MetaSize) {
+  InodeStorage storage(kvStorage_, nameGenerator_, 0);
+  auto list = GenS3ChunkInfoList(1, 3);
+  ASSERT_EQ(storage.ModifyInodeS3ChunkInfoList(1, 1, 0, &list, nullptr),
+            MetaStatusCode::OK);
+  list = GenS3ChunkInfoList(4, 4);
+  ASSERT_EQ(storage.ModifyInodeS3ChunkInfoList(1, 1, 1, &list, nullptr),
+            MetaStatusCode::OK);
+  ASSERT_EQ(storage.ModifyInodeS3ChunkInfoList(1, 2, 0, &list, nullptr),
+            MetaStatusCode::OK);
+
+  std::unordered_map<uint64_t, uint64_t> sizes;
+  ASSERT_TRUE(storage.GetAllInodeS3MetaSize(&sizes));
+  ASSERT_EQ(sizes.size(), 2);
+  ASSERT_EQ(sizes[1], 4);
+  ASSERT_EQ(sizes[2], 1);
+}
+
 TEST_F(InodeStorageTest, ModifyInodeS3ChunkInfoList) {
   uint32_t fsId = 1;
   uint64_t inodeId = 1;
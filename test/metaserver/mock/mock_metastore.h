@@ -119,6 +119,7 @@ class MockMetaStore : public dingofs::metaserver::MetaStore {
   MOCK_METHOD2(PrepareRenameTx,
                MetaStatusCode(const pb::metaserver::PrepareRenameTxRequest*,
                               pb::metaserver::PrepareRenameTxResponse*));
+  MOCK_METHOD2(GetExpiredRenameTxs, void(uint64_t, std::vector<ShardedTx>*));
 
   MOCK_METHOD0(GetStreamServer, std::shared_ptr<common::StreamServer>());
 
@@ -203,6 +203,36 @@ TEST_F(PartitionTest, testInodeIdGen5_paritionstatus) {
   ASSERT_EQ(partition1.GetPartitionInfo().status(), PartitionStatus::READONLY);
 }
 
+TEST_F(PartitionTest, testShrinkRange) {
+  PartitionInfo partitionInfo1;
+  partitionInfo1.set_fsid(1);
+  partitionInfo1.set_poolid(2);
+  partitionInfo1.set_copysetid(3);
+  partitionInfo1.set_partitionid(4);
+  partitionInfo1.set_start(100);
+  partitionInfo1.set_end(199);
+  partitionInfo1.set_nextid(150);
+  partitionInfo1.set_status(PartitionStatus::READWRITE);
+
+  Partition partition1(partitionInfo1, kvStorage_);
+
+  // the ids below next id are allocated already
+  ASSERT_EQ(partition1.ShrinkRange(99), MetaStatusCode::PARAM_ERROR);
+  ASSERT_EQ(partition1.ShrinkRange(148), MetaStatusCode::PARAM_ERROR);
+  ASSERT_EQ(partition1.GetPartitionInfo().end(), 199);
+
+  ASSERT_EQ(partition1.ShrinkRange(159), MetaStatusCode::OK);
+  ASSERT_EQ(partition1.GetPartitionInfo().end(), 159);
+  ASSERT_TRUE(partition1.IsInodeBelongs(1, 159));
+  ASSERT_FALSE(partition1.IsInodeBelongs(1, 160));
+  ASSERT_EQ(partition1.GetPartitionInfo().status(), PartitionStatus::READWRITE);
+
+  // no free id left
+  ASSERT_EQ(partition1.ShrinkRange(149), MetaStatusCode::OK);
+  ASSERT_EQ(partition1.GetPartitionInfo().status(), PartitionStatus::READONLY);
+  ASSERT_EQ(partition1.GetNewInodeId(), UINT64_MAX);
+}
+
 TEST_F(PartitionTest, test1) {
   PartitionInfo partitionInfo1;
   partitionInfo1.set_fsid(1);
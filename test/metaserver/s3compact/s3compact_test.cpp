@@ -23,13 +23,21 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
+#include "common/s3util.h"
 #include "fs/ext4_filesystem_impl.h"
 #include "metaserver/mock_metaserver_s3_adaptor.h"
 #include "metaserver/s3compact/mock_s3_adapter.h"
 #include "metaserver/s3compact/mock_s3compact_inode.h"
 #include "metaserver/s3compact/mock_s3infocache.h"
+#include "metaserver/s3compact_dedup.h"
 #include "metaserver/s3compact_inode.h"
 #include "metaserver/s3compact_manager.h"
 #include "metaserver/s3compact_worker.h"
@@ -483,72 +491,265 @@ TEST_F(S3CompactTest, test_BuildValidList) {
   ASSERT_TRUE(validList.empty());
 }
 
-TEST_F(S3CompactTest, test_ReadFullChunk) {
+TEST_F(S3CompactTest, test_StreamMergeChunk) {
   int ret;
   std::list<struct CompactInodeJob::Node> validList;
   struct CompactInodeJob::S3CompactCtx ctx {
     1, 1, PartitionInfo(), 4, 64, 0, 0, s3adapter_.get()
   };
   struct CompactInodeJob::S3NewChunkInfo newChunkInfo;
-  std::string fullChunk;
+  uint64_t chunkLen;
+  std::vector<std::string> objsAdded;
+  std::map<std::string, std::string> objsPut;
+  std::mutex mtx;
 
   auto reset = [&]() {
     validList.clear();
-    fullChunk.clear();
     newChunkInfo = {};
+    chunkLen = 0;
+    objsAdded.clear();
+    objsPut.clear();
   };
 
-  EXPECT_CALL(*s3adapter_, DeleteObject(_)).WillRepeatedly(Return(0));
   auto mock_getobj = [&](const Aws::String& key, std::string* data) {
     data->clear();
-    data->append(ctx.blockSize, '\0');
+    data->append(ctx.blockSize, 'a');
+    return 0;
+  };
+  auto mock_putobj = [&](const Aws::String& key, const std::string& data) {
+    std::lock_guard<std::mutex> lk(mtx);
+    objsPut[std::string(key.c_str(), key.size())] = data;
     return 0;
   };
   EXPECT_CALL(*s3adapter_, GetObject(_, _))
       .WillRepeatedly(testing::Invoke(mock_getobj));
+  EXPECT_CALL(*s3adapter_, PutObject(_, _))
+      .WillRepeatedly(testing::Invoke(mock_putobj));
 
+  // CASE 1: zero range
   validList.emplace_back(0, 1, 0, 0, 0, 0, true);
-  ret = impl_->ReadFullChunk(ctx, validList, &fullChunk, &newChunkInfo);
+  ret = impl_->StreamMergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                                &objsAdded);
   ASSERT_EQ(ret, 0);
   ASSERT_EQ(newChunkInfo.newChunkId, 0);
   ASSERT_EQ(newChunkInfo.newCompaction, 1);
+  ASSERT_EQ(chunkLen, 2);
+  ASSERT_EQ(objsAdded.size(), 1);
+  ASSERT_EQ(objsPut[objsAdded[0]], std::string(2, '\0'));
 
+  // CASE 2: ranges with hole, written block by block
   reset();
   validList.emplace_back(0, 0, 1, 1, 0, 1, false);
   validList.emplace_back(1, 10, 0, 0, 1, 11, false);
   validList.emplace_back(13, 13, 2, 0, 13, 14, false);
-  ret = impl_->ReadFullChunk(ctx, validList, &fullChunk, &newChunkInfo);
+  ret = impl_->StreamMergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                                &objsAdded);
   ASSERT_EQ(ret, 0);
   ASSERT_EQ(newChunkInfo.newChunkId, 2);
   ASSERT_EQ(newChunkInfo.newCompaction, 1);
-  ASSERT_EQ(fullChunk.size(), 14);
+  ASSERT_EQ(chunkLen, 14);
+  ASSERT_EQ(objsAdded.size(), 4);
+  ASSERT_EQ(objsPut[objsAdded[0]], "aaaa");
+  ASSERT_EQ(objsPut[objsAdded[1]], "aaaa");
+  ASSERT_EQ(objsPut[objsAdded[2]], std::string("aaa\0", 4));
+  ASSERT_EQ(objsPut[objsAdded[3]], std::string("\0a", 2));
+
+  // CASE 3: names of new objs, only one block in flight
+  reset();
+  workerOptions_.maxInflightBlocks = 1;
+  ctx.inodeId = 100;
+  ctx.chunkSize = 16;
+  validList.emplace_back(0, 9, 2, 2, 0, 10, false);
+  ret = impl_->StreamMergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                                &objsAdded);
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(chunkLen, 10);
+  ASSERT_EQ(objsAdded.size(), 3);
+  ASSERT_EQ(objsAdded[0], "1_100_2_0_3");
+  ASSERT_EQ(objsAdded[1], "1_100_2_1_3");
+  ASSERT_EQ(objsAdded[2], "1_100_2_2_3");
+
+  // CASE 4: write failed
+  reset();
+  EXPECT_CALL(*s3adapter_, PutObject(_, _)).WillRepeatedly(Return(-1));
+  validList.emplace_back(0, 9, 2, 2, 0, 10, false);
+  ret = impl_->StreamMergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                                &objsAdded);
+  ASSERT_EQ(ret, -1);
+  ASSERT_TRUE(objsAdded.empty());
 
+  // CASE 5: read failed
   reset();
   EXPECT_CALL(*s3adapter_, GetObject(_, _)).WillRepeatedly(Return(-1));
   validList.emplace_back(0, 1, 1, 1, 0, 0, false);
-  ret = impl_->ReadFullChunk(ctx, validList, &fullChunk, &newChunkInfo);
+  ret = impl_->StreamMergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                                &objsAdded);
+  ASSERT_EQ(ret, -1);
+
+  // CASE 6: obj is shorter than expected
+  reset();
+  auto mock_getshortobj = [&](const Aws::String& key, std::string* data) {
+    data->assign(1, 'a');
+    return 0;
+  };
+  EXPECT_CALL(*s3adapter_, GetObject(_, _))
+      .WillRepeatedly(testing::Invoke(mock_getshortobj));
+  validList.emplace_back(0, 3, 1, 0, 0, 4, false);
+  ret = impl_->StreamMergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                                &objsAdded);
   ASSERT_EQ(ret, -1);
 }
 
-TEST_F(S3CompactTest, test_WriteFullChunk) {
-  struct CompactInodeJob::S3CompactCtx ctx {
-    100, 1, PartitionInfo(), 4, 16, 0, 0, s3adapter_.get()
+TEST_F(S3CompactTest, test_StreamMergeChunkCopyInS3) {
+  aws::FakeS3Adapter fakeS3(true);
+  S3DedupTable dedupTable(100);
+  workerOptions_.serverSideCopyMinBytes = 1;
+  workerOptions_.dedupTable = &dedupTable;
+  const uint64_t blockSize = 8;
+  const uint64_t chunkSize = 64;
+
+  auto put = [&](uint64_t inodeId, uint64_t chunkid, uint64_t index,
+                 const std::string& data) {
+    auto name =
+        common::s3util::GenObjName(chunkid, index, 0, 1, inodeId, 0);
+    ASSERT_EQ(fakeS3.PutObject(Aws::String(name.c_str()), data), 0);
   };
-  struct CompactInodeJob::S3NewChunkInfo newChunkInfo {
-    2, 0, 3
+  auto get = [&](uint64_t inodeId, uint64_t index) {
+    auto name = common::s3util::GenObjName(4, index, 1, 1, inodeId, 0);
+    std::string data;
+    EXPECT_EQ(fakeS3.GetObject(Aws::String(name.c_str()), &data), 0);
+    return data;
   };
-  EXPECT_CALL(*s3adapter_, PutObject(_, _)).WillRepeatedly(Return(0));
-  std::string fullChunk(10, '0');
+  auto add = [](S3ChunkInfoList* l, uint64_t chunkid, uint64_t offset,
+                uint64_t len) {
+    auto* ref = l->add_s3chunks();
+    ref->set_chunkid(chunkid);
+    ref->set_compaction(0);
+    ref->set_offset(offset);
+    ref->set_len(len);
+    ref->set_size(len);
+    ref->set_zero(false);
+  };
+
+  // chunk 1: [0, 16), chunk 2: [4, 12), chunk 3: [16, 32), chunk 4: [32, 36)
+  S3ChunkInfoList l;
+  add(&l, 1, 0, 16);
+  add(&l, 2, 4, 8);
+  add(&l, 3, 16, 16);
+  add(&l, 4, 32, 4);
+  auto& metric = S3CompactMetric::GetInstance();
+  for (uint64_t inodeId : {1, 2}) {
+    put(inodeId, 1, 0, "AAAAAAAA");
+    put(inodeId, 1, 1, "BBBBBBBB");
+    put(inodeId, 2, 0, "cccc");
+    put(inodeId, 2, 1, "dddd");
+    put(inodeId, 3, 2, "EEEEEEEE");
+    put(inodeId, 3, 3, "FFFFFFFF");
+    put(inodeId, 4, 4, "gggg");
+
+    struct CompactInodeJob::S3CompactCtx ctx {
+      inodeId, 1, PartitionInfo(), blockSize, chunkSize, 0, 0, &fakeS3
+    };
+    auto validList = impl_->BuildValidList(l, 36, 0, chunkSize);
+    struct CompactInodeJob::S3NewChunkInfo newChunkInfo;
+    uint64_t chunkLen;
+    std::vector<std::string> objsAdded;
+    uint64_t copied = metric.copiedBytes.get_value();
+    uint64_t dedup = metric.dedupBytes.get_value();
+    int ret = impl_->StreamMergeChunk(ctx, validList, &newChunkInfo,
+                                      &chunkLen, &objsAdded);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(chunkLen, 36);
+    ASSERT_EQ(objsAdded.size(), 5);
+    ASSERT_EQ(get(inodeId, 0), "AAAAcccc");
+    ASSERT_EQ(get(inodeId, 1), "ddddBBBB");
+    ASSERT_EQ(get(inodeId, 2), "EEEEEEEE");
+    ASSERT_EQ(get(inodeId, 3), "FFFFFFFF");
+    ASSERT_EQ(get(inodeId, 4), "gggg");
+    // blocks 2, 3 and 4 are copied from old objs inside s3
+    ASSERT_EQ(metric.copiedBytes.get_value() - copied, 20);
+    // blocks 0 and 1 of inode 2 are copied from the objs of inode 1
+    ASSERT_EQ(metric.dedupBytes.get_value() - dedup, inodeId == 1 ? 0 : 16);
+  }
+
+  // the identical obj is deleted, fall back to upload
+  auto name = common::s3util::GenObjName(4, 0, 1, 1, 1, 0);
+  ASSERT_EQ(fakeS3.DeleteObject(Aws::String(name.c_str())), 0);
+  put(3, 1, 0, "AAAAAAAA");
+  put(3, 1, 1, "BBBBBBBB");
+  put(3, 2, 0, "cccc");
+  put(3, 2, 1, "dddd");
+  put(3, 3, 2, "EEEEEEEE");
+  put(3, 3, 3, "FFFFFFFF");
+  put(3, 4, 4, "gggg");
+  struct CompactInodeJob::S3CompactCtx ctx {
+    3, 1, PartitionInfo(), blockSize, chunkSize, 0, 0, &fakeS3
+  };
+  auto validList = impl_->BuildValidList(l, 36, 0, chunkSize);
+  struct CompactInodeJob::S3NewChunkInfo newChunkInfo;
+  uint64_t chunkLen;
   std::vector<std::string> objsAdded;
-  int ret = impl_->WriteFullChunk(ctx, newChunkInfo, fullChunk, &objsAdded);
-  ASSERT_EQ(ret, 0);
-  ASSERT_EQ(objsAdded[0], "1_100_2_0_3");
-  ASSERT_EQ(objsAdded[1], "1_100_2_1_3");
-  ASSERT_EQ(objsAdded[2], "1_100_2_2_3");
+  ASSERT_EQ(impl_->StreamMergeChunk(ctx, validList, &newChunkInfo, &chunkLen,
+                                    &objsAdded),
+            0);
+  ASSERT_EQ(get(3, 0), "AAAAcccc");
+  ASSERT_EQ(get(3, 1), "ddddBBBB");
+}
 
-  EXPECT_CALL(*s3adapter_, PutObject(_, _)).WillRepeatedly(Return(-1));
-  ret = impl_->WriteFullChunk(ctx, newChunkInfo, fullChunk, &objsAdded);
-  ASSERT_EQ(ret, -1);
+TEST_F(S3CompactTest, test_CompactChunkRetained) {
+  struct CompactInodeJob::S3CompactCtx ctx {
+    1, 1, PartitionInfo(), 4, 64, 0, 0, s3adapter_.get()
+  };
+  EXPECT_CALL(*s3adapter_, GetObject(_, _)).Times(0);
+  EXPECT_CALL(*s3adapter_, PutObject(_, _)).Times(0);
+
+  auto add = [](S3ChunkInfoList* l, uint64_t chunkid, uint64_t offset,
+                uint64_t len) {
+    auto* ref = l->add_s3chunks();
+    ref->set_chunkid(chunkid);
+    ref->set_compaction(0);
+    ref->set_offset(offset);
+    ref->set_len(len);
+    ref->set_size(len);
+    ref->set_zero(false);
+  };
+
+  // [0, 16) is overwritten by 4 appends without partial overlap
+  Inode inode;
+  inode.set_length(16);
+  S3ChunkInfoList l;
+  add(&l, 1, 0, 16);
+  add(&l, 2, 0, 8);
+  add(&l, 4, 12, 4);
+  add(&l, 3, 8, 4);
+  (*inode.mutable_s3chunkinfomap())[0] = l;
+
+  std::unordered_map<uint64_t, std::vector<std::string>> objsAddedMap;
+  ::google::protobuf::Map<uint64_t, S3ChunkInfoList> s3ChunkInfoAdd;
+  ::google::protobuf::Map<uint64_t, S3ChunkInfoList> s3ChunkInfoRemove;
+  impl_->CompactChunk(ctx, 0, inode, &objsAddedMap, &s3ChunkInfoAdd,
+                      &s3ChunkInfoRemove);
+  ASSERT_TRUE(objsAddedMap.empty());
+  ASSERT_EQ(s3ChunkInfoRemove.at(0).s3chunks_size(), 4);
+  const auto& retained = s3ChunkInfoAdd.at(0);
+  ASSERT_EQ(retained.s3chunks_size(), 3);
+  ASSERT_EQ(retained.s3chunks(0).chunkid(), 2);
+  ASSERT_EQ(retained.s3chunks(1).chunkid(), 3);
+  ASSERT_EQ(retained.s3chunks(2).chunkid(), 4);
+
+  // only the objs of dropped s3chunkinfo are deleted
+  std::set<std::string> deleted;
+  auto mock_delobj = [&](const Aws::String& key) {
+    deleted.emplace(key.c_str(), key.size());
+    return 0;
+  };
+  EXPECT_CALL(*s3adapter_, DeleteObject(_))
+      .WillRepeatedly(testing::Invoke(mock_delobj));
+  impl_->DeleteObjsOfS3ChunkInfoList(ctx, l, retained);
+  ASSERT_EQ(deleted.size(), 4);
+  for (const auto& name : deleted) {
+    ASSERT_EQ(name.rfind("1_1_1_", 0), 0);
+  }
 }
 
 TEST_F(S3CompactTest, test_CompactChunks) {
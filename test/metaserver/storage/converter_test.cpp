@@ -111,6 +111,24 @@ TEST_F(ConverterTest, Key4InodeAuxInfo) {
   ASSERT_EQ(out.inodeId, 1);
 }
 
+TEST_F(ConverterTest, Key4TrashItem) {
+  Key4TrashItem key(100, 1, 2);
+  std::string skey = conv_.SerializeToString(key);
+  ASSERT_EQ(skey, "8:0000000100:1:2");
+
+  Key4TrashItem out;
+  ASSERT_TRUE(conv_.ParseFromString(skey, &out));
+  ASSERT_EQ(out.dtime, 100);
+  ASSERT_EQ(out.fsId, 1);
+  ASSERT_EQ(out.inodeId, 2);
+
+  // sorted by dtime
+  ASSERT_LT(conv_.SerializeToString(Key4TrashItem(9, 2, 2)),
+            conv_.SerializeToString(Key4TrashItem(10, 1, 1)));
+  ASSERT_LT(conv_.SerializeToString(Key4TrashItem(99999, 1, 1)),
+            conv_.SerializeToString(Key4TrashItem(UINT32_MAX, 1, 1)));
+}
+
 TEST_F(ConverterTest, NameGenerator) {
   NameGenerator ng(1);
   ASSERT_EQ(ng.GetFixedLength(), 6);
@@ -119,6 +137,14 @@ TEST_F(ConverterTest, NameGenerator) {
   ASSERT_EQ(ng.GetDentryTableName().size(), ng.GetFixedLength());
   ASSERT_EQ(ng.GetVolumeExtentTableName().size(), ng.GetFixedLength());
   ASSERT_EQ(ng.GetInodeAuxInfoTableName().size(), ng.GetFixedLength());
+  ASSERT_EQ(ng.GetTrashItemTableName().size(), ng.GetFixedLength());
+
+  ASSERT_EQ(NameGenerator::GetTableType(ng.GetInodeTableName()), kTypeInode);
+  ASSERT_EQ(NameGenerator::GetTableType(ng.GetDentryTableName()), kTypeDentry);
+  ASSERT_EQ(NameGenerator::GetTableType(ng.GetS3ChunkInfoTableName()),
+            kTypeS3ChunkInfo);
+  ASSERT_EQ(NameGenerator::GetTableType("1"), 0);
+  ASSERT_EQ(NameGenerator::GetTableType("partition:1"), 0);
 }
 
 }  // namespace storage
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <butil/time.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fs/ext4_filesystem_impl.h"
+#include "metaserver/storage/converter.h"
+#include "metaserver/storage/rocksdb_options.h"
+#include "metaserver/storage/rocksdb_storage.h"
+#include "metaserver/storage/storage_test.h"
+
+namespace dingofs {
+namespace metaserver {
+namespace storage {
+
+class RocksDBLayoutTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    dirname_ = ".db_layout_" + std::to_string(getpid());
+    options_.maxMemoryQuotaBytes = 32212254720;
+    options_.maxDiskQuotaBytes = 2199023255552;
+    options_.dataDir = dirname_ + "/rocksdb.db";
+    options_.compression = false;
+    options_.localFileSystem = localfs_.get();
+    ASSERT_EQ(localfs_->Mkdir(dirname_), 0);
+  }
+
+  void TearDown() override {
+    FLAGS_rocksdb_per_table_column_family = false;
+    if (kvStorage_ != nullptr) {
+      ASSERT_TRUE(kvStorage_->Close());
+    }
+    ASSERT_EQ(localfs_->Delete(dirname_), 0);
+  }
+
+  void Open(bool perTable) {
+    FLAGS_rocksdb_per_table_column_family = perTable;
+    kvStorage_ = std::make_shared<RocksDBStorage>(options_);
+    ASSERT_TRUE(kvStorage_->Open());
+  }
+
+  // reopen the database with another layout through checkpoint,
+  // just like the metaserver restart from the raft snapshot
+  void SwitchLayout(bool perTable) {
+    std::vector<std::string> files;
+    std::string checkpoint = dirname_ + "/checkpoint";
+    ASSERT_TRUE(kvStorage_->Checkpoint(checkpoint, &files));
+    FLAGS_rocksdb_per_table_column_family = perTable;
+    ASSERT_TRUE(kvStorage_->Recover(checkpoint));
+    ASSERT_EQ(localfs_->Delete(checkpoint), 0);
+  }
+
+  void CheckTables(const NameGenerator& gen) {
+    Dentry value;
+    ASSERT_EQ(kvStorage_->HSize(gen.GetInodeTableName()), 100);
+    for (int i = 0; i < 100; i++) {
+      auto key = Key4Inode(1, i).SerializeToString();
+      ASSERT_TRUE(kvStorage_->HGet(gen.GetInodeTableName(), key, &value).ok());
+      ASSERT_EQ(value, Value(key));
+    }
+
+    ASSERT_EQ(kvStorage_->SSize(gen.GetDentryTableName()), 100);
+    for (int parent = 0; parent < 10; parent++) {
+      auto prefix = Prefix4SameParentDentry(1, parent).SerializeToString();
+      auto iter = kvStorage_->SSeek(gen.GetDentryTableName(), prefix);
+      ASSERT_EQ(iter->Status(), 0);
+      int n = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        ASSERT_EQ(iter->Key().rfind(prefix, 0), 0);
+        n++;
+      }
+      ASSERT_EQ(n, 10);
+    }
+
+    auto iter = kvStorage_->SGetAll(gen.GetDentryTableName());
+    int n = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      n++;
+    }
+    ASSERT_EQ(n, 100);
+
+    ASSERT_EQ(kvStorage_->SSize(gen.GetS3ChunkInfoTableName()), 10);
+    ASSERT_EQ(kvStorage_->HSize(gen.GetInodeAuxInfoTableName()), 1);
+  }
+
+ protected:
+  std::string dirname_;
+  StorageOptions options_;
+  std::shared_ptr<KVStorage> kvStorage_;
+  std::shared_ptr<fs::LocalFileSystem> localfs_ =
+      fs::Ext4FileSystemImpl::getInstance();
+};
+
+TEST_F(RocksDBLayoutTest, DentryPrefixTransform) {
+  std::string table = NameGenerator(1).GetDentryTableName();
+  std::string ikey = "1:" + table + ":0:";
+  std::unique_ptr<const rocksdb::SliceTransform> transform(
+      NewDentryPrefixTransform(ikey.size()));
+
+  auto key = ikey + Key4Dentry(1, 100, "a:b").SerializeToString();
+  auto prefix = ikey + Prefix4SameParentDentry(1, 100).SerializeToString();
+  ASSERT_TRUE(transform->InDomain(key));
+  ASSERT_EQ(transform->Transform(key).ToString(), prefix);
+  ASSERT_EQ(transform->Transform(prefix).ToString(), prefix);
+
+  // seek all dentries of table is out of domain
+  ASSERT_FALSE(transform->InDomain(ikey));
+  ASSERT_FALSE(transform->InDomain(ikey + "3:1:100"));
+}
+
+TEST_F(RocksDBLayoutTest, MigrateColumnFamilies) {
+  NameGenerator gen(1);
+  Open(false);
+  for (int i = 0; i < 100; i++) {
+    auto ikey = Key4Inode(1, i).SerializeToString();
+    ASSERT_TRUE(
+        kvStorage_->HSet(gen.GetInodeTableName(), ikey, Value(ikey)).ok());
+    auto dkey = Key4Dentry(1, i / 10, std::to_string(i)).SerializeToString();
+    ASSERT_TRUE(
+        kvStorage_->SSet(gen.GetDentryTableName(), dkey, Value(dkey)).ok());
+  }
+  for (int i = 0; i < 10; i++) {
+    auto key = "chunk" + std::to_string(i);
+    ASSERT_TRUE(
+        kvStorage_->SSet(gen.GetS3ChunkInfoTableName(), key, Value(key)).ok());
+  }
+  ASSERT_TRUE(
+      kvStorage_->HSet(gen.GetInodeAuxInfoTableName(), "aux", Value("aux"))
+          .ok());
+  CheckTables(gen);
+
+  // CASE 1: shared => per table
+  SwitchLayout(true);
+  CheckTables(gen);
+
+  // CASE 2: reopen with the same layout
+  SwitchLayout(true);
+  CheckTables(gen);
+
+  // CASE 3: per table => shared
+  SwitchLayout(false);
+  CheckTables(gen);
+
+  // CASE 4: counters still work after migration
+  auto key = Key4Inode(1, 100).SerializeToString();
+  ASSERT_TRUE(kvStorage_->HSet(gen.GetInodeTableName(), key, Value(key)).ok());
+  ASSERT_EQ(kvStorage_->HSize(gen.GetInodeTableName()), 101);
+}
+
+// Mixed workload of metaserver: inode point lookups, dentry listing and
+// s3chunkinfo appends, both layouts should see exactly the same data.
+TEST_F(RocksDBLayoutTest, MixedWorkload) {
+  const uint64_t kInodes = 2000;
+  const uint64_t kRounds = 2000;
+  double elapsedUs[2];
+  for (bool perTable : {false, true}) {
+    NameGenerator gen(1);
+    options_.dataDir = dirname_ + (perTable ? "/per_table.db" : "/shared.db");
+    Open(perTable);
+    for (uint64_t i = 0; i < kInodes; i++) {
+      auto ikey = Key4Inode(1, i).SerializeToString();
+      ASSERT_TRUE(
+          kvStorage_->HSet(gen.GetInodeTableName(), ikey, Value(ikey)).ok());
+      auto dkey =
+          Key4Dentry(1, i / 100, std::to_string(i)).SerializeToString();
+      ASSERT_TRUE(
+          kvStorage_->SSet(gen.GetDentryTableName(), dkey, Value(dkey)).ok());
+    }
+
+    Dentry value;
+    butil::Timer timer;
+    timer.start();
+    for (uint64_t i = 0; i < kRounds; i++) {
+      auto ikey = Key4Inode(1, (i * 7919) % kInodes).SerializeToString();
+      ASSERT_TRUE(kvStorage_->HGet(gen.GetInodeTableName(), ikey, &value).ok());
+      ASSERT_EQ(value, Value(ikey));
+
+      if (i % 10 == 0) {
+        auto prefix = Prefix4SameParentDentry(1, (i / 10) % (kInodes / 100))
+                          .SerializeToString();
+        auto iter = kvStorage_->SSeek(gen.GetDentryTableName(), prefix);
+        ASSERT_EQ(iter->Status(), 0);
+        uint64_t n = 0;
+        for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+          ASSERT_EQ(iter->Key().rfind(prefix, 0), 0);
+          n++;
+        }
+        ASSERT_EQ(n, 100);
+      }
+
+      auto ckey = "chunk" + std::to_string(i);
+      ASSERT_TRUE(
+          kvStorage_->SSet(gen.GetS3ChunkInfoTableName(), ckey, Value(ckey))
+              .ok());
+    }
+    timer.stop();
+    elapsedUs[perTable] = static_cast<double>(timer.u_elapsed()) / kRounds;
+
+    ASSERT_EQ(kvStorage_->HSize(gen.GetInodeTableName()), kInodes);
+    ASSERT_EQ(kvStorage_->SSize(gen.GetDentryTableName()), kInodes);
+    ASSERT_EQ(kvStorage_->SSize(gen.GetS3ChunkInfoTableName()), kRounds);
+    ASSERT_TRUE(kvStorage_->Close());
+    kvStorage_ = nullptr;
+  }
+
+  LOG(INFO) << "mixed workload of " << kRounds
+            << " rounds, shared column family: " << elapsedUs[false]
+            << " us/round, per-table column families: " << elapsedUs[true]
+            << " us/round";
+}
+
+}  // namespace storage
+}  // namespace metaserver
+}  // namespace dingofs
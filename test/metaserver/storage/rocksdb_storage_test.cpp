@@ -175,6 +175,45 @@ TEST_F(RocksDBStorageTest, HClearTestSMixOperator) {
 }
 TEST_F(RocksDBStorageTest, Transaction) { TestTransaction(kvStorage_); }
 
+TEST_F(RocksDBStorageTest, TableCounter) {
+  std::string tablename = "partition:1";
+
+  // overwrite the existing key should not change the counter
+  ASSERT_TRUE(kvStorage_->HSet(tablename, "key1", Value("value1")).ok());
+  ASSERT_TRUE(kvStorage_->HSet(tablename, "key1", Value("value2")).ok());
+  ASSERT_TRUE(kvStorage_->HSet(tablename, "key2", Value("value2")).ok());
+  ASSERT_EQ(kvStorage_->HSize(tablename), 2);
+  ASSERT_EQ(kvStorage_->SSize(tablename), 0);
+
+  // delete the non-existent key should not change the counter
+  ASSERT_TRUE(kvStorage_->HDel(tablename, "key3").ok());
+  ASSERT_EQ(kvStorage_->HSize(tablename), 2);
+
+  // rollback
+  auto txn = kvStorage_->BeginTransaction();
+  ASSERT_NE(txn, nullptr);
+  ASSERT_TRUE(txn->HSet(tablename, "key3", Value("value3")).ok());
+  ASSERT_TRUE(txn->HDel(tablename, "key1").ok());
+  ASSERT_TRUE(txn->HDel(tablename, "key2").ok());
+  ASSERT_EQ(txn->HSize(tablename), 1);
+  ASSERT_TRUE(txn->Rollback().ok());
+  ASSERT_EQ(kvStorage_->HSize(tablename), 2);
+
+  // commit
+  txn = kvStorage_->BeginTransaction();
+  ASSERT_NE(txn, nullptr);
+  ASSERT_TRUE(txn->HSet(tablename, "key3", Value("value3")).ok());
+  ASSERT_TRUE(txn->HSet(tablename, "key4", Value("value4")).ok());
+  ASSERT_TRUE(txn->HDel(tablename, "key1").ok());
+  ASSERT_TRUE(txn->Commit().ok());
+  ASSERT_EQ(kvStorage_->HSize(tablename), 3);
+
+  ASSERT_TRUE(kvStorage_->HClear(tablename).ok());
+  ASSERT_EQ(kvStorage_->HSize(tablename), 0);
+  ASSERT_TRUE(kvStorage_->HSet(tablename, "key1", Value("value1")).ok());
+  ASSERT_EQ(kvStorage_->HSize(tablename), 1);
+}
+
 TEST_F(RocksDBStorageTest, TestCleanOpen) {
   ASSERT_TRUE(kvStorage_->Close());
 
@@ -286,6 +325,10 @@ TEST_F(RocksDBStorageTest, TestCheckpointAndRecover) {
 
   kvStorage_->SGet("7", "7", &dummyDentry);
   EXPECT_EQ(Value("7"), dummyDentry);
+
+  // table counters are recovered from checkpoint
+  EXPECT_EQ(kvStorage_->SSize("1"), 1);
+  EXPECT_EQ(kvStorage_->SSize("3"), 0);
 }
 
 }  // namespace storage
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metaserver/storage/row_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+namespace dingofs {
+namespace metaserver {
+namespace storage {
+
+using pb::metaserver::InodeAttr;
+
+namespace {
+
+InodeRowCache::ValueType NewAttr(uint64_t inodeId) {
+  auto attr = std::make_shared<InodeAttr>();
+  attr->set_fsid(1);
+  attr->set_inodeid(inodeId);
+  return attr;
+}
+
+}  // namespace
+
+TEST(RowCacheTest, Basic) {
+  InodeRowCache cache("row_cache_test_basic", 1 << 20, 4);
+  ASSERT_TRUE(cache.Enabled());
+
+  InodeRowCache::ValueType out;
+  ASSERT_FALSE(cache.Get("1", &out));
+  cache.Put("1", NewAttr(1));
+  ASSERT_TRUE(cache.Get("1", &out));
+  ASSERT_EQ(out->inodeid(), 1);
+  ASSERT_DOUBLE_EQ(cache.HitRatio(), 0.5);
+
+  cache.Remove("1");
+  ASSERT_FALSE(cache.Get("1", &out));
+}
+
+TEST(RowCacheTest, BoundedByBytes) {
+  // room for exactly two entries
+  uint64_t bytes = 1 + NewAttr(1)->SpaceUsedLong();
+  InodeRowCache cache("row_cache_test_bounded", bytes * 2, 1);
+  InodeRowCache::ValueType out;
+  cache.Put("1", NewAttr(1));
+  cache.Put("2", NewAttr(2));
+  ASSERT_TRUE(cache.Get("1", &out));  // "2" becomes the least recently used
+  cache.Put("3", NewAttr(3));
+  ASSERT_TRUE(cache.Get("1", &out));
+  ASSERT_FALSE(cache.Get("2", &out));
+  ASSERT_TRUE(cache.Get("3", &out));
+
+  // the value larger than the capacity is never cached
+  auto large = std::make_shared<InodeAttr>(*NewAttr(4));
+  large->set_symlink(std::string(bytes * 2, 'x'));
+  cache.Put("4", large);
+  ASSERT_FALSE(cache.Get("4", &out));
+  ASSERT_TRUE(cache.Get("1", &out));
+  ASSERT_TRUE(cache.Get("3", &out));
+}
+
+TEST(RowCacheTest, Disabled) {
+  InodeRowCache cache("row_cache_test_disabled", 0, 4);
+  ASSERT_FALSE(cache.Enabled());
+
+  InodeRowCache::ValueType out;
+  cache.Put("1", NewAttr(1));
+  ASSERT_FALSE(cache.Get("1", &out));
+}
+
+TEST(RowCacheTest, TableId) {
+  uint64_t id1 = NewRowCacheTableId();
+  uint64_t id2 = NewRowCacheTableId();
+  ASSERT_NE(id1, id2);
+  ASSERT_NE(RowCacheKey(id1, "key"), RowCacheKey(id2, "key"));
+  ASSERT_EQ(RowCacheKey(id1, "key"), RowCacheKey(id1, "key"));
+}
+
+}  // namespace storage
+}  // namespace metaserver
+}  // namespace dingofs
@@ -31,6 +31,7 @@
 #include "metaserver/storage/storage.h"
 #include "metaserver/storage/test_utils.h"
 #include "dingofs/metaserver.pb.h"
+#include "stub/common/rename_tx.h"
 
 namespace dingofs {
 namespace metaserver {
@@ -44,6 +45,8 @@ using ::dingofs::metaserver::storage::StorageOptions;
 using ::dingofs::pb::metaserver::Dentry;
 using ::dingofs::pb::metaserver::DentryFlag;
 using ::dingofs::pb::metaserver::MetaStatusCode;
+using ::dingofs::stub::common::EncodeShardedTx;
+using ::dingofs::stub::common::ShardedTxOp;
 
 using TX_OP_TYPE = DentryStorage::TX_OP_TYPE;
 
@@ -113,6 +116,21 @@ class TransactionTest : public ::testing::Test {
     ASSERT_EQ(storage->Size(), dentrys.size());
   }
 
+  std::vector<Dentry> GenShardedTx(uint64_t txId, std::vector<Dentry> dentrys) {
+    for (auto& dentry : dentrys) {
+      dentry.set_txsequence(txId);
+    }
+    return dentrys;
+  }
+
+  // the partition which owns the dentrys under `parentId`
+  std::shared_ptr<TxManager> NewPartitionTxManager(uint64_t parentId) {
+    return std::make_shared<TxManager>(
+        dentryStorage_, [parentId](const Dentry& dentry) {
+          return dentry.parentinodeid() == parentId;
+        });
+  }
+
   void ASSERT_DENTRYS_EQ(const std::vector<Dentry>& lhs,
                          const std::vector<Dentry>&& rhs) {
     ASSERT_EQ(lhs, rhs);
@@ -354,5 +372,259 @@ TEST_F(TransactionTest, HandleTxWithTargetExist) {
   ASSERT_EQ(dentryStorage_->Size(), 3);  // /B /B/A /C(pending)
 }
 
+TEST_F(TransactionTest, ShardedTxInSamePartition) {
+  InsertDentrys(dentryStorage_,
+                std::vector<Dentry>{
+                    // { fsId, parentId, name, txId, inodeId, flag }
+                    GenDentry(1, 0, "A", 0, 1, 0),
+                    GenDentry(1, 0, "B", 0, 2, 0),
+                });
+
+  // step-1: commit on coordinator directly (rename A B)
+  auto tx = GenShardedTx(100, std::vector<Dentry>{
+                                  GenDentry(1, 0, "A", 0, 1, DELETE_FLAG),
+                                  GenDentry(1, 0, "B", 0, 1, 0),
+                              });
+  auto rc = txManager_->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kCommit, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+
+  // step-2: the dentrys are visible with the old txid
+  auto dentry = GenDentry(1, 0, "A", 0, 0, 0);
+  ASSERT_EQ(dentryManager_->GetDentry(&dentry), MetaStatusCode::NOT_FOUND);
+  dentry = GenDentry(1, 0, "B", 0, 0, 0);
+  ASSERT_EQ(dentryManager_->GetDentry(&dentry), MetaStatusCode::OK);
+  ASSERT_EQ(dentry.inodeid(), 1);
+  ASSERT_EQ(dentryStorage_->Size(), 1);
+
+  // step-3: retry is idempotent, abort fails after committed
+  rc = txManager_->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kCommit, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+  rc = txManager_->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kAbort, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::HANDLE_TX_FAILED);
+
+  // step-4: the decision is dropped by forget
+  std::vector<ShardedTx> expired;
+  txManager_->GetExpiredShardedTxs(0, &expired);
+  ASSERT_EQ(expired.size(), 1);
+  ASSERT_TRUE(expired[0].decided);
+  rc = txManager_->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kForget, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+  expired.clear();
+  txManager_->GetExpiredShardedTxs(0, &expired);
+  ASSERT_TRUE(expired.empty());
+
+  // step-5: the source has been renamed by others
+  tx = GenShardedTx(101, std::vector<Dentry>{
+                             GenDentry(1, 0, "A", 0, 1, DELETE_FLAG),
+                             GenDentry(1, 0, "C", 0, 1, 0),
+                         });
+  rc = txManager_->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kCommit, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::HANDLE_TX_FAILED);
+  ASSERT_EQ(dentryStorage_->Size(), 1);
+}
+
+TEST_F(TransactionTest, ShardedTxAcrossPartitions) {
+  InsertDentrys(dentryStorage_,
+                std::vector<Dentry>{
+                    // { fsId, parentId, name, txId, inodeId, flag }
+                    GenDentry(1, 0, "A", 0, 1, 0),
+                });
+  auto coordinator = NewPartitionTxManager(0);
+  auto participant = NewPartitionTxManager(2);
+  auto participantDentry =
+      std::make_shared<DentryManager>(dentryStorage_, participant);
+
+  // step-1: prepare on participant, then on coordinator (rename /A /2/A)
+  auto tx = GenShardedTx(100, std::vector<Dentry>{
+                                  GenDentry(1, 0, "A", 0, 1, DELETE_FLAG),
+                                  GenDentry(1, 2, "A", 0, 1, 0),
+                              });
+  auto rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kCommit, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::HANDLE_TX_FAILED);
+  rc = participant->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kPrepare, tx, 1));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+  rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kPrepare, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+  ASSERT_EQ(dentryStorage_->Size(), 1);
+
+  // step-2: the prepared tx survives the snapshot
+  std::vector<std::vector<Dentry>> txs;
+  participant->GetShardedTxs(&txs);
+  ASSERT_EQ(txs.size(), 1);
+  participant = NewPartitionTxManager(2);
+  participantDentry =
+      std::make_shared<DentryManager>(dentryStorage_, participant);
+  ASSERT_TRUE(participant->RestoreShardedTx(txs[0]));
+
+  // step-3: the locked name can't be prepared, created or deleted by others
+  auto other = GenShardedTx(101, std::vector<Dentry>{
+                                     GenDentry(1, 0, "B", 0, 3, DELETE_FLAG),
+                                     GenDentry(1, 2, "A", 0, 3, 0),
+                                 });
+  rc = participant->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kPrepare, other, 1));
+  ASSERT_EQ(rc, MetaStatusCode::HANDLE_PENDING_TX_FAILED);
+  rc = participantDentry->CreateDentry(GenDentry(1, 2, "A", 0, 4, 0));
+  ASSERT_EQ(rc, MetaStatusCode::HANDLE_PENDING_TX_FAILED);
+  rc = participantDentry->DeleteDentry(GenDentry(1, 2, "A", 0, 4, 0));
+  ASSERT_EQ(rc, MetaStatusCode::HANDLE_PENDING_TX_FAILED);
+
+  // step-4: commit on coordinator, then on participant
+  rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kCommit, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+  auto dentry = GenDentry(1, 0, "A", 0, 0, 0);
+  ASSERT_EQ(dentryManager_->GetDentry(&dentry), MetaStatusCode::NOT_FOUND);
+  rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kAbort, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::HANDLE_TX_FAILED);
+
+  rc = participant->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kCommit, tx, 1));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+  rc = participant->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kCommit, tx, 1));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+  dentry = GenDentry(1, 2, "A", 0, 0, 0);
+  ASSERT_EQ(dentryManager_->GetDentry(&dentry), MetaStatusCode::OK);
+  ASSERT_EQ(dentry.inodeid(), 1);
+  ASSERT_EQ(dentryStorage_->Size(), 1);
+
+  // step-5: the lock is released, the aborted tx can't be prepared or
+  //         committed on coordinator
+  rc = participant->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kPrepare, other, 1));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+  rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kAbort, other, 0));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+  rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kPrepare, other, 0));
+  ASSERT_EQ(rc, MetaStatusCode::HANDLE_TX_FAILED);
+  rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kCommit, other, 0));
+  ASSERT_EQ(rc, MetaStatusCode::HANDLE_TX_FAILED);
+  rc = participant->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kAbort, other, 1));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+
+  std::vector<ShardedTx> expired;
+  participant->GetExpiredShardedTxs(0, &expired);
+  ASSERT_TRUE(expired.empty());
+  dentry = GenDentry(1, 2, "A", 0, 0, 0);
+  ASSERT_EQ(dentryManager_->GetDentry(&dentry), MetaStatusCode::OK);
+  ASSERT_EQ(dentry.inodeid(), 1);
+
+  // step-6: all decisions are dumped in one request, and kept until forgotten
+  txs.clear();
+  coordinator->GetShardedTxs(&txs);
+  ASSERT_EQ(txs.size(), 1);
+  ASSERT_EQ(txs[0].size(), 4);
+  coordinator = NewPartitionTxManager(0);
+  ASSERT_TRUE(coordinator->RestoreShardedTx(txs[0]));
+  coordinator->GetExpiredShardedTxs(0, &expired);
+  ASSERT_EQ(expired.size(), 2);
+  rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kAbort, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::HANDLE_TX_FAILED);
+  rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kCommit, other, 0));
+  ASSERT_EQ(rc, MetaStatusCode::HANDLE_TX_FAILED);
+
+  for (const auto& item : expired) {
+    rc = coordinator->HandleRenameTx(
+        EncodeShardedTx(ShardedTxOp::kForget, item.dentrys, 0));
+    ASSERT_EQ(rc, MetaStatusCode::OK);
+  }
+  expired.clear();
+  coordinator->GetExpiredShardedTxs(0, &expired);
+  ASSERT_TRUE(expired.empty());
+}
+
+TEST_F(TransactionTest, ShardedTxForgottenAbortFencesLatePrepare) {
+  InsertDentrys(dentryStorage_,
+                std::vector<Dentry>{
+                    // { fsId, parentId, name, txId, inodeId, flag }
+                    GenDentry(1, 0, "A", 0, 1, 0),
+                });
+  auto coordinator = NewPartitionTxManager(0);
+  auto participant = NewPartitionTxManager(2);
+
+  // step-1: prepared on participant, then resolved by aborting
+  auto tx = GenShardedTx(100, std::vector<Dentry>{
+                                  GenDentry(1, 0, "A", 0, 1, DELETE_FLAG),
+                                  GenDentry(1, 2, "A", 0, 1, 0),
+                              });
+  auto rc = participant->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kPrepare, tx, 1));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+  rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kAbort, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+  rc = participant->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kAbort, tx, 1));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+  rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kForget, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+
+  // step-2: the late prepare on coordinator can't be committed alone
+  rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kPrepare, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::HANDLE_TX_FAILED);
+  rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kCommit, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::HANDLE_TX_FAILED);
+  rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kAbort, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+  auto dentry = GenDentry(1, 0, "A", 0, 0, 0);
+  ASSERT_EQ(dentryManager_->GetDentry(&dentry), MetaStatusCode::OK);
+
+  std::vector<ShardedTx> expired;
+  coordinator->GetExpiredShardedTxs(0, &expired);
+  ASSERT_TRUE(expired.empty());
+
+  // step-3: the tombstone survives the snapshot
+  std::vector<std::vector<Dentry>> txs;
+  coordinator->GetShardedTxs(&txs);
+  ASSERT_EQ(txs.size(), 1);
+  ASSERT_EQ(txs[0].size(), 1);
+  coordinator = NewPartitionTxManager(0);
+  ASSERT_TRUE(coordinator->RestoreShardedTx(txs[0]));
+  rc = coordinator->HandleRenameTx(
+      EncodeShardedTx(ShardedTxOp::kPrepare, tx, 0));
+  ASSERT_EQ(rc, MetaStatusCode::HANDLE_TX_FAILED);
+}
+
+TEST_F(TransactionTest, ShardedTxApplyChecksSource) {
+  InsertDentrys(dentryStorage_,
+                std::vector<Dentry>{
+                    // { fsId, parentId, name, txId, inodeId, flag }
+                    GenDentry(1, 0, "A", 0, 2, 0),
+                });
+
+  // the name is created again with another inode
+  auto rc = dentryStorage_->HandleTx(TX_OP_TYPE::APPLY,
+                                     GenDentry(1, 0, "A", 0, 1, DELETE_FLAG));
+  ASSERT_EQ(rc, MetaStatusCode::NOT_FOUND);
+  auto dentry = GenDentry(1, 0, "A", 0, 0, 0);
+  ASSERT_EQ(dentryManager_->GetDentry(&dentry), MetaStatusCode::OK);
+  ASSERT_EQ(dentry.inodeid(), 2);
+
+  rc = dentryStorage_->HandleTx(TX_OP_TYPE::APPLY,
+                                GenDentry(1, 0, "A", 0, 2, DELETE_FLAG));
+  ASSERT_EQ(rc, MetaStatusCode::OK);
+  ASSERT_EQ(dentryStorage_->Size(), 0);
+}
+
 }  // namespace metaserver
 }  // namespace dingofs
@@ -31,6 +31,7 @@
 #include "metaserver/trash_manager.h"
 #include "dingofs/metaserver.pb.h"
 #include "stub/rpcclient/mock_mds_client.h"
+#include "utils/timeutility.h"
 
 using ::testing::_;
 using ::testing::AtLeast;
@@ -206,5 +207,38 @@ TEST_F(TestTrash, testAdd3ItemAndNoDelete) {
   trashManager_->Fini();
 }
 
+TEST_F(TestTrash, testScanExpiredPrefixAndRestart) {
+  TrashOption option;
+  option.scanPeriodSec = 1;
+  option.expiredAfterSec = 3600;
+  option.mdsClient = std::make_shared<MockMdsClient>();
+  option.s3Adaptor = std::make_shared<MockS3ClientAdaptor>();
+
+  auto trash = std::make_shared<TrashImpl>(inodeStorage_);
+  trash->Init(option);
+  uint32_t now = ::dingofs::utils::TimeUtility::GetTimeofDaySec();
+  inodeStorage_->Insert(GenInodeHasChunks(1, 1));
+  inodeStorage_->Insert(GenInodeHasChunks(1, 2));
+  trash->Add(1, 2, now);
+  trash->Add(1, 1, now - 7200);
+
+  // the trash items are persisted and sorted by dtime
+  auto restarted = std::make_shared<TrashImpl>(inodeStorage_);
+  restarted->Init(option);
+  std::list<TrashItem> list;
+  restarted->ListItems(&list);
+  ASSERT_EQ(2, list.size());
+  ASSERT_EQ(1, list.front().inodeId);
+  ASSERT_EQ(2, list.back().inodeId);
+
+  // only the expired one is deleted
+  restarted->ScanTrash();
+  list.clear();
+  restarted->ListItems(&list);
+  ASSERT_EQ(1, list.size());
+  ASSERT_EQ(2, list.front().inodeId);
+  ASSERT_EQ(inodeStorage_->Size(), 1);
+}
+
 }  // namespace metaserver
 }  // namespace dingofs
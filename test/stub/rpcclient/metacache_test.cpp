@@ -25,6 +25,8 @@
 #include <brpc/server.h>
 #include <gtest/gtest.h>
 
+#include <set>
+
 #include "dingofs/common.pb.h"
 #include "stub/common/common.h"
 #include "stub/rpcclient/mock_cli2_client.h"
@@ -313,6 +315,55 @@ TEST_F(MetaCacheTest, test_SelectTarget) {
   ASSERT_TRUE(CopysetTargetEQ(target, expect));
 }
 
+TEST_F(MetaCacheTest, test_SelectTarget_Locality) {
+  uint32_t fsID = 1;
+  CopysetTarget target;
+  uint64_t applyIndex;
+
+  opt_.inodePlacementPolicy = common::InodePlacementPolicy::kLocality;
+  metaCache_.Init(opt_, mockCli2Client_, mockMdsClient_);
+
+  // partition 1 [1, 10] and partition 2 [11, 20] in copyset 1
+  auto partitions = pInfoList_;
+  PartitionInfo pInfo2 = pInfoList_[0];
+  pInfo2.set_partitionid(2);
+  pInfo2.set_start(11);
+  pInfo2.set_end(20);
+  partitions.emplace_back(pInfo2);
+  std::vector<CopysetInfo<MetaserverID>> metaServerInfos;
+  metaServerInfos.push_back(metaServerList_);
+  EXPECT_CALL(*mockMdsClient_.get(), ListPartition(fsID, _))
+      .WillOnce(DoAll(SetArgPointee<1>(partitions), Return(true)));
+  EXPECT_CALL(*mockMdsClient_.get(), GetCopysetOfPartitions(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(copysetMap_), Return(true)));
+  EXPECT_CALL(*mockMdsClient_.get(), GetMetaServerListInCopysets(_, _, _))
+      .WillOnce(DoAll(SetArgPointee<2>(metaServerInfos), Return(true)));
+  ASSERT_TRUE(metaCache_.ListPartitions(fsID));
+
+  // CASE 1: placed in the partition of parent
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(metaCache_.SelectTarget(fsID, &target, &applyIndex, 15));
+    ASSERT_EQ(target.partitionID, 2);
+    ASSERT_TRUE(metaCache_.SelectTarget(fsID, &target, &applyIndex, 5));
+    ASSERT_EQ(target.partitionID, 1);
+  }
+
+  // CASE 2: no preferred partition, e.g. new directory
+  std::set<uint32_t> selected;
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(metaCache_.SelectTarget(fsID, &target, &applyIndex, 0));
+    selected.insert(target.partitionID);
+  }
+  ASSERT_EQ(selected, (std::set<uint32_t>{1, 2}));
+
+  // CASE 3: spill to other partitions if the partition of parent is full
+  metaCache_.MarkPartitionUnavailable(2);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(metaCache_.SelectTarget(fsID, &target, &applyIndex, 15));
+    ASSERT_EQ(target.partitionID, 1);
+  }
+}
+
 TEST_F(MetaCacheTest, test_UpdateAndGetApplyIndex) {
   // in
   CopysetGroupID groupID(1, 1);
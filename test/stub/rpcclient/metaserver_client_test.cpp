@@ -972,7 +972,7 @@ TEST_F(MetaServerClientImplTest, test_CreateInode) {
       .WillRepeatedly(
           Invoke(SetRpcService<pb::metaserver::CreateInodeRequest,
                                pb::metaserver::CreateInodeResponse, true>));
-  EXPECT_CALL(*mockMetacache_.get(), SelectTarget(_, _, _))
+  EXPECT_CALL(*mockMetacache_.get(), SelectTarget(_, _, _, _))
       .WillRepeatedly(Return(true));
   MetaStatusCode status = metaserverCli_.CreateInode(inode, &out);
   ASSERT_EQ(MetaStatusCode::RPC_ERROR, status);
@@ -988,7 +988,7 @@ TEST_F(MetaServerClientImplTest, test_CreateInode) {
           DoAll(SetArgPointee<2>(response),
                 Invoke(SetRpcService<pb::metaserver::CreateInodeRequest,
                                      pb::metaserver::CreateInodeResponse>)));
-  EXPECT_CALL(*mockMetacache_.get(), SelectTarget(_, _, _))
+  EXPECT_CALL(*mockMetacache_.get(), SelectTarget(_, _, _, _))
       .WillOnce(DoAll(SetArgPointee<1>(target_), SetArgPointee<2>(applyIndex),
                       Return(true)));
   EXPECT_CALL(*mockMetacache_.get(), UpdateApplyIndex(_, _));
@@ -1002,7 +1002,7 @@ TEST_F(MetaServerClientImplTest, test_CreateInode) {
           DoAll(SetArgPointee<2>(response),
                 Invoke(SetRpcService<pb::metaserver::CreateInodeRequest,
                                      pb::metaserver::CreateInodeResponse>)));
-  EXPECT_CALL(*mockMetacache_.get(), SelectTarget(_, _, _))
+  EXPECT_CALL(*mockMetacache_.get(), SelectTarget(_, _, _, _))
       .WillRepeatedly(DoAll(SetArgPointee<1>(target_),
                             SetArgPointee<2>(applyIndex), Return(true)));
 
@@ -1042,7 +1042,7 @@ TEST_F(MetaServerClientImplTest, test_CreateInode) {
           DoAll(SetArgPointee<2>(response),
                 Invoke(SetRpcService<pb::metaserver::CreateInodeRequest,
                                      pb::metaserver::CreateInodeResponse>)));
-  EXPECT_CALL(*mockMetacache_.get(), SelectTarget(_, _, _))
+  EXPECT_CALL(*mockMetacache_.get(), SelectTarget(_, _, _, _))
       .WillRepeatedly(DoAll(SetArgPointee<1>(target_),
                             SetArgPointee<2>(applyIndex), Return(true)));
   EXPECT_CALL(*mockMetacache_.get(), MarkPartitionUnavailable(_))
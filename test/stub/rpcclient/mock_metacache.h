@@ -49,8 +49,8 @@ class MockMetaCache : public MetaCache {
                bool(uint32_t fsID, uint64_t inodeID, CopysetTarget* target,
                     uint64_t* applyIndex, bool refresh));
 
-  MOCK_METHOD3(SelectTarget, bool(uint32_t fsID, CopysetTarget* target,
-                                  uint64_t* applyIndex));
+  MOCK_METHOD4(SelectTarget, bool(uint32_t fsID, CopysetTarget* target,
+                                  uint64_t* applyIndex, uint64_t parentId));
 
   MOCK_METHOD1(GetAllTxIds, void(std::vector<PartitionTxId>* txIds));
 
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stub/rpcclient/routing_table.h"
+
+#include <butil/fast_rand.h>
+#include <butil/time.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace dingofs {
+namespace stub {
+namespace rpcclient {
+
+using pb::common::PartitionInfo;
+using pb::common::PartitionStatus;
+
+class RoutingTableTest : public ::testing::Test {
+ protected:
+  // partitions with continuous inode ranges, in random order
+  static std::vector<PartitionInfo> GenPartitions(uint32_t num,
+                                                  uint64_t rangeSize) {
+    std::vector<PartitionInfo> partitions;
+    for (uint32_t i = 0; i < num; i++) {
+      PartitionInfo info;
+      info.set_fsid(1);
+      info.set_poolid(1);
+      info.set_copysetid(i % 100 + 1);
+      info.set_partitionid(i + 1);
+      info.set_start(i * rangeSize + 1);
+      info.set_end((i + 1) * rangeSize);
+      info.set_txid(i);
+      info.set_status(PartitionStatus::READWRITE);
+      partitions.emplace_back(info);
+    }
+    std::shuffle(partitions.begin(), partitions.end(), std::mt19937(0));
+    return partitions;
+  }
+
+  // the linear scan which MetaCache used before
+  static const PartitionInfo* LinearLookup(
+      const std::vector<PartitionInfo>& partitions, uint64_t inodeId) {
+    for (const auto& info : partitions) {
+      if (info.start() <= inodeId && info.end() >= inodeId) {
+        return &info;
+      }
+    }
+    return nullptr;
+  }
+};
+
+TEST_F(RoutingTableTest, Empty) {
+  RoutingTable table;
+  ASSERT_EQ(table.Size(), 0);
+  ASSERT_EQ(table.Version(), 0);
+  ASSERT_EQ(table.Lookup(1), nullptr);
+  ASSERT_EQ(table.Select(0), nullptr);
+}
+
+TEST_F(RoutingTableTest, Lookup) {
+  auto partitions = GenPartitions(10, 100);
+  // leave a hole in the inode ranges
+  partitions.erase(std::find_if(
+      partitions.begin(), partitions.end(),
+      [](const PartitionInfo& info) { return info.partitionid() == 5; }));
+  RoutingTable table(partitions, 1);
+  ASSERT_EQ(table.Size(), 9);
+  ASSERT_EQ(table.Version(), 1);
+
+  ASSERT_EQ(table.Lookup(0), nullptr);
+  ASSERT_EQ(table.Lookup(1001), nullptr);
+  ASSERT_EQ(table.Lookup(450), nullptr);
+  for (uint64_t inodeId = 1; inodeId <= 1000; inodeId++) {
+    const auto* expect = LinearLookup(partitions, inodeId);
+    const auto* route = table.Lookup(inodeId);
+    if (expect == nullptr) {
+      ASSERT_EQ(route, nullptr);
+      continue;
+    }
+    ASSERT_NE(route, nullptr);
+    ASSERT_EQ(route->partitionId, expect->partitionid());
+    ASSERT_EQ(route->copysetId, expect->copysetid());
+    ASSERT_EQ(route->txId, expect->txid());
+  }
+}
+
+TEST_F(RoutingTableTest, Select) {
+  auto partitions = GenPartitions(10, 100);
+  for (auto& info : partitions) {
+    if (info.partitionid() % 2 == 0) {
+      info.set_status(PartitionStatus::READONLY);
+    }
+  }
+  RoutingTable table(partitions, 1);
+
+  std::set<uint32_t> selected;
+  for (uint64_t rand = 0; rand < 100; rand++) {
+    const auto* route = table.Select(rand);
+    ASSERT_NE(route, nullptr);
+    ASSERT_TRUE(route->readWrite);
+    selected.insert(route->partitionId);
+  }
+  ASSERT_EQ(selected, std::set<uint32_t>({1, 3, 5, 7, 9}));
+
+  // the readonly partitions can be still looked up
+  ASSERT_EQ(table.Lookup(150)->partitionId, 2);
+}
+
+TEST_F(RoutingTableTest, SelectWeighted) {
+  auto partitions = GenPartitions(3, 1000);
+  for (auto& info : partitions) {
+    // partition 1 is nearly full, partition 3 is readonly
+    if (info.partitionid() == 1) {
+      info.set_nextid(info.end() - 9);
+    } else if (info.partitionid() == 3) {
+      info.set_status(PartitionStatus::READONLY);
+    }
+  }
+  RoutingTable table(partitions, 1);
+
+  std::map<uint32_t, int> selected;
+  for (uint64_t rand = 0; rand < 1010; rand++) {
+    selected[table.SelectWeighted(rand)->partitionId]++;
+  }
+  ASSERT_EQ(selected.size(), 2);
+  ASSERT_EQ(selected[1], 10);
+  ASSERT_EQ(selected[2], 1000);
+}
+
+TEST_F(RoutingTableTest, SelectLocal) {
+  auto partitions = GenPartitions(4, 1000);
+  for (auto& info : partitions) {
+    // partition 1 is filled much faster than others, partition 2 is a bit
+    // faster, partition 4 is readonly
+    if (info.partitionid() == 1) {
+      info.set_nextid(info.start() + 800);
+    } else if (info.partitionid() == 2) {
+      info.set_nextid(info.start() + 400);
+    } else if (info.partitionid() == 4) {
+      info.set_status(PartitionStatus::READONLY);
+    }
+  }
+  RoutingTable table(partitions, 1);
+
+  // the average free ids is (200 + 600 + 1000) / 3 = 600
+  ASSERT_EQ(table.SelectLocal(10), nullptr);
+  ASSERT_EQ(table.SelectLocal(1010)->partitionId, 2);
+  ASSERT_EQ(table.SelectLocal(2010)->partitionId, 3);
+  ASSERT_EQ(table.SelectLocal(3010), nullptr);
+  ASSERT_EQ(table.SelectLocal(5000), nullptr);
+}
+
+TEST_F(RoutingTableTest, LookupBenchmark) {
+  const uint32_t kPartitions = 4096;
+  const uint64_t kRangeSize = 1000;
+  const int kLookups = 200000;
+  auto partitions = GenPartitions(kPartitions, kRangeSize);
+  RoutingTable table(partitions, 1);
+
+  std::vector<uint64_t> inodeIds;
+  for (int i = 0; i < kLookups; i++) {
+    inodeIds.emplace_back(butil::fast_rand_less_than(kPartitions * kRangeSize) +
+                          1);
+  }
+
+  butil::Timer timer;
+  uint64_t linearSum = 0;
+  timer.start();
+  for (int i = 0; i < kLookups / 100; i++) {
+    linearSum += LinearLookup(partitions, inodeIds[i])->partitionid();
+  }
+  timer.stop();
+  double linearNs = static_cast<double>(timer.n_elapsed()) / (kLookups / 100);
+
+  uint64_t sum = 0;
+  timer.start();
+  for (int i = 0; i < kLookups; i++) {
+    sum += table.Lookup(inodeIds[i])->partitionId;
+  }
+  timer.stop();
+  double tableNs = static_cast<double>(timer.n_elapsed()) / kLookups;
+
+  uint64_t expectSum = 0;
+  for (int i = 0; i < kLookups / 100; i++) {
+    expectSum += table.Lookup(inodeIds[i])->partitionId;
+  }
+  ASSERT_EQ(linearSum, expectSum);
+  ASSERT_GT(sum, 0);
+
+  LOG(INFO) << "lookup " << kPartitions << " partitions, linear scan: "
+            << linearNs << " ns/op, routing table: " << tableNs << " ns/op";
+}
+
+}  // namespace rpcclient
+}  // namespace stub
+}  // namespace dingofs
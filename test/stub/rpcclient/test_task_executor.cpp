@@ -68,7 +68,7 @@ TEST(CreateInodeTaskExecutorTest, TestPartitionAllocIdFail) {
   EXPECT_CALL(*mockMetaCache, MarkPartitionUnavailable(_))
       .WillOnce(Return(true));
 
-  EXPECT_CALL(*mockMetaCache, SelectTarget(_, _, _))
+  EXPECT_CALL(*mockMetaCache, SelectTarget(_, _, _, _))
       .Times(2)
       .WillRepeatedly(Invoke(
           [](uint32_t /*fsId*/, CopysetTarget* target, uint64_t* applyIndex) {
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2024 dingodb.com, Inc. All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/concurrent/sharded_task_pool.h"
+
+#include <gtest/gtest.h>
+#include <sched.h>
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "utils/concurrent/count_down_event.h"
+
+namespace dingofs {
+namespace utils {
+
+TEST(ShardedTaskPoolTest, InvalidArguments) {
+  {
+    ShardedTaskPool pool;
+    ASSERT_EQ(-1, pool.Start(0, 1));
+  }
+  {
+    ShardedTaskPool pool;
+    ASSERT_EQ(-1, pool.Start(2, 0));
+  }
+  {
+    ShardedTaskPool pool;
+    ASSERT_EQ(-1, pool.Start(2, 1, 0));
+  }
+}
+
+TEST(ShardedTaskPoolTest, SameKeySameThread) {
+  ShardedTaskPool pool;
+  ASSERT_EQ(0, pool.Start(4, 1));
+  ASSERT_EQ(4, pool.ShardOfNums());
+
+  std::mutex mutex;
+  std::map<uint64_t, std::set<std::thread::id>> threads;
+  std::set<std::thread::id> allThreads;
+  CountDownEvent event(100 * 8);
+  for (int i = 0; i < 100; i++) {
+    for (uint64_t key = 0; key < 8; key++) {
+      pool.Enqueue(key, [&, key]() {
+        std::lock_guard<std::mutex> lk(mutex);
+        threads[key].insert(std::this_thread::get_id());
+        allThreads.insert(std::this_thread::get_id());
+        event.Signal();
+      });
+    }
+  }
+  event.Wait();
+
+  for (const auto& item : threads) {
+    ASSERT_EQ(item.second.size(), 1) << "key " << item.first;
+  }
+  ASSERT_EQ(allThreads.size(), 4);
+  ASSERT_EQ(threads[1], threads[5]);
+  pool.Stop();
+  ASSERT_EQ(0, pool.ShardOfNums());
+}
+
+TEST(ShardedTaskPoolTest, BindCpu) {
+  auto cpus = CpuAffinity::GetUsableCpus();
+  ASSERT_FALSE(cpus.empty());
+
+  ShardedTaskPool pool;
+  ASSERT_EQ(0, pool.Start(cpus.size(), 1, 100, true));
+
+  std::vector<int> running(cpus.size(), -1);
+  CountDownEvent event(cpus.size());
+  for (uint64_t key = 0; key < cpus.size(); key++) {
+    pool.Enqueue(key, [&, key]() {
+      running[key] = sched_getcpu();
+      event.Signal();
+    });
+  }
+  event.Wait();
+
+  for (size_t i = 0; i < cpus.size(); i++) {
+    ASSERT_EQ(running[i], cpus[i]);
+  }
+}
+
+}  // namespace utils
+}  // namespace dingofs